@@ -451,6 +451,7 @@ set(BASE_CMN_SRC
     src/common/strvararg.cpp
     src/common/sysopt.cpp
     src/common/tarstrm.cpp
+    src/common/taskexecutor.cpp
     src/common/textbuf.cpp
     src/common/textfile.cpp
     src/common/threadinfo.cpp
@@ -601,6 +602,7 @@ set(BASE_CMN_HDR
     wx/strvararg.h
     wx/sysopt.h
     wx/tarstrm.h
+    wx/taskexecutor.h
     wx/textbuf.h
     wx/textfile.h
     wx/thread.h
@@ -482,6 +482,11 @@ protected:
     // called from ProcessPendingEvents()
     void DeletePendingObjects();
 
+    // move the handlers from m_handlersWithNewPendingEvents queue to the
+    // m_handlersWithPendingEvents array, must be called with
+    // m_handlersWithPendingEventsLocker held
+    void TakeNewPendingEventHandlers();
+
     // the function which creates the traits object when GetTraits() needs it
     // for the first time
     virtual wxAppTraits *CreateTraits();
@@ -514,6 +519,13 @@ protected:
 
     // pending events management vars:
 
+    // the handlers which got pending events since the last time this queue was
+    // checked: they are added to this lock-free intrusive queue (see
+    // wx/private/mpscqueue.h), linked by wxEvtHandler::m_nextWithPendingEvents,
+    // from any thread and moved to m_handlersWithPendingEvents by the thread
+    // processing the pending events
+    wxEvtHandler * volatile m_handlersWithNewPendingEvents;
+
     // the array of the handlers with pending events which needs to be processed
     // inside ProcessPendingEvents()
     wxEvtHandlerArray m_handlersWithPendingEvents;
@@ -525,7 +537,8 @@ protected:
     wxEvtHandlerArray m_handlersWithPendingDelayedEvents;
 
 #if wxUSE_THREADS
-    // this critical section protects both the lists above
+    // this critical section protects both the arrays above, it is only used
+    // when processing or deleting the pending events and not when queuing them
     wxCriticalSection m_handlersWithPendingEventsLocker;
 #endif
 
@@ -126,6 +126,11 @@ public:
 
     virtual void Resort() = 0;
 
+    // called around a group of notifications, the view may postpone updating
+    // itself until the end of the batch
+    virtual void BeginBatch() { }
+    virtual void EndBatch() { }
+
     void SetOwner( wxDataViewModel *owner ) { m_owner = owner; }
     wxDataViewModel *GetOwner() const       { return m_owner; }
 
@@ -265,6 +270,11 @@ public:
     bool BeforeReset();
     bool AfterReset();
 
+    // group several notifications together, calls can be nested
+    void BeginBatch();
+    void EndBatch();
+    bool IsInBatch() const { return m_batchCount != 0; }
+
 
     // delegated action
     virtual void Resort();
@@ -277,6 +287,10 @@ public:
                          unsigned int column, bool ascending ) const;
     virtual bool HasDefaultCompare() const { return false; }
 
+    // return true if Compare() is not overridden, allowing the control to sort
+    // the items by retrieving their values only once
+    virtual bool UsesDefaultCompare() const { return false; }
+
     // internal
     virtual bool IsListModel() const { return false; }
     virtual bool IsVirtualListModel() const { return false; }
@@ -297,6 +311,34 @@ protected:
 
 private:
     wxDataViewModelNotifiers  m_notifiers;
+
+    // number of BeginBatch() calls without the matching EndBatch() yet
+    int                       m_batchCount;
+};
+
+// ----------------------------------------------------------------------------
+// wxDataViewBatchUpdater: groups the model notifications during its lifetime
+// ----------------------------------------------------------------------------
+
+class wxDataViewBatchUpdater
+{
+public:
+    // the model must have a lifetime at least as great as ours
+    explicit wxDataViewBatchUpdater(wxDataViewModel *model)
+        : m_model(model)
+    {
+        m_model->BeginBatch();
+    }
+
+    ~wxDataViewBatchUpdater()
+    {
+        m_model->EndBatch();
+    }
+
+private:
+    wxDataViewModel * const m_model;
+
+    wxDECLARE_NO_COPY_CLASS(wxDataViewBatchUpdater);
 };
 
 // ----------------------------------------------------------------------------
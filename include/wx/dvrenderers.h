@@ -220,6 +220,19 @@ public:
     // Send wxEVT_DATAVIEW_ITEM_EDITING_STARTED event.
     void NotifyEditingStarted(const wxDataViewItem& item);
 
+    // PrepareForItem() is equivalent to calling GetDataForItem() followed by
+    // PrepareForData(), these functions can be used separately to reuse the
+    // data retrieved from the model for rendering the same cell again.
+    void GetDataForItem(const wxDataViewModel *model,
+                        const wxDataViewItem& item,
+                        unsigned column,
+                        wxVariant& value,
+                        wxDataViewItemAttr& attr,
+                        bool& enabled) const;
+    void PrepareForData(const wxVariant& value,
+                        const wxDataViewItemAttr& attr,
+                        bool enabled);
+
     // Sets the transformer for fine-tuning rendering of values depending on row's state
     void SetValueAdjuster(wxDataViewValueAdjuster *transformer)
         { delete m_valueAdjuster; m_valueAdjuster = transformer; }
@@ -73,6 +73,9 @@ class WXDLLIMPEXP_FWD_BASE wxEventFilter;
 
 class WXDLLIMPEXP_FWD_BASE wxMSVC_FWD_MULTIPLE_BASES wxEvtHandler;
 class wxEventConnectionRef;
+class wxPendingEventsData;
+class wxDynamicEventsIndex;
+class WXDLLIMPEXP_FWD_BASE wxEventTraceScope;
 
 // ----------------------------------------------------------------------------
 // Event types
@@ -661,6 +664,7 @@ extern WXDLLIMPEXP_BASE const wxEventType wxEVT_USER_FIRST;
     // Need events declared to do this
 class WXDLLIMPEXP_FWD_BASE wxIdleEvent;
 class WXDLLIMPEXP_FWD_BASE wxThreadEvent;
+class WXDLLIMPEXP_FWD_BASE wxBatchEvent;
 class WXDLLIMPEXP_FWD_BASE wxAsyncMethodCallEvent;
 class WXDLLIMPEXP_FWD_CORE wxCommandEvent;
 class WXDLLIMPEXP_FWD_CORE wxMouseEvent;
@@ -733,6 +737,7 @@ wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_CORE, wxEVT_COMBOBOX_CLOSEUP, wxCommandEven
 
     // Thread and asynchronous method call events
 wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_BASE, wxEVT_THREAD, wxThreadEvent);
+wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_BASE, wxEVT_BATCH, wxBatchEvent);
 wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_BASE, wxEVT_ASYNC_METHOD_CALL, wxAsyncMethodCallEvent);
 
     // Mouse event types
@@ -1134,12 +1139,26 @@ protected:
     wxEvent& operator=(const wxEvent&); // for derived classes operator=()
 
 private:
+    // The next event in the queue of the pending events of wxEvtHandler this
+    // event was queued to, only used while the event is pending.
+    wxEvent *m_nextPending;
+
+    // The time when this event was queued as returned by wxEventTracer, or 0
+    // if the tracer wasn't running then.
+    wxUint32 m_queuedTime;
+
     // It needs to access our m_propagationLevel and m_propagatedFrom fields.
     friend class WXDLLIMPEXP_FWD_BASE wxPropagateOnce;
 
     // and this one needs to access our m_handlerToProcessOnlyIn
     friend class WXDLLIMPEXP_FWD_BASE wxEventProcessInHandlerOnly;
 
+    // and this one uses m_nextPending for its queue of pending events
+    friend class WXDLLIMPEXP_FWD_BASE wxEvtHandler;
+
+    // and this one uses m_queuedTime and m_wasProcessed
+    friend class WXDLLIMPEXP_FWD_BASE wxEventTraceScope;
+
 
     wxDECLARE_ABSTRACT_CLASS(wxEvent);
 };
@@ -1367,6 +1386,50 @@ private:
 };
 
 
+// Batch event: contains several pending events of the same type delivered
+// together, see wxEvtHandler::EnableBatchedEvents()
+
+class WXDLLIMPEXP_BASE wxBatchEvent : public wxEvent
+{
+public:
+    wxBatchEvent(wxEventType batchedEventType = wxEVT_NULL)
+        : wxEvent(wxID_ANY, wxEVT_BATCH),
+          m_batchedEventType(batchedEventType),
+          m_category(wxEVT_CATEGORY_UI)
+        { }
+
+    wxBatchEvent(const wxBatchEvent& event);
+
+    virtual ~wxBatchEvent();
+
+    // the type of the events in this batch
+    wxEventType GetBatchedEventType() const { return m_batchedEventType; }
+
+    // the events in the order in which they were queued, they are owned by
+    // this object and deleted when it is
+    const wxVector<wxEvent*>& GetEvents() const { return m_events; }
+
+    // add an event to the batch, taking ownership of it
+    void AddEvent(wxEvent *event);
+
+    virtual wxEvent *Clone() const wxOVERRIDE
+    {
+        return new wxBatchEvent(*this);
+    }
+
+    // a batch has the same category as the events in it
+    virtual wxEventCategory GetEventCategory() const wxOVERRIDE
+        { return m_category; }
+
+private:
+    wxEventType m_batchedEventType;
+    wxEventCategory m_category;
+    wxVector<wxEvent*> m_events;
+
+    wxDECLARE_DYNAMIC_CLASS_NO_ASSIGN(wxBatchEvent);
+};
+
+
 // Asynchronous method call events: these event are processed by wxEvtHandler
 // itself and result in a call to its Execute() method which simply calls the
 // specified method. The difference with a simple method call is that this is
@@ -3593,6 +3656,109 @@ protected:
     wxDECLARE_NO_COPY_CLASS(wxEventHashTable);
 };
 
+// ----------------------------------------------------------------------------
+// wxEventDispatchStats: statistics of the dynamic event handlers lookups
+// ----------------------------------------------------------------------------
+
+// The values returned by wxEvtHandler::GetDispatchStats(), see the
+// description of EnableDispatchStats() there.
+struct wxEventDispatchStats
+{
+    wxEventDispatchStats()
+        : searches(0),
+          handlersScanned(0),
+          maxHandlersScanned(0)
+    {
+    }
+
+    // Number of searches for a dynamic event handler for an event.
+    wxUint64 searches;
+
+    // Total number of the dynamic handlers examined by all of these searches.
+    wxUint64 handlersScanned;
+
+    // Maximal number of the handlers examined by a single search.
+    size_t maxHandlersScanned;
+};
+
+// ----------------------------------------------------------------------------
+// wxEventTracer: recording of the events processing for profiling
+// ----------------------------------------------------------------------------
+
+// The kinds of the activities recorded by wxEventTracer.
+enum wxEventTraceKind
+{
+    // Processing of a single event by wxEvtHandler::ProcessEvent().
+    wxEVENT_TRACE_PROCESS,
+
+    // Processing of all the pending events by wxApp.
+    wxEVENT_TRACE_PENDING_EVENTS,
+
+    // Sending idle events from the event loop.
+    wxEVENT_TRACE_IDLE
+};
+
+// A single record of wxEventTracer.
+struct wxEventTraceRecord
+{
+    wxEventTraceKind kind;
+
+    // The type and the class of the event and the class of the handler it was
+    // sent to, only used by wxEVENT_TRACE_PROCESS records.
+    wxEventType eventType;
+    const wxClassInfo* eventClass;
+    const wxClassInfo* handlerClass;
+
+#if wxUSE_THREADS
+    // The thread in which the activity took place.
+    wxThreadIdType threadId;
+#endif // wxUSE_THREADS
+
+    // The start time in microseconds since wxEventTracer::Start() call.
+    wxUint64 start;
+
+    // The duration of the activity in microseconds.
+    wxUint32 duration;
+
+    // The time in microseconds between queuing the event and starting to
+    // process it, only valid if wasQueued is true.
+    wxUint32 queueLatency;
+    bool wasQueued;
+};
+
+class WXDLLIMPEXP_BASE wxEventTracer
+{
+public:
+    // Start recording the events processing, keeping at most the given number
+    // of the most recent records (rounded up to a power of 2). Any existing
+    // records are discarded.
+    static void Start(size_t capacity = 65536);
+
+    // Stop recording, the existing records are kept.
+    static void Stop();
+
+    static bool IsRunning() { return ms_running; }
+
+    // Discard all the existing records.
+    static void Clear();
+
+    // Return the existing records in the order in which the corresponding
+    // activities ended.
+    static wxVector<wxEventTraceRecord> GetRecords();
+
+    // Return the existing records in Chrome trace event JSON format, which
+    // can be loaded into chrome://tracing or other compatible viewers.
+    static wxString GetChromeTrace();
+
+#if wxUSE_FFILE
+    // Save the result of GetChromeTrace() into the given file.
+    static bool SaveChromeTrace(const wxString& filename);
+#endif // wxUSE_FFILE
+
+private:
+    static volatile bool ms_running;
+};
+
 // ----------------------------------------------------------------------------
 // wxEvtHandler: the base class for all objects handling wxWidgets events
 // ----------------------------------------------------------------------------
@@ -3634,6 +3800,20 @@ public:
     static void RemoveFilter(wxEventFilter* filter);
 
 
+    // Dispatch statistics
+    // -------------------
+
+    // Start or stop counting the dynamic event handlers examined when
+    // processing the events. This is disabled by default.
+    static void EnableDispatchStats(bool enable = true);
+
+    // Get the statistics collected since the last call to ResetDispatchStats().
+    static wxEventDispatchStats GetDispatchStats();
+
+    // Reset all the statistics values to 0.
+    static void ResetDispatchStats();
+
+
     // Event queuing and processing
     // ----------------------------
 
@@ -3683,6 +3863,20 @@ public:
         QueueEvent(event.Clone());
     }
 
+    // Queue an event which replaces the event queued with the same key before
+    // if it hasn't been processed yet. The event is processed at the position
+    // of the first of the events it replaced in the queue. This is useful for
+    // the events representing the current state of something, e.g. progress
+    // updates, as only the last one of them needs to be processed. Just as
+    // QueueEvent(), this takes ownership of the event and can be called from
+    // any thread.
+    void QueueCoalescedEvent(wxUIntPtr key, wxEvent *event);
+
+    // Process all pending events of the given type together, as a single
+    // wxBatchEvent, instead of processing them one by one. This should be
+    // called from the main thread before any such events are queued.
+    void EnableBatchedEvents(wxEventType eventType, bool enable = true);
+
     void ProcessPendingEvents();
         // NOTE: uses ProcessEvent()
 
@@ -4012,10 +4206,36 @@ protected:
     typedef wxVector<wxDynamicEventTableEntry*> DynamicEvents;
     DynamicEvents* m_dynamicEvents;
 
-    wxList*             m_pendingEvents;
+    // The same entries as in m_dynamicEvents grouped by their event type, to
+    // avoid examining all of them when searching for the handler of an event.
+    // It is only created once there are many entries and is NULL until then.
+    wxDynamicEventsIndex* m_dynamicEventsIndex;
+
+    // The events queued by QueueEvent(), which can be called from any thread,
+    // are added to this lock-free intrusive queue (see wx/private/mpscqueue.h)
+    // linked by wxEvent::m_nextPending.
+    wxEvent * volatile  m_pendingEventsQueued;
+
+    // The thread processing the pending events moves them from the queue above
+    // to this list, preserving their order, before processing them.
+    wxEvent*            m_pendingEventsFirst;
+    wxEvent*            m_pendingEventsLast;
+
+    // Non-zero if this handler is in wxAppConsole list of handlers with
+    // pending events or is being added to it.
+    wxUint32 volatile   m_pendingEventsRegistered;
+
+    // The next handler in wxAppConsole lock-free queue of handlers with new
+    // pending events.
+    wxEvtHandler*       m_nextWithPendingEvents;
+
+    // The coalesced events and other rarely used pending events data, created
+    // on demand.
+    wxPendingEventsData * volatile m_pendingEventsData;
 
 #if wxUSE_THREADS
-    // critical section protecting m_pendingEvents
+    // critical section serializing the processing of the pending events, it is
+    // not used when queuing them
     wxCriticalSection m_pendingEventsLock;
 #endif // wxUSE_THREADS
 
@@ -4054,9 +4274,27 @@ private:
     // try to process events in all handlers chained to this one
     bool DoTryChain(wxEvent& event);
 
+    // move the events from m_pendingEventsQueued to the end of the list of
+    // the events to process, must be called with m_pendingEventsLock held
+    void TakeQueuedPendingEvents();
+
+    // remove this handler from the list of handlers with pending events if
+    // it doesn't have any of them any more
+    void UnregisterIfNoPendingEvents();
+
+    // remove the given event, following the given one (which may be NULL),
+    // from the list of the events to process
+    void UnlinkPendingEvent(wxEvent* prev, wxEvent* event);
+
+    // create m_pendingEventsData if necessary and return it
+    wxPendingEventsData* GetPendingEventsData();
+
     // Head of the event filter linked list.
     static wxEventFilter* ms_filterList;
 
+    // it manages m_pendingEventsRegistered and m_nextWithPendingEvents
+    friend class WXDLLIMPEXP_FWD_BASE wxAppConsoleBase;
+
     wxDECLARE_DYNAMIC_CLASS_NO_COPY(wxEvtHandler);
 };
 
@@ -4146,6 +4384,7 @@ inline void wxQueueEvent(wxEvtHandler *dest, wxEvent *event)
 typedef void (wxEvtHandler::*wxEventFunction)(wxEvent&);
 typedef void (wxEvtHandler::*wxIdleEventFunction)(wxIdleEvent&);
 typedef void (wxEvtHandler::*wxThreadEventFunction)(wxThreadEvent&);
+typedef void (wxEvtHandler::*wxBatchEventFunction)(wxBatchEvent&);
 
 #define wxEventHandler(func) \
     wxEVENT_HANDLER_CAST(wxEventFunction, func)
@@ -4153,6 +4392,8 @@ typedef void (wxEvtHandler::*wxThreadEventFunction)(wxThreadEvent&);
     wxEVENT_HANDLER_CAST(wxIdleEventFunction, func)
 #define wxThreadEventHandler(func) \
     wxEVENT_HANDLER_CAST(wxThreadEventFunction, func)
+#define wxBatchEventHandler(func) \
+    wxEVENT_HANDLER_CAST(wxBatchEventFunction, func)
 
 #if wxUSE_GUI
 
@@ -4723,6 +4964,9 @@ typedef void (wxEvtHandler::*wxPressAndTapEventFunction)(wxPressAndTapEvent&);
 // Thread events
 #define EVT_THREAD(id, func)  wx__DECLARE_EVT1(wxEVT_THREAD, id, wxThreadEventHandler(func))
 
+// Batch events
+#define EVT_BATCH(func)  wx__DECLARE_EVT0(wxEVT_BATCH, wxBatchEventHandler(func))
+
 // ----------------------------------------------------------------------------
 // Helper functions
 // ----------------------------------------------------------------------------
@@ -283,6 +283,9 @@ public:
 
     virtual wxBorder GetDefaultBorder() const wxOVERRIDE;
 
+    virtual void Refresh(bool eraseBackground = true,
+                         const wxRect *rect = NULL) wxOVERRIDE;
+
     virtual void EditItem(const wxDataViewItem& item, const wxDataViewColumn *column) wxOVERRIDE;
 
     virtual bool SetHeaderAttr(const wxItemAttr& attr) wxOVERRIDE;
@@ -115,6 +115,12 @@ class WXDLLIMPEXP_FWD_CORE wxDatePickerCtrl;
 #endif
 
 class wxGridFixedIndicesSet;
+class wxGridLinePositions;
+class wxGridAutoSizeCache;
+class wxGridRenderCache;
+class wxGridColumnarTableColumn;
+class wxGridSortData;
+class wxGridSortThread;
 
 class wxGridOperations;
 class wxGridRowOperations;
@@ -226,6 +232,22 @@ public:
         return wxDefaultSize;
     }
 
+    // This function is optional too: it is used when auto-sizing columns to
+    // determine the maximal best width of several cells of the same column,
+    // all using the same attribute, at once, which can be much faster than
+    // calling GetBestWidth() for each of them.
+    //
+    // If it isn't supported, return wxDefaultCoord as the base class version
+    // does by default.
+    virtual int GetMaxBestWidth(wxGrid& WXUNUSED(grid),
+                                wxGridCellAttr& WXUNUSED(attr),
+                                wxDC& WXUNUSED(dc),
+                                const wxArrayInt& WXUNUSED(rows),
+                                int WXUNUSED(col))
+    {
+        return wxDefaultCoord;
+    }
+
     // create a new object which is the copy of this one
     virtual wxGridCellRenderer *Clone() const = 0;
 
@@ -1229,6 +1251,12 @@ public:
     virtual void* GetValueAsCustom( int row, int col, const wxString& typeName );
     virtual void  SetValueAsCustom( int row, int col, const wxString& typeName, void* value );
 
+    // Append the values of all cells of the given block, row by row, to the
+    // provided array. The default implementation simply calls GetValue() for
+    // each of them, but this can be overridden to do it more efficiently.
+    virtual void GetValuesAsString( const wxGridBlockCoords& block,
+                                    wxArrayString& values );
+
 
     // Overriding these is optional
     //
@@ -1412,6 +1440,255 @@ private:
     wxDECLARE_DYNAMIC_CLASS_NO_COPY(wxGridStringTable);
 };
 
+// ----------------------------------------------------------------------------
+// wxGridColumnarTable: a table storing typed values column by column
+// ----------------------------------------------------------------------------
+
+class WXDLLIMPEXP_CORE wxGridColumnarTable : public wxGridTableBase
+{
+public:
+    // the types of the values which can be stored in the columns
+    enum ColumnType
+    {
+        Type_String,
+        Type_Long,
+        Type_Double,
+        Type_Bool
+    };
+
+    wxGridColumnarTable();
+    virtual ~wxGridColumnarTable();
+
+    // add a new column of the given type, all its values are initially 0,
+    // false or empty, and return its index
+    int AppendColumn( ColumnType type, const wxString& label = wxString() );
+
+    // change the type of an existing column, resetting all its values
+    void SetColumnType( int col, ColumnType type );
+    ColumnType GetColumnType( int col ) const;
+
+    // set the values of count consecutive rows of the column, starting at
+    // firstRow, in a single call: the rows must already exist and the type of
+    // the values must correspond to the type of the column
+    bool SetColumnData( int col, const long *values, size_t count,
+                        size_t firstRow = 0 );
+    bool SetColumnData( int col, const double *values, size_t count,
+                        size_t firstRow = 0 );
+    bool SetColumnData( int col, const bool *values, size_t count,
+                        size_t firstRow = 0 );
+    bool SetColumnData( int col, const wxArrayString& values,
+                        size_t firstRow = 0 );
+
+    // these are pure virtual in wxGridTableBase
+    //
+    virtual int GetNumberRows() wxOVERRIDE { return m_numRows; }
+    virtual int GetNumberCols() wxOVERRIDE { return static_cast<int>(m_columns.size()); }
+    virtual wxString GetValue( int row, int col ) wxOVERRIDE;
+    virtual void SetValue( int row, int col, const wxString& s ) wxOVERRIDE;
+
+    // overridden functions from wxGridTableBase
+    //
+    virtual bool IsEmptyCell( int row, int col ) wxOVERRIDE;
+
+    virtual wxString GetTypeName( int row, int col ) wxOVERRIDE;
+    virtual bool CanGetValueAs( int row, int col, const wxString& typeName ) wxOVERRIDE;
+    virtual bool CanSetValueAs( int row, int col, const wxString& typeName ) wxOVERRIDE;
+
+    virtual long GetValueAsLong( int row, int col ) wxOVERRIDE;
+    virtual double GetValueAsDouble( int row, int col ) wxOVERRIDE;
+    virtual bool GetValueAsBool( int row, int col ) wxOVERRIDE;
+
+    virtual void SetValueAsLong( int row, int col, long value ) wxOVERRIDE;
+    virtual void SetValueAsDouble( int row, int col, double value ) wxOVERRIDE;
+    virtual void SetValueAsBool( int row, int col, bool value ) wxOVERRIDE;
+
+    virtual void GetValuesAsString( const wxGridBlockCoords& block,
+                                    wxArrayString& values ) wxOVERRIDE;
+
+    void Clear() wxOVERRIDE;
+    bool InsertRows( size_t pos = 0, size_t numRows = 1 ) wxOVERRIDE;
+    bool AppendRows( size_t numRows = 1 ) wxOVERRIDE;
+    bool DeleteRows( size_t pos = 0, size_t numRows = 1 ) wxOVERRIDE;
+    bool InsertCols( size_t pos = 0, size_t numCols = 1 ) wxOVERRIDE;
+    bool AppendCols( size_t numCols = 1 ) wxOVERRIDE;
+    bool DeleteCols( size_t pos = 0, size_t numCols = 1 ) wxOVERRIDE;
+
+    void SetRowLabelValue( int row, const wxString& ) wxOVERRIDE;
+    void SetColLabelValue( int col, const wxString& ) wxOVERRIDE;
+    void SetCornerLabelValue( const wxString& ) wxOVERRIDE;
+    wxString GetRowLabelValue( int row ) wxOVERRIDE;
+    wxString GetColLabelValue( int col ) wxOVERRIDE;
+    wxString GetCornerLabelValue() const wxOVERRIDE;
+
+private:
+    // return the column if the given cell is valid or NULL otherwise
+    wxGridColumnarTableColumn* GetColumn( int row, int col ) const;
+
+    // common part of all SetColumnData() overloads: check that the column has
+    // the expected type and that the rows exist
+    wxGridColumnarTableColumn*
+    GetColumnForData( int col, ColumnType type, size_t count, size_t firstRow ) const;
+
+    // insert the columns of the given type without sending any notifications
+    void DoInsertCols( size_t pos, size_t numCols, ColumnType type );
+
+    wxVector<wxGridColumnarTableColumn*> m_columns;
+
+    int m_numRows;
+
+    // only used if the labels of the rows are set, as in wxGridStringTable
+    wxArrayString m_rowLabels;
+
+    wxString m_cornerLabel;
+
+    wxDECLARE_DYNAMIC_CLASS_NO_COPY(wxGridColumnarTable);
+};
+
+// ----------------------------------------------------------------------------
+// wxGridSortedTable: a table showing the rows of another one in sorted order
+// ----------------------------------------------------------------------------
+
+// a single key used for sorting the rows
+struct wxGridSortKey
+{
+    wxGridSortKey(int col_ = -1, bool ascending_ = true)
+        : col(col_), ascending(ascending_)
+    {
+    }
+
+    int col;
+    bool ascending;
+};
+
+typedef wxVector<wxGridSortKey> wxGridSortKeys;
+
+class WXDLLIMPEXP_CORE wxGridSortedTable : public wxGridTableBase
+{
+public:
+    // the table is deleted by this object only if takeOwnership is true
+    wxGridSortedTable( wxGridTableBase *table, bool takeOwnership = false );
+    virtual ~wxGridSortedTable();
+
+    wxGridTableBase *GetSourceTable() const { return m_table; }
+
+    // sort the rows using the given keys, the first one being the primary
+    // one: the sort is stable, so the rows with equal keys keep their order,
+    // and is done in background if the table has at least as many rows as
+    // the background sort threshold
+    void Sort( const wxGridSortKeys& keys );
+    void Sort( int col, bool ascending = true )
+        { Sort( wxGridSortKeys(1, wxGridSortKey(col, ascending)) ); }
+
+    // restore the original order of the rows
+    void ResetSort();
+
+    // cancel the background sort, if any, keeping the current order
+    void CancelSort();
+
+    bool IsSorting() const { return m_sortThread != NULL; }
+    const wxGridSortKeys& GetSortKeys() const { return m_sortKeys; }
+
+    // set the minimal number of rows for sorting in background, 0 disables
+    // background sorting entirely
+    void SetBackgroundSortThreshold( size_t numRows ) { m_sortThreshold = numRows; }
+    size_t GetBackgroundSortThreshold() const { return m_sortThreshold; }
+
+    // return the row of the source table shown at the given row
+    int GetSourceRow( int row ) const
+    {
+        return static_cast<size_t>(row) < m_rows.size() ? m_rows[row] : row;
+    }
+
+    // these are pure virtual in wxGridTableBase
+    //
+    virtual int GetNumberRows() wxOVERRIDE { return m_table->GetNumberRows(); }
+    virtual int GetNumberCols() wxOVERRIDE { return m_table->GetNumberCols(); }
+    virtual wxString GetValue( int row, int col ) wxOVERRIDE;
+    virtual void SetValue( int row, int col, const wxString& s ) wxOVERRIDE;
+
+    // all the other functions are forwarded to the source table too
+    //
+    virtual bool IsEmptyCell( int row, int col ) wxOVERRIDE;
+
+    virtual wxString GetTypeName( int row, int col ) wxOVERRIDE;
+    virtual bool CanGetValueAs( int row, int col, const wxString& typeName ) wxOVERRIDE;
+    virtual bool CanSetValueAs( int row, int col, const wxString& typeName ) wxOVERRIDE;
+
+    virtual long GetValueAsLong( int row, int col ) wxOVERRIDE;
+    virtual double GetValueAsDouble( int row, int col ) wxOVERRIDE;
+    virtual bool GetValueAsBool( int row, int col ) wxOVERRIDE;
+
+    virtual void SetValueAsLong( int row, int col, long value ) wxOVERRIDE;
+    virtual void SetValueAsDouble( int row, int col, double value ) wxOVERRIDE;
+    virtual void SetValueAsBool( int row, int col, bool value ) wxOVERRIDE;
+
+    virtual void* GetValueAsCustom( int row, int col, const wxString& typeName ) wxOVERRIDE;
+    virtual void  SetValueAsCustom( int row, int col, const wxString& typeName, void* value ) wxOVERRIDE;
+
+    // changing the number of rows resets the sort order
+    void Clear() wxOVERRIDE;
+    bool InsertRows( size_t pos = 0, size_t numRows = 1 ) wxOVERRIDE;
+    bool AppendRows( size_t numRows = 1 ) wxOVERRIDE;
+    bool DeleteRows( size_t pos = 0, size_t numRows = 1 ) wxOVERRIDE;
+    bool InsertCols( size_t pos = 0, size_t numCols = 1 ) wxOVERRIDE;
+    bool AppendCols( size_t numCols = 1 ) wxOVERRIDE;
+    bool DeleteCols( size_t pos = 0, size_t numCols = 1 ) wxOVERRIDE;
+
+    void SetRowLabelValue( int row, const wxString& ) wxOVERRIDE;
+    void SetColLabelValue( int col, const wxString& ) wxOVERRIDE;
+    void SetCornerLabelValue( const wxString& ) wxOVERRIDE;
+    wxString GetRowLabelValue( int row ) wxOVERRIDE;
+    wxString GetColLabelValue( int col ) wxOVERRIDE;
+    wxString GetCornerLabelValue() const wxOVERRIDE;
+
+    virtual bool CanHaveAttributes() wxOVERRIDE;
+    virtual wxGridCellAttr *GetAttr( int row, int col,
+                                     wxGridCellAttr::wxAttrKind kind ) wxOVERRIDE;
+    virtual bool CanMeasureColUsingSameAttr( int col ) const wxOVERRIDE;
+    virtual void SetAttr( wxGridCellAttr* attr, int row, int col ) wxOVERRIDE;
+    virtual void SetRowAttr( wxGridCellAttr *attr, int row ) wxOVERRIDE;
+    virtual void SetColAttr( wxGridCellAttr *attr, int col ) wxOVERRIDE;
+
+private:
+    // use the given order of the rows, which is swapped with the current
+    // one, and refresh the view
+    void ApplySort( wxVector<int>& rows );
+
+    // handler of the event sent by the background sorting thread
+    void OnSortDone( wxThreadEvent& event );
+
+    // update m_rows after inserting numRows rows at srcPos in the source
+    // table to show them at the given position
+    void InsertSourceRows( size_t pos, size_t srcPos, size_t numRows );
+
+    // start sorting using m_sortKeys again if the sort was in progress
+    void RestartSort( bool wasSorting );
+
+    // send the message about the change in the rows or columns to the view
+    void NotifyView( int id, int comInt1 = -1, int comInt2 = -1 );
+
+    wxGridTableBase *m_table;
+    bool m_ownTable;
+
+    // the rows of m_table in the display order or empty if not sorted
+    wxVector<int> m_rows;
+
+    wxGridSortKeys m_sortKeys;
+
+    size_t m_sortThreshold;
+
+    // the data and the thread used for sorting in background and the
+    // counter allowing to ignore the results of the cancelled sorts
+    wxGridSortData *m_sortData;
+    wxGridSortThread *m_sortThread;
+    int m_sortGeneration;
+
+    // the object receiving the events from the sorting thread
+    wxEvtHandler m_sortHandler;
+
+    wxDECLARE_NO_COPY_CLASS(wxGridSortedTable);
+};
+
 
 
 // ============================================================================
@@ -1960,6 +2237,12 @@ public:
     // happens, call this function to force it
     void RefreshAttr(int row, int col);
 
+    // cache the attributes and renderers of all the cells drawn by the grid
+    // and not just the last one, this cache is invalidated by RefreshAttr()
+    // and ForceRefresh() too
+    void EnableRenderCache(bool enable = true);
+    bool IsRenderCacheEnabled() const { return m_renderCache != NULL; }
+
     // returns the attribute we may modify in place: a new one if this cell
     // doesn't have any yet or the existing one if it does
     //
@@ -2126,6 +2409,22 @@ public:
     // autosize column width depending on label text
     void     AutoSizeColLabelSize( int col );
 
+    // cache the best sizes of the cells computed when auto-sizing the rows
+    // and columns to avoid measuring the cells which didn't change again
+    void     EnableAutoSizeCache( bool enable = true );
+    bool     IsAutoSizeCacheEnabled() const { return m_autoSizeColsCache != NULL; }
+
+    // the grid itself invalidates the cache when the cells are changed using
+    // its own functions, but these methods must be called if the table
+    // contents or the cell attributes are changed directly
+    void     InvalidateCellAutoSize( int row, int col );
+    void     ClearAutoSizeCache();
+
+    // limit the number of cells measured when auto-sizing a row or column,
+    // 0 (default) means to measure all of them
+    void     SetAutoSizeMaxCells( int maxCells );
+    int      GetAutoSizeMaxCells() const { return m_autoSizeMaxCells; }
+
     // column won't be resized to be lesser width - this must be called during
     // the grid creation because it won't resize the column if it's already
     // narrower than the minimal width
@@ -2207,6 +2506,7 @@ public:
     // ------ select blocks of cells
     //
     void SelectRow( int row, bool addToSelected = false );
+    void SelectRows( const wxArrayInt& rows, bool addToSelected = false );
     void SelectCol( int col, bool addToSelected = false );
 
     void SelectBlock( int topRow, int leftCol, int bottomRow, int rightCol,
@@ -2583,21 +2883,26 @@ protected:
     // NB: *never* access m_row/col arrays directly because they are created
     //     on demand, *always* use accessor functions instead!
 
-    // init the m_rowHeights/Bottoms arrays with default values
+    // init the m_rowHeights array and m_rowPositions with default values
     void InitRowHeights();
 
     int        m_defaultRowHeight;
     int        m_minAcceptableRowHeight;
     wxArrayInt m_rowHeights;
-    wxArrayInt m_rowBottoms;
 
-    // init the m_colWidths/Rights arrays
+    // positions of the rows, only valid if m_rowHeights is not empty
+    wxGridLinePositions *m_rowPositions;
+
+    // init the m_colWidths array and m_colPositions
     void InitColWidths();
 
     int        m_defaultColWidth;
     int        m_minAcceptableColWidth;
     wxArrayInt m_colWidths;
-    wxArrayInt m_colRights;
+
+    // positions of the columns in display order, only valid if m_colWidths
+    // is not empty
+    wxGridLinePositions *m_colPositions;
 
     int m_sortCol;
     bool m_sortIsAscending;
@@ -3130,6 +3435,22 @@ private:
     wxGridFixedIndicesSet *m_setFixedRows,
                           *m_setFixedCols;
 
+    // the caches of the best sizes of the cells of the columns and rows, used
+    // by AutoSizeColOrRow(), are NULL unless EnableAutoSizeCache() is called
+    wxGridAutoSizeCache *m_autoSizeColsCache,
+                        *m_autoSizeRowsCache;
+
+    // the maximal number of cells to measure in AutoSizeColOrRow() or 0
+    int m_autoSizeMaxCells;
+
+    // the cache of the attributes and renderers used by DrawCell(), NULL
+    // unless EnableRenderCache() is called
+    wxGridRenderCache *m_renderCache;
+
+    // invalidate the render cache for the given cell or all of them
+    void InvalidateRenderCache(int row, int col) const;
+    void ClearRenderCache() const;
+
     wxDECLARE_DYNAMIC_CLASS(wxGrid);
     wxDECLARE_EVENT_TABLE();
     wxDECLARE_NO_COPY_CLASS(wxGrid);
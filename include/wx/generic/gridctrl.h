@@ -37,14 +37,31 @@ public:
                                wxDC& dc,
                                int row, int col) wxOVERRIDE;
 
+    // return the width of the longest string of all the given cells, as
+    // returned by GetDisplayString()
+    virtual int GetMaxBestWidth(wxGrid& grid,
+                                wxGridCellAttr& attr,
+                                wxDC& dc,
+                                const wxArrayInt& rows,
+                                int col) wxOVERRIDE;
+
     virtual wxGridCellRenderer *Clone() const wxOVERRIDE
         { return new wxGridCellStringRenderer; }
 
 protected:
+    // return the string shown in the given cell, this is just its value here
+    // but is overridden in the derived classes formatting it
+    virtual wxString GetDisplayString(const wxGrid& grid, int row, int col);
+
     // calc the string extent for given string/font
     wxSize DoGetBestSize(const wxGridCellAttr& attr,
                          wxDC& dc,
                          const wxString& text);
+
+    // calc the width of the longest of the given strings for the given font
+    int DoGetMaxBestWidth(const wxGridCellAttr& attr,
+                          wxDC& dc,
+                          const wxArrayString& texts);
 };
 
 // the default renderer for the cells containing numeric (long) data
@@ -82,6 +99,10 @@ public:
         { return new wxGridCellNumberRenderer(m_minValue, m_maxValue); }
 
 protected:
+    virtual wxString GetDisplayString(const wxGrid& grid,
+                                      int row, int col) wxOVERRIDE
+        { return GetString(grid, row, col); }
+
     wxString GetString(const wxGrid& grid, int row, int col);
 
     long m_minValue,
@@ -123,6 +144,10 @@ public:
     virtual wxGridCellRenderer *Clone() const wxOVERRIDE;
 
 protected:
+    virtual wxString GetDisplayString(const wxGrid& grid,
+                                      int row, int col) wxOVERRIDE
+        { return GetString(grid, row, col); }
+
     wxString GetString(const wxGrid& grid, int row, int col);
 
 private:
@@ -202,6 +227,10 @@ public:
     virtual void SetParameters(const wxString& params) wxOVERRIDE;
 
 protected:
+    virtual wxString GetDisplayString(const wxGrid& grid,
+                                      int row, int col) wxOVERRIDE
+        { return GetString(grid, row, col); }
+
     wxString GetString(const wxGrid& grid, int row, int col);
 
     // This is overridden in wxGridCellDateTimeRenderer which uses a separate
@@ -288,6 +317,10 @@ public:
     virtual wxGridCellRenderer *Clone() const wxOVERRIDE;
 
 protected:
+    virtual wxString GetDisplayString(const wxGrid& grid,
+                                      int row, int col) wxOVERRIDE
+        { return GetString(grid, row, col); }
+
     wxString GetString(const wxGrid& grid, int row, int col);
 };
 
@@ -321,6 +354,15 @@ public:
                               int row, int col,
                               int height) wxOVERRIDE;
 
+    // the best width depends on the height of each row, so the cells can't
+    // be measured together
+    virtual int GetMaxBestWidth(wxGrid& WXUNUSED(grid),
+                                wxGridCellAttr& WXUNUSED(attr),
+                                wxDC& WXUNUSED(dc),
+                                const wxArrayInt& WXUNUSED(rows),
+                                int WXUNUSED(col)) wxOVERRIDE
+        { return wxDefaultCoord; }
+
     virtual wxGridCellRenderer *Clone() const wxOVERRIDE
         { return new wxGridCellAutoWrapStringRenderer; }
 
@@ -21,6 +21,8 @@
 
 typedef wxVector<wxGridBlockCoords> wxVectorGridBlockCoords;
 
+class wxGridSelectionIndex;
+
 // Note: for all eventType arguments of the methods of this class wxEVT_NULL
 //       may be passed to forbid events generation completely.
 class WXDLLIMPEXP_CORE wxGridSelection
@@ -28,6 +30,7 @@ class WXDLLIMPEXP_CORE wxGridSelection
 public:
     wxGridSelection(wxGrid *grid,
                     wxGrid::wxGridSelectionModes sel = wxGrid::wxGridSelectCells);
+    ~wxGridSelection();
 
     bool IsSelection();
     bool IsInSelection(int row, int col) const;
@@ -40,6 +43,13 @@ public:
     wxGrid::wxGridSelectionModes GetSelectionMode() { return m_selectionMode; }
     void SelectRow(int row, const wxKeyboardState& kbd = wxKeyboardState());
     void SelectCol(int col, const wxKeyboardState& kbd = wxKeyboardState());
+
+    // Select all the given rows, which don't need to be sorted, at once,
+    // sending one event for each range of consecutive rows which were not
+    // selected yet.
+    void SelectRows(const wxArrayInt& rows,
+                    const wxKeyboardState& kbd = wxKeyboardState(),
+                    wxEventType eventType = wxEVT_GRID_RANGE_SELECTED);
     void SelectBlock(int topRow, int leftCol,
                      int bottomRow, int rightCol,
                      const wxKeyboardState& kbd = wxKeyboardState(),
@@ -109,7 +119,13 @@ public:
     wxArrayInt GetRowSelection() const;
     wxArrayInt GetColSelection() const;
 
-    wxVectorGridBlockCoords& GetBlocks() { return m_selection; }
+    // Notice that the blocks may be modified using the returned reference, so
+    // we can't rely on our index remaining valid after calling this.
+    wxVectorGridBlockCoords& GetBlocks()
+    {
+        InvalidateIndex();
+        return m_selection;
+    }
 
     void EndSelecting();
 
@@ -135,9 +151,15 @@ private:
     // We don't currently check if the new block is contained by several
     // existing blocks, as this would be more difficult and doesn't seem to be
     // really needed in practice.
-    void MergeOrAddBlock(wxVectorGridBlockCoords& blocks,
+    //
+    // Returns true if the block was added.
+    bool MergeOrAddBlock(wxVectorGridBlockCoords& blocks,
                          const wxGridBlockCoords& block);
 
+    // Must be called whenever any of the existing blocks is modified or
+    // removed, but not when new blocks are added at the end.
+    void InvalidateIndex();
+
     // All currently selected blocks. We expect there to be a relatively small
     // amount of them, even for very large grids, as each block must be
     // selected by the user, so we store them unsorted.
@@ -147,6 +169,13 @@ private:
     // extending the current selection from keyboard.
     wxVectorGridBlockCoords             m_selection;
 
+    // The index allowing to find the blocks containing the given cell without
+    // checking all of them. It only contains the first m_numIndexedBlocks of
+    // m_selection, the remaining ones, which are usually few, are checked
+    // linearly and the index is rebuilt when there are too many of them.
+    wxGridSelectionIndex                *m_index;
+    mutable size_t                      m_numIndexedBlocks;
+
     wxGrid                              *m_grid;
     wxGrid::wxGridSelectionModes        m_selectionMode;
 
@@ -15,7 +15,9 @@
 
 #if wxUSE_GRID
 
+#include "wx/hashmap.h"
 #include "wx/headerctrl.h"
+#include "wx/vector.h"
 
 // ----------------------------------------------------------------------------
 // array classes
@@ -24,10 +26,6 @@
 WX_DEFINE_ARRAY_WITH_DECL_PTR(wxGridCellAttr *, wxArrayAttrs,
                                  class WXDLLIMPEXP_ADV);
 
-WX_DECLARE_HASH_MAP_WITH_DECL(wxLongLong_t, wxGridCellAttr*,
-                              wxIntegerHash, wxIntegerEqual,
-                              wxGridCoordsToAttrMap, class WXDLLIMPEXP_CORE);
-
 
 // ----------------------------------------------------------------------------
 // private classes
@@ -419,9 +417,15 @@ private:
 // ----------------------------------------------------------------------------
 
 // this class stores attributes set for cells
+//
+// The attributes are stored per row, with only the rows having at least one
+// cell attribute being present, so that inserting or deleting rows only needs
+// to update the indices of the following rows instead of touching all the
+// attributes.
 class WXDLLIMPEXP_ADV wxGridCellAttrData
 {
 public:
+    wxGridCellAttrData() { }
     ~wxGridCellAttrData();
 
     void SetAttr(wxGridCellAttr *attr, int row, int col);
@@ -430,10 +434,70 @@ public:
     void UpdateAttrCols( size_t pos, int numCols );
 
 private:
-    // Tries to search for the attr for given cell.
-    wxGridCoordsToAttrMap::iterator FindIndex(int row, int col) const;
+    // Attribute of a single cell.
+    struct CellAttr
+    {
+        CellAttr(int col_, wxGridCellAttr *attr_) : col(col_), attr(attr_) { }
+
+        int col;
+        wxGridCellAttr *attr;
+    };
+
+    // Attributes of all cells of a single row, sorted by column.
+    typedef wxVector<CellAttr> CellAttrs;
+
+    struct RowAttrs
+    {
+        int row;
+        CellAttrs *cells;
+    };
+
+    // Attribute of a cell which needs to be added after inserting rows or
+    // columns inside a multicell.
+    struct NewCellAttr
+    {
+        int row,
+            col;
+        wxGridCellAttr *attr;
+    };
+
+    typedef wxVector<NewCellAttr> NewCellAttrs;
+
+    // Update the coordinates and the size of the attribute of the given cell
+    // after inserting (if editRowCount or editColCount is positive) or
+    // deleting (if negative) rows or columns at editPos. Returns false if the
+    // cell doesn't exist any more and its attribute was released.
+    static bool UpdateCellAttr(int& row, int& col, wxGridCellAttr *attr,
+                               int editPos, int editRowCount, int editColCount,
+                               NewCellAttrs& newAttrs);
+
+    // Update all attributes of the given row as above, return false if it
+    // doesn't have any attributes any more.
+    static bool UpdateRowAttrs(RowAttrs& rowAttrs,
+                               int editPos, int editRowCount, int editColCount,
+                               NewCellAttrs& newAttrs);
+
+    // Add the attributes collected by UpdateCellAttr().
+    void AddNewAttrs(const NewCellAttrs& newAttrs);
+
+    // Return the index of the first element of m_rows for the given row or
+    // after it.
+    size_t FindRow(int row) const;
+
+    // Return the index of the first element of cells for the given column or
+    // after it.
+    static size_t FindCol(const CellAttrs& cells, int col);
+
+    // Return the pointer to the attribute of the given cell in m_rows or NULL.
+    wxGridCellAttr **FindAttr(int row, int col) const;
+
+    // Remove the element of m_rows with the given index.
+    void DeleteRow(size_t n);
+
+    // Sorted by row, never contains rows without any attributes.
+    wxVector<RowAttrs> m_rows;
 
-    mutable wxGridCoordsToAttrMap m_attrs;
+    wxDECLARE_NO_COPY_CLASS(wxGridCellAttrData);
 };
 
 // this class stores attributes set for rows or columns
@@ -463,6 +527,165 @@ public:
                            m_colAttrs;
 };
 
+// ----------------------------------------------------------------------------
+// wxGridLinePositions: positions of the rows or columns of non-default sizes
+// ----------------------------------------------------------------------------
+
+// This class stores the sizes of all rows or columns, in their display order,
+// in a Fenwick (also known as binary indexed) tree which allows to find the
+// position of any line, find the line at the given coordinate and change the
+// size of a line, all in O(log N) time.
+//
+// Hidden lines are stored as having zero size.
+class wxGridLinePositions
+{
+public:
+    wxGridLinePositions() { }
+
+    // Rebuild the tree using the given sizes, taken in the order specified by
+    // the second array, i.e. sizes[order[pos]] is the size of the line at the
+    // display position pos, or in their natural order if it is empty.
+    //
+    // Negative sizes correspond to the hidden lines. This takes O(N) time.
+    void Build(const wxArrayInt& sizes, const wxArrayInt& order);
+
+    // Add the given number of lines of the same size at the end.
+    void Append(int count, int size);
+
+    // Change the size of the line at the given display position by diff.
+    void Update(int pos, int diff);
+
+    // Return the number of lines.
+    int GetCount() const { return static_cast<int>(m_tree.size()); }
+
+    // Return the start, i.e. the sum of the sizes of all the lines before it,
+    // or the end of the line at the given position. Passing GetCount() to
+    // GetStart() returns the total size of all lines.
+    int GetStart(int pos) const;
+    int GetEnd(int pos) const { return GetStart(pos + 1); }
+
+    // Return the display position of the line containing the given
+    // non-negative coordinate, i.e. the first line ending after it, or
+    // GetCount() if the coordinate is beyond the end of the last line.
+    int FindPos(int coord) const;
+
+private:
+    // Element i of this vector contains the sum of the sizes of the lines in
+    // [i + 1 - lsb(i + 1), i], where lsb(n) is the lowest set bit of n.
+    wxVector<int> m_tree;
+
+    wxDECLARE_NO_COPY_CLASS(wxGridLinePositions);
+};
+
+// ----------------------------------------------------------------------------
+// wxGridAutoSizeCache: best sizes of the cells used for auto-sizing
+// ----------------------------------------------------------------------------
+
+// This class stores the maximal best extents of the blocks of BLOCK_SIZE
+// consecutive cells of all rows or columns, allowing wxGrid to only measure
+// the cells of the blocks that changed when auto-sizing them again.
+//
+// The "lines" here are columns and the "cells" are rows for the cache used
+// for auto-sizing columns and vice versa for the one used for the rows.
+class wxGridAutoSizeCache
+{
+public:
+    enum { BLOCK_SIZE = 256 };
+
+    wxGridAutoSizeCache() { }
+
+    // Return the cached extent of the given block of the line or -1.
+    int Get(int line, int block) const;
+
+    // Remember the extent of the given block of the line.
+    void Set(int line, int block, int extent);
+
+    // Forget the extent of the block containing the given cell of the line or
+    // of all lines if line is -1.
+    void InvalidateCell(int line, int cell);
+
+    // Forget all the extents of the given line.
+    void InvalidateLine(int line);
+
+    // Forget everything.
+    void Clear() { m_lines.clear(); }
+
+    // Update the cache after inserting (if numLines > 0) or deleting (if it's
+    // negative) the lines at the given position.
+    void UpdateLines(int pos, int numLines);
+
+    // Update the cache after inserting or deleting the cells at the given
+    // position in all lines, which invalidates all the blocks after it.
+    void UpdateCells(int pos);
+
+private:
+    // The extents of all blocks of every line, -1 for the unknown ones.
+    wxVector< wxVector<int> > m_lines;
+
+    wxDECLARE_NO_COPY_CLASS(wxGridAutoSizeCache);
+};
+
+// ----------------------------------------------------------------------------
+// wxGridRenderCache: attributes and renderers of the cells used for drawing
+// ----------------------------------------------------------------------------
+
+// The attribute and the renderer used for drawing a cell, both of them have
+// an extra reference held by wxGridRenderCache.
+struct wxGridRenderCacheEntry
+{
+    wxGridCellAttr *attr;
+    wxGridCellRenderer *renderer;
+};
+
+WX_DECLARE_HASH_MAP(wxLongLong_t, wxGridRenderCacheEntry,
+                    wxIntegerHash, wxIntegerEqual,
+                    wxGridRenderCacheMap);
+
+// This class allows wxGrid to avoid resolving the attribute of each cell,
+// which may involve merging the cell, row and column attributes, and finding
+// the renderer for its type every time the cell is redrawn.
+//
+// It's cleared entirely when it contains more than MAX_ENTRIES cells, which
+// is enough for any realistic number of cells visible on screen at once.
+class wxGridRenderCache
+{
+public:
+    enum { MAX_ENTRIES = 65536 };
+
+    wxGridRenderCache() { }
+    ~wxGridRenderCache() { Clear(); }
+
+    // Return the cached entry for the given cell or NULL.
+    const wxGridRenderCacheEntry* Get(int row, int col) const
+    {
+        const wxGridRenderCacheMap::const_iterator it = m_entries.find(GetKey(row, col));
+        return it == m_entries.end() ? NULL : &it->second;
+    }
+
+    // Remember the attribute and renderer of the given cell, taking a new
+    // reference to both of them.
+    void Set(int row, int col,
+             wxGridCellAttr *attr, wxGridCellRenderer *renderer);
+
+    // Forget the entry of the given cell.
+    void Invalidate(int row, int col);
+
+    // Forget everything.
+    void Clear();
+
+private:
+    static wxLongLong_t GetKey(int row, int col)
+    {
+        return (static_cast<wxLongLong_t>(row) << 32) | static_cast<wxUint32>(col);
+    }
+
+    static void ReleaseEntry(const wxGridRenderCacheEntry& entry);
+
+    wxGridRenderCacheMap m_entries;
+
+    wxDECLARE_NO_COPY_CLASS(wxGridRenderCache);
+};
+
 // ----------------------------------------------------------------------------
 // operations classes abstracting the difference between operating on rows and
 // columns
@@ -551,8 +774,9 @@ public:
     // Get the height/width of the given row/column
     virtual int GetLineSize(const wxGrid *grid, int line) const = 0;
 
-    // Get wxGrid::m_rowBottoms/m_colRights array
-    virtual const wxArrayInt& GetLineEnds(const wxGrid *grid) const = 0;
+    // Get wxGrid::m_rowPositions/m_colPositions, which are only valid if the
+    // grid has any rows/columns of non-default size and NULL otherwise
+    virtual const wxGridLinePositions *GetLinePositions(const wxGrid *grid) const = 0;
 
     // Get default height row height or column width
     virtual int GetDefaultLineSize(const wxGrid *grid) const = 0;
@@ -649,8 +873,8 @@ public:
         { return grid->GetRowBottom(line); }
     virtual int GetLineSize(const wxGrid *grid, int line) const wxOVERRIDE
         { return grid->GetRowHeight(line); }
-    virtual const wxArrayInt& GetLineEnds(const wxGrid *grid) const wxOVERRIDE
-        { return grid->m_rowBottoms; }
+    virtual const wxGridLinePositions *GetLinePositions(const wxGrid *grid) const wxOVERRIDE
+        { return grid->m_rowHeights.empty() ? NULL : grid->m_rowPositions; }
     virtual int GetDefaultLineSize(const wxGrid *grid) const wxOVERRIDE
         { return grid->GetDefaultRowSize(); }
     virtual int GetMinimalAcceptableLineSize(const wxGrid *grid) const wxOVERRIDE
@@ -730,8 +954,8 @@ public:
         { return grid->GetColRight(line); }
     virtual int GetLineSize(const wxGrid *grid, int line) const wxOVERRIDE
         { return grid->GetColWidth(line); }
-    virtual const wxArrayInt& GetLineEnds(const wxGrid *grid) const wxOVERRIDE
-        { return grid->m_colRights; }
+    virtual const wxGridLinePositions *GetLinePositions(const wxGrid *grid) const wxOVERRIDE
+        { return grid->m_colWidths.empty() ? NULL : grid->m_colPositions; }
     virtual int GetDefaultLineSize(const wxGrid *grid) const wxOVERRIDE
         { return grid->GetDefaultColSize(); }
     virtual int GetMinimalAcceptableLineSize(const wxGrid *grid) const wxOVERRIDE
@@ -18,6 +18,8 @@
 #include "wx/selstore.h"
 #include "wx/timer.h"
 #include "wx/settings.h"
+#include "wx/hashmap.h"
+#include "wx/vector.h"
 
 // ============================================================================
 // private classes
@@ -42,6 +44,72 @@ struct wxColWidthInfo
 
 WX_DEFINE_ARRAY_PTR(wxColWidthInfo *, ColWidthArray);
 
+//-----------------------------------------------------------------------------
+//  wxListStringPool and wxListAttrPool (internal)
+//-----------------------------------------------------------------------------
+
+// Many items of a list control typically have the same texts and attributes,
+// so the items only keep pointers to the values stored in these pools, which
+// store every distinct value only once, and release them when they don't
+// need them any more.
+
+WX_DECLARE_STRING_HASH_MAP(unsigned, wxListStringRefCounts);
+
+class wxListStringPool
+{
+public:
+    wxListStringPool() { }
+
+    // Return the pointer to the pooled copy of the given string, which must be
+    // released later, or NULL if the string is empty.
+    const wxString* Add(const wxString& s);
+
+    // Add another reference to the non-NULL string returned by Add().
+    void AddRef(const wxString* s);
+
+    // Release the string returned by Add(), NULL is allowed here.
+    void Release(const wxString* s);
+
+    // Return the empty string which corresponds to the NULL pointer.
+    static const wxString& GetEmpty();
+
+private:
+    wxListStringRefCounts m_refCounts;
+
+    wxDECLARE_NO_COPY_CLASS(wxListStringPool);
+};
+
+WX_DECLARE_HASH_MAP(wxItemAttr*, unsigned, wxPointerHash, wxPointerEqual,
+                    wxListAttrRefCounts);
+WX_DECLARE_HASH_MAP(unsigned long, wxVector<wxItemAttr*>,
+                    wxIntegerHash, wxIntegerEqual,
+                    wxListAttrsByHash);
+
+class wxListAttrPool
+{
+public:
+    wxListAttrPool() { }
+    ~wxListAttrPool();
+
+    // Return the shared attributes equal to the given ones, which must be
+    // released later.
+    wxItemAttr* Add(const wxItemAttr& attr);
+
+    // Add another reference to the attributes returned by Add().
+    void AddRef(wxItemAttr* attr);
+
+    // Release the attributes returned by Add(), NULL is allowed here.
+    void Release(wxItemAttr* attr);
+
+private:
+    static unsigned long Hash(const wxItemAttr& attr);
+
+    wxListAttrRefCounts m_refCounts;
+    wxListAttrsByHash m_attrsByHash;
+
+    wxDECLARE_NO_COPY_CLASS(wxListAttrPool);
+};
+
 //-----------------------------------------------------------------------------
 //  wxListItemData (internal)
 //-----------------------------------------------------------------------------
@@ -50,6 +118,8 @@ class wxListItemData
 {
 public:
     wxListItemData(wxListMainWindow *owner);
+    wxListItemData(const wxListItemData& other);
+    wxListItemData& operator=(const wxListItemData& other);
     ~wxListItemData();
 
     void SetItem( const wxListItem &info );
@@ -58,9 +128,10 @@ public:
     void SetPosition( int x, int y );
     void SetSize( int width, int height );
 
-    bool HasText() const { return !m_text.empty(); }
-    const wxString& GetText() const { return m_text; }
-    void SetText(const wxString& text) { m_text = text; }
+    bool HasText() const { return m_text != NULL; }
+    const wxString& GetText() const
+        { return m_text ? *m_text : wxListStringPool::GetEmpty(); }
+    void SetText(const wxString& text);
 
     // we can't use empty string for measuring the string width/height, so
     // always return something
@@ -85,6 +156,8 @@ public:
 
     void GetItem( wxListItem &info ) const;
 
+    // this is only used for the virtual controls, where the attributes are
+    // not owned by the item
     void SetAttr(wxItemAttr *attr) { m_attr = attr; }
     wxItemAttr *GetAttr() const { return m_attr; }
 
@@ -102,14 +175,22 @@ public:
     // the list ctrl we are in
     wxListMainWindow *m_owner;
 
-    // custom attributes or NULL
+    // custom attributes or NULL, they're shared with the other items with the
+    // same attributes using the owner attributes pool in non-virtual controls
     wxItemAttr *m_attr;
 
 protected:
     // common part of all ctors
     void Init();
 
-    wxString m_text;
+    // copy the other item data into this one, which must be empty
+    void Copy(const wxListItemData& other);
+
+    // release all the data of this item
+    void Free();
+
+    // the text of the item stored in the owner strings pool or NULL if empty
+    const wxString *m_text;
 };
 
 //-----------------------------------------------------------------------------
@@ -160,13 +241,13 @@ private:
 //  wxListLineData (internal)
 //-----------------------------------------------------------------------------
 
-WX_DECLARE_LIST(wxListItemData, wxListItemDataList);
+typedef wxVector<wxListItemData> wxListItemDataArray;
 
 class wxListLineData
 {
 public:
-    // the list of subitems: only may have more than one item in report mode
-    wxListItemDataList m_items;
+    // the subitems: only may have more than one item in report mode
+    wxListItemDataArray m_items;
 
     // this is not used in report view
     struct GeometryInfo
@@ -210,7 +291,6 @@ public:
 
     ~wxListLineData()
     {
-        WX_CLEAR_LIST(wxListItemDataList, m_items);
         delete m_gi;
     }
 
@@ -326,6 +406,10 @@ public:
     ~wxListLineDataArray() { Clear(); }
 };
 
+// Map from the item data to the index of the first item having it.
+WX_DECLARE_HASH_MAP(wxUIntPtr, size_t, wxIntegerHash, wxIntegerEqual,
+                    wxListDataIndex);
+
 //-----------------------------------------------------------------------------
 //  wxListHeaderWindow (internal)
 //-----------------------------------------------------------------------------
@@ -785,7 +869,16 @@ public:
                                    const wxRect& rect,
                                    int lineNumber );
 
+    // get the pools used by the items for storing their texts and attributes
+    wxListStringPool& GetStringPool() { return m_stringPool; }
+    wxListAttrPool& GetAttrPool() { return m_attrPool; }
+
 protected:
+    // the pools of the texts and attributes of the items: they must be
+    // declared before m_lines as they must outlive the items
+    wxListStringPool     m_stringPool;
+    wxListAttrPool       m_attrPool;
+
     // the array of all line objects for a non virtual list control (for the
     // virtual list control we only ever use m_lines[0])
     wxListLineDataArray  m_lines;
@@ -854,6 +947,14 @@ protected:
     // controls
     wxSelectionStore m_selStore;
 
+    // the index of the first item with the given data, used by FindItem() and
+    // only valid if m_dataIndexValid is true, never used in virtual controls
+    wxListDataIndex m_dataIndex;
+    bool m_dataIndexValid;
+
+    // update m_dataIndex after inserting a line or invalidate it otherwise
+    void UpdateDataIndexOnInsert(size_t line);
+
     // common part of all ctors
     void Init();
 
@@ -10,7 +10,6 @@
 #ifndef _WX_PRIVATE_ROWHEIGHTCACHE_H_
 #define _WX_PRIVATE_ROWHEIGHTCACHE_H_
 
-#include "wx/hashmap.h"
 #include "wx/vector.h"
 
 // struct describing a range of rows which contains rows <from> .. <to-1>
@@ -76,8 +75,8 @@ private:
     void CleanUp(unsigned int idx);
 };
 
-WX_DECLARE_HASH_MAP(unsigned int, RowRanges*, wxIntegerHash, wxIntegerEqual,
-    HeightToRowRangesMap);
+// node of the tree used by HeightCache, only defined in its implementation
+struct HeightCacheNode;
 
 /**
     HeightCache implements a cache mechanism for wxDataViewCtrl.
@@ -87,56 +86,76 @@ WX_DECLARE_HASH_MAP(unsigned int, RowRanges*, wxIntegerHash, wxIntegerEqual,
     * the y-coordinate where a row starts (GetLineStart)
     * and vice versa (GetLineAt)
 
-    The layout of the cache is a hashmap where the keys are all existing row
-    heights in pixels. The values are RowRange objects that represent all rows
-    having the specified height.
+    The rows are stored in a balanced binary tree (a treap) in which every
+    node contains a run of consecutive rows with the same height, or with
+    unknown height, ordered by their position and not by any key. Each node
+    also keeps the total number of rows, the number of rows with known
+    heights and the sum of these heights for its entire subtree, which allows
+    to compute the sum of the heights of all rows before the given one, as
+    well as to find the row containing the given y-coordinate, in O(log n)
+    time.
+
+    Inserting or removing rows, as well as changing the height of a single
+    row, only requires splitting and merging the tree at the affected
+    positions, which is O(log n) too, and the heights of all the following
+    rows are preserved, so that they don't need to be queried again. The
+    adjacent rows with the same height are kept in the same node, so the
+    tree remains small if most rows have the same height.
 
     An example:
     @code
-    {
-    22: RowRange([0..10], [15..17], [20..2000]),
-    42: RowRange([11..12], [18..18]),
-    62: RowRange([13..14], [19..19])
-    }
+    row:    0  1  2  3  4  5  6  7
+    height: 22 22 42 22 62 22 22 22
     @endcode
 
-    Examples
-    ========
-
-    GetLineStart
-    ------------
-    To retrieve the y-coordinate of item 1000 it is necessary to look into
-    each key of the hashmap *m_heightToRowRange*. Get the row count of
-    indices lower than 1000 (RowRange::CountTo) and multiplies it which the
-    according height.
-
-    RowRange([0..10], [15..17], [20..2000]).CountTo(1000)
-    --> 0..10 are 11 items, 15..17 are 3 items and 20..1000 are 980 items (1000-20)
-    = 11 + 3 + 980 = 994 items
-
-    GetLineStart(1000) --> (22 * 994) + (42 * 3) + (62 * 3) = 22180
-
-    GetLineHeight
-    -------------
-    To retrieve the line height look into each key and check if row is
-    contained in RowRange (RowRange::Has)
-
-    GetLineAt
-    ---------
-    To retrieve the row that starts at a specific y-coordinate.
-    Look into each key and count all rows.
-    Use bisect algorithm in combination with GetLineStart() to
-    find the appropriate item
+    GetLineStart(5) returns 22 + 22 + 42 + 22 + 62 = 170 and GetLineAt(169)
+    returns 4, but both of them fail if the height of any of the rows before
+    the given one is unknown.
 */
 class WXDLLIMPEXP_CORE HeightCache
 {
 public:
-    ~HeightCache();
+    HeightCache() : m_root(NULL), m_seed(1) { }
+    ~HeightCache() { Clear(); }
+
+    /**
+        Gets the y-coordinate of the start of the given row.
+
+        Returns false if the heights of some of the preceding rows are not
+        known. Notice that the height of the row itself doesn't need to be
+        known, so this can be used to get the total height of the rows too.
+    */
     bool GetLineStart(unsigned int row, int& start);
+
+    /**
+        Gets the height of the given row, if it's known.
+    */
     bool GetLineHeight(unsigned int row, int& height);
+
+    /**
+        Gets the row containing the given y-coordinate.
+
+        Returns false if y is before the first or after the last known row or
+        if the heights of some of the preceding rows are not known.
+    */
     bool GetLineAt(int y, unsigned int& row);
+
+    /**
+        Gets both the start and the height of the given row.
+
+        Returns false if the height of this row or any of the preceding ones
+        is unknown.
+    */
     bool GetLineInfo(unsigned int row, int &start, int &height);
 
+    /**
+        Returns the index of the first row whose height is not known.
+
+        All the rows before it have known heights and so GetLineStart() can
+        be used for any row up to and including the returned one.
+    */
+    unsigned int GetFirstUnknownRow();
+
     void Put(unsigned int row, int height);
 
     /**
@@ -145,10 +164,50 @@ public:
     */
     void Remove(unsigned int row);
 
+    /**
+        Removes the stored height of the given row only.
+    */
+    void InvalidateLine(unsigned int row);
+
+    /**
+        Inserts the given number of rows with unknown heights before the
+        given one, shifting the heights of the subsequent rows.
+    */
+    void InsertRows(unsigned int row, unsigned int count);
+
+    /**
+        Deletes the given number of rows starting with the given one, shifting
+        the heights of the subsequent rows back.
+    */
+    void DeleteRows(unsigned int row, unsigned int count);
+
     void Clear();
 
 private:
-    HeightToRowRangesMap m_heightToRowRange;
+    typedef HeightCacheNode Node;
+
+    // Create a new node for the given number of rows with the given height
+    // (or -1 if it's unknown).
+    Node* NewNode(unsigned int rows, int height);
+
+    // Set the height of the given existing row, or make it unknown if the
+    // height is -1.
+    void SetHeight(unsigned int row, int height);
+
+    // Return the total number of rows.
+    unsigned int GetSize() const;
+
+    // Return the number of known rows and the sum of their heights in
+    // [0, row) range.
+    void GetPrefix(unsigned int row, unsigned int& known, int& sum) const;
+
+    // Root of the tree or NULL if it's empty.
+    Node* m_root;
+
+    // State of the pseudo-random generator of the nodes priorities.
+    unsigned int m_seed;
+
+    wxDECLARE_NO_COPY_CLASS(HeightCache);
 };
 
 
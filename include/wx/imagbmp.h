@@ -53,6 +53,8 @@ public:
 #if wxUSE_STREAMS
     virtual bool SaveFile( wxImage *image, wxOutputStream& stream, bool verbose=true ) wxOVERRIDE;
     virtual bool LoadFile( wxImage *image, wxInputStream& stream, bool verbose=true, int index=-1 ) wxOVERRIDE;
+    virtual bool LoadRows( wxImageRowSink& sink, wxInputStream& stream,
+                           int scale = 1, bool verbose=true, int index=-1 ) wxOVERRIDE;
 
 protected:
     virtual bool DoCanRead( wxInputStream& stream ) wxOVERRIDE;
@@ -89,6 +91,14 @@ public:
     virtual bool LoadFile( wxImage *image, wxInputStream& stream, bool verbose=true, int index=-1 ) wxOVERRIDE;
     virtual bool DoLoadFile( wxImage *image, wxInputStream& stream, bool verbose, int index );
 
+    // Icons are not BMP files, so don't use wxBMPHandler version of this
+    // function, which only works for the latter.
+    virtual bool LoadRows( wxImageRowSink& sink, wxInputStream& stream,
+                           int scale = 1, bool verbose=true, int index=-1 ) wxOVERRIDE
+    {
+        return wxImageHandler::LoadRows(sink, stream, scale, verbose, index);
+    }
+
 protected:
     virtual int DoGetImageCount( wxInputStream& stream ) wxOVERRIDE;
     virtual bool DoCanRead( wxInputStream& stream ) wxOVERRIDE;
@@ -83,6 +83,19 @@ enum wxImageAlphaBlendMode
     wxIMAGE_ALPHA_BLEND_COMPOSE = 1
 };
 
+// Layouts of the interleaved pixel data returned by wxImage::GetRGBAData().
+enum wxImageRGBAFormat
+{
+    // R, G, B and A bytes, colour components are not premultiplied by alpha.
+    // This is the layout used by GdkPixbuf.
+    wxIMAGE_RGBA_STRAIGHT,
+
+    // 32 bit values in native byte order with alpha in the most significant
+    // byte, followed by red, green and blue premultiplied by alpha. This is
+    // the layout used by Cairo CAIRO_FORMAT_ARGB32 surfaces.
+    wxIMAGE_RGBA_PREMULTIPLIED
+};
+
 // alpha channel values: fully transparent, default threshold separating
 // transparent pixels from opaque for a few functions dealing with alpha and
 // fully opaque
@@ -107,6 +120,33 @@ class WXDLLIMPEXP_FWD_CORE wxPalette;
 DECLARE_VARIANT_OBJECT_EXPORTED(wxImage,WXDLLIMPEXP_CORE)
 #endif
 
+//-----------------------------------------------------------------------------
+// wxImageRowSink
+//-----------------------------------------------------------------------------
+
+// Base class for receiving the image data from wxImageHandler::LoadRows()
+// progressively, without ever having the entire image in memory.
+class WXDLLIMPEXP_CORE wxImageRowSink
+{
+public:
+    wxImageRowSink() { }
+    virtual ~wxImageRowSink() { }
+
+    // Called once before any calls to OnRows() with the size of the image,
+    // after reducing it if requested. Return false to stop loading.
+    virtual bool OnBegin(int width, int height, bool hasAlpha) = 0;
+
+    // Called with count consecutive rows starting at the given one, in top to
+    // bottom order. The data is in the same format as used by wxImage itself
+    // and alpha is NULL if the image doesn't have it. Return false to stop
+    // loading.
+    virtual bool OnRows(int y, int count,
+                        const unsigned char* data,
+                        const unsigned char* alpha) = 0;
+
+    wxDECLARE_NO_COPY_CLASS(wxImageRowSink);
+};
+
 //-----------------------------------------------------------------------------
 // wxImageHandler
 //-----------------------------------------------------------------------------
@@ -133,6 +173,12 @@ public:
 
     bool CanRead( wxInputStream& stream ) { return CallDoCanRead(stream); }
     bool CanRead( const wxString& name );
+
+    // Load the image passing it to the sink row by row, optionally reducing
+    // it by the given factor. The default implementation loads the entire
+    // image using LoadFile(), the derived classes override it to avoid this.
+    virtual bool LoadRows( wxImageRowSink& sink, wxInputStream& stream,
+                           int scale = 1, bool verbose=true, int index=-1 );
 #endif // wxUSE_STREAMS
 
     void SetName(const wxString& name) { m_name = name; }
@@ -260,6 +306,37 @@ public:
     }
 };
 
+//-----------------------------------------------------------------------------
+// wxImageRGBAData
+//-----------------------------------------------------------------------------
+
+// Read-only interleaved copy of the wxImage pixels, returned by
+// wxImage::GetRGBAData(). It is reference-counted and can be kept alive for
+// as long as needed, e.g. by the native objects using its data directly.
+class WXDLLIMPEXP_CORE wxImageRGBAData : public wxObject
+{
+public:
+    wxImageRGBAData() { }
+
+    bool IsOk() const { return m_refData != NULL; }
+
+    int GetWidth() const;
+    int GetHeight() const;
+    wxImageRGBAFormat GetFormat() const;
+
+    // Rows are stored without any padding, i.e. the stride is 4*GetWidth().
+    const unsigned char* GetData() const;
+
+private:
+    wxImageRGBAData(int width, int height, wxImageRGBAFormat format);
+
+    unsigned char* GetWritableData();
+
+    friend class WXDLLIMPEXP_FWD_CORE wxImage;
+
+    wxDECLARE_DYNAMIC_CLASS(wxImageRGBAData);
+};
+
 //-----------------------------------------------------------------------------
 // wxImage
 //-----------------------------------------------------------------------------
@@ -375,6 +452,13 @@ public:
     wxImage BlurHorizontal(int radius) const;
     wxImage BlurVertical(int radius) const;
 
+    // approximate Gaussian blur with the given standard deviation
+    wxImage GaussianBlur(double sigma) const;
+
+    // in-place versions of the blur functions, avoiding allocating a new image
+    wxImage& BlurInPlace(int radius);
+    wxImage& GaussianBlurInPlace(double sigma);
+
     wxImage ShrinkBy( int xFactor , int yFactor ) const ;
 
     // rescales the image in place
@@ -466,6 +550,12 @@ public:
     void SetLoadFlags(int flags);
     int GetLoadFlags() const;
 
+    // Number of threads used by the image processing functions, 1 by default
+    // meaning that they're not parallelized at all and 0 meaning to use as
+    // many threads as there are CPUs.
+    static void SetThreadCount(int count);
+    static int GetThreadCount();
+
     static bool CanRead( const wxString& name );
     static int GetImageCount( const wxString& name, wxBitmapType type = wxBITMAP_TYPE_ANY );
     virtual bool LoadFile( const wxString& name, wxBitmapType type = wxBITMAP_TYPE_ANY, int index = -1 );
@@ -476,6 +566,14 @@ public:
     static int GetImageCount( wxInputStream& stream, wxBitmapType type = wxBITMAP_TYPE_ANY );
     virtual bool LoadFile( wxInputStream& stream, wxBitmapType type = wxBITMAP_TYPE_ANY, int index = -1 );
     virtual bool LoadFile( wxInputStream& stream, const wxString& mimetype, int index = -1 );
+
+    // progressive loading of (parts of) huge images, possibly reducing them
+    static bool LoadRows( wxImageRowSink& sink, wxInputStream& stream,
+                          int scale = 1,
+                          wxBitmapType type = wxBITMAP_TYPE_ANY, int index = -1 );
+    bool LoadFileRegion( wxInputStream& stream, const wxRect& rect,
+                         int scale = 1,
+                         wxBitmapType type = wxBITMAP_TYPE_ANY, int index = -1 );
 #endif
 
     virtual bool SaveFile( const wxString& name ) const;
@@ -505,12 +603,20 @@ public:
 
     // these functions provide fastest access to wxImage data but should be
     // used carefully as no checks are done
+    // the non-const overloads discard the data cached by GetRGBAData() as
+    // the returned pointers may be used to modify the image
+    unsigned char *GetData();
     unsigned char *GetData() const;
     void SetData( unsigned char *data, bool static_data=false );
     void SetData( unsigned char *data, int new_width, int new_height, bool static_data=false );
 
+    // return the pixels in the given interleaved format, the result is cached
+    // until the image is modified, so calling this function again is cheap
+    wxImageRGBAData GetRGBAData(wxImageRGBAFormat format) const;
+
+    unsigned char *GetAlpha();          // may return NULL!
     unsigned char *GetAlpha() const;    // may return NULL!
-    bool HasAlpha() const { return GetAlpha() != NULL; }
+    bool HasAlpha() const;
     void SetAlpha(unsigned char *alpha = NULL, bool static_data=false);
     void InitAlpha();
     void ClearAlpha();
@@ -649,9 +755,17 @@ protected:
     virtual wxObjectRefData* CreateRefData() const wxOVERRIDE;
     virtual wxObjectRefData* CloneRefData(const wxObjectRefData* data) const wxOVERRIDE;
 
+    // Call AllocExclusive() and discard the data cached by GetRGBAData(),
+    // must be used by all functions modifying the image.
+    void AllocExclusiveAndInvalidate();
+
 private:
     friend class WXDLLIMPEXP_FWD_CORE wxImageHandler;
 
+    // Discard the data cached by GetRGBAData(), must be called whenever the
+    // image data may be modified.
+    void InvalidateRGBAData();
+
     // Possible values for MakeEmptyClone() flags.
     enum
     {
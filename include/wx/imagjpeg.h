@@ -37,6 +37,8 @@ public:
 
 #if wxUSE_STREAMS
     virtual bool LoadFile( wxImage *image, wxInputStream& stream, bool verbose=true, int index=-1 ) wxOVERRIDE;
+    virtual bool LoadRows( wxImageRowSink& sink, wxInputStream& stream,
+                           int scale = 1, bool verbose=true, int index=-1 ) wxOVERRIDE;
     virtual bool SaveFile( wxImage *image, wxOutputStream& stream, bool verbose=true ) wxOVERRIDE;
 protected:
     virtual bool DoCanRead( wxInputStream& stream ) wxOVERRIDE;
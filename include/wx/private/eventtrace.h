@@ -0,0 +1,74 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        wx/private/eventtrace.h
+// Purpose:     Helper for recording the events processing with wxEventTracer
+// Author:      wxWidgets team
+// Created:     2026-10-18
+// Copyright:   (c) 2026 wxWidgets team
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _WX_PRIVATE_EVENTTRACE_H_
+#define _WX_PRIVATE_EVENTTRACE_H_
+
+#include "wx/event.h"
+
+class wxEventTraceBuffer;
+
+// ----------------------------------------------------------------------------
+// wxEventTraceScope: records the activity during its lifetime
+// ----------------------------------------------------------------------------
+
+// Objects of this class are created on the stack by the code processing the
+// events and add a record to wxEventTracer buffer when they're destroyed, if
+// the tracer was running when they were created. Otherwise they don't do
+// anything and are cheap to create.
+//
+// This class is exported as it's also used by the event loops in wxCore.
+class WXDLLIMPEXP_BASE wxEventTraceScope
+{
+public:
+    // Record processing of the given event by the given handler. Only the
+    // outermost ProcessEvent() call for the event is recorded, i.e. nothing
+    // is done if it is being propagated to another handler.
+    wxEventTraceScope(const wxEvtHandler* handler, wxEvent& event)
+    {
+        m_buffer = NULL;
+
+        if ( wxEventTracer::IsRunning() && !event.m_wasProcessed )
+            Init(handler, event);
+    }
+
+    // Record an activity not corresponding to any single event, unless the
+    // second argument is false, which is convenient for skipping the record
+    // when there turns out to be nothing to do.
+    explicit wxEventTraceScope(wxEventTraceKind kind, bool record = true)
+    {
+        m_buffer = NULL;
+
+        if ( record && wxEventTracer::IsRunning() )
+            Init(kind);
+    }
+
+    ~wxEventTraceScope()
+    {
+        if ( m_buffer )
+            Finish();
+    }
+
+    // Return the time to store in wxEvent::m_queuedTime when queuing it.
+    static wxUint32 GetQueuedTime();
+
+private:
+    void Init(const wxEvtHandler* handler, wxEvent& event);
+    void Init(wxEventTraceKind kind);
+    void Finish();
+
+    // The buffer to add the record to or NULL if we're not recording.
+    wxEventTraceBuffer* m_buffer;
+
+    wxEventTraceRecord m_record;
+
+    wxDECLARE_NO_COPY_CLASS(wxEventTraceScope);
+};
+
+#endif // _WX_PRIVATE_EVENTTRACE_H_
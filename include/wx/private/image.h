@@ -0,0 +1,111 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        wx/private/image.h
+// Purpose:     Private wxImage helpers
+// Author:      wxWidgets team
+// Created:     2026-10-18
+// Copyright:   (c) 2026 wxWidgets team
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _WX_PRIVATE_IMAGE_H_
+#define _WX_PRIVATE_IMAGE_H_
+
+#include "wx/defs.h"
+
+#if wxUSE_IMAGE
+
+#include "wx/image.h"
+#include "wx/vector.h"
+
+// ----------------------------------------------------------------------------
+// Resampling kernels selection
+// ----------------------------------------------------------------------------
+
+// Implementations of the kernels used by wxImage::ResampleBilinear() and
+// wxImage::ResampleBicubic(). All of them produce exactly the same results,
+// the scalar one is the reference implementation used when no other one is
+// available.
+enum wxImageResampleImpl
+{
+    wxIMAGE_RESAMPLE_IMPL_DEFAULT,  // The best one available at run-time.
+    wxIMAGE_RESAMPLE_IMPL_SCALAR,   // Portable C++ implementation.
+    wxIMAGE_RESAMPLE_IMPL_SSE2,     // x86 SSE2, always available on x86-64.
+    wxIMAGE_RESAMPLE_IMPL_AVX,      // x86 AVX, selected if the CPU has it.
+    wxIMAGE_RESAMPLE_IMPL_NEON,     // ARM64 Advanced SIMD.
+
+    wxIMAGE_RESAMPLE_IMPL_MAX
+};
+
+// Return true if the given implementation was compiled in and can be used on
+// the current CPU.
+WXDLLIMPEXP_CORE bool wxImageIsResampleImplAvailable(wxImageResampleImpl impl);
+
+// Return the short human-readable name of the given implementation.
+WXDLLIMPEXP_CORE const char* wxImageGetResampleImplName(wxImageResampleImpl impl);
+
+// Return the implementation which is currently used, never returns
+// wxIMAGE_RESAMPLE_IMPL_DEFAULT.
+WXDLLIMPEXP_CORE wxImageResampleImpl wxImageGetResampleImpl();
+
+// Force using the given implementation, which must be available, or revert to
+// the default one. Returns the previously used implementation.
+//
+// This function is not thread-safe and is only supposed to be used by the
+// tests and benchmarks comparing the different implementations.
+WXDLLIMPEXP_CORE wxImageResampleImpl
+wxImageSetResampleImpl(wxImageResampleImpl impl);
+
+// ----------------------------------------------------------------------------
+// Helpers for wxImageHandler::LoadRows() implementations
+// ----------------------------------------------------------------------------
+
+// Sink reducing the image by the given factor, by averaging the blocks of
+// scale*scale pixels, before passing it to another sink. If the size of the
+// image is not a multiple of the scale, the last row and column of the
+// reduced image use the incomplete blocks.
+//
+// Using this sink with the scale of 1 is allowed and simply forwards all the
+// data to the real sink.
+class wxImageRowReducer : public wxImageRowSink
+{
+public:
+    wxImageRowReducer(wxImageRowSink& sink, int scale);
+
+    virtual bool OnBegin(int width, int height, bool hasAlpha) wxOVERRIDE;
+    virtual bool OnRows(int y, int count,
+                        const unsigned char* data,
+                        const unsigned char* alpha) wxOVERRIDE;
+
+private:
+    // Pass the row of the reduced image accumulated so far to the sink.
+    bool FlushRow();
+
+    wxImageRowSink& m_sink;
+    const int m_scale;
+
+    // Size of the original image and the width of the reduced one.
+    int m_width,
+        m_height,
+        m_widthReduced;
+    bool m_hasAlpha;
+
+    // Number of the original rows accumulated in m_sums so far and the index
+    // of the next row of the reduced image.
+    int m_rowsAccumulated,
+        m_yReduced;
+
+    // Sums of the R, G, B and alpha values for each pixel of the reduced row.
+    wxVector<wxUint32> m_sums;
+
+    // The reduced row itself.
+    wxVector<unsigned char> m_data,
+                            m_alpha;
+};
+
+// Pass the entire image to the sink, used when the image can't be loaded
+// progressively. If the image has a mask, it is converted to alpha.
+bool wxSendImageToRowSink(const wxImage& image, wxImageRowSink& sink);
+
+#endif // wxUSE_IMAGE
+
+#endif // _WX_PRIVATE_IMAGE_H_
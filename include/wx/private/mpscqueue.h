@@ -0,0 +1,193 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        wx/private/mpscqueue.h
+// Purpose:     Helpers for intrusive lock-free multiple producers queues
+// Author:      wxWidgets team
+// Created:     2026-10-18
+// Copyright:   (c) 2026 wxWidgets team
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _WX_PRIVATE_MPSCQUEUE_H_
+#define _WX_PRIVATE_MPSCQUEUE_H_
+
+#include "wx/defs.h"
+
+// ----------------------------------------------------------------------------
+// Atomic compare-and-swap operations
+// ----------------------------------------------------------------------------
+
+// Both functions below atomically replace the value with the desired one if
+// it's equal to the expected one and return true if they did it. They also
+// act as full memory barriers, which is relied upon by the code using them.
+
+#if !wxUSE_THREADS
+
+template <typename T>
+inline bool wxAtomicCompareExchangePtr(T* volatile& ptr, T* expected, T* desired)
+{
+    if ( ptr != expected )
+        return false;
+
+    ptr = desired;
+    return true;
+}
+
+inline bool
+wxAtomicCompareExchange(wxUint32 volatile& value, wxUint32 expected, wxUint32 desired)
+{
+    if ( value != expected )
+        return false;
+
+    value = desired;
+    return true;
+}
+
+#elif defined(HAVE_GCC_ATOMIC_BUILTINS)
+
+template <typename T>
+inline bool wxAtomicCompareExchangePtr(T* volatile& ptr, T* expected, T* desired)
+{
+    return __sync_bool_compare_and_swap(&ptr, expected, desired);
+}
+
+inline bool
+wxAtomicCompareExchange(wxUint32 volatile& value, wxUint32 expected, wxUint32 desired)
+{
+    return __sync_bool_compare_and_swap(&value, expected, desired);
+}
+
+#elif defined(__WINDOWS__)
+
+#include "wx/msw/wrapwin.h"
+
+template <typename T>
+inline bool wxAtomicCompareExchangePtr(T* volatile& ptr, T* expected, T* desired)
+{
+    return InterlockedCompareExchangePointer((PVOID volatile*)&ptr,
+                                             desired, expected) == expected;
+}
+
+inline bool
+wxAtomicCompareExchange(wxUint32 volatile& value, wxUint32 expected, wxUint32 desired)
+{
+    return (wxUint32)InterlockedCompareExchange((LONG volatile*)&value,
+                                                (LONG)desired,
+                                                (LONG)expected) == expected;
+}
+
+#elif defined(__DARWIN__)
+
+#include "libkern/OSAtomic.h"
+
+template <typename T>
+inline bool wxAtomicCompareExchangePtr(T* volatile& ptr, T* expected, T* desired)
+{
+    return OSAtomicCompareAndSwapPtrBarrier(expected, desired,
+                                            (void* volatile*)&ptr);
+}
+
+inline bool
+wxAtomicCompareExchange(wxUint32 volatile& value, wxUint32 expected, wxUint32 desired)
+{
+    return OSAtomicCompareAndSwap32Barrier(expected, desired,
+                                           (volatile int32_t*)&value);
+}
+
+#else // unknown platform
+
+#include "wx/thread.h"
+
+// Defined in src/common/event.cpp, this lock serializes all the operations
+// below when we don't have any native atomic operations.
+extern wxCriticalSection& wxGetAtomicCompareExchangeLock();
+
+template <typename T>
+inline bool wxAtomicCompareExchangePtr(T* volatile& ptr, T* expected, T* desired)
+{
+    wxCriticalSectionLocker lock(wxGetAtomicCompareExchangeLock());
+
+    if ( ptr != expected )
+        return false;
+
+    ptr = desired;
+    return true;
+}
+
+inline bool
+wxAtomicCompareExchange(wxUint32 volatile& value, wxUint32 expected, wxUint32 desired)
+{
+    wxCriticalSectionLocker lock(wxGetAtomicCompareExchangeLock());
+
+    if ( value != expected )
+        return false;
+
+    value = desired;
+    return true;
+}
+
+#define wxNEEDS_ATOMIC_COMPARE_EXCHANGE_LOCK
+
+#endif // platforms
+
+// ----------------------------------------------------------------------------
+// Intrusive multiple producers, single consumer queue
+// ----------------------------------------------------------------------------
+
+// The queue is represented by a single pointer to its most recently added
+// element and each element points to the one added before it using the
+// member specified by the "next" parameter of the functions below, so adding
+// an element doesn't need to allocate anything.
+//
+// Elements can be added by any number of threads concurrently, while only a
+// single thread at a time can retrieve them, which it does by taking all of
+// them at once. This avoids the ABA problem entirely, as no element is ever
+// removed from the queue individually.
+
+// Add an element to the queue, may be called from any thread.
+template <typename T>
+inline void wxMPSCQueuePush(T* volatile& head, T* item, T* T::*next)
+{
+    for ( ;; )
+    {
+        T* const top = head;
+        item->*next = top;
+
+        if ( wxAtomicCompareExchangePtr(head, top, item) )
+            break;
+    }
+}
+
+// Remove all the elements from the queue and return the first one of them,
+// i.e. the one added before all the others, or NULL if the queue is empty.
+// The returned elements are linked in the order in which they were added and
+// the last one of them is returned in the output parameter.
+//
+// Only the consumer thread may call this function.
+template <typename T>
+inline T* wxMPSCQueueTakeAll(T* volatile& head, T* T::*next, T** last)
+{
+    T* top;
+    do
+    {
+        top = head;
+        if ( !top )
+            return NULL;
+    }
+    while ( !wxAtomicCompareExchangePtr(head, top, static_cast<T*>(NULL)) );
+
+    // The elements are linked from the most recently added one, reverse them.
+    *last = top;
+
+    T* first = NULL;
+    while ( top )
+    {
+        T* const prev = top->*next;
+        top->*next = first;
+        first = top;
+        top = prev;
+    }
+
+    return first;
+}
+
+#endif // _WX_PRIVATE_MPSCQUEUE_H_
@@ -0,0 +1,551 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        wx/taskexecutor.h
+// Purpose:     wxTaskExecutor thread pool and wxTaskFuture class
+// Author:      wxWidgets team
+// Created:     2026-10-18
+// Copyright:   (c) 2026 wxWidgets team
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _WX_TASKEXECUTOR_H_
+#define _WX_TASKEXECUTOR_H_
+
+#include "wx/defs.h"
+
+#if wxUSE_THREADS
+
+#include "wx/atomic.h"
+#include "wx/thread.h"
+#include "wx/vector.h"
+#include "wx/weakref.h"
+
+class WXDLLIMPEXP_FWD_BASE wxTaskExecutor;
+class wxTaskWorker;
+class wxTaskMainThreadHandler;
+
+template <typename T> class wxTaskFuture;
+
+// Priorities of the tasks: the tasks with higher priority are always started
+// before the tasks with lower priority which are already queued.
+enum wxTaskPriority
+{
+    wxTASK_PRIORITY_LOW,
+    wxTASK_PRIORITY_NORMAL,
+    wxTASK_PRIORITY_HIGH
+};
+
+// The state of a task, the last 3 states are final.
+enum wxTaskState
+{
+    wxTASK_PENDING,
+    wxTASK_RUNNING,
+    wxTASK_DONE,
+    wxTASK_CANCELLED,
+    wxTASK_FAILED
+};
+
+// ----------------------------------------------------------------------------
+// wxTaskContinuation: action executed when a task finishes (private)
+// ----------------------------------------------------------------------------
+
+class WXDLLIMPEXP_BASE wxTaskContinuation
+{
+public:
+    explicit wxTaskContinuation(bool inMainThread)
+        : m_next(NULL),
+          m_inMainThread(inMainThread)
+    {
+    }
+
+    virtual ~wxTaskContinuation() { }
+
+    virtual void Run() = 0;
+
+    bool IsInMainThread() const { return m_inMainThread; }
+
+private:
+    // Links the continuations of the same task together and, later, the
+    // continuations waiting for being executed in the main thread.
+    wxTaskContinuation* m_next;
+
+    const bool m_inMainThread;
+
+    friend class wxTaskBase;
+    friend class wxTaskExecutor;
+
+    wxDECLARE_NO_COPY_CLASS(wxTaskContinuation);
+};
+
+// ----------------------------------------------------------------------------
+// wxTaskBase: a task submitted to wxTaskExecutor (private)
+// ----------------------------------------------------------------------------
+
+// This class is reference-counted as it is shared by the executor, all the
+// futures referring to the task and its continuations.
+class WXDLLIMPEXP_BASE wxTaskBase
+{
+public:
+    void IncRef() { wxAtomicInc(m_refCount); }
+    void DecRef()
+    {
+        if ( !wxAtomicDec(m_refCount) )
+            delete this;
+    }
+
+    wxTaskState GetState() const { return static_cast<wxTaskState>(m_state); }
+    bool IsDone() const { return GetState() >= wxTASK_DONE; }
+
+    // Cancel the task if it hasn't started yet, or ask it to stop if it's
+    // already running. Returns true if the task was cancelled.
+    bool Cancel();
+
+    // Block until the task finishes.
+    void Wait();
+
+    // Take ownership of the continuation and execute it when the task
+    // finishes or immediately if it had already finished.
+    void AddContinuation(wxTaskContinuation* continuation);
+
+protected:
+    wxTaskBase(wxTaskExecutor* executor, wxTaskPriority priority);
+    virtual ~wxTaskBase();
+
+    // Execute the task and store its result.
+    virtual void DoRun() = 0;
+
+private:
+    // Run the task unless it was cancelled, called by the worker threads.
+    void Run();
+
+    // Dispatch all the continuations and wake up the waiting threads once the
+    // task has reached its final state.
+    void Finish();
+
+    // Return true once Finish() has dispatched all the continuations.
+    bool IsFinished() const { return m_finished != 0; }
+
+    // Execute or schedule the given continuation and the ones linked to it.
+    void DispatchContinuations(wxTaskContinuation* continuations);
+
+
+    wxTaskExecutor* const m_executor;
+    const wxTaskPriority m_priority;
+
+    wxAtomicInt m_refCount;
+
+    // wxTaskState value, only changed atomically.
+    wxUint32 volatile m_state;
+
+    // wxTaskCancelRequest value indicating whether cancelling the task was
+    // requested while it was running and whether the task noticed it.
+    wxUint32 volatile m_cancelRequested;
+
+    // Stack of the continuations to execute when the task finishes, set to a
+    // special value once this happens.
+    wxTaskContinuation* volatile m_continuations;
+
+    // Set to 1 by Finish() after dispatching the continuations, Wait() only
+    // returns once this happens and not as soon as the task is done.
+    wxUint32 volatile m_finished;
+
+    friend class wxTaskExecutor;
+    friend class wxTaskWorker;
+
+    wxDECLARE_NO_COPY_CLASS(wxTaskBase);
+};
+
+// Task with a result of type T.
+template <typename T>
+class wxTaskResult : public wxTaskBase
+{
+public:
+    // Return the result or T() if the task didn't finish successfully.
+    T GetResult() const
+    {
+        wxCHECK_MSG( GetState() == wxTASK_DONE, T(),
+                     "task didn't finish successfully" );
+
+        return *m_result;
+    }
+
+protected:
+    wxTaskResult(wxTaskExecutor* executor, wxTaskPriority priority)
+        : wxTaskBase(executor, priority),
+          m_result(NULL)
+    {
+    }
+
+    virtual ~wxTaskResult() { delete m_result; }
+
+    void SetResult(const T& result) { m_result = new T(result); }
+
+private:
+    // Allocated only once the task finishes, so that T doesn't need to be
+    // default-constructible unless wxTaskFuture::Get() is used.
+    T* m_result;
+};
+
+template <>
+class wxTaskResult<void> : public wxTaskBase
+{
+protected:
+    wxTaskResult(wxTaskExecutor* executor, wxTaskPriority priority)
+        : wxTaskBase(executor, priority)
+    {
+    }
+};
+
+// Task executing the given functor.
+template <typename T, typename F>
+class wxTaskFunctor : public wxTaskResult<T>
+{
+public:
+    wxTaskFunctor(wxTaskExecutor* executor, F func, wxTaskPriority priority)
+        : wxTaskResult<T>(executor, priority),
+          m_func(func)
+    {
+    }
+
+protected:
+    virtual void DoRun() wxOVERRIDE { this->SetResult(m_func()); }
+
+private:
+    F m_func;
+};
+
+template <typename F>
+class wxTaskFunctor<void, F> : public wxTaskResult<void>
+{
+public:
+    wxTaskFunctor(wxTaskExecutor* executor, F func, wxTaskPriority priority)
+        : wxTaskResult<void>(executor, priority),
+          m_func(func)
+    {
+    }
+
+protected:
+    virtual void DoRun() wxOVERRIDE { m_func(); }
+
+private:
+    F m_func;
+};
+
+// ----------------------------------------------------------------------------
+// wxTaskFuture: handle to the result of a task
+// ----------------------------------------------------------------------------
+
+template <typename T>
+class wxTaskFuture
+{
+public:
+    wxTaskFuture() : m_task(NULL) { }
+
+    explicit wxTaskFuture(wxTaskResult<T>* task)
+        : m_task(task)
+    {
+        if ( m_task )
+            m_task->IncRef();
+    }
+
+    wxTaskFuture(const wxTaskFuture& other)
+        : m_task(other.m_task)
+    {
+        if ( m_task )
+            m_task->IncRef();
+    }
+
+    wxTaskFuture& operator=(const wxTaskFuture& other)
+    {
+        if ( other.m_task )
+            other.m_task->IncRef();
+        if ( m_task )
+            m_task->DecRef();
+
+        m_task = other.m_task;
+
+        return *this;
+    }
+
+    ~wxTaskFuture()
+    {
+        if ( m_task )
+            m_task->DecRef();
+    }
+
+    bool IsValid() const { return m_task != NULL; }
+
+    wxTaskState GetState() const
+    {
+        wxCHECK_MSG( m_task, wxTASK_FAILED, "invalid future" );
+
+        return m_task->GetState();
+    }
+
+    bool IsDone() const { return GetState() >= wxTASK_DONE; }
+    bool IsCancelled() const { return GetState() == wxTASK_CANCELLED; }
+
+    bool Cancel() const
+    {
+        wxCHECK_MSG( m_task, false, "invalid future" );
+
+        return m_task->Cancel();
+    }
+
+    void Wait() const
+    {
+        wxCHECK_RET( m_task, "invalid future" );
+
+        m_task->Wait();
+    }
+
+    // Wait for the task to finish and return its result, can't be used for
+    // the futures of void tasks. Returns T() if the task was cancelled or
+    // failed.
+    T Get() const
+    {
+        wxCHECK_MSG( m_task, T(), "invalid future" );
+
+        m_task->Wait();
+
+        return m_task->GetResult();
+    }
+
+    // Execute the functor, taking the future as argument, when the task
+    // finishes, in the thread finishing it.
+    template <typename F>
+    void Then(F func) const;
+
+    // Execute the functor, taking the future as argument, in the main thread
+    // after the task finishes.
+    template <typename F>
+    void ThenInMainThread(F func) const;
+
+    // Call the given method of the handler in the main thread after the task
+    // finishes, unless the handler is destroyed before this happens. This
+    // overload can only be used from the main thread.
+    template <typename H>
+    void ThenInMainThread(H* handler,
+                          void (H::*method)(const wxTaskFuture<T>&)) const;
+
+private:
+    void DoAddContinuation(wxTaskContinuation* continuation) const
+    {
+        if ( !m_task )
+        {
+            delete continuation;
+            wxFAIL_MSG( "invalid future" );
+            return;
+        }
+
+        m_task->AddContinuation(continuation);
+    }
+
+    wxTaskResult<T>* m_task;
+};
+
+// ----------------------------------------------------------------------------
+// Continuations implementations (private)
+// ----------------------------------------------------------------------------
+
+template <typename T, typename F>
+class wxTaskFunctorContinuation : public wxTaskContinuation
+{
+public:
+    wxTaskFunctorContinuation(const wxTaskFuture<T>& future,
+                              F func,
+                              bool inMainThread)
+        : wxTaskContinuation(inMainThread),
+          m_future(future),
+          m_func(func)
+    {
+    }
+
+    virtual void Run() wxOVERRIDE { m_func(m_future); }
+
+private:
+    const wxTaskFuture<T> m_future;
+    F m_func;
+};
+
+template <typename T, typename H>
+class wxTaskMethodContinuation : public wxTaskContinuation
+{
+public:
+    typedef void (H::*Method)(const wxTaskFuture<T>&);
+
+    wxTaskMethodContinuation(const wxTaskFuture<T>& future,
+                             H* handler,
+                             Method method)
+        : wxTaskContinuation(true),
+          m_future(future),
+          m_handler(handler),
+          m_method(method)
+    {
+    }
+
+    virtual void Run() wxOVERRIDE
+    {
+        if ( m_handler )
+            (m_handler.get()->*m_method)(m_future);
+    }
+
+private:
+    const wxTaskFuture<T> m_future;
+    wxWeakRef<H> m_handler;
+    const Method m_method;
+};
+
+template <typename T>
+template <typename F>
+inline void wxTaskFuture<T>::Then(F func) const
+{
+    DoAddContinuation(new wxTaskFunctorContinuation<T, F>(*this, func, false));
+}
+
+template <typename T>
+template <typename F>
+inline void wxTaskFuture<T>::ThenInMainThread(F func) const
+{
+    DoAddContinuation(new wxTaskFunctorContinuation<T, F>(*this, func, true));
+}
+
+template <typename T>
+template <typename H>
+inline void
+wxTaskFuture<T>::ThenInMainThread(H* handler,
+                                  void (H::*method)(const wxTaskFuture<T>&)) const
+{
+    wxASSERT_MSG( wxThread::IsMain(),
+                  "handler can only be used from the main thread" );
+
+    DoAddContinuation(new wxTaskMethodContinuation<T, H>(*this, handler, method));
+}
+
+// ----------------------------------------------------------------------------
+// wxTaskExecutor: work-stealing thread pool
+// ----------------------------------------------------------------------------
+
+class WXDLLIMPEXP_BASE wxTaskExecutor
+{
+public:
+    // Create the executor with the given number of worker threads or with
+    // one thread per CPU if it is 0.
+    explicit wxTaskExecutor(unsigned numThreads = 0);
+
+    // Cancel all the pending tasks and wait until the running ones finish.
+    ~wxTaskExecutor();
+
+    // Return the executor shared by the entire application, created on demand.
+    static wxTaskExecutor& Get();
+
+    // Return true if the task being executed by the current thread was asked
+    // to stop by wxTaskFuture::Cancel().
+    static bool IsCurrentTaskCancelled();
+
+
+    unsigned GetThreadCount() const
+        { return static_cast<unsigned>(m_workers.size()); }
+
+    // Submit the functor returning T for execution in a worker thread.
+    template <typename T, typename F>
+    wxTaskFuture<T> Submit(F func, wxTaskPriority priority = wxTASK_PRIORITY_NORMAL)
+    {
+        wxTaskResult<T>* const
+            task = new wxTaskFunctor<T, F>(this, func, priority);
+
+        const wxTaskFuture<T> future(task);
+        DoSubmit(task);
+
+        return future;
+    }
+
+    // Set the maximal time, in milliseconds, spent executing the main thread
+    // continuations in one go, with the rest of them being executed later,
+    // when the application is idle. 0 means no limit.
+    void SetMainThreadTimeSlice(long ms) { m_mainThreadTimeSlice = ms; }
+
+    // Execute the main thread continuations of the tasks which have finished,
+    // this is done automatically and only needs to be called when not running
+    // the event loop. Returns the number of the continuations executed.
+    size_t ProcessMainThreadContinuations();
+
+private:
+    // Queue the task, taking ownership of the reference to it.
+    void DoSubmit(wxTaskBase* task);
+
+    // Find the next task to execute by the given worker, taking it either
+    // from its own queue or from the other workers ones, or return NULL.
+    wxTaskBase* FindTask(wxTaskWorker* worker);
+
+    // Block until there are any queued tasks, return false if the executor
+    // is being destroyed instead.
+    bool WaitForTasks();
+
+    bool HasQueuedTasks() const;
+
+    // Run the task found by FindTask() and release it.
+    void RunTask(wxTaskWorker* worker, wxTaskBase* task);
+
+    // Run the other tasks until the given one finishes, called by the worker
+    // thread waiting for this task.
+    void HelpUntilDone(wxTaskWorker* worker, wxTaskBase* task);
+
+    // Wake up the threads waiting for any task to finish.
+    void NotifyTaskDone();
+
+    // Wake up the workers waiting in HelpUntilDone() after submitting a task.
+    void NotifyHelpers();
+
+    // Queue the continuation for execution in the main thread.
+    void PostToMainThread(wxTaskContinuation* continuation);
+
+
+    wxVector<wxTaskWorker*> m_workers;
+
+    // Counter used to select the worker for the next task submitted from
+    // outside of the worker threads.
+    wxAtomicInt m_nextWorker;
+
+    // The number of tasks of each priority in all the workers queues and the
+    // number of the workers waiting for new tasks to appear.
+    wxAtomicInt m_numQueued[wxTASK_PRIORITY_HIGH + 1];
+    wxAtomicInt m_numSleeping;
+    wxMutex m_sleepMutex;
+    wxCondition m_sleepCondition;
+
+    // Set when the executor is being destroyed.
+    bool volatile m_shuttingDown;
+
+    // The number of threads blocked in wxTaskBase::Wait() and the condition
+    // they wait on. The workers waiting in HelpUntilDone() are counted in
+    // m_numHelpers too, as they also need to be woken up when a new task is
+    // submitted, to run it.
+    wxAtomicInt m_numWaiters;
+    wxAtomicInt m_numHelpers;
+    wxMutex m_doneMutex;
+    wxCondition m_doneCondition;
+
+    // Continuations to execute in the main thread: the ones added by the
+    // other threads and those already taken from them but not executed yet.
+    wxTaskContinuation* volatile m_mainQueue;
+    wxTaskContinuation* m_mainFirst;
+    wxTaskContinuation* m_mainLast;
+
+    // Non-zero if a call to ProcessMainThreadContinuations() is scheduled.
+    wxUint32 volatile m_mainScheduled;
+
+    long m_mainThreadTimeSlice;
+
+    // Handler calling ProcessMainThreadContinuations() later.
+    wxTaskMainThreadHandler* m_mainThreadHandler;
+
+    friend class wxTaskBase;
+    friend class wxTaskWorker;
+    friend class wxTaskMainThreadHandler;
+
+    wxDECLARE_NO_COPY_CLASS(wxTaskExecutor);
+};
+
+#endif // wxUSE_THREADS
+
+#endif // _WX_TASKEXECUTOR_H_
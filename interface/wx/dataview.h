@@ -52,6 +52,12 @@
     - wxDataViewModel::ItemsDeleted,
     - wxDataViewModel::ItemsChanged.
 
+    When many notifications of different kinds have to be sent, e.g. when
+    updating the model from a stream of incoming data, they can be grouped
+    together by calling wxDataViewModel::BeginBatch() before them and
+    wxDataViewModel::EndBatch() after them, allowing the control to update
+    itself only once.
+
     Note that Cleared() can be called for all changes involving many, or all,
     of the model items and not only for deleting all of them (i.e. clearing the
     model).
@@ -110,6 +116,29 @@ public:
     */
     void AddNotifier(wxDataViewModelNotifier* notifier);
 
+    /**
+        Starts a batch of notifications.
+
+        All the notifications sent until the matching call to EndBatch() may
+        be coalesced by the controls associated with this model, e.g. the
+        generic wxDataViewCtrl inserts all the items added during the batch
+        into its tree at once and refreshes itself only when the batch ends.
+        Because of this, the control may not reflect the changes to the model
+        before EndBatch() is called.
+
+        The calls to this function can be nested, in which case only the
+        outermost pair of BeginBatch() and EndBatch() calls is taken into
+        account.
+
+        Consider using wxDataViewBatchUpdater instead of calling this function
+        and EndBatch() directly to ensure that they are always matched.
+
+        @see IsInBatch(), wxDataViewModelNotifier::BeginBatch()
+
+        @since 3.1.6
+    */
+    void BeginBatch();
+
     /**
         Change the value of the given item and update the control to reflect
         it.
@@ -146,6 +175,13 @@ public:
     */
     bool Cleared();
 
+    /**
+        Ends a batch of notifications started by BeginBatch().
+
+        @since 3.1.6
+    */
+    void EndBatch();
+
     /**
         The compare function to be used by the control. The default compare
         function sorts most data types implemented by wxVariant (i.e. bool,
@@ -323,6 +359,14 @@ public:
     */
     virtual bool IsContainer(const wxDataViewItem& item) const = 0;
 
+    /**
+        Returns @true if BeginBatch() was called without the matching
+        EndBatch() yet.
+
+        @since 3.1.6
+    */
+    bool IsInBatch() const;
+
     /**
         Call this to inform the model that an item has been added to the data.
     */
@@ -388,6 +432,24 @@ public:
                           const wxDataViewItem& item,
                           unsigned int col) = 0;
 
+    /**
+        Override this to return @true if Compare() is not overridden.
+
+        If this function returns @true, the generic wxDataViewCtrl sorts the
+        items by a column by retrieving their values in this column only once,
+        instead of calling Compare(), which retrieves two values for every
+        comparison, and, for big numbers of items, uses several threads to
+        sort them. The resulting order is the same as with the default
+        Compare() implementation, as long as the items values are all of the
+        same type among "string", "long", "double", "bool", "datetime" and
+        "wxDataViewIconText". Otherwise Compare() is used as usual.
+
+        The default implementation returns @false.
+
+        @since 3.1.6
+    */
+    virtual bool UsesDefaultCompare() const;
+
     /**
         Call this to inform this model that a value in the model has been changed.
         This is also called from wxDataViewCtrl's internal editing code, e.g. when
@@ -437,6 +499,46 @@ protected:
 };
 
 
+/**
+    @class wxDataViewBatchUpdater
+
+    Helper calling wxDataViewModel::BeginBatch() in its constructor and
+    wxDataViewModel::EndBatch() in its destructor.
+
+    This ensures that the batch is ended even if an exception is thrown or the
+    function returns early, e.g.:
+    @code
+    void MyModel::AddMany(const wxArrayString& names)
+    {
+        wxDataViewBatchUpdater batch(this);
+
+        for ( size_t n = 0; n < names.size(); n++ )
+            ItemAdded(wxDataViewItem(), DoAdd(names[n]));
+    }
+    @endcode
+
+    @library{wxcore}
+    @category{dvc}
+
+    @since 3.1.6
+*/
+class wxDataViewBatchUpdater
+{
+public:
+    /**
+        Start a batch of notifications for the given model.
+
+        The model must remain alive for the lifetime of this object.
+    */
+    explicit wxDataViewBatchUpdater(wxDataViewModel* model);
+
+    /**
+        Ends the batch started by the constructor.
+    */
+    ~wxDataViewBatchUpdater();
+};
+
+
 
 /**
     @class wxDataViewListModel
@@ -1780,11 +1882,32 @@ public:
     */
     virtual ~wxDataViewModelNotifier();
 
+    /**
+        Called by owning model when a batch of notifications starts.
+
+        If the notifier is added to the model during a batch, this function is
+        called immediately. The default implementation does nothing.
+
+        @see wxDataViewModel::BeginBatch()
+
+        @since 3.1.6
+    */
+    virtual void BeginBatch();
+
     /**
         Called by owning model.
     */
     virtual bool Cleared() = 0;
 
+    /**
+        Called by owning model when a batch of notifications ends.
+
+        The default implementation does nothing.
+
+        @since 3.1.6
+    */
+    virtual void EndBatch();
+
     /**
         Get owning wxDataViewModel.
     */
@@ -361,6 +361,225 @@ public:
 
 #if wxUSE_BASE
 
+/**
+    The kinds of the activities recorded by wxEventTracer.
+
+    @since 3.1.6
+*/
+enum wxEventTraceKind
+{
+    /// Processing of a single event by wxEvtHandler::ProcessEvent().
+    wxEVENT_TRACE_PROCESS,
+
+    /// Processing of all the pending events by wxApp.
+    wxEVENT_TRACE_PENDING_EVENTS,
+
+    /// Sending idle events from the event loop.
+    wxEVENT_TRACE_IDLE
+};
+
+/**
+    A single record of wxEventTracer.
+
+    @library{wxbase}
+    @category{events}
+
+    @since 3.1.6
+*/
+struct wxEventTraceRecord
+{
+    /// The kind of the recorded activity.
+    wxEventTraceKind kind;
+
+    /**
+        The type of the processed event.
+
+        This field and the next two ones are only used for the records of
+        wxEVENT_TRACE_PROCESS kind.
+     */
+    wxEventType eventType;
+
+    /// The class of the processed event.
+    const wxClassInfo* eventClass;
+
+    /// The class of the handler the event was sent to.
+    const wxClassInfo* handlerClass;
+
+    /**
+        The thread in which the activity took place.
+
+        This field only exists when @c wxUSE_THREADS is 1.
+     */
+    wxThreadIdType threadId;
+
+    /// The start time in microseconds since wxEventTracer::Start() call.
+    wxUint64 start;
+
+    /// The duration of the activity in microseconds.
+    wxUint32 duration;
+
+    /**
+        The time in microseconds between queuing the event and starting to
+        process it.
+
+        Only valid if @c wasQueued is @true.
+     */
+    wxUint32 queueLatency;
+
+    /// True if the event was queued using wxEvtHandler::QueueEvent().
+    bool wasQueued;
+};
+
+/**
+    @class wxEventTracer
+
+    Records the events processing for finding the slow event handlers.
+
+    When this tracer is running, it records the duration of every event
+    processing, i.e. of each wxEvtHandler::ProcessEvent() call, as well as of
+    the processing of all pending events and idle events by the event loop.
+    For the events posted using wxEvtHandler::QueueEvent(), it also records
+    the time they spent in the queue.
+
+    Nested calls to ProcessEvent(), i.e. processing other events from inside
+    an event handler, produce separate records. However propagating the event
+    to the parent window or to the other handlers in the chain doesn't, and
+    only the first ProcessEvent() call is recorded for the events processed
+    more than once, just as wxEventFilter only filters them once.
+
+    The records are stored in a fixed size ring buffer keeping only the most
+    recent ones, so that the tracer can be left running for a long time.
+    Events can be processed and recorded by several threads concurrently
+    without any locking.
+
+    The records can be retrieved using GetRecords() or exported in the
+    Chrome trace event format, which can be loaded into @c chrome://tracing or
+    other compatible trace viewers, e.g.:
+    @code
+        wxEventTracer::Start();
+
+        ... reproduce the problem ...
+
+        wxEventTracer::Stop();
+        wxEventTracer::SaveChromeTrace("events.json");
+    @endcode
+
+    When the tracer is not running, the overhead of checking for it while
+    processing events is negligible.
+
+    All functions of this class except IsRunning() should be only called from
+    the main thread.
+
+    @library{wxbase}
+    @category{events}
+
+    @since 3.1.6
+*/
+class wxEventTracer
+{
+public:
+    /**
+        Start recording.
+
+        Any existing records are discarded.
+
+        @param capacity The maximal number of records to keep, rounded up to
+            the next power of 2.
+     */
+    static void Start(size_t capacity = 65536);
+
+    /**
+        Stop recording.
+
+        The existing records are kept and can still be retrieved.
+     */
+    static void Stop();
+
+    /**
+        Return @true if the tracer was started and not stopped since then.
+     */
+    static bool IsRunning();
+
+    /**
+        Discard all the existing records.
+
+        The other threads may keep processing events while this function is
+        called, the records added by them concurrently may or may not be
+        discarded.
+     */
+    static void Clear();
+
+    /**
+        Return all the existing records.
+
+        The records are returned in the order in which the corresponding
+        activities ended, so records of the nested events come before the
+        records of the events during whose processing they happened.
+     */
+    static wxVector<wxEventTraceRecord> GetRecords();
+
+    /**
+        Return all the existing records in Chrome trace event JSON format.
+
+        Each record is represented by a complete ("X" phase) event. The event
+        type, the class of the handler and, for the queued events, the queue
+        latency are stored in its arguments.
+     */
+    static wxString GetChromeTrace();
+
+    /**
+        Save the result of GetChromeTrace() into the given file.
+
+        Returns @false if writing to the file failed.
+
+        This function is only available if @c wxUSE_FFILE is 1.
+     */
+    static bool SaveChromeTrace(const wxString& filename);
+};
+
+/**
+    Statistics of the dynamic event handlers lookups.
+
+    An object of this type is returned by wxEvtHandler::GetDispatchStats(),
+    see wxEvtHandler::EnableDispatchStats() for more details.
+
+    @library{wxbase}
+    @category{events}
+
+    @since 3.1.6
+*/
+struct wxEventDispatchStats
+{
+    /**
+        Default constructor initializes all values to 0.
+     */
+    wxEventDispatchStats();
+
+    /**
+        Number of searches for a dynamically bound handler for an event.
+
+        A search is done whenever an event is processed by a wxEvtHandler
+        having any handlers bound to it using Bind().
+     */
+    wxUint64 searches;
+
+    /**
+        Total number of the dynamically bound handlers examined by all the
+        searches.
+
+        For the objects with many handlers, only the handlers for the type of
+        the event being processed are examined, so this number doesn't depend
+        on the number of the handlers for the other events. All the handlers
+        are examined for the objects with just a few of them.
+     */
+    wxUint64 handlersScanned;
+
+    /**
+        Maximal number of the handlers examined by a single search.
+     */
+    size_t maxHandlersScanned;
+};
+
 /**
     @class wxEvtHandler
 
@@ -417,7 +636,9 @@ public:
 
         QueueEvent() can be used for inter-thread communication from the worker
         threads to the main thread, it is safe in the sense that it uses
-        locking internally and avoids the problem mentioned in AddPendingEvent()
+        atomic operations internally, so that many threads can queue events
+        concurrently without blocking each other, and avoids the problem
+        mentioned in AddPendingEvent()
         documentation by ensuring that the @a event object is not used by the
         calling thread any more. Care should still be taken to avoid that some
         fields of this object are used by it, notably any wxString members of
@@ -484,6 +705,62 @@ public:
     */
     virtual void AddPendingEvent(const wxEvent& event);
 
+    /**
+        Queue an event replacing the previously queued event with the same key.
+
+        This function works like QueueEvent(), but if an event with the same
+        @a key had been queued using this function before and hadn't been
+        processed yet, it is deleted and @a event is processed instead of it.
+        The new event is processed at the position of the event it replaces in
+        the queue, i.e. the events queued between them are processed after it.
+
+        This is useful for the events representing the current state of
+        something, e.g. the progress of an operation performed by a worker
+        thread: as only the last of such events needs to be processed, the
+        main thread has to process at most one of them for each key, however
+        often they are queued.
+
+        Just as QueueEvent(), this function takes ownership of @a event and can
+        be called from any thread.
+
+        @param key
+            Any value identifying the events replacing each other, the keys
+            are specific to this handler.
+        @param event
+            A heap-allocated event to be queued, this function takes ownership
+            of it.
+
+        @since 3.1.6
+    */
+    void QueueCoalescedEvent(wxUIntPtr key, wxEvent* event);
+
+    /**
+        Process all pending events of the given type together.
+
+        After calling this function, all events of the given type queued for
+        this handler, using QueueEvent(), QueueCoalescedEvent() or
+        AddPendingEvent(), are not processed individually any more. Instead,
+        whenever one of them would be processed, it is processed together
+        with all the other pending events of the same type as a single
+        wxBatchEvent containing all of them.
+
+        This allows to handle high-rate updates from worker threads, e.g. to
+        update the GUI just once for all of them, without any changes to the
+        code posting them.
+
+        This function should be called from the main thread before any events
+        of the given type are queued.
+
+        @param eventType
+            The type of the events to process together.
+        @param enable
+            @true to enable processing the events in batches or @false to
+            disable it.
+
+        @since 3.1.6
+    */
+    void EnableBatchedEvents(wxEventType eventType, bool enable = true);
+
     /**
          Asynchronously call the given method.
 
@@ -1214,6 +1491,46 @@ public:
 
     //@}
 
+
+    /**
+        @name Dispatch statistics.
+
+        Methods for measuring the cost of finding the event handlers bound
+        using Bind().
+     */
+    //@{
+
+    /**
+        Start or stop collecting the dispatch statistics.
+
+        When enabled, the number of the dynamically bound event handlers
+        examined while processing each event is counted and can be retrieved
+        using GetDispatchStats(). This is disabled by default and has
+        negligible overhead when it is.
+
+        The events processed in all threads are taken into account.
+
+        @since 3.1.6
+     */
+    static void EnableDispatchStats(bool enable = true);
+
+    /**
+        Return the dispatch statistics collected since the program start or
+        the last call to ResetDispatchStats().
+
+        @since 3.1.6
+     */
+    static wxEventDispatchStats GetDispatchStats();
+
+    /**
+        Reset all the dispatch statistics values to 0.
+
+        @since 3.1.6
+     */
+    static void ResetDispatchStats();
+
+    //@}
+
 protected:
     /**
         Method called by ProcessEvent() before examining this object event
@@ -3615,6 +3932,63 @@ public:
 };
 
 
+/**
+    @class wxBatchEvent
+
+    This event contains several pending events of the same type processed
+    together.
+
+    It is generated instead of the events of the types for which
+    wxEvtHandler::EnableBatchedEvents() was called and contains all events of
+    this type pending for the handler, in the order in which they were queued.
+
+    @beginEventTable{wxBatchEvent}
+    @event{EVT_BATCH(func)}
+        Process a @c wxEVT_BATCH event.
+    @endEventTable
+
+    @library{wxbase}
+    @category{events,threading}
+
+    @see wxEvtHandler::EnableBatchedEvents()
+
+    @since 3.1.6
+*/
+class wxBatchEvent : public wxEvent
+{
+public:
+    /**
+        Constructor creates an empty batch of events of the given type.
+    */
+    wxBatchEvent(wxEventType batchedEventType = wxEVT_NULL);
+
+    /**
+        Returns the type of the events in this batch.
+    */
+    wxEventType GetBatchedEventType() const;
+
+    /**
+        Returns the events in this batch.
+
+        The events are owned by this object and are deleted when it is, so
+        their addresses must not be used after the handler returns.
+    */
+    const wxVector<wxEvent*>& GetEvents() const;
+
+    /**
+        Adds an event to this batch.
+
+        This object takes ownership of the event.
+    */
+    void AddEvent(wxEvent* event);
+
+    /**
+        Returns the category of the events in this batch.
+    */
+    virtual wxEventCategory GetEventCategory() const;
+};
+
+
 /**
     @class wxHelpEvent
 
@@ -5078,6 +5452,7 @@ wxEventType wxEVT_TOOL_ENTER;
 wxEventType wxEVT_COMBOBOX_DROPDOWN;
 wxEventType wxEVT_COMBOBOX_CLOSEUP;
 wxEventType wxEVT_THREAD;
+wxEventType wxEVT_BATCH;
 wxEventType wxEVT_LEFT_DOWN;
 wxEventType wxEVT_LEFT_UP;
 wxEventType wxEVT_MIDDLE_DOWN;
@@ -108,6 +108,38 @@ public:
                                   wxGridCellAttr& attr,
                                   wxDC& dc);
 
+    /**
+        Get the maximal best width of the given cells of the same column.
+
+        This function may be overridden in the derived class to measure the
+        best width of many cells at once more efficiently than by calling
+        GetBestWidth() for each of them, e.g. wxGridCellStringRenderer
+        implements it by measuring the text of all cells together. The base
+        class version returns ::wxDefaultCoord, indicating that this is not
+        supported.
+
+        Note that this method is only used when auto-sizing the columns for
+        which wxGridTableBase::CanMeasureColUsingSameAttr() returns @true, as
+        all the cells are supposed to use the same @a attr. Also notice that
+        if you override GetBestSize() in a class deriving from
+        wxGridCellStringRenderer, you need to override this function too,
+        e.g. to just return ::wxDefaultCoord.
+
+        @param grid The grid containing the cells.
+        @param attr The attribute used by all the cells.
+        @param dc The DC to use for measuring.
+        @param rows The rows of the cells to measure, all of them shown.
+        @param col The column of the cells.
+        @return The maximal best width of all cells or ::wxDefaultCoord.
+
+        @since 3.1.6
+     */
+    virtual int GetMaxBestWidth(wxGrid& grid,
+                                wxGridCellAttr& attr,
+                                wxDC& dc,
+                                const wxArrayInt& rows,
+                                int col);
+
 protected:
     /**
         Helper function setting the correct colours and font.
@@ -1939,6 +1971,295 @@ public:
     wxString GetCornerLabelValue() const;
 };
 
+/**
+    Data table storing the values of each column contiguously using the type
+    of this column.
+
+    Unlike wxGridStringTable, which stores all values as strings, this table
+    stores the numbers and booleans in their native format, using only as
+    much memory as necessary for them, and the strings are stored only once
+    per column even if they are used in many cells. This makes it suitable
+    for storing big amounts of data, especially as the entire column can be
+    filled with a single SetColumnData() call.
+
+    The type of each column is returned by GetTypeName(), so the grid uses
+    the appropriate renderer and editor for it, and the values can be
+    accessed both as strings and using GetValueAsLong() and similar
+    functions corresponding to the column type. The numbers are converted
+    to and from strings using the C locale, and setting a string which is
+    not a valid number as the value of a numeric cell leaves it unchanged,
+    while setting an empty string resets it to 0.
+
+    Notice that, as with any other table, the grid is not notified about the
+    changes to the values done directly in the table, so you need to
+    refresh it after calling SetColumnData() or SetColumnType().
+
+    @since 3.1.6
+ */
+class wxGridColumnarTable : public wxGridTableBase
+{
+public:
+    /// Possible types of the columns.
+    enum ColumnType
+    {
+        Type_String,    ///< Strings, used by default.
+        Type_Long,      ///< Integer numbers.
+        Type_Double,    ///< Floating point numbers.
+        Type_Bool       ///< Boolean values.
+    };
+
+    /**
+        Default constructor creates an empty table.
+     */
+    wxGridColumnarTable();
+
+    /**
+        Adds a new column of the given type.
+
+        All values of the column are initially 0, @false or empty.
+
+        Notice that the generic InsertCols() and AppendCols() functions
+        always add string columns, use this function to add typed ones.
+
+        @param type
+            The type of the values stored in the new column.
+        @param label
+            The label of the new column, if empty, the default one is used.
+        @return
+            The index of the new column.
+     */
+    int AppendColumn(ColumnType type, const wxString& label = wxString());
+
+    /**
+        Changes the type of an existing column.
+
+        All the values of the column are reset to the default ones.
+     */
+    void SetColumnType(int col, ColumnType type);
+
+    /**
+        Returns the type of the given column.
+     */
+    ColumnType GetColumnType(int col) const;
+
+    /**
+        Sets the values of several consecutive rows of the column at once.
+
+        The rows must already exist, i.e. @a firstRow + @a count must be at
+        most equal to the number of rows in the table, use AppendRows() to
+        add them if necessary. The type of the values must correspond to the
+        column type, i.e. the overload taking @c long values can be only used
+        with the columns of @c Type_Long type and so on.
+
+        @return
+            @true if the values were set or @false if the column doesn't exist,
+            has a different type or doesn't have enough rows.
+     */
+    bool SetColumnData(int col, const long *values, size_t count,
+                       size_t firstRow = 0);
+
+    /// @overload
+    bool SetColumnData(int col, const double *values, size_t count,
+                       size_t firstRow = 0);
+
+    /// @overload
+    bool SetColumnData(int col, const bool *values, size_t count,
+                       size_t firstRow = 0);
+
+    /// @overload
+    bool SetColumnData(int col, const wxArrayString& values,
+                       size_t firstRow = 0);
+
+    virtual int GetNumberRows();
+    virtual int GetNumberCols();
+    virtual wxString GetValue( int row, int col );
+    virtual void SetValue( int row, int col, const wxString& s );
+
+    virtual bool IsEmptyCell( int row, int col );
+
+    virtual wxString GetTypeName( int row, int col );
+    virtual bool CanGetValueAs( int row, int col, const wxString& typeName );
+    virtual bool CanSetValueAs( int row, int col, const wxString& typeName );
+
+    virtual long GetValueAsLong( int row, int col );
+    virtual double GetValueAsDouble( int row, int col );
+    virtual bool GetValueAsBool( int row, int col );
+
+    virtual void SetValueAsLong( int row, int col, long value );
+    virtual void SetValueAsDouble( int row, int col, double value );
+    virtual void SetValueAsBool( int row, int col, bool value );
+
+    virtual void GetValuesAsString( const wxGridBlockCoords& block,
+                                    wxArrayString& values );
+
+    void Clear();
+    bool InsertRows( size_t pos = 0, size_t numRows = 1 );
+    bool AppendRows( size_t numRows = 1 );
+    bool DeleteRows( size_t pos = 0, size_t numRows = 1 );
+    bool InsertCols( size_t pos = 0, size_t numCols = 1 );
+    bool AppendCols( size_t numCols = 1 );
+    bool DeleteCols( size_t pos = 0, size_t numCols = 1 );
+
+    void SetRowLabelValue( int row, const wxString& );
+    void SetColLabelValue( int col, const wxString& );
+    void SetCornerLabelValue( const wxString& );
+    wxString GetRowLabelValue( int row );
+    wxString GetColLabelValue( int col );
+    wxString GetCornerLabelValue() const;
+};
+
+/**
+    A key used for sorting the rows of wxGridSortedTable.
+
+    @since 3.1.6
+ */
+struct wxGridSortKey
+{
+    /// Constructor initializes all the fields.
+    wxGridSortKey(int col = -1, bool ascending = true);
+
+    /// The column whose values are compared.
+    int col;
+
+    /// Whether the values are sorted in ascending or descending order.
+    bool ascending;
+};
+
+/**
+    A vector of the sort keys, the first one being the primary key.
+
+    @since 3.1.6
+ */
+typedef wxVector<wxGridSortKey> wxGridSortKeys;
+
+/**
+    Data table showing the rows of another table in sorted order.
+
+    This table forwards all the calls to the source table, only mapping the
+    row indices using the current sort order, so sorting it doesn't copy nor
+    modify any data and the mapping of the rows costs constant time.
+
+    The rows are sorted using the values of the cells retrieved by
+    GetValueAsLong(), GetValueAsDouble() or GetValueAsBool() if the source
+    table supports them for the sort key column, e.g. for the numeric
+    columns of wxGridColumnarTable, and by comparing the strings returned by
+    GetValue() otherwise.
+
+    The tables with many rows are sorted in a background thread: the current
+    order is kept until the sort is done and then the grid using this table
+    is refreshed. Notice that the values of the cells are retrieved in the
+    main thread before starting sorting, so the source table doesn't need to
+    be thread-safe.
+
+    Typical use of this class is to sort the rows when a column header is
+    clicked:
+    @code
+    wxGridSortedTable* table = new wxGridSortedTable(new MyTable, true);
+    grid->SetTable(table, true);
+    grid->Bind(wxEVT_GRID_COL_SORT,
+               [=](wxGridEvent& event) {
+                    const int col = event.GetCol();
+                    table->Sort(col, !(grid->IsSortingBy(col) &&
+                                       grid->IsSortOrderAscending()));
+               });
+    @endcode
+
+    Inserting or appending rows using this table keeps the current sort
+    order and sort keys, with the new rows shown at the position where they
+    were inserted, use Sort() again to move them to their sorted positions.
+    Deleting rows keeps the sort order too, the rows deleted from the source
+    table are those shown at the given positions. Changing the number of
+    columns, except when they are appended, resets the sort order.
+    Notice that the rows and columns must not be added or removed directly
+    in the source table while it's used by this one.
+
+    The attributes of the cells and rows are stored in the source table too,
+    so they move together with the rows when they are sorted.
+
+    @since 3.1.6
+ */
+class wxGridSortedTable : public wxGridTableBase
+{
+public:
+    /**
+        Constructor takes the table containing the data.
+
+        @param table
+            The source table, must be non-@NULL.
+        @param takeOwnership
+            If @true, the source table is deleted by this object.
+     */
+    wxGridSortedTable(wxGridTableBase* table, bool takeOwnership = false);
+
+    /**
+        Returns the source table.
+     */
+    wxGridTableBase* GetSourceTable() const;
+
+    /**
+        Sorts the rows using the given keys.
+
+        The sort is stable, i.e. the rows for which all keys are equal keep
+        their original order in the source table.
+
+        If the table has at least GetBackgroundSortThreshold() rows, this
+        function returns immediately and the rows are sorted in a background
+        thread. Calling this function again, or CancelSort(), while this
+        happens cancels the previous sort.
+
+        When the new order is used, the sorting indicator of the grid showing
+        this table is updated to correspond to the primary sort key.
+     */
+    void Sort(const wxGridSortKeys& keys);
+
+    /**
+        Sorts the rows using the values of the single column.
+     */
+    void Sort(int col, bool ascending = true);
+
+    /**
+        Restores the original order of the rows.
+     */
+    void ResetSort();
+
+    /**
+        Cancels the background sort, if any.
+
+        The current order of the rows is kept.
+     */
+    void CancelSort();
+
+    /**
+        Returns @true if the rows are being sorted in background.
+     */
+    bool IsSorting() const;
+
+    /**
+        Returns the keys used for the last sort.
+
+        The returned vector is empty if the rows are not sorted.
+     */
+    const wxGridSortKeys& GetSortKeys() const;
+
+    /**
+        Sets the minimal number of rows for sorting them in background.
+
+        The default threshold is 100000 rows, 0 disables sorting in
+        background.
+     */
+    void SetBackgroundSortThreshold(size_t numRows);
+
+    /**
+        Returns the minimal number of rows for sorting them in background.
+     */
+    size_t GetBackgroundSortThreshold() const;
+
+    /**
+        Returns the row of the source table shown at the given row.
+     */
+    int GetSourceRow(int row) const;
+};
+
 /**
     Represents coordinates of a grid cell.
 
@@ -2464,6 +2785,23 @@ public:
     virtual void SetValueAsCustom(int row, int col, const wxString& typeName,
                                   void *value);
 
+    /**
+        Appends the values of all cells in the given block to the array.
+
+        The values are appended row by row, i.e. the value of the cell at
+        (@c row, @c col) of the block is at the index
+        @c (row - top) * width + (col - left) relatively to the initial
+        size of the array.
+
+        The default implementation simply calls GetValue() for each cell, but
+        it may be overridden to retrieve the values of many cells, e.g. all
+        the currently visible ones, more efficiently.
+
+        @since 3.1.6
+     */
+    virtual void GetValuesAsString(const wxGridBlockCoords& block,
+                                   wxArrayString& values);
+
     //@}
 
 
@@ -4069,6 +4407,95 @@ public:
     */
     void AutoSizeRows(bool setAsMin = true);
 
+    /**
+        Forget all the best sizes of the cells cached for auto-sizing.
+
+        Does nothing if the cache is not enabled.
+
+        @see EnableAutoSizeCache()
+
+        @since 3.1.6
+     */
+    void ClearAutoSizeCache();
+
+    /**
+        Enable or disable caching of the best sizes of the cells computed when
+        auto-sizing the columns or rows.
+
+        When the cache is enabled, auto-sizing a column or row again, e.g. by
+        calling AutoSizeColumns() whenever the grid contents changes, only
+        measures the cells which changed since the last time, or rather the
+        blocks of consecutive cells containing them, instead of measuring all
+        of them.
+
+        The grid itself invalidates the cached sizes of the cells modified
+        using its own functions, such as SetCellValue() or SetCellFont(), and
+        when inserting or deleting rows or columns, but if the table contents
+        or the cell attributes are changed directly, InvalidateCellAutoSize()
+        or ClearAutoSizeCache() must be called.
+
+        Notice that the cached best width of a cell is not updated when the
+        height of its row changes and vice versa, so the cache should not be
+        used with the renderers for which it matters, such as
+        wxGridCellAutoWrapStringRenderer, or ClearAutoSizeCache() must be
+        called after changing the rows or columns sizes.
+
+        The cache is disabled by default.
+
+        @since 3.1.6
+     */
+    void EnableAutoSizeCache(bool enable = true);
+
+    /**
+        Returns the limit on the number of cells measured when auto-sizing a
+        column or row.
+
+        @see SetAutoSizeMaxCells()
+
+        @since 3.1.6
+     */
+    int GetAutoSizeMaxCells() const;
+
+    /**
+        Invalidate the cached best size of the given cell.
+
+        If @a row is -1, the best sizes of all cells in the column @a col are
+        invalidated and, similarly, if @a col is -1, those of all cells in the
+        row @a row are. If both are -1, this function is the same as
+        ClearAutoSizeCache().
+
+        Does nothing if the cache is not enabled.
+
+        @see EnableAutoSizeCache()
+
+        @since 3.1.6
+     */
+    void InvalidateCellAutoSize(int row, int col);
+
+    /**
+        Returns @true if the best sizes of the cells are cached.
+
+        @see EnableAutoSizeCache()
+
+        @since 3.1.6
+     */
+    bool IsAutoSizeCacheEnabled() const;
+
+    /**
+        Limit the number of cells measured when auto-sizing a column or row.
+
+        If the column or row contains more than approximately @a maxCells
+        cells, only some blocks of consecutive cells, spread evenly over all
+        of it, are measured to determine its best size. This is much faster
+        for the very big grids, but may result in the column or row not being
+        big enough to fit all its cells.
+
+        The default value of 0 means that all cells are always measured.
+
+        @since 3.1.6
+     */
+    void SetAutoSizeMaxCells(int maxCells);
+
     /**
         Returns the cell fitting mode.
 
@@ -5120,6 +5547,25 @@ public:
     */
     void SelectRow(int row, bool addToSelected = false);
 
+    /**
+        Selects all the specified rows at once.
+
+        This function is equivalent to calling SelectRow() for all the rows,
+        which don't need to be sorted, but is much more efficient when there
+        are many of them. Notably, it generates a single
+        @c wxEVT_GRID_RANGE_SELECTED event for each range of consecutive rows,
+        instead of an event for each row.
+
+        If @a addToSelected is @false then any existing selection will be
+        deselected; if @true the rows will be added to the existing selection.
+
+        This method won't select anything if the current selection mode is
+        wxGridSelectColumns.
+
+        @since 3.1.6
+    */
+    void SelectRows(const wxArrayInt& rows, bool addToSelected = false);
+
     /**
         Set the colour to be used for drawing the selection background.
     */
@@ -5737,6 +6183,42 @@ public:
      */
     void RefreshAttr(int row, int col);
 
+    /**
+        Enable or disable caching the attributes and renderers of all cells.
+
+        By default, wxGrid only caches the attribute of the most recently
+        used cell, which means that the attribute of each cell, which may need
+        to be obtained by combining the cell, row and column attributes, and
+        the renderer for its type are looked up again every time the cell is
+        redrawn. Enabling this cache makes redrawing, and notably scrolling,
+        the grids using many attributes or custom data types faster, at the
+        price of using more memory.
+
+        The cache is updated automatically when the attributes are changed
+        using wxGrid methods, such as SetAttr() or SetCellBackgroundColour(),
+        or when rows or columns are inserted or deleted. If the attributes are
+        modified directly in the table or its attributes provider, RefreshAttr()
+        or ForceRefresh() must be called to invalidate the cache, as with the
+        cache of a single attribute.
+
+        Notice that only the attributes and renderers are cached, the cell
+        values are still retrieved from the table when drawing.
+
+        @see IsRenderCacheEnabled()
+
+        @since 3.1.6
+     */
+    void EnableRenderCache(bool enable = true);
+
+    /**
+        Return @true if the attributes cache used for drawing is enabled.
+
+        @see EnableRenderCache()
+
+        @since 3.1.6
+     */
+    bool IsRenderCacheEnabled() const;
+
     /**
         Draws part or all of a wxGrid on a wxDC for printing or display.
 
@@ -75,6 +75,31 @@ enum wxImageAlphaBlendMode
     wxIMAGE_ALPHA_BLEND_COMPOSE = 1
 };
 
+/**
+    Layouts of the interleaved pixel data returned by wxImage::GetRGBAData().
+
+    @since 3.1.6
+*/
+enum wxImageRGBAFormat
+{
+    /**
+        Each pixel is represented by 4 bytes: red, green, blue and alpha.
+
+        Colour components are not premultiplied by alpha. This is the layout
+        used by @c GdkPixbuf with alpha channel.
+     */
+    wxIMAGE_RGBA_STRAIGHT,
+
+    /**
+        Each pixel is represented by a 32 bit value in native byte order
+        with alpha in its most significant byte, followed by red, green and
+        blue components premultiplied by alpha.
+
+        This is the layout used by Cairo @c CAIRO_FORMAT_ARGB32 surfaces.
+     */
+    wxIMAGE_RGBA_PREMULTIPLIED
+};
+
 /**
     Possible values for PNG image type option.
 
@@ -142,6 +167,76 @@ enum
 };
 
 
+/**
+    @class wxImageRowSink
+
+    Receives the image data loaded progressively by wxImage::LoadRows().
+
+    Derive from this class and override its pure virtual functions to process
+    the image rows as soon as they are decoded, without having to keep the
+    entire image in memory. This is useful for processing very big images or
+    for showing the image while it's still being loaded.
+
+    @library{wxcore}
+    @category{gdi}
+
+    @see wxImage::LoadRows(), wxImageHandler::LoadRows()
+
+    @since 3.1.6
+*/
+class wxImageRowSink
+{
+public:
+    /**
+        Default constructor.
+    */
+    wxImageRowSink();
+
+    /**
+        Virtual destructor for the base class.
+    */
+    virtual ~wxImageRowSink();
+
+    /**
+        Called once, before any calls to OnRows().
+
+        @param width
+            The width of the image being loaded, taking the scale into account.
+        @param height
+            The height of the image being loaded, taking the scale into account.
+        @param hasAlpha
+            @true if the @c alpha parameter of OnRows() will be non-@NULL.
+        @return
+            @true to continue loading or @false to stop it.
+    */
+    virtual bool OnBegin(int width, int height, bool hasAlpha) = 0;
+
+    /**
+        Called with one or more consecutive rows of the image.
+
+        The rows are always passed in top to bottom order and each row is
+        passed exactly once.
+
+        @param y
+            The index of the first row.
+        @param count
+            The number of rows, at least 1.
+        @param data
+            RGB data of the rows, i.e. @c 3*width*count bytes. The pointer is
+            only valid during this call.
+        @param alpha
+            Alpha values of the rows, i.e. @c width*count bytes, or @NULL if
+            the image doesn't have alpha. The pointer is only valid during this
+            call.
+        @return
+            @true to continue loading or @false to stop it.
+    */
+    virtual bool OnRows(int y, int count,
+                        const unsigned char* data,
+                        const unsigned char* alpha) = 0;
+};
+
+
 /**
     @class wxImageHandler
 
@@ -283,6 +378,43 @@ public:
     virtual bool LoadFile(wxImage* image, wxInputStream& stream,
                           bool verbose = true, int index = -1);
 
+    /**
+        Loads the image from the stream progressively, passing its rows to the
+        given sink as soon as they are decoded.
+
+        The default implementation loads the entire image using LoadFile() and
+        then passes it to the sink. JPEG, PNG, BMP and TIFF handlers override
+        it to decode the image without storing it in memory entirely, except
+        in some cases (interlaced PNG, compressed BMP, TIFF with non-default
+        orientation) in which they fall back on the default implementation.
+
+        @param sink
+            The object receiving the image data.
+        @param stream
+            Opened input stream for reading image data.
+        @param scale
+            If greater than 1, the image is reduced by this factor, with each
+            pixel of the result being the average of @c scale*scale pixels of
+            the original image. The JPEG handler uses the decoder support for
+            scaling in this case, making loading faster. The size of the image
+            passed to the sink is rounded up, i.e. it's
+            @c (width+scale-1)/scale.
+        @param verbose
+            If set to @true, errors reported by the image handler will produce
+            wxLogMessages.
+        @param index
+            The index of the image in the file (starting from zero).
+
+        @return @true if the operation succeeded, @false if it failed or if
+            the sink stopped it.
+
+        @see wxImage::LoadRows()
+
+        @since 3.1.6
+    */
+    virtual bool LoadRows(wxImageRowSink& sink, wxInputStream& stream,
+                          int scale = 1, bool verbose = true, int index = -1);
+
     /**
         Saves an image in the output stream.
 
@@ -396,6 +528,62 @@ const unsigned char wxIMAGE_ALPHA_OPAQUE = 0xff;
 const unsigned char wxIMAGE_ALPHA_THRESHOLD = 0x80;
 
 
+/**
+    @class wxImageRGBAData
+
+    Interleaved representation of wxImage pixels.
+
+    Objects of this class are returned by wxImage::GetRGBAData() and contain
+    a read-only copy of the image data, in which colour and alpha values of
+    each pixel are stored together, as expected by many native APIs.
+
+    This class uses reference counting, so copying its objects is cheap and
+    the data remains valid for as long as at least one object referencing it
+    exists, even if the image it was created from is modified or destroyed.
+
+    @library{wxcore}
+    @category{gdi}
+
+    @since 3.1.6
+*/
+class wxImageRGBAData : public wxObject
+{
+public:
+    /**
+        Default constructor creates an invalid object.
+    */
+    wxImageRGBAData();
+
+    /**
+        Returns @true if the object contains data.
+    */
+    bool IsOk() const;
+
+    /**
+        Returns the width of the image.
+    */
+    int GetWidth() const;
+
+    /**
+        Returns the height of the image.
+    */
+    int GetHeight() const;
+
+    /**
+        Returns the format of the data.
+    */
+    wxImageRGBAFormat GetFormat() const;
+
+    /**
+        Returns the pointer to the pixel data.
+
+        The rows are stored from top to bottom without any padding, i.e. each
+        row takes exactly @c 4*GetWidth() bytes.
+    */
+    const unsigned char* GetData() const;
+};
+
+
 /**
     @class wxImage
 
@@ -812,6 +1000,47 @@ public:
     */
     wxImage BlurVertical(int blurRadius) const;
 
+    /**
+        Blurs the image in place in both horizontal and vertical directions.
+
+        This function does the same thing as Blur() but modifies this image
+        instead of returning a new one, which avoids allocating memory for
+        another image.
+
+        @see GaussianBlurInPlace()
+
+        @since 3.1.6
+    */
+    wxImage& BlurInPlace(int blurRadius);
+
+    /**
+        Returns an approximately Gaussian blurred version of the image.
+
+        The blur is approximated by several successive box blurs, which makes
+        its cost independent of @a sigma, unlike a real Gaussian filter. As
+        with Blur(), this should not be used when using a single mask colour
+        for transparency.
+
+        @param sigma
+            Standard deviation of the Gaussian function, in pixels, must be
+            non-negative. Blurring with zero standard deviation returns the
+            copy of the image.
+
+        @see GaussianBlurInPlace()
+
+        @since 3.1.6
+    */
+    wxImage GaussianBlur(double sigma) const;
+
+    /**
+        Blurs the image in place using an approximately Gaussian filter.
+
+        This is the in-place version of GaussianBlur().
+
+        @since 3.1.6
+    */
+    wxImage& GaussianBlurInPlace(double sigma);
+
     /**
         Returns a mirrored copy of the image.
         The parameter @a horizontally indicates the orientation.
@@ -1121,7 +1350,12 @@ public:
         This pointer is @NULL for the images without the alpha channel. If the image
         does have it, this pointer may be used to directly manipulate the alpha values
         which are stored as the RGB ones.
+
+        Only the pointer returned by the non-const overload, which discards
+        the data cached by GetRGBAData(), should be used for this, the non-const
+        overload is new since wxWidgets 3.1.6.
     */
+    unsigned char* GetAlpha();
     unsigned char* GetAlpha() const;
 
     /**
@@ -1135,9 +1369,43 @@ public:
         row, with second row following after it and so on.
 
         You should not delete the returned pointer nor pass it to SetData().
+
+        Only the pointer returned by the non-const overload, which discards
+        the data cached by GetRGBAData(), should be used for modifying the
+        image, the non-const overload is new since wxWidgets 3.1.6.
     */
+    unsigned char* GetData();
     unsigned char* GetData() const;
 
+    /**
+        Returns the image pixels in the given interleaved format.
+
+        The returned data is cached by the image, so calling this function
+        again for the same format is cheap, until the image is modified. It is
+        used when converting the image to the native bitmaps under wxGTK and
+        to wxGraphicsBitmap when using Cairo, which use this data directly
+        without copying it, so converting the same image several times only
+        converts its data once.
+
+        Alpha values are set to ::wxIMAGE_ALPHA_OPAQUE if the image doesn't
+        have alpha channel. The mask, if any, is ignored.
+
+        Note that calling non-const overloads of GetData() or GetAlpha()
+        discards the cached data, as it can be modified using the returned
+        pointers, and so does calling any other functions modifying the image.
+        However the data modified using the pointers obtained before calling
+        this function is not taken into account, so GetData() or GetAlpha()
+        must be called again before modifying the image data directly. The
+        const overloads don't discard the cached data and the pointers
+        returned by them must not be used for modifying the image.
+
+        This function can be called for the images sharing the same data from
+        several threads concurrently.
+
+        @since 3.1.6
+    */
+    wxImageRGBAData GetRGBAData(wxImageRGBAFormat format) const;
+
     /**
         Return alpha value at given pixel location.
     */
@@ -1516,6 +1784,66 @@ public:
     virtual bool LoadFile(wxInputStream& stream, const wxString& mimetype,
                           int index = -1);
 
+    /**
+        Loads an image progressively, passing its rows to the sink.
+
+        This function allows to process the image without creating the
+        wxImage object for it, which can be much more efficient for big
+        images, see wxImageHandler::LoadRows() for more details.
+
+        @param sink
+            The object receiving the image data.
+        @param stream
+            Opened input stream from which to load the image.
+        @param scale
+            Optional factor by which the image should be reduced.
+        @param type
+            See the description in the LoadFile(wxInputStream&, wxBitmapType, int) overload.
+        @param index
+            See the description in the LoadFile(wxInputStream&, wxBitmapType, int) overload.
+
+        @return @true if the operation succeeded, @false if it failed or if
+            the sink stopped it.
+
+        @since 3.1.6
+    */
+    static bool LoadRows(wxImageRowSink& sink,
+                         wxInputStream& stream,
+                         int scale = 1,
+                         wxBitmapType type = wxBITMAP_TYPE_ANY,
+                         int index = -1);
+
+    /**
+        Loads only the given part of the image.
+
+        This function uses LoadRows() to avoid storing the entire image in
+        memory and stops reading the stream as soon as the last row of the
+        region is loaded.
+
+        @param stream
+            Opened input stream from which to load the image.
+        @param rect
+            The region of the (possibly scaled) image to load. It is
+            intersected with the image bounds and an empty rectangle means
+            loading the entire image.
+        @param scale
+            Optional factor by which the image should be reduced before
+            extracting the region from it.
+        @param type
+            See the description in the LoadFile(wxInputStream&, wxBitmapType, int) overload.
+        @param index
+            See the description in the LoadFile(wxInputStream&, wxBitmapType, int) overload.
+
+        @return @true if the operation succeeded, @false otherwise.
+
+        @since 3.1.6
+    */
+    bool LoadFileRegion(wxInputStream& stream,
+                        const wxRect& rect,
+                        int scale = 1,
+                        wxBitmapType type = wxBITMAP_TYPE_ANY,
+                        int index = -1);
+
     /**
         Saves an image in the given stream.
 
@@ -1675,6 +2003,33 @@ public:
      */
     static void SetDefaultLoadFlags(int flags);
 
+    /**
+        Sets the number of threads used by the image processing functions.
+
+        By default, all image processing happens in the calling thread. When
+        a greater number of threads is specified, the functions Rescale(),
+        Scale(), Blur(), BlurHorizontal(), BlurVertical(), Rotate90(),
+        ConvertToGreyscale() and ConvertToDisabled() split big images into
+        bands of rows or columns which are processed by a pool of worker
+        threads, reused by all these functions, in parallel. The results are
+        always exactly the same as when using a single thread.
+
+        Small images are still processed in the calling thread, as are the
+        images processed while the thread pool is already busy, e.g. when
+        these functions are called from several threads at once.
+
+        @param count
+            The total number of threads to use, including the calling one,
+            1 to disable parallel processing (this is the default) or 0 to
+            use as many threads as there are CPUs in the system, see
+            wxThread::GetCPUCount().
+
+        @see GetThreadCount()
+
+        @since 3.1.6
+     */
+    static void SetThreadCount(int count);
+
     /**
         Sets the flags used for loading image files by this object.
 
@@ -1957,6 +2312,15 @@ public:
      */
     static int GetDefaultLoadFlags();
 
+    /**
+        Returns the number of threads used by the image processing functions.
+
+        This is the value set by SetThreadCount(), 1 by default.
+
+        @since 3.1.6
+     */
+    static int GetThreadCount();
+
     //@{
     /**
         If the image file contains more than one image and the image handler is
@@ -0,0 +1,331 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        wx/taskexecutor.h
+// Purpose:     interface of wxTaskExecutor and wxTaskFuture<T>
+// Author:      wxWidgets team
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+    Priorities of the tasks executed by wxTaskExecutor.
+
+    Queued tasks with higher priority are always started before the queued
+    tasks with lower priority, but the tasks which are already running are
+    never interrupted.
+
+    @since 3.1.6
+    @category{threading}
+ */
+enum wxTaskPriority
+{
+    wxTASK_PRIORITY_LOW,
+    wxTASK_PRIORITY_NORMAL,
+    wxTASK_PRIORITY_HIGH
+};
+
+/**
+    The state of a task submitted to wxTaskExecutor.
+
+    @since 3.1.6
+    @category{threading}
+ */
+enum wxTaskState
+{
+    /// The task is queued and didn't start running yet.
+    wxTASK_PENDING,
+
+    /// The task is being executed by one of the worker threads.
+    wxTASK_RUNNING,
+
+    /// The task has finished successfully and its result is available.
+    wxTASK_DONE,
+
+    /**
+        The task was cancelled.
+
+        This happens either when it is cancelled before starting to run, or
+        if it was running and wxTaskExecutor::IsCurrentTaskCancelled() returned
+        @true for it. The result of the cancelled task is not available.
+     */
+    wxTASK_CANCELLED,
+
+    /// The task has thrown an exception.
+    wxTASK_FAILED
+};
+
+/**
+    Handle to the result of a task submitted to wxTaskExecutor.
+
+    Objects of this class are returned by wxTaskExecutor::Submit() and can be
+    freely copied, all the copies refer to the same task. The task itself
+    continues running even if all the futures referring to it are destroyed.
+
+    All methods of this class, except for ThenInMainThread() overload taking
+    an event handler, can be used from any thread.
+
+    @tparam T
+        The type of the task result. It must be copyable and may be @c void
+        if the task doesn't return anything, in which case Get() can't be used.
+
+    @since 3.1.6
+
+    @library{wxbase}
+    @category{threading}
+
+    @see wxTaskExecutor
+ */
+template <typename T>
+class wxTaskFuture<T>
+{
+public:
+    /**
+        Default constructor creates an invalid future.
+
+        Invalid futures can only be assigned to, all the other methods must
+        not be called for them.
+     */
+    wxTaskFuture();
+
+    /**
+        Returns @true if this future refers to a task.
+     */
+    bool IsValid() const;
+
+    /**
+        Returns the current state of the task.
+     */
+    wxTaskState GetState() const;
+
+    /**
+        Returns @true if the task has finished running, whether successfully or
+        not.
+     */
+    bool IsDone() const;
+
+    /**
+        Returns @true if the task was cancelled.
+     */
+    bool IsCancelled() const;
+
+    /**
+        Cancel the task.
+
+        If the task didn't start running yet, it is cancelled immediately and
+        will never run. Otherwise, if it's currently running, it is asked to
+        stop: the task code should check wxTaskExecutor::IsCurrentTaskCancelled()
+        periodically for this to have any effect. The running task is only
+        considered to be cancelled if it does this, otherwise it finishes
+        normally and its result is available.
+
+        Cancelling a task which has already finished doesn't do anything.
+
+        @return @true if the task was cancelled before it could start running,
+            @false if it is already running or has finished.
+     */
+    bool Cancel() const;
+
+    /**
+        Block until the task finishes.
+
+        When called from a task running in the same executor, the current
+        worker thread executes the other queued tasks while waiting, so that
+        tasks waiting for the results of other tasks don't deadlock.
+
+        When this function returns, all the continuations added with Then()
+        before the task finished have been executed and all the continuations
+        added with ThenInMainThread() have been queued for execution.
+     */
+    void Wait() const;
+
+    /**
+        Wait for the task to finish and return its result.
+
+        The task must have finished successfully, i.e. it must be in
+        wxTASK_DONE state after finishing. If it was cancelled or failed, this
+        function asserts and returns a default-constructed value, so @c T must
+        be default-constructible for this function to be used.
+     */
+    T Get() const;
+
+    /**
+        Execute the given functor when the task finishes.
+
+        The functor is called with this future as its only argument in the
+        thread finishing the task, which is one of the worker threads if the
+        task runs, or the thread calling Cancel() if it is cancelled before
+        starting. If the task has already finished, the functor is called
+        immediately.
+
+        Any exceptions thrown by the functor are ignored.
+     */
+    template <typename F>
+    void Then(F func) const;
+
+    /**
+        Execute the given functor in the main thread after the task finishes.
+
+        The functor is called with this future as its only argument. It is
+        executed asynchronously, when the application processes its pending
+        events, even if the task has already finished.
+
+        Notice that, as with wxEvtHandler::CallAfter(), the objects used by
+        the functor must remain alive until it is called.
+     */
+    template <typename F>
+    void ThenInMainThread(F func) const;
+
+    /**
+        Call the given method of the handler in the main thread after the task
+        finishes.
+
+        This overload is similar to the one taking a functor, but the method
+        is not called at all if the handler is destroyed before the task
+        finishes. It can only be used from the main thread.
+     */
+    template <typename H>
+    void ThenInMainThread(H* handler,
+                          void (H::*method)(const wxTaskFuture<T>&)) const;
+};
+
+/**
+    Thread pool executing tasks in the worker threads.
+
+    wxTaskExecutor runs a fixed number of worker threads executing the tasks
+    submitted to it with Submit(). A task is any copyable functor taking no
+    arguments, its return value, if any, can be retrieved using the
+    wxTaskFuture returned by Submit(). For example:
+    @code
+    struct CountWords
+    {
+        explicit CountWords(const wxString& text) : m_text(text) { }
+
+        int operator()() const { ... count the words in m_text ... }
+
+        wxString m_text;
+    };
+
+    void MyFrame::StartCounting()
+    {
+        wxTaskFuture<int>
+            future = wxTaskExecutor::Get().Submit<int>(CountWords(m_text));
+
+        // Show the result in the main thread once it's computed.
+        future.ThenInMainThread(this, &MyFrame::OnWordsCounted);
+    }
+
+    void MyFrame::OnWordsCounted(const wxTaskFuture<int>& future)
+    {
+        if ( future.GetState() == wxTASK_DONE )
+            SetStatusText(wxString::Format("%d words", future.Get()));
+    }
+    @endcode
+
+    Each worker thread has its own queues of tasks, one for each priority.
+    The tasks submitted from the tasks running in the executor are queued by
+    the same worker and are executed by it in the last in, first out order,
+    while the other tasks are distributed between all workers. When a worker
+    runs out of tasks, it steals them from the other workers queues, so the
+    work is balanced between all the threads.
+
+    The continuations to be executed in the main thread are executed from
+    wxEvtHandler::CallAfter(), all together, but if executing them takes
+    longer than the time slice set with SetMainThreadTimeSlice(), the
+    remaining ones are executed when the application is idle, so that the
+    user interface remains responsive even when many tasks finish at once.
+
+    The futures of the tasks must not be used after the executor which ran
+    them is destroyed.
+
+    @since 3.1.6
+
+    @library{wxbase}
+    @category{threading}
+
+    @see wxTaskFuture, wxThread
+ */
+class wxTaskExecutor
+{
+public:
+    /**
+        Create the executor and start its worker threads.
+
+        @param numThreads
+            The number of worker threads to use, the default value of 0 means
+            to use one thread for each CPU, as returned by
+            wxThread::GetCPUCount().
+     */
+    explicit wxTaskExecutor(unsigned numThreads = 0);
+
+    /**
+        Destroy the executor.
+
+        All the tasks which didn't start yet are cancelled and the running
+        tasks are asked to stop, as if wxTaskFuture::Cancel() were called for
+        them, and the destructor waits until they do it. The continuations
+        which haven't been executed in the main thread yet are discarded.
+     */
+    ~wxTaskExecutor();
+
+    /**
+        Return the executor shared by the entire application.
+
+        It is created with the default number of threads when this function is
+        called for the first time and is destroyed when the library is shut
+        down.
+     */
+    static wxTaskExecutor& Get();
+
+    /**
+        Returns @true if the task running in the current thread was asked to
+        stop.
+
+        Long-running tasks should call this function periodically and return
+        as soon as possible if it returns @true. It always returns @false when
+        called from outside of the tasks.
+     */
+    static bool IsCurrentTaskCancelled();
+
+    /**
+        Returns the number of the worker threads.
+     */
+    unsigned GetThreadCount() const;
+
+    /**
+        Submit a task for execution in one of the worker threads.
+
+        @tparam T
+            The type of the value returned by the functor, must be specified
+            explicitly.
+        @param func
+            The functor to call. It is copied and can be a pointer to function.
+        @param priority
+            The priority of the task.
+        @return The future which can be used to retrieve the result of the
+            task or cancel it.
+     */
+    template <typename T, typename F>
+    wxTaskFuture<T> Submit(F func,
+                           wxTaskPriority priority = wxTASK_PRIORITY_NORMAL);
+
+    /**
+        Set the maximal time spent executing the main thread continuations at
+        once.
+
+        The default time slice is 10ms. Use 0 to always execute all of the
+        continuations at once.
+     */
+    void SetMainThreadTimeSlice(long ms);
+
+    /**
+        Execute the main thread continuations of the finished tasks.
+
+        This function is called automatically while the event loop is running
+        and only needs to be called explicitly when it isn't, e.g. in console
+        applications. It must be called from the main thread only.
+
+        Notice that it returns after the time slice set with
+        SetMainThreadTimeSlice() expires, even if some continuations remain.
+
+        @return The number of the continuations executed.
+     */
+    size_t ProcessMainThreadContinuations();
+};
@@ -44,6 +44,9 @@
 #include "wx/thread.h"
 #include "wx/stdpaths.h"
 
+#include "wx/private/eventtrace.h"
+#include "wx/private/mpscqueue.h"
+
 #if wxUSE_EXCEPTIONS
     // Do we have a C++ compiler with enough C++11 support for
     // std::exception_ptr and functions working with it?
@@ -168,6 +171,7 @@ wxAppConsoleBase::wxAppConsoleBase()
 {
     m_traits = NULL;
     m_mainLoop = NULL;
+    m_handlersWithNewPendingEvents = NULL;
     m_bDoPendingEventProcessing = true;
 
     ms_appInstance = reinterpret_cast<wxAppConsole *>(this);
@@ -467,24 +471,59 @@ int wxAppConsoleBase::FilterEvent(wxEvent& WXUNUSED(event))
     return Event_Skip;
 }
 
+void wxAppConsoleBase::TakeNewPendingEventHandlers()
+{
+    wxEvtHandler* last;
+    for ( wxEvtHandler* handler = wxMPSCQueueTakeAll
+                                  (
+                                    m_handlersWithNewPendingEvents,
+                                    &wxEvtHandler::m_nextWithPendingEvents,
+                                    &last
+                                  );
+          handler;
+          handler = handler->m_nextWithPendingEvents )
+    {
+        m_handlersWithPendingEvents.Add(handler);
+    }
+}
+
 void wxAppConsoleBase::DelayPendingEventHandler(wxEvtHandler* toDelay)
 {
     wxENTER_CRIT_SECT(m_handlersWithPendingEventsLocker);
 
+    TakeNewPendingEventHandlers();
+
     // move the handler from the list of handlers with processable pending events
     // to the list of handlers with pending events which needs to be processed later
-    m_handlersWithPendingEvents.Remove(toDelay);
-
-    if (m_handlersWithPendingDelayedEvents.Index(toDelay) == wxNOT_FOUND)
+    if (m_handlersWithPendingEvents.Index(toDelay) != wxNOT_FOUND)
+    {
+        m_handlersWithPendingEvents.Remove(toDelay);
         m_handlersWithPendingDelayedEvents.Add(toDelay);
+    }
+    else if (wxAtomicCompareExchange(toDelay->m_pendingEventsRegistered, 0, 1))
+    {
+        // it wasn't registered at all, do it now
+        m_handlersWithPendingDelayedEvents.Add(toDelay);
+    }
+    //else: it is either already delayed or is being added to the queue of the
+    //      handlers with new pending events by another thread right now and
+    //      will be delayed again when we try to process its events
 
     wxLEAVE_CRIT_SECT(m_handlersWithPendingEventsLocker);
 }
 
 void wxAppConsoleBase::RemovePendingEventHandler(wxEvtHandler* toRemove)
 {
+    // avoid locking anything in the common case of a handler without any
+    // pending events
+    if ( !toRemove->m_pendingEventsRegistered )
+        return;
+
     wxENTER_CRIT_SECT(m_handlersWithPendingEventsLocker);
 
+    TakeNewPendingEventHandlers();
+
+    bool removed = false;
     if (m_handlersWithPendingEvents.Index(toRemove) != wxNOT_FOUND)
     {
         m_handlersWithPendingEvents.Remove(toRemove);
@@ -492,6 +531,8 @@ void wxAppConsoleBase::RemovePendingEventHandler(wxEvtHandler* toRemove)
         // check that the handler was present only once in the list
         wxASSERT_MSG( m_handlersWithPendingEvents.Index(toRemove) == wxNOT_FOUND,
                         "Handler occurs twice in the m_handlersWithPendingEvents list!" );
+
+        removed = true;
     }
     //else: it wasn't in this list at all, it's ok
 
@@ -502,24 +543,36 @@ void wxAppConsoleBase::RemovePendingEventHandler(wxEvtHandler* toRemove)
         // check that the handler was present only once in the list
         wxASSERT_MSG( m_handlersWithPendingDelayedEvents.Index(toRemove) == wxNOT_FOUND,
                         "Handler occurs twice in m_handlersWithPendingDelayedEvents list!" );
+
+        removed = true;
     }
     //else: it wasn't in this list at all, it's ok
 
+    // Only reset the flag if we really removed the handler: if we didn't find
+    // it, it must be in the process of being added to the queue by another
+    // thread and will be removed when it's found to have no pending events.
+    if ( removed )
+        wxAtomicCompareExchange(toRemove->m_pendingEventsRegistered, 1, 0);
+
     wxLEAVE_CRIT_SECT(m_handlersWithPendingEventsLocker);
 }
 
 void wxAppConsoleBase::AppendPendingEventHandler(wxEvtHandler* toAppend)
 {
-    wxENTER_CRIT_SECT(m_handlersWithPendingEventsLocker);
-
-    if ( m_handlersWithPendingEvents.Index(toAppend) == wxNOT_FOUND )
-        m_handlersWithPendingEvents.Add(toAppend);
-
-    wxLEAVE_CRIT_SECT(m_handlersWithPendingEventsLocker);
+    // This function may be called from any thread and doesn't lock anything:
+    // the flag ensures that the handler is added only once.
+    if ( wxAtomicCompareExchange(toAppend->m_pendingEventsRegistered, 0, 1) )
+    {
+        wxMPSCQueuePush(m_handlersWithNewPendingEvents, toAppend,
+                        &wxEvtHandler::m_nextWithPendingEvents);
+    }
 }
 
 bool wxAppConsoleBase::HasPendingEvents() const
 {
+    if ( m_handlersWithNewPendingEvents )
+        return true;
+
     wxENTER_CRIT_SECT(const_cast<wxAppConsoleBase*>(this)->m_handlersWithPendingEventsLocker);
 
     bool has = !m_handlersWithPendingEvents.IsEmpty();
@@ -548,6 +601,12 @@ void wxAppConsoleBase::ProcessPendingEvents()
         wxCHECK_RET( m_handlersWithPendingDelayedEvents.IsEmpty(),
                      "this helper list should be empty" );
 
+        TakeNewPendingEventHandlers();
+
+        // Record the time taken by processing all the pending events, if any.
+        wxEventTraceScope traceScope(wxEVENT_TRACE_PENDING_EVENTS,
+                                     !m_handlersWithPendingEvents.IsEmpty());
+
         // iterate until the list becomes empty: the handlers remove themselves
         // from it when they don't have any more pending events
         while (!m_handlersWithPendingEvents.IsEmpty())
@@ -563,6 +622,8 @@ void wxAppConsoleBase::ProcessPendingEvents()
             m_handlersWithPendingEvents[0]->ProcessPendingEvents();
 
             wxENTER_CRIT_SECT(m_handlersWithPendingEventsLocker);
+
+            TakeNewPendingEventHandlers();
         }
 
         // now the wxHandlersWithPendingEvents is surely empty; however some event
@@ -587,8 +648,21 @@ void wxAppConsoleBase::DeletePendingEvents()
     wxCHECK_RET( m_handlersWithPendingDelayedEvents.IsEmpty(),
                  "this helper list should be empty" );
 
+    TakeNewPendingEventHandlers();
+
     for (unsigned int i=0; i<m_handlersWithPendingEvents.GetCount(); i++)
-        m_handlersWithPendingEvents[i]->DeletePendingEvents();
+    {
+        wxEvtHandler* const handler = m_handlersWithPendingEvents[i];
+
+        handler->DeletePendingEvents();
+
+        wxAtomicCompareExchange(handler->m_pendingEventsRegistered, 1, 0);
+
+        // Check for the events queued after DeletePendingEvents() call above
+        // but before we reset the flag, as they wouldn't be processed otherwise.
+        if ( handler->m_pendingEventsQueued )
+            AppendPendingEventHandler(handler);
+    }
 
     m_handlersWithPendingEvents.Clear();
 
@@ -132,6 +132,7 @@ bool wxDataViewModelNotifier::ItemsChanged( const wxDataViewItemArray &items )
 
 wxDataViewModel::wxDataViewModel()
 {
+    m_batchCount = 0;
 }
 
 wxDataViewModel::~wxDataViewModel()
@@ -303,10 +304,40 @@ void wxDataViewModel::Resort()
     }
 }
 
+void wxDataViewModel::BeginBatch()
+{
+    if ( m_batchCount++ )
+        return;
+
+    wxDataViewModelNotifiers::iterator iter;
+    for (iter = m_notifiers.begin(); iter != m_notifiers.end(); ++iter)
+    {
+        (*iter)->BeginBatch();
+    }
+}
+
+void wxDataViewModel::EndBatch()
+{
+    wxCHECK_RET( m_batchCount > 0, "EndBatch() without matching BeginBatch()" );
+
+    if ( --m_batchCount )
+        return;
+
+    wxDataViewModelNotifiers::iterator iter;
+    for (iter = m_notifiers.begin(); iter != m_notifiers.end(); ++iter)
+    {
+        (*iter)->EndBatch();
+    }
+}
+
 void wxDataViewModel::AddNotifier( wxDataViewModelNotifier *notifier )
 {
     m_notifiers.push_back( notifier );
     notifier->SetOwner( this );
+
+    // The new notifier must get EndBatch() call matching this one later.
+    if ( m_batchCount )
+        notifier->BeginBatch();
 }
 
 void wxDataViewModel::RemoveNotifier( wxDataViewModelNotifier *notifier )
@@ -410,11 +441,16 @@ int wxDataViewModel::Compare( const wxDataViewItem &item1, const wxDataViewItem
     }
 
 
-    // items must be different
+    // items must be different, order them by their IDs: notice that their
+    // difference can't be used for this as it could overflow int
     wxUIntPtr id1 = wxPtrToUInt(item1.GetID()),
               id2 = wxPtrToUInt(item2.GetID());
+    if ( id1 == id2 )
+        return 0;
+
+    const int res = id1 < id2 ? -1 : 1;
 
-    return ascending ? id1 - id2 : id2 - id1;
+    return ascending ? res : -res;
 }
 
 // ---------------------------------------------------------
@@ -874,10 +910,13 @@ wxDataViewRendererBase::CheckedGetValue(const wxDataViewModel* model,
     return value;
 }
 
-bool
-wxDataViewRendererBase::PrepareForItem(const wxDataViewModel *model,
+void
+wxDataViewRendererBase::GetDataForItem(const wxDataViewModel *model,
                                        const wxDataViewItem& item,
-                                       unsigned column)
+                                       unsigned column,
+                                       wxVariant& value,
+                                       wxDataViewItemAttr& attr,
+                                       bool& enabled) const
 {
     // This method is called by the native control, so we shouldn't allow
     // exceptions to escape from it.
@@ -887,27 +926,14 @@ wxDataViewRendererBase::PrepareForItem(const wxDataViewModel *model,
     // Now check if we have a value and remember it for rendering it later.
     // Notice that we do it even if it's null, as the cell should be empty then
     // and not show the last used value.
-    wxVariant value = CheckedGetValue(model, item, column);
-
-    if ( m_valueAdjuster )
-    {
-        if ( IsHighlighted() )
-            value = m_valueAdjuster->MakeHighlighted(value);
-    }
-
-    SetValue(value);
+    value = CheckedGetValue(model, item, column);
 
+    // Also get the attributes for this item if it's not empty.
     if ( !value.IsNull() )
-    {
-        // Also set up the attributes for this item if it's not empty.
-        wxDataViewItemAttr attr;
         model->GetAttr(item, column, attr);
-        SetAttr(attr);
-    }
 
-    // Finally determine the enabled/disabled state and apply it, even to the
-    // empty cells.
-    SetEnabled(model->IsEnabled(item, column));
+    // Finally determine the enabled/disabled state, even for the empty cells.
+    enabled = model->IsEnabled(item, column);
 
     }
     wxCATCH_ALL
@@ -915,8 +941,38 @@ wxDataViewRendererBase::PrepareForItem(const wxDataViewModel *model,
         // There is not much we can do about it here, just log it and don't
         // show anything in this cell.
         wxLogDebug("Retrieving the value from the model threw an exception");
-        SetValue(wxVariant());
+        value.MakeNull();
+        enabled = true;
     )
+}
+
+void
+wxDataViewRendererBase::PrepareForData(const wxVariant& value,
+                                       const wxDataViewItemAttr& attr,
+                                       bool enabled)
+{
+    if ( m_valueAdjuster && IsHighlighted() )
+        SetValue(m_valueAdjuster->MakeHighlighted(value));
+    else
+        SetValue(value);
+
+    if ( !value.IsNull() )
+        SetAttr(attr);
+
+    SetEnabled(enabled);
+}
+
+bool
+wxDataViewRendererBase::PrepareForItem(const wxDataViewModel *model,
+                                       const wxDataViewItem& item,
+                                       unsigned column)
+{
+    wxVariant value;
+    wxDataViewItemAttr attr;
+    bool enabled = true;
+    GetDataForItem(model, item, column, value, attr, enabled);
+
+    PrepareForData(value, attr, enabled);
 
     return true;
 }
@@ -45,8 +45,14 @@
 #include "wx/thread.h"
 
 #if wxUSE_BASE
+    #include "wx/atomic.h"
+    #include "wx/ffile.h"
+    #include "wx/hashmap.h"
     #include "wx/scopedptr.h"
 
+    #include "wx/private/eventtrace.h"
+    #include "wx/private/mpscqueue.h"
+
     wxDECLARE_SCOPED_PTR(wxEvent, wxEventPtr)
     wxDEFINE_SCOPED_PTR(wxEvent, wxEventPtr)
 #endif // wxUSE_BASE
@@ -60,6 +66,7 @@
     wxIMPLEMENT_ABSTRACT_CLASS(wxEvent, wxObject);
     wxIMPLEMENT_DYNAMIC_CLASS(wxIdleEvent, wxEvent);
     wxIMPLEMENT_DYNAMIC_CLASS(wxThreadEvent, wxEvent);
+    wxIMPLEMENT_DYNAMIC_CLASS(wxBatchEvent, wxEvent);
 #endif // wxUSE_BASE
 
 #if wxUSE_GUI
@@ -163,6 +170,7 @@ wxDEFINE_EVENT( wxEVT_IDLE, wxIdleEvent );
 
 // Thread and asynchronous call events
 wxDEFINE_EVENT( wxEVT_THREAD, wxThreadEvent );
+wxDEFINE_EVENT( wxEVT_BATCH, wxBatchEvent );
 wxDEFINE_EVENT( wxEVT_ASYNC_METHOD_CALL, wxAsyncMethodCallEvent );
 
 #endif // wxUSE_BASE
@@ -386,6 +394,8 @@ wxEvent::wxEvent(int theId, wxEventType commandType)
     m_propagatedFrom = NULL;
     m_wasProcessed = false;
     m_willBeProcessedAgain = false;
+    m_nextPending = NULL;
+    m_queuedTime = 0;
 }
 
 wxEvent::wxEvent(const wxEvent& src)
@@ -402,6 +412,8 @@ wxEvent::wxEvent(const wxEvent& src)
     , m_isCommandEvent(src.m_isCommandEvent)
     , m_wasProcessed(false)
     , m_willBeProcessedAgain(false)
+    , m_nextPending(NULL)
+    , m_queuedTime(0)
 {
 }
 
@@ -429,6 +441,36 @@ wxEvent& wxEvent::operator=(const wxEvent& src)
     return *this;
 }
 
+// ----------------------------------------------------------------------------
+// wxBatchEvent
+// ----------------------------------------------------------------------------
+
+wxBatchEvent::wxBatchEvent(const wxBatchEvent& event)
+    : wxEvent(event),
+      m_batchedEventType(event.m_batchedEventType),
+      m_category(event.m_category)
+{
+    m_events.reserve(event.m_events.size());
+    for ( size_t n = 0; n < event.m_events.size(); n++ )
+        m_events.push_back(event.m_events[n]->Clone());
+}
+
+wxBatchEvent::~wxBatchEvent()
+{
+    for ( size_t n = 0; n < m_events.size(); n++ )
+        delete m_events[n];
+}
+
+void wxBatchEvent::AddEvent(wxEvent *event)
+{
+    wxCHECK_RET( event, "NULL event can't be added" );
+
+    if ( m_events.empty() )
+        m_category = event->GetEventCategory();
+
+    m_events.push_back(event);
+}
+
 #endif // wxUSE_BASE
 
 #if wxUSE_GUI
@@ -1136,17 +1178,765 @@ void wxEventHashTable::GrowEventTypeTable()
     delete[] oldEventTypeTable;
 }
 
+// ----------------------------------------------------------------------------
+// wxPendingEventsData
+// ----------------------------------------------------------------------------
+
+// The event queued by QueueCoalescedEvent() instead of the real event, which
+// is kept in wxPendingEventsData and can be replaced until this placeholder is
+// processed. It has the same type, id and category as the real event, so that
+// it is handled in the same way when selecting the events to process.
+class wxCoalescedEventPlaceholder : public wxEvent
+{
+public:
+    wxCoalescedEventPlaceholder(wxUIntPtr key,
+                                int id,
+                                wxEventType eventType,
+                                wxEventCategory category)
+        : wxEvent(id, eventType),
+          m_key(key),
+          m_category(category)
+    {
+    }
+
+    wxUIntPtr GetKey() const { return m_key; }
+
+    virtual wxEvent *Clone() const wxOVERRIDE
+    {
+        return new wxCoalescedEventPlaceholder(*this);
+    }
+
+    virtual wxEventCategory GetEventCategory() const wxOVERRIDE
+    {
+        return m_category;
+    }
+
+private:
+    // only used by wxCreateObject()
+    wxCoalescedEventPlaceholder()
+        : m_key(0),
+          m_category(wxEVT_CATEGORY_ALL)
+    {
+    }
+
+    const wxUIntPtr m_key;
+    const wxEventCategory m_category;
+
+    wxDECLARE_DYNAMIC_CLASS_NO_ASSIGN(wxCoalescedEventPlaceholder);
+};
+
+wxIMPLEMENT_DYNAMIC_CLASS(wxCoalescedEventPlaceholder, wxEvent);
+
+WX_DECLARE_HASH_MAP(wxUIntPtr, wxEvent*,
+                    wxIntegerHash, wxIntegerEqual,
+                    wxCoalescedEventsMap);
+
+class wxPendingEventsData
+{
+public:
+    wxPendingEventsData() { }
+    ~wxPendingEventsData() { DeleteCoalescedEvents(); }
+
+    // Store the event to process for the given key, taking ownership of it and
+    // deleting the event previously stored for it, if any. Returns true if
+    // there was no such event, meaning that a placeholder needs to be queued.
+    bool StoreCoalescedEvent(wxUIntPtr key, wxEvent* event)
+    {
+        wxCRIT_SECT_LOCKER(lock, m_coalescedEventsLock);
+
+        wxCoalescedEventsMap::iterator it = m_coalescedEvents.find(key);
+        if ( it != m_coalescedEvents.end() )
+        {
+            delete it->second;
+            it->second = event;
+
+            return false;
+        }
+
+        m_coalescedEvents[key] = event;
+
+        return true;
+    }
+
+    // Return the event to process for the given pending event, which is just
+    // the event itself unless it is a placeholder for a coalesced event. In
+    // the latter case the placeholder is deleted and the event is returned,
+    // or NULL if it had been already deleted by DeleteCoalescedEvents().
+    wxEvent* GetEventToProcess(wxEvent* event)
+    {
+        wxCoalescedEventPlaceholder* const
+            placeholder = wxDynamicCast(event, wxCoalescedEventPlaceholder);
+        if ( !placeholder )
+            return event;
+
+        wxEvent* coalesced = NULL;
+
+        {
+            wxCRIT_SECT_LOCKER(lock, m_coalescedEventsLock);
+
+            wxCoalescedEventsMap::iterator
+                it = m_coalescedEvents.find(placeholder->GetKey());
+            if ( it != m_coalescedEvents.end() )
+            {
+                coalesced = it->second;
+                m_coalescedEvents.erase(it);
+            }
+        }
+
+        delete placeholder;
+
+        return coalesced;
+    }
+
+    void DeleteCoalescedEvents()
+    {
+        wxCRIT_SECT_LOCKER(lock, m_coalescedEventsLock);
+
+        for ( wxCoalescedEventsMap::iterator it = m_coalescedEvents.begin();
+              it != m_coalescedEvents.end();
+              ++it )
+        {
+            delete it->second;
+        }
+
+        m_coalescedEvents.clear();
+    }
+
+    void EnableBatching(wxEventType eventType, bool enable)
+    {
+        for ( size_t n = 0; n < m_batchedEventTypes.size(); n++ )
+        {
+            if ( m_batchedEventTypes[n] == eventType )
+            {
+                if ( !enable )
+                    m_batchedEventTypes.erase(m_batchedEventTypes.begin() + n);
+
+                return;
+            }
+        }
+
+        if ( enable )
+            m_batchedEventTypes.push_back(eventType);
+    }
+
+    bool IsBatched(wxEventType eventType) const
+    {
+        for ( size_t n = 0; n < m_batchedEventTypes.size(); n++ )
+        {
+            if ( m_batchedEventTypes[n] == eventType )
+                return true;
+        }
+
+        return false;
+    }
+
+private:
+    wxCoalescedEventsMap m_coalescedEvents;
+    wxCRIT_SECT_DECLARE_MEMBER(m_coalescedEventsLock);
+
+    // The types of the events delivered in batches, typically very few.
+    wxVector<wxEventType> m_batchedEventTypes;
+
+    wxDECLARE_NO_COPY_CLASS(wxPendingEventsData);
+};
+
+// ----------------------------------------------------------------------------
+// wxDynamicEventsIndex
+// ----------------------------------------------------------------------------
+
+// The dynamic event handlers for a single event type in the order in which
+// they were bound, with the unbound ones replaced by NULL until pruned.
+typedef wxVector<wxDynamicEventTableEntry*> wxDynamicEventsBucket;
+
+// The index of the dynamic event handlers by their event type.
+//
+// It is only created for the objects with many dynamic handlers, as scanning
+// all of them is faster than looking up the event type when there are just a
+// few, see wxDYNAMIC_EVENTS_INDEX_MIN_SIZE below.
+//
+// It uses a sorted array of the event types rather than a hash map because
+// there are typically just a few dozens of them at most and looking them up
+// using binary search is faster in this case.
+class wxDynamicEventsIndex
+{
+public:
+    // Create the index for the given entries, which can contain NULL entries
+    // for the unbound handlers which will be pruned later.
+    explicit wxDynamicEventsIndex(const wxDynamicEventsBucket& entries)
+    {
+        m_numUnbound = 0;
+
+        for ( size_t n = 0; n < entries.size(); n++ )
+        {
+            if ( entries[n] )
+                Add(entries[n]);
+            else
+                m_numUnbound++;
+        }
+    }
+
+    ~wxDynamicEventsIndex()
+    {
+        for ( size_t n = 0; n < m_buckets.size(); n++ )
+            delete m_buckets[n];
+    }
+
+    void Add(wxDynamicEventTableEntry* entry)
+    {
+        const wxEventType eventType = entry->m_eventType;
+
+        const size_t pos = LowerBound(eventType);
+        if ( pos == m_types.size() || m_types[pos] != eventType )
+        {
+            m_types.insert(m_types.begin() + pos, eventType);
+            m_buckets.insert(m_buckets.begin() + pos, new wxDynamicEventsBucket);
+        }
+
+        m_buckets[pos]->push_back(entry);
+    }
+
+    // Replace the entry with NULL, it will be removed by Prune() later.
+    void Remove(wxDynamicEventTableEntry* entry)
+    {
+        m_numUnbound++;
+
+        wxDynamicEventsBucket* const bucket = Find(entry->m_eventType);
+        wxCHECK_RET( bucket, "dynamic event entry not indexed" );
+
+        for ( size_t n = bucket->size(); n; n-- )
+        {
+            if ( (*bucket)[n - 1] == entry )
+            {
+                (*bucket)[n - 1] = NULL;
+                return;
+            }
+        }
+
+        wxFAIL_MSG( "dynamic event entry not found in the index" );
+    }
+
+    // Return the handlers for the given event type or NULL if there are none.
+    //
+    // Notice that the buckets are never deleted, so the returned pointer
+    // remains valid for the lifetime of this object, even if more handlers
+    // are bound in the meanwhile.
+    wxDynamicEventsBucket* Find(wxEventType eventType) const
+    {
+        const size_t pos = LowerBound(eventType);
+        if ( pos == m_types.size() || m_types[pos] != eventType )
+            return NULL;
+
+        return m_buckets[pos];
+    }
+
+    // Return true if Remove() was called since the last Prune() call.
+    bool HasUnbound() const { return m_numUnbound != 0; }
+
+    // Remove the NULL entries from all the buckets.
+    void Prune()
+    {
+        for ( size_t n = 0; n < m_buckets.size(); n++ )
+            DoPrune(*m_buckets[n]);
+
+        m_numUnbound = 0;
+    }
+
+    // Remove the NULL entries from the given vector.
+    static void DoPrune(wxVector<wxDynamicEventTableEntry*>& entries)
+    {
+        size_t nNew = 0;
+        for ( size_t n = 0; n != entries.size(); n++ )
+        {
+            if ( entries[n] )
+                entries[nNew++] = entries[n];
+        }
+
+        entries.resize(nNew);
+    }
+
+private:
+    // Return the index of the first element of m_types not less than the
+    // given one.
+    size_t LowerBound(wxEventType eventType) const
+    {
+        size_t lo = 0,
+               hi = m_types.size();
+        while ( lo < hi )
+        {
+            const size_t mid = (lo + hi) / 2;
+            if ( m_types[mid] < eventType )
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+
+        return lo;
+    }
+
+    // The event types sorted in increasing order and the handlers for each of
+    // them at the same index.
+    wxVector<wxEventType> m_types;
+    wxVector<wxDynamicEventsBucket*> m_buckets;
+
+    // Number of the entries removed since the last call to Prune().
+    size_t m_numUnbound;
+
+    wxDECLARE_NO_COPY_CLASS(wxDynamicEventsIndex);
+};
+
+namespace
+{
+
+// The minimal number of the dynamic event handlers for which the index is
+// created: for fewer handlers they are just examined one by one.
+const size_t wxDYNAMIC_EVENTS_INDEX_MIN_SIZE = 8;
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------
+// Dispatch statistics
+// ----------------------------------------------------------------------------
+
+namespace
+{
+
+// This flag is checked for every event processed by any thread, so it is
+// atomic, while the statistics themselves are only updated when it is set and
+// are protected by a critical section.
+wxAtomicInt gs_dispatchStatsEnabled = 0;
+
+wxCRIT_SECT_DECLARE(gs_dispatchStatsLock);
+
+wxEventDispatchStats gs_dispatchStats;
+
+void RecordDynamicEventsSearch(size_t handlersScanned)
+{
+    wxCRIT_SECT_LOCKER(lock, gs_dispatchStatsLock);
+
+    gs_dispatchStats.searches++;
+    gs_dispatchStats.handlersScanned += handlersScanned;
+    if ( handlersScanned > gs_dispatchStats.maxHandlersScanned )
+        gs_dispatchStats.maxHandlersScanned = handlersScanned;
+}
+
+} // anonymous namespace
+
+/* static */
+void wxEvtHandler::EnableDispatchStats(bool enable)
+{
+    gs_dispatchStatsEnabled = enable;
+}
+
+/* static */
+wxEventDispatchStats wxEvtHandler::GetDispatchStats()
+{
+    wxCRIT_SECT_LOCKER(lock, gs_dispatchStatsLock);
+
+    return gs_dispatchStats;
+}
+
+/* static */
+void wxEvtHandler::ResetDispatchStats()
+{
+    wxCRIT_SECT_LOCKER(lock, gs_dispatchStatsLock);
+
+    gs_dispatchStats = wxEventDispatchStats();
+}
+
+// ----------------------------------------------------------------------------
+// wxEventTracer
+// ----------------------------------------------------------------------------
+
+// The ring buffer containing the most recent records.
+//
+// Records can be added to it by several threads concurrently without locking:
+// each of them atomically reserves the next slot and then fills it, while the
+// slot sequence number allows GetRecords() to skip the slots being written.
+//
+// Clear() doesn't reset the index of the next record, which would race with
+// Add(), but just remembers the index of the first record to return instead.
+class wxEventTraceBuffer
+{
+public:
+    explicit wxEventTraceBuffer(size_t capacity)
+        : m_slots(RoundCapacity(capacity))
+    {
+        m_mask = m_slots.size() - 1;
+        m_next = 0;
+        m_first = 0;
+    }
+
+    // Return the smallest power of 2 not less than the given capacity.
+    static size_t RoundCapacity(size_t capacity)
+    {
+        size_t size = 1;
+        while ( size < capacity )
+            size *= 2;
+
+        return size;
+    }
+
+    size_t GetCapacity() const { return m_slots.size(); }
+
+    void Add(const wxEventTraceRecord& record)
+    {
+        wxUint32 n;
+        do
+        {
+            n = m_next;
+        }
+        while ( !wxAtomicCompareExchange(m_next, n, n + 1) );
+
+        Slot& slot = m_slots[n & m_mask];
+
+        // After the buffer wraps around, another thread may still be writing
+        // the older record to the same slot, or may have already written a
+        // more recent one to it. The record is simply dropped in both cases,
+        // as it would have been overwritten soon anyhow.
+        if ( !wxAtomicCompareExchange(slot.busy, 0, 1) )
+            return;
+
+        const wxUint32 seq = slot.seq;
+        if ( seq && static_cast<wxInt32>(seq - (n + 1)) > 0 )
+        {
+            wxAtomicCompareExchange(slot.busy, 1, 0);
+            return;
+        }
+
+        // Mark the slot as not containing a valid record while we fill it,
+        // the atomic operations also act as memory barriers here.
+        wxAtomicCompareExchange(slot.seq, seq, 0);
+        slot.record = record;
+        wxAtomicCompareExchange(slot.seq, 0, n + 1);
+
+        wxAtomicCompareExchange(slot.busy, 1, 0);
+    }
+
+    void Clear()
+    {
+        m_first = m_next;
+    }
+
+    void GetRecords(wxVector<wxEventTraceRecord>& records)
+    {
+        // Notice that all the arithmetic here is modulo 2^32 to handle the
+        // indices wrapping around correctly.
+        const wxUint32 end = m_next;
+        const wxUint32 available = end - m_first;
+        const wxUint32 count = available < m_slots.size() ? available
+                                                          : m_slots.size();
+
+        records.reserve(count);
+        for ( wxUint32 n = end - count; n != end; n++ )
+        {
+            Slot& slot = m_slots[n & m_mask];
+
+            // Skip the slots which are being written or were already reused
+            // for a more recent record.
+            const wxUint32 seq = slot.seq;
+            if ( seq != n + 1 )
+                continue;
+
+            const wxEventTraceRecord record = slot.record;
+
+            // Check that the slot wasn't modified while we were copying it.
+            if ( wxAtomicCompareExchange(slot.seq, seq, seq) )
+                records.push_back(record);
+        }
+    }
+
+private:
+    struct Slot
+    {
+        Slot() : seq(0), busy(0) { }
+
+        // One more than the index of the record in this slot or 0 if it
+        // doesn't contain a valid record.
+        wxUint32 volatile seq;
+
+        // 1 while a thread is writing to this slot, 0 otherwise.
+        wxUint32 volatile busy;
+
+        wxEventTraceRecord record;
+    };
+
+    wxVector<Slot> m_slots;
+    size_t m_mask;
+
+    // Index of the next record to add.
+    wxUint32 volatile m_next;
+
+    // Index of the first record to return, i.e. the value of m_next when
+    // Clear() was last called.
+    wxUint32 volatile m_first;
+
+    wxDECLARE_NO_COPY_CLASS(wxEventTraceBuffer);
+};
+
+namespace
+{
+
+// The clock used for all the records timestamps.
+wxStopWatch gs_traceClock;
+
+// The buffer currently used for recording, it is only modified by Start() in
+// the main thread but is read by wxEventTraceScope in all of them.
+wxEventTraceBuffer* volatile gs_traceBuffer = NULL;
+
+// The buffers replaced by Start() with a different capacity can still be used
+// by the wxEventTraceScope objects created before, even in the other threads,
+// so we only delete them on shutdown, when no events are processed any more.
+wxVector<wxEventTraceBuffer*> gs_retiredTraceBuffers;
+
+wxUint64 GetTraceTime()
+{
+    return gs_traceClock.TimeInMicro().GetValue();
+}
+
+} // anonymous namespace
+
+class wxEventTracerModule : public wxModule
+{
+public:
+    wxEventTracerModule() { }
+    virtual bool OnInit() wxOVERRIDE { return true; }
+    virtual void OnExit() wxOVERRIDE
+    {
+        wxEventTracer::Stop();
+
+        for ( size_t n = 0; n < gs_retiredTraceBuffers.size(); n++ )
+            delete gs_retiredTraceBuffers[n];
+        gs_retiredTraceBuffers.clear();
+
+        delete gs_traceBuffer;
+        gs_traceBuffer = NULL;
+    }
+
+    wxDECLARE_DYNAMIC_CLASS(wxEventTracerModule);
+};
+
+wxIMPLEMENT_DYNAMIC_CLASS(wxEventTracerModule, wxModule);
+
+volatile bool wxEventTracer::ms_running = false;
+
+/* static */
+void wxEventTracer::Start(size_t capacity)
+{
+    wxCHECK_RET( capacity, "tracer capacity must be positive" );
+    wxASSERT_MSG( wxIsMainThread(), "must be called from the main thread" );
+
+    wxEventTraceBuffer* const old = gs_traceBuffer;
+    if ( old &&
+            old->GetCapacity() == wxEventTraceBuffer::RoundCapacity(capacity) )
+    {
+        old->Clear();
+    }
+    else
+    {
+        // Publish the new buffer atomically, as the other threads may be
+        // reading this pointer right now. This can't fail as we're the only
+        // thread modifying it.
+        wxEventTraceBuffer* const buffer = new wxEventTraceBuffer(capacity);
+        wxAtomicCompareExchangePtr(gs_traceBuffer, old, buffer);
+
+        if ( old )
+            gs_retiredTraceBuffers.push_back(old);
+    }
+
+    gs_traceClock.Start();
+
+    ms_running = true;
+}
+
+/* static */
+void wxEventTracer::Stop()
+{
+    ms_running = false;
+}
+
+/* static */
+void wxEventTracer::Clear()
+{
+    wxASSERT_MSG( wxIsMainThread(), "must be called from the main thread" );
+
+    if ( gs_traceBuffer )
+        gs_traceBuffer->Clear();
+}
+
+/* static */
+wxVector<wxEventTraceRecord> wxEventTracer::GetRecords()
+{
+    wxVector<wxEventTraceRecord> records;
+    if ( gs_traceBuffer )
+        gs_traceBuffer->GetRecords(records);
+
+    return records;
+}
+
+/* static */
+wxString wxEventTracer::GetChromeTrace()
+{
+    const wxVector<wxEventTraceRecord> records = GetRecords();
+
+    const unsigned long pid = wxGetProcessId();
+
+    wxString trace("{\"traceEvents\":[");
+    for ( size_t n = 0; n < records.size(); n++ )
+    {
+        const wxEventTraceRecord& r = records[n];
+
+        wxString name,
+                 args;
+        switch ( r.kind )
+        {
+            case wxEVENT_TRACE_PROCESS:
+                name = r.eventClass ? r.eventClass->GetClassName()
+                                    : wxS("wxEvent");
+                args.Printf("\"type\":%d,\"handler\":\"%s\"",
+                            r.eventType,
+                            r.handlerClass ? r.handlerClass->GetClassName()
+                                           : wxS("wxEvtHandler"));
+                if ( r.wasQueued )
+                    args += wxString::Format(",\"queueLatency\":%u",
+                                             r.queueLatency);
+                break;
+
+            case wxEVENT_TRACE_PENDING_EVENTS:
+                name = "Pending events";
+                break;
+
+            case wxEVENT_TRACE_IDLE:
+                name = "Idle";
+                break;
+        }
+
+        unsigned long tid = 0;
+#if wxUSE_THREADS
+        tid = static_cast<unsigned long>(r.threadId);
+#endif // wxUSE_THREADS
+
+        if ( n )
+            trace += ',';
+
+        trace += wxString::Format
+                 (
+                    "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\","
+                    "\"ts\":%" wxLongLongFmtSpec "u,\"dur\":%u,"
+                    "\"pid\":%lu,\"tid\":%lu,\"args\":{%s}}",
+                    name,
+                    r.kind == wxEVENT_TRACE_PROCESS ? "event" : "loop",
+                    r.start,
+                    r.duration,
+                    pid,
+                    tid,
+                    args
+                 );
+    }
+
+    trace += "],\"displayTimeUnit\":\"ms\"}";
+
+    return trace;
+}
+
+#if wxUSE_FFILE
+
+/* static */
+bool wxEventTracer::SaveChromeTrace(const wxString& filename)
+{
+    wxFFile file(filename, "w");
+    if ( !file.IsOpened() )
+        return false;
+
+    return file.Write(GetChromeTrace(), wxConvUTF8) && file.Close();
+}
+
+#endif // wxUSE_FFILE
+
+// ----------------------------------------------------------------------------
+// wxEventTraceScope
+// ----------------------------------------------------------------------------
+
+/* static */
+wxUint32 wxEventTraceScope::GetQueuedTime()
+{
+    // Only the lower bits of the time are needed to compute the latency and
+    // 0 is reserved for the events queued while the tracer is not running.
+    const wxUint32 t = static_cast<wxUint32>(GetTraceTime());
+
+    return t ? t : 1;
+}
+
+void wxEventTraceScope::Init(const wxEvtHandler* handler, wxEvent& event)
+{
+    Init(wxEVENT_TRACE_PROCESS);
+
+    m_record.eventType = event.GetEventType();
+    m_record.eventClass = event.GetClassInfo();
+    m_record.handlerClass = handler->GetClassInfo();
+
+    if ( event.m_queuedTime )
+    {
+        m_record.queueLatency =
+            static_cast<wxUint32>(m_record.start) - event.m_queuedTime;
+        m_record.wasQueued = true;
+
+        // Don't record the latency again if the same event is processed again.
+        event.m_queuedTime = 0;
+    }
+}
+
+void wxEventTraceScope::Init(wxEventTraceKind kind)
+{
+    m_buffer = gs_traceBuffer;
+
+    m_record.kind = kind;
+    m_record.eventType = wxEVT_NULL;
+    m_record.eventClass = NULL;
+    m_record.handlerClass = NULL;
+#if wxUSE_THREADS
+    m_record.threadId = wxThread::GetCurrentId();
+#endif // wxUSE_THREADS
+    m_record.duration = 0;
+    m_record.queueLatency = 0;
+    m_record.wasQueued = false;
+
+    m_record.start = GetTraceTime();
+}
+
+void wxEventTraceScope::Finish()
+{
+    m_record.duration = static_cast<wxUint32>(GetTraceTime() - m_record.start);
+
+    m_buffer->Add(m_record);
+}
+
 // ----------------------------------------------------------------------------
 // wxEvtHandler
 // ----------------------------------------------------------------------------
 
+#ifdef wxNEEDS_ATOMIC_COMPARE_EXCHANGE_LOCK
+
+wxCriticalSection& wxGetAtomicCompareExchangeLock()
+{
+    static wxCriticalSection s_lock;
+    return s_lock;
+}
+
+#endif // wxNEEDS_ATOMIC_COMPARE_EXCHANGE_LOCK
+
 wxEvtHandler::wxEvtHandler()
 {
     m_nextHandler = NULL;
     m_previousHandler = NULL;
     m_enabled = true;
     m_dynamicEvents = NULL;
-    m_pendingEvents = NULL;
+    m_dynamicEventsIndex = NULL;
+    m_pendingEventsQueued = NULL;
+    m_pendingEventsFirst = NULL;
+    m_pendingEventsLast = NULL;
+    m_pendingEventsRegistered = 0;
+    m_nextWithPendingEvents = NULL;
+    m_pendingEventsData = NULL;
 
     // no client data (yet)
     m_clientData = NULL;
@@ -1182,6 +1972,7 @@ wxEvtHandler::~wxEvtHandler()
             delete entry;
         }
         delete m_dynamicEvents;
+        delete m_dynamicEventsIndex;
     }
 
     // Remove us from the list of the pending events if necessary.
@@ -1189,6 +1980,7 @@ wxEvtHandler::~wxEvtHandler()
         wxTheApp->RemovePendingEventHandler(this);
 
     DeletePendingEvents();
+    delete m_pendingEventsData;
 
     // we only delete object data, not untyped
     if ( m_clientDataType == wxClientData_Object )
@@ -1285,37 +2077,137 @@ void wxEvtHandler::QueueEvent(wxEvent *event)
         return;
     }
 
-    // 1) Add this event to our list of pending events
-    wxENTER_CRIT_SECT( m_pendingEventsLock );
-
-    if ( !m_pendingEvents )
-        m_pendingEvents = new wxList;
+    if ( wxEventTracer::IsRunning() )
+        event->m_queuedTime = wxEventTraceScope::GetQueuedTime();
 
-    m_pendingEvents->Append(event);
+    // 1) Add this event to our queue of pending events: this doesn't lock
+    //    anything, so that many threads can do it concurrently.
+    wxMPSCQueuePush(m_pendingEventsQueued, event, &wxEvent::m_nextPending);
 
     // 2) Add this event handler to list of event handlers that
-    //    have pending events.
+    //    have pending events, unless it's already there.
+    //
+    //    Notice that this must be done after adding the event to the queue:
+    //    otherwise the handler could be found to have no pending events and
+    //    removed from the list between these 2 steps, breaking the invariant
+    //    that a handler with pending events is always in this list.
 
     wxTheApp->AppendPendingEventHandler(this);
 
-    // only release m_pendingEventsLock now because otherwise there is a race
-    // condition as described in the ticket #9093: we could process the event
-    // just added to m_pendingEvents in our ProcessPendingEvents() below before
-    // we had time to append this pointer to wxHandlersWithPendingEvents list; thus
-    // breaking the invariant that a handler should be in the list iff it has
-    // any pending events to process
-    wxLEAVE_CRIT_SECT( m_pendingEventsLock );
-
     // 3) Inform the system that new pending events are somewhere,
     //    and that these should be processed in idle time.
     wxWakeUpIdle();
 }
 
+void wxEvtHandler::QueueCoalescedEvent(wxUIntPtr key, wxEvent *event)
+{
+    wxCHECK_RET( event, "NULL event can't be posted" );
+
+    if ( !wxTheApp )
+    {
+        // let QueueEvent() deal with this case
+        QueueEvent(event);
+        return;
+    }
+
+    // Don't use the event after storing it, as it could be replaced, and
+    // deleted, by another thread at any moment after this.
+    const int id = event->GetId();
+    const wxEventType eventType = event->GetEventType();
+    const wxEventCategory category = event->GetEventCategory();
+
+    if ( GetPendingEventsData()->StoreCoalescedEvent(key, event) )
+    {
+        QueueEvent(new wxCoalescedEventPlaceholder(key, id, eventType, category));
+    }
+    //else: the placeholder queued for the previous event will be used
+}
+
+void wxEvtHandler::EnableBatchedEvents(wxEventType eventType, bool enable)
+{
+    GetPendingEventsData()->EnableBatching(eventType, enable);
+}
+
+wxPendingEventsData* wxEvtHandler::GetPendingEventsData()
+{
+    if ( !m_pendingEventsData )
+    {
+        // This can be called from several threads at once, so make sure that
+        // only one of the created objects is used.
+        wxPendingEventsData* const data = new wxPendingEventsData;
+        if ( !wxAtomicCompareExchangePtr(m_pendingEventsData,
+                                         static_cast<wxPendingEventsData*>(NULL),
+                                         data) )
+        {
+            delete data;
+        }
+    }
+
+    return m_pendingEventsData;
+}
+
+void wxEvtHandler::TakeQueuedPendingEvents()
+{
+    wxEvent* last;
+    wxEvent* const first = wxMPSCQueueTakeAll(m_pendingEventsQueued,
+                                              &wxEvent::m_nextPending,
+                                              &last);
+    if ( !first )
+        return;
+
+    if ( m_pendingEventsLast )
+        m_pendingEventsLast->m_nextPending = first;
+    else
+        m_pendingEventsFirst = first;
+
+    m_pendingEventsLast = last;
+}
+
+void wxEvtHandler::UnregisterIfNoPendingEvents()
+{
+    if ( m_pendingEventsFirst || m_pendingEventsQueued )
+        return;
+
+    wxTheApp->RemovePendingEventHandler(this);
+
+    // Another thread could have queued an event after the check above but
+    // before we were removed from the list, in which case it didn't add us to
+    // it again because we were still there, so do it now. If the event was
+    // queued after this check, it will be done by QueueEvent() itself.
+    if ( m_pendingEventsQueued )
+        wxTheApp->AppendPendingEventHandler(this);
+}
+
 void wxEvtHandler::DeletePendingEvents()
 {
-    if (m_pendingEvents)
-        m_pendingEvents->DeleteContents(true);
-    wxDELETE(m_pendingEvents);
+    TakeQueuedPendingEvents();
+
+    wxEvent* event = m_pendingEventsFirst;
+    while ( event )
+    {
+        wxEvent* const next = event->m_nextPending;
+        delete event;
+        event = next;
+    }
+
+    m_pendingEventsFirst =
+    m_pendingEventsLast = NULL;
+
+    if ( m_pendingEventsData )
+        m_pendingEventsData->DeleteCoalescedEvents();
+}
+
+void wxEvtHandler::UnlinkPendingEvent(wxEvent* prev, wxEvent* event)
+{
+    if ( prev )
+        prev->m_nextPending = event->m_nextPending;
+    else
+        m_pendingEventsFirst = event->m_nextPending;
+
+    if ( m_pendingEventsLast == event )
+        m_pendingEventsLast = prev;
+
+    event->m_nextPending = NULL;
 }
 
 void wxEvtHandler::ProcessPendingEvents()
@@ -1334,25 +2226,35 @@ void wxEvtHandler::ProcessPendingEvents()
 
     wxENTER_CRIT_SECT( m_pendingEventsLock );
 
-    // this method is only called by wxApp if this handler does have
-    // pending events
-    wxCHECK_RET( m_pendingEvents && !m_pendingEvents->IsEmpty(),
-                 "should have pending events if called" );
+    TakeQueuedPendingEvents();
 
-    wxList::compatibility_iterator node = m_pendingEvents->GetFirst();
-    wxEvent* pEvent = static_cast<wxEvent *>(node->GetData());
+    // this method is normally only called by wxApp if this handler does have
+    // pending events, but it's still possible for it to have none of them if
+    // another thread added us to the list after we had already processed the
+    // event it queued, so just remove ourselves from the list in this case
+    wxEvent* pEvent = m_pendingEventsFirst;
+    if ( !pEvent )
+    {
+        UnregisterIfNoPendingEvents();
+
+        wxLEAVE_CRIT_SECT( m_pendingEventsLock );
+
+        return;
+    }
 
     // find the first event which can be processed now:
+    wxEvent* pPrevEvent = NULL;
     wxEventLoopBase* evtLoop = wxEventLoopBase::GetActive();
-    if (evtLoop && evtLoop->IsYielding())
+    const bool yielding = evtLoop && evtLoop->IsYielding();
+    if (yielding)
     {
-        while (node && pEvent && !evtLoop->IsEventAllowedInsideYield(pEvent->GetEventCategory()))
+        while (pEvent && !evtLoop->IsEventAllowedInsideYield(pEvent->GetEventCategory()))
         {
-            node = node->GetNext();
-            pEvent = node ? static_cast<wxEvent *>(node->GetData()) : NULL;
+            pPrevEvent = pEvent;
+            pEvent = pEvent->m_nextPending;
         }
 
-        if (!node)
+        if (!pEvent)
         {
             // all our events are NOT processable now... signal this:
             wxTheApp->DelayPendingEventHandler(this);
@@ -1366,23 +2268,68 @@ void wxEvtHandler::ProcessPendingEvents()
         }
     }
 
-    wxEventPtr event(pEvent);
-
     // it's important we remove event from list before processing it, else a
     // nested event loop, for example from a modal dialog, might process the
     // same event again.
-    m_pendingEvents->Erase(node);
+    UnlinkPendingEvent(pPrevEvent, pEvent);
 
-    if ( m_pendingEvents->IsEmpty() )
+    wxEventPtr event(pEvent);
+
+    if ( m_pendingEventsData )
     {
-        // if there are no more pending events left, we don't need to
-        // stay in this list
-        wxTheApp->RemovePendingEventHandler(this);
+        // Replace the placeholder of a coalesced event with the real one,
+        // which was queued at the same time as the placeholder.
+        const wxUint32 queuedTime = event->m_queuedTime;
+        event.reset(m_pendingEventsData->GetEventToProcess(event.release()));
+        if ( event.get() )
+            event->m_queuedTime = queuedTime;
+
+        if ( event.get() &&
+                m_pendingEventsData->IsBatched(event->GetEventType()) )
+        {
+            const wxEventType eventType = event->GetEventType();
+
+            wxBatchEvent* const batch = new wxBatchEvent(eventType);
+            batch->AddEvent(event.release());
+            event.reset(batch);
+            event->m_queuedTime = queuedTime;
+
+            // Also take all the other pending events of the same type which
+            // can be processed now.
+            wxEvent* prev = pPrevEvent;
+            wxEvent* next;
+            for ( wxEvent* e = prev ? prev->m_nextPending : m_pendingEventsFirst;
+                  e;
+                  e = next )
+            {
+                next = e->m_nextPending;
+
+                if ( e->GetEventType() != eventType ||
+                        (yielding &&
+                            !evtLoop->IsEventAllowedInsideYield(e->GetEventCategory())) )
+                {
+                    prev = e;
+                    continue;
+                }
+
+                UnlinkPendingEvent(prev, e);
+
+                wxEvent* const toProcess = m_pendingEventsData->GetEventToProcess(e);
+                if ( toProcess )
+                    batch->AddEvent(toProcess);
+            }
+        }
     }
 
+    // if there are no more pending events left, we don't need to
+    // stay in this list
+    UnregisterIfNoPendingEvents();
+
     wxLEAVE_CRIT_SECT( m_pendingEventsLock );
 
-    ProcessEvent(*event);
+    // the event could have been deleted if it was coalesced
+    if ( event.get() )
+        ProcessEvent(*event);
 
     // careful: this object could have been deleted by the event handler
     // executed by the above ProcessEvent() call, so we can't access any fields
@@ -1488,6 +2435,9 @@ bool wxEvtHandler::TryAfter(wxEvent& event)
 
 bool wxEvtHandler::ProcessEvent(wxEvent& event)
 {
+    // Record the processing of the event if tracing is enabled.
+    wxEventTraceScope traceScope(this, event);
+
     // The very first thing we do is to allow any registered filters to hook
     // into event processing in order to globally pre-process all events.
     //
@@ -1767,6 +2717,11 @@ void wxEvtHandler::DoBind(int id,
     // than inserting the element at the front.
     m_dynamicEvents->push_back(entry);
 
+    if ( m_dynamicEventsIndex )
+        m_dynamicEventsIndex->Add(entry);
+    else if ( m_dynamicEvents->size() >= wxDYNAMIC_EVENTS_INDEX_MIN_SIZE )
+        m_dynamicEventsIndex = new wxDynamicEventsIndex(*m_dynamicEvents);
+
     // Make sure we get to know when a sink is destroyed
     wxEvtHandler *eventSink = func->GetEvtHandler();
     if ( eventSink && eventSink != this )
@@ -1820,6 +2775,8 @@ wxEvtHandler::DoUnbind(int id,
             // vector, which is not guaranteed by our API, but here we can use
             // this implementation detail.
             (*m_dynamicEvents)[cookie] = NULL;
+            if ( m_dynamicEventsIndex )
+                m_dynamicEventsIndex->Remove(entry);
 
             delete entry;
             return true;
@@ -1861,7 +2818,15 @@ bool wxEvtHandler::SearchDynamicEventTable( wxEvent& event )
     wxCHECK_MSG( m_dynamicEvents, false,
                  wxT("caller should check that we have dynamic events") );
 
-    DynamicEvents& dynamicEvents = *m_dynamicEvents;
+    // If we have the index, only the handlers for this event type need to be
+    // examined and there may be none of them at all. Otherwise we examine all
+    // of them, which is faster when there are just a few.
+    wxDynamicEventsBucket* const entries = m_dynamicEventsIndex
+        ? m_dynamicEventsIndex->Find(event.GetEventType())
+        : m_dynamicEvents;
+
+    const bool recordStats = gs_dispatchStatsEnabled != 0;
+    size_t handlersScanned = 0;
 
     bool needToPruneDeleted = false;
 
@@ -1869,9 +2834,19 @@ bool wxEvtHandler::SearchDynamicEventTable( wxEvent& event )
     // but not yet pruned entries from the caller, but here we do want to know
     // about them, so iterate directly. Remember to do it in the reverse order
     // to honour the order of handlers connection.
-    for ( size_t n = dynamicEvents.size(); n; n-- )
+    //
+    // Notice that the handlers we call can bind and unbind other handlers, so
+    // the entries can change while we iterate over them.
+    for ( size_t n = entries ? entries->size() : 0; n; n-- )
     {
-        wxDynamicEventTableEntry* const entry = dynamicEvents[n - 1];
+        // The entries could have been pruned by a nested call to this function.
+        if ( n > entries->size() )
+        {
+            n = entries->size() + 1;
+            continue;
+        }
+
+        wxDynamicEventTableEntry* const entry = (*entries)[n - 1];
 
         if ( !entry )
         {
@@ -1882,42 +2857,54 @@ bool wxEvtHandler::SearchDynamicEventTable( wxEvent& event )
             continue;
         }
 
-        if ( event.GetEventType() == entry->m_eventType )
+        handlersScanned++;
+
+        if ( event.GetEventType() != entry->m_eventType )
+            continue;
+
+        wxEvtHandler *handler = entry->m_fn->GetEvtHandler();
+        if ( !handler )
+           handler = this;
+        if ( ProcessEventIfMatchesId(*entry, handler, event) )
         {
-            wxEvtHandler *handler = entry->m_fn->GetEvtHandler();
-            if ( !handler )
-               handler = this;
-            if ( ProcessEventIfMatchesId(*entry, handler, event) )
-            {
-                // It's important to skip pruning of the unbound event entries
-                // below because this object itself could have been deleted by
-                // the event handler making m_dynamicEvents a dangling pointer
-                // which can't be accessed any longer in the code below.
-                //
-                // In practice, it hopefully shouldn't be a problem to wait
-                // until we get an event that we don't handle before pruning
-                // because this should happen soon enough and even if it
-                // doesn't the worst possible outcome is slightly increased
-                // memory consumption while not skipping pruning can result in
-                // hard to reproduce (because they require the disconnection
-                // and deletion happen at the same time which is not always the
-                // case) crashes.
-                return true;
-            }
+            // Only static data can be used here, see below.
+            if ( recordStats )
+                RecordDynamicEventsSearch(handlersScanned);
+
+            // It's important to skip pruning of the unbound event entries
+            // below because this object itself could have been deleted by
+            // the event handler making m_dynamicEvents a dangling pointer
+            // which can't be accessed any longer in the code below.
+            //
+            // In practice, it hopefully shouldn't be a problem to wait
+            // until we get an event that we don't handle before pruning
+            // because this should happen soon enough and even if it
+            // doesn't the worst possible outcome is slightly increased
+            // memory consumption while not skipping pruning can result in
+            // hard to reproduce (because they require the disconnection
+            // and deletion happen at the same time which is not always the
+            // case) crashes.
+            return true;
         }
     }
 
-    if ( needToPruneDeleted )
+    if ( recordStats )
+        RecordDynamicEventsSearch(handlersScanned);
+
+    // Remove all the entries unbound since the last time we did it, both
+    // from the main vector and from the index, if we have it. Notice that the
+    // index could have been created by one of the handlers called above.
+    if ( m_dynamicEventsIndex )
     {
-        size_t nNew = 0;
-        for ( size_t n = 0; n != dynamicEvents.size(); n++ )
+        if ( m_dynamicEventsIndex->HasUnbound() )
         {
-            if ( dynamicEvents[n] )
-                dynamicEvents[nNew++] = dynamicEvents[n];
+            wxDynamicEventsIndex::DoPrune(*m_dynamicEvents);
+            m_dynamicEventsIndex->Prune();
         }
-
-        wxASSERT( nNew != dynamicEvents.size() );
-        dynamicEvents.resize(nNew);
+    }
+    else if ( needToPruneDeleted )
+    {
+        wxDynamicEventsIndex::DoPrune(*m_dynamicEvents);
     }
 
     return false;
@@ -1993,6 +2980,9 @@ void wxEvtHandler::OnSinkDestroyed( wxEvtHandler *sink )
     {
         if ( entry->m_fn->GetEvtHandler() == sink )
         {
+            if ( m_dynamicEventsIndex )
+                m_dynamicEventsIndex->Remove(entry);
+
             delete entry->m_callbackUserData;
             delete entry;
 
@@ -21,6 +21,7 @@
 #include "wx/scopeguard.h"
 #include "wx/apptrait.h"
 #include "wx/private/eventloopsourcesmanager.h"
+#include "wx/private/eventtrace.h"
 
 // Counts currently existing event loops.
 //
@@ -101,6 +102,8 @@ void wxEventLoopBase::OnExit()
 
 bool wxEventLoopBase::ProcessIdle()
 {
+    wxEventTraceScope traceScope(wxEVENT_TRACE_IDLE);
+
     return wxTheApp && wxTheApp->ProcessIdle();
 }
 
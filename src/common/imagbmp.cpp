@@ -34,6 +34,7 @@
 #include "wx/scopedptr.h"
 #include "wx/anidecod.h"
 #include "wx/private/icondir.h"
+#include "wx/private/image.h"
 
 // For memcpy
 #include <string.h>
@@ -494,6 +495,26 @@ bool wxBMPHandler::SaveDib(wxImage *image,
 }
 
 
+// Find the shift, i.e. the position of the least significant bit, and the
+// number of bits in the given bit field mask.
+static void GetBitfieldShiftAndBits(wxUint32 mask, int bpp, int& shift, int& bits)
+{
+    shift =
+    bits = 0;
+
+    for ( int bit = bpp - 1; bit >= 0; bit-- )
+    {
+        if ( mask & (1u << bit) )
+            shift = bit;
+    }
+
+    for ( int bit = 0; bit < bpp; bit++ )
+    {
+        if ( mask & (1u << bit) )
+            bits = bit - shift + 1;
+    }
+}
+
 struct BMPPalette
 {
     static void Free(BMPPalette* pal) { delete [] pal; }
@@ -623,33 +644,15 @@ bool wxBMPHandler::DoLoadDib(wxImage * image, int width, int height,
     {
         if ( comp == BI_BITFIELDS )
         {
-            int bit;
             if ( !stream.ReadAll(dbuf, 4 * 3) )
                 return false;
 
             rmask = wxINT32_SWAP_ON_BE(dbuf[0]);
             gmask = wxINT32_SWAP_ON_BE(dbuf[1]);
             bmask = wxINT32_SWAP_ON_BE(dbuf[2]);
-            // find shift amount (Least significant bit of mask)
-            for (bit = bpp-1; bit>=0; bit--)
-            {
-                if (bmask & (1 << bit))
-                    bshift = bit;
-                if (gmask & (1 << bit))
-                    gshift = bit;
-                if (rmask & (1 << bit))
-                    rshift = bit;
-            }
-            // Find number of bits in mask (MSB-LSB+1)
-            for (bit = 0; bit < bpp; bit++)
-            {
-                if (bmask & (1 << bit))
-                    bbits = bit-bshift+1;
-                if (gmask & (1 << bit))
-                    gbits = bit-gshift+1;
-                if (rmask & (1 << bit))
-                    rbits = bit-rshift+1;
-            }
+            GetBitfieldShiftAndBits(rmask, bpp, rshift, rbits);
+            GetBitfieldShiftAndBits(gmask, bpp, gshift, gbits);
+            GetBitfieldShiftAndBits(bmask, bpp, bshift, bbits);
         }
         else if ( bpp == 16 )
         {
@@ -999,14 +1002,36 @@ bool wxBMPHandler::DoLoadDib(wxImage * image, int width, int height,
     return err == wxSTREAM_NO_ERROR || err == wxSTREAM_EOF;
 }
 
-bool wxBMPHandler::LoadDib(wxImage *image, wxInputStream& stream,
-                           bool verbose, bool IsBmp)
+namespace
+{
+
+// Information from the DIB header needed for loading it.
+struct DibHeader
+{
+    // offset to bitmap data, only used for BMP files
+    wxFileOffset offset;
+
+    int width,
+        height;     // negative for top-to-bottom bitmaps
+    int bpp;
+    int comp;
+    int ncolors;
+
+    // whether the header uses old v1 format, with 3 byte palette entries
+    bool usesV1;
+
+    // resolution in pixels per centimeter, if specified
+    bool hasResolution;
+    int resX,
+        resY;
+};
+
+bool ReadDibHeader(wxInputStream& stream, bool verbose, bool IsBmp,
+                   DibHeader& hdr)
 {
     wxUint16        aWord;
     wxInt32         dbuf[4];
 
-    // offset to bitmap data
-    wxFileOffset offset;
     // DIB header size (used to distinguish different versions of DIB header)
     wxInt32 hdrSize;
     if ( IsBmp )
@@ -1020,7 +1045,7 @@ bool wxBMPHandler::LoadDib(wxImage *image, wxInputStream& stream,
         #if 0 // unused
             wxInt32 size = wxINT32_SWAP_ON_BE(dbuf[0]);
         #endif
-        offset = wxINT32_SWAP_ON_BE(dbuf[2]);
+        hdr.offset = wxINT32_SWAP_ON_BE(dbuf[2]);
         hdrSize = wxINT32_SWAP_ON_BE(dbuf[3]);
     }
     else
@@ -1028,7 +1053,7 @@ bool wxBMPHandler::LoadDib(wxImage *image, wxInputStream& stream,
         if ( !stream.ReadAll(dbuf, 4) )
             return false;
 
-        offset = wxInvalidOffset; // not used in loading ICO/CUR DIBs
+        hdr.offset = wxInvalidOffset; // not used in loading ICO/CUR DIBs
         hdrSize = wxINT32_SWAP_ON_BE(dbuf[0]);
     }
 
@@ -1036,11 +1061,11 @@ bool wxBMPHandler::LoadDib(wxImage *image, wxInputStream& stream,
     // format (typically BITMAPV5HEADER, but we don't
     // really support any features specific to later formats such as gamma
     // correction or ICC profiles, so it doesn't matter much to us).
-    const bool usesV1 = hdrSize == 12;
+    hdr.usesV1 = hdrSize == 12;
 
     int width;
     int height;
-    if ( usesV1 )
+    if ( hdr.usesV1 )
     {
         wxInt16 buf[2];
         if ( !stream.ReadAll(buf, sizeof(buf)) )
@@ -1076,6 +1101,9 @@ bool wxBMPHandler::LoadDib(wxImage *image, wxInputStream& stream,
         return false;
     }
 
+    hdr.width = width;
+    hdr.height = height;
+
     if ( !stream.ReadAll(&aWord, 2) )
         return false;
 
@@ -1096,40 +1124,15 @@ bool wxBMPHandler::LoadDib(wxImage *image, wxInputStream& stream,
         return false;
     }
 
-    class Resolution
-    {
-    public:
-        Resolution()
-        {
-            m_valid = false;
-
-            // Still initialize them as some compilers are smart enough to
-            // give "use of possibly uninitialized variable" for them (but not
-            // smart enough to see that this is not really the case).
-            m_x =
-            m_y = 0;
-        }
-
-        void Init(int x, int y)
-        {
-            m_x = x;
-            m_y = y;
-            m_valid = true;
-        }
-
-        bool IsValid() const { return m_valid; }
+    hdr.bpp = bpp;
+    hdr.hasResolution = false;
+    hdr.resX =
+    hdr.resY = 0;
 
-        int GetX() const { return m_x; }
-        int GetY() const { return m_y; }
-
-    private:
-        int m_x, m_y;
-        bool m_valid;
-    } res;
     int comp;
     int ncolors;
 
-    if ( usesV1 )
+    if ( hdr.usesV1 )
     {
         // The only possible format is BI_RGB and colours count is not used.
         comp = BI_RGB;
@@ -1155,7 +1158,9 @@ bool wxBMPHandler::LoadDib(wxImage *image, wxInputStream& stream,
             return false;
 
         ncolors = wxINT32_SWAP_ON_BE( (int)dbuf[0] );
-        res.Init(dbuf[2]/100, dbuf[3]/100);
+        hdr.hasResolution = true;
+        hdr.resX = dbuf[2]/100;
+        hdr.resY = dbuf[3]/100;
 
         // We've read BITMAPINFOHEADER data but for BITMAPV4HEADER or BITMAPV5HEADER
         // we have to forward stream position to after the actual bitmap header.
@@ -1183,10 +1188,25 @@ bool wxBMPHandler::LoadDib(wxImage *image, wxInputStream& stream,
         return false;
     }
 
+    hdr.comp = comp;
+    hdr.ncolors = ncolors;
+
+    return true;
+}
+
+} // anonymous namespace
+
+bool wxBMPHandler::LoadDib(wxImage *image, wxInputStream& stream,
+                           bool verbose, bool IsBmp)
+{
+    DibHeader hdr;
+    if ( !ReadDibHeader(stream, verbose, IsBmp, hdr) )
+        return false;
+
     //read DIB; this is the BMP image or the XOR part of an icon image
-    if ( !DoLoadDib(image, width, height, bpp, ncolors, comp, offset, stream,
-                    verbose, IsBmp, true,
-                    usesV1 ? 3 : 4) )
+    if ( !DoLoadDib(image, hdr.width, hdr.height, hdr.bpp, hdr.ncolors,
+                    hdr.comp, hdr.offset, stream, verbose, IsBmp, true,
+                    hdr.usesV1 ? 3 : 4) )
     {
         if (verbose)
         {
@@ -1200,8 +1220,8 @@ bool wxBMPHandler::LoadDib(wxImage *image, wxInputStream& stream,
         //read Icon mask which is monochrome
         //there is no palette, so we will create one
         wxImage mask;
-        if ( !DoLoadDib(&mask, width, height, 1, 2, BI_RGB, offset, stream,
-                        verbose, IsBmp, false) )
+        if ( !DoLoadDib(&mask, hdr.width, hdr.height, 1, 2, BI_RGB,
+                        hdr.offset, stream, verbose, IsBmp, false) )
         {
             if (verbose)
             {
@@ -1214,11 +1234,11 @@ bool wxBMPHandler::LoadDib(wxImage *image, wxInputStream& stream,
     }
 
     // the resolution in the bitmap header is in meters, convert to centimeters
-    if ( res.IsValid() )
+    if ( hdr.hasResolution )
     {
         image->SetOption(wxIMAGE_OPTION_RESOLUTIONUNIT, wxIMAGE_RESOLUTION_CM);
-        image->SetOption(wxIMAGE_OPTION_RESOLUTIONX, res.GetX());
-        image->SetOption(wxIMAGE_OPTION_RESOLUTIONY, res.GetY());
+        image->SetOption(wxIMAGE_OPTION_RESOLUTIONX, hdr.resX);
+        image->SetOption(wxIMAGE_OPTION_RESOLUTIONY, hdr.resY);
     }
 
     return true;
@@ -1231,6 +1251,338 @@ bool wxBMPHandler::LoadFile(wxImage *image, wxInputStream& stream,
     return LoadDib(image, stream, verbose, true/*isBmp*/);
 }
 
+namespace
+{
+
+// Decoder for uncompressed DIB data used for loading it progressively.
+class DibRowDecoder
+{
+public:
+    explicit DibRowDecoder(const DibHeader& hdr)
+        : m_hdr(hdr)
+    {
+        for ( int n = 0; n < 4; n++ )
+        {
+            m_masks[n] = 0;
+            m_shifts[n] =
+            m_bits[n] = 0;
+        }
+    }
+
+    // Read the palette or the bit fields following the header.
+    bool ReadColourInfo(wxInputStream& stream)
+    {
+        const int bpp = m_hdr.bpp;
+        if ( bpp < 16 )
+        {
+            // Use black for any indices not present in the palette.
+            m_cmap.resize(wxMax(m_hdr.ncolors, 1 << bpp));
+
+            const int colEntrySize = m_hdr.usesV1 ? 3 : 4;
+            for ( int j = 0; j < m_hdr.ncolors; j++ )
+            {
+                wxUint8 bbuf[4];
+                if ( !stream.ReadAll(bbuf, colEntrySize) )
+                    return false;
+
+                m_cmap[j].b = bbuf[0];
+                m_cmap[j].g = bbuf[1];
+                m_cmap[j].r = bbuf[2];
+            }
+        }
+        else if ( m_hdr.comp == BI_BITFIELDS )
+        {
+            wxInt32 dbuf[3];
+            if ( !stream.ReadAll(dbuf, 4 * 3) )
+                return false;
+
+            for ( int n = 0; n < 3; n++ )
+            {
+                m_masks[n] = wxINT32_SWAP_ON_BE(dbuf[n]);
+                GetBitfieldShiftAndBits(m_masks[n], bpp,
+                                        m_shifts[n], m_bits[n]);
+            }
+        }
+        else if ( bpp == 16 )
+        {
+            SetMask(0, 0x7C00, 10, 5);
+            SetMask(1, 0x03E0, 5, 5);
+            SetMask(2, 0x001F, 0, 5);
+        }
+        else if ( bpp == 32 )
+        {
+            SetMask(0, 0x00FF0000, 16, 8);
+            SetMask(1, 0x0000FF00, 8, 8);
+            SetMask(2, 0x000000FF, 0, 8);
+            SetMask(3, 0xFF000000, 24, 8);
+        }
+
+        return true;
+    }
+
+    // Check if the image has the alpha channel.
+    bool HasAlphaMask() const { return m_masks[3] != 0; }
+
+    // Get the alpha value of the given pixel of a row.
+    unsigned char GetAlpha(const unsigned char* src, int x) const
+    {
+        return static_cast<unsigned char>
+               (
+                    (GetDword(src + 4*x) & m_masks[3]) >> m_shifts[3]
+               );
+    }
+
+    // Decode a single row.
+    void DecodeRow(const unsigned char* src,
+                   unsigned char* dst,
+                   unsigned char* alpha) const
+    {
+        const int width = m_hdr.width;
+        switch ( m_hdr.bpp )
+        {
+            case 1:
+                for ( int x = 0; x < width; x++ )
+                    SetFromPalette(dst, x, (src[x / 8] >> (7 - x % 8)) & 1);
+                break;
+
+            case 4:
+                for ( int x = 0; x < width; x++ )
+                {
+                    const unsigned char b = src[x / 2];
+                    SetFromPalette(dst, x, x % 2 ? b & 0x0F : b >> 4);
+                }
+                break;
+
+            case 8:
+                for ( int x = 0; x < width; x++ )
+                    SetFromPalette(dst, x, src[x]);
+                break;
+
+            case 16:
+                for ( int x = 0; x < width; x++ )
+                {
+                    const wxUint32 w = src[2*x] | (src[2*x + 1] << 8);
+                    for ( int n = 0; n < 3; n++ )
+                    {
+                        *dst++ = static_cast<unsigned char>
+                                 (
+                                    ((w & m_masks[n]) >> m_shifts[n])
+                                        << (8 - m_bits[n])
+                                 );
+                    }
+                }
+                break;
+
+            case 24:
+                for ( int x = 0; x < width; x++, src += 3 )
+                {
+                    *dst++ = src[2];
+                    *dst++ = src[1];
+                    *dst++ = src[0];
+                }
+                break;
+
+            case 32:
+                for ( int x = 0; x < width; x++ )
+                {
+                    const wxUint32 dw = GetDword(src + 4*x);
+                    for ( int n = 0; n < 3; n++ )
+                    {
+                        *dst++ = static_cast<unsigned char>
+                                 (
+                                    (dw & m_masks[n]) >> m_shifts[n]
+                                 );
+                    }
+
+                    if ( alpha )
+                        *alpha++ = GetAlpha(src, x);
+                }
+                break;
+        }
+    }
+
+private:
+    static wxUint32 GetDword(const unsigned char* p)
+    {
+        return p[0] | (p[1] << 8) | (p[2] << 16) | (wxUint32(p[3]) << 24);
+    }
+
+    void SetMask(int n, wxUint32 mask, int shift, int bits)
+    {
+        m_masks[n] = mask;
+        m_shifts[n] = shift;
+        m_bits[n] = bits;
+    }
+
+    void SetFromPalette(unsigned char* dst, int x, int index) const
+    {
+        const BMPPalette& entry = m_cmap[index];
+        dst[3*x    ] = entry.r;
+        dst[3*x + 1] = entry.g;
+        dst[3*x + 2] = entry.b;
+    }
+
+    const DibHeader& m_hdr;
+
+    wxVector<BMPPalette> m_cmap;
+
+    // R, G, B and alpha masks and their shifts and sizes for 16 and 32 bpp.
+    wxUint32 m_masks[4];
+    int m_shifts[4],
+        m_bits[4];
+};
+
+// Read the image data progressively, this is only possible for uncompressed
+// bitmaps and, for the usual bottom-to-top ones, seekable streams.
+bool DoLoadDibRows(wxImageRowSink& sink,
+                   wxInputStream& stream,
+                   const DibHeader& hdr,
+                   bool verbose)
+{
+    DibRowDecoder decoder(hdr);
+    if ( !decoder.ReadColourInfo(stream) )
+        return false;
+
+    // NOTE: seeking a positive amount in wxFromCurrent mode allows us to
+    //       load even non-seekable streams (see wxInputStream::SeekI docs)!
+    wxFileOffset dataStart = stream.TellI();
+    if ( dataStart == wxInvalidOffset )
+        return false;
+    if ( hdr.offset > dataStart )
+    {
+        if ( stream.SeekI(hdr.offset - dataStart, wxFromCurrent) == wxInvalidOffset )
+            return false;
+
+        dataStart = hdr.offset;
+    }
+
+    const int width = hdr.width;
+    const bool isUpsideDown = hdr.height > 0;
+    const int height = isUpsideDown ? hdr.height : -hdr.height;
+    const size_t linesize = ((size_t(width) * hdr.bpp + 31) / 32) * 4;
+
+    // Allow the padding of the last row in the file to be missing.
+    const size_t padding = linesize - (size_t(width) * hdr.bpp + 7) / 8;
+
+    // As in DoLoadDib(), consider that 32bpp bitmaps without any not fully
+    // transparent pixels don't have alpha at all. Unfortunately we need to
+    // find it out before starting to decode the image, so check for it now,
+    // stopping as soon as we find any such pixel, which is usually the first
+    // one for the bitmaps really using alpha.
+    bool hasAlpha = false;
+    if ( decoder.HasAlphaMask() )
+    {
+        wxVector<unsigned char> line(linesize);
+        for ( int y = 0; y < height && !hasAlpha; y++ )
+        {
+            stream.Read(&line[0], linesize);
+            if ( stream.LastRead() < linesize - padding )
+                break;
+
+            for ( int x = 0; x < width; x++ )
+            {
+                if ( decoder.GetAlpha(&line[0], x) != wxALPHA_TRANSPARENT )
+                {
+                    hasAlpha = true;
+                    break;
+                }
+            }
+        }
+
+        if ( stream.SeekI(dataStart) == wxInvalidOffset )
+            return false;
+    }
+
+    if ( !sink.OnBegin(width, height, hasAlpha) )
+        return false;
+
+    // Read the data in bands of several rows, not too big to avoid using too
+    // much memory, but big enough to avoid seeking too often.
+    static const size_t BAND_SIZE = 1024*1024;
+    const int rowsPerBand = wxMax(1, wxMin(height, int(BAND_SIZE / linesize)));
+
+    wxVector<unsigned char> raw(rowsPerBand*linesize),
+                            data(size_t(rowsPerBand)*width*3),
+                            alpha(hasAlpha ? size_t(rowsPerBand)*width : 0);
+
+    for ( int y = 0; y < height; y += rowsPerBand )
+    {
+        const int count = wxMin(rowsPerBand, height - y);
+
+        if ( isUpsideDown )
+        {
+            // The rows are stored from bottom to top, so the rows of this
+            // band are the last ones of the remaining part of the data.
+            const wxFileOffset
+                pos = dataStart + wxFileOffset(height - y - count)*linesize;
+            if ( stream.SeekI(pos) == wxInvalidOffset )
+                return false;
+        }
+
+        const size_t size = count*linesize;
+        stream.Read(&raw[0], size);
+        if ( stream.LastRead() < size - padding )
+        {
+            if ( verbose )
+            {
+                wxLogError( _("Error in reading image DIB.") );
+            }
+            return false;
+        }
+
+        for ( int n = 0; n < count; n++ )
+        {
+            const int line = isUpsideDown ? count - 1 - n : n;
+            decoder.DecodeRow(&raw[line*linesize],
+                              &data[size_t(n)*width*3],
+                              hasAlpha ? &alpha[size_t(n)*width] : NULL);
+        }
+
+        if ( !sink.OnRows(y, count, &data[0], hasAlpha ? &alpha[0] : NULL) )
+            return false;
+    }
+
+    return true;
+}
+
+} // anonymous namespace
+
+bool wxBMPHandler::LoadRows(wxImageRowSink& sink, wxInputStream& stream,
+                            int scale, bool verbose, int WXUNUSED(index))
+{
+    wxCHECK_MSG( scale >= 1, false, wxS("invalid scale") );
+
+    DibHeader hdr;
+    if ( !ReadDibHeader(stream, verbose, true/*isBmp*/, hdr) )
+        return false;
+
+    wxImageRowReducer reducer(sink, scale);
+
+    // Compressed bitmaps can only be loaded entirely, as well as the bottom
+    // to top ones or those that need to be checked for alpha before loading
+    // them if we can't seek in the stream.
+    if ( hdr.comp == BI_RLE4 || hdr.comp == BI_RLE8 ||
+            (!stream.IsSeekable() &&
+                (hdr.height > 0 || (hdr.bpp == 32 && hdr.comp == BI_RGB))) )
+    {
+        wxImage image;
+        if ( !DoLoadDib(&image, hdr.width, hdr.height, hdr.bpp, hdr.ncolors,
+                        hdr.comp, hdr.offset, stream, verbose, true, true,
+                        hdr.usesV1 ? 3 : 4) )
+        {
+            if (verbose)
+            {
+                wxLogError( _("Error in reading image DIB.") );
+            }
+            return false;
+        }
+
+        return wxSendImageToRowSink(image, reducer);
+    }
+
+    return DoLoadDibRows(reducer, stream, hdr, verbose);
+}
+
 bool wxBMPHandler::DoCanRead(wxInputStream& stream)
 {
     unsigned char hdr[2];
@@ -27,10 +27,58 @@
 
 #include "wx/wfstream.h"
 #include "wx/xpmdecod.h"
+#include "wx/thread.h"
+#include "wx/private/image.h"
 
 // For memcpy
 #include <string.h>
 
+// SIMD versions of the resampling kernels are only used on 64-bit platforms
+// where the scalar floating point code is guaranteed to use the same IEEE
+// double precision arithmetic as the vector one, as otherwise their results
+// could differ from the reference scalar implementation.
+//
+// Notice that the vector kernels process all the channels of a single pixel
+// at once rather than several pixels, so AVX, which can only use 3 or 4 of
+// its 4 lanes for this, is not significantly faster than SSE2.
+#if defined(__x86_64__) || defined(_M_X64)
+    #define wxHAS_IMAGE_RESAMPLE_SSE2
+
+    #include <emmintrin.h>
+
+    // AVX is not guaranteed to be available, so we compile the code using it
+    // even when it's not enabled globally and check for it at run-time.
+    #if defined(__clang__) || wxCHECK_GCC_VERSION(4, 9)
+        #define wxHAS_IMAGE_RESAMPLE_AVX
+        #define wxIMAGE_TARGET_AVX __attribute__((target("avx")))
+
+        #include <immintrin.h>
+    #elif wxCHECK_VISUALC_VERSION(11)
+        #define wxHAS_IMAGE_RESAMPLE_AVX
+        #define wxIMAGE_TARGET_AVX
+
+        #include <immintrin.h>
+        #include <intrin.h>
+    #endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define wxHAS_IMAGE_RESAMPLE_NEON
+
+    #include <arm_neon.h>
+#endif
+
+// The results are only bit-identical if the compiler doesn't contract the
+// multiplications and additions into fused multiply-add instructions, which
+// it may do in either the scalar or the vector code (intrinsics are just
+// vector operations for gcc), e.g. gcc does it by default on ARM64 and when
+// FMA is enabled on x86-64, so disable contraction for this file.
+#if defined(__clang__)
+    #pragma STDC FP_CONTRACT OFF
+#elif wxCHECK_GCC_VERSION(4, 6)
+    #pragma GCC optimize("fp-contract=off")
+#elif wxCHECK_VISUALC_VERSION(8)
+    #pragma fp_contract(off)
+#endif
+
 // make the code compile with either wxFile*Stream or wxFFile*Stream:
 #define HAS_FILE_STREAMS (wxUSE_STREAMS && (wxUSE_FILE || wxUSE_FFILE))
 
@@ -95,6 +143,16 @@ public:
     wxArrayString   m_optionNames;
     wxArrayString   m_optionValues;
 
+    // interleaved copy of m_data and m_alpha cached by GetRGBAData(), may be
+    // invalid
+    wxImageRGBAData m_rgba;
+
+#if wxUSE_THREADS
+    // protects m_rgba which can be updated by GetRGBAData() called for the
+    // images sharing this data from different threads
+    wxCriticalSection m_rgbaCS;
+#endif // wxUSE_THREADS
+
     wxDECLARE_NO_COPY_CLASS(wxImageRefData);
 };
 
@@ -220,6 +278,8 @@ void wxImage::Destroy()
 
 void wxImage::Clear(unsigned char value)
 {
+    InvalidateRGBAData();
+
     memset(M_IMGDATA->m_data, value, M_IMGDATA->m_width*M_IMGDATA->m_height*3);
 }
 
@@ -499,6 +559,450 @@ wxImage::Scale( int width, int height, wxImageResizeQuality quality ) const
     return image;
 }
 
+//-----------------------------------------------------------------------------
+// Parallel processing support
+//-----------------------------------------------------------------------------
+
+namespace
+{
+
+// The number of threads to use as set by wxImage::SetThreadCount().
+int gs_imageThreadCount = 1;
+
+// Images smaller than this number of pixels are always processed serially as
+// the overhead of using several threads would outweigh any gains.
+const size_t MIN_PIXELS_FOR_THREADS = 128*128;
+
+// Base class for the operations which can be split into independent bands of
+// rows or columns and processed by several threads at once.
+//
+// As each item is always processed in exactly the same way, the result doesn't
+// depend on the number of threads used.
+class ImageBandsTask
+{
+public:
+    // Process all items (rows or columns) in [start, end) range.
+    virtual void ProcessBand(int start, int end) = 0;
+
+protected:
+    virtual ~ImageBandsTask() { }
+};
+
+#if wxUSE_THREADS
+
+// Pool of threads reused by all image operations.
+class ImageThreadPool
+{
+public:
+    // Create the pool running the given number of threads in total, including
+    // the thread calling Run().
+    explicit ImageThreadPool(int numThreads);
+    ~ImageThreadPool();
+
+    int GetThreadCount() const { return m_numThreads; }
+
+    // Process all bands of the given task, only returns when it's done.
+    void Run(ImageBandsTask& task, int count);
+
+    // Called from the worker threads.
+    void DoWork();
+
+private:
+    // Process the next band of the current task, must be called with m_mutex
+    // locked and with m_next < m_count.
+    void ProcessNextBand();
+
+    const int m_numThreads;
+
+    wxMutex m_mutex;
+
+    // Signalled when a new task is available or when the pool is destroyed.
+    wxCondition m_condWork;
+
+    // Signalled when the last band of the current task is processed.
+    wxCondition m_condDone;
+
+    wxVector<wxThread*> m_threads;
+
+    // The task currently being processed, if any, and its state.
+    ImageBandsTask* m_task;
+    int m_count,
+        m_bandSize,
+        m_next,
+        m_bandsLeft;
+
+    bool m_exit;
+
+    wxDECLARE_NO_COPY_CLASS(ImageThreadPool);
+};
+
+class ImageWorkerThread : public wxThread
+{
+public:
+    explicit ImageWorkerThread(ImageThreadPool& pool)
+        : wxThread(wxTHREAD_JOINABLE),
+          m_pool(pool)
+    {
+    }
+
+protected:
+    virtual ExitCode Entry() wxOVERRIDE
+    {
+        m_pool.DoWork();
+
+        return 0;
+    }
+
+private:
+    ImageThreadPool& m_pool;
+
+    wxDECLARE_NO_COPY_CLASS(ImageWorkerThread);
+};
+
+ImageThreadPool::ImageThreadPool(int numThreads)
+    : m_numThreads(numThreads),
+      m_condWork(m_mutex),
+      m_condDone(m_mutex)
+{
+    m_task = NULL;
+    m_count =
+    m_bandSize =
+    m_next =
+    m_bandsLeft = 0;
+    m_exit = false;
+
+    for ( int n = 1; n < numThreads; n++ )
+    {
+        wxThread* const thread = new ImageWorkerThread(*this);
+        if ( thread->Run() != wxTHREAD_NO_ERROR )
+        {
+            // Not fatal, we'll just use fewer threads.
+            delete thread;
+            break;
+        }
+
+        m_threads.push_back(thread);
+    }
+}
+
+ImageThreadPool::~ImageThreadPool()
+{
+    {
+        wxMutexLocker lock(m_mutex);
+        m_exit = true;
+        m_condWork.Broadcast();
+    }
+
+    for ( size_t n = 0; n < m_threads.size(); n++ )
+    {
+        m_threads[n]->Wait();
+        delete m_threads[n];
+    }
+}
+
+void ImageThreadPool::ProcessNextBand()
+{
+    const int start = m_next;
+    const int end = wxMin(start + m_bandSize, m_count);
+    m_next = end;
+
+    ImageBandsTask* const task = m_task;
+
+    m_mutex.Unlock();
+    task->ProcessBand(start, end);
+    m_mutex.Lock();
+
+    if ( --m_bandsLeft == 0 )
+        m_condDone.Signal();
+}
+
+void ImageThreadPool::DoWork()
+{
+    wxMutexLocker lock(m_mutex);
+
+    for ( ;; )
+    {
+        while ( !m_exit && m_next >= m_count )
+            m_condWork.Wait();
+
+        if ( m_exit )
+            break;
+
+        ProcessNextBand();
+    }
+}
+
+void ImageThreadPool::Run(ImageBandsTask& task, int count)
+{
+    wxMutexLocker lock(m_mutex);
+
+    // Use a few bands per thread to balance the load if some of them are
+    // slower than the others.
+    const int numBands = wxMin(count, 4*(int(m_threads.size()) + 1));
+
+    m_task = &task;
+    m_count = count;
+    m_next = 0;
+    m_bandSize = (count + numBands - 1) / numBands;
+    m_bandsLeft = (count + m_bandSize - 1) / m_bandSize;
+
+    m_condWork.Broadcast();
+
+    // Do our share of work in this thread too.
+    while ( m_next < m_count )
+        ProcessNextBand();
+
+    while ( m_bandsLeft )
+        m_condDone.Wait();
+
+    m_task = NULL;
+    m_count =
+    m_next = 0;
+}
+
+// The global pool, created on demand.
+ImageThreadPool* gs_imageThreadPool = NULL;
+
+// True while the pool is used by some thread.
+bool gs_imageThreadPoolBusy = false;
+
+wxCriticalSection gs_csImageThreadPool;
+
+// Get the pool with the given number of threads for exclusive use, returns
+// NULL if it's already being used, e.g. by another thread or because an image
+// operation is performed from inside another one. The pool must be released
+// by calling ReleaseImageThreadPool() if non-NULL is returned.
+ImageThreadPool* AcquireImageThreadPool(int numThreads)
+{
+    wxCriticalSectionLocker lock(gs_csImageThreadPool);
+
+    if ( gs_imageThreadPoolBusy )
+        return NULL;
+
+    if ( gs_imageThreadPool &&
+            gs_imageThreadPool->GetThreadCount() != numThreads )
+    {
+        delete gs_imageThreadPool;
+        gs_imageThreadPool = NULL;
+    }
+
+    if ( !gs_imageThreadPool )
+        gs_imageThreadPool = new ImageThreadPool(numThreads);
+
+    gs_imageThreadPoolBusy = true;
+
+    return gs_imageThreadPool;
+}
+
+void ReleaseImageThreadPool()
+{
+    wxCriticalSectionLocker lock(gs_csImageThreadPool);
+
+    gs_imageThreadPoolBusy = false;
+}
+
+void DeleteImageThreadPool()
+{
+    wxCriticalSectionLocker lock(gs_csImageThreadPool);
+
+    wxASSERT_MSG( !gs_imageThreadPoolBusy, "image thread pool still in use" );
+
+    wxDELETE(gs_imageThreadPool);
+}
+
+#endif // wxUSE_THREADS
+
+// Get the number of threads to use, taking into account the special value 0.
+int GetImageThreadCount()
+{
+    if ( gs_imageThreadCount )
+        return gs_imageThreadCount;
+
+#if wxUSE_THREADS
+    const int numCPUs = wxThread::GetCPUCount();
+    if ( numCPUs > 1 )
+        return numCPUs;
+#endif // wxUSE_THREADS
+
+    return 1;
+}
+
+// Process all "count" items of the given task, each of them consisting of the
+// given number of pixels, using multiple threads if allowed and worth it.
+void ProcessImageBands(ImageBandsTask& task, int count, int pixelsPerItem)
+{
+#if wxUSE_THREADS
+    const int numThreads = GetImageThreadCount();
+    if ( numThreads > 1 && count > 1 &&
+            size_t(count)*pixelsPerItem >= MIN_PIXELS_FOR_THREADS )
+    {
+        ImageThreadPool* const pool = AcquireImageThreadPool(numThreads);
+        if ( pool )
+        {
+            pool->Run(task, count);
+
+            ReleaseImageThreadPool();
+
+            return;
+        }
+    }
+#else // !wxUSE_THREADS
+    wxUnusedVar(pixelsPerItem);
+#endif // wxUSE_THREADS/!wxUSE_THREADS
+
+    task.ProcessBand(0, count);
+}
+
+} // anonymous namespace
+
+/* static */
+void wxImage::SetThreadCount(int count)
+{
+    wxCHECK_RET( count >= 0, wxS("invalid number of threads") );
+
+    gs_imageThreadCount = count;
+}
+
+/* static */
+int wxImage::GetThreadCount()
+{
+    return gs_imageThreadCount;
+}
+
+namespace
+{
+
+// Task used by all resampling functions except the nearest neighbour one:
+// they all compute each row of the destination image independently using the
+// precomputed coefficients for the rows and columns of the source image.
+template <typename Precalc>
+class ResampleRowsTask : public ImageBandsTask
+{
+public:
+    typedef void (*RowFunc)(const unsigned char* src_data,
+                            const unsigned char* src_alpha,
+                            int srcWidth,
+                            const Precalc& vPrecalc,
+                            const wxVector<Precalc>& hPrecalcs,
+                            unsigned char* dst_data,
+                            unsigned char* dst_alpha);
+
+    ResampleRowsTask(RowFunc doRow,
+                     const unsigned char* src_data,
+                     const unsigned char* src_alpha,
+                     int srcWidth,
+                     const wxVector<Precalc>& vPrecalcs,
+                     const wxVector<Precalc>& hPrecalcs,
+                     unsigned char* dst_data,
+                     unsigned char* dst_alpha)
+        : m_doRow(doRow),
+          m_src_data(src_data),
+          m_src_alpha(src_alpha),
+          m_srcWidth(srcWidth),
+          m_vPrecalcs(vPrecalcs),
+          m_hPrecalcs(hPrecalcs),
+          m_dst_data(dst_data),
+          m_dst_alpha(dst_alpha)
+    {
+    }
+
+    virtual void ProcessBand(int start, int end) wxOVERRIDE
+    {
+        const size_t width = m_hPrecalcs.size();
+
+        for ( int y = start; y < end; y++ )
+        {
+            m_doRow(m_src_data, m_src_alpha, m_srcWidth,
+                    m_vPrecalcs[y], m_hPrecalcs,
+                    m_dst_data + 3*width*y,
+                    m_dst_alpha ? m_dst_alpha + width*y : NULL);
+        }
+    }
+
+private:
+    const RowFunc m_doRow;
+    const unsigned char* const m_src_data;
+    const unsigned char* const m_src_alpha;
+    const int m_srcWidth;
+    const wxVector<Precalc>& m_vPrecalcs;
+    const wxVector<Precalc>& m_hPrecalcs;
+    unsigned char* const m_dst_data;
+    unsigned char* const m_dst_alpha;
+
+    wxDECLARE_NO_COPY_TEMPLATE_CLASS(ResampleRowsTask, Precalc);
+};
+
+class ResampleNearestTask : public ImageBandsTask
+{
+public:
+    ResampleNearestTask(const unsigned char* source_data,
+                        const unsigned char* source_alpha,
+                        unsigned long old_width,
+                        unsigned long old_height,
+                        unsigned char* target_data,
+                        unsigned char* target_alpha,
+                        int width,
+                        int height)
+        : m_source_data(source_data),
+          m_source_alpha(source_alpha),
+          m_old_width(old_width),
+          m_target_data(target_data),
+          m_target_alpha(target_alpha),
+          m_width(width),
+          m_x_delta((old_width  << 16) / width),
+          m_y_delta((old_height << 16) / height)
+    {
+    }
+
+    virtual void ProcessBand(int start, int end) wxOVERRIDE
+    {
+        const unsigned char* const source_data = m_source_data;
+        const unsigned char* const source_alpha = m_source_alpha;
+        const unsigned long old_width = m_old_width;
+        const int width = m_width;
+
+        unsigned char* dest_pixel = m_target_data + size_t(start)*width*3;
+        unsigned char* target_alpha = m_target_alpha
+                                        ? m_target_alpha + size_t(start)*width
+                                        : NULL;
+
+        unsigned long y = start*m_y_delta;
+        for (int j = start; j < end; j++)
+        {
+            const unsigned char* src_line = &source_data[(y>>16)*old_width*3];
+            const unsigned char* src_alpha_line = source_alpha ? &source_alpha[(y>>16)*old_width] : 0 ;
+
+            unsigned long x = 0;
+            for (int i = 0; i < width; i++)
+            {
+                const unsigned char* src_pixel = &src_line[(x>>16)*3];
+                const unsigned char* src_alpha_pixel = source_alpha ? &src_alpha_line[(x>>16)] : 0 ;
+                dest_pixel[0] = src_pixel[0];
+                dest_pixel[1] = src_pixel[1];
+                dest_pixel[2] = src_pixel[2];
+                dest_pixel += 3;
+                if ( source_alpha )
+                    *(target_alpha++) = *src_alpha_pixel ;
+                x += m_x_delta;
+            }
+
+            y += m_y_delta;
+        }
+    }
+
+private:
+    const unsigned char* const m_source_data;
+    const unsigned char* const m_source_alpha;
+    const unsigned long m_old_width;
+    unsigned char* const m_target_data;
+    unsigned char* const m_target_alpha;
+    const int m_width;
+    const unsigned long m_x_delta;
+    const unsigned long m_y_delta;
+};
+
+} // anonymous namespace
+
 wxImage wxImage::ResampleNearest(int width, int height) const
 {
     wxImage image;
@@ -529,35 +1033,150 @@ wxImage wxImage::ResampleNearest(int width, int height) const
         }
     }
 
-    const unsigned long x_delta = (old_width  << 16) / width;
-    const unsigned long y_delta = (old_height << 16) / height;
+    ResampleNearestTask task(source_data, source_alpha, old_width, old_height,
+                             target_data, target_alpha, width, height);
+    ProcessImageBands(task, height, width);
+
+    return image;
+}
+
+// ----------------------------------------------------------------------------
+// Resampling kernels implementation selection
+// ----------------------------------------------------------------------------
+
+namespace
+{
+
+#ifdef wxHAS_IMAGE_RESAMPLE_AVX
+
+bool CPUHasAVX()
+{
+#ifdef __VISUALC__
+    int info[4];
+    __cpuid(info, 1);
+
+    // Check that the CPU supports AVX and that the OS saves its registers.
+    const int osxsave = 1 << 27;
+    const int avx = 1 << 28;
+    if ( (info[2] & (osxsave | avx)) != (osxsave | avx) )
+        return false;
+
+    return (_xgetbv(0) & 6) == 6;
+#else // gcc or clang
+    __builtin_cpu_init();
+
+    return __builtin_cpu_supports("avx") != 0;
+#endif // compiler
+}
+
+#endif // wxHAS_IMAGE_RESAMPLE_AVX
+
+wxImageResampleImpl GetBestResampleImpl()
+{
+#ifdef wxHAS_IMAGE_RESAMPLE_AVX
+    if ( CPUHasAVX() )
+        return wxIMAGE_RESAMPLE_IMPL_AVX;
+#endif
+
+#if defined(wxHAS_IMAGE_RESAMPLE_SSE2)
+    return wxIMAGE_RESAMPLE_IMPL_SSE2;
+#elif defined(wxHAS_IMAGE_RESAMPLE_NEON)
+    return wxIMAGE_RESAMPLE_IMPL_NEON;
+#else
+    return wxIMAGE_RESAMPLE_IMPL_SCALAR;
+#endif
+}
+
+// The implementation forced by wxImageSetResampleImpl(), if any.
+wxImageResampleImpl gs_resampleImpl = wxIMAGE_RESAMPLE_IMPL_DEFAULT;
 
-    unsigned char* dest_pixel = target_data;
+} // anonymous namespace
 
-    unsigned long y = 0;
-    for (int j = 0; j < height; j++)
+bool wxImageIsResampleImplAvailable(wxImageResampleImpl impl)
+{
+    switch ( impl )
     {
-        const unsigned char* src_line = &source_data[(y>>16)*old_width*3];
-        const unsigned char* src_alpha_line = source_alpha ? &source_alpha[(y>>16)*old_width] : 0 ;
+        case wxIMAGE_RESAMPLE_IMPL_DEFAULT:
+        case wxIMAGE_RESAMPLE_IMPL_SCALAR:
+            return true;
 
-        unsigned long x = 0;
-        for (int i = 0; i < width; i++)
-        {
-            const unsigned char* src_pixel = &src_line[(x>>16)*3];
-            const unsigned char* src_alpha_pixel = source_alpha ? &src_alpha_line[(x>>16)] : 0 ;
-            dest_pixel[0] = src_pixel[0];
-            dest_pixel[1] = src_pixel[1];
-            dest_pixel[2] = src_pixel[2];
-            dest_pixel += 3;
-            if ( source_alpha )
-                *(target_alpha++) = *src_alpha_pixel ;
-            x += x_delta;
-        }
+        case wxIMAGE_RESAMPLE_IMPL_SSE2:
+#ifdef wxHAS_IMAGE_RESAMPLE_SSE2
+            return true;
+#else
+            break;
+#endif
+
+        case wxIMAGE_RESAMPLE_IMPL_AVX:
+#ifdef wxHAS_IMAGE_RESAMPLE_AVX
+            return CPUHasAVX();
+#else
+            break;
+#endif
+
+        case wxIMAGE_RESAMPLE_IMPL_NEON:
+#ifdef wxHAS_IMAGE_RESAMPLE_NEON
+            return true;
+#else
+            break;
+#endif
 
-        y += y_delta;
+        case wxIMAGE_RESAMPLE_IMPL_MAX:
+            break;
     }
 
-    return image;
+    return false;
+}
+
+const char* wxImageGetResampleImplName(wxImageResampleImpl impl)
+{
+    switch ( impl )
+    {
+        case wxIMAGE_RESAMPLE_IMPL_DEFAULT:
+            return "default";
+
+        case wxIMAGE_RESAMPLE_IMPL_SCALAR:
+            return "scalar";
+
+        case wxIMAGE_RESAMPLE_IMPL_SSE2:
+            return "SSE2";
+
+        case wxIMAGE_RESAMPLE_IMPL_AVX:
+            return "AVX";
+
+        case wxIMAGE_RESAMPLE_IMPL_NEON:
+            return "NEON";
+
+        case wxIMAGE_RESAMPLE_IMPL_MAX:
+            break;
+    }
+
+    wxFAIL_MSG( wxS("invalid resampling implementation") );
+
+    return "";
+}
+
+wxImageResampleImpl wxImageGetResampleImpl()
+{
+    if ( gs_resampleImpl != wxIMAGE_RESAMPLE_IMPL_DEFAULT )
+        return gs_resampleImpl;
+
+    static const wxImageResampleImpl s_bestImpl = GetBestResampleImpl();
+
+    return s_bestImpl;
+}
+
+wxImageResampleImpl wxImageSetResampleImpl(wxImageResampleImpl impl)
+{
+    wxCHECK_MSG( wxImageIsResampleImplAvailable(impl),
+                 wxImageGetResampleImpl(),
+                 wxS("resampling implementation not available") );
+
+    const wxImageResampleImpl implOld = wxImageGetResampleImpl();
+
+    gs_resampleImpl = impl;
+
+    return implOld;
 }
 
 namespace
@@ -612,106 +1231,118 @@ void ResampleBoxPrecalc(wxVector<BoxPrecalc>& boxes, int oldDim)
     }
 }
 
-} // anonymous namespace
-
-wxImage wxImage::ResampleBox(int width, int height) const
+// Compute a single row of the box averaging output.
+void ResampleBoxRow(const unsigned char* src_data,
+                    const unsigned char* src_alpha,
+                    int srcWidth,
+                    const BoxPrecalc& vPrecalc,
+                    const wxVector<BoxPrecalc>& hPrecalcs,
+                    unsigned char* dst_data,
+                    unsigned char* dst_alpha)
 {
-    // This function implements a simple pre-blur/box averaging method for
-    // downsampling that gives reasonably smooth results To scale the image
-    // down we will need to gather a grid of pixels of the size of the scale
-    // factor in each direction and then do an averaging of the pixels.
+    const int width = hPrecalcs.size();
 
-    wxImage ret_image(width, height, false);
+    int averaged_pixels, src_pixel_index;
+    double sum_r, sum_g, sum_b, sum_a;
 
-    wxVector<BoxPrecalc> vPrecalcs(height);
-    wxVector<BoxPrecalc> hPrecalcs(width);
+    for ( int x = 0; x < width; x++ )      // Destination image - X direction
+    {
+        // Source pixel in the X direction
+        const BoxPrecalc& hPrecalc = hPrecalcs[x];
 
-    ResampleBoxPrecalc(vPrecalcs, M_IMGDATA->m_height);
-    ResampleBoxPrecalc(hPrecalcs, M_IMGDATA->m_width);
+        // Box of pixels to average
+        averaged_pixels = 0;
+        sum_r = sum_g = sum_b = sum_a = 0.0;
 
-
-    const unsigned char* src_data = M_IMGDATA->m_data;
-    const unsigned char* src_alpha = M_IMGDATA->m_alpha;
-    unsigned char* dst_data = ret_image.GetData();
-    unsigned char* dst_alpha = NULL;
-
-    wxCHECK_MSG( dst_data, ret_image, wxS("unable to create image") );
-
-    if ( src_alpha )
-    {
-        ret_image.SetAlpha();
-        dst_alpha = ret_image.GetAlpha();
-    }
-
-    int averaged_pixels, src_pixel_index;
-    double sum_r, sum_g, sum_b, sum_a;
-
-    for ( int y = 0; y < height; y++ )         // Destination image - Y direction
-    {
-        // Source pixel in the Y direction
-        const BoxPrecalc& vPrecalc = vPrecalcs[y];
-
-        for ( int x = 0; x < width; x++ )      // Destination image - X direction
+        for ( int j = vPrecalc.boxStart; j <= vPrecalc.boxEnd; ++j )
         {
-            // Source pixel in the X direction
-            const BoxPrecalc& hPrecalc = hPrecalcs[x];
-
-            // Box of pixels to average
-            averaged_pixels = 0;
-            sum_r = sum_g = sum_b = sum_a = 0.0;
-
-            for ( int j = vPrecalc.boxStart; j <= vPrecalc.boxEnd; ++j )
+            for ( int i = hPrecalc.boxStart; i <= hPrecalc.boxEnd; ++i )
             {
-                for ( int i = hPrecalc.boxStart; i <= hPrecalc.boxEnd; ++i )
-                {
-                    // Calculate the actual index in our source pixels
-                    src_pixel_index = j * M_IMGDATA->m_width + i;
-
-                    if (src_alpha)
-                    {
-                        sum_r += src_data[src_pixel_index * 3 + 0] * src_alpha[src_pixel_index];
-                        sum_g += src_data[src_pixel_index * 3 + 1] * src_alpha[src_pixel_index];
-                        sum_b += src_data[src_pixel_index * 3 + 2] * src_alpha[src_pixel_index];
-                        sum_a += src_alpha[src_pixel_index];
-                    }
-                    else
-                    {
-                        sum_r += src_data[src_pixel_index * 3 + 0];
-                        sum_g += src_data[src_pixel_index * 3 + 1];
-                        sum_b += src_data[src_pixel_index * 3 + 2];
-                    }
+                // Calculate the actual index in our source pixels
+                src_pixel_index = j * srcWidth + i;
 
-                    averaged_pixels++;
-                }
-            }
-
-            // Calculate the average from the sum and number of averaged pixels
-            if (src_alpha)
-            {
-                if (sum_a)
+                if (src_alpha)
                 {
-                    dst_data[0] = (unsigned char)(sum_r / sum_a);
-                    dst_data[1] = (unsigned char)(sum_g / sum_a);
-                    dst_data[2] = (unsigned char)(sum_b / sum_a);
+                    sum_r += src_data[src_pixel_index * 3 + 0] * src_alpha[src_pixel_index];
+                    sum_g += src_data[src_pixel_index * 3 + 1] * src_alpha[src_pixel_index];
+                    sum_b += src_data[src_pixel_index * 3 + 2] * src_alpha[src_pixel_index];
+                    sum_a += src_alpha[src_pixel_index];
                 }
                 else
                 {
-                    dst_data[0] = 0;
-                    dst_data[1] = 0;
-                    dst_data[2] = 0;
+                    sum_r += src_data[src_pixel_index * 3 + 0];
+                    sum_g += src_data[src_pixel_index * 3 + 1];
+                    sum_b += src_data[src_pixel_index * 3 + 2];
                 }
-                *dst_alpha++ = (unsigned char)(sum_a / averaged_pixels);
+
+                averaged_pixels++;
+            }
+        }
+
+        // Calculate the average from the sum and number of averaged pixels
+        if (src_alpha)
+        {
+            if (sum_a)
+            {
+                dst_data[0] = (unsigned char)(sum_r / sum_a);
+                dst_data[1] = (unsigned char)(sum_g / sum_a);
+                dst_data[2] = (unsigned char)(sum_b / sum_a);
             }
             else
             {
-                dst_data[0] = (unsigned char)(sum_r / averaged_pixels);
-                dst_data[1] = (unsigned char)(sum_g / averaged_pixels);
-                dst_data[2] = (unsigned char)(sum_b / averaged_pixels);
+                dst_data[0] = 0;
+                dst_data[1] = 0;
+                dst_data[2] = 0;
             }
-            dst_data += 3;
+            *dst_alpha++ = (unsigned char)(sum_a / averaged_pixels);
+        }
+        else
+        {
+            dst_data[0] = (unsigned char)(sum_r / averaged_pixels);
+            dst_data[1] = (unsigned char)(sum_g / averaged_pixels);
+            dst_data[2] = (unsigned char)(sum_b / averaged_pixels);
         }
+        dst_data += 3;
+    }
+}
+
+} // anonymous namespace
+
+wxImage wxImage::ResampleBox(int width, int height) const
+{
+    // This function implements a simple pre-blur/box averaging method for
+    // downsampling that gives reasonably smooth results To scale the image
+    // down we will need to gather a grid of pixels of the size of the scale
+    // factor in each direction and then do an averaging of the pixels.
+
+    wxImage ret_image(width, height, false);
+
+    wxVector<BoxPrecalc> vPrecalcs(height);
+    wxVector<BoxPrecalc> hPrecalcs(width);
+
+    ResampleBoxPrecalc(vPrecalcs, M_IMGDATA->m_height);
+    ResampleBoxPrecalc(hPrecalcs, M_IMGDATA->m_width);
+
+
+    const unsigned char* src_data = M_IMGDATA->m_data;
+    const unsigned char* src_alpha = M_IMGDATA->m_alpha;
+    unsigned char* dst_data = ret_image.GetData();
+    unsigned char* dst_alpha = NULL;
+
+    wxCHECK_MSG( dst_data, ret_image, wxS("unable to create image") );
+
+    if ( src_alpha )
+    {
+        ret_image.SetAlpha();
+        dst_alpha = ret_image.GetAlpha();
     }
 
+    ResampleRowsTask<BoxPrecalc> task(ResampleBoxRow,
+                                      src_data, src_alpha, M_IMGDATA->m_width,
+                                      vPrecalcs, hPrecalcs,
+                                      dst_data, dst_alpha);
+    ProcessImageBands(task, height, width);
+
     return ret_image;
 }
 
@@ -773,6 +1404,338 @@ void ResampleBilinearPrecalc(wxVector<BilinearPrecalc>& precalcs, int oldDim)
     }
 }
 
+// Signature of the functions computing a single row of the bilinear output.
+typedef void (*BilinearRowFunc)(const unsigned char* src_data,
+                                const unsigned char* src_alpha,
+                                int srcWidth,
+                                const BilinearPrecalc& vPrecalc,
+                                const wxVector<BilinearPrecalc>& hPrecalcs,
+                                unsigned char* dst_data,
+                                unsigned char* dst_alpha);
+
+// This is the reference implementation, all the others must produce exactly
+// the same results as it.
+void BilinearRowScalar(const unsigned char* src_data,
+                       const unsigned char* src_alpha,
+                       int srcWidth,
+                       const BilinearPrecalc& vPrecalc,
+                       const wxVector<BilinearPrecalc>& hPrecalcs,
+                       unsigned char* dst_data,
+                       unsigned char* dst_alpha)
+{
+    const int width = hPrecalcs.size();
+
+    const int y_offset1 = vPrecalc.offset1;
+    const int y_offset2 = vPrecalc.offset2;
+    const double dy = vPrecalc.dd;
+    const double dy1 = vPrecalc.dd1;
+
+    // initialize alpha values to avoid g++ warnings about possibly
+    // uninitialized variables
+    double r1, g1, b1, a1 = 0;
+    double r2, g2, b2, a2 = 0;
+
+    for ( int dstx = 0; dstx < width; dstx++ )
+    {
+        // X-axis of pixel to interpolate from
+        const BilinearPrecalc& hPrecalc = hPrecalcs[dstx];
+
+        const int x_offset1 = hPrecalc.offset1;
+        const int x_offset2 = hPrecalc.offset2;
+        const double dx = hPrecalc.dd;
+        const double dx1 = hPrecalc.dd1;
+
+        int src_pixel_index00 = y_offset1 * srcWidth + x_offset1;
+        int src_pixel_index01 = y_offset1 * srcWidth + x_offset2;
+        int src_pixel_index10 = y_offset2 * srcWidth + x_offset1;
+        int src_pixel_index11 = y_offset2 * srcWidth + x_offset2;
+
+        // first line
+        r1 = src_data[src_pixel_index00 * 3 + 0] * dx1 + src_data[src_pixel_index01 * 3 + 0] * dx;
+        g1 = src_data[src_pixel_index00 * 3 + 1] * dx1 + src_data[src_pixel_index01 * 3 + 1] * dx;
+        b1 = src_data[src_pixel_index00 * 3 + 2] * dx1 + src_data[src_pixel_index01 * 3 + 2] * dx;
+        if ( src_alpha )
+            a1 = src_alpha[src_pixel_index00] * dx1 + src_alpha[src_pixel_index01] * dx;
+
+        // second line
+        r2 = src_data[src_pixel_index10 * 3 + 0] * dx1 + src_data[src_pixel_index11 * 3 + 0] * dx;
+        g2 = src_data[src_pixel_index10 * 3 + 1] * dx1 + src_data[src_pixel_index11 * 3 + 1] * dx;
+        b2 = src_data[src_pixel_index10 * 3 + 2] * dx1 + src_data[src_pixel_index11 * 3 + 2] * dx;
+        if ( src_alpha )
+            a2 = src_alpha[src_pixel_index10] * dx1 + src_alpha[src_pixel_index11] * dx;
+
+        // result lines
+
+        dst_data[0] = static_cast<unsigned char>(r1 * dy1 + r2 * dy + .5);
+        dst_data[1] = static_cast<unsigned char>(g1 * dy1 + g2 * dy + .5);
+        dst_data[2] = static_cast<unsigned char>(b1 * dy1 + b2 * dy + .5);
+        dst_data += 3;
+
+        if ( src_alpha )
+            *dst_alpha++ = static_cast<unsigned char>(a1 * dy1 + a2 * dy +.5);
+    }
+}
+
+// Store the pixel computed by one of the vectorized kernels below, which
+// keep the red, green, blue and alpha components in consecutive lanes.
+inline void StoreRGBA(const double* rgba,
+                      unsigned char*& dst_data,
+                      unsigned char*& dst_alpha)
+{
+    dst_data[0] = static_cast<unsigned char>(rgba[0]);
+    dst_data[1] = static_cast<unsigned char>(rgba[1]);
+    dst_data[2] = static_cast<unsigned char>(rgba[2]);
+    dst_data += 3;
+
+    if ( dst_alpha )
+        *dst_alpha++ = static_cast<unsigned char>(rgba[3]);
+}
+
+#ifdef wxHAS_IMAGE_RESAMPLE_SSE2
+
+// Pack the components of a pixel into a single 32-bit value, which is more
+// efficient than converting them to floating point one by one.
+inline int PackRGBA(const unsigned char* p, unsigned char a)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (a << 24);
+}
+
+// Unpack the components packed by PackRGBA() into red/green and blue/alpha
+// pairs of doubles.
+inline void UnpackRGBA_SSE2(int rgba, __m128d& rg, __m128d& ba)
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    __m128i v = _mm_cvtsi32_si128(rgba);
+    v = _mm_unpacklo_epi8(v, zero);
+    v = _mm_unpacklo_epi16(v, zero);
+
+    rg = _mm_cvtepi32_pd(v);
+    ba = _mm_cvtepi32_pd(_mm_shuffle_epi32(v, _MM_SHUFFLE(3, 2, 3, 2)));
+}
+
+inline __m128d LerpSSE2(__m128d v1, __m128d d1, __m128d v2, __m128d d2)
+{
+    return _mm_add_pd(_mm_mul_pd(v1, d1), _mm_mul_pd(v2, d2));
+}
+
+void BilinearRowSSE2(const unsigned char* src_data,
+                     const unsigned char* src_alpha,
+                     int srcWidth,
+                     const BilinearPrecalc& vPrecalc,
+                     const wxVector<BilinearPrecalc>& hPrecalcs,
+                     unsigned char* dst_data,
+                     unsigned char* dst_alpha)
+{
+    const int width = hPrecalcs.size();
+
+    const int y_index1 = vPrecalc.offset1 * srcWidth;
+    const int y_index2 = vPrecalc.offset2 * srcWidth;
+    const __m128d dy = _mm_set1_pd(vPrecalc.dd);
+    const __m128d dy1 = _mm_set1_pd(vPrecalc.dd1);
+    const __m128d half = _mm_set1_pd(.5);
+
+    double rgba[4];
+    for ( int dstx = 0; dstx < width; dstx++ )
+    {
+        const BilinearPrecalc& hPrecalc = hPrecalcs[dstx];
+
+        const int index00 = y_index1 + hPrecalc.offset1;
+        const int index01 = y_index1 + hPrecalc.offset2;
+        const int index10 = y_index2 + hPrecalc.offset1;
+        const int index11 = y_index2 + hPrecalc.offset2;
+        const __m128d dx = _mm_set1_pd(hPrecalc.dd);
+        const __m128d dx1 = _mm_set1_pd(hPrecalc.dd1);
+
+        __m128d rg00, ba00, rg01, ba01, rg10, ba10, rg11, ba11;
+        UnpackRGBA_SSE2(PackRGBA(src_data + index00 * 3,
+                                 src_alpha ? src_alpha[index00] : 0), rg00, ba00);
+        UnpackRGBA_SSE2(PackRGBA(src_data + index01 * 3,
+                                 src_alpha ? src_alpha[index01] : 0), rg01, ba01);
+        UnpackRGBA_SSE2(PackRGBA(src_data + index10 * 3,
+                                 src_alpha ? src_alpha[index10] : 0), rg10, ba10);
+        UnpackRGBA_SSE2(PackRGBA(src_data + index11 * 3,
+                                 src_alpha ? src_alpha[index11] : 0), rg11, ba11);
+
+        const __m128d rg1 = LerpSSE2(rg00, dx1, rg01, dx);
+        const __m128d ba1 = LerpSSE2(ba00, dx1, ba01, dx);
+        const __m128d rg2 = LerpSSE2(rg10, dx1, rg11, dx);
+        const __m128d ba2 = LerpSSE2(ba10, dx1, ba11, dx);
+
+        _mm_storeu_pd(rgba, _mm_add_pd(LerpSSE2(rg1, dy1, rg2, dy), half));
+        _mm_storeu_pd(rgba + 2, _mm_add_pd(LerpSSE2(ba1, dy1, ba2, dy), half));
+
+        StoreRGBA(rgba, dst_data, dst_alpha);
+    }
+}
+
+#endif // wxHAS_IMAGE_RESAMPLE_SSE2
+
+#ifdef wxHAS_IMAGE_RESAMPLE_AVX
+
+// Unpack the components packed by PackRGBA() into a vector of doubles.
+wxIMAGE_TARGET_AVX
+inline __m256d UnpackRGBA_AVX(int rgba)
+{
+    return _mm256_cvtepi32_pd(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(rgba)));
+}
+
+// Load all components of the pixel at the given index, alpha is 0 if absent.
+wxIMAGE_TARGET_AVX
+inline __m256d LoadRGBA_AVX(const unsigned char* src_data,
+                            const unsigned char* src_alpha,
+                            int index)
+{
+    return UnpackRGBA_AVX(PackRGBA(src_data + index * 3,
+                                   src_alpha ? src_alpha[index] : 0));
+}
+
+wxIMAGE_TARGET_AVX
+inline __m256d LerpAVX(__m256d v1, __m256d d1, __m256d v2, __m256d d2)
+{
+    return _mm256_add_pd(_mm256_mul_pd(v1, d1), _mm256_mul_pd(v2, d2));
+}
+
+wxIMAGE_TARGET_AVX
+void BilinearRowAVX(const unsigned char* src_data,
+                    const unsigned char* src_alpha,
+                    int srcWidth,
+                    const BilinearPrecalc& vPrecalc,
+                    const wxVector<BilinearPrecalc>& hPrecalcs,
+                    unsigned char* dst_data,
+                    unsigned char* dst_alpha)
+{
+    const int width = hPrecalcs.size();
+
+    const int y_index1 = vPrecalc.offset1 * srcWidth;
+    const int y_index2 = vPrecalc.offset2 * srcWidth;
+    const __m256d dy = _mm256_set1_pd(vPrecalc.dd);
+    const __m256d dy1 = _mm256_set1_pd(vPrecalc.dd1);
+    const __m256d half = _mm256_set1_pd(.5);
+
+    double rgba[4];
+    for ( int dstx = 0; dstx < width; dstx++ )
+    {
+        const BilinearPrecalc& hPrecalc = hPrecalcs[dstx];
+
+        const int index00 = y_index1 + hPrecalc.offset1;
+        const int index01 = y_index1 + hPrecalc.offset2;
+        const int index10 = y_index2 + hPrecalc.offset1;
+        const int index11 = y_index2 + hPrecalc.offset2;
+        const __m256d dx = _mm256_set1_pd(hPrecalc.dd);
+        const __m256d dx1 = _mm256_set1_pd(hPrecalc.dd1);
+
+        const __m256d line1 = LerpAVX(LoadRGBA_AVX(src_data, src_alpha, index00), dx1,
+                                      LoadRGBA_AVX(src_data, src_alpha, index01), dx);
+        const __m256d line2 = LerpAVX(LoadRGBA_AVX(src_data, src_alpha, index10), dx1,
+                                      LoadRGBA_AVX(src_data, src_alpha, index11), dx);
+
+        _mm256_storeu_pd(rgba, _mm256_add_pd(LerpAVX(line1, dy1, line2, dy), half));
+
+        StoreRGBA(rgba, dst_data, dst_alpha);
+    }
+}
+
+#endif // wxHAS_IMAGE_RESAMPLE_AVX
+
+#ifdef wxHAS_IMAGE_RESAMPLE_NEON
+
+inline float64x2_t MakePairNEON(double lo, double hi)
+{
+    return vcombine_f64(vdup_n_f64(lo), vdup_n_f64(hi));
+}
+
+inline float64x2_t LoadRG_NEON(const unsigned char* src_data, int index)
+{
+    return MakePairNEON(src_data[index * 3 + 0], src_data[index * 3 + 1]);
+}
+
+inline float64x2_t LoadBA_NEON(const unsigned char* src_data,
+                               const unsigned char* src_alpha,
+                               int index)
+{
+    return MakePairNEON(src_data[index * 3 + 2],
+                        src_alpha ? src_alpha[index] : 0);
+}
+
+inline float64x2_t
+LerpNEON(float64x2_t v1, float64x2_t d1, float64x2_t v2, float64x2_t d2)
+{
+    return vaddq_f64(vmulq_f64(v1, d1), vmulq_f64(v2, d2));
+}
+
+void BilinearRowNEON(const unsigned char* src_data,
+                     const unsigned char* src_alpha,
+                     int srcWidth,
+                     const BilinearPrecalc& vPrecalc,
+                     const wxVector<BilinearPrecalc>& hPrecalcs,
+                     unsigned char* dst_data,
+                     unsigned char* dst_alpha)
+{
+    const int width = hPrecalcs.size();
+
+    const int y_index1 = vPrecalc.offset1 * srcWidth;
+    const int y_index2 = vPrecalc.offset2 * srcWidth;
+    const float64x2_t dy = vdupq_n_f64(vPrecalc.dd);
+    const float64x2_t dy1 = vdupq_n_f64(vPrecalc.dd1);
+    const float64x2_t half = vdupq_n_f64(.5);
+
+    double rgba[4];
+    for ( int dstx = 0; dstx < width; dstx++ )
+    {
+        const BilinearPrecalc& hPrecalc = hPrecalcs[dstx];
+
+        const int index00 = y_index1 + hPrecalc.offset1;
+        const int index01 = y_index1 + hPrecalc.offset2;
+        const int index10 = y_index2 + hPrecalc.offset1;
+        const int index11 = y_index2 + hPrecalc.offset2;
+        const float64x2_t dx = vdupq_n_f64(hPrecalc.dd);
+        const float64x2_t dx1 = vdupq_n_f64(hPrecalc.dd1);
+
+        const float64x2_t rg1 = LerpNEON(LoadRG_NEON(src_data, index00), dx1,
+                                         LoadRG_NEON(src_data, index01), dx);
+        const float64x2_t ba1 = LerpNEON(LoadBA_NEON(src_data, src_alpha, index00), dx1,
+                                         LoadBA_NEON(src_data, src_alpha, index01), dx);
+        const float64x2_t rg2 = LerpNEON(LoadRG_NEON(src_data, index10), dx1,
+                                         LoadRG_NEON(src_data, index11), dx);
+        const float64x2_t ba2 = LerpNEON(LoadBA_NEON(src_data, src_alpha, index10), dx1,
+                                         LoadBA_NEON(src_data, src_alpha, index11), dx);
+
+        vst1q_f64(rgba, vaddq_f64(LerpNEON(rg1, dy1, rg2, dy), half));
+        vst1q_f64(rgba + 2, vaddq_f64(LerpNEON(ba1, dy1, ba2, dy), half));
+
+        StoreRGBA(rgba, dst_data, dst_alpha);
+    }
+}
+
+#endif // wxHAS_IMAGE_RESAMPLE_NEON
+
+BilinearRowFunc GetBilinearRowFunc()
+{
+    switch ( wxImageGetResampleImpl() )
+    {
+#ifdef wxHAS_IMAGE_RESAMPLE_SSE2
+        case wxIMAGE_RESAMPLE_IMPL_SSE2:
+            return BilinearRowSSE2;
+#endif
+
+#ifdef wxHAS_IMAGE_RESAMPLE_AVX
+        case wxIMAGE_RESAMPLE_IMPL_AVX:
+            return BilinearRowAVX;
+#endif
+
+#ifdef wxHAS_IMAGE_RESAMPLE_NEON
+        case wxIMAGE_RESAMPLE_IMPL_NEON:
+            return BilinearRowNEON;
+#endif
+
+        default:
+            break;
+    }
+
+    return BilinearRowScalar;
+}
+
 } // anonymous namespace
 
 wxImage wxImage::ResampleBilinear(int width, int height) const
@@ -797,61 +1760,11 @@ wxImage wxImage::ResampleBilinear(int width, int height) const
     ResampleBilinearPrecalc(vPrecalcs, M_IMGDATA->m_height);
     ResampleBilinearPrecalc(hPrecalcs, M_IMGDATA->m_width);
 
-    // initialize alpha values to avoid g++ warnings about possibly
-    // uninitialized variables
-    double r1, g1, b1, a1 = 0;
-    double r2, g2, b2, a2 = 0;
-
-    for ( int dsty = 0; dsty < height; dsty++ )
-    {
-        // We need to calculate the source pixel to interpolate from - Y-axis
-        const BilinearPrecalc& vPrecalc = vPrecalcs[dsty];
-        const int y_offset1 = vPrecalc.offset1;
-        const int y_offset2 = vPrecalc.offset2;
-        const double dy = vPrecalc.dd;
-        const double dy1 = vPrecalc.dd1;
-
-
-        for ( int dstx = 0; dstx < width; dstx++ )
-        {
-            // X-axis of pixel to interpolate from
-            const BilinearPrecalc& hPrecalc = hPrecalcs[dstx];
-
-            const int x_offset1 = hPrecalc.offset1;
-            const int x_offset2 = hPrecalc.offset2;
-            const double dx = hPrecalc.dd;
-            const double dx1 = hPrecalc.dd1;
-
-            int src_pixel_index00 = y_offset1 * M_IMGDATA->m_width + x_offset1;
-            int src_pixel_index01 = y_offset1 * M_IMGDATA->m_width + x_offset2;
-            int src_pixel_index10 = y_offset2 * M_IMGDATA->m_width + x_offset1;
-            int src_pixel_index11 = y_offset2 * M_IMGDATA->m_width + x_offset2;
-
-            // first line
-            r1 = src_data[src_pixel_index00 * 3 + 0] * dx1 + src_data[src_pixel_index01 * 3 + 0] * dx;
-            g1 = src_data[src_pixel_index00 * 3 + 1] * dx1 + src_data[src_pixel_index01 * 3 + 1] * dx;
-            b1 = src_data[src_pixel_index00 * 3 + 2] * dx1 + src_data[src_pixel_index01 * 3 + 2] * dx;
-            if ( src_alpha )
-                a1 = src_alpha[src_pixel_index00] * dx1 + src_alpha[src_pixel_index01] * dx;
-
-            // second line
-            r2 = src_data[src_pixel_index10 * 3 + 0] * dx1 + src_data[src_pixel_index11 * 3 + 0] * dx;
-            g2 = src_data[src_pixel_index10 * 3 + 1] * dx1 + src_data[src_pixel_index11 * 3 + 1] * dx;
-            b2 = src_data[src_pixel_index10 * 3 + 2] * dx1 + src_data[src_pixel_index11 * 3 + 2] * dx;
-            if ( src_alpha )
-                a2 = src_alpha[src_pixel_index10] * dx1 + src_alpha[src_pixel_index11] * dx;
-
-            // result lines
-
-            dst_data[0] = static_cast<unsigned char>(r1 * dy1 + r2 * dy + .5);
-            dst_data[1] = static_cast<unsigned char>(g1 * dy1 + g2 * dy + .5);
-            dst_data[2] = static_cast<unsigned char>(b1 * dy1 + b2 * dy + .5);
-            dst_data += 3;
-
-            if ( src_alpha )
-                *dst_alpha++ = static_cast<unsigned char>(a1 * dy1 + a2 * dy +.5);
-        }
-    }
+    ResampleRowsTask<BilinearPrecalc> task(GetBilinearRowFunc(),
+                                           src_data, src_alpha, M_IMGDATA->m_width,
+                                           vPrecalcs, hPrecalcs,
+                                           dst_data, dst_alpha);
+    ProcessImageBands(task, height, width);
 
     return ret_image;
 }
@@ -925,6 +1838,318 @@ void ResampleBicubicPrecalc(wxVector<BicubicPrecalc> &aWeight, int oldDim)
     }
 }
 
+// Signature of the functions computing a single row of the bicubic output.
+typedef void (*BicubicRowFunc)(const unsigned char* src_data,
+                               const unsigned char* src_alpha,
+                               int srcWidth,
+                               const BicubicPrecalc& vPrecalc,
+                               const wxVector<BicubicPrecalc>& hPrecalcs,
+                               unsigned char* dst_data,
+                               unsigned char* dst_alpha);
+
+// Put the data into the destination image. The summed values are of double
+// data type and are rounded here for accuracy.
+inline void StoreBicubicPixel(double sum_r, double sum_g, double sum_b,
+                              double sum_a,
+                              unsigned char*& dst_data,
+                              unsigned char*& dst_alpha)
+{
+    if ( dst_alpha )
+    {
+        if ( sum_a )
+        {
+             dst_data[0] = (unsigned char)(sum_r / sum_a + 0.5);
+             dst_data[1] = (unsigned char)(sum_g / sum_a + 0.5);
+             dst_data[2] = (unsigned char)(sum_b / sum_a + 0.5);
+        }
+        else
+        {
+            dst_data[0] = 0;
+            dst_data[1] = 0;
+            dst_data[2] = 0;
+        }
+        *dst_alpha++ = (unsigned char)sum_a;
+    }
+    else
+    {
+        dst_data[0] = (unsigned char)(sum_r + 0.5);
+        dst_data[1] = (unsigned char)(sum_g + 0.5);
+        dst_data[2] = (unsigned char)(sum_b + 0.5);
+    }
+    dst_data += 3;
+}
+
+// This is the reference implementation, all the others must produce exactly
+// the same results as it.
+void BicubicRowScalar(const unsigned char* src_data,
+                      const unsigned char* src_alpha,
+                      int srcWidth,
+                      const BicubicPrecalc& vPrecalc,
+                      const wxVector<BicubicPrecalc>& hPrecalcs,
+                      unsigned char* dst_data,
+                      unsigned char* dst_alpha)
+{
+    const int width = hPrecalcs.size();
+
+    for ( int dstx = 0; dstx < width; dstx++ )
+    {
+        // X-axis of pixel to interpolate from
+        const BicubicPrecalc& hPrecalc = hPrecalcs[dstx];
+
+        // Sums for each color channel
+        double sum_r = 0, sum_g = 0, sum_b = 0, sum_a = 0;
+
+        // Here we actually determine the RGBA values for the destination pixel
+        for ( int k = -1; k <= 2; k++ )
+        {
+            // Y offset
+            const int y_offset = vPrecalc.offset[k + 1];
+
+            // Loop across the X axis
+            for ( int i = -1; i <= 2; i++ )
+            {
+                // X offset
+                const int x_offset = hPrecalc.offset[i + 1];
+
+                // Calculate the exact position where the source data
+                // should be pulled from based on the x_offset and y_offset
+                int src_pixel_index = y_offset*srcWidth + x_offset;
+
+                // Calculate the weight for the specified pixel according
+                // to the bicubic b-spline kernel we're using for
+                // interpolation
+                const double
+                    pixel_weight = vPrecalc.weight[k + 1] * hPrecalc.weight[i + 1];
+
+                // Create a sum of all velues for each color channel
+                // adjusted for the pixel's calculated weight
+                if ( src_alpha )
+                {
+                    const unsigned char a = src_alpha[src_pixel_index];
+                    sum_r += src_data[src_pixel_index * 3 + 0] * pixel_weight * a;
+                    sum_g += src_data[src_pixel_index * 3 + 1] * pixel_weight * a;
+                    sum_b += src_data[src_pixel_index * 3 + 2] * pixel_weight * a;
+                    sum_a += a * pixel_weight;
+                }
+                else
+                {
+                    sum_r += src_data[src_pixel_index * 3 + 0] * pixel_weight;
+                    sum_g += src_data[src_pixel_index * 3 + 1] * pixel_weight;
+                    sum_b += src_data[src_pixel_index * 3 + 2] * pixel_weight;
+                }
+            }
+        }
+
+        StoreBicubicPixel(sum_r, sum_g, sum_b, sum_a, dst_data, dst_alpha);
+    }
+}
+
+// The vectorized versions below compute the weighted sums of all components
+// at once by using 1 as the "colour" of the alpha component: this gives the
+// same results as the scalar code above as multiplication is commutative.
+
+#ifdef wxHAS_IMAGE_RESAMPLE_SSE2
+
+void BicubicRowSSE2(const unsigned char* src_data,
+                    const unsigned char* src_alpha,
+                    int srcWidth,
+                    const BicubicPrecalc& vPrecalc,
+                    const wxVector<BicubicPrecalc>& hPrecalcs,
+                    unsigned char* dst_data,
+                    unsigned char* dst_alpha)
+{
+    const int width = hPrecalcs.size();
+
+    // Value of the alpha lane, see the comment above.
+    const unsigned char alphaOne = src_alpha ? 1 : 0;
+
+    int y_index[4];
+    for ( int k = 0; k < 4; k++ )
+        y_index[k] = vPrecalc.offset[k] * srcWidth;
+
+    double rgba[4];
+    for ( int dstx = 0; dstx < width; dstx++ )
+    {
+        const BicubicPrecalc& hPrecalc = hPrecalcs[dstx];
+
+        __m128d sum_rg = _mm_setzero_pd();
+        __m128d sum_ba = _mm_setzero_pd();
+
+        for ( int k = 0; k < 4; k++ )
+        {
+            for ( int i = 0; i < 4; i++ )
+            {
+                const int index = y_index[k] + hPrecalc.offset[i];
+                const __m128d
+                    w = _mm_set1_pd(vPrecalc.weight[k] * hPrecalc.weight[i]);
+
+                const unsigned char* const p = src_data + index * 3;
+                __m128d rg, ba;
+                UnpackRGBA_SSE2(PackRGBA(p, alphaOne), rg, ba);
+                rg = _mm_mul_pd(rg, w);
+                ba = _mm_mul_pd(ba, w);
+                if ( src_alpha )
+                {
+                    const __m128d a = _mm_set1_pd(src_alpha[index]);
+                    rg = _mm_mul_pd(rg, a);
+                    ba = _mm_mul_pd(ba, a);
+                }
+
+                sum_rg = _mm_add_pd(sum_rg, rg);
+                sum_ba = _mm_add_pd(sum_ba, ba);
+            }
+        }
+
+        _mm_storeu_pd(rgba, sum_rg);
+        _mm_storeu_pd(rgba + 2, sum_ba);
+
+        StoreBicubicPixel(rgba[0], rgba[1], rgba[2], rgba[3],
+                          dst_data, dst_alpha);
+    }
+}
+
+#endif // wxHAS_IMAGE_RESAMPLE_SSE2
+
+#ifdef wxHAS_IMAGE_RESAMPLE_AVX
+
+wxIMAGE_TARGET_AVX
+void BicubicRowAVX(const unsigned char* src_data,
+                   const unsigned char* src_alpha,
+                   int srcWidth,
+                   const BicubicPrecalc& vPrecalc,
+                   const wxVector<BicubicPrecalc>& hPrecalcs,
+                   unsigned char* dst_data,
+                   unsigned char* dst_alpha)
+{
+    const int width = hPrecalcs.size();
+
+    // Value of the alpha lane, see the comment above.
+    const unsigned char alphaOne = src_alpha ? 1 : 0;
+
+    int y_index[4];
+    for ( int k = 0; k < 4; k++ )
+        y_index[k] = vPrecalc.offset[k] * srcWidth;
+
+    double rgba[4];
+    for ( int dstx = 0; dstx < width; dstx++ )
+    {
+        const BicubicPrecalc& hPrecalc = hPrecalcs[dstx];
+
+        __m256d sum = _mm256_setzero_pd();
+
+        for ( int k = 0; k < 4; k++ )
+        {
+            for ( int i = 0; i < 4; i++ )
+            {
+                const int index = y_index[k] + hPrecalc.offset[i];
+                const __m256d
+                    w = _mm256_set1_pd(vPrecalc.weight[k] * hPrecalc.weight[i]);
+
+                const unsigned char* const p = src_data + index * 3;
+                __m256d v = _mm256_mul_pd(UnpackRGBA_AVX(PackRGBA(p, alphaOne)), w);
+                if ( src_alpha )
+                    v = _mm256_mul_pd(v, _mm256_set1_pd(src_alpha[index]));
+
+                sum = _mm256_add_pd(sum, v);
+            }
+        }
+
+        _mm256_storeu_pd(rgba, sum);
+
+        StoreBicubicPixel(rgba[0], rgba[1], rgba[2], rgba[3],
+                          dst_data, dst_alpha);
+    }
+}
+
+#endif // wxHAS_IMAGE_RESAMPLE_AVX
+
+#ifdef wxHAS_IMAGE_RESAMPLE_NEON
+
+void BicubicRowNEON(const unsigned char* src_data,
+                    const unsigned char* src_alpha,
+                    int srcWidth,
+                    const BicubicPrecalc& vPrecalc,
+                    const wxVector<BicubicPrecalc>& hPrecalcs,
+                    unsigned char* dst_data,
+                    unsigned char* dst_alpha)
+{
+    const int width = hPrecalcs.size();
+
+    int y_index[4];
+    for ( int k = 0; k < 4; k++ )
+        y_index[k] = vPrecalc.offset[k] * srcWidth;
+
+    double rgba[4];
+    for ( int dstx = 0; dstx < width; dstx++ )
+    {
+        const BicubicPrecalc& hPrecalc = hPrecalcs[dstx];
+
+        float64x2_t sum_rg = vdupq_n_f64(0);
+        float64x2_t sum_ba = vdupq_n_f64(0);
+
+        for ( int k = 0; k < 4; k++ )
+        {
+            for ( int i = 0; i < 4; i++ )
+            {
+                const int index = y_index[k] + hPrecalc.offset[i];
+                const float64x2_t
+                    w = vdupq_n_f64(vPrecalc.weight[k] * hPrecalc.weight[i]);
+
+                const unsigned char* const p = src_data + index * 3;
+                float64x2_t rg = vmulq_f64(MakePairNEON(p[0], p[1]), w);
+                float64x2_t ba;
+                if ( src_alpha )
+                {
+                    const float64x2_t a = vdupq_n_f64(src_alpha[index]);
+                    rg = vmulq_f64(rg, a);
+                    ba = vmulq_f64(vmulq_f64(MakePairNEON(p[2], 1), w), a);
+                }
+                else
+                {
+                    ba = vmulq_f64(MakePairNEON(p[2], 0), w);
+                }
+
+                sum_rg = vaddq_f64(sum_rg, rg);
+                sum_ba = vaddq_f64(sum_ba, ba);
+            }
+        }
+
+        vst1q_f64(rgba, sum_rg);
+        vst1q_f64(rgba + 2, sum_ba);
+
+        StoreBicubicPixel(rgba[0], rgba[1], rgba[2], rgba[3],
+                          dst_data, dst_alpha);
+    }
+}
+
+#endif // wxHAS_IMAGE_RESAMPLE_NEON
+
+BicubicRowFunc GetBicubicRowFunc()
+{
+    switch ( wxImageGetResampleImpl() )
+    {
+#ifdef wxHAS_IMAGE_RESAMPLE_SSE2
+        case wxIMAGE_RESAMPLE_IMPL_SSE2:
+            return BicubicRowSSE2;
+#endif
+
+#ifdef wxHAS_IMAGE_RESAMPLE_AVX
+        case wxIMAGE_RESAMPLE_IMPL_AVX:
+            return BicubicRowAVX;
+#endif
+
+#ifdef wxHAS_IMAGE_RESAMPLE_NEON
+        case wxIMAGE_RESAMPLE_IMPL_NEON:
+            return BicubicRowNEON;
+#endif
+
+        default:
+            break;
+    }
+
+    return BicubicRowScalar;
+}
+
 } // anonymous namespace
 
 // This is the bicubic resampling algorithm
@@ -980,309 +2205,602 @@ wxImage wxImage::ResampleBicubic(int width, int height) const
     ResampleBicubicPrecalc(vPrecalcs, M_IMGDATA->m_height);
     ResampleBicubicPrecalc(hPrecalcs, M_IMGDATA->m_width);
 
-    for ( int dsty = 0; dsty < height; dsty++ )
+    ResampleRowsTask<BicubicPrecalc> task(GetBicubicRowFunc(),
+                                          src_data, src_alpha, M_IMGDATA->m_width,
+                                          vPrecalcs, hPrecalcs,
+                                          dst_data, dst_alpha);
+    ProcessImageBands(task, height, width);
+
+    return ret_image;
+}
+
+namespace
+{
+
+// All blur functions below use a box filter: each pixel is replaced with the
+// average of the (2*radius + 1) pixels around it in the blur direction, with
+// the pixels beyond the image edges being replaced by the edge pixels.
+//
+// The sums are updated incrementally as the box slides along the line, so
+// the cost per pixel doesn't depend on the radius.
+
+// Divides the box sums by the box area. Integer division is relatively slow
+// and is done for each channel of each pixel, so replace it by multiplication
+// by the precomputed reciprocal, which gives exactly the same results as long
+// as the area is not too big, see "Division by Invariant Integers using
+// Multiplication" by Granlund and Montgomery.
+class BoxBlurDivider
+{
+public:
+    explicit BoxBlurDivider(int blurRadius)
+        : m_area(2*wxUint64(blurRadius) + 1),
+          m_mult(m_area < (1u << 20) ? ((wxUint64(1) << 48) + m_area - 1) / m_area
+                                     : 0)
+    {
+    }
+
+    unsigned char operator()(wxUint64 sum) const
     {
-        // We need to calculate the source pixel to interpolate from - Y-axis
-        const BicubicPrecalc& vPrecalc = vPrecalcs[dsty];
+        return static_cast<unsigned char>(m_mult ? (sum * m_mult) >> 48
+                                                 : sum / m_area);
+    }
+
+private:
+    const wxUint64 m_area;
+    const wxUint64 m_mult;
+};
+
+// Blur a line of n pixels with the given number of channels each. The source
+// and destination must not overlap.
+template <int Channels>
+void BoxBlurLine(const unsigned char* src,
+                 unsigned char* dst,
+                 int n,
+                 int blurRadius,
+                 const BoxBlurDivider& divide)
+{
+    const unsigned char* const first = src;
+    const unsigned char* const last = src + (n - 1)*Channels;
 
-        for ( int dstx = 0; dstx < width; dstx++ )
+    // Initialize the sums for the first pixel: the box contains blurRadius+1
+    // copies of the first pixel, the following pixels and, if the box is
+    // bigger than the line, copies of the last pixel.
+    const int inside = wxMin(blurRadius, n - 1);
+
+    wxUint64 sums[Channels];
+    for ( int c = 0; c < Channels; c++ )
+    {
+        wxUint64 sum = wxUint64(blurRadius + 1)*first[c] +
+                        wxUint64(blurRadius - inside)*last[c];
+        for ( int k = 1; k <= inside; k++ )
+            sum += src[k*Channels + c];
+
+        sums[c] = sum;
+        dst[c] = divide(sum);
+    }
+
+    // Now just slide the box along the line.
+    for ( int x = 1; x < n; x++ )
+    {
+        const int out = x - blurRadius - 1;
+        const int in = x + blurRadius;
+        const unsigned char* const
+            pixelOut = out < 0 ? first : src + out*Channels;
+        const unsigned char* const
+            pixelIn = in >= n ? last : src + in*Channels;
+
+        unsigned char* const pixel = dst + x*Channels;
+        for ( int c = 0; c < Channels; c++ )
         {
-            // X-axis of pixel to interpolate from
-            const BicubicPrecalc& hPrecalc = hPrecalcs[dstx];
+            sums[c] += pixelIn[c];
+            sums[c] -= pixelOut[c];
+            pixel[c] = divide(sums[c]);
+        }
+    }
+}
 
-            // Sums for each color channel
-            double sum_r = 0, sum_g = 0, sum_b = 0, sum_a = 0;
+// Blur the columns of a strip of the given height consisting of len values
+// per row, in the vertical direction. Rows are processed one after another to
+// access memory sequentially, using the provided array of len sums. The
+// source and destination must not overlap.
+void BoxBlurStrip(const unsigned char* src,
+                  size_t srcStride,
+                  unsigned char* dst,
+                  size_t dstStride,
+                  int len,
+                  int height,
+                  int blurRadius,
+                  const BoxBlurDivider& divide,
+                  wxUint64* sums)
+{
+    const unsigned char* const first = src;
+    const unsigned char* const last = src + (height - 1)*srcStride;
 
-            // Here we actually determine the RGBA values for the destination pixel
-            for ( int k = -1; k <= 2; k++ )
-            {
-                // Y offset
-                const int y_offset = vPrecalc.offset[k + 1];
+    const int inside = wxMin(blurRadius, height - 1);
 
-                // Loop across the X axis
-                for ( int i = -1; i <= 2; i++ )
-                {
-                    // X offset
-                    const int x_offset = hPrecalc.offset[i + 1];
-
-                    // Calculate the exact position where the source data
-                    // should be pulled from based on the x_offset and y_offset
-                    int src_pixel_index = y_offset*M_IMGDATA->m_width + x_offset;
-
-                    // Calculate the weight for the specified pixel according
-                    // to the bicubic b-spline kernel we're using for
-                    // interpolation
-                    const double
-                        pixel_weight = vPrecalc.weight[k + 1] * hPrecalc.weight[i + 1];
-
-                    // Create a sum of all velues for each color channel
-                    // adjusted for the pixel's calculated weight
-                    if ( src_alpha )
-                    {
-                        const unsigned char a = src_alpha[src_pixel_index];
-                        sum_r += src_data[src_pixel_index * 3 + 0] * pixel_weight * a;
-                        sum_g += src_data[src_pixel_index * 3 + 1] * pixel_weight * a;
-                        sum_b += src_data[src_pixel_index * 3 + 2] * pixel_weight * a;
-                        sum_a += a * pixel_weight;
-                    }
-                    else
-                    {
-                        sum_r += src_data[src_pixel_index * 3 + 0] * pixel_weight;
-                        sum_g += src_data[src_pixel_index * 3 + 1] * pixel_weight;
-                        sum_b += src_data[src_pixel_index * 3 + 2] * pixel_weight;
-                    }
-                }
+    for ( int i = 0; i < len; i++ )
+    {
+        sums[i] = wxUint64(blurRadius + 1)*first[i] +
+                    wxUint64(blurRadius - inside)*last[i];
+    }
+
+    for ( int k = 1; k <= inside; k++ )
+    {
+        const unsigned char* const row = src + k*srcStride;
+        for ( int i = 0; i < len; i++ )
+            sums[i] += row[i];
+    }
+
+    for ( int i = 0; i < len; i++ )
+        dst[i] = divide(sums[i]);
+
+    for ( int y = 1; y < height; y++ )
+    {
+        const int out = y - blurRadius - 1;
+        const int in = y + blurRadius;
+        const unsigned char* const
+            rowOut = out < 0 ? first : src + out*srcStride;
+        const unsigned char* const
+            rowIn = in >= height ? last : src + in*srcStride;
+
+        unsigned char* const row = dst + y*dstStride;
+        for ( int i = 0; i < len; i++ )
+        {
+            sums[i] += rowIn[i];
+            sums[i] -= rowOut[i];
+            row[i] = divide(sums[i]);
+        }
+    }
+}
+
+// Note that the source and destination may be the same for both tasks below,
+// in which case the pixels are blurred in place using a temporary buffer just
+// big enough for a single row or a strip of columns respectively.
+class BlurHorizontalTask : public ImageBandsTask
+{
+public:
+    BlurHorizontalTask(const unsigned char* src_data,
+                       const unsigned char* src_alpha,
+                       unsigned char* dst_data,
+                       unsigned char* dst_alpha,
+                       int width,
+                       int blurRadius)
+        : m_src_data(src_data),
+          m_src_alpha(src_alpha),
+          m_dst_data(dst_data),
+          m_dst_alpha(dst_alpha),
+          m_width(width),
+          m_blurRadius(blurRadius),
+          m_divide(blurRadius)
+    {
+    }
+
+    // Blur the rows in the given range.
+    virtual void ProcessBand(int start, int end) wxOVERRIDE
+    {
+        const int width = m_width;
+        const bool inPlace = m_src_data == m_dst_data;
+
+        wxVector<unsigned char> line;
+        if ( inPlace )
+            line.resize(width*3);
+
+        for ( int y = start; y < end; y++ )
+        {
+            const size_t offset = size_t(y)*width;
+
+            const unsigned char* src = m_src_data + offset*3;
+            if ( inPlace )
+            {
+                memcpy(&line[0], src, width*3);
+                src = &line[0];
             }
 
-            // Put the data into the destination image.  The summed values are
-            // of double data type and are rounded here for accuracy
-            if ( src_alpha )
+            BoxBlurLine<3>(src, m_dst_data + offset*3,
+                           width, m_blurRadius, m_divide);
+
+            if ( m_src_alpha )
             {
-                if ( sum_a )
-                {
-                     dst_data[0] = (unsigned char)(sum_r / sum_a + 0.5);
-                     dst_data[1] = (unsigned char)(sum_g / sum_a + 0.5);
-                     dst_data[2] = (unsigned char)(sum_b / sum_a + 0.5);
-                }
-                else
+                const unsigned char* alpha = m_src_alpha + offset;
+                if ( inPlace )
                 {
-                    dst_data[0] = 0;
-                    dst_data[1] = 0;
-                    dst_data[2] = 0;
+                    memcpy(&line[0], alpha, width);
+                    alpha = &line[0];
                 }
-                *dst_alpha++ = (unsigned char)sum_a;
+
+                BoxBlurLine<1>(alpha, m_dst_alpha + offset,
+                               width, m_blurRadius, m_divide);
             }
-            else
+        }
+    }
+
+private:
+    const unsigned char* const m_src_data;
+    const unsigned char* const m_src_alpha;
+    unsigned char* const m_dst_data;
+    unsigned char* const m_dst_alpha;
+    const int m_width;
+    const int m_blurRadius;
+    const BoxBlurDivider m_divide;
+};
+
+class BlurVerticalTask : public ImageBandsTask
+{
+public:
+    BlurVerticalTask(const unsigned char* src_data,
+                     const unsigned char* src_alpha,
+                     unsigned char* dst_data,
+                     unsigned char* dst_alpha,
+                     int width,
+                     int height,
+                     int blurRadius)
+        : m_src_data(src_data),
+          m_src_alpha(src_alpha),
+          m_dst_data(dst_data),
+          m_dst_alpha(dst_alpha),
+          m_width(width),
+          m_height(height),
+          m_blurRadius(blurRadius),
+          m_divide(blurRadius)
+    {
+    }
+
+    // Blur the columns in the given range.
+    virtual void ProcessBand(int start, int end) wxOVERRIDE
+    {
+        // Process the columns in strips narrow enough for the sums and, when
+        // working in place, the copy of the strip to stay in the cache.
+        static const int STRIP_WIDTH = 64;
+
+        const int width = m_width;
+        const bool inPlace = m_src_data == m_dst_data;
+
+        wxVector<wxUint64> sums(STRIP_WIDTH*3);
+
+        wxVector<unsigned char> strip;
+        if ( inPlace )
+            strip.resize(size_t(m_height)*STRIP_WIDTH*3);
+
+        for ( int x = start; x < end; x += STRIP_WIDTH )
+        {
+            const int n = wxMin(STRIP_WIDTH, end - x);
+
+            DoBlurStrip(m_src_data + x*3, m_dst_data + x*3,
+                        n*3, size_t(width)*3, strip, sums);
+
+            if ( m_src_alpha )
             {
-                dst_data[0] = (unsigned char)(sum_r + 0.5);
-                dst_data[1] = (unsigned char)(sum_g + 0.5);
-                dst_data[2] = (unsigned char)(sum_b + 0.5);
+                DoBlurStrip(m_src_alpha + x, m_dst_alpha + x,
+                            n, width, strip, sums);
             }
-            dst_data += 3;
         }
     }
 
-    return ret_image;
+private:
+    void DoBlurStrip(const unsigned char* src,
+                     unsigned char* dst,
+                     int len,
+                     size_t stride,
+                     wxVector<unsigned char>& strip,
+                     wxVector<wxUint64>& sums) const
+    {
+        size_t srcStride = stride;
+        if ( !strip.empty() )
+        {
+            for ( int y = 0; y < m_height; y++ )
+                memcpy(&strip[size_t(y)*len], src + y*stride, len);
+
+            src = &strip[0];
+            srcStride = len;
+        }
+
+        BoxBlurStrip(src, srcStride, dst, stride, len, m_height,
+                     m_blurRadius, m_divide, &sums[0]);
+    }
+
+    const unsigned char* const m_src_data;
+    const unsigned char* const m_src_alpha;
+    unsigned char* const m_dst_data;
+    unsigned char* const m_dst_alpha;
+    const int m_width;
+    const int m_height;
+    const int m_blurRadius;
+    const BoxBlurDivider m_divide;
+};
+
+// Helpers used by the public functions: both of them can be called with the
+// same source and destination to blur the image in place.
+void BlurImageHorizontally(const unsigned char* src_data,
+                           const unsigned char* src_alpha,
+                           unsigned char* dst_data,
+                           unsigned char* dst_alpha,
+                           int width,
+                           int height,
+                           int blurRadius)
+{
+    BlurHorizontalTask task(src_data, src_alpha, dst_data, dst_alpha,
+                            width, blurRadius);
+    ProcessImageBands(task, height, width);
+}
+
+void BlurImageVertically(const unsigned char* src_data,
+                         const unsigned char* src_alpha,
+                         unsigned char* dst_data,
+                         unsigned char* dst_alpha,
+                         int width,
+                         int height,
+                         int blurRadius)
+{
+    BlurVerticalTask task(src_data, src_alpha, dst_data, dst_alpha,
+                          width, height, blurRadius);
+    ProcessImageBands(task, width, height);
+}
+
+// Compute the radii of the successive box blurs approximating the Gaussian
+// blur with the given standard deviation, see "Fast Almost-Gaussian
+// Filtering" by Peter Kovesi.
+static const int GAUSSIAN_BLUR_PASSES = 3;
+
+void GetGaussianBoxRadii(double sigma, int radii[GAUSSIAN_BLUR_PASSES])
+{
+    const int n = GAUSSIAN_BLUR_PASSES;
+
+    // Ideal width of the box for the given number of passes, rounded down to
+    // the nearest odd number.
+    int widthLower = static_cast<int>(floor(sqrt(12*sigma*sigma/n + 1)));
+    if ( widthLower % 2 == 0 )
+        widthLower--;
+
+    // Use the next odd width for some of the passes to get closer to the
+    // desired standard deviation.
+    const int numLower = wxRound((12*sigma*sigma - n*widthLower*widthLower
+                                    - 4*n*widthLower - 3*n) /
+                                 (-4*widthLower - 4));
+
+    for ( int i = 0; i < n; i++ )
+        radii[i] = (i < numLower ? widthLower - 1 : widthLower + 1) / 2;
 }
 
+} // anonymous namespace
+
 // Blur in the horizontal direction
 wxImage wxImage::BlurHorizontal(int blurRadius) const
 {
+    wxCHECK_MSG( blurRadius >= 0, wxNullImage, wxS("invalid blur radius") );
+
     wxImage ret_image(MakeEmptyClone());
 
     wxCHECK( ret_image.IsOk(), ret_image );
 
-    const unsigned char* src_data = M_IMGDATA->m_data;
-    unsigned char* dst_data = ret_image.GetData();
-    const unsigned char* src_alpha = M_IMGDATA->m_alpha;
-    unsigned char* dst_alpha = ret_image.GetAlpha();
-
-    // number of pixels we average over
-    const int blurArea = blurRadius*2 + 1;
-
-    // Horizontal blurring algorithm - average all pixels in the specified blur
-    // radius in the X or horizontal direction
-    for ( int y = 0; y < M_IMGDATA->m_height; y++ )
-    {
-        // Variables used in the blurring algorithm
-        long sum_r = 0,
-             sum_g = 0,
-             sum_b = 0,
-             sum_a = 0;
-
-        long pixel_idx;
-        const unsigned char *src;
-        unsigned char *dst;
-
-        // Calculate the average of all pixels in the blur radius for the first
-        // pixel of the row
-        for ( int kernel_x = -blurRadius; kernel_x <= blurRadius; kernel_x++ )
-        {
-            // To deal with the pixels at the start of a row so it's not
-            // grabbing GOK values from memory at negative indices of the
-            // image's data or grabbing from the previous row
-            if ( kernel_x < 0 )
-                pixel_idx = y * M_IMGDATA->m_width;
-            else
-                pixel_idx = kernel_x + y * M_IMGDATA->m_width;
+    BlurImageHorizontally(M_IMGDATA->m_data, M_IMGDATA->m_alpha,
+                          ret_image.GetData(), ret_image.GetAlpha(),
+                          M_IMGDATA->m_width, M_IMGDATA->m_height,
+                          blurRadius);
 
-            src = src_data + pixel_idx*3;
-            sum_r += src[0];
-            sum_g += src[1];
-            sum_b += src[2];
-            if ( src_alpha )
-                sum_a += src_alpha[pixel_idx];
-        }
+    return ret_image;
+}
 
-        dst = dst_data + y * M_IMGDATA->m_width*3;
-        dst[0] = (unsigned char)(sum_r / blurArea);
-        dst[1] = (unsigned char)(sum_g / blurArea);
-        dst[2] = (unsigned char)(sum_b / blurArea);
-        if ( src_alpha )
-            dst_alpha[y * M_IMGDATA->m_width] = (unsigned char)(sum_a / blurArea);
+// Blur in the vertical direction
+wxImage wxImage::BlurVertical(int blurRadius) const
+{
+    wxCHECK_MSG( blurRadius >= 0, wxNullImage, wxS("invalid blur radius") );
 
-        // Now average the values of the rest of the pixels by just moving the
-        // blur radius box along the row
-        for ( int x = 1; x < M_IMGDATA->m_width; x++ )
-        {
-            // Take care of edge pixels on the left edge by essentially
-            // duplicating the edge pixel
-            if ( x - blurRadius - 1 < 0 )
-                pixel_idx = y * M_IMGDATA->m_width;
-            else
-                pixel_idx = (x - blurRadius - 1) + y * M_IMGDATA->m_width;
-
-            // Subtract the value of the pixel at the left side of the blur
-            // radius box
-            src = src_data + pixel_idx*3;
-            sum_r -= src[0];
-            sum_g -= src[1];
-            sum_b -= src[2];
-            if ( src_alpha )
-                sum_a -= src_alpha[pixel_idx];
-
-            // Take care of edge pixels on the right edge
-            if ( x + blurRadius > M_IMGDATA->m_width - 1 )
-                pixel_idx = M_IMGDATA->m_width - 1 + y * M_IMGDATA->m_width;
-            else
-                pixel_idx = x + blurRadius + y * M_IMGDATA->m_width;
+    wxImage ret_image(MakeEmptyClone());
 
-            // Add the value of the pixel being added to the end of our box
-            src = src_data + pixel_idx*3;
-            sum_r += src[0];
-            sum_g += src[1];
-            sum_b += src[2];
-            if ( src_alpha )
-                sum_a += src_alpha[pixel_idx];
+    wxCHECK( ret_image.IsOk(), ret_image );
 
-            // Save off the averaged data
-            dst = dst_data + x*3 + y*M_IMGDATA->m_width*3;
-            dst[0] = (unsigned char)(sum_r / blurArea);
-            dst[1] = (unsigned char)(sum_g / blurArea);
-            dst[2] = (unsigned char)(sum_b / blurArea);
-            if ( src_alpha )
-                dst_alpha[x + y * M_IMGDATA->m_width] = (unsigned char)(sum_a / blurArea);
-        }
-    }
+    BlurImageVertically(M_IMGDATA->m_data, M_IMGDATA->m_alpha,
+                        ret_image.GetData(), ret_image.GetAlpha(),
+                        M_IMGDATA->m_width, M_IMGDATA->m_height,
+                        blurRadius);
 
     return ret_image;
 }
 
-// Blur in the vertical direction
-wxImage wxImage::BlurVertical(int blurRadius) const
+// The new blur function
+wxImage wxImage::Blur(int blurRadius) const
 {
+    wxCHECK_MSG( blurRadius >= 0, wxNullImage, wxS("invalid blur radius") );
+
     wxImage ret_image(MakeEmptyClone());
 
     wxCHECK( ret_image.IsOk(), ret_image );
 
-    const unsigned char* src_data = M_IMGDATA->m_data;
-    unsigned char* dst_data = ret_image.GetData();
-    const unsigned char* src_alpha = M_IMGDATA->m_alpha;
-    unsigned char* dst_alpha = ret_image.GetAlpha();
-
-    // number of pixels we average over
-    const int blurArea = blurRadius*2 + 1;
-
-    // Vertical blurring algorithm - same as horizontal but switched the
-    // opposite direction
-    for ( int x = 0; x < M_IMGDATA->m_width; x++ )
-    {
-        // Variables used in the blurring algorithm
-        long sum_r = 0,
-             sum_g = 0,
-             sum_b = 0,
-             sum_a = 0;
-
-        long pixel_idx;
-        const unsigned char *src;
-        unsigned char *dst;
-
-        // Calculate the average of all pixels in our blur radius box for the
-        // first pixel of the column
-        for ( int kernel_y = -blurRadius; kernel_y <= blurRadius; kernel_y++ )
-        {
-            // To deal with the pixels at the start of a column so it's not
-            // grabbing GOK values from memory at negative indices of the
-            // image's data or grabbing from the previous column
-            if ( kernel_y < 0 )
-                pixel_idx = x;
-            else
-                pixel_idx = x + kernel_y * M_IMGDATA->m_width;
+    unsigned char* const data = ret_image.GetData();
+    unsigned char* const alpha = ret_image.GetAlpha();
+    const int width = M_IMGDATA->m_width;
+    const int height = M_IMGDATA->m_height;
 
-            src = src_data + pixel_idx*3;
-            sum_r += src[0];
-            sum_g += src[1];
-            sum_b += src[2];
-            if ( src_alpha )
-                sum_a += src_alpha[pixel_idx];
-        }
+    // Blur the image in each direction, the second pass can be done in place
+    // to avoid allocating another image.
+    BlurImageHorizontally(M_IMGDATA->m_data, M_IMGDATA->m_alpha,
+                          data, alpha, width, height, blurRadius);
+    BlurImageVertically(data, alpha, data, alpha, width, height, blurRadius);
 
-        dst = dst_data + x*3;
-        dst[0] = (unsigned char)(sum_r / blurArea);
-        dst[1] = (unsigned char)(sum_g / blurArea);
-        dst[2] = (unsigned char)(sum_b / blurArea);
-        if ( src_alpha )
-            dst_alpha[x] = (unsigned char)(sum_a / blurArea);
+    return ret_image;
+}
+
+wxImage& wxImage::BlurInPlace(int blurRadius)
+{
+    wxCHECK_MSG( IsOk(), *this, wxS("invalid image") );
+    wxCHECK_MSG( blurRadius >= 0, *this, wxS("invalid blur radius") );
 
-        // Now average the values of the rest of the pixels by just moving the
-        // box along the column from top to bottom
-        for ( int y = 1; y < M_IMGDATA->m_height; y++ )
+    AllocExclusiveAndInvalidate();
+
+    unsigned char* const data = M_IMGDATA->m_data;
+    unsigned char* const alpha = M_IMGDATA->m_alpha;
+    const int width = M_IMGDATA->m_width;
+    const int height = M_IMGDATA->m_height;
+
+    BlurImageHorizontally(data, alpha, data, alpha, width, height, blurRadius);
+    BlurImageVertically(data, alpha, data, alpha, width, height, blurRadius);
+
+    return *this;
+}
+
+wxImage wxImage::GaussianBlur(double sigma) const
+{
+    wxCHECK_MSG( sigma >= 0, wxNullImage, wxS("invalid standard deviation") );
+
+    wxImage ret_image(MakeEmptyClone());
+
+    wxCHECK( ret_image.IsOk(), ret_image );
+
+    int radii[GAUSSIAN_BLUR_PASSES];
+    GetGaussianBoxRadii(sigma, radii);
+
+    unsigned char* const data = ret_image.GetData();
+    unsigned char* const alpha = ret_image.GetAlpha();
+    const int width = M_IMGDATA->m_width;
+    const int height = M_IMGDATA->m_height;
+
+    // Only the first pass needs to read from this image, all the subsequent
+    // ones work in place.
+    BlurImageHorizontally(M_IMGDATA->m_data, M_IMGDATA->m_alpha,
+                          data, alpha, width, height, radii[0]);
+
+    for ( int i = 1; i < GAUSSIAN_BLUR_PASSES; i++ )
+        BlurImageHorizontally(data, alpha, data, alpha, width, height, radii[i]);
+
+    for ( int i = 0; i < GAUSSIAN_BLUR_PASSES; i++ )
+        BlurImageVertically(data, alpha, data, alpha, width, height, radii[i]);
+
+    return ret_image;
+}
+
+wxImage& wxImage::GaussianBlurInPlace(double sigma)
+{
+    wxCHECK_MSG( IsOk(), *this, wxS("invalid image") );
+    wxCHECK_MSG( sigma >= 0, *this, wxS("invalid standard deviation") );
+
+    AllocExclusiveAndInvalidate();
+
+    int radii[GAUSSIAN_BLUR_PASSES];
+    GetGaussianBoxRadii(sigma, radii);
+
+    unsigned char* const data = M_IMGDATA->m_data;
+    unsigned char* const alpha = M_IMGDATA->m_alpha;
+    const int width = M_IMGDATA->m_width;
+    const int height = M_IMGDATA->m_height;
+
+    for ( int i = 0; i < GAUSSIAN_BLUR_PASSES; i++ )
+        BlurImageHorizontally(data, alpha, data, alpha, width, height, radii[i]);
+
+    for ( int i = 0; i < GAUSSIAN_BLUR_PASSES; i++ )
+        BlurImageVertically(data, alpha, data, alpha, width, height, radii[i]);
+
+    return *this;
+}
+
+namespace
+{
+
+class Rotate90Task : public ImageBandsTask
+{
+public:
+    Rotate90Task(const unsigned char* src_data,
+                 const unsigned char* src_alpha,
+                 unsigned char* dst_data,
+                 unsigned char* dst_alpha,
+                 long width,
+                 long height,
+                 bool clockwise)
+        : m_src_data(src_data),
+          m_src_alpha(src_alpha),
+          m_dst_data(dst_data),
+          m_dst_alpha(dst_alpha),
+          m_width(width),
+          m_height(height),
+          m_clockwise(clockwise)
+    {
+    }
+
+    // Rotate the columns of the source image in the given range.
+    virtual void ProcessBand(int start, int end) wxOVERRIDE
+    {
+        const long width = m_width;
+        const long height = m_height;
+        const bool clockwise = m_clockwise;
+
+        unsigned char *data = m_dst_data;
+        unsigned char *target_data;
+
+        // we rotate the image in 21-pixel (63-byte) wide strips
+        // to make better use of cpu cache - memory transfers
+        // (note: while much better than single-pixel "strips",
+        //  our vertical strips will still generally straddle 64-byte cachelines)
+        for (long ii = start; ii < end; )
         {
-            // Take care of pixels that would be beyond the top edge by
-            // duplicating the top edge pixel for the column
-            if ( y - blurRadius - 1 < 0 )
-                pixel_idx = x;
-            else
-                pixel_idx = x + (y - blurRadius - 1) * M_IMGDATA->m_width;
-
-            // Subtract the value of the pixel at the top of our blur radius box
-            src = src_data + pixel_idx*3;
-            sum_r -= src[0];
-            sum_g -= src[1];
-            sum_b -= src[2];
-            if ( src_alpha )
-                sum_a -= src_alpha[pixel_idx];
-
-            // Take care of the pixels that would be beyond the bottom edge of
-            // the image similar to the top edge
-            if ( y + blurRadius > M_IMGDATA->m_height - 1 )
-                pixel_idx = x + (M_IMGDATA->m_height - 1) * M_IMGDATA->m_width;
-            else
-                pixel_idx = x + (blurRadius + y) * M_IMGDATA->m_width;
+            long next_ii = wxMin(ii + 21, end);
 
-            // Add the value of the pixel being added to the end of our box
-            src = src_data + pixel_idx*3;
-            sum_r += src[0];
-            sum_g += src[1];
-            sum_b += src[2];
-            if ( src_alpha )
-                sum_a += src_alpha[pixel_idx];
+            for (long j = 0; j < height; j++)
+            {
+                const unsigned char *source_data =
+                    m_src_data + (j*width + ii)*3;
+
+                for (long i = ii; i < next_ii; i++)
+                {
+                    if ( clockwise )
+                    {
+                        target_data = data + ((i + 1)*height - j - 1)*3;
+                    }
+                    else
+                    {
+                        target_data = data + (height*(width - 1 - i) + j)*3;
+                    }
+                    memcpy( target_data, source_data, 3 );
+                    source_data += 3;
+                }
+            }
 
-            // Save off the averaged data
-            dst = dst_data + (x + y * M_IMGDATA->m_width) * 3;
-            dst[0] = (unsigned char)(sum_r / blurArea);
-            dst[1] = (unsigned char)(sum_g / blurArea);
-            dst[2] = (unsigned char)(sum_b / blurArea);
-            if ( src_alpha )
-                dst_alpha[x + y * M_IMGDATA->m_width] = (unsigned char)(sum_a / blurArea);
+            ii = next_ii;
+        }
+
+        if ( m_src_alpha )
+        {
+            unsigned char *alpha_data = m_dst_alpha;
+
+            for (long ii = start; ii < end; )
+            {
+                long next_ii = wxMin(ii + 64, end);
+
+                for (long j = 0; j < height; j++)
+                {
+                    const unsigned char*
+                        source_alpha = m_src_alpha + j*width + ii;
+
+                    for (long i = ii; i < next_ii; i++)
+                    {
+                        unsigned char* target_alpha;
+                        if ( clockwise )
+                        {
+                            target_alpha = alpha_data + (i+1)*height - j - 1;
+                        }
+                        else
+                        {
+                            target_alpha = alpha_data + height*(width - i - 1) + j;
+                        }
+
+                        *target_alpha = *source_alpha++;
+                    }
+                }
+
+                ii = next_ii;
+            }
         }
     }
 
-    return ret_image;
-}
-
-// The new blur function
-wxImage wxImage::Blur(int blurRadius) const
-{
-    wxImage ret_image;
-    ret_image.Create(M_IMGDATA->m_width, M_IMGDATA->m_height, false);
-
-    // Blur the image in each direction
-    ret_image = BlurHorizontal(blurRadius);
-    ret_image = ret_image.BlurVertical(blurRadius);
+private:
+    const unsigned char* const m_src_data;
+    const unsigned char* const m_src_alpha;
+    unsigned char* const m_dst_data;
+    unsigned char* const m_dst_alpha;
+    const long m_width;
+    const long m_height;
+    const bool m_clockwise;
+};
 
-    return ret_image;
-}
+} // anonymous namespace
 
 wxImage wxImage::Rotate90( bool clockwise ) const
 {
@@ -1307,73 +2825,10 @@ wxImage wxImage::Rotate90( bool clockwise ) const
                         clockwise ? height - 1 - hot_y : hot_y);
     }
 
-    unsigned char *data = image.GetData();
-    unsigned char *target_data;
-
-    // we rotate the image in 21-pixel (63-byte) wide strips
-    // to make better use of cpu cache - memory transfers
-    // (note: while much better than single-pixel "strips",
-    //  our vertical strips will still generally straddle 64-byte cachelines)
-    for (long ii = 0; ii < width; )
-    {
-        long next_ii = wxMin(ii + 21, width);
-
-        for (long j = 0; j < height; j++)
-        {
-            const unsigned char *source_data =
-                M_IMGDATA->m_data + (j*width + ii)*3;
-
-            for (long i = ii; i < next_ii; i++)
-            {
-                if ( clockwise )
-                {
-                    target_data = data + ((i + 1)*height - j - 1)*3;
-                }
-                else
-                {
-                    target_data = data + (height*(width - 1 - i) + j)*3;
-                }
-                memcpy( target_data, source_data, 3 );
-                source_data += 3;
-            }
-        }
-
-        ii = next_ii;
-    }
-
-    const unsigned char *source_alpha = M_IMGDATA->m_alpha;
-
-    if ( source_alpha )
-    {
-        unsigned char *alpha_data = image.GetAlpha();
-
-        for (long ii = 0; ii < width; )
-        {
-            long next_ii = wxMin(ii + 64, width);
-
-            for (long j = 0; j < height; j++)
-            {
-                source_alpha = M_IMGDATA->m_alpha + j*width + ii;
-
-                for (long i = ii; i < next_ii; i++)
-                {
-                    unsigned char* target_alpha;
-                    if ( clockwise )
-                    {
-                        target_alpha = alpha_data + (i+1)*height - j - 1;
-                    }
-                    else
-                    {
-                        target_alpha = alpha_data + height*(width - i - 1) + j;
-                    }
-
-                    *target_alpha = *source_alpha++;
-                }
-            }
-
-            ii = next_ii;
-        }
-    }
+    Rotate90Task task(M_IMGDATA->m_data, M_IMGDATA->m_alpha,
+                      image.GetData(), image.GetAlpha(),
+                      width, height, clockwise);
+    ProcessImageBands(task, width, height);
 
     return image;
 }
@@ -1618,7 +3073,7 @@ wxImage::Paste(const wxImage & image, int x, int y,
     wxCHECK_RET( IsOk(), wxT("invalid image") );
     wxCHECK_RET( image.IsOk(), wxT("invalid image") );
 
-    AllocExclusive();
+    AllocExclusiveAndInvalidate();
 
     int xx = 0;
     int yy = 0;
@@ -1807,7 +3262,7 @@ void wxImage::Replace( unsigned char r1, unsigned char g1, unsigned char b1,
 {
     wxCHECK_RET( IsOk(), wxT("invalid image") );
 
-    AllocExclusive();
+    AllocExclusiveAndInvalidate();
 
     unsigned char *data = GetData();
 
@@ -1827,6 +3282,104 @@ void wxImage::Replace( unsigned char r1, unsigned char g1, unsigned char b1,
         }
 }
 
+namespace
+{
+
+// Task applying the given converter to all pixels not having the mask colour.
+template <typename Converter>
+class ConvertColoursTask : public ImageBandsTask
+{
+public:
+    ConvertColoursTask(const Converter& converter,
+                       const unsigned char* src_data,
+                       unsigned char* dst_data,
+                       int width,
+                       bool hasMask,
+                       unsigned char mask_r,
+                       unsigned char mask_g,
+                       unsigned char mask_b)
+        : m_converter(converter),
+          m_src_data(src_data),
+          m_dst_data(dst_data),
+          m_width(width),
+          m_hasMask(hasMask),
+          m_mask_r(mask_r),
+          m_mask_g(mask_g),
+          m_mask_b(mask_b)
+    {
+    }
+
+    // Convert the rows in the given range.
+    virtual void ProcessBand(int start, int end) wxOVERRIDE
+    {
+        const size_t offset = size_t(start)*m_width*3;
+        const unsigned char* src = m_src_data + offset;
+        unsigned char* dst = m_dst_data + offset;
+
+        for ( size_t size = size_t(end - start)*m_width; size; size-- )
+        {
+            unsigned char r = *src++;
+            unsigned char g = *src++;
+            unsigned char b = *src++;
+            if (!m_hasMask || r != m_mask_r || g != m_mask_g || b != m_mask_b)
+                m_converter(&r, &g, &b);
+            *dst++ = r;
+            *dst++ = g;
+            *dst++ = b;
+        }
+    }
+
+private:
+    const Converter& m_converter;
+    const unsigned char* const m_src_data;
+    unsigned char* const m_dst_data;
+    const int m_width;
+    const bool m_hasMask;
+    const unsigned char m_mask_r;
+    const unsigned char m_mask_g;
+    const unsigned char m_mask_b;
+
+    wxDECLARE_NO_COPY_TEMPLATE_CLASS(ConvertColoursTask, Converter);
+};
+
+class GreyscaleConverter
+{
+public:
+    GreyscaleConverter(double weight_r, double weight_g, double weight_b)
+        : m_weight_r(weight_r), m_weight_g(weight_g), m_weight_b(weight_b)
+    {
+    }
+
+    void operator()(unsigned char* r, unsigned char* g, unsigned char* b) const
+    {
+        wxColour::MakeGrey(r, g, b, m_weight_r, m_weight_g, m_weight_b);
+    }
+
+private:
+    const double m_weight_r;
+    const double m_weight_g;
+    const double m_weight_b;
+};
+
+class DisabledConverter
+{
+public:
+    explicit DisabledConverter(unsigned char brightness)
+        : m_brightness(brightness)
+    {
+    }
+
+    void operator()(unsigned char* r, unsigned char* g, unsigned char* b) const
+    {
+        wxColour::MakeDisabled(r, g, b, m_brightness);
+    }
+
+private:
+    const unsigned char m_brightness;
+};
+
+} // anonymous namespace
+
 wxImage wxImage::ConvertToGreyscale(void) const
 {
     return ConvertToGreyscale(0.299, 0.587, 0.114);
@@ -1854,19 +3407,12 @@ wxImage wxImage::ConvertToGreyscale(double weight_r, double weight_g, double wei
     if (hasMask)
         image.SetMaskColour(mask_r, mask_g, mask_b);
 
-    const unsigned char* src = M_IMGDATA->m_data;
-    unsigned char* dst = image.GetData();
-    while (size--)
-    {
-        unsigned char r = *src++;
-        unsigned char g = *src++;
-        unsigned char b = *src++;
-        if (!hasMask || r != mask_r || g != mask_g || b != mask_b)
-            wxColour::MakeGrey(&r, &g, &b, weight_r, weight_g, weight_b);
-        *dst++ = r;
-        *dst++ = g;
-        *dst++ = b;
-    }
+    const GreyscaleConverter converter(weight_r, weight_g, weight_b);
+    ConvertColoursTask<GreyscaleConverter>
+        task(converter, M_IMGDATA->m_data, image.GetData(), w,
+             hasMask, mask_r, mask_g, mask_b);
+    ProcessImageBands(task, h, w);
+
     return image;
 }
 
@@ -1927,19 +3473,12 @@ wxImage wxImage::ConvertToDisabled(unsigned char brightness) const
     if (hasMask)
         image.SetMaskColour(mask_r, mask_g, mask_b);
 
-    const unsigned char* src = M_IMGDATA->m_data;
-    unsigned char* dst = image.GetData();
-    while (size--)
-    {
-        unsigned char r = *src++;
-        unsigned char g = *src++;
-        unsigned char b = *src++;
-        if (!hasMask || r != mask_r || g != mask_g || b != mask_b)
-            wxColour::MakeDisabled(&r, &g, &b, brightness);
-        *dst++ = r;
-        *dst++ = g;
-        *dst++ = b;
-    }
+    const DisabledConverter converter(brightness);
+    ConvertColoursTask<DisabledConverter>
+        task(converter, M_IMGDATA->m_data, image.GetData(), w,
+             hasMask, mask_r, mask_g, mask_b);
+    ProcessImageBands(task, h, w);
+
     return image;
 }
 
@@ -1991,7 +3530,7 @@ void wxImage::SetRGB( int x, int y, unsigned char r, unsigned char g, unsigned c
     long pos = XYToIndex(x, y);
     wxCHECK_RET( pos != -1, wxT("invalid image coordinates") );
 
-    AllocExclusive();
+    AllocExclusiveAndInvalidate();
 
     pos *= 3;
 
@@ -2004,7 +3543,7 @@ void wxImage::SetRGB( const wxRect& rect_, unsigned char r, unsigned char g, uns
 {
     wxCHECK_RET( IsOk(), wxT("invalid image") );
 
-    AllocExclusive();
+    AllocExclusiveAndInvalidate();
 
     wxRect rect(rect_);
     wxRect imageRect(0, 0, GetWidth(), GetHeight());
@@ -2076,6 +3615,16 @@ bool wxImage::IsOk() const
     return data && data->m_ok && data->m_width && data->m_height;
 }
 
+unsigned char *wxImage::GetData()
+{
+    wxCHECK_MSG( IsOk(), (unsigned char *)NULL, wxT("invalid image") );
+
+    // The returned pointer can be used to modify the image.
+    InvalidateRGBAData();
+
+    return M_IMGDATA->m_data;
+}
+
 unsigned char *wxImage::GetData() const
 {
     wxCHECK_MSG( IsOk(), (unsigned char *)NULL, wxT("invalid image") );
@@ -2144,7 +3693,7 @@ void wxImage::SetAlpha(int x, int y, unsigned char alpha)
     long pos = XYToIndex(x, y);
     wxCHECK_RET( pos != -1, wxT("invalid image coordinates") );
 
-    AllocExclusive();
+    AllocExclusiveAndInvalidate();
 
     M_IMGDATA->m_alpha[pos] = alpha;
 }
@@ -2164,97 +3713,320 @@ wxImage::ConvertColourToAlpha(unsigned char r, unsigned char g, unsigned char b)
 {
     SetAlpha(NULL);
 
-    const int w = M_IMGDATA->m_width;
-    const int h = M_IMGDATA->m_height;
+    const int w = M_IMGDATA->m_width;
+    const int h = M_IMGDATA->m_height;
+
+    unsigned char *alpha = GetAlpha();
+    unsigned char *data = GetData();
+
+    for ( int y = 0; y < h; y++ )
+    {
+        for ( int x = 0; x < w; x++ )
+        {
+            *alpha++ = *data;
+            *data++ = r;
+            *data++ = g;
+            *data++ = b;
+        }
+    }
+
+    return true;
+}
+
+void wxImage::SetAlpha( unsigned char *alpha, bool static_data )
+{
+    wxCHECK_RET( IsOk(), wxT("invalid image") );
+
+    AllocExclusiveAndInvalidate();
+
+    if ( !alpha )
+    {
+        alpha = (unsigned char *)malloc(M_IMGDATA->m_width*M_IMGDATA->m_height);
+    }
+
+    if( !M_IMGDATA->m_staticAlpha )
+        free(M_IMGDATA->m_alpha);
+
+    M_IMGDATA->m_alpha = alpha;
+    M_IMGDATA->m_staticAlpha = static_data;
+}
+
+unsigned char *wxImage::GetAlpha()
+{
+    wxCHECK_MSG( IsOk(), (unsigned char *)NULL, wxT("invalid image") );
+
+    // The returned pointer can be used to modify the image.
+    InvalidateRGBAData();
+
+    return M_IMGDATA->m_alpha;
+}
+
+unsigned char *wxImage::GetAlpha() const
+{
+    wxCHECK_MSG( IsOk(), (unsigned char *)NULL, wxT("invalid image") );
+
+    return M_IMGDATA->m_alpha;
+}
+
+bool wxImage::HasAlpha() const
+{
+    wxCHECK_MSG( IsOk(), false, wxT("invalid image") );
+
+    return M_IMGDATA->m_alpha != NULL;
+}
+
+void wxImage::InitAlpha()
+{
+    wxCHECK_RET( !HasAlpha(), wxT("image already has an alpha channel") );
+
+    // initialize memory for alpha channel
+    SetAlpha();
+
+    unsigned char *alpha = M_IMGDATA->m_alpha;
+    const size_t lenAlpha = M_IMGDATA->m_width * M_IMGDATA->m_height;
+
+    if ( HasMask() )
+    {
+        // use the mask to initialize the alpha channel.
+        const unsigned char * const alphaEnd = alpha + lenAlpha;
+
+        const unsigned char mr = M_IMGDATA->m_maskRed;
+        const unsigned char mg = M_IMGDATA->m_maskGreen;
+        const unsigned char mb = M_IMGDATA->m_maskBlue;
+        for ( unsigned char *src = M_IMGDATA->m_data;
+              alpha < alphaEnd;
+              src += 3, alpha++ )
+        {
+            *alpha = (src[0] == mr && src[1] == mg && src[2] == mb)
+                            ? wxIMAGE_ALPHA_TRANSPARENT
+                            : wxIMAGE_ALPHA_OPAQUE;
+        }
+
+        M_IMGDATA->m_hasMask = false;
+    }
+    else // no mask
+    {
+        // make the image fully opaque
+        memset(alpha, wxIMAGE_ALPHA_OPAQUE, lenAlpha);
+    }
+}
+
+void wxImage::ClearAlpha()
+{
+    wxCHECK_RET( HasAlpha(), wxT("image already doesn't have an alpha channel") );
+
+    AllocExclusiveAndInvalidate();
+
+    if ( !M_IMGDATA->m_staticAlpha )
+        free( M_IMGDATA->m_alpha );
+
+    M_IMGDATA->m_alpha = NULL;
+}
+
+// ----------------------------------------------------------------------------
+// interleaved RGBA data
+// ----------------------------------------------------------------------------
+
+namespace
+{
+
+class wxImageRGBARefData : public wxObjectRefData
+{
+public:
+    wxImageRGBARefData(int width, int height, wxImageRGBAFormat format)
+        : m_width(width),
+          m_height(height),
+          m_format(format)
+    {
+        m_data = static_cast<unsigned char*>(malloc(4*size_t(width)*height));
+    }
+
+    virtual ~wxImageRGBARefData()
+    {
+        free(m_data);
+    }
+
+    const int m_width,
+              m_height;
+    const wxImageRGBAFormat m_format;
+    unsigned char* m_data;
+
+    wxDECLARE_NO_COPY_CLASS(wxImageRGBARefData);
+};
+
+// Interleave RGB and alpha (which may be NULL) data into the given format.
+class InterleaveRGBATask : public ImageBandsTask
+{
+public:
+    InterleaveRGBATask(const unsigned char* data,
+                       const unsigned char* alpha,
+                       int width,
+                       wxImageRGBAFormat format,
+                       unsigned char* dst)
+        : m_data(data),
+          m_alpha(alpha),
+          m_width(width),
+          m_format(format),
+          m_dst(dst)
+    {
+    }
+
+    virtual void ProcessBand(int start, int end) wxOVERRIDE
+    {
+        const size_t offset = size_t(start)*m_width;
+        const size_t count = size_t(end - start)*m_width;
+
+        const unsigned char* src = m_data + 3*offset;
+        const unsigned char* alpha = m_alpha ? m_alpha + offset : NULL;
+
+        if ( m_format == wxIMAGE_RGBA_STRAIGHT )
+        {
+            unsigned char* dst = m_dst + 4*offset;
+            for ( size_t n = 0; n < count; n++, src += 3, dst += 4 )
+            {
+                dst[0] = src[0];
+                dst[1] = src[1];
+                dst[2] = src[2];
+                dst[3] = alpha ? *alpha++ : wxIMAGE_ALPHA_OPAQUE;
+            }
+        }
+        else // wxIMAGE_RGBA_PREMULTIPLIED
+        {
+            // Note that this must use the same rounding as wxCairoBitmapData
+            // code which still converts the images with mask itself.
+            wxUint32* dst = reinterpret_cast<wxUint32*>(m_dst) + offset;
+            if ( alpha )
+            {
+                for ( size_t n = 0; n < count; n++, src += 3 )
+                {
+                    const unsigned a = *alpha++;
+                    *dst++ = a                  << 24 |
+                             ((a * src[0]) / 255) << 16 |
+                             ((a * src[1]) / 255) <<  8 |
+                             ((a * src[2]) / 255);
+                }
+            }
+            else
+            {
+                for ( size_t n = 0; n < count; n++, src += 3 )
+                {
+                    *dst++ = 0xff000000u |
+                             src[0] << 16 |
+                             src[1] <<  8 |
+                             src[2];
+                }
+            }
+        }
+    }
+
+private:
+    const unsigned char* const m_data;
+    const unsigned char* const m_alpha;
+    const int m_width;
+    const wxImageRGBAFormat m_format;
+    unsigned char* const m_dst;
+
+    wxDECLARE_NO_COPY_CLASS(InterleaveRGBATask);
+};
+
+} // anonymous namespace
 
-    unsigned char *alpha = GetAlpha();
-    unsigned char *data = GetData();
+#define M_RGBADATA static_cast<wxImageRGBARefData*>(m_refData)
 
-    for ( int y = 0; y < h; y++ )
-    {
-        for ( int x = 0; x < w; x++ )
-        {
-            *alpha++ = *data;
-            *data++ = r;
-            *data++ = g;
-            *data++ = b;
-        }
-    }
+wxIMPLEMENT_DYNAMIC_CLASS(wxImageRGBAData, wxObject);
 
-    return true;
+wxImageRGBAData::wxImageRGBAData(int width, int height, wxImageRGBAFormat format)
+{
+    m_refData = new wxImageRGBARefData(width, height, format);
 }
 
-void wxImage::SetAlpha( unsigned char *alpha, bool static_data )
+int wxImageRGBAData::GetWidth() const
 {
-    wxCHECK_RET( IsOk(), wxT("invalid image") );
-
-    AllocExclusive();
+    wxCHECK_MSG( IsOk(), 0, wxS("invalid RGBA data") );
 
-    if ( !alpha )
-    {
-        alpha = (unsigned char *)malloc(M_IMGDATA->m_width*M_IMGDATA->m_height);
-    }
+    return M_RGBADATA->m_width;
+}
 
-    if( !M_IMGDATA->m_staticAlpha )
-        free(M_IMGDATA->m_alpha);
+int wxImageRGBAData::GetHeight() const
+{
+    wxCHECK_MSG( IsOk(), 0, wxS("invalid RGBA data") );
 
-    M_IMGDATA->m_alpha = alpha;
-    M_IMGDATA->m_staticAlpha = static_data;
+    return M_RGBADATA->m_height;
 }
 
-unsigned char *wxImage::GetAlpha() const
+wxImageRGBAFormat wxImageRGBAData::GetFormat() const
 {
-    wxCHECK_MSG( IsOk(), (unsigned char *)NULL, wxT("invalid image") );
+    wxCHECK_MSG( IsOk(), wxIMAGE_RGBA_STRAIGHT, wxS("invalid RGBA data") );
 
-    return M_IMGDATA->m_alpha;
+    return M_RGBADATA->m_format;
 }
 
-void wxImage::InitAlpha()
+const unsigned char* wxImageRGBAData::GetData() const
 {
-    wxCHECK_RET( !HasAlpha(), wxT("image already has an alpha channel") );
+    wxCHECK_MSG( IsOk(), NULL, wxS("invalid RGBA data") );
 
-    // initialize memory for alpha channel
-    SetAlpha();
+    return M_RGBADATA->m_data;
+}
 
-    unsigned char *alpha = M_IMGDATA->m_alpha;
-    const size_t lenAlpha = M_IMGDATA->m_width * M_IMGDATA->m_height;
+unsigned char* wxImageRGBAData::GetWritableData()
+{
+    return M_RGBADATA->m_data;
+}
 
-    if ( HasMask() )
-    {
-        // use the mask to initialize the alpha channel.
-        const unsigned char * const alphaEnd = alpha + lenAlpha;
+wxImageRGBAData wxImage::GetRGBAData(wxImageRGBAFormat format) const
+{
+    wxCHECK_MSG( IsOk(), wxImageRGBAData(), wxS("invalid image") );
 
-        const unsigned char mr = M_IMGDATA->m_maskRed;
-        const unsigned char mg = M_IMGDATA->m_maskGreen;
-        const unsigned char mb = M_IMGDATA->m_maskBlue;
-        for ( unsigned char *src = M_IMGDATA->m_data;
-              alpha < alphaEnd;
-              src += 3, alpha++ )
-        {
-            *alpha = (src[0] == mr && src[1] == mg && src[2] == mb)
-                            ? wxIMAGE_ALPHA_TRANSPARENT
-                            : wxIMAGE_ALPHA_OPAQUE;
-        }
+    wxImageRefData* const data = M_IMGDATA;
+    {
+#if wxUSE_THREADS
+        wxCriticalSectionLocker lock(data->m_rgbaCS);
+#endif // wxUSE_THREADS
 
-        M_IMGDATA->m_hasMask = false;
+        if ( data->m_rgba.IsOk() && data->m_rgba.GetFormat() == format )
+            return data->m_rgba;
     }
-    else // no mask
+
+    // Convert the data without holding the lock, the image itself can't be
+    // modified while this const function is running.
+    wxImageRGBAData rgba(data->m_width, data->m_height, format);
+    wxCHECK_MSG( rgba.GetData(), wxImageRGBAData(),
+                 wxS("failed to allocate RGBA data") );
+
+    InterleaveRGBATask task(data->m_data, data->m_alpha, data->m_width,
+                            format, rgba.GetWritableData());
+    ProcessImageBands(task, data->m_height, data->m_width);
+
     {
-        // make the image fully opaque
-        memset(alpha, wxIMAGE_ALPHA_OPAQUE, lenAlpha);
+#if wxUSE_THREADS
+        wxCriticalSectionLocker lock(data->m_rgbaCS);
+#endif // wxUSE_THREADS
+
+        data->m_rgba = rgba;
     }
+
+    return rgba;
 }
 
-void wxImage::ClearAlpha()
+void wxImage::InvalidateRGBAData()
 {
-    wxCHECK_RET( HasAlpha(), wxT("image already doesn't have an alpha channel") );
+    if ( !m_refData )
+        return;
 
-    AllocExclusive();
+    wxImageRefData* const data = M_IMGDATA;
 
-    if ( !M_IMGDATA->m_staticAlpha )
-        free( M_IMGDATA->m_alpha );
+#if wxUSE_THREADS
+    wxCriticalSectionLocker lock(data->m_rgbaCS);
+#endif // wxUSE_THREADS
 
-    M_IMGDATA->m_alpha = NULL;
+    data->m_rgba = wxImageRGBAData();
+}
+
+void wxImage::AllocExclusiveAndInvalidate()
+{
+    AllocExclusive();
+
+    InvalidateRGBAData();
 }
 
 
@@ -2266,7 +4038,7 @@ void wxImage::SetMaskColour( unsigned char r, unsigned char g, unsigned char b )
 {
     wxCHECK_RET( IsOk(), wxT("invalid image") );
 
-    AllocExclusive();
+    AllocExclusiveAndInvalidate();
 
     M_IMGDATA->m_maskRed = r;
     M_IMGDATA->m_maskGreen = g;
@@ -2317,7 +4089,7 @@ void wxImage::SetMask( bool mask )
 {
     wxCHECK_RET( IsOk(), wxT("invalid image") );
 
-    AllocExclusive();
+    AllocExclusiveAndInvalidate();
 
     M_IMGDATA->m_hasMask = mask;
 }
@@ -2378,7 +4150,7 @@ bool wxImage::SetMaskFromImage(const wxImage& mask,
         return false ;
     }
 
-    AllocExclusive();
+    AllocExclusiveAndInvalidate();
 
     unsigned char *imgdata = GetData();
     unsigned char *maskdata = mask.GetData();
@@ -2430,7 +4202,7 @@ bool wxImage::ConvertAlphaToMask(unsigned char mr,
     if ( !HasAlpha() )
         return false;
 
-    AllocExclusive();
+    AllocExclusiveAndInvalidate();
 
     SetMask(true);
     SetMaskColour(mr, mg, mb);
@@ -2488,7 +4260,7 @@ void wxImage::SetPalette(const wxPalette& palette)
 {
     wxCHECK_RET( IsOk(), wxT("invalid image") );
 
-    AllocExclusive();
+    AllocExclusiveAndInvalidate();
 
     M_IMGDATA->m_palette = palette;
 }
@@ -2501,7 +4273,7 @@ void wxImage::SetPalette(const wxPalette& palette)
 
 void wxImage::SetOption(const wxString& name, const wxString& value)
 {
-    AllocExclusive();
+    AllocExclusiveAndInvalidate();
 
     int idx = M_IMGDATA->m_optionNames.Index(name, false);
     if ( idx == wxNOT_FOUND )
@@ -2564,7 +4336,7 @@ int wxImage::GetDefaultLoadFlags()
 
 void wxImage::SetLoadFlags(int flags)
 {
-    AllocExclusive();
+    AllocExclusiveAndInvalidate();
 
     M_IMGDATA->m_loadFlags = flags;
 }
@@ -2910,7 +4682,7 @@ bool wxImage::DoLoad(wxImageHandler& handler, wxInputStream& stream, int index)
 
 bool wxImage::LoadFile( wxInputStream& stream, wxBitmapType type, int index )
 {
-    AllocExclusive();
+    AllocExclusiveAndInvalidate();
 
     wxImageHandler *handler;
 
@@ -3006,6 +4778,199 @@ bool wxImage::LoadFile( wxInputStream& stream, const wxString& mimetype, int ind
     return DoLoad(*handler, stream, index);
 }
 
+namespace
+{
+
+bool DoLoadRows(wxImageRowSink& sink,
+                wxInputStream& stream,
+                int scale,
+                wxBitmapType type,
+                int index,
+                bool verbose)
+{
+    wxCHECK_MSG( scale >= 1, false, wxS("invalid scale") );
+
+    wxImageHandler *handler = NULL;
+
+    if ( type == wxBITMAP_TYPE_ANY )
+    {
+        if ( !stream.IsSeekable() )
+        {
+            if ( verbose )
+            {
+                wxLogError(_("Can't automatically determine the image format "
+                             "for non-seekable input."));
+            }
+            return false;
+        }
+
+        // Unlike LoadFile(), don't try the other handlers if the first one
+        // able to read the stream fails, as it could have already passed
+        // some rows to the sink.
+        const wxList& list = wxImage::GetHandlers();
+        for ( wxList::compatibility_iterator node = list.GetFirst();
+              node;
+              node = node->GetNext() )
+        {
+            wxImageHandler* const h = (wxImageHandler*)node->GetData();
+            if ( h->CanRead(stream) )
+            {
+                handler = h;
+                break;
+            }
+        }
+
+        if ( !handler )
+        {
+            if ( verbose )
+            {
+                wxLogWarning( _("Unknown image data format.") );
+            }
+            return false;
+        }
+    }
+    else
+    {
+        handler = wxImage::FindHandler(type);
+        if ( !handler )
+        {
+            if ( verbose )
+            {
+                wxLogWarning( _("No image handler for type %d defined."), type );
+            }
+            return false;
+        }
+
+        if ( stream.IsSeekable() && !handler->CanRead(stream) )
+        {
+            if ( verbose )
+            {
+                wxLogError(_("This is not a %s."), handler->GetName());
+            }
+            return false;
+        }
+    }
+
+    return handler->LoadRows(sink, stream, scale, verbose, index);
+}
+
+// Sink storing the given part of the image in a wxImage.
+class wxImageRegionSink : public wxImageRowSink
+{
+public:
+    explicit wxImageRegionSink(const wxRect& rect)
+        : m_rect(rect)
+    {
+        m_width =
+        m_height = 0;
+        m_done = false;
+    }
+
+    virtual bool OnBegin(int width, int height, bool hasAlpha) wxOVERRIDE
+    {
+        m_width = width;
+        m_height = height;
+
+        const wxRect rectAll(0, 0, width, height);
+        if ( m_rect.IsEmpty() )
+            m_rect = rectAll;
+        else
+            m_rect.Intersect(rectAll);
+
+        if ( m_rect.IsEmpty() )
+            return false;
+
+        if ( !m_image.Create(m_rect.width, m_rect.height, false) )
+            return false;
+
+        if ( hasAlpha )
+            m_image.SetAlpha();
+
+        return true;
+    }
+
+    virtual bool OnRows(int y, int count,
+                        const unsigned char* data,
+                        const unsigned char* alpha) wxOVERRIDE
+    {
+        const int yStart = wxMax(y, m_rect.y),
+                  yEnd = wxMin(y + count, m_rect.GetBottom() + 1);
+
+        unsigned char* const dst = m_image.GetData();
+        unsigned char* const dstAlpha = m_image.GetAlpha();
+        for ( int yy = yStart; yy < yEnd; yy++ )
+        {
+            const size_t offsetSrc = size_t(yy - y)*m_width + m_rect.x;
+            const size_t offsetDst = size_t(yy - m_rect.y)*m_rect.width;
+
+            memcpy(dst + 3*offsetDst, data + 3*offsetSrc, 3*m_rect.width);
+            if ( dstAlpha )
+                memcpy(dstAlpha + offsetDst, alpha + offsetSrc, m_rect.width);
+        }
+
+        if ( y + count > m_rect.GetBottom() )
+        {
+            m_done = true;
+
+            // There is no need to continue decoding the rest of the image if
+            // it's not needed.
+            if ( y + count < m_height )
+                return false;
+        }
+
+        return true;
+    }
+
+    bool IsDone() const { return m_done; }
+
+    const wxImage& GetImage() const { return m_image; }
+
+private:
+    wxRect m_rect;
+    int m_width,
+        m_height;
+    bool m_done;
+    wxImage m_image;
+
+    wxDECLARE_NO_COPY_CLASS(wxImageRegionSink);
+};
+
+} // anonymous namespace
+
+/* static */
+bool wxImage::LoadRows(wxImageRowSink& sink,
+                       wxInputStream& stream,
+                       int scale,
+                       wxBitmapType type,
+                       int index)
+{
+    return DoLoadRows(sink, stream, scale, type, index,
+                      (GetDefaultLoadFlags() & Load_Verbose) != 0);
+}
+
+bool wxImage::LoadFileRegion(wxInputStream& stream,
+                             const wxRect& rect,
+                             int scale,
+                             wxBitmapType type,
+                             int index)
+{
+    const int loadFlags = GetLoadFlags();
+    const bool verbose = (loadFlags & Load_Verbose) != 0;
+
+    wxImageRegionSink sink(rect);
+
+    // The sink stops loading as soon as it has all the data it needs, so
+    // check whether it got it even if loading "failed".
+    if ( !DoLoadRows(sink, stream, scale, type, index, verbose) &&
+            !sink.IsDone() )
+        return false;
+
+    *this = sink.GetImage();
+    SetLoadFlags(loadFlags);
+
+    return true;
+}
+
 bool wxImage::DoSave(wxImageHandler& handler, wxOutputStream& stream) const
 {
     wxImage * const self = const_cast<wxImage *>(this);
@@ -3329,7 +5294,7 @@ wxImage::RGBValue wxImage::HSVtoRGB(const HSVValue& hsv)
  */
 void wxImage::RotateHue(double angle)
 {
-    AllocExclusive();
+    AllocExclusiveAndInvalidate();
 
     unsigned long count;
     wxImage::HSVValue hsv;
@@ -3430,8 +5395,162 @@ bool wxImageHandler::CallDoCanRead(wxInputStream& stream)
     return ok;
 }
 
+bool wxImageHandler::LoadRows(wxImageRowSink& sink,
+                              wxInputStream& stream,
+                              int scale,
+                              bool verbose,
+                              int index)
+{
+    wxCHECK_MSG( scale >= 1, false, wxS("invalid scale") );
+
+    // This handler doesn't support loading the image progressively, so just
+    // load all of it.
+    wxImage image;
+    if ( !LoadFile(&image, stream, verbose, index) )
+        return false;
+
+    wxImageRowReducer reducer(sink, scale);
+    return wxSendImageToRowSink(image, reducer);
+}
+
 #endif // wxUSE_STREAMS
 
+// ----------------------------------------------------------------------------
+// wxImageRowReducer
+// ----------------------------------------------------------------------------
+
+wxImageRowReducer::wxImageRowReducer(wxImageRowSink& sink, int scale)
+    : m_sink(sink),
+      m_scale(scale)
+{
+    wxASSERT_MSG( scale >= 1, wxS("invalid scale") );
+
+    m_width =
+    m_height =
+    m_widthReduced = 0;
+    m_hasAlpha = false;
+    m_rowsAccumulated =
+    m_yReduced = 0;
+}
+
+bool wxImageRowReducer::OnBegin(int width, int height, bool hasAlpha)
+{
+    if ( m_scale == 1 )
+        return m_sink.OnBegin(width, height, hasAlpha);
+
+    m_width = width;
+    m_height = height;
+    m_widthReduced = (width + m_scale - 1) / m_scale;
+    m_hasAlpha = hasAlpha;
+    m_rowsAccumulated =
+    m_yReduced = 0;
+
+    m_sums.assign(4*m_widthReduced, 0);
+    m_data.resize(3*m_widthReduced);
+    m_alpha.resize(hasAlpha ? m_widthReduced : 0);
+
+    return m_sink.OnBegin(m_widthReduced,
+                          (height + m_scale - 1) / m_scale,
+                          hasAlpha);
+}
+
+bool wxImageRowReducer::OnRows(int y, int count,
+                               const unsigned char* data,
+                               const unsigned char* alpha)
+{
+    if ( m_scale == 1 )
+        return m_sink.OnRows(y, count, data, alpha);
+
+    for ( int n = 0; n < count; n++ )
+    {
+        wxUint32* sums = &m_sums[0];
+        for ( int x = 0; x < m_width; x += m_scale, sums += 4 )
+        {
+            const int xEnd = wxMin(x + m_scale, m_width);
+            for ( int xx = x; xx < xEnd; xx++ )
+            {
+                sums[0] += *data++;
+                sums[1] += *data++;
+                sums[2] += *data++;
+                if ( alpha )
+                    sums[3] += *alpha++;
+            }
+        }
+
+        if ( ++m_rowsAccumulated == m_scale || y + n == m_height - 1 )
+        {
+            if ( !FlushRow() )
+                return false;
+        }
+    }
+
+    return true;
+}
+
+bool wxImageRowReducer::FlushRow()
+{
+    unsigned char* data = &m_data[0];
+    unsigned char* alpha = m_hasAlpha ? &m_alpha[0] : NULL;
+    wxUint32* sums = &m_sums[0];
+    for ( int x = 0; x < m_width; x += m_scale, sums += 4 )
+    {
+        const wxUint32
+            area = m_rowsAccumulated*wxMin(m_scale, m_width - x);
+
+        *data++ = static_cast<unsigned char>((sums[0] + area/2) / area);
+        *data++ = static_cast<unsigned char>((sums[1] + area/2) / area);
+        *data++ = static_cast<unsigned char>((sums[2] + area/2) / area);
+        if ( alpha )
+            *alpha++ = static_cast<unsigned char>((sums[3] + area/2) / area);
+
+        sums[0] =
+        sums[1] =
+        sums[2] =
+        sums[3] = 0;
+    }
+
+    m_rowsAccumulated = 0;
+
+    return m_sink.OnRows(m_yReduced++, 1,
+                         &m_data[0], m_hasAlpha ? &m_alpha[0] : NULL);
+}
+
+bool wxSendImageToRowSink(const wxImage& image, wxImageRowSink& sink)
+{
+    const int width = image.GetWidth(),
+              height = image.GetHeight();
+
+    // Sinks don't support masks, so use alpha instead.
+    wxVector<unsigned char> alphaFromMask;
+    const unsigned char* alpha = image.GetAlpha();
+    if ( !alpha && image.HasMask() )
+    {
+        const unsigned char maskR = image.GetMaskRed(),
+                            maskG = image.GetMaskGreen(),
+                            maskB = image.GetMaskBlue();
+
+        alphaFromMask.resize(size_t(width)*height);
+
+        const unsigned char* data = image.GetData();
+        for ( size_t n = 0; n < alphaFromMask.size(); n++, data += 3 )
+        {
+            const bool masked = data[0] == maskR &&
+                                    data[1] == maskG &&
+                                        data[2] == maskB;
+            alphaFromMask[n] = masked ? wxIMAGE_ALPHA_TRANSPARENT
+                                      : wxIMAGE_ALPHA_OPAQUE;
+        }
+
+        if ( !alphaFromMask.empty() )
+            alpha = &alphaFromMask[0];
+    }
+
+    if ( !sink.OnBegin(width, height, alpha != NULL) )
+        return false;
+
+    return sink.OnRows(0, height, image.GetData(), alpha);
+}
+
 /* static */
 wxImageResolution
 wxImageHandler::GetResolutionFromOptions(const wxImage& image, int *x, int *y)
@@ -3869,9 +5988,24 @@ class wxImageModule: public wxModule
 {
     wxDECLARE_DYNAMIC_CLASS(wxImageModule);
 public:
-    wxImageModule() {}
+    wxImageModule()
+    {
+#if wxUSE_THREADS
+        // The resampling threads must be stopped before the threads support
+        // is cleaned up.
+        AddDependency("wxThreadModule");
+#endif // wxUSE_THREADS
+    }
+
     bool OnInit() wxOVERRIDE { wxImage::InitStandardHandlers(); return true; }
-    void OnExit() wxOVERRIDE { wxImage::CleanUpHandlers(); }
+    void OnExit() wxOVERRIDE
+    {
+        wxImage::CleanUpHandlers();
+
+#if wxUSE_THREADS
+        DeleteImageThreadPool();
+#endif // wxUSE_THREADS
+    }
 };
 
 wxIMPLEMENT_DYNAMIC_CLASS(wxImageModule, wxModule);
@@ -38,6 +38,7 @@
 
 #include "wx/filefn.h"
 #include "wx/wfstream.h"
+#include "wx/private/image.h"
 
 // For memcpy
 #include <string.h>
@@ -348,6 +349,131 @@ bool wxJPEGHandler::LoadFile( wxImage *image, wxInputStream& stream, bool verbos
     return true;
 }
 
+// Helper of wxJPEGHandler::LoadRows() which can't have any objects with
+// non-trivial destructors because of setjmp() use.
+static bool
+DoLoadJPEGRows(wxImageRowSink& sink,
+               wxInputStream& stream,
+               unsigned scale,
+               bool verbose)
+{
+    struct jpeg_decompress_struct cinfo;
+    wx_error_mgr jerr;
+
+    cinfo.err = jpeg_std_error( &jerr );
+    jerr.error_exit = wx_error_exit;
+
+    if (!verbose)
+        cinfo.err->output_message = wx_ignore_message;
+
+    if (setjmp(jerr.setjmp_buffer))
+    {
+        if (verbose)
+        {
+            wxLogError(_("JPEG: Couldn't load - file is probably corrupted."));
+        }
+        (cinfo.src->term_source)(&cinfo);
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+
+    jpeg_create_decompress( &cinfo );
+    wx_jpeg_io_src( &cinfo, stream );
+    jpeg_read_header( &cinfo, TRUE );
+
+    const bool isCMYK = cinfo.out_color_space == JCS_CMYK ||
+                            cinfo.out_color_space == JCS_YCCK;
+    cinfo.out_color_space = isCMYK ? JCS_CMYK : JCS_RGB;
+
+    // Let libjpeg reduce the image while decoding it, which is much faster
+    // than decoding it at full size and needs less memory.
+    cinfo.scale_num = 1;
+    cinfo.scale_denom = scale;
+
+    jpeg_start_decompress( &cinfo );
+
+    const JDIMENSION width = cinfo.output_width;
+
+    // Read as many rows as libjpeg can return at once into a contiguous RGB
+    // buffer, to pass them to the sink together.
+    const int numRows = cinfo.rec_outbuf_height;
+    const JDIMENSION stride = width * 3;
+    unsigned char* const data = (*cinfo.mem->alloc_sarray)
+        ((j_common_ptr) &cinfo, JPOOL_IMAGE, stride * numRows, 1)[0];
+
+    JSAMPARRAY rows;
+    if ( isCMYK )
+    {
+        rows = (*cinfo.mem->alloc_sarray)
+            ((j_common_ptr) &cinfo, JPOOL_IMAGE, width * 4, numRows);
+    }
+    else // RGB, decode directly into the data buffer
+    {
+        rows = (JSAMPARRAY)(*cinfo.mem->alloc_small)
+            ((j_common_ptr) &cinfo, JPOOL_IMAGE, numRows * sizeof(JSAMPROW));
+        for ( int n = 0; n < numRows; n++ )
+            rows[n] = data + n * stride;
+    }
+
+    if ( !sink.OnBegin(width, cinfo.output_height, false) )
+    {
+        (cinfo.src->term_source)(&cinfo);
+        jpeg_destroy_decompress( &cinfo );
+        return false;
+    }
+
+    while ( cinfo.output_scanline < cinfo.output_height )
+    {
+        const JDIMENSION y = cinfo.output_scanline;
+        const JDIMENSION count = jpeg_read_scanlines( &cinfo, rows, numRows );
+
+        if ( isCMYK )
+        {
+            unsigned char* ptr = data;
+            for ( JDIMENSION n = 0; n < count; n++ )
+            {
+                const unsigned char* inptr = (const unsigned char*) rows[n];
+                for ( JDIMENSION i = 0; i < width; i++ )
+                {
+                    wx_cmyk_to_rgb(ptr, inptr);
+                    ptr += 3;
+                    inptr += 4;
+                }
+            }
+        }
+
+        if ( !sink.OnRows(y, count, data, NULL) )
+        {
+            (cinfo.src->term_source)(&cinfo);
+            jpeg_destroy_decompress( &cinfo );
+            return false;
+        }
+    }
+
+    jpeg_finish_decompress( &cinfo );
+    jpeg_destroy_decompress( &cinfo );
+    return true;
+}
+
+bool wxJPEGHandler::LoadRows(wxImageRowSink& sink,
+                             wxInputStream& stream,
+                             int scale,
+                             bool verbose,
+                             int WXUNUSED(index))
+{
+    wxCHECK_MSG( scale >= 1, false, wxS("invalid scale") );
+
+    // libjpeg supports reducing the image by 2, 4 or 8 itself, do the rest of
+    // the reduction, if any, ourselves.
+    unsigned scaleJPEG = 1;
+    while ( scaleJPEG < 8 && scale % (scaleJPEG * 2) == 0 )
+        scaleJPEG *= 2;
+
+    wxImageRowReducer reducer(sink, scale / scaleJPEG);
+
+    return DoLoadJPEGRows(reducer, stream, scaleJPEG, verbose);
+}
+
 typedef struct {
     struct jpeg_destination_mgr pub;
 
@@ -22,6 +22,7 @@
 
 #include "wx/imagpng.h"
 #include "wx/versioninfo.h"
+#include "wx/private/image.h"
 
 #ifndef WX_PRECOMP
     #include "wx/log.h"
@@ -105,9 +106,11 @@ struct wxPNGImageData
     {
         lines = NULL;
         m_buf = NULL;
+        m_rowBuf = NULL;
         info_ptr = (png_infop) NULL;
         png_ptr = (png_structp) NULL;
         ok = false;
+        stopped = false;
     }
 
     bool Alloc(png_uint_32 width, png_uint_32 height, unsigned char* buf)
@@ -139,6 +142,7 @@ struct wxPNGImageData
 
     ~wxPNGImageData()
     {
+        free(m_rowBuf);
         free(m_buf);
         free( lines );
 
@@ -153,11 +157,19 @@ struct wxPNGImageData
 
     void DoLoadPNGFile(wxImage* image, wxPNGInfoStruct& wxinfo);
 
+    void DoLoadPNGRows(wxImageRowSink& sink, wxPNGInfoStruct& wxinfo);
+    bool SendRow(wxImageRowSink& sink, png_uint_32 y, png_uint_32 width,
+                 const unsigned char* row, bool hasAlpha);
+
     unsigned char** lines;
     unsigned char* m_buf;
+    unsigned char* m_rowBuf;
     png_infop info_ptr;
     png_structp png_ptr;
     bool ok;
+
+    // Set by DoLoadPNGRows() if the sink asked to stop loading.
+    bool stopped;
 };
 
 } // anonymous namespace
@@ -417,6 +429,157 @@ wxPNGImageData::DoLoadPNGFile(wxImage* image, wxPNGInfoStruct& wxinfo)
     ok = true;
 }
 
+// Pass a row in RGB or RGBA format, depending on hasAlpha, to the sink.
+bool
+wxPNGImageData::SendRow(wxImageRowSink& sink,
+                        png_uint_32 y,
+                        png_uint_32 width,
+                        const unsigned char* row,
+                        bool hasAlpha)
+{
+    if ( !hasAlpha )
+        return sink.OnRows(y, 1, row, NULL);
+
+    // Split RGBA into RGB and alpha parts using the second half of the row
+    // buffer, the first one is used for reading the rows.
+    unsigned char* const data = m_rowBuf + 4*width;
+    unsigned char* const alpha = data + 3*width;
+
+    unsigned char* ptrData = data;
+    for ( png_uint_32 x = 0; x < width; x++ )
+    {
+        *ptrData++ = *row++;
+        *ptrData++ = *row++;
+        *ptrData++ = *row++;
+        alpha[x] = *row++;
+    }
+
+    return sink.OnRows(y, 1, data, alpha);
+}
+
+// This function is similar to DoLoadPNGFile() but passes the rows to the sink
+// as soon as they are decoded instead of storing all of them in wxImage.
+void
+wxPNGImageData::DoLoadPNGRows(wxImageRowSink& sink, wxPNGInfoStruct& wxinfo)
+{
+    png_uint_32 width, height = 0;
+    int bit_depth, color_type, interlace_type;
+
+    png_ptr = png_create_read_struct
+                          (
+                            PNG_LIBPNG_VER_STRING,
+                            NULL,
+                            wx_PNG_error,
+                            wx_PNG_warning
+                          );
+    if (!png_ptr)
+        return;
+
+    png_set_read_fn( png_ptr, &wxinfo, wx_PNG_stream_reader);
+
+    info_ptr = png_create_info_struct( png_ptr );
+    if (!info_ptr)
+        return;
+
+    if (setjmp(wxinfo.jmpbuf))
+        return;
+
+    png_read_info( png_ptr, info_ptr );
+    png_get_IHDR( png_ptr, info_ptr, &width, &height, &bit_depth, &color_type,
+                  &interlace_type, NULL, NULL );
+
+    png_set_expand(png_ptr);
+    png_set_gray_to_rgb(png_ptr);
+    png_set_strip_16( png_ptr );
+    png_set_packing( png_ptr );
+
+    // As in DoLoadPNGFile(), the rows are in RGBA format if there is any
+    // transparency and RGB otherwise. Unlike it, we can't check if all the
+    // pixels are actually opaque before deciding whether we need alpha.
+    const bool hasAlpha =
+        (color_type & PNG_COLOR_MASK_ALPHA) ||
+        png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS);
+
+    // Buffer used for reading a single row and for splitting it into RGB
+    // and alpha parts, see SendRow().
+    m_rowBuf = static_cast<unsigned char*>(malloc(8 * (size_t)width));
+    if ( !m_rowBuf )
+        return;
+
+    if ( !sink.OnBegin((int)width, (int)height, hasAlpha) )
+    {
+        stopped = true;
+        return;
+    }
+
+    if ( interlace_type == PNG_INTERLACE_NONE )
+    {
+        for ( png_uint_32 y = 0; y < height; y++ )
+        {
+            png_read_row( png_ptr, m_rowBuf, NULL );
+
+            if ( !SendRow(sink, y, width, m_rowBuf, hasAlpha) )
+            {
+                stopped = true;
+                return;
+            }
+        }
+    }
+    else // interlaced
+    {
+        // The rows are only complete after the last pass, so we have no
+        // choice but to decode the entire image at once.
+        if ( !Alloc(width, height, NULL) )
+            return;
+
+        png_read_image( png_ptr, lines );
+
+        for ( png_uint_32 y = 0; y < height; y++ )
+        {
+            if ( !SendRow(sink, y, width, lines[y], hasAlpha) )
+            {
+                stopped = true;
+                return;
+            }
+        }
+    }
+
+    png_read_end( png_ptr, info_ptr );
+
+    ok = true;
+}
+
+bool
+wxPNGHandler::LoadRows(wxImageRowSink& sink,
+                       wxInputStream& stream,
+                       int scale,
+                       bool verbose,
+                       int WXUNUSED(index))
+{
+    wxCHECK_MSG( scale >= 1, false, wxS("invalid scale") );
+
+    wxPNGInfoStruct wxinfo;
+    wxinfo.verbose = verbose;
+    wxinfo.stream.in = &stream;
+
+    wxImageRowReducer reducer(sink, scale);
+
+    wxPNGImageData data;
+    data.DoLoadPNGRows(reducer, wxinfo);
+
+    if ( !data.ok )
+    {
+        if ( verbose && !data.stopped )
+        {
+           wxLogError(_("Couldn't load a PNG image - file is corrupted or not enough memory."));
+        }
+
+        return false;
+    }
+
+    return true;
+}
+
 bool
 wxPNGHandler::LoadFile(wxImage *image,
                        wxInputStream& stream,
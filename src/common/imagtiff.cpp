@@ -39,6 +39,8 @@ extern "C"
 }
 #include "wx/filefn.h"
 #include "wx/wfstream.h"
+#include "wx/vector.h"
+#include "wx/private/image.h"
 
 #ifndef TIFFLINKAGEMODE
     #define TIFFLINKAGEMODE LINKAGEMODE
@@ -282,6 +284,103 @@ TIFFwxOpen(wxOutputStream &stream, const char* name, const char* mode)
     return tif;
 }
 
+// ----------------------------------------------------------------------------
+// LoadFile() and LoadRows() helpers
+// ----------------------------------------------------------------------------
+
+// Check if the image has an alpha channel.
+static bool
+IsTiffWithAlpha(uint16 samplesPerPixel,
+                uint16 extraSamples,
+                const uint16* samplesInfo,
+                uint16 photometric)
+{
+    return (extraSamples >= 1
+        && ((samplesInfo[0] == EXTRASAMPLE_UNSPECIFIED)
+            || samplesInfo[0] == EXTRASAMPLE_ASSOCALPHA
+            || samplesInfo[0] == EXTRASAMPLE_UNASSALPHA))
+        || (extraSamples == 0 && samplesPerPixel == 4
+            && photometric == PHOTOMETRIC_RGB);
+}
+
+// Check if the image is greyscale with alpha which needs to be decoded using
+// ConvertGreyAlphaScanline() instead of libtiff RGBA functions.
+static bool
+NeedsGreyAlphaDecoding(TIFF* tif,
+                       uint16 planarConfig,
+                       uint16 samplesPerPixel,
+                       uint16 extraSamples,
+                       uint16 bitsPerSample)
+{
+    char msg[1024] = "";
+    return (planarConfig == PLANARCONFIG_CONTIG && samplesPerPixel == 2
+                && extraSamples == 1)
+            &&
+            (
+                ( !TIFFRGBAImageOK(tif, msg) )
+                || (bitsPerSample == 8)
+            );
+}
+
+// Decode a scanline of greyscale image with alpha to ABGR format, as that is
+// what the code converting it to wxImage expects (normally libtiff RGBA
+// functions, which use ABGR layout, are used for decoding).
+static void
+ConvertGreyAlphaScanline(const unsigned char* buf,
+                         uint32 w,
+                         uint16 bitsPerSample,
+                         uint16 photometric,
+                         uint32* raster)
+{
+    const bool isGreyScale = (bitsPerSample == 8);
+    const bool minIsWhite = (photometric == PHOTOMETRIC_MINISWHITE);
+    const int minValue =  minIsWhite ? 255 : 0;
+    const int maxValue = 255 - minValue;
+
+    if (isGreyScale)
+    {
+        for (uint32 x = 0; x < w; ++x)
+        {
+            uint8 val = minIsWhite ? 255 - buf[x*2] : buf[x*2];
+            uint8 alpha = minIsWhite ? 255 - buf[x*2+1] : buf[x*2+1];
+            *raster++ = val + (val << 8) + (val << 16)
+                + (alpha << 24);
+        }
+    }
+    else
+    {
+        for (uint32 x = 0; x < w; ++x)
+        {
+            int mask = buf[x*2/8] << ((x*2)%8);
+
+            uint8 val = mask & 128 ? maxValue : minValue;
+            *raster++ = val + (val << 8) + (val << 16)
+                + ((mask & 64 ? maxValue : minValue) << 24);
+        }
+    }
+}
+
+// Convert ABGR pixels to RGB data and, optionally, alpha.
+static void
+ConvertFromRaster(const uint32* raster,
+                  size_t count,
+                  unsigned char* ptr,
+                  unsigned char* alpha)
+{
+    for (size_t pos = 0; pos < count; pos++)
+    {
+        *(ptr++) = (unsigned char)TIFFGetR(raster[pos]);
+        *(ptr++) = (unsigned char)TIFFGetG(raster[pos]);
+        *(ptr++) = (unsigned char)TIFFGetB(raster[pos]);
+        if ( alpha )
+            *(alpha++) = (unsigned char)TIFFGetA(raster[pos]);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// reading TIFFs
+// ----------------------------------------------------------------------------
+
 bool wxTIFFHandler::LoadFile( wxImage *image, wxInputStream& stream, bool verbose, int index )
 {
     if (index == -1)
@@ -335,12 +434,8 @@ bool wxTIFFHandler::LoadFile( wxImage *image, wxInputStream& stream, bool verbos
     {
         photometric = PHOTOMETRIC_MINISWHITE;
     }
-    const bool hasAlpha = (extraSamples >= 1
-        && ((samplesInfo[0] == EXTRASAMPLE_UNSPECIFIED)
-            || samplesInfo[0] == EXTRASAMPLE_ASSOCALPHA
-            || samplesInfo[0] == EXTRASAMPLE_UNASSALPHA))
-        || (extraSamples == 0 && samplesPerPixel == 4
-            && photometric == PHOTOMETRIC_RGB);
+    const bool hasAlpha = IsTiffWithAlpha(samplesPerPixel, extraSamples,
+                                          samplesInfo, photometric);
 
     // guard against integer overflow during multiplication which could result
     // in allocating a too small buffer and then overflowing it
@@ -392,30 +487,11 @@ bool wxTIFFHandler::LoadFile( wxImage *image, wxInputStream& stream, bool verbos
     (void) TIFFGetField(tif, TIFFTAG_PLANARCONFIG, &planarConfig);
 
     bool ok = true;
-    char msg[1024] = "";
-    if
-    (
-        (planarConfig == PLANARCONFIG_CONTIG && samplesPerPixel == 2
-            && extraSamples == 1)
-        &&
-        (
-            ( !TIFFRGBAImageOK(tif, msg) )
-            || (bitsPerSample == 8)
-        )
-    )
+    if ( NeedsGreyAlphaDecoding(tif, planarConfig, samplesPerPixel,
+                                extraSamples, bitsPerSample) )
     {
-        const bool isGreyScale = (bitsPerSample == 8);
         unsigned char *buf = (unsigned char *)_TIFFmalloc(TIFFScanlineSize(tif));
-        uint32 pos = 0;
-        const bool minIsWhite = (photometric == PHOTOMETRIC_MINISWHITE);
-        const int minValue =  minIsWhite ? 255 : 0;
-        const int maxValue = 255 - minValue;
 
-        /*
-        Decode to ABGR format as that is what the code, that converts to
-        wxImage, later on expects (normally TIFFReadRGBAImageOriented is
-        used to decode which uses an ABGR layout).
-        */
         for (uint32 y = 0; y < h; ++y)
         {
             if (TIFFReadScanline(tif, buf, y, 0) != 1)
@@ -424,29 +500,8 @@ bool wxTIFFHandler::LoadFile( wxImage *image, wxInputStream& stream, bool verbos
                 break;
             }
 
-            if (isGreyScale)
-            {
-                for (uint32 x = 0; x < w; ++x)
-                {
-                    uint8 val = minIsWhite ? 255 - buf[x*2] : buf[x*2];
-                    uint8 alpha = minIsWhite ? 255 - buf[x*2+1] : buf[x*2+1];
-                    raster[pos] = val + (val << 8) + (val << 16)
-                        + (alpha << 24);
-                    pos++;
-                }
-            }
-            else
-            {
-                for (uint32 x = 0; x < w; ++x)
-                {
-                    int mask = buf[x*2/8] << ((x*2)%8);
-
-                    uint8 val = mask & 128 ? maxValue : minValue;
-                    raster[pos] = val + (val << 8) + (val << 16)
-                        + ((mask & 64 ? maxValue : minValue) << 24);
-                    pos++;
-                }
-            }
+            ConvertGreyAlphaScanline(buf, w, bitsPerSample, photometric,
+                                     raster + y*w);
         }
 
         _TIFFfree(buf);
@@ -472,25 +527,7 @@ bool wxTIFFHandler::LoadFile( wxImage *image, wxInputStream& stream, bool verbos
         return false;
     }
 
-    unsigned char *ptr = image->GetData();
-
-    unsigned char *alpha = image->GetAlpha();
-
-    uint32 pos = 0;
-
-    for (uint32 i = 0; i < h; i++)
-    {
-        for (uint32 j = 0; j < w; j++)
-        {
-            *(ptr++) = (unsigned char)TIFFGetR(raster[pos]);
-            *(ptr++) = (unsigned char)TIFFGetG(raster[pos]);
-            *(ptr++) = (unsigned char)TIFFGetB(raster[pos]);
-            if ( hasAlpha )
-                *(alpha++) = (unsigned char)TIFFGetA(raster[pos]);
-
-            pos++;
-        }
-    }
+    ConvertFromRaster(raster, (size_t)w*h, image->GetData(), image->GetAlpha());
 
 
     image->SetOption(wxIMAGE_OPTION_TIFF_PHOTOMETRIC, photometric);
@@ -574,6 +611,190 @@ bool wxTIFFHandler::LoadFile( wxImage *image, wxInputStream& stream, bool verbos
     return true;
 }
 
+bool wxTIFFHandler::LoadRows( wxImageRowSink& sink, wxInputStream& stream,
+                              int scale, bool verbose, int index )
+{
+    wxCHECK_MSG( scale >= 1, false, wxS("invalid scale") );
+
+    if (index == -1)
+        index = 0;
+
+    const wxFileOffset posStart = stream.TellI();
+
+    TIFF *tif = TIFFwxOpen( stream, "image", "r" );
+
+    if (!tif)
+    {
+        if (verbose)
+        {
+            wxLogError( _("TIFF: Error loading image.") );
+        }
+
+        return false;
+    }
+
+    if (!TIFFSetDirectory( tif, (tdir_t)index ))
+    {
+        if (verbose)
+        {
+            wxLogError( _("Invalid TIFF image index.") );
+        }
+
+        TIFFClose( tif );
+
+        return false;
+    }
+
+    // We decode the image in bands of rows from top to bottom, which is
+    // impossible to do efficiently for the images stored in the other order,
+    // so just load them entirely.
+    uint16 orientation = ORIENTATION_TOPLEFT;
+    (void) TIFFGetFieldDefaulted(tif, TIFFTAG_ORIENTATION, &orientation);
+    if ( orientation != ORIENTATION_TOPLEFT &&
+            orientation != ORIENTATION_TOPRIGHT )
+    {
+        TIFFClose( tif );
+
+        if ( posStart == wxInvalidOffset ||
+                stream.SeekI(posStart) == wxInvalidOffset )
+            return false;
+
+        return wxImageHandler::LoadRows(sink, stream, scale, verbose, index);
+    }
+
+    uint32 w, h;
+
+    TIFFGetField( tif, TIFFTAG_IMAGEWIDTH, &w );
+    TIFFGetField( tif, TIFFTAG_IMAGELENGTH, &h );
+
+    uint16 samplesPerPixel = 0;
+    (void) TIFFGetFieldDefaulted(tif, TIFFTAG_SAMPLESPERPIXEL, &samplesPerPixel);
+
+    uint16 bitsPerSample = 0;
+    (void) TIFFGetFieldDefaulted(tif, TIFFTAG_BITSPERSAMPLE, &bitsPerSample);
+
+    uint16 extraSamples;
+    uint16* samplesInfo;
+    TIFFGetFieldDefaulted(tif, TIFFTAG_EXTRASAMPLES,
+                          &extraSamples, &samplesInfo);
+
+    uint16 photometric;
+    if (!TIFFGetField(tif, TIFFTAG_PHOTOMETRIC, &photometric))
+    {
+        photometric = PHOTOMETRIC_MINISWHITE;
+    }
+
+    uint16 planarConfig = PLANARCONFIG_CONTIG;
+    (void) TIFFGetField(tif, TIFFTAG_PLANARCONFIG, &planarConfig);
+
+    const bool hasAlpha = IsTiffWithAlpha(samplesPerPixel, extraSamples,
+                                          samplesInfo, photometric);
+
+    // Use the bands corresponding to the strips or tiles of the image to
+    // avoid decoding any of them more than once.
+    uint32 rowsPerBand = 0;
+    if ( TIFFIsTiled(tif) )
+        (void) TIFFGetField(tif, TIFFTAG_TILELENGTH, &rowsPerBand);
+    else
+        (void) TIFFGetFieldDefaulted(tif, TIFFTAG_ROWSPERSTRIP, &rowsPerBand);
+
+    if ( rowsPerBand == 0 || rowsPerBand > h )
+        rowsPerBand = h;
+
+    // guard against integer overflow, as in LoadFile()
+    const double bytesNeeded = (double)w * (double)rowsPerBand * sizeof(uint32);
+    if ( bytesNeeded >= wxUINT32_MAX )
+    {
+        if ( verbose )
+        {
+            wxLogError( _("TIFF: Image size is abnormally big.") );
+        }
+
+        TIFFClose(tif);
+
+        return false;
+    }
+
+    const bool useScanlines = NeedsGreyAlphaDecoding(tif, planarConfig,
+                                                     samplesPerPixel,
+                                                     extraSamples,
+                                                     bitsPerSample);
+
+    TIFFRGBAImage img;
+    char msg[1024] = "";
+    if ( !useScanlines )
+    {
+        if ( !TIFFRGBAImageOK(tif, msg) ||
+                !TIFFRGBAImageBegin(&img, tif, 0, msg) )
+        {
+            if (verbose)
+            {
+                wxLogError( _("TIFF: Error reading image.") );
+            }
+
+            TIFFClose( tif );
+
+            return false;
+        }
+
+        img.req_orientation = ORIENTATION_TOPLEFT;
+    }
+
+    const size_t bandSize = (size_t)w * rowsPerBand;
+    wxVector<uint32> raster(bandSize);
+    wxVector<unsigned char> data(3 * bandSize),
+                            alpha(hasAlpha ? bandSize : 0),
+                            scanline(useScanlines ? TIFFScanlineSize(tif) : 0);
+
+    wxImageRowReducer reducer(sink, scale);
+
+    bool ok = reducer.OnBegin((int)w, (int)h, hasAlpha);
+
+    for ( uint32 y = 0; ok && y < h; y += rowsPerBand )
+    {
+        const uint32 count = wxMin(rowsPerBand, h - y);
+
+        if ( useScanlines )
+        {
+            for ( uint32 n = 0; ok && n < count; n++ )
+            {
+                if ( TIFFReadScanline(tif, &scanline[0], y + n, 0) != 1 )
+                    ok = false;
+                else
+                    ConvertGreyAlphaScanline(&scanline[0], w, bitsPerSample,
+                                             photometric, &raster[n * w]);
+            }
+        }
+        else
+        {
+            img.row_offset = y;
+            img.col_offset = 0;
+            ok = TIFFRGBAImageGet(&img, &raster[0], w, count) != 0;
+        }
+
+        if ( !ok )
+        {
+            if (verbose)
+            {
+                wxLogError( _("TIFF: Error reading image.") );
+            }
+            break;
+        }
+
+        ConvertFromRaster(&raster[0], (size_t)w * count,
+                          &data[0], hasAlpha ? &alpha[0] : NULL);
+
+        ok = reducer.OnRows(y, count, &data[0], hasAlpha ? &alpha[0] : NULL);
+    }
+
+    if ( !useScanlines )
+        TIFFRGBAImageEnd(&img);
+
+    TIFFClose( tif );
+
+    return ok;
+}
+
 int wxTIFFHandler::DoGetImageCount( wxInputStream& stream )
 {
     TIFF *tif = TIFFwxOpen( stream, "image", "r" );
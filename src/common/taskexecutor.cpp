@@ -0,0 +1,885 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        src/common/taskexecutor.cpp
+// Purpose:     wxTaskExecutor implementation
+// Author:      wxWidgets team
+// Created:     2026-10-18
+// Copyright:   (c) 2026 wxWidgets team
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+// ============================================================================
+// declarations
+// ============================================================================
+
+// ----------------------------------------------------------------------------
+// headers
+// ----------------------------------------------------------------------------
+
+// For compilers that support precompilation, includes "wx.h".
+#include "wx/wxprec.h"
+
+
+#if wxUSE_THREADS
+
+#include "wx/taskexecutor.h"
+
+#ifndef WX_PRECOMP
+    #include "wx/app.h"
+    #include "wx/module.h"
+    #include "wx/stopwatch.h"
+#endif // WX_PRECOMP
+
+#include "wx/scopedptr.h"
+#include "wx/tls.h"
+
+#include "wx/private/mpscqueue.h"
+
+// ----------------------------------------------------------------------------
+// globals
+// ----------------------------------------------------------------------------
+
+namespace
+{
+
+// The worker thread running the current code, if any.
+inline wxTLS_TYPE_REF(wxTaskWorker*) GetCurrentWorker()
+{
+    static wxTLS_TYPE(wxTaskWorker*) s_currentWorker;
+
+    return s_currentWorker;
+}
+
+#define wxCURRENT_TASK_WORKER wxTLS_VALUE(GetCurrentWorker())
+
+// The task whose continuations are being dispatched by the current thread.
+inline wxTLS_TYPE_REF(wxTaskBase*) GetFinishingTask()
+{
+    static wxTLS_TYPE(wxTaskBase*) s_finishingTask;
+
+    return s_finishingTask;
+}
+
+#define wxCURRENT_FINISHING_TASK wxTLS_VALUE(GetFinishingTask())
+
+// Values of wxTaskBase::m_cancelRequested.
+enum wxTaskCancelRequest
+{
+    // The task wasn't asked to stop.
+    wxTASK_CANCEL_NONE,
+
+    // Cancel() was called while the task was running.
+    wxTASK_CANCEL_REQUESTED,
+
+    // The task was asked to stop and knows about it, as it was told so by
+    // IsCurrentTaskCancelled(), so it is considered to be cancelled.
+    wxTASK_CANCEL_OBSERVED
+};
+
+// Special continuation used to mark the task continuations list as closed
+// once it finishes.
+class wxClosedTaskContinuation : public wxTaskContinuation
+{
+public:
+    wxClosedTaskContinuation() : wxTaskContinuation(false) { }
+
+    virtual void Run() wxOVERRIDE { }
+};
+
+wxClosedTaskContinuation gs_closedContinuation;
+
+// The executor returned by wxTaskExecutor::Get().
+wxTaskExecutor* gs_defaultExecutor = NULL;
+wxCriticalSection gs_csDefaultExecutor;
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------
+// wxTaskDeque: double-ended queue of tasks
+// ----------------------------------------------------------------------------
+
+// This is a simple ring buffer growing as needed, it's not thread-safe and is
+// always used under the lock of the worker owning it.
+class wxTaskDeque
+{
+public:
+    wxTaskDeque() : m_first(0), m_count(0) { }
+
+    bool IsEmpty() const { return m_count == 0; }
+
+    void PushBack(wxTaskBase* task)
+    {
+        GrowIfFull();
+
+        m_items[(m_first + m_count) & GetMask()] = task;
+        m_count++;
+    }
+
+    void PushFront(wxTaskBase* task)
+    {
+        GrowIfFull();
+
+        m_first = (m_first - 1) & GetMask();
+        m_items[m_first] = task;
+        m_count++;
+    }
+
+    wxTaskBase* PopBack()
+    {
+        m_count--;
+
+        return m_items[(m_first + m_count) & GetMask()];
+    }
+
+    wxTaskBase* PopFront()
+    {
+        wxTaskBase* const task = m_items[m_first];
+
+        m_first = (m_first + 1) & GetMask();
+        m_count--;
+
+        return task;
+    }
+
+private:
+    // The size of the buffer is always a power of 2.
+    size_t GetMask() const { return m_items.size() - 1; }
+
+    void GrowIfFull()
+    {
+        if ( m_count < m_items.size() )
+            return;
+
+        wxVector<wxTaskBase*> items(m_items.empty() ? 16 : 2*m_items.size());
+        for ( size_t n = 0; n < m_count; n++ )
+            items[n] = m_items[(m_first + n) & GetMask()];
+
+        m_items.swap(items);
+        m_first = 0;
+    }
+
+    wxVector<wxTaskBase*> m_items;
+    size_t m_first,
+           m_count;
+
+    wxDECLARE_NO_COPY_CLASS(wxTaskDeque);
+};
+
+// ----------------------------------------------------------------------------
+// wxTaskWorker: one of the executor threads
+// ----------------------------------------------------------------------------
+
+// Each worker has its own queues of tasks, one per priority. The worker takes
+// the tasks from the back of its queues, so that the tasks submitted by the
+// tasks it runs are executed first, while being cache-friendly, and the other
+// workers steal the tasks from the front of them when they run out of their
+// own tasks.
+class wxTaskWorker : public wxThread
+{
+public:
+    wxTaskWorker(wxTaskExecutor* executor, unsigned index)
+        : wxThread(wxTHREAD_JOINABLE),
+          m_executor(executor),
+          m_index(index),
+          m_currentTask(NULL)
+    {
+    }
+
+    // Add the task submitted by the task running in this worker, if local is
+    // true, or by another thread otherwise.
+    void Push(wxTaskBase* task, bool local)
+    {
+        wxCriticalSectionLocker lock(m_cs);
+
+        wxTaskDeque& tasks = m_tasks[task->m_priority];
+        if ( local )
+            tasks.PushBack(task);
+        else
+            tasks.PushFront(task);
+    }
+
+    // Take the task with the given priority for running it in this worker.
+    wxTaskBase* Pop(wxTaskPriority priority)
+    {
+        wxCriticalSectionLocker lock(m_cs);
+
+        wxTaskDeque& tasks = m_tasks[priority];
+
+        return tasks.IsEmpty() ? NULL : tasks.PopBack();
+    }
+
+    // Take the task with the given priority for running it in another worker.
+    wxTaskBase* Steal(wxTaskPriority priority)
+    {
+        wxCriticalSectionLocker lock(m_cs);
+
+        wxTaskDeque& tasks = m_tasks[priority];
+
+        return tasks.IsEmpty() ? NULL : tasks.PopFront();
+    }
+
+    virtual ExitCode Entry() wxOVERRIDE
+    {
+        wxCURRENT_TASK_WORKER = this;
+
+        for ( ;; )
+        {
+            if ( m_executor->m_shuttingDown )
+                break;
+
+            wxTaskBase* const task = m_executor->FindTask(this);
+            if ( task )
+            {
+                m_executor->RunTask(this, task);
+                continue;
+            }
+
+            if ( !m_executor->WaitForTasks() )
+                break;
+        }
+
+        wxCURRENT_TASK_WORKER = NULL;
+
+        return 0;
+    }
+
+    wxTaskExecutor* const m_executor;
+    const unsigned m_index;
+
+    // The task being executed by this worker, only used by it.
+    wxTaskBase* m_currentTask;
+
+private:
+    wxCriticalSection m_cs;
+    wxTaskDeque m_tasks[wxTASK_PRIORITY_HIGH + 1];
+
+    wxDECLARE_NO_COPY_CLASS(wxTaskWorker);
+};
+
+// ----------------------------------------------------------------------------
+// wxTaskMainThreadHandler: executes the continuations in the main thread
+// ----------------------------------------------------------------------------
+
+// The continuations are executed from CallAfter(), to do it as soon as
+// possible, but if there are too many of them to execute during the time slice
+// allocated to them, the remaining ones are executed in idle time, to avoid
+// blocking the processing of the other events.
+class wxTaskMainThreadHandler : public wxEvtHandler
+{
+public:
+    explicit wxTaskMainThreadHandler(wxTaskExecutor* executor)
+        : m_executor(executor),
+          m_idleBound(false)
+    {
+    }
+
+    virtual ~wxTaskMainThreadHandler()
+    {
+        if ( m_idleBound && wxTheApp )
+            wxTheApp->Unbind(wxEVT_IDLE, &wxTaskMainThreadHandler::OnIdle, this);
+    }
+
+    bool ScheduleProcessing()
+    {
+        // CallAfter() doesn't work without the application object, so
+        // ProcessMainThreadContinuations() must be called explicitly then.
+        if ( !wxTheApp )
+            return false;
+
+        CallAfter(&wxTaskMainThreadHandler::Process);
+
+        return true;
+    }
+
+    void ProcessWhenIdle()
+    {
+        if ( m_idleBound || !wxTheApp )
+            return;
+
+        wxTheApp->Bind(wxEVT_IDLE, &wxTaskMainThreadHandler::OnIdle, this);
+        m_idleBound = true;
+    }
+
+private:
+    void Process()
+    {
+        m_executor->ProcessMainThreadContinuations();
+    }
+
+    void OnIdle(wxIdleEvent& event)
+    {
+        event.Skip();
+
+        m_executor->ProcessMainThreadContinuations();
+
+        if ( m_executor->m_mainFirst )
+        {
+            event.RequestMore();
+        }
+        else
+        {
+            wxTheApp->Unbind(wxEVT_IDLE, &wxTaskMainThreadHandler::OnIdle, this);
+            m_idleBound = false;
+        }
+    }
+
+    wxTaskExecutor* const m_executor;
+    bool m_idleBound;
+
+    wxDECLARE_NO_COPY_CLASS(wxTaskMainThreadHandler);
+};
+
+// ============================================================================
+// wxTaskBase implementation
+// ============================================================================
+
+wxTaskBase::wxTaskBase(wxTaskExecutor* executor, wxTaskPriority priority)
+    : m_executor(executor),
+      m_priority(priority)
+{
+    m_refCount = 1;
+    m_state = wxTASK_PENDING;
+    m_cancelRequested = wxTASK_CANCEL_NONE;
+    m_continuations = NULL;
+    m_finished = 0;
+}
+
+wxTaskBase::~wxTaskBase()
+{
+}
+
+void wxTaskBase::Run()
+{
+    if ( !wxAtomicCompareExchange(m_state, wxTASK_PENDING, wxTASK_RUNNING) )
+    {
+        // The task was cancelled before it could start.
+        return;
+    }
+
+    wxTaskState state = wxTASK_DONE;
+
+    wxTRY
+    {
+        DoRun();
+    }
+    wxCATCH_ALL
+    (
+        state = wxTASK_FAILED;
+    )
+
+    // Only consider the task cancelled if it saw the cancellation request, as
+    // otherwise it must have run until the end and its result is valid.
+    if ( state == wxTASK_DONE && m_cancelRequested == wxTASK_CANCEL_OBSERVED )
+        state = wxTASK_CANCELLED;
+
+    wxAtomicCompareExchange(m_state, wxTASK_RUNNING, state);
+
+    Finish();
+}
+
+bool wxTaskBase::Cancel()
+{
+    if ( wxAtomicCompareExchange(m_state, wxTASK_PENDING, wxTASK_CANCELLED) )
+    {
+        // The task remains in the queue, but will be skipped when it's taken
+        // from it.
+        Finish();
+        return true;
+    }
+
+    // Ask the running task to stop, but don't do anything if it has already
+    // finished, and don't forget that it already noticed the request if it
+    // was made before either.
+    if ( GetState() == wxTASK_RUNNING )
+    {
+        wxAtomicCompareExchange(m_cancelRequested,
+                                wxTASK_CANCEL_NONE,
+                                wxTASK_CANCEL_REQUESTED);
+    }
+
+    return false;
+}
+
+void wxTaskBase::Finish()
+{
+    wxTaskContinuation* top;
+    do
+    {
+        top = m_continuations;
+    }
+    while ( !wxAtomicCompareExchangePtr(m_continuations, top,
+                static_cast<wxTaskContinuation*>(&gs_closedContinuation)) );
+
+    // Execute the continuations in the order in which they were added.
+    wxTaskContinuation* first = NULL;
+    while ( top )
+    {
+        wxTaskContinuation* const prev = top->m_next;
+        top->m_next = first;
+        first = top;
+        top = prev;
+    }
+
+    wxTaskBase* const previousTask = wxCURRENT_FINISHING_TASK;
+    wxCURRENT_FINISHING_TASK = this;
+
+    DispatchContinuations(first);
+
+    wxCURRENT_FINISHING_TASK = previousTask;
+
+    // Let Wait() return and wake up the waiting threads only now, so that
+    // they can rely on the continuations having been executed or posted to
+    // the main thread, even though the task state was already updated.
+    wxAtomicCompareExchange(m_finished, 0, 1);
+
+    m_executor->NotifyTaskDone();
+}
+
+void wxTaskBase::DispatchContinuations(wxTaskContinuation* continuations)
+{
+    while ( continuations )
+    {
+        wxTaskContinuation* const continuation = continuations;
+        continuations = continuation->m_next;
+        continuation->m_next = NULL;
+
+        if ( continuation->IsInMainThread() )
+        {
+            m_executor->PostToMainThread(continuation);
+            continue;
+        }
+
+        // There is nobody to report the exceptions to in the worker threads,
+        // so just make sure they don't terminate them.
+        wxTRY
+        {
+            continuation->Run();
+        }
+        wxCATCH_ALL
+        (
+            ;
+        )
+
+        delete continuation;
+    }
+}
+
+void wxTaskBase::AddContinuation(wxTaskContinuation* continuation)
+{
+    wxCHECK_RET( continuation, "NULL continuation" );
+
+    for ( ;; )
+    {
+        wxTaskContinuation* const top = m_continuations;
+        if ( top == &gs_closedContinuation )
+        {
+            // The task has already finished.
+            DispatchContinuations(continuation);
+            return;
+        }
+
+        continuation->m_next = top;
+        if ( wxAtomicCompareExchangePtr(m_continuations, top, continuation) )
+            return;
+    }
+}
+
+void wxTaskBase::Wait()
+{
+    if ( IsFinished() )
+        return;
+
+    // The continuations of this task, which typically call Wait() to get its
+    // result, can't wait until Finish() dispatching them returns, but the
+    // result is already available to them.
+    if ( wxCURRENT_FINISHING_TASK == this )
+        return;
+
+    wxTaskWorker* const worker = wxCURRENT_TASK_WORKER;
+    if ( worker && worker->m_executor == m_executor )
+    {
+        // Blocking this worker could result in a deadlock if all the other
+        // workers are waiting too, so execute the other tasks instead.
+        m_executor->HelpUntilDone(worker, this);
+        return;
+    }
+
+    wxAtomicInc(m_executor->m_numWaiters);
+
+    {
+        wxMutexLocker lock(m_executor->m_doneMutex);
+        while ( !IsFinished() )
+            m_executor->m_doneCondition.Wait();
+    }
+
+    wxAtomicDec(m_executor->m_numWaiters);
+}
+
+// ============================================================================
+// wxTaskExecutor implementation
+// ============================================================================
+
+wxTaskExecutor::wxTaskExecutor(unsigned numThreads)
+    : m_sleepCondition(m_sleepMutex),
+      m_doneCondition(m_doneMutex)
+{
+    m_nextWorker = 0;
+    for ( size_t n = 0; n < WXSIZEOF(m_numQueued); n++ )
+        m_numQueued[n] = 0;
+    m_numSleeping = 0;
+    m_shuttingDown = false;
+    m_numWaiters = 0;
+    m_numHelpers = 0;
+
+    m_mainQueue = NULL;
+    m_mainFirst =
+    m_mainLast = NULL;
+    m_mainScheduled = 0;
+    m_mainThreadTimeSlice = 10;
+    m_mainThreadHandler = new wxTaskMainThreadHandler(this);
+
+    if ( !numThreads )
+    {
+        const int numCPUs = wxThread::GetCPUCount();
+        numThreads = numCPUs > 0 ? numCPUs : 1;
+    }
+
+    for ( unsigned n = 0; n < numThreads; n++ )
+    {
+        wxTaskWorker* const worker = new wxTaskWorker(this, m_workers.size());
+        if ( worker->Run() != wxTHREAD_NO_ERROR )
+        {
+            delete worker;
+            break;
+        }
+
+        m_workers.push_back(worker);
+    }
+
+    wxASSERT_MSG( !m_workers.empty(), "failed to create any worker threads" );
+}
+
+wxTaskExecutor::~wxTaskExecutor()
+{
+    m_shuttingDown = true;
+
+    {
+        wxMutexLocker lock(m_sleepMutex);
+        m_sleepCondition.Broadcast();
+    }
+
+    // The running tasks see that they should stop in IsCurrentTaskCancelled()
+    // now, wait until they do it.
+    for ( size_t n = 0; n < m_workers.size(); n++ )
+        m_workers[n]->Wait();
+
+    // Cancel all the tasks which didn't get to run.
+    for ( size_t n = 0; n < m_workers.size(); n++ )
+    {
+        for ( int priority = wxTASK_PRIORITY_HIGH;
+              priority >= wxTASK_PRIORITY_LOW;
+              priority-- )
+        {
+            while ( wxTaskBase* const
+                        task = m_workers[n]->Steal(static_cast<wxTaskPriority>(priority)) )
+            {
+                task->Cancel();
+                task->DecRef();
+            }
+        }
+    }
+
+    for ( size_t n = 0; n < m_workers.size(); n++ )
+        delete m_workers[n];
+
+    // Finally delete the main thread continuations which won't be executed.
+    wxTaskContinuation* last;
+    wxTaskContinuation*
+        continuation = wxMPSCQueueTakeAll(m_mainQueue,
+                                          &wxTaskContinuation::m_next,
+                                          &last);
+    if ( m_mainLast )
+    {
+        m_mainLast->m_next = continuation;
+        continuation = m_mainFirst;
+    }
+
+    while ( continuation )
+    {
+        wxTaskContinuation* const next = continuation->m_next;
+        delete continuation;
+        continuation = next;
+    }
+
+    delete m_mainThreadHandler;
+}
+
+/* static */
+wxTaskExecutor& wxTaskExecutor::Get()
+{
+    wxCriticalSectionLocker lock(gs_csDefaultExecutor);
+
+    if ( !gs_defaultExecutor )
+        gs_defaultExecutor = new wxTaskExecutor();
+
+    return *gs_defaultExecutor;
+}
+
+/* static */
+bool wxTaskExecutor::IsCurrentTaskCancelled()
+{
+    const wxTaskWorker* const worker = wxCURRENT_TASK_WORKER;
+    if ( !worker || !worker->m_currentTask )
+        return false;
+
+    wxTaskBase* const task = worker->m_currentTask;
+
+    // All the running tasks are cancelled when the executor is destroyed.
+    if ( !worker->m_executor->m_shuttingDown &&
+            task->m_cancelRequested == wxTASK_CANCEL_NONE )
+        return false;
+
+    // Remember that the task knows that it should stop now, so that it's
+    // considered to be cancelled when it returns.
+    task->m_cancelRequested = wxTASK_CANCEL_OBSERVED;
+
+    return true;
+}
+
+void wxTaskExecutor::DoSubmit(wxTaskBase* task)
+{
+    if ( m_shuttingDown || m_workers.empty() )
+    {
+        task->Cancel();
+        task->DecRef();
+        return;
+    }
+
+    // The tasks submitted by the tasks running in our workers are kept in the
+    // same worker, the others are distributed between all of them.
+    wxTaskWorker* worker = wxCURRENT_TASK_WORKER;
+    const bool local = worker && worker->m_executor == this;
+    if ( !local )
+    {
+        // wxAtomicInc() doesn't return the new value, so just go through the
+        // workers in the reverse order.
+        const wxUint32 next = static_cast<wxUint32>(wxAtomicDec(m_nextWorker));
+
+        worker = m_workers[next % m_workers.size()];
+    }
+
+    worker->Push(task, local);
+    wxAtomicInc(m_numQueued[task->m_priority]);
+
+    // Both the increment above and the one in WaitForTasks() act as memory
+    // barriers, so either we see the sleeping worker here or it sees the new
+    // task there.
+    if ( m_numSleeping )
+    {
+        wxMutexLocker lock(m_sleepMutex);
+        m_sleepCondition.Signal();
+    }
+
+    // The same reasoning applies to the workers waiting for other tasks to
+    // finish, which can run this one in the meanwhile.
+    NotifyHelpers();
+}
+
+bool wxTaskExecutor::HasQueuedTasks() const
+{
+    for ( size_t n = 0; n < WXSIZEOF(m_numQueued); n++ )
+    {
+        if ( m_numQueued[n] > 0 )
+            return true;
+    }
+
+    return false;
+}
+
+wxTaskBase* wxTaskExecutor::FindTask(wxTaskWorker* worker)
+{
+    const size_t numWorkers = m_workers.size();
+
+    for ( int n = wxTASK_PRIORITY_HIGH; n >= wxTASK_PRIORITY_LOW; n-- )
+    {
+        if ( m_numQueued[n] <= 0 )
+            continue;
+
+        const wxTaskPriority priority = static_cast<wxTaskPriority>(n);
+
+        wxTaskBase* task = worker->Pop(priority);
+
+        // Try stealing the task from the other workers, starting with the
+        // next one to avoid all of them trying to steal from the same one.
+        for ( size_t i = 1; !task && i < numWorkers; i++ )
+            task = m_workers[(worker->m_index + i) % numWorkers]->Steal(priority);
+
+        if ( task )
+        {
+            wxAtomicDec(m_numQueued[n]);
+            return task;
+        }
+    }
+
+    return NULL;
+}
+
+bool wxTaskExecutor::WaitForTasks()
+{
+    wxMutexLocker lock(m_sleepMutex);
+
+    wxAtomicInc(m_numSleeping);
+
+    while ( !m_shuttingDown && !HasQueuedTasks() )
+        m_sleepCondition.Wait();
+
+    wxAtomicDec(m_numSleeping);
+
+    return !m_shuttingDown;
+}
+
+void wxTaskExecutor::RunTask(wxTaskWorker* worker, wxTaskBase* task)
+{
+    wxTaskBase* const previousTask = worker->m_currentTask;
+    worker->m_currentTask = task;
+
+    task->Run();
+
+    worker->m_currentTask = previousTask;
+
+    task->DecRef();
+}
+
+void wxTaskExecutor::HelpUntilDone(wxTaskWorker* worker, wxTaskBase* task)
+{
+    while ( !task->IsFinished() )
+    {
+        wxTaskBase* const otherTask = FindTask(worker);
+        if ( otherTask )
+        {
+            RunTask(worker, otherTask);
+            continue;
+        }
+
+        // Nothing to do, wait until some task finishes or a new one, which we
+        // could run, is submitted.
+        wxAtomicInc(m_numWaiters);
+        wxAtomicInc(m_numHelpers);
+
+        {
+            wxMutexLocker lock(m_doneMutex);
+            while ( !task->IsFinished() && !HasQueuedTasks() )
+                m_doneCondition.Wait();
+        }
+
+        wxAtomicDec(m_numHelpers);
+        wxAtomicDec(m_numWaiters);
+    }
+}
+
+void wxTaskExecutor::NotifyTaskDone()
+{
+    if ( m_numWaiters )
+    {
+        wxMutexLocker lock(m_doneMutex);
+        m_doneCondition.Broadcast();
+    }
+}
+
+void wxTaskExecutor::NotifyHelpers()
+{
+    if ( m_numHelpers )
+    {
+        wxMutexLocker lock(m_doneMutex);
+        m_doneCondition.Broadcast();
+    }
+}
+
+void wxTaskExecutor::PostToMainThread(wxTaskContinuation* continuation)
+{
+    wxMPSCQueuePush(m_mainQueue, continuation, &wxTaskContinuation::m_next);
+
+    // Schedule a single call to ProcessMainThreadContinuations() for all the
+    // continuations posted before it happens.
+    //
+    // If it can't be scheduled, reset the flag to try again the next time.
+    if ( wxAtomicCompareExchange(m_mainScheduled, 0, 1) &&
+            !m_mainThreadHandler->ScheduleProcessing() )
+    {
+        wxAtomicCompareExchange(m_mainScheduled, 1, 0);
+    }
+}
+
+size_t wxTaskExecutor::ProcessMainThreadContinuations()
+{
+    wxCHECK_MSG( wxThread::IsMain(), 0, "must be called from the main thread" );
+
+    // Reset the flag before taking the continuations, so that the ones posted
+    // after doing it result in another call to this function.
+    wxAtomicCompareExchange(m_mainScheduled, 1, 0);
+
+    wxTaskContinuation* last;
+    wxTaskContinuation* const
+        first = wxMPSCQueueTakeAll(m_mainQueue,
+                                   &wxTaskContinuation::m_next,
+                                   &last);
+    if ( first )
+    {
+        if ( m_mainLast )
+            m_mainLast->m_next = first;
+        else
+            m_mainFirst = first;
+
+        m_mainLast = last;
+    }
+
+    wxStopWatch sw;
+
+    size_t count = 0;
+    while ( m_mainFirst )
+    {
+        // Remove the continuation from the list before running it, as it can
+        // reenter this function.
+        wxScopedPtr<wxTaskContinuation> continuation(m_mainFirst);
+        m_mainFirst = m_mainFirst->m_next;
+        if ( !m_mainFirst )
+            m_mainLast = NULL;
+
+        continuation->Run();
+        count++;
+
+        if ( m_mainThreadTimeSlice && sw.Time() >= m_mainThreadTimeSlice )
+            break;
+    }
+
+    if ( m_mainFirst )
+        m_mainThreadHandler->ProcessWhenIdle();
+
+    return count;
+}
+
+// ----------------------------------------------------------------------------
+// wxTaskExecutorModule: destroys the default executor
+// ----------------------------------------------------------------------------
+
+class wxTaskExecutorModule : public wxModule
+{
+public:
+    wxTaskExecutorModule()
+    {
+        // The worker threads must be stopped before the threads support is
+        // cleaned up.
+        AddDependency("wxThreadModule");
+    }
+
+    virtual bool OnInit() wxOVERRIDE { return true; }
+    virtual void OnExit() wxOVERRIDE
+    {
+        wxDELETE(gs_defaultExecutor);
+    }
+
+    wxDECLARE_DYNAMIC_CLASS(wxTaskExecutorModule);
+};
+
+wxIMPLEMENT_DYNAMIC_CLASS(wxTaskExecutorModule, wxModule);
+
+#endif // wxUSE_THREADS
@@ -43,11 +43,14 @@
 #include "wx/itemattr.h"
 #include "wx/list.h"
 #include "wx/listimpl.cpp"
+#include "wx/hashmap.h"
 #include "wx/imaglist.h"
 #include "wx/headerctrl.h"
 #include "wx/dnd.h"
 #include "wx/selstore.h"
 #include "wx/stopwatch.h"
+#include "wx/taskexecutor.h"
+#include "wx/thread.h"
 #include "wx/weakref.h"
 #include "wx/generic/private/markuptext.h"
 #include "wx/generic/private/rowheightcache.h"
@@ -71,10 +74,13 @@ class wxDataViewCtrl;
 // the cell padding on the left/right
 static const int PADDING_RIGHTLEFT = 3;
 
+// the minimal number of children for which a tree node indexes them by item
+static const int CHILDREN_INDEX_THRESHOLD = 64;
+
 namespace
 {
 
-// Flags for Walker() function defined below.
+// Flags for wxDataViewMainWindow::GetRowByItem().
 enum WalkFlags
 {
     Walk_All,               // Visit all items.
@@ -478,6 +484,10 @@ class wxDataViewTreeNode;
 
 typedef wxVector<wxDataViewTreeNode*> wxDataViewTreeNodes;
 
+// Map from the item IDs to the positions of the corresponding child nodes.
+WX_DECLARE_HASH_MAP(void*, int, wxPointerHash, wxPointerEqual,
+                    wxDataViewTreeNodePositions);
+
 // Note: this class is not used at all for virtual list models, so all code
 // using it, i.e. any functions taking or returning objects of this type,
 // including wxDataViewMainWindow::m_root, can only be called after checking
@@ -527,6 +537,16 @@ public:
     void InsertChild(wxDataViewMainWindow* window,
                      wxDataViewTreeNode *node, unsigned index);
 
+    // Appends all the given nodes, which must be new children of this node,
+    // and sorts them if necessary.
+    void AppendChildren(wxDataViewMainWindow* window,
+                        const wxDataViewTreeNodes& nodes);
+
+    // Replaces the children with the given nodes, which must include all the
+    // existing ones, without sorting them. The nodes vector is swapped with
+    // the children and so contains the old children on return.
+    void SetChildNodes(wxDataViewTreeNodes& nodes);
+
     void RemoveChild(unsigned index)
     {
         wxCHECK_RET( m_branchData != NULL, "leaf node doesn't have children" );
@@ -541,6 +561,15 @@ public:
 
         const wxDataViewTreeNodes& nodes = m_branchData->children;
         const int len = nodes.size();
+        if ( len >= CHILDREN_INDEX_THRESHOLD )
+        {
+            UpdatePositions();
+
+            const wxDataViewTreeNodePositions& positions = *m_branchData->positions;
+            wxDataViewTreeNodePositions::const_iterator it = positions.find(item.GetID());
+            return it == positions.end() ? wxNOT_FOUND : it->second;
+        }
+
         for ( int i = 0; i < len; i++ )
         {
             if ( nodes[i]->m_item == item )
@@ -549,6 +578,21 @@ public:
         return wxNOT_FOUND;
     }
 
+    // Returns the number of rows between the first child of this node and the
+    // child at the given position.
+    int GetChildRowOffset(unsigned index) const
+    {
+        UpdateRowOffsets();
+
+        return m_branchData->rowOffsets[index];
+    }
+
+    // Returns the child node shown in the given row or containing it in its
+    // subtree, with the row counted from the first child of this node, which
+    // must be less than GetSubTreeCount(). On return, row is relative to the
+    // returned node, i.e. it is 0 if the row corresponds to the node itself.
+    wxDataViewTreeNode* GetChildByRow(int& row) const;
+
     const wxDataViewItem & GetItem() const { return m_item; }
     void SetItem( const wxDataViewItem & item ) { m_item = item; }
 
@@ -615,6 +659,9 @@ public:
 
         if ( !has )
         {
+            if ( m_branchData && m_branchData->subTreeCount )
+                m_parent->m_branchData->rowOffsetsValid = false;
+
             wxDELETE(m_branchData);
         }
         else if ( m_branchData == NULL )
@@ -639,7 +686,12 @@ public:
         wxASSERT( m_branchData->subTreeCount >= 0 );
 
         if( m_parent )
+        {
+            // The rows of all our following siblings have changed.
+            m_parent->m_branchData->rowOffsetsValid = false;
+
             m_parent->ChangeSubTreeCount(num);
+        }
     }
 
     void Resort(wxDataViewMainWindow* window);
@@ -653,6 +705,12 @@ public:
     }
 
 private:
+    // Recompute BranchNodeData::rowOffsets if necessary.
+    void UpdateRowOffsets() const;
+
+    // Recompute BranchNodeData::positions if necessary.
+    void UpdatePositions() const;
+
     // Called by the child after it has been updated to put it in the right
     // place among its siblings, depending on the sort order.
     //
@@ -672,18 +730,36 @@ private:
     {
         BranchNodeData()
             : open(false),
-              subTreeCount(0)
+              subTreeCount(0),
+              positions(NULL),
+              rowOffsetsValid(false),
+              positionsValid(false)
+        {
+        }
+
+        ~BranchNodeData()
         {
+            delete positions;
         }
 
         void InsertChild(wxDataViewTreeNode* node, unsigned index)
         {
             children.insert(children.begin() + index, node);
+            ChildrenChanged();
         }
 
         void RemoveChild(unsigned index)
         {
             children.erase(children.begin() + index);
+            ChildrenChanged();
+        }
+
+        // Must be called whenever the children are added, removed or
+        // reordered.
+        void ChildrenChanged()
+        {
+            rowOffsetsValid = false;
+            positionsValid = false;
         }
 
         // Child nodes. Note that this may be empty even if m_hasChildren in
@@ -701,6 +777,21 @@ private:
         // 0 for leaves and is the number of rows the subtree occupies for
         // branch nodes.
         int                  subTreeCount;
+
+        // Number of rows preceding each child in this subtree, i.e. the sum
+        // of 1 + GetSubTreeCount() for all the previous children. This allows
+        // mapping between rows and nodes in time proportional to the tree
+        // depth instead of the number of rows. Computed on demand.
+        wxVector<int>        rowOffsets;
+
+        // Positions of the children indexed by their items, only used if
+        // there are at least CHILDREN_INDEX_THRESHOLD of them and computed
+        // on demand too.
+        wxDataViewTreeNodePositions *positions;
+
+        // Whether rowOffsets and positions are up to date.
+        bool                 rowOffsetsValid,
+                             positionsValid;
     };
 
     BranchNodeData *m_branchData;
@@ -712,6 +803,30 @@ private:
 // wxDataViewMainWindow
 //-----------------------------------------------------------------------------
 
+// The data retrieved from the model for rendering a single cell.
+struct wxDataViewCachedCell
+{
+    unsigned int        column;     // model column
+    wxVariant           value;
+    wxDataViewItemAttr  attr;
+    bool                enabled;
+};
+
+// All the cached cells of an item.
+struct wxDataViewCachedRow
+{
+    wxDataViewCachedRow() : row(0) { }
+
+    // The row at which the item was shown when it was last painted, used only
+    // for deciding which items to forget.
+    unsigned int                    row;
+    wxVector<wxDataViewCachedCell>  cells;
+};
+
+// Map from the item IDs to their cached cells.
+WX_DECLARE_HASH_MAP(void*, wxDataViewCachedRow, wxPointerHash, wxPointerEqual,
+                    wxDataViewCellCache);
+
 class wxDataViewMainWindow: public wxWindow
 {
 public:
@@ -736,6 +851,7 @@ public:
     bool Cleared();
     void Resort()
     {
+        InsertBatchedItems();
         ClearRowHeightCache();
 
         if (!IsVirtualList())
@@ -750,6 +866,25 @@ public:
             m_rowHeightCache->Clear();
     }
 
+    // Forget the cached data of the cells of the given item or of all items.
+    void InvalidateCellCache(const wxDataViewItem& item)
+    {
+        m_cellCache.erase(item.GetID());
+    }
+    void ClearCellCache()
+    {
+        m_cellCache.clear();
+    }
+
+    // Start and end a batch of notifications: during it, the items added to
+    // the model are only inserted into the tree when another notification
+    // needs it or when the batch ends, and the window is refreshed only once.
+    void BeginBatch() { m_batchCount++; }
+    void EndBatch();
+
+    // End the batch without updating the tree, which must be rebuilt.
+    void CancelBatch();
+
     SortOrder GetSortOrder() const
     {
         wxDataViewColumn* const col = GetOwner()->GetSortingColumn();
@@ -777,6 +912,19 @@ public:
 #if wxUSE_DRAG_AND_DROP
     wxBitmap CreateItemBitmap( unsigned int row, int &indent );
 #endif // wxUSE_DRAG_AND_DROP
+
+    // Refreshing the entire window may be done because the model data has
+    // changed without notifying us about it, so forget the cached data then.
+    // Refreshing just a part of it, as done by RefreshRows(), keeps it.
+    virtual void Refresh(bool eraseBackground = true,
+                         const wxRect *rect = NULL) wxOVERRIDE
+    {
+        if ( !rect )
+            ClearCellCache();
+
+        wxWindow::Refresh(eraseBackground, rect);
+    }
+
     void OnPaint( wxPaintEvent &event );
     void OnCharHook( wxKeyEvent &event );
     void OnChar( wxKeyEvent &event );
@@ -1008,6 +1156,19 @@ private:
     // Helper of public Expand(), must be called with a valid node.
     void DoExpand(wxDataViewTreeNode* node, unsigned int row, bool expandChildren);
 
+    // Insert all items added during the current batch into the tree.
+    void InsertBatchedItems();
+
+    // Forget about the items added during the current batch if they are the
+    // given item, being deleted from the model, or its descendants.
+    void ForgetBatchedItems(const wxDataViewItem& parent,
+                            const wxDataViewItem& item);
+
+    // Helper of InsertBatchedItems(): insert the new child nodes of the given
+    // parent node at the same positions as the model has them.
+    void InsertChildrenInModelOrder(wxDataViewTreeNode* parentNode,
+                                    const wxDataViewTreeNodes& nodes);
+
 private:
     wxDataViewCtrl             *m_owner;
     int                         m_lineHeight;
@@ -1058,6 +1219,51 @@ private:
     // Id m_editorCtrl is non-NULL, pointer to the associated renderer.
     wxDataViewRenderer* m_editorRenderer;
 
+    // The data of the cells painted recently, so that repainting them, e.g.
+    // when scrolling, doesn't require getting it from the model again. It is
+    // invalidated by the model change notifications.
+    wxDataViewCellCache m_cellCache;
+
+    // Prepare the renderer for drawing the given cell using the cached data,
+    // retrieving it from the model first if necessary.
+    void PrepareCachedCell(wxDataViewRenderer* cell,
+                           const wxDataViewItem& item,
+                           unsigned int row,
+                           unsigned int column);
+
+    // Forget the cached data of the items not shown in the given rows range
+    // if there are too many of them.
+    void TrimCellCache(unsigned int rowFirst, unsigned int rowLast);
+
+    // Number of nested BeginBatch() calls.
+    int m_batchCount;
+
+    // Set if the window needs to be refreshed at the end of the batch.
+    bool m_batchDirty;
+
+    // Items added to the model during the current batch and not inserted
+    // into the tree yet, with their parents.
+    struct BatchedItem
+    {
+        BatchedItem(const wxDataViewItem& parent_, const wxDataViewItem& item_)
+            : parent(parent_), item(item_)
+        {
+        }
+
+        wxDataViewItem parent,
+                       item;
+    };
+
+    wxVector<BatchedItem> m_batchedItems;
+
+    // Put the items changed during the current batch in their sorted
+    // positions and forget the heights of all rows.
+    void ApplyBatchedChanges();
+
+    // Items changed during the current batch, may contain duplicates and
+    // the items deleted after being changed.
+    wxVector<wxDataViewItem> m_batchedChanges;
+
 private:
     wxDECLARE_DYNAMIC_CLASS(wxDataViewMainWindow);
     wxDECLARE_EVENT_TABLE();
@@ -1071,7 +1277,15 @@ class wxGenericDataViewModelNotifier: public wxDataViewModelNotifier
 {
 public:
     wxGenericDataViewModelNotifier( wxDataViewMainWindow *mainWindow )
-        { m_mainWindow = mainWindow; }
+        { m_mainWindow = mainWindow; m_inBatch = false; }
+
+    virtual ~wxGenericDataViewModelNotifier()
+    {
+        // We won't get EndBatch() any more if the model is in the middle of a
+        // batch, so don't leave the window waiting for it.
+        if ( m_inBatch )
+            m_mainWindow->CancelBatch();
+    }
 
     virtual bool ItemAdded( const wxDataViewItem & parent, const wxDataViewItem & item ) wxOVERRIDE
         { return m_mainWindow->ItemAdded( parent , item ); }
@@ -1086,7 +1300,39 @@ public:
     virtual void Resort() wxOVERRIDE
         { m_mainWindow->Resort(); }
 
+    // Process the notifications about several items as a single batch.
+    virtual bool ItemsAdded( const wxDataViewItem &parent, const wxDataViewItemArray &items ) wxOVERRIDE
+    {
+        m_mainWindow->BeginBatch();
+        const bool ok = wxDataViewModelNotifier::ItemsAdded(parent, items);
+        m_mainWindow->EndBatch();
+        return ok;
+    }
+    virtual bool ItemsDeleted( const wxDataViewItem &parent, const wxDataViewItemArray &items ) wxOVERRIDE
+    {
+        m_mainWindow->BeginBatch();
+        const bool ok = wxDataViewModelNotifier::ItemsDeleted(parent, items);
+        m_mainWindow->EndBatch();
+        return ok;
+    }
+    virtual bool ItemsChanged( const wxDataViewItemArray &items ) wxOVERRIDE
+    {
+        m_mainWindow->BeginBatch();
+        const bool ok = wxDataViewModelNotifier::ItemsChanged(items);
+        m_mainWindow->EndBatch();
+        return ok;
+    }
+
+    virtual void BeginBatch() wxOVERRIDE
+        { m_inBatch = true; m_mainWindow->BeginBatch(); }
+    virtual void EndBatch() wxOVERRIDE
+        { m_inBatch = false; m_mainWindow->EndBatch(); }
+
     wxDataViewMainWindow    *m_mainWindow;
+
+private:
+    // Set between BeginBatch() and EndBatch() calls.
+    bool                     m_inBatch;
 };
 
 // ---------------------------------------------------------
@@ -1801,6 +2047,266 @@ private:
     const SortOrder m_sortOrder;
 };
 
+// Comparator used for sorting the indices of the nodes by their sort keys,
+// which must be in the same order as the default wxDataViewModel::Compare()
+// would put the corresponding items.
+template <typename T>
+class wxDataViewSortKeyCmp
+{
+public:
+    wxDataViewSortKeyCmp(const wxVector<T>& keys,
+                         const wxVector<wxUIntPtr>& ids,
+                         bool ascending)
+        : m_keys(keys.begin()),
+          m_ids(ids.begin()),
+          m_ascending(ascending)
+    {
+    }
+
+    bool operator()(int first, int second) const
+    {
+        const T& key1 = m_keys[first];
+        const T& key2 = m_keys[second];
+
+        if ( key1 < key2 )
+            return m_ascending;
+        if ( key2 < key1 )
+            return !m_ascending;
+
+        // As in wxDataViewModel::Compare(), order the items with equal values
+        // by their IDs.
+        return m_ascending ? m_ids[first] < m_ids[second]
+                           : m_ids[second] < m_ids[first];
+    }
+
+private:
+    const typename wxVector<T>::const_iterator m_keys;
+    const wxVector<wxUIntPtr>::const_iterator m_ids;
+    const bool m_ascending;
+};
+
+// Functions extracting the sort keys from the values of the types supported
+// by wxDataViewModel::Compare(), return false if the value can't be used.
+bool GetSortKey(const wxVariant& value, wxString& key)
+{
+    if ( value.GetType() == wxS("string") )
+    {
+        key = value.GetString();
+    }
+    else // wxDataViewIconText
+    {
+        wxDataViewIconText iconText;
+        iconText << value;
+        key = iconText.GetText();
+    }
+
+    return true;
+}
+
+bool GetSortKey(const wxVariant& value, long& key)
+{
+    key = value.GetLong();
+    return true;
+}
+
+bool GetSortKey(const wxVariant& value, double& key)
+{
+    key = value.GetDouble();
+
+    // NaNs can't be ordered.
+    return key == key;
+}
+
+bool GetSortKey(const wxVariant& value, bool& key)
+{
+    key = value.GetBool();
+    return true;
+}
+
+#if wxUSE_DATETIME
+bool GetSortKey(const wxVariant& value, wxLongLong& key)
+{
+    const wxDateTime dt = value.GetDateTime();
+    if ( !dt.IsValid() )
+        return false;
+
+    key = dt.GetValue();
+    return true;
+}
+#endif // wxUSE_DATETIME
+
+#if wxUSE_THREADS
+
+// Minimal number of items for sorting them in several threads.
+const size_t PARALLEL_SORT_THRESHOLD = 50000;
+
+// Task sorting a chunk of the range in wxTaskExecutor.
+template <typename Cmp>
+struct wxDataViewSortTask
+{
+    wxDataViewSortTask(int* first, int* last, const Cmp& cmp)
+        : m_first(first),
+          m_last(last),
+          m_cmp(cmp)
+    {
+    }
+
+    void operator()() const
+    {
+        std::sort(m_first, m_last, m_cmp);
+    }
+
+    int* m_first;
+    int* m_last;
+    Cmp m_cmp;
+};
+
+#endif // wxUSE_THREADS
+
+// Sort the given range, using the worker threads of the shared executor if it
+// is big enough: each thread sorts a chunk of it and the chunks are merged
+// after.
+template <typename Cmp>
+void ParallelSort(int* first, int* last, const Cmp& cmp)
+{
+#if wxUSE_THREADS
+    const size_t count = last - first;
+    const int numCPUs = wxThread::GetCPUCount();
+    if ( count >= PARALLEL_SORT_THRESHOLD && numCPUs > 1 )
+    {
+        wxTaskExecutor& executor = wxTaskExecutor::Get();
+
+        // This thread sorts one of the chunks too.
+        const size_t numChunks = wxMin(executor.GetThreadCount() + 1,
+                                       static_cast<unsigned>(wxMin(numCPUs, 8)));
+
+        wxVector<int*> bounds;
+        for ( size_t n = 0; n <= numChunks; n++ )
+            bounds.push_back(first + count*n/numChunks);
+
+        wxVector< wxTaskFuture<void> > futures;
+        for ( size_t n = 1; n < numChunks; n++ )
+        {
+            futures.push_back(executor.Submit<void>
+                              (
+                                wxDataViewSortTask<Cmp>(bounds[n],
+                                                        bounds[n + 1],
+                                                        cmp)
+                              ));
+        }
+
+        std::sort(bounds[0], bounds[1], cmp);
+
+        for ( size_t n = 0; n < futures.size(); n++ )
+            futures[n].Wait();
+
+        for ( size_t width = 1; width < numChunks; width *= 2 )
+        {
+            for ( size_t n = 0; n + width < numChunks; n += 2*width )
+            {
+                std::inplace_merge(bounds[n], bounds[n + width],
+                                   bounds[wxMin(n + 2*width, numChunks)],
+                                   cmp);
+            }
+        }
+
+        return;
+    }
+#endif // wxUSE_THREADS
+
+    std::sort(first, last, cmp);
+}
+
+// Helper of SortNodesByValues() for the given type of keys.
+template <typename T>
+bool DoSortNodesByValues(wxDataViewModel* model,
+                         const SortOrder& sortOrder,
+                         const wxString& type,
+                         wxDataViewTreeNodes& nodes)
+{
+    const unsigned col = sortOrder.GetColumn();
+    const size_t count = nodes.size();
+
+    // Retrieve all the keys first: this can only be done from this thread
+    // and only once for each item instead of twice for every comparison.
+    wxVector<T> keys(count);
+    wxVector<wxUIntPtr> ids(count);
+    typename wxVector<T>::iterator key = keys.begin();
+    wxVector<wxUIntPtr>::iterator id = ids.begin();
+
+    wxVariant value;
+    for ( wxDataViewTreeNodes::const_iterator i = nodes.begin();
+          i != nodes.end();
+          ++i, ++key, ++id )
+    {
+        const wxDataViewItem& item = (*i)->GetItem();
+        if ( !model->HasValue(item, col) )
+            return false;
+
+        model->GetValue(value, item, col);
+        if ( value.GetType() != type || !GetSortKey(value, *key) )
+            return false;
+
+        *id = wxPtrToUInt(item.GetID());
+    }
+
+    wxVector<int> order(count);
+    for ( size_t n = 0; n < count; n++ )
+        order[n] = n;
+
+    int* const first = &order[0];
+    ParallelSort(first, first + count,
+                 wxDataViewSortKeyCmp<T>(keys, ids, sortOrder.IsAscending()));
+
+    wxDataViewTreeNodes sorted;
+    sorted.reserve(count);
+    for ( size_t n = 0; n < count; n++ )
+        sorted.push_back(nodes[first[n]]);
+
+    nodes.swap(sorted);
+
+    return true;
+}
+
+// Sort the nodes by the values of their items in the sort column if the model
+// uses the default comparison function, which only compares these values.
+// Returns false if the nodes couldn't be sorted in this way, e.g. because they
+// use values of different or unsupported types.
+bool SortNodesByValues(wxDataViewModel* model,
+                       const SortOrder& sortOrder,
+                       wxDataViewTreeNodes& nodes)
+{
+    if ( !sortOrder.UsesColumn() || !model->UsesDefaultCompare() )
+        return false;
+
+    if ( nodes.size() < 2 )
+        return true;
+
+    const unsigned col = sortOrder.GetColumn();
+    const wxDataViewItem& item = nodes[0]->GetItem();
+    if ( !model->HasValue(item, col) )
+        return false;
+
+    wxVariant value;
+    model->GetValue(value, item, col);
+
+    const wxString type = value.GetType();
+    if ( type == wxS("string") || type == wxS("wxDataViewIconText") )
+        return DoSortNodesByValues<wxString>(model, sortOrder, type, nodes);
+    if ( type == wxS("long") )
+        return DoSortNodesByValues<long>(model, sortOrder, type, nodes);
+    if ( type == wxS("double") )
+        return DoSortNodesByValues<double>(model, sortOrder, type, nodes);
+    if ( type == wxS("bool") )
+        return DoSortNodesByValues<bool>(model, sortOrder, type, nodes);
+#if wxUSE_DATETIME
+    if ( type == wxS("datetime") )
+        return DoSortNodesByValues<wxLongLong>(model, sortOrder, type, nodes);
+#endif // wxUSE_DATETIME
+
+    return false;
+}
+
 } // anonymous namespace
 
 void wxDataViewTreeNode::InsertChild(wxDataViewMainWindow* window,
@@ -1908,9 +2414,13 @@ void wxDataViewTreeNode::Resort(wxDataViewMainWindow* window)
         // using model-specific sort order, which can change at any time.
         if ( m_branchData->sortOrder != sortOrder || !sortOrder.UsesColumn() )
         {
-            std::sort(m_branchData->children.begin(),
-                      m_branchData->children.end(),
-                      wxGenericTreeModelNodeCmp(window, sortOrder));
+            if ( !SortNodesByValues(window->GetModel(), sortOrder, nodes) )
+            {
+                std::sort(m_branchData->children.begin(),
+                          m_branchData->children.end(),
+                          wxGenericTreeModelNodeCmp(window, sortOrder));
+            }
+            m_branchData->ChildrenChanged();
 
             m_branchData->sortOrder = sortOrder;
         }
@@ -1926,6 +2436,101 @@ void wxDataViewTreeNode::Resort(wxDataViewMainWindow* window)
 }
 
 
+void wxDataViewTreeNode::AppendChildren(wxDataViewMainWindow* window,
+                                        const wxDataViewTreeNodes& nodes)
+{
+    if ( !m_branchData )
+        m_branchData = new BranchNodeData;
+
+    wxDataViewTreeNodes& children = m_branchData->children;
+    children.reserve(children.size() + nodes.size());
+    for ( wxDataViewTreeNodes::const_iterator i = nodes.begin();
+          i != nodes.end();
+          ++i )
+    {
+        children.push_back(*i);
+    }
+
+    m_branchData->ChildrenChanged();
+
+    // The children are not sorted any more, but instead of inserting each of
+    // them at its sorted position, as InsertChild() does, which takes
+    // quadratic time, sort all of them at once if necessary.
+    m_branchData->sortOrder = SortOrder();
+    Resort(window);
+}
+
+void wxDataViewTreeNode::SetChildNodes(wxDataViewTreeNodes& nodes)
+{
+    if ( !m_branchData )
+        m_branchData = new BranchNodeData;
+
+    m_branchData->children.swap(nodes);
+    m_branchData->ChildrenChanged();
+
+    // As with InsertChild() without sorting, the children are not sorted
+    // any more.
+    m_branchData->sortOrder = SortOrder();
+}
+
+void wxDataViewTreeNode::UpdateRowOffsets() const
+{
+    BranchNodeData* const data = m_branchData;
+    if ( data->rowOffsetsValid )
+        return;
+
+    const wxDataViewTreeNodes& nodes = data->children;
+    data->rowOffsets.resize(nodes.size());
+
+    int row = 0;
+    wxVector<int>::iterator offset = data->rowOffsets.begin();
+    for ( wxDataViewTreeNodes::const_iterator i = nodes.begin();
+          i != nodes.end();
+          ++i, ++offset )
+    {
+        *offset = row;
+        row += 1 + (*i)->GetSubTreeCount();
+    }
+
+    data->rowOffsetsValid = true;
+}
+
+void wxDataViewTreeNode::UpdatePositions() const
+{
+    BranchNodeData* const data = m_branchData;
+    if ( data->positionsValid )
+        return;
+
+    if ( data->positions )
+        data->positions->clear();
+    else
+        data->positions = new wxDataViewTreeNodePositions;
+
+    const wxDataViewTreeNodes& nodes = data->children;
+    int pos = 0;
+    for ( wxDataViewTreeNodes::const_iterator i = nodes.begin();
+          i != nodes.end();
+          ++i, ++pos )
+    {
+        (*data->positions)[(*i)->m_item.GetID()] = pos;
+    }
+
+    data->positionsValid = true;
+}
+
+wxDataViewTreeNode* wxDataViewTreeNode::GetChildByRow(int& row) const
+{
+    UpdateRowOffsets();
+
+    // Find the last child starting at or before the given row.
+    const wxVector<int>& offsets = m_branchData->rowOffsets;
+    const unsigned pos = std::upper_bound(offsets.begin(), offsets.end(), row)
+                            - offsets.begin() - 1;
+
+    row -= offsets[pos];
+    return m_branchData->children[pos];
+}
+
 void
 wxDataViewTreeNode::PutChildInSortOrder(wxDataViewMainWindow* window,
                                         wxDataViewTreeNode* childNode)
@@ -2098,6 +2703,9 @@ wxDataViewMainWindow::wxDataViewMainWindow( wxDataViewCtrl *parent, wxWindowID i
     m_count = -1;
     m_underMouse = NULL;
 
+    m_batchCount = 0;
+    m_batchDirty = false;
+
     UpdateDisplay();
 }
 
@@ -2480,6 +3088,64 @@ wxBitmap wxDataViewMainWindow::CreateItemBitmap( unsigned int row, int &indent )
 
 #endif // wxUSE_DRAG_AND_DROP
 
+void wxDataViewMainWindow::PrepareCachedCell(wxDataViewRenderer* cell,
+                                             const wxDataViewItem& item,
+                                             unsigned int row,
+                                             unsigned int column)
+{
+    wxDataViewCachedRow& cachedRow = m_cellCache[item.GetID()];
+    cachedRow.row = row;
+
+    for ( wxVector<wxDataViewCachedCell>::const_iterator it = cachedRow.cells.begin();
+          it != cachedRow.cells.end();
+          ++it )
+    {
+        if ( it->column == column )
+        {
+            cell->PrepareForData(it->value, it->attr, it->enabled);
+            return;
+        }
+    }
+
+    wxDataViewCachedCell cached;
+    cached.column = column;
+    cached.enabled = true;
+    cell->GetDataForItem(GetModel(), item, column,
+                         cached.value, cached.attr, cached.enabled);
+
+    cell->PrepareForData(cached.value, cached.attr, cached.enabled);
+
+    // Notice that we can't reuse cachedRow here as the model could have sent
+    // us a notification invalidating it from inside GetDataForItem().
+    m_cellCache[item.GetID()].cells.push_back(cached);
+}
+
+void wxDataViewMainWindow::TrimCellCache(unsigned int rowFirst,
+                                         unsigned int rowLast)
+{
+    // Allow keeping a few more items than are shown to avoid doing this on
+    // every repaint.
+    const size_t maxItems = 2*(rowLast - rowFirst + 1) + 16;
+    if ( m_cellCache.size() <= maxItems )
+        return;
+
+    wxVector<void*> hiddenItems;
+    for ( wxDataViewCellCache::const_iterator it = m_cellCache.begin();
+          it != m_cellCache.end();
+          ++it )
+    {
+        if ( it->second.row < rowFirst || it->second.row > rowLast )
+            hiddenItems.push_back(it->first);
+    }
+
+    for ( wxVector<void*>::const_iterator it = hiddenItems.begin();
+          it != hiddenItems.end();
+          ++it )
+    {
+        m_cellCache.erase(*it);
+    }
+}
+
 void wxDataViewMainWindow::OnPaint( wxPaintEvent &WXUNUSED(event) )
 {
     wxDataViewModel *model = GetModel();
@@ -2836,7 +3502,7 @@ void wxDataViewMainWindow::OnPaint( wxPaintEvent &WXUNUSED(event) )
 
             cell->SetState(state);
             if (hasValue)
-                cell->PrepareForItem(model, dataitem, col->GetModelColumn());
+                PrepareCachedCell(cell, dataitem, item, col->GetModelColumn());
 
             // draw the background
             if ( !selected )
@@ -2926,6 +3592,11 @@ void wxDataViewMainWindow::OnPaint( wxPaintEvent &WXUNUSED(event) )
         cell_rect.x += cell_rect.width;
     }
 
+    // Forget the cached data of the items which are not shown any longer.
+    int yVisible = 0;
+    m_owner->CalcUnscrolledPosition(0, 0, NULL, &yVisible);
+    TrimCellCache(GetLineAt(yVisible), GetLineAt(yVisible + size.y));
+
 #if wxUSE_DRAG_AND_DROP
     if (m_dropItemInfo.m_hint == DropHint_Below || m_dropItemInfo.m_hint == DropHint_Above)
     {
@@ -3017,75 +3688,26 @@ void wxDataViewHeaderWindow::FinishEditing()
     win->FinishEditing();
 }
 
-//-----------------------------------------------------------------------------
-// Helper class for do operation on the tree node
-//-----------------------------------------------------------------------------
-
-namespace
-{
-
-class DoJob
-{
-public:
-    DoJob() { }
-    virtual ~DoJob() { }
-
-    // The return value control how the tree-walker tranverse the tree
-    enum
-    {
-        DONE,          // Job done, stop traversing and return
-        SKIP_SUBTREE,  // Ignore the current node's subtree and continue
-        CONTINUE       // Job not done, continue
-    };
-
-    virtual int operator() ( wxDataViewTreeNode * node ) = 0;
-};
-
-bool
-Walker(wxDataViewTreeNode * node, DoJob & func, WalkFlags flags = Walk_All)
-{
-    wxCHECK_MSG( node, false, "can't walk NULL node" );
-
-    switch( func( node ) )
-    {
-        case DoJob::DONE:
-            return true;
-        case DoJob::SKIP_SUBTREE:
-            return false;
-        case DoJob::CONTINUE:
-            break;
-    }
-
-    if ( node->HasChildren() && (flags != Walk_ExpandedOnly || node->IsOpen()) )
-    {
-        const wxDataViewTreeNodes& nodes = node->GetChildNodes();
-
-        for ( wxDataViewTreeNodes::const_iterator i = nodes.begin();
-              i != nodes.end();
-              ++i )
-        {
-            if ( Walker(*i, func, flags) )
-                return true;
-        }
-    }
-
-    return false;
-}
-
-} // anonymous namespace
-
-bool wxDataViewMainWindow::ItemAdded(const wxDataViewItem & parent, const wxDataViewItem & item)
+bool wxDataViewMainWindow::ItemAdded(const wxDataViewItem & parent, const wxDataViewItem & item)
 {
     if (IsVirtualList())
     {
         wxDataViewVirtualListModel *list_model =
             (wxDataViewVirtualListModel*) GetModel();
         m_count = list_model->GetCount();
+
+        // The IDs of all the items after the new one have changed.
+        ClearCellCache();
     }
     else
     {
-        // specific position (row) is unclear, so clear whole height cache
-        ClearRowHeightCache();
+        if ( m_batchCount )
+        {
+            // Insert the item together with all the other items added during
+            // this batch later.
+            m_batchedItems.push_back(BatchedItem(parent, item));
+            return true;
+        }
 
         wxDataViewTreeNode *parentNode = FindNode(parent);
 
@@ -3158,6 +3780,13 @@ bool wxDataViewMainWindow::ItemAdded(const wxDataViewItem & parent, const wxData
         }
 
         InvalidateCount();
+
+        if ( m_rowHeightCache )
+        {
+            const int row = GetRowByItem(item, Walk_ExpandedOnly);
+            if ( row != -1 )
+                m_rowHeightCache->InsertRows(row, 1);
+        }
     }
 
     m_selection.OnItemsInserted(GetRowByItem(item), 1);
@@ -3171,6 +3800,11 @@ bool wxDataViewMainWindow::ItemAdded(const wxDataViewItem & parent, const wxData
 bool wxDataViewMainWindow::ItemDeleted(const wxDataViewItem& parent,
                                        const wxDataViewItem& item)
 {
+    // The IDs of the deleted item and its children may be reused for other
+    // items and, for virtual list models, the IDs of all subsequent items
+    // change, so forget everything cached for them.
+    ClearCellCache();
+
     if (IsVirtualList())
     {
         wxDataViewVirtualListModel *list_model =
@@ -3181,6 +3815,12 @@ bool wxDataViewMainWindow::ItemDeleted(const wxDataViewItem& parent,
     }
     else // general case
     {
+        if ( !m_batchedItems.empty() )
+        {
+            ForgetBatchedItems(parent, item);
+            InsertBatchedItems();
+        }
+
         wxDataViewTreeNode *parentNode = FindNode(parent);
 
         // Notice that it is possible that the item being deleted is not in the
@@ -3197,18 +3837,10 @@ bool wxDataViewMainWindow::ItemDeleted(const wxDataViewItem& parent,
         // removed from the model by the time ItemDeleted() is called, so we
         // have to do it manually. We keep track of its position as well for
         // later use.
-        int itemPosInNode = 0;
+        const int itemPosInNode = parentNode->FindChildByItem(item);
         wxDataViewTreeNode *itemNode = NULL;
-        for ( wxDataViewTreeNodes::const_iterator i = parentsChildren.begin();
-              i != parentsChildren.end();
-              ++i, ++itemPosInNode )
-        {
-            if( (*i)->GetItem() == item )
-            {
-                itemNode = *i;
-                break;
-            }
-        }
+        if ( itemPosInNode != wxNOT_FOUND )
+            itemNode = parentsChildren[itemPosInNode];
 
         // If the parent wasn't expanded, it's possible that we didn't have a
         // node corresponding to 'item' and so there's nothing left to do.
@@ -3222,12 +3854,25 @@ bool wxDataViewMainWindow::ItemDeleted(const wxDataViewItem& parent,
             return true;
         }
 
-        if ( m_rowHeightCache )
-            m_rowHeightCache->Remove(GetRowByItem(parent) + itemPosInNode);
-
         // Delete the item from wxDataViewTreeNode representation:
         const int itemsDeleted = 1 + itemNode->GetSubTreeCount();
 
+        if ( m_rowHeightCache && parentNode->IsOpen() )
+        {
+            const int parentRow = parentNode == m_root
+                                    ? -1
+                                    : GetRowByItem(parent, Walk_ExpandedOnly);
+            if ( parentNode == m_root || parentRow != -1 )
+            {
+                m_rowHeightCache->DeleteRows
+                                  (
+                                    parentRow + 1 +
+                                        parentNode->GetChildRowOffset(itemPosInNode),
+                                    itemsDeleted
+                                  );
+            }
+        }
+
         parentNode->RemoveChild(itemPosInNode);
         delete itemNode;
         parentNode->ChangeSubTreeCount(-itemsDeleted);
@@ -3287,10 +3932,19 @@ bool wxDataViewMainWindow::ItemDeleted(const wxDataViewItem& parent,
 
 bool wxDataViewMainWindow::DoItemChanged(const wxDataViewItem & item, int view_column)
 {
-    if ( !IsVirtualList() )
+    // Even if only a single value changed, the attributes of the other cells
+    // of this item may depend on it, so forget all of them.
+    InvalidateCellCache(item);
+
+    if ( !IsVirtualList() && m_batchCount )
     {
-        if ( m_rowHeightCache )
-            m_rowHeightCache->Remove(GetRowByItem(item));
+        // Put the item in its sorted position together with all the other
+        // items changed during this batch when it ends.
+        m_batchedChanges.push_back(item);
+    }
+    else if ( !IsVirtualList() )
+    {
+        InsertBatchedItems();
 
         // Move this node to its new correct place after it was updated.
         //
@@ -3302,7 +3956,29 @@ bool wxDataViewMainWindow::DoItemChanged(const wxDataViewItem & item, int view_c
         // change.
         wxDataViewTreeNode* const node = FindNode(item);
         wxCHECK_MSG( node, false, "invalid item" );
+
+        const int oldRow = m_rowHeightCache
+                            ? GetRowByItem(item, Walk_ExpandedOnly)
+                            : -1;
+
         node->PutInSortOrder(this);
+
+        if ( oldRow != -1 )
+        {
+            // The height of the item may have changed and, if it was moved,
+            // the rows between its old and new positions have shifted.
+            const int newRow = GetRowByItem(item, Walk_ExpandedOnly);
+            if ( newRow == oldRow )
+            {
+                m_rowHeightCache->InvalidateLine(oldRow);
+            }
+            else
+            {
+                const unsigned int count = 1 + node->GetSubTreeCount();
+                m_rowHeightCache->DeleteRows(oldRow, count);
+                m_rowHeightCache->InsertRows(newRow, count);
+            }
+        }
     }
 
     wxDataViewColumn* column;
@@ -3318,7 +3994,10 @@ bool wxDataViewMainWindow::DoItemChanged(const wxDataViewItem & item, int view_c
     }
 
     // Update the displayed value(s).
-    RefreshRow(GetRowByItem(item));
+    if ( m_batchCount )
+        m_batchDirty = true;
+    else
+        RefreshRow(GetRowByItem(item));
 
     // Send event
     wxDataViewEvent le(wxEVT_DATAVIEW_ITEM_VALUE_CHANGED, m_owner, column, item);
@@ -3679,24 +4358,20 @@ int wxDataViewMainWindow::GetLineStart( unsigned int row ) const
         return row * m_lineHeight;
 
     int start = 0;
-    if ( m_rowHeightCache->GetLineStart(row, start) )
-        return start;
-
-    unsigned int r;
-    for (r = 0; r < row; r++)
+    while ( !m_rowHeightCache->GetLineStart(row, start) )
     {
-        int height = 0;
-        if ( !m_rowHeightCache->GetLineHeight(r, height) )
+        // Some row before this one is not in the cache yet, get its height
+        // from the renderer.
+        const unsigned int r = m_rowHeightCache->GetFirstUnknownRow();
+        wxDataViewItem item = GetItemByRow(r);
+        if ( !item )
         {
-            // row height not in cache -> get it from the renderer...
-            wxDataViewItem item = GetItemByRow(r);
-            if (!item)
-                break;
-
-            height = QueryAndCacheLineHeight(r, item);
+            // This can only happen if the row is beyond the last one.
+            m_rowHeightCache->GetLineStart(r, start);
+            break;
         }
 
-        start += height;
+        QueryAndCacheLineHeight(r, item);
     }
 
     return start;
@@ -3709,48 +4384,24 @@ int wxDataViewMainWindow::GetLineAt( unsigned int y ) const
         return y / m_lineHeight;
 
     unsigned int row = 0;
-    if ( m_rowHeightCache->GetLineAt(y, row) )
-        return row;
-
-    // OnPaint asks GetLineAt for the very last y position and this is always
-    // below the last item (--> an invalid item). To prevent iterating over all
-    // items, check if y is below the last row.
-    // Because this is done very often (for each repaint) its worth to handle
-    // this special case separately.
-    int height = 0;
-    int start = 0;
-    unsigned int rowCount = GetRowCount();
-    if (rowCount == 0 ||
-        (m_rowHeightCache->GetLineInfo(rowCount - 1, start, height) &&
-         y >= static_cast<unsigned int>(start + height)))
-    {
-        return rowCount;
-    }
-
-    // sum all item heights until y is reached
-    unsigned int yy = 0;
-    for (;;)
+    while ( !m_rowHeightCache->GetLineAt(y, row) )
     {
-        height = 0;
-        if ( !m_rowHeightCache->GetLineHeight(row, height) )
-        {
-            // row height not in cache -> get it from the renderer...
-            wxDataViewItem item = GetItemByRow(row);
-            if ( !item )
-            {
-                wxASSERT(row >= GetRowCount());
-                break;
-            }
+        // Either y is below the rows with known heights or some row above it
+        // is not in the cache yet: get the height of the first such row from
+        // the renderer. Notice that OnPaint asks GetLineAt for the very last y
+        // position and this is always below the last item, so this is done
+        // very often and we must not iterate over all items in this case.
+        const unsigned int r = m_rowHeightCache->GetFirstUnknownRow();
+        if ( r >= GetRowCount() )
+            return GetRowCount();
 
-            height = QueryAndCacheLineHeight(row, item);
-        }
+        wxDataViewItem item = GetItemByRow(r);
+        if ( !item )
+            return GetRowCount();
 
-        yy += height;
-        if (y < yy)
-            break;
-
-        row++;
+        QueryAndCacheLineHeight(r, item);
     }
+
     return row;
 }
 
@@ -3801,58 +4452,6 @@ int wxDataViewMainWindow::QueryAndCacheLineHeight(unsigned int row, wxDataViewIt
 }
 
 
-class RowToTreeNodeJob: public DoJob
-{
-public:
-    // Note that we initialize m_current to -1 because the first node passed to
-    // our operator() will be the root node, which doesn't appear in the window
-    // and so doesn't count as a real row.
-    explicit RowToTreeNodeJob(int row)
-        : m_row(row), m_current(-1), m_ret(NULL)
-    {
-    }
-
-    virtual int operator() ( wxDataViewTreeNode * node ) wxOVERRIDE
-    {
-        if( m_current == m_row)
-        {
-            m_ret = node;
-            return DoJob::DONE;
-        }
-
-        if( node->GetSubTreeCount() + m_current < m_row )
-        {
-            m_current += node->GetSubTreeCount() + 1;
-            return  DoJob::SKIP_SUBTREE;
-        }
-        else
-        {
-            // If the current node has only leaf children, we can find the
-            // desired node directly. This can speed up finding the node
-            // in some cases, and will have a very good effect for list views.
-            if ( node->HasChildren() &&
-                 (int)node->GetChildNodes().size() == node->GetSubTreeCount() )
-            {
-                const int index = m_row - m_current - 1;
-                m_ret = node->GetChildNodes()[index];
-                return DoJob::DONE;
-            }
-
-            m_current++;
-
-            return DoJob::CONTINUE;
-        }
-    }
-
-    wxDataViewTreeNode * GetResult() const
-        { return m_ret; }
-
-private:
-    const int m_row;
-    int m_current;
-    wxDataViewTreeNode* m_ret;
-};
-
 wxDataViewTreeNode * wxDataViewMainWindow::GetTreeNodeByRow(unsigned int row) const
 {
     wxASSERT( !IsVirtualList() );
@@ -3860,9 +4459,21 @@ wxDataViewTreeNode * wxDataViewMainWindow::GetTreeNodeByRow(unsigned int row) co
     if ( row == (unsigned)-1 )
         return NULL;
 
-    RowToTreeNodeJob job(static_cast<int>(row));
-    Walker( m_root , job );
-    return job.GetResult();
+    // Descend into the subtree containing the row at each level, the row
+    // being relative to the first child of the current node.
+    wxDataViewTreeNode* node = m_root;
+    int rowInNode = static_cast<int>(row);
+    for ( ;; )
+    {
+        if ( rowInNode >= node->GetSubTreeCount() )
+            return NULL;
+
+        node = node->GetChildByRow(rowInNode);
+        if ( !rowInNode )
+            return node;
+
+        rowInNode--;
+    }
 }
 
 wxDataViewItem wxDataViewMainWindow::GetItemByRow(unsigned int row) const
@@ -3954,13 +4565,6 @@ wxDataViewMainWindow::DoExpand(wxDataViewTreeNode* node,
             return;
         }
 
-        if ( m_rowHeightCache )
-        {
-            // Expand makes new rows visible thus we invalidates all following
-            // rows in the height cache
-            m_rowHeightCache->Remove(row);
-        }
-
         node->ToggleOpen(this);
 
         // build the children of current node
@@ -3971,6 +4575,10 @@ wxDataViewMainWindow::DoExpand(wxDataViewTreeNode* node,
 
         const unsigned countNewRows = node->GetSubTreeCount();
 
+        // Expand makes new rows visible, their heights are not known yet.
+        if ( m_rowHeightCache )
+            m_rowHeightCache->InsertRows(row + 1, countNewRows);
+
         // Shift all stored indices after this row by the number of newly added
         // rows.
         m_selection.OnItemsInserted(row + 1, countNewRows);
@@ -4024,13 +4632,6 @@ void wxDataViewMainWindow::Collapse(unsigned int row)
     if (!node->HasChildren())
         return;
 
-    if ( m_rowHeightCache )
-    {
-        // Collapse hides rows thus we invalidates all following
-        // rows in the height cache
-        m_rowHeightCache->Remove(row);
-    }
-
     if (node->IsOpen())
     {
         if ( !SendExpanderEvent(wxEVT_DATAVIEW_ITEM_COLLAPSING,node->GetItem()) )
@@ -4041,6 +4642,10 @@ void wxDataViewMainWindow::Collapse(unsigned int row)
 
         const unsigned countDeletedRows = node->GetSubTreeCount();
 
+        // Collapse hides rows, so forget their heights.
+        if ( m_rowHeightCache )
+            m_rowHeightCache->DeleteRows(row + 1, countDeletedRows);
+
         if ( m_selection.OnItemsDeleted(row + 1, countDeletedRows) )
         {
             SendSelectionChangedEvent(GetItemByRow(row));
@@ -4102,24 +4707,15 @@ wxDataViewTreeNode * wxDataViewMainWindow::FindNode( const wxDataViewItem & item
                 ::BuildTreeHelper(this, model, node->GetItem(), node);
             }
 
-            const wxDataViewTreeNodes& nodes = node->GetChildNodes();
-            bool found = false;
+            const int pos = node->FindChildByItem(parentChain[iter]);
+            if ( pos == wxNOT_FOUND )
+                return NULL;
 
-            for (unsigned i = 0; i < nodes.size(); ++i)
-            {
-                wxDataViewTreeNode* currentNode = nodes[i];
-                if (currentNode->GetItem() == parentChain[iter])
-                {
-                    if (currentNode->GetItem() == item)
-                        return currentNode;
+            wxDataViewTreeNode* currentNode = node->GetChildNodes()[pos];
+            if (currentNode->GetItem() == item)
+                return currentNode;
 
-                    node = currentNode;
-                    found = true;
-                    break;
-                }
-            }
-            if (!found)
-                return NULL;
+            node = currentNode;
         }
         else
             return NULL;
@@ -4245,55 +4841,6 @@ int wxDataViewMainWindow::RecalculateCount() const
     }
 }
 
-class ItemToRowJob : public DoJob
-{
-public:
-    // As with RowToTreeNodeJob above, we initialize m_current to -1 because
-    // the first node passed to our operator() is the root node which is not
-    // visible on screen and so we should return 0 for its first child node and
-    // not for the root itself.
-    ItemToRowJob(const wxDataViewItem& item, wxVector<wxDataViewItem>::reverse_iterator iter)
-        : m_item(item), m_iter(iter), m_current(-1)
-    {
-    }
-
-    // Maybe binary search will help to speed up this process
-    virtual int operator() ( wxDataViewTreeNode * node) wxOVERRIDE
-    {
-        if( node->GetItem() == m_item )
-        {
-            return DoJob::DONE;
-        }
-
-        // Is this node the next (grand)parent of the item we're looking for?
-        if( node->GetItem() == *m_iter )
-        {
-            // Search for the next (grand)parent now and skip this item itself.
-            ++m_iter;
-            ++m_current;
-            return DoJob::CONTINUE;
-        }
-        else
-        {
-            // Skip this node and all its currently visible children.
-            m_current += node->GetSubTreeCount() + 1;
-            return DoJob::SKIP_SUBTREE;
-        }
-
-    }
-
-    int GetResult() const
-        { return m_current; }
-
-private:
-    const wxDataViewItem m_item;
-    wxVector<wxDataViewItem>::reverse_iterator m_iter;
-
-    // The row corresponding to the last node seen in our operator().
-    int m_current;
-
-};
-
 int
 wxDataViewMainWindow::GetRowByItem(const wxDataViewItem & item,
                                    WalkFlags flags) const
@@ -4320,16 +4867,29 @@ wxDataViewMainWindow::GetRowByItem(const wxDataViewItem & item,
             it = model->GetParent(it);
         }
 
-        // add an 'invalid' item to represent our 'invisible' root node
-        parentChain.push_back(wxDataViewItem());
-
         // the parent chain was created by adding the deepest parent first.
         // so if we want to start at the root node, we have to iterate backwards through the vector
-        ItemToRowJob job( item, parentChain.rbegin() );
-        if ( !Walker( m_root, job, flags ) )
-            return -1;
+        //
+        // Notice that we start at -1 because the root node itself doesn't
+        // appear in the window.
+        int row = -1;
+        const wxDataViewTreeNode* node = m_root;
+        for ( wxVector<wxDataViewItem>::reverse_iterator it = parentChain.rbegin();
+              it != parentChain.rend();
+              ++it )
+        {
+            if ( flags == Walk_ExpandedOnly && !node->IsOpen() )
+                return -1;
+
+            const int pos = node->FindChildByItem(*it);
+            if ( pos == wxNOT_FOUND )
+                return -1;
+
+            row += 1 + node->GetChildRowOffset(pos);
+            node = node->GetChildNodes()[pos];
+        }
 
-        return job.GetResult();
+        return row;
     }
 }
 
@@ -4342,6 +4902,8 @@ static void BuildTreeHelper( wxDataViewMainWindow *window, const wxDataViewModel
     wxDataViewItemArray children;
     unsigned int num = model->GetChildren( item, children);
 
+    wxDataViewTreeNodes nodes;
+    nodes.reserve(num);
     for ( unsigned int index = 0; index < num; index++ )
     {
         wxDataViewTreeNode *n = new wxDataViewTreeNode(node, children[index]);
@@ -4349,9 +4911,11 @@ static void BuildTreeHelper( wxDataViewMainWindow *window, const wxDataViewModel
         if( model->IsContainer(children[index]) )
             n->SetHasChildren( true );
 
-        node->InsertChild(window, n, index);
+        nodes.push_back(n);
     }
 
+    node->AppendChildren(window, nodes);
+
     if ( node->IsOpen() )
         node->ChangeSubTreeCount(+num);
 }
@@ -4376,6 +4940,13 @@ void wxDataViewMainWindow::BuildTree(wxDataViewModel * model)
 
 void wxDataViewMainWindow::DestroyTree()
 {
+    // The items added or changed during the current batch, if any, will be
+    // taken into account when the tree is rebuilt.
+    m_batchedItems.clear();
+    m_batchedChanges.clear();
+
+    ClearCellCache();
+
     if (!IsVirtualList())
     {
         wxDELETE(m_root);
@@ -4383,6 +4954,334 @@ void wxDataViewMainWindow::DestroyTree()
     }
 }
 
+void wxDataViewMainWindow::EndBatch()
+{
+    wxCHECK_RET( m_batchCount > 0, "EndBatch() without matching BeginBatch()" );
+
+    if ( --m_batchCount )
+        return;
+
+    InsertBatchedItems();
+    ApplyBatchedChanges();
+
+    if ( m_batchDirty )
+    {
+        m_batchDirty = false;
+
+        UpdateDisplay();
+        Refresh();
+    }
+}
+
+void wxDataViewMainWindow::CancelBatch()
+{
+    m_batchCount = 0;
+    m_batchDirty = false;
+    m_batchedItems.clear();
+    m_batchedChanges.clear();
+
+    UpdateDisplay();
+    Refresh();
+}
+
+void wxDataViewMainWindow::ApplyBatchedChanges()
+{
+    if ( m_batchedChanges.empty() )
+        return;
+
+    if ( !GetSortOrder().IsNone() )
+    {
+        wxDataViewTreeNodePositions changed;
+        for ( wxVector<wxDataViewItem>::const_iterator i = m_batchedChanges.begin();
+              i != m_batchedChanges.end();
+              ++i )
+        {
+            changed[i->GetID()] = 0;
+        }
+
+        // Walk the tree once instead of looking up every item in it, which
+        // also skips the items deleted after being changed.
+        wxVector<wxDataViewTreeNode*> nodes,
+                                      found;
+        nodes.push_back(m_root);
+        while ( !nodes.empty() )
+        {
+            wxDataViewTreeNode* const node = nodes.back();
+            nodes.pop_back();
+
+            if ( node != m_root &&
+                    changed.find(node->GetItem().GetID()) != changed.end() )
+                found.push_back(node);
+
+            if ( node->HasChildren() )
+            {
+                const wxDataViewTreeNodes& children = node->GetChildNodes();
+                for ( wxDataViewTreeNodes::const_iterator i = children.begin();
+                      i != children.end();
+                      ++i )
+                {
+                    nodes.push_back(*i);
+                }
+            }
+        }
+
+        for ( size_t n = 0; n < found.size(); n++ )
+            found[n]->PutInSortOrder(this);
+    }
+
+    m_batchedChanges.clear();
+
+    // Finding the old and new rows of every changed item would take time
+    // proportional to the number of rows for each of them, so just forget
+    // all the heights at once.
+    if ( m_rowHeightCache )
+        m_rowHeightCache->Clear();
+}
+
+void wxDataViewMainWindow::InsertBatchedItems()
+{
+    if ( m_batchedItems.empty() )
+        return;
+
+    wxVector<BatchedItem> batchedItems;
+    batchedItems.swap(m_batchedItems);
+
+    const wxDataViewModel* const model = GetModel();
+
+    // Group the items by their parents, keeping the parents in the order in
+    // which they were first used, as a parent may be itself added before its
+    // children.
+    wxDataViewTreeNodePositions parentsIndex;
+    wxVector<wxDataViewItem> parents;
+    wxVector<wxDataViewItemArray> children;
+    for ( wxVector<BatchedItem>::const_iterator i = batchedItems.begin();
+          i != batchedItems.end();
+          ++i )
+    {
+        wxDataViewTreeNodePositions::const_iterator it = parentsIndex.find(i->parent.GetID());
+        int n;
+        if ( it == parentsIndex.end() )
+        {
+            n = parents.size();
+            parentsIndex[i->parent.GetID()] = n;
+            parents.push_back(i->parent);
+            children.push_back(wxDataViewItemArray());
+        }
+        else
+        {
+            n = it->second;
+        }
+
+        children[n].push_back(i->item);
+    }
+
+    wxDataViewItemArray inserted;
+    inserted.reserve(batchedItems.size());
+
+    const bool sorted = !GetSortOrder().IsNone();
+    for ( size_t n = 0; n < parents.size(); n++ )
+    {
+        wxDataViewTreeNode* const parentNode = FindNode(parents[n]);
+        if ( !parentNode )
+            continue;
+
+        parentNode->SetHasChildren(true);
+
+        const wxDataViewItemArray& items = children[n];
+        wxDataViewTreeNodes nodes;
+        nodes.reserve(items.size());
+        for ( size_t i = 0; i < items.size(); i++ )
+        {
+            // The item may be already present if the parent node children
+            // were created from the model after it had been added to it.
+            if ( parentNode->FindChildByItem(items[i]) != wxNOT_FOUND )
+                continue;
+
+            wxDataViewTreeNode* const node = new wxDataViewTreeNode(parentNode, items[i]);
+            node->SetHasChildren(model->IsContainer(items[i]));
+            nodes.push_back(node);
+            inserted.push_back(items[i]);
+        }
+
+        if ( nodes.empty() )
+            continue;
+
+        parentNode->ChangeSubTreeCount(static_cast<int>(nodes.size()));
+
+        if ( sorted )
+        {
+            for ( size_t i = 0; i < nodes.size(); i++ )
+                parentNode->InsertChild(this, nodes[i], 0);
+        }
+        else
+        {
+            InsertChildrenInModelOrder(parentNode, nodes);
+        }
+    }
+
+    InvalidateCount();
+
+    // Shift the selection and the row heights for all the new rows at once:
+    // doing it in the increasing order of the rows is equivalent to inserting
+    // them one by one.
+    wxVector<int> rows;
+    rows.reserve(inserted.size());
+    for ( size_t n = 0; n < inserted.size(); n++ )
+    {
+        const int row = GetRowByItem(inserted[n], Walk_ExpandedOnly);
+        if ( row != -1 )
+            rows.push_back(row);
+    }
+
+    std::sort(rows.begin(), rows.end());
+    for ( wxVector<int>::const_iterator i = rows.begin(); i != rows.end(); ++i )
+    {
+        m_selection.OnItemsInserted(*i, 1);
+        if ( m_rowHeightCache )
+            m_rowHeightCache->InsertRows(*i, 1);
+    }
+
+    GetOwner()->InvalidateColBestWidths();
+    UpdateDisplay();
+
+    m_batchDirty = true;
+}
+
+void
+wxDataViewMainWindow::ForgetBatchedItems(const wxDataViewItem& parent,
+                                         const wxDataViewItem& item)
+{
+    // Collect all the items which don't exist in the model any more, starting
+    // with the item itself and its descendants already in the tree.
+    wxDataViewTreeNodePositions deleted;
+    deleted[item.GetID()] = 0;
+
+    wxVector<const wxDataViewTreeNode*> nodes;
+    const wxDataViewTreeNode* const parentNode = FindNode(parent);
+    if ( parentNode )
+    {
+        const int pos = parentNode->FindChildByItem(item);
+        if ( pos != wxNOT_FOUND )
+            nodes.push_back(parentNode->GetChildNodes()[pos]);
+    }
+
+    while ( !nodes.empty() )
+    {
+        const wxDataViewTreeNode* const node = nodes.back();
+        nodes.pop_back();
+
+        deleted[node->GetItem().GetID()] = 0;
+
+        if ( node->HasChildren() )
+        {
+            const wxDataViewTreeNodes& children = node->GetChildNodes();
+            for ( wxDataViewTreeNodes::const_iterator i = children.begin();
+                  i != children.end();
+                  ++i )
+            {
+                nodes.push_back(*i);
+            }
+        }
+    }
+
+    // Items are always added after their parents, so a single pass is enough
+    // to also find the items added to the ones added during the batch.
+    wxVector<BatchedItem> batchedItems;
+    batchedItems.reserve(m_batchedItems.size());
+    for ( wxVector<BatchedItem>::const_iterator i = m_batchedItems.begin();
+          i != m_batchedItems.end();
+          ++i )
+    {
+        if ( deleted.find(i->item.GetID()) != deleted.end() ||
+                deleted.find(i->parent.GetID()) != deleted.end() )
+        {
+            deleted[i->item.GetID()] = 0;
+            continue;
+        }
+
+        batchedItems.push_back(*i);
+    }
+
+    m_batchedItems.swap(batchedItems);
+}
+
+void
+wxDataViewMainWindow::InsertChildrenInModelOrder(wxDataViewTreeNode* parentNode,
+                                                 const wxDataViewTreeNodes& nodes)
+{
+    wxDataViewItemArray modelSiblings;
+    GetModel()->GetChildren(parentNode->GetItem(), modelSiblings);
+
+    wxDataViewTreeNodePositions newNodes;
+    for ( size_t n = 0; n < nodes.size(); n++ )
+        newNodes[nodes[n]->GetItem().GetID()] = n;
+
+    // As in ItemAdded(), insert each new node before the node of the first
+    // following sibling in the model which already has one. Iterate over the
+    // model items backwards to find all these positions in a single pass.
+    // Each new node is represented by its position among the existing nodes
+    // and its index in the model, used to sort the new nodes inserted at the
+    // same position.
+    const wxDataViewTreeNodes& oldNodes = parentNode->GetChildNodes();
+    const int oldCount = oldNodes.size();
+
+    wxVector< std::pair<int, int> > positions;
+    positions.reserve(nodes.size());
+
+    wxVector<bool> found(nodes.size(), false);
+
+    int nextPos = oldCount;
+    for ( int n = modelSiblings.size() - 1; n >= 0; n-- )
+    {
+        const wxDataViewItem& sibling = modelSiblings[n];
+
+        wxDataViewTreeNodePositions::const_iterator it = newNodes.find(sibling.GetID());
+        if ( it != newNodes.end() )
+        {
+            positions.push_back(std::make_pair(nextPos, n));
+            found[it->second] = true;
+        }
+        else
+        {
+            const int pos = parentNode->FindChildByItem(sibling);
+            if ( pos != wxNOT_FOUND )
+                nextPos = pos;
+        }
+    }
+
+    // Any remaining nodes don't exist in the model.
+    if ( positions.size() != nodes.size() )
+    {
+        wxFAIL_MSG( "adding non-existent item?" );
+
+        for ( size_t n = 0; n < nodes.size(); n++ )
+        {
+            if ( !found[n] )
+                delete nodes[n];
+        }
+
+        parentNode->ChangeSubTreeCount(static_cast<int>(positions.size()) -
+                                       static_cast<int>(nodes.size()));
+    }
+
+    std::sort(positions.begin(), positions.end());
+
+    wxDataViewTreeNodes children;
+    children.reserve(oldCount + positions.size());
+
+    wxVector< std::pair<int, int> >::const_iterator it = positions.begin();
+    for ( int pos = 0; pos <= oldCount; pos++ )
+    {
+        for ( ; it != positions.end() && it->first == pos; ++it )
+            children.push_back(nodes[newNodes[modelSiblings[it->second].GetID()]]);
+
+        if ( pos < oldCount )
+            children.push_back(oldNodes[pos]);
+    }
+
+    parentNode->SetChildNodes(children);
+}
+
 wxDataViewColumn*
 wxDataViewMainWindow::FindColumnForEditing(const wxDataViewItem& item, wxDataViewCellMode mode) const
 {
@@ -5423,6 +6322,9 @@ void wxDataViewMainWindow::OnColumnsCountChanged()
 
     m_useCellFocus = (editableCount > 0);
 
+    // The new columns may use different renderers for the same model columns.
+    ClearCellCache();
+
     UpdateDisplay();
 }
 
@@ -5589,6 +6491,16 @@ wxBorder wxDataViewCtrl::GetDefaultBorder() const
     return wxBORDER_THEME;
 }
 
+void wxDataViewCtrl::Refresh(bool eraseBackground, const wxRect *rect)
+{
+    // The application may refresh the control after changing the model data
+    // without notifying it, so don't show the cached values any more.
+    if ( m_clientArea )
+        m_clientArea->ClearCellCache();
+
+    wxDataViewCtrlBase::Refresh(eraseBackground, rect);
+}
+
 wxHeaderCtrl* wxDataViewCtrl::GenericGetHeader() const
 {
     return m_headerArea;
@@ -1719,6 +1719,14 @@ wxCairoBitmapData::wxCairoBitmapData( wxGraphicsRenderer* renderer, const wxBitm
 
 #if wxUSE_IMAGE
 
+// Key used for associating wxImageRGBAData with the surfaces using it.
+static cairo_user_data_key_t gs_imageRGBADataKey;
+
+static void DeleteImageRGBAData(void* data)
+{
+    delete static_cast<wxImageRGBAData*>(data);
+}
+
 wxCairoBitmapData::wxCairoBitmapData(wxGraphicsRenderer* renderer,
                                      const wxImage& image)
     : wxGraphicsBitmapData(renderer)
@@ -1727,6 +1735,38 @@ wxCairoBitmapData::wxCairoBitmapData(wxGraphicsRenderer* renderer,
                                             ? CAIRO_FORMAT_ARGB32
                                             : CAIRO_FORMAT_RGB24;
 
+    if ( !image.HasMask() )
+    {
+        // The premultiplied interleaved representation of the image has
+        // exactly the layout of Cairo surface (the alpha byte is just ignored
+        // for RGB24 surfaces), so use it directly instead of copying it. This
+        // also means that drawing the same image repeatedly doesn't need to
+        // convert it every time.
+        wxImageRGBAData* const rgba =
+            new wxImageRGBAData(image.GetRGBAData(wxIMAGE_RGBA_PREMULTIPLIED));
+
+        m_width = rgba->GetWidth();
+        m_height = rgba->GetHeight();
+        m_buffer = NULL;
+        m_surface = cairo_image_surface_create_for_data(
+                            const_cast<unsigned char*>(rgba->GetData()),
+                            bufferFormat, m_width, m_height, 4*m_width);
+
+        // Keep the data alive for as long as the surface uses it.
+        if ( cairo_surface_set_user_data(m_surface, &gs_imageRGBADataKey,
+                                         rgba, DeleteImageRGBAData)
+                == CAIRO_STATUS_SUCCESS )
+        {
+            m_pattern = cairo_pattern_create_for_surface(m_surface);
+            return;
+        }
+
+        // This can only fail if we ran out of memory, but still handle it by
+        // falling back to the code below.
+        cairo_surface_destroy(m_surface);
+        delete rgba;
+    }
+
     int stride = InitBuffer(image.GetWidth(), image.GetHeight(), bufferFormat);
 
     // Copy wxImage data into the buffer. Notice that we work with wxUint32
@@ -761,48 +761,101 @@ wxGridCellEditor* wxGridCellAttr::GetEditor(const wxGrid* grid, int row, int col
 // wxGridCellAttrData
 // ----------------------------------------------------------------------------
 
-namespace
+wxGridCellAttrData::~wxGridCellAttrData()
 {
+    for ( size_t n = 0; n < m_rows.size(); n++ )
+    {
+        const CellAttrs& cells = *m_rows[n].cells;
+        for ( size_t m = 0; m < cells.size(); m++ )
+        {
+            cells[m].attr->DecRef();
+        }
 
-// Helper functions to convert grid coords to a key for the attr map, and
-// vice versa.
-
-wxGridCoordsToAttrMap::key_type CoordsToKey(int row, int col)
-{
-    // Treat both row and col as unsigned to not cause havoc with (unsupported)
-    // negative coords.
-    return (static_cast<wxULongLong_t>(row) << 32) + static_cast<wxUint32>(col);
+        delete m_rows[n].cells;
+    }
 }
 
-void KeyToCoords(wxGridCoordsToAttrMap::key_type key, int *pRow, int *pCol)
+size_t wxGridCellAttrData::FindRow(int row) const
 {
-    *pRow = key >> 32;
-    *pCol = key & wxUINT32_MAX;
-}
+    size_t lo = 0,
+           hi = m_rows.size();
+    while ( lo < hi )
+    {
+        const size_t mid = lo + (hi - lo) / 2;
+        if ( m_rows[mid].row < row )
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
 
-} // anonymous namespace
+    return lo;
+}
 
-wxGridCellAttrData::~wxGridCellAttrData()
+/* static */
+size_t wxGridCellAttrData::FindCol(const CellAttrs& cells, int col)
 {
-    for ( wxGridCoordsToAttrMap::iterator it = m_attrs.begin();
-          it != m_attrs.end();
-          ++it )
+    size_t lo = 0,
+           hi = cells.size();
+    while ( lo < hi )
     {
-        it->second->DecRef();
+        const size_t mid = lo + (hi - lo) / 2;
+        if ( cells[mid].col < col )
+            lo = mid + 1;
+        else
+            hi = mid;
     }
 
-    m_attrs.clear();
+    return lo;
+}
+
+wxGridCellAttr **wxGridCellAttrData::FindAttr(int row, int col) const
+{
+    const size_t n = FindRow(row);
+    if ( n == m_rows.size() || m_rows[n].row != row )
+        return NULL;
+
+    CellAttrs& cells = *m_rows[n].cells;
+    const size_t m = FindCol(cells, col);
+    if ( m == cells.size() || cells[m].col != col )
+        return NULL;
+
+    return &cells[m].attr;
+}
+
+void wxGridCellAttrData::DeleteRow(size_t n)
+{
+    delete m_rows[n].cells;
+    m_rows.erase(m_rows.begin() + n);
 }
 
 void wxGridCellAttrData::SetAttr(wxGridCellAttr *attr, int row, int col)
 {
-    wxGridCoordsToAttrMap::iterator it = FindIndex(row, col);
-    if ( it == m_attrs.end() )
+    const size_t n = FindRow(row);
+    if ( n == m_rows.size() || m_rows[n].row != row )
+    {
+        if ( attr )
+        {
+            // add the first attribute of this row
+            RowAttrs rowAttrs;
+            rowAttrs.row = row;
+            rowAttrs.cells = new CellAttrs;
+            rowAttrs.cells->push_back(CellAttr(col, attr));
+
+            m_rows.insert(m_rows.begin() + n, rowAttrs);
+        }
+        //else: nothing to do
+
+        return;
+    }
+
+    CellAttrs& cells = *m_rows[n].cells;
+    const size_t m = FindCol(cells, col);
+    if ( m == cells.size() || cells[m].col != col )
     {
         if ( attr )
         {
             // add the attribute
-            m_attrs[CoordsToKey(row, col)] = attr;
+            cells.insert(cells.begin() + m, CellAttr(col, attr));
         }
         //else: nothing to do
     }
@@ -810,13 +863,19 @@ void wxGridCellAttrData::SetAttr(wxGridCellAttr *attr, int row, int col)
     {
         // See note near DecRef() in wxGridRowOrColAttrData::SetAttr for why
         // this also works when old and new attribute are the same.
-        it->second->DecRef();
+        cells[m].attr->DecRef();
 
         // Change or remove the attribute.
         if ( attr )
-            it->second = attr;
+        {
+            cells[m].attr = attr;
+        }
         else
-            m_attrs.erase(it);
+        {
+            cells.erase(cells.begin() + m);
+            if ( cells.empty() )
+                DeleteRow(n);
+        }
     }
 }
 
@@ -824,215 +883,345 @@ wxGridCellAttr *wxGridCellAttrData::GetAttr(int row, int col) const
 {
     wxGridCellAttr *attr = NULL;
 
-    wxGridCoordsToAttrMap::iterator it = FindIndex(row, col);
-    if ( it != m_attrs.end() )
+    wxGridCellAttr ** const pAttr = FindAttr(row, col);
+    if ( pAttr )
     {
-        attr = it->second;
+        attr = *pAttr;
         attr->IncRef();
     }
 
     return attr;
 }
 
-namespace
-{
-
-void UpdateCellAttrRowsOrCols(wxGridCoordsToAttrMap& attrs, int editPos,
-                              int editRowCount, int editColCount)
+/* static */
+bool wxGridCellAttrData::UpdateCellAttr(int& cellRow, int& cellCol,
+                                        wxGridCellAttr *cellAttr,
+                                        int editPos,
+                                        int editRowCount,
+                                        int editColCount,
+                                        NewCellAttrs& newAttrs)
 {
     wxASSERT( !editRowCount || !editColCount );
 
     const bool isEditingRows = (editRowCount != 0);
     const int editCount = (isEditingRows ? editRowCount : editColCount);
 
-    // Copy updated attributes to a new map instead of attempting to edit attrs
-    // map in-place. This requires more memory but greatly simplifies the code
-    // and any attempt with in-place editing would likely also require a lot
-    // more attr lookups.
-    // The updated copy will contain an attrs map with, if applicable: adjusted
-    // coords and cell size, newly inserted attributes (for multicells), and
-    // without now deleted attributes.
-    wxGridCoordsToAttrMap newAttrs;
-
-    for ( wxGridCoordsToAttrMap::iterator it = attrs.begin();
-          it != attrs.end();
-          ++it )
-    {
-        const wxGridCoordsToAttrMap::key_type oldCoords = it->first;
-        wxGridCellAttr* cellAttr = it->second;
-
-        int cellRows, cellCols;
-        cellAttr->GetSize(&cellRows, &cellCols);
-
-        int cellRow, cellCol;
-        KeyToCoords(oldCoords, &cellRow, &cellCol);
+    int cellRows, cellCols;
+    cellAttr->GetSize(&cellRows, &cellCols);
 
-        const int cellPos = isEditingRows ? cellRow : cellCol;
+    const int cellPos = isEditingRows ? cellRow : cellCol;
 
-        if ( cellPos < editPos )
+    if ( cellPos < editPos )
+    {
+        // This cell's coords aren't influenced by the editing, however
+        // do adjust a multicell's main size, if needed.
+        if ( GetCellSpan(cellRows, cellCols) == wxGrid::CellSpan_Main )
         {
-            // This cell's coords aren't influenced by the editing, however
-            // do adjust a multicell's main size, if needed.
-            if ( GetCellSpan(cellRows, cellCols) == wxGrid::CellSpan_Main )
+            int mainSize = isEditingRows ? cellRows : cellCols;
+            if ( cellPos + mainSize > editPos )
             {
-                int mainSize = isEditingRows ? cellRows : cellCols;
-                if ( cellPos + mainSize > editPos )
-                {
-                    // Multicell is within affected range:
-                    // Adjust its size.
-
-                    if ( editCount >= 0 )
-                    {
-                        mainSize += editCount;
-                    }
-                    else
-                    {
-                        // Reduce multicell size by number of deletions, but
-                        // never more than the multicell's size minus one:
-                        // cellPos (the main cell) is always less than editPos
-                        // at this point, then with the below code a multicell
-                        // with size 7 is at most reduced by:
-                        // cellPos + 7 - (cellPos + 1) = 7 - 1 = 6.
-                        mainSize -= wxMin(-editCount,
-                                          cellPos + mainSize - editPos);
-                        /*
-                        The above was derived from:
-                        first_del = edit
-                        last_del = min(edit - count - 1, cell + size - 1)
-                        size -= (last_del + 1 - first_del)
-
-                        eliminating the 1's:
-
-                        first_del = edit
-                        last_del = min(edit - count, cell + size)
-                        size -= (last_del - first_del)
-
-                        reducing each by edit:
-
-                        first_del = 0
-                        last_del_plus_1 = min(0 - count, cell + size - edit)
-                        size -= (last_del_plus_1 - 0)
-
-                        after eliminating the 0's and substitution, leaving:
-
-                        size -= min(-count, cell + size - edit)
-
-                        E.g. with a multicell of size 7 and at 2 positions
-                        after the main cell 100 positions are deleted then
-                        the size will not (/can't) be reduced by 100 cells
-                        but by:
-
-                        cellPos + 7 - editPos =       # editPos = cellPos + 2
-                        cellPos + 7 - (cellPos + 2) = # eliminate cellPos
-                        7 - 2 =
-                        5 cells, making the final size 7 - 5 = 2.
-                        */
-                    }
+                // Multicell is within affected range:
+                // Adjust its size.
 
-                    cellAttr->SetSize(isEditingRows ? mainSize : cellRows,
-                                      isEditingRows ? cellCols : mainSize);
+                if ( editCount >= 0 )
+                {
+                    mainSize += editCount;
+                }
+                else
+                {
+                    // Reduce multicell size by number of deletions, but
+                    // never more than the multicell's size minus one:
+                    // cellPos (the main cell) is always less than editPos
+                    // at this point, then with the below code a multicell
+                    // with size 7 is at most reduced by:
+                    // cellPos + 7 - (cellPos + 1) = 7 - 1 = 6.
+                    mainSize -= wxMin(-editCount,
+                                      cellPos + mainSize - editPos);
+                    /*
+                    The above was derived from:
+                    first_del = edit
+                    last_del = min(edit - count - 1, cell + size - 1)
+                    size -= (last_del + 1 - first_del)
+
+                    eliminating the 1's:
+
+                    first_del = edit
+                    last_del = min(edit - count, cell + size)
+                    size -= (last_del - first_del)
+
+                    reducing each by edit:
+
+                    first_del = 0
+                    last_del_plus_1 = min(0 - count, cell + size - edit)
+                    size -= (last_del_plus_1 - 0)
+
+                    after eliminating the 0's and substitution, leaving:
+
+                    size -= min(-count, cell + size - edit)
+
+                    E.g. with a multicell of size 7 and at 2 positions
+                    after the main cell 100 positions are deleted then
+                    the size will not (/can't) be reduced by 100 cells
+                    but by:
+
+                    cellPos + 7 - editPos =       # editPos = cellPos + 2
+                    cellPos + 7 - (cellPos + 2) = # eliminate cellPos
+                    7 - 2 =
+                    5 cells, making the final size 7 - 5 = 2.
+                    */
                 }
+
+                cellAttr->SetSize(isEditingRows ? mainSize : cellRows,
+                                  isEditingRows ? cellCols : mainSize);
             }
+        }
+
+        // Keep the attribute at old/unmodified coords.
+        return true;
+    }
 
-            // Set attribute at old/unmodified coords.
-            newAttrs[oldCoords] = cellAttr;
+    if ( editCount < 0 && cellPos < editPos - editCount )
+    {
+        // This row/col is deleted and the cell doesn't exist any longer:
+        // Remove the attribute.
+        cellAttr->DecRef();
 
-            continue;
-        }
+        return false;
+    }
 
-        if ( editCount < 0 && cellPos < editPos - editCount )
-        {
-            // This row/col is deleted and the cell doesn't exist any longer:
-            // Remove the attribute.
-            cellAttr->DecRef();
+    // Rows/cols inserted or deleted (and this cell still exists):
+    // Adjust cell coords.
+    const int oldRow = cellRow,
+              oldCol = cellCol;
+    cellRow += editRowCount;
+    cellCol += editColCount;
 
-            continue;
-        }
+    if ( GetCellSpan(cellRows, cellCols) != wxGrid::CellSpan_Inside )
+    {
+        // Nothing more to do: cell is not an inside cell of a multicell.
+        return true;
+    }
+
+    // Handle inside cell's existence, coords, and size.
+
+    const int mainPos = cellPos + (isEditingRows ? cellRows : cellCols);
+
+    if ( editCount < 0
+         && mainPos >= editPos && mainPos < editPos - editCount )
+    {
+        // On a position that still exists after deletion but main cell
+        // of multicell is within deletion range so the multicell is gone:
+        // Remove the attribute.
+        cellAttr->DecRef();
 
-        const wxGridCoordsToAttrMap::key_type newCoords
-            = CoordsToKey(cellRow + editRowCount, cellCol + editColCount);
+        return false;
+    }
+
+    if ( mainPos >= editPos )
+    {
+        // Nothing more to do: the multicell that this inside cell is part
+        // of is moving its main cell as well so offsets to the main cell
+        // don't change and there are no edits changing the multicell size.
+        return true;
+    }
 
-        if ( GetCellSpan(cellRows, cellCols) != wxGrid::CellSpan_Inside )
+    if ( editCount > 0 && cellPos == editPos )
+    {
+        // At an (old) position that is newly inserted: this is the only
+        // opportunity to add required inside cells that point to
+        // the main cell. E.g. with a 2x1 multicell that increases in size
+        // there's only one inside cell that will be visited while there
+        // can be multiple insertions.
+        for ( int i = 0; i < editCount; ++i )
         {
-            // Rows/cols inserted or deleted (and this cell still exists):
-            // Adjust cell coords.
-            newAttrs[newCoords] = cellAttr;
+            const int adjustRows = i * isEditingRows,
+                      adjustCols = i * !isEditingRows;
 
-            // Nothing more to do: cell is not an inside cell of a multicell.
-            continue;
+            NewCellAttr newAttr;
+            newAttr.row = oldRow + adjustRows;
+            newAttr.col = oldCol + adjustCols;
+            newAttr.attr = new wxGridCellAttr;
+            newAttr.attr->SetSize(cellRows - adjustRows, cellCols - adjustCols);
+            newAttrs.push_back(newAttr);
         }
+    }
+
+    // Let this inside cell's size point to the main cell of the multicell.
+    cellAttr->SetSize(cellRows - editRowCount, cellCols - editColCount);
 
-        // Handle inside cell's existence, coords, and size.
+    return true;
+}
 
-        const int mainPos = cellPos + (isEditingRows ? cellRows : cellCols);
+/* static */
+bool wxGridCellAttrData::UpdateRowAttrs(RowAttrs& rowAttrs,
+                                        int editPos,
+                                        int editRowCount,
+                                        int editColCount,
+                                        NewCellAttrs& newAttrs)
+{
+    CellAttrs& cells = *rowAttrs.cells;
 
-        if ( editCount < 0
-             && mainPos >= editPos && mainPos < editPos - editCount )
+    // Remove the attributes of the deleted cells by moving the remaining
+    // ones in place, this preserves their order as all the cells after the
+    // edit position are shifted by the same amount.
+    size_t kept = 0;
+    int newRow = rowAttrs.row;
+    for ( size_t m = 0; m < cells.size(); m++ )
+    {
+        int row = rowAttrs.row,
+            col = cells[m].col;
+        if ( UpdateCellAttr(row, col, cells[m].attr,
+                            editPos, editRowCount, editColCount, newAttrs) )
         {
-            // On a position that still exists after deletion but main cell
-            // of multicell is within deletion range so the multicell is gone:
-            // Remove the attribute.
-            cellAttr->DecRef();
+            // When editing rows, all the remaining cells of this row are
+            // either not affected or shifted together, so they all have the
+            // same new row.
+            newRow = row;
 
-            continue;
+            cells[kept] = CellAttr(col, cells[m].attr);
+            kept++;
         }
+    }
 
-        // Rows/cols inserted or deleted (and this inside cell still exists):
-        // Adjust (inside) cell coords.
-        newAttrs[newCoords] = cellAttr;
+    if ( !kept )
+        return false;
+
+    cells.erase(cells.begin() + kept, cells.end());
+
+    rowAttrs.row = newRow;
+
+    return true;
+}
+
+void wxGridCellAttrData::AddNewAttrs(const NewCellAttrs& newAttrs)
+{
+    for ( size_t n = 0; n < newAttrs.size(); n++ )
+    {
+        const NewCellAttr& newAttr = newAttrs[n];
+        SetAttr(newAttr.attr, newAttr.row, newAttr.col);
+    }
+}
+
+void wxGridCellAttrData::UpdateAttrRows( size_t pos, int numRows )
+{
+    if ( !numRows )
+        return;
+
+    const int editPos = static_cast<int>(pos);
 
-        if ( mainPos >= editPos )
+    // Only the cells in the rows before this one can be affected by the
+    // editing in a way different from just being shifted or deleted: this
+    // range includes all the rows of the multicells crossing the edit
+    // position or starting in the deleted range and is extended below when
+    // such multicells are found.
+    const int deleteEnd = numRows < 0 ? editPos - numRows : editPos;
+    int affectedEnd = deleteEnd;
+
+    NewCellAttrs newAttrs;
+
+    const size_t first = FindRow(editPos);
+    if ( first < m_rows.size() && m_rows[first].row == editPos )
+    {
+        // Multicells with the main cell above the edit position and
+        // continuing below it must be resized. As all the cells of a
+        // multicell have attributes, they can be found using the inside cells
+        // in the same column as their main cells in the first edited row,
+        // without checking all the rows above it.
+        const CellAttrs& cells = *m_rows[first].cells;
+        for ( size_t m = 0; m < cells.size(); m++ )
         {
-            // Nothing more to do: the multicell that this inside cell is part
-            // of is moving its main cell as well so offsets to the main cell
-            // don't change and there are no edits changing the multicell size.
-            continue;
+            int cellRows, cellCols;
+            cells[m].attr->GetSize(&cellRows, &cellCols);
+            if ( cellRows >= 0 || cellCols != 0 )
+                continue;
+
+            int mainRow = editPos + cellRows,
+                mainCol = cells[m].col;
+            wxGridCellAttr ** const mainAttr = FindAttr(mainRow, mainCol);
+            if ( !mainAttr )
+                continue;
+
+            int mainRows, mainCols;
+            (*mainAttr)->GetSize(&mainRows, &mainCols);
+            affectedEnd = wxMax(affectedEnd, mainRow + mainRows);
+
+            UpdateCellAttr(mainRow, mainCol, *mainAttr,
+                           editPos, numRows, 0, newAttrs);
         }
+    }
 
-        if ( editCount > 0 && cellPos == editPos )
+    // Update the rows after the edit position in place, removing the deleted
+    // ones, and shift all the rows after the affected range without looking
+    // at their individual cells.
+    size_t out = first;
+    for ( size_t n = first; n < m_rows.size(); n++ )
+    {
+        RowAttrs rowAttrs = m_rows[n];
+        if ( rowAttrs.row < affectedEnd )
         {
-            // At an (old) position that is newly inserted: this is the only
-            // opportunity to add required inside cells that point to
-            // the main cell. E.g. with a 2x1 multicell that increases in size
-            // there's only one inside cell that will be visited while there
-            // can be multiple insertions.
-            for ( int i = 0; i < editCount; ++i )
+            if ( rowAttrs.row < deleteEnd )
             {
-                const int adjustRows = i * isEditingRows,
-                          adjustCols = i * !isEditingRows;
-
-                wxGridCellAttr* attr = new wxGridCellAttr;
-                attr->SetSize(cellRows - adjustRows, cellCols - adjustCols);
+                // The inside cells of the deleted multicells must be deleted
+                // too, even if they're outside of the deleted range.
+                const CellAttrs& cells = *rowAttrs.cells;
+                for ( size_t m = 0; m < cells.size(); m++ )
+                {
+                    int cellRows, cellCols;
+                    cells[m].attr->GetSize(&cellRows, &cellCols);
+                    if ( GetCellSpan(cellRows, cellCols)
+                            == wxGrid::CellSpan_Main )
+                    {
+                        affectedEnd = wxMax(affectedEnd,
+                                            rowAttrs.row + cellRows);
+                    }
+                }
+            }
 
-                const int row = cellRow + adjustRows,
-                          col = cellCol + adjustCols;
-                newAttrs[CoordsToKey(row, col)] = attr;
+            if ( !UpdateRowAttrs(rowAttrs, editPos, numRows, 0, newAttrs) )
+            {
+                delete rowAttrs.cells;
+                continue;
             }
         }
+        else
+        {
+            rowAttrs.row += numRows;
+        }
 
-        // Let this inside cell's size point to the main cell of the multicell.
-        cellAttr->SetSize(cellRows - editRowCount, cellCols - editColCount);
+        m_rows[out++] = rowAttrs;
     }
 
-    attrs = newAttrs;
-}
-
-} // anonymous namespace
+    m_rows.erase(m_rows.begin() + out, m_rows.end());
 
-void wxGridCellAttrData::UpdateAttrRows( size_t pos, int numRows )
-{
-    UpdateCellAttrRowsOrCols(m_attrs, static_cast<int>(pos), numRows, 0);
+    AddNewAttrs(newAttrs);
 }
 
 void wxGridCellAttrData::UpdateAttrCols( size_t pos, int numCols )
 {
-    UpdateCellAttrRowsOrCols(m_attrs, static_cast<int>(pos), 0, numCols);
-}
+    if ( !numCols )
+        return;
 
-wxGridCoordsToAttrMap::iterator
-wxGridCellAttrData::FindIndex(int row, int col) const
-{
-    return m_attrs.find(CoordsToKey(row, col));
+    const int editPos = static_cast<int>(pos);
+
+    NewCellAttrs newAttrs;
+
+    // All rows may be affected, but there is no need to shift them.
+    size_t out = 0;
+    for ( size_t n = 0; n < m_rows.size(); n++ )
+    {
+        RowAttrs rowAttrs = m_rows[n];
+        if ( !UpdateRowAttrs(rowAttrs, editPos, 0, numCols, newAttrs) )
+        {
+            delete rowAttrs.cells;
+            continue;
+        }
+
+        m_rows[out++] = rowAttrs;
+    }
+
+    m_rows.erase(m_rows.begin() + out, m_rows.end());
+
+    AddNewAttrs(newAttrs);
 }
 
 // ----------------------------------------------------------------------------
@@ -1131,116 +1320,347 @@ void wxGridRowOrColAttrData::UpdateAttrRowsOrCols( size_t pos, int numRowsOrCols
 }
 
 // ----------------------------------------------------------------------------
-// wxGridCellAttrProvider
+// wxGridLinePositions
 // ----------------------------------------------------------------------------
 
-wxGridCellAttrProvider::wxGridCellAttrProvider()
+void wxGridLinePositions::Build(const wxArrayInt& sizes, const wxArrayInt& order)
 {
-    m_data = NULL;
-}
+    const int count = static_cast<int>(sizes.size());
 
-wxGridCellAttrProvider::~wxGridCellAttrProvider()
-{
-    delete m_data;
+    m_tree.clear();
+    m_tree.reserve(count);
+
+    for ( int pos = 0; pos < count; pos++ )
+    {
+        // Negative size indicates a hidden line.
+        const int size = sizes[order.empty() ? pos : order[pos]];
+        m_tree.push_back(size > 0 ? size : 0);
+    }
+
+    // Propagate the partial sums to the parent nodes, which is what Update()
+    // does too, but can be done in a single linear pass here.
+    for ( int i = 1; i <= count; i++ )
+    {
+        const int parent = i + (i & -i);
+        if ( parent <= count )
+            m_tree[parent - 1] += m_tree[i - 1];
+    }
 }
 
-void wxGridCellAttrProvider::InitData()
+void wxGridLinePositions::Append(int count, int size)
 {
-    m_data = new wxGridCellAttrProviderData;
+    if ( size < 0 )
+        size = 0;
+
+    for ( ; count > 0; count-- )
+    {
+        // The new node covers the new line itself and the lowest set bit of
+        // its index minus one lines preceding it.
+        const int i = GetCount() + 1;
+        m_tree.push_back(size + GetStart(i - 1) - GetStart(i - (i & -i)));
+    }
 }
 
-wxGridCellAttr *wxGridCellAttrProvider::GetAttr(int row, int col,
-                                                wxGridCellAttr::wxAttrKind  kind ) const
+void wxGridLinePositions::Update(int pos, int diff)
 {
-    wxGridCellAttr *attr = NULL;
-    if ( m_data )
-    {
-        switch (kind)
-        {
-            case (wxGridCellAttr::Any):
-                // Get cached merge attributes.
-                // Currently not used as no cache implemented as not mutable
-                // attr = m_data->m_mergeAttr.GetAttr(row, col);
-                if (!attr)
-                {
-                    // Basically implement old version.
-                    // Also check merge cache, so we don't have to re-merge every time..
-                    wxGridCellAttr *attrcell = m_data->m_cellAttrs.GetAttr(row, col);
-                    wxGridCellAttr *attrrow = m_data->m_rowAttrs.GetAttr(row);
-                    wxGridCellAttr *attrcol = m_data->m_colAttrs.GetAttr(col);
+    const int count = GetCount();
 
-                    if ((attrcell != attrrow) && (attrrow != attrcol) && (attrcell != attrcol))
-                    {
-                        // Two or more are non NULL
-                        attr = new wxGridCellAttr;
-                        attr->SetKind(wxGridCellAttr::Merged);
+    wxCHECK_RET( pos >= 0 && pos < count, "invalid line position" );
 
-                        // Order is important..
-                        if (attrcell)
-                        {
-                            attr->MergeWith(attrcell);
-                            attrcell->DecRef();
-                        }
-                        if (attrcol)
-                        {
-                            attr->MergeWith(attrcol);
-                            attrcol->DecRef();
-                        }
-                        if (attrrow)
-                        {
-                            attr->MergeWith(attrrow);
-                            attrrow->DecRef();
-                        }
+    for ( int i = pos + 1; i <= count; i += i & -i )
+        m_tree[i - 1] += diff;
+}
 
-                        // store merge attr if cache implemented
-                        //attr->IncRef();
-                        //m_data->m_mergeAttr.SetAttr(attr, row, col);
-                    }
-                    else
-                    {
-                        // one or none is non null return it or null.
-                        if (attrrow)
-                            attr = attrrow;
-                        if (attrcol)
-                        {
-                            if (attr)
-                                attr->DecRef();
-                            attr = attrcol;
-                        }
-                        if (attrcell)
-                        {
-                            if (attr)
-                                attr->DecRef();
-                            attr = attrcell;
-                        }
-                    }
-                }
-                break;
+int wxGridLinePositions::GetStart(int pos) const
+{
+    wxCHECK_MSG( pos >= 0 && pos <= GetCount(), 0, "invalid line position" );
 
-            case (wxGridCellAttr::Cell):
-                attr = m_data->m_cellAttrs.GetAttr(row, col);
-                break;
+    int start = 0;
+    for ( int i = pos; i > 0; i -= i & -i )
+        start += m_tree[i - 1];
 
-            case (wxGridCellAttr::Col):
-                attr = m_data->m_colAttrs.GetAttr(col);
-                break;
+    return start;
+}
 
-            case (wxGridCellAttr::Row):
-                attr = m_data->m_rowAttrs.GetAttr(row);
-                break;
+int wxGridLinePositions::FindPos(int coord) const
+{
+    const int count = GetCount();
 
-            default:
-                // unused as yet...
-                // (wxGridCellAttr::Default):
-                // (wxGridCellAttr::Merged):
-                break;
+    int step = 1;
+    while ( step <= count / 2 )
+        step *= 2;
+
+    // Descend the tree, skipping over all the nodes ending before or at the
+    // given coordinate, which leaves pos equal to the number of lines ending
+    // there, i.e. the position of the line containing it.
+    int pos = 0;
+    for ( ; step > 0; step /= 2 )
+    {
+        const int next = pos + step;
+        if ( next <= count && m_tree[next - 1] <= coord )
+        {
+            pos = next;
+            coord -= m_tree[next - 1];
         }
     }
 
-    return attr;
+    return pos;
 }
 
-void wxGridCellAttrProvider::SetAttr(wxGridCellAttr *attr,
+// ----------------------------------------------------------------------------
+// wxGridAutoSizeCache
+// ----------------------------------------------------------------------------
+
+int wxGridAutoSizeCache::Get(int line, int block) const
+{
+    if ( line >= static_cast<int>(m_lines.size()) )
+        return -1;
+
+    const wxVector<int>& blocks = m_lines[line];
+
+    return block < static_cast<int>(blocks.size()) ? blocks[block] : -1;
+}
+
+void wxGridAutoSizeCache::Set(int line, int block, int extent)
+{
+    if ( line >= static_cast<int>(m_lines.size()) )
+        m_lines.resize(line + 1);
+
+    wxVector<int>& blocks = m_lines[line];
+    if ( block >= static_cast<int>(blocks.size()) )
+        blocks.resize(block + 1, -1);
+
+    blocks[block] = extent;
+}
+
+void wxGridAutoSizeCache::InvalidateCell(int line, int cell)
+{
+    const size_t block = cell / BLOCK_SIZE;
+
+    if ( line == -1 )
+    {
+        for ( size_t n = 0; n < m_lines.size(); n++ )
+        {
+            if ( block < m_lines[n].size() )
+                m_lines[n][block] = -1;
+        }
+    }
+    else if ( line < static_cast<int>(m_lines.size()) )
+    {
+        wxVector<int>& blocks = m_lines[line];
+        if ( block < blocks.size() )
+            blocks[block] = -1;
+    }
+}
+
+void wxGridAutoSizeCache::InvalidateLine(int line)
+{
+    if ( line < static_cast<int>(m_lines.size()) )
+        m_lines[line].clear();
+}
+
+void wxGridAutoSizeCache::UpdateLines(int pos, int numLines)
+{
+    if ( pos >= static_cast<int>(m_lines.size()) )
+        return;
+
+    if ( numLines > 0 )
+    {
+        m_lines.insert(m_lines.begin() + pos, numLines, wxVector<int>());
+    }
+    else
+    {
+        const int end = wxMin(pos - numLines, static_cast<int>(m_lines.size()));
+        m_lines.erase(m_lines.begin() + pos, m_lines.begin() + end);
+    }
+}
+
+void wxGridAutoSizeCache::UpdateCells(int pos)
+{
+    const size_t block = pos / BLOCK_SIZE;
+
+    for ( size_t n = 0; n < m_lines.size(); n++ )
+    {
+        wxVector<int>& blocks = m_lines[n];
+        if ( block < blocks.size() )
+            blocks.erase(blocks.begin() + block, blocks.end());
+    }
+}
+
+// ----------------------------------------------------------------------------
+// wxGridRenderCache
+// ----------------------------------------------------------------------------
+
+/* static */
+void wxGridRenderCache::ReleaseEntry(const wxGridRenderCacheEntry& entry)
+{
+    entry.renderer->DecRef();
+    entry.attr->DecRef();
+}
+
+void wxGridRenderCache::Set(int row, int col,
+                            wxGridCellAttr *attr,
+                            wxGridCellRenderer *renderer)
+{
+    if ( m_entries.size() >= MAX_ENTRIES )
+        Clear();
+
+    attr->IncRef();
+    renderer->IncRef();
+
+    wxGridRenderCacheEntry& entry = m_entries[GetKey(row, col)];
+    if ( entry.attr )
+        ReleaseEntry(entry);
+
+    entry.attr = attr;
+    entry.renderer = renderer;
+}
+
+void wxGridRenderCache::Invalidate(int row, int col)
+{
+    const wxGridRenderCacheMap::iterator it = m_entries.find(GetKey(row, col));
+    if ( it == m_entries.end() )
+        return;
+
+    // Releasing the attribute could, in principle, result in calling back
+    // into the grid, so remove it from the cache first.
+    const wxGridRenderCacheEntry entry = it->second;
+    m_entries.erase(it);
+    ReleaseEntry(entry);
+}
+
+void wxGridRenderCache::Clear()
+{
+    if ( m_entries.empty() )
+        return;
+
+    // As in Invalidate(), empty the cache before releasing its contents.
+    wxVector<wxGridRenderCacheEntry> entries;
+    entries.reserve(m_entries.size());
+    for ( wxGridRenderCacheMap::const_iterator it = m_entries.begin();
+          it != m_entries.end();
+          ++it )
+    {
+        entries.push_back(it->second);
+    }
+
+    m_entries.clear();
+
+    for ( size_t n = 0; n < entries.size(); n++ )
+        ReleaseEntry(entries[n]);
+}
+
+// ----------------------------------------------------------------------------
+// wxGridCellAttrProvider
+// ----------------------------------------------------------------------------
+
+wxGridCellAttrProvider::wxGridCellAttrProvider()
+{
+    m_data = NULL;
+}
+
+wxGridCellAttrProvider::~wxGridCellAttrProvider()
+{
+    delete m_data;
+}
+
+void wxGridCellAttrProvider::InitData()
+{
+    m_data = new wxGridCellAttrProviderData;
+}
+
+wxGridCellAttr *wxGridCellAttrProvider::GetAttr(int row, int col,
+                                                wxGridCellAttr::wxAttrKind  kind ) const
+{
+    wxGridCellAttr *attr = NULL;
+    if ( m_data )
+    {
+        switch (kind)
+        {
+            case (wxGridCellAttr::Any):
+                // Get cached merge attributes.
+                // Currently not used as no cache implemented as not mutable
+                // attr = m_data->m_mergeAttr.GetAttr(row, col);
+                if (!attr)
+                {
+                    // Basically implement old version.
+                    // Also check merge cache, so we don't have to re-merge every time..
+                    wxGridCellAttr *attrcell = m_data->m_cellAttrs.GetAttr(row, col);
+                    wxGridCellAttr *attrrow = m_data->m_rowAttrs.GetAttr(row);
+                    wxGridCellAttr *attrcol = m_data->m_colAttrs.GetAttr(col);
+
+                    if ((attrcell != attrrow) && (attrrow != attrcol) && (attrcell != attrcol))
+                    {
+                        // Two or more are non NULL
+                        attr = new wxGridCellAttr;
+                        attr->SetKind(wxGridCellAttr::Merged);
+
+                        // Order is important..
+                        if (attrcell)
+                        {
+                            attr->MergeWith(attrcell);
+                            attrcell->DecRef();
+                        }
+                        if (attrcol)
+                        {
+                            attr->MergeWith(attrcol);
+                            attrcol->DecRef();
+                        }
+                        if (attrrow)
+                        {
+                            attr->MergeWith(attrrow);
+                            attrrow->DecRef();
+                        }
+
+                        // store merge attr if cache implemented
+                        //attr->IncRef();
+                        //m_data->m_mergeAttr.SetAttr(attr, row, col);
+                    }
+                    else
+                    {
+                        // one or none is non null return it or null.
+                        if (attrrow)
+                            attr = attrrow;
+                        if (attrcol)
+                        {
+                            if (attr)
+                                attr->DecRef();
+                            attr = attrcol;
+                        }
+                        if (attrcell)
+                        {
+                            if (attr)
+                                attr->DecRef();
+                            attr = attrcell;
+                        }
+                    }
+                }
+                break;
+
+            case (wxGridCellAttr::Cell):
+                attr = m_data->m_cellAttrs.GetAttr(row, col);
+                break;
+
+            case (wxGridCellAttr::Col):
+                attr = m_data->m_colAttrs.GetAttr(col);
+                break;
+
+            case (wxGridCellAttr::Row):
+                attr = m_data->m_rowAttrs.GetAttr(row);
+                break;
+
+            default:
+                // unused as yet...
+                // (wxGridCellAttr::Default):
+                // (wxGridCellAttr::Merged):
+                break;
+        }
+    }
+
+    return attr;
+}
+
+void wxGridCellAttrProvider::SetAttr(wxGridCellAttr *attr,
                                      int row, int col)
 {
     if ( !m_data )
@@ -1738,6 +2158,18 @@ void  wxGridTableBase::SetValueAsCustom( int WXUNUSED(row), int WXUNUSED(col),
 {
 }
 
+void wxGridTableBase::GetValuesAsString( const wxGridBlockCoords& block,
+                                         wxArrayString& values )
+{
+    for ( int row = block.GetTopRow(); row <= block.GetBottomRow(); row++ )
+    {
+        for ( int col = block.GetLeftCol(); col <= block.GetRightCol(); col++ )
+        {
+            values.Add( GetValue(row, col) );
+        }
+    }
+}
+
 //////////////////////////////////////////////////////////////////////
 //
 // Message class for the grid table to send requests and notifications
@@ -2089,39 +2521,1514 @@ void wxGridStringTable::SetRowLabelValue( int row, const wxString& value )
         int n = m_rowLabels.GetCount();
         int i;
 
-        for ( i = n; i <= row; i++ )
-        {
-            m_rowLabels.Add( wxGridTableBase::GetRowLabelValue(i) );
-        }
-    }
+        for ( i = n; i <= row; i++ )
+        {
+            m_rowLabels.Add( wxGridTableBase::GetRowLabelValue(i) );
+        }
+    }
+
+    m_rowLabels[row] = value;
+}
+
+void wxGridStringTable::SetColLabelValue( int col, const wxString& value )
+{
+    if ( col > (int)(m_colLabels.GetCount()) - 1 )
+    {
+        int n = m_colLabels.GetCount();
+        int i;
+
+        for ( i = n; i <= col; i++ )
+        {
+            m_colLabels.Add( wxGridTableBase::GetColLabelValue(i) );
+        }
+    }
+
+    m_colLabels[col] = value;
+}
+
+void wxGridStringTable::SetCornerLabelValue( const wxString& value )
+{
+    m_cornerLabel = value;
+}
+
+wxString wxGridStringTable::GetCornerLabelValue() const
+{
+    return m_cornerLabel;
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// A grid table storing the values of each column in a vector of the type
+// corresponding to the column type instead of storing all of them as
+// strings, which allows to use much less memory for the numeric data and
+// to fill the table with it much faster.
+//
+
+// The values of a single column of wxGridColumnarTable: only the vector
+// corresponding to the column type is used.
+//
+// The string values are interned, i.e. each distinct string is stored only
+// once per column and the cells only store its index, which is especially
+// useful for the columns containing a few distinct values repeated many
+// times. Notice that the strings are never removed from the pool, even if
+// they're not used by any cell any more, until the column is reset.
+class wxGridColumnarTableColumn
+{
+public:
+    wxGridColumnarTableColumn(wxGridColumnarTable::ColumnType type,
+                              size_t numRows)
+        : m_hasLabel(false)
+    {
+        Reset(type, numRows);
+    }
+
+    wxGridColumnarTable::ColumnType GetType() const { return m_type; }
+
+    // Change the type of the column and reset all its values to the defaults.
+    void Reset(wxGridColumnarTable::ColumnType type, size_t numRows);
+
+    // Insert the given number of default values or erase the values of the
+    // given rows.
+    void Insert(size_t pos, size_t count);
+    void Erase(size_t pos, size_t count);
+
+    // Get or set the value of the given row converting it to or from string.
+    wxString GetString(size_t row) const;
+    void SetString(size_t row, const wxString& value);
+
+    // Return the index of the given string in the pool, adding it if needed.
+    wxUint32 Intern(const wxString& value);
+
+    wxVector<long> m_longs;
+    wxVector<double> m_doubles;
+    wxVector<unsigned char> m_bools;
+    wxVector<wxUint32> m_strings;
+
+    // The distinct values of the string column and the map from them to
+    // their indices in this array.
+    wxArrayString m_pool;
+    wxStringToNumHashMap m_poolIndices;
+
+    wxString m_label;
+    bool m_hasLabel;
+
+private:
+    wxGridColumnarTable::ColumnType m_type;
+
+    wxDECLARE_NO_COPY_CLASS(wxGridColumnarTableColumn);
+};
+
+void
+wxGridColumnarTableColumn::Reset(wxGridColumnarTable::ColumnType type,
+                                 size_t numRows)
+{
+    m_type = type;
+
+    m_longs.clear();
+    m_doubles.clear();
+    m_bools.clear();
+    m_strings.clear();
+    m_pool.clear();
+    m_poolIndices.clear();
+
+    // The empty string always has index 0, so that the default value of the
+    // cells of the string columns is 0, as for all the other types.
+    if ( m_type == wxGridColumnarTable::Type_String )
+        Intern(wxString());
+
+    Insert(0, numRows);
+}
+
+void wxGridColumnarTableColumn::Insert(size_t pos, size_t count)
+{
+    switch ( m_type )
+    {
+        case wxGridColumnarTable::Type_String:
+            m_strings.insert(m_strings.begin() + pos, count, 0);
+            break;
+
+        case wxGridColumnarTable::Type_Long:
+            m_longs.insert(m_longs.begin() + pos, count, 0);
+            break;
+
+        case wxGridColumnarTable::Type_Double:
+            m_doubles.insert(m_doubles.begin() + pos, count, 0.);
+            break;
+
+        case wxGridColumnarTable::Type_Bool:
+            m_bools.insert(m_bools.begin() + pos, count, 0);
+            break;
+    }
+}
+
+void wxGridColumnarTableColumn::Erase(size_t pos, size_t count)
+{
+    switch ( m_type )
+    {
+        case wxGridColumnarTable::Type_String:
+            m_strings.erase(m_strings.begin() + pos,
+                            m_strings.begin() + pos + count);
+            break;
+
+        case wxGridColumnarTable::Type_Long:
+            m_longs.erase(m_longs.begin() + pos,
+                          m_longs.begin() + pos + count);
+            break;
+
+        case wxGridColumnarTable::Type_Double:
+            m_doubles.erase(m_doubles.begin() + pos,
+                            m_doubles.begin() + pos + count);
+            break;
+
+        case wxGridColumnarTable::Type_Bool:
+            m_bools.erase(m_bools.begin() + pos,
+                          m_bools.begin() + pos + count);
+            break;
+    }
+}
+
+wxString wxGridColumnarTableColumn::GetString(size_t row) const
+{
+    switch ( m_type )
+    {
+        case wxGridColumnarTable::Type_String:
+            return m_pool[m_strings[row]];
+
+        case wxGridColumnarTable::Type_Long:
+            return wxString::Format("%ld", m_longs[row]);
+
+        case wxGridColumnarTable::Type_Double:
+            return wxString::FromDouble(m_doubles[row]);
+
+        case wxGridColumnarTable::Type_Bool:
+            // Use the same representation as wxGridCellBoolEditor.
+            return m_bools[row] ? wxString("1") : wxString();
+    }
+
+    return wxString();
+}
+
+void wxGridColumnarTableColumn::SetString(size_t row, const wxString& value)
+{
+    switch ( m_type )
+    {
+        case wxGridColumnarTable::Type_String:
+            m_strings[row] = Intern(value);
+            break;
+
+        case wxGridColumnarTable::Type_Long:
+            {
+                long l = 0;
+                if ( value.empty() || value.ToLong(&l) )
+                    m_longs[row] = l;
+                else
+                    wxLogDebug("Ignoring invalid integer value \"%s\".", value);
+            }
+            break;
+
+        case wxGridColumnarTable::Type_Double:
+            {
+                // Use the C locale to parse the strings returned by GetString().
+                double d = 0.;
+                if ( value.empty() || value.ToCDouble(&d) )
+                    m_doubles[row] = d;
+                else
+                    wxLogDebug("Ignoring invalid number \"%s\".", value);
+            }
+            break;
+
+        case wxGridColumnarTable::Type_Bool:
+            m_bools[row] = !value.empty() && value != wxS("0");
+            break;
+    }
+}
+
+wxUint32 wxGridColumnarTableColumn::Intern(const wxString& value)
+{
+    const wxStringToNumHashMap::const_iterator it = m_poolIndices.find(value);
+    if ( it != m_poolIndices.end() )
+        return static_cast<wxUint32>(it->second);
+
+    const wxUint32 index = static_cast<wxUint32>(m_pool.size());
+    m_pool.push_back(value);
+    m_poolIndices[value] = index;
+
+    return index;
+}
+
+wxIMPLEMENT_DYNAMIC_CLASS(wxGridColumnarTable, wxGridTableBase);
+
+wxGridColumnarTable::wxGridColumnarTable()
+        : wxGridTableBase()
+{
+    m_numRows = 0;
+}
+
+wxGridColumnarTable::~wxGridColumnarTable()
+{
+    for ( size_t n = 0; n < m_columns.size(); n++ )
+        delete m_columns[n];
+}
+
+wxGridColumnarTableColumn*
+wxGridColumnarTable::GetColumn( int row, int col ) const
+{
+    wxCHECK_MSG( (row >= 0 && row < m_numRows) &&
+                 (col >= 0 && col < static_cast<int>(m_columns.size())),
+                 NULL,
+                 wxT("invalid row or column index in wxGridColumnarTable") );
+
+    return m_columns[col];
+}
+
+wxGridColumnarTableColumn*
+wxGridColumnarTable::GetColumnForData( int col, ColumnType type,
+                                       size_t count, size_t firstRow ) const
+{
+    wxCHECK_MSG( col >= 0 && col < static_cast<int>(m_columns.size()),
+                 NULL,
+                 wxT("invalid column index in wxGridColumnarTable") );
+
+    wxCHECK_MSG( m_columns[col]->GetType() == type,
+                 NULL,
+                 wxT("wrong type of data for this column") );
+
+    wxCHECK_MSG( firstRow <= static_cast<size_t>(m_numRows) &&
+                    count <= m_numRows - firstRow,
+                 NULL,
+                 wxT("too many values for the number of rows") );
+
+    return m_columns[col];
+}
+
+int wxGridColumnarTable::AppendColumn( ColumnType type, const wxString& label )
+{
+    DoInsertCols( m_columns.size(), 1, type );
+
+    const int col = static_cast<int>(m_columns.size()) - 1;
+    if ( !label.empty() )
+        SetColLabelValue( col, label );
+
+    if ( GetView() )
+    {
+        wxGridTableMessage msg( this,
+                                wxGRIDTABLE_NOTIFY_COLS_APPENDED,
+                                1 );
+
+        GetView()->ProcessTableMessage( msg );
+    }
+
+    return col;
+}
+
+void wxGridColumnarTable::SetColumnType( int col, ColumnType type )
+{
+    wxCHECK_RET( col >= 0 && col < static_cast<int>(m_columns.size()),
+                 wxT("invalid column index in wxGridColumnarTable") );
+
+    m_columns[col]->Reset( type, m_numRows );
+}
+
+wxGridColumnarTable::ColumnType wxGridColumnarTable::GetColumnType( int col ) const
+{
+    wxCHECK_MSG( col >= 0 && col < static_cast<int>(m_columns.size()),
+                 Type_String,
+                 wxT("invalid column index in wxGridColumnarTable") );
+
+    return m_columns[col]->GetType();
+}
+
+bool wxGridColumnarTable::SetColumnData( int col, const long *values,
+                                         size_t count, size_t firstRow )
+{
+    wxGridColumnarTableColumn* const
+        column = GetColumnForData( col, Type_Long, count, firstRow );
+    if ( !column )
+        return false;
+
+    for ( size_t n = 0; n < count; n++ )
+        column->m_longs[firstRow + n] = values[n];
+
+    return true;
+}
+
+bool wxGridColumnarTable::SetColumnData( int col, const double *values,
+                                         size_t count, size_t firstRow )
+{
+    wxGridColumnarTableColumn* const
+        column = GetColumnForData( col, Type_Double, count, firstRow );
+    if ( !column )
+        return false;
+
+    for ( size_t n = 0; n < count; n++ )
+        column->m_doubles[firstRow + n] = values[n];
+
+    return true;
+}
+
+bool wxGridColumnarTable::SetColumnData( int col, const bool *values,
+                                         size_t count, size_t firstRow )
+{
+    wxGridColumnarTableColumn* const
+        column = GetColumnForData( col, Type_Bool, count, firstRow );
+    if ( !column )
+        return false;
+
+    for ( size_t n = 0; n < count; n++ )
+        column->m_bools[firstRow + n] = values[n];
+
+    return true;
+}
+
+bool wxGridColumnarTable::SetColumnData( int col, const wxArrayString& values,
+                                         size_t firstRow )
+{
+    wxGridColumnarTableColumn* const
+        column = GetColumnForData( col, Type_String, values.size(), firstRow );
+    if ( !column )
+        return false;
+
+    for ( size_t n = 0; n < values.size(); n++ )
+        column->m_strings[firstRow + n] = column->Intern( values[n] );
+
+    return true;
+}
+
+wxString wxGridColumnarTable::GetValue( int row, int col )
+{
+    wxGridColumnarTableColumn* const column = GetColumn( row, col );
+
+    return column ? column->GetString( row ) : wxString();
+}
+
+void wxGridColumnarTable::SetValue( int row, int col, const wxString& value )
+{
+    wxGridColumnarTableColumn* const column = GetColumn( row, col );
+    if ( column )
+        column->SetString( row, value );
+}
+
+bool wxGridColumnarTable::IsEmptyCell( int row, int col )
+{
+    wxGridColumnarTableColumn* const column = GetColumn( row, col );
+    if ( !column )
+        return true;
+
+    // Only the string cells can be empty, the numeric ones always have some
+    // value, while the boolean ones are empty when they're false, as for
+    // wxGridStringTable.
+    switch ( column->GetType() )
+    {
+        case Type_String:
+            return column->m_strings[row] == 0;
+
+        case Type_Bool:
+            return !column->m_bools[row];
+
+        case Type_Long:
+        case Type_Double:
+            break;
+    }
+
+    return false;
+}
+
+wxString wxGridColumnarTable::GetTypeName( int row, int col )
+{
+    wxGridColumnarTableColumn* const column = GetColumn( row, col );
+    if ( !column )
+        return wxGRID_VALUE_STRING;
+
+    switch ( column->GetType() )
+    {
+        case Type_String:
+            break;
+
+        case Type_Long:
+            return wxGRID_VALUE_NUMBER;
+
+        case Type_Double:
+            return wxGRID_VALUE_FLOAT;
+
+        case Type_Bool:
+            return wxGRID_VALUE_BOOL;
+    }
+
+    return wxGRID_VALUE_STRING;
+}
+
+bool wxGridColumnarTable::CanGetValueAs( int row, int col,
+                                         const wxString& typeName )
+{
+    // All values can be converted to strings.
+    return typeName == wxGRID_VALUE_STRING ||
+            typeName == GetTypeName( row, col );
+}
+
+bool wxGridColumnarTable::CanSetValueAs( int row, int col,
+                                         const wxString& typeName )
+{
+    return CanGetValueAs( row, col, typeName );
+}
+
+long wxGridColumnarTable::GetValueAsLong( int row, int col )
+{
+    wxGridColumnarTableColumn* const column = GetColumn( row, col );
+    if ( !column || column->GetType() != Type_Long )
+        return wxGridTableBase::GetValueAsLong( row, col );
+
+    return column->m_longs[row];
+}
+
+double wxGridColumnarTable::GetValueAsDouble( int row, int col )
+{
+    wxGridColumnarTableColumn* const column = GetColumn( row, col );
+    if ( !column || column->GetType() != Type_Double )
+        return wxGridTableBase::GetValueAsDouble( row, col );
+
+    return column->m_doubles[row];
+}
+
+bool wxGridColumnarTable::GetValueAsBool( int row, int col )
+{
+    wxGridColumnarTableColumn* const column = GetColumn( row, col );
+    if ( !column || column->GetType() != Type_Bool )
+        return wxGridTableBase::GetValueAsBool( row, col );
+
+    return column->m_bools[row] != 0;
+}
+
+void wxGridColumnarTable::SetValueAsLong( int row, int col, long value )
+{
+    wxGridColumnarTableColumn* const column = GetColumn( row, col );
+    if ( column && column->GetType() == Type_Long )
+        column->m_longs[row] = value;
+}
+
+void wxGridColumnarTable::SetValueAsDouble( int row, int col, double value )
+{
+    wxGridColumnarTableColumn* const column = GetColumn( row, col );
+    if ( column && column->GetType() == Type_Double )
+        column->m_doubles[row] = value;
+}
+
+void wxGridColumnarTable::SetValueAsBool( int row, int col, bool value )
+{
+    wxGridColumnarTableColumn* const column = GetColumn( row, col );
+    if ( column && column->GetType() == Type_Bool )
+        column->m_bools[row] = value;
+}
+
+void wxGridColumnarTable::GetValuesAsString( const wxGridBlockCoords& block,
+                                             wxArrayString& values )
+{
+    wxCHECK_RET( block.GetTopRow() >= 0 &&
+                    block.GetBottomRow() < m_numRows &&
+                    block.GetLeftCol() >= 0 &&
+                    block.GetRightCol() < static_cast<int>(m_columns.size()),
+                 wxT("invalid block in wxGridColumnarTable") );
+
+    if ( block.GetTopRow() > block.GetBottomRow() ||
+            block.GetLeftCol() > block.GetRightCol() )
+        return;
+
+    const size_t numRows = block.GetBottomRow() - block.GetTopRow() + 1;
+    const size_t numCols = block.GetRightCol() - block.GetLeftCol() + 1;
+
+    // Allocate all the strings at once and then fill them column by column,
+    // which avoids checking the column type for every cell.
+    const size_t first = values.size();
+    values.Add( wxString(), numRows * numCols );
+
+    for ( size_t c = 0; c < numCols; c++ )
+    {
+        const wxGridColumnarTableColumn&
+            column = *m_columns[block.GetLeftCol() + c];
+
+        for ( size_t r = 0; r < numRows; r++ )
+        {
+            values[first + r * numCols + c] =
+                column.GetString( block.GetTopRow() + r );
+        }
+    }
+}
+
+void wxGridColumnarTable::Clear()
+{
+    for ( size_t n = 0; n < m_columns.size(); n++ )
+    {
+        wxGridColumnarTableColumn* const column = m_columns[n];
+        column->Reset( column->GetType(), m_numRows );
+    }
+}
+
+bool wxGridColumnarTable::InsertRows( size_t pos, size_t numRows )
+{
+    if ( pos >= static_cast<size_t>(m_numRows) )
+    {
+        return AppendRows( numRows );
+    }
+
+    for ( size_t n = 0; n < m_columns.size(); n++ )
+        m_columns[n]->Insert( pos, numRows );
+
+    m_numRows += numRows;
+
+    if ( GetView() )
+    {
+        wxGridTableMessage msg( this,
+                                wxGRIDTABLE_NOTIFY_ROWS_INSERTED,
+                                pos,
+                                numRows );
+
+        GetView()->ProcessTableMessage( msg );
+    }
+
+    return true;
+}
+
+bool wxGridColumnarTable::AppendRows( size_t numRows )
+{
+    for ( size_t n = 0; n < m_columns.size(); n++ )
+        m_columns[n]->Insert( m_numRows, numRows );
+
+    m_numRows += numRows;
+
+    if ( GetView() )
+    {
+        wxGridTableMessage msg( this,
+                                wxGRIDTABLE_NOTIFY_ROWS_APPENDED,
+                                numRows );
+
+        GetView()->ProcessTableMessage( msg );
+    }
+
+    return true;
+}
+
+bool wxGridColumnarTable::DeleteRows( size_t pos, size_t numRows )
+{
+    const size_t curNumRows = m_numRows;
+
+    wxCHECK_MSG( pos < curNumRows, false,
+                 wxT("invalid row index in wxGridColumnarTable::DeleteRows()") );
+
+    if ( numRows > curNumRows - pos )
+    {
+        numRows = curNumRows - pos;
+    }
+
+    for ( size_t n = 0; n < m_columns.size(); n++ )
+        m_columns[n]->Erase( pos, numRows );
+
+    m_numRows -= numRows;
+
+    if ( GetView() )
+    {
+        wxGridTableMessage msg( this,
+                                wxGRIDTABLE_NOTIFY_ROWS_DELETED,
+                                pos,
+                                numRows );
+
+        GetView()->ProcessTableMessage( msg );
+    }
+
+    return true;
+}
+
+void wxGridColumnarTable::DoInsertCols( size_t pos, size_t numCols,
+                                        ColumnType type )
+{
+    m_columns.insert( m_columns.begin() + pos, numCols, NULL );
+
+    for ( size_t n = pos; n < pos + numCols; n++ )
+        m_columns[n] = new wxGridColumnarTableColumn( type, m_numRows );
+}
+
+bool wxGridColumnarTable::InsertCols( size_t pos, size_t numCols )
+{
+    if ( pos >= m_columns.size() )
+    {
+        return AppendCols( numCols );
+    }
+
+    // The columns added using the generic API can contain anything, so they
+    // use strings, AppendColumn() can be used to add typed columns.
+    DoInsertCols( pos, numCols, Type_String );
+
+    if ( GetView() )
+    {
+        wxGridTableMessage msg( this,
+                                wxGRIDTABLE_NOTIFY_COLS_INSERTED,
+                                pos,
+                                numCols );
+
+        GetView()->ProcessTableMessage( msg );
+    }
+
+    return true;
+}
+
+bool wxGridColumnarTable::AppendCols( size_t numCols )
+{
+    DoInsertCols( m_columns.size(), numCols, Type_String );
+
+    if ( GetView() )
+    {
+        wxGridTableMessage msg( this,
+                                wxGRIDTABLE_NOTIFY_COLS_APPENDED,
+                                numCols );
+
+        GetView()->ProcessTableMessage( msg );
+    }
+
+    return true;
+}
+
+bool wxGridColumnarTable::DeleteCols( size_t pos, size_t numCols )
+{
+    const size_t curNumCols = m_columns.size();
+
+    wxCHECK_MSG( pos < curNumCols, false,
+                 wxT("invalid column index in wxGridColumnarTable::DeleteCols()") );
+
+    if ( numCols > curNumCols - pos )
+    {
+        numCols = curNumCols - pos;
+    }
+
+    for ( size_t n = pos; n < pos + numCols; n++ )
+        delete m_columns[n];
+
+    m_columns.erase( m_columns.begin() + pos,
+                     m_columns.begin() + pos + numCols );
+
+    if ( GetView() )
+    {
+        wxGridTableMessage msg( this,
+                                wxGRIDTABLE_NOTIFY_COLS_DELETED,
+                                pos,
+                                numCols );
+
+        GetView()->ProcessTableMessage( msg );
+    }
+
+    return true;
+}
+
+wxString wxGridColumnarTable::GetRowLabelValue( int row )
+{
+    if ( row > (int)(m_rowLabels.GetCount()) - 1 )
+    {
+        // using default label
+        //
+        return wxGridTableBase::GetRowLabelValue( row );
+    }
+    else
+    {
+        return m_rowLabels[row];
+    }
+}
+
+wxString wxGridColumnarTable::GetColLabelValue( int col )
+{
+    if ( col >= 0 && col < static_cast<int>(m_columns.size()) &&
+            m_columns[col]->m_hasLabel )
+    {
+        return m_columns[col]->m_label;
+    }
+
+    return wxGridTableBase::GetColLabelValue( col );
+}
+
+void wxGridColumnarTable::SetRowLabelValue( int row, const wxString& value )
+{
+    if ( row > (int)(m_rowLabels.GetCount()) - 1 )
+    {
+        int n = m_rowLabels.GetCount();
+        int i;
+
+        for ( i = n; i <= row; i++ )
+        {
+            m_rowLabels.Add( wxGridTableBase::GetRowLabelValue(i) );
+        }
+    }
+
+    m_rowLabels[row] = value;
+}
+
+void wxGridColumnarTable::SetColLabelValue( int col, const wxString& value )
+{
+    wxCHECK_RET( col >= 0 && col < static_cast<int>(m_columns.size()),
+                 wxT("invalid column index in wxGridColumnarTable") );
+
+    m_columns[col]->m_label = value;
+    m_columns[col]->m_hasLabel = true;
+}
+
+void wxGridColumnarTable::SetCornerLabelValue( const wxString& value )
+{
+    m_cornerLabel = value;
+}
+
+wxString wxGridColumnarTable::GetCornerLabelValue() const
+{
+    return m_cornerLabel;
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// A table showing the rows of another table in sorted order: only the
+// permutation of the rows is stored, the data itself is never copied.
+//
+
+// The values of the cells of the columns used as sort keys, extracted from
+// the table in the main thread, so that the sort itself can be done in the
+// background one, and the resulting order of the rows.
+class wxGridSortData
+{
+public:
+    wxGridSortData(wxGridTableBase& table, const wxGridSortKeys& keys);
+
+    // Sort the rows, checking if we should stop periodically if a thread is
+    // specified. Returns false if the sort was cancelled.
+    bool Sort(wxThread* thread);
+
+    // The rows of the table in the sorted order.
+    wxVector<int> m_rows;
+
+private:
+    enum KeyType
+    {
+        Key_Long,
+        Key_Double,
+        Key_String
+    };
+
+    struct Key
+    {
+        KeyType type;
+        bool ascending;
+
+        // Only the vector corresponding to the type is used.
+        wxVector<long> longs;
+        wxVector<double> doubles;
+        wxVector<wxString> strings;
+
+        // Pointers to the data of the used vector, as accessing it via
+        // operator[] is noticeably slower in the debug builds.
+        const long* longData;
+        const double* doubleData;
+        const wxString* stringData;
+    };
+
+    template <typename T>
+    static int CompareValues(const T& a, const T& b)
+    {
+        return a < b ? -1 : b < a ? 1 : 0;
+    }
+
+    // Compare the two rows using all the keys.
+    int Compare(int row1, int row2) const;
+
+    // Merge the two adjacent sorted ranges of src into dst.
+    void Merge(const int* src, int* dst, int lo, int mid, int hi) const;
+
+    wxVector<Key> m_keys;
+    int m_count;
+
+    wxDECLARE_NO_COPY_CLASS(wxGridSortData);
+};
+
+wxGridSortData::wxGridSortData(wxGridTableBase& table,
+                               const wxGridSortKeys& keys)
+{
+    m_count = table.GetNumberRows();
+
+    m_keys.resize(keys.size());
+    for ( size_t n = 0; n < keys.size(); n++ )
+    {
+        const int col = keys[n].col;
+        Key& key = m_keys[n];
+        key.ascending = keys[n].ascending;
+
+        // Use the type of the first cell for the entire column, as the typed
+        // columns normally contain values of the same type.
+        if ( m_count > 0 && table.CanGetValueAs(0, col, wxGRID_VALUE_NUMBER) )
+        {
+            key.type = Key_Long;
+            key.longs.reserve(m_count);
+            for ( int row = 0; row < m_count; row++ )
+                key.longs.push_back(table.GetValueAsLong(row, col));
+        }
+        else if ( m_count > 0 &&
+                    table.CanGetValueAs(0, col, wxGRID_VALUE_FLOAT) )
+        {
+            key.type = Key_Double;
+            key.doubles.reserve(m_count);
+            for ( int row = 0; row < m_count; row++ )
+                key.doubles.push_back(table.GetValueAsDouble(row, col));
+        }
+        else if ( m_count > 0 &&
+                    table.CanGetValueAs(0, col, wxGRID_VALUE_BOOL) )
+        {
+            key.type = Key_Long;
+            key.longs.reserve(m_count);
+            for ( int row = 0; row < m_count; row++ )
+                key.longs.push_back(table.GetValueAsBool(row, col));
+        }
+        else
+        {
+            key.type = Key_String;
+            key.strings.reserve(m_count);
+            for ( int row = 0; row < m_count; row++ )
+                key.strings.push_back(table.GetValue(row, col));
+        }
+
+        key.longData = key.longs.empty() ? NULL : &key.longs[0];
+        key.doubleData = key.doubles.empty() ? NULL : &key.doubles[0];
+        key.stringData = key.strings.empty() ? NULL : &key.strings[0];
+    }
+}
+
+int wxGridSortData::Compare(int row1, int row2) const
+{
+    for ( wxVector<Key>::const_iterator it = m_keys.begin();
+          it != m_keys.end();
+          ++it )
+    {
+        const Key& key = *it;
+
+        int rc = 0;
+        switch ( key.type )
+        {
+            case Key_Long:
+                rc = CompareValues(key.longData[row1], key.longData[row2]);
+                break;
+
+            case Key_Double:
+                rc = CompareValues(key.doubleData[row1], key.doubleData[row2]);
+                break;
+
+            case Key_String:
+                rc = key.stringData[row1].compare(key.stringData[row2]);
+                break;
+        }
+
+        if ( rc )
+            return key.ascending ? rc : -rc;
+    }
+
+    return 0;
+}
+
+void
+wxGridSortData::Merge(const int* src, int* dst, int lo, int mid, int hi) const
+{
+    int i = lo,
+        j = mid;
+
+    for ( int k = lo; k < hi; k++ )
+    {
+        // Take the element from the left range if they're equal to preserve
+        // the original order of the rows.
+        if ( i < mid && (j == hi || Compare(src[i], src[j]) <= 0) )
+            dst[k] = src[i++];
+        else
+            dst[k] = src[j++];
+    }
+}
+
+bool wxGridSortData::Sort(wxThread* thread)
+{
+    m_rows.resize(m_count);
+    for ( int row = 0; row < m_count; row++ )
+        m_rows[row] = row;
+
+    if ( m_count < 2 || m_keys.empty() )
+        return true;
+
+    // Use bottom up merge sort, which is stable and allows to check whether
+    // we should stop after each pass over the entire array, starting with
+    // sorting small runs using insertion sort.
+    static const int RUN_LENGTH = 32;
+
+    int* const rows = &m_rows[0];
+    for ( int lo = 0; lo < m_count; lo += RUN_LENGTH )
+    {
+        const int hi = wxMin(lo + RUN_LENGTH, m_count);
+        for ( int i = lo + 1; i < hi; i++ )
+        {
+            const int row = rows[i];
+
+            int j = i;
+            for ( ; j > lo && Compare(rows[j - 1], row) > 0; j-- )
+                rows[j] = rows[j - 1];
+
+            rows[j] = row;
+        }
+    }
+
+    wxVector<int> buffer(m_count);
+    int* src = rows;
+    int* dst = &buffer[0];
+
+    for ( int width = RUN_LENGTH; width < m_count; width *= 2 )
+    {
+        if ( thread && thread->TestDestroy() )
+            return false;
+
+        for ( int lo = 0; lo < m_count; lo += 2*width )
+        {
+            const int mid = wxMin(lo + width, m_count);
+            const int hi = wxMin(lo + 2*width, m_count);
+
+            Merge(src, dst, lo, mid, hi);
+        }
+
+        wxSwap(src, dst);
+    }
+
+    if ( src != rows )
+        m_rows.swap(buffer);
+
+    return true;
+}
+
+#if wxUSE_THREADS
+
+class wxGridSortThread : public wxThread
+{
+public:
+    wxGridSortThread(wxGridSortData& data,
+                     wxEvtHandler& handler,
+                     int generation)
+        : wxThread(wxTHREAD_JOINABLE),
+          m_data(data),
+          m_handler(handler),
+          m_generation(generation)
+    {
+    }
+
+protected:
+    virtual ExitCode Entry() wxOVERRIDE
+    {
+        if ( m_data.Sort(this) )
+        {
+            wxThreadEvent* const event = new wxThreadEvent();
+            event->SetInt(m_generation);
+            m_handler.QueueEvent(event);
+        }
+
+        return 0;
+    }
+
+private:
+    wxGridSortData& m_data;
+    wxEvtHandler& m_handler;
+    const int m_generation;
+
+    wxDECLARE_NO_COPY_CLASS(wxGridSortThread);
+};
+
+#endif // wxUSE_THREADS
+
+wxGridSortedTable::wxGridSortedTable( wxGridTableBase *table,
+                                      bool takeOwnership )
+        : wxGridTableBase(),
+          m_table(table),
+          m_ownTable(takeOwnership)
+{
+    wxASSERT_MSG( m_table, wxT("source table must be specified") );
+
+    m_sortThreshold = 100000;
+    m_sortData = NULL;
+    m_sortThread = NULL;
+    m_sortGeneration = 0;
+
+    m_sortHandler.Bind(wxEVT_THREAD, &wxGridSortedTable::OnSortDone, this);
+}
+
+wxGridSortedTable::~wxGridSortedTable()
+{
+    CancelSort();
+
+    if ( m_ownTable )
+        delete m_table;
+}
+
+void wxGridSortedTable::Sort( const wxGridSortKeys& keys )
+{
+    for ( size_t n = 0; n < keys.size(); n++ )
+    {
+        wxCHECK_RET( keys[n].col >= 0 && keys[n].col < GetNumberCols(),
+                     wxT("invalid sort column") );
+    }
+
+    CancelSort();
+
+    m_sortKeys = keys;
+
+    wxGridSortData* const data = new wxGridSortData(*m_table, keys);
+
+#if wxUSE_THREADS
+    if ( m_sortThreshold &&
+            static_cast<size_t>(GetNumberRows()) >= m_sortThreshold )
+    {
+        wxGridSortThread* const
+            thread = new wxGridSortThread(*data, m_sortHandler, ++m_sortGeneration);
+        if ( thread->Run() == wxTHREAD_NO_ERROR )
+        {
+            m_sortData = data;
+            m_sortThread = thread;
+            return;
+        }
+
+        // Fall back on sorting synchronously.
+        delete thread;
+    }
+#endif // wxUSE_THREADS
+
+    data->Sort(NULL);
+    ApplySort(data->m_rows);
+    delete data;
+}
+
+void wxGridSortedTable::CancelSort()
+{
+#if wxUSE_THREADS
+    if ( m_sortThread )
+    {
+        // The event possibly queued by the thread will be ignored because
+        // its generation doesn't match the next one.
+        m_sortThread->Delete();
+        wxDELETE(m_sortThread);
+        wxDELETE(m_sortData);
+        m_sortGeneration++;
+    }
+#endif // wxUSE_THREADS
+}
+
+void wxGridSortedTable::OnSortDone( wxThreadEvent& event )
+{
+#if wxUSE_THREADS
+    if ( !m_sortThread || event.GetInt() != m_sortGeneration )
+        return;
+
+    m_sortThread->Wait();
+    wxDELETE(m_sortThread);
+
+    ApplySort(m_sortData->m_rows);
+    wxDELETE(m_sortData);
+#else // !wxUSE_THREADS
+    wxUnusedVar(event);
+#endif // wxUSE_THREADS/!wxUSE_THREADS
+}
+
+void wxGridSortedTable::ApplySort( wxVector<int>& rows )
+{
+    m_rows.swap(rows);
+
+    wxGrid* const grid = GetView();
+    if ( grid )
+    {
+        if ( m_sortKeys.empty() )
+            grid->UnsetSortingColumn();
+        else
+            grid->SetSortingColumn(m_sortKeys[0].col, m_sortKeys[0].ascending);
+
+        // The cells now correspond to different rows of the source table, so
+        // invalidate everything cached by the grid.
+        grid->ClearAutoSizeCache();
+        grid->ForceRefresh();
+    }
+}
+
+void wxGridSortedTable::ResetSort()
+{
+    CancelSort();
+
+    if ( m_sortKeys.empty() && m_rows.empty() )
+        return;
+
+    m_sortKeys.clear();
+
+    wxVector<int> rows;
+    ApplySort(rows);
+}
+
+void wxGridSortedTable::NotifyView( int id, int comInt1, int comInt2 )
+{
+    if ( GetView() )
+    {
+        wxGridTableMessage msg( this, id, comInt1, comInt2 );
+
+        GetView()->ProcessTableMessage( msg );
+    }
+}
+
+wxString wxGridSortedTable::GetValue( int row, int col )
+{
+    return m_table->GetValue( GetSourceRow(row), col );
+}
+
+void wxGridSortedTable::SetValue( int row, int col, const wxString& s )
+{
+    m_table->SetValue( GetSourceRow(row), col, s );
+}
+
+bool wxGridSortedTable::IsEmptyCell( int row, int col )
+{
+    return m_table->IsEmptyCell( GetSourceRow(row), col );
+}
+
+wxString wxGridSortedTable::GetTypeName( int row, int col )
+{
+    return m_table->GetTypeName( GetSourceRow(row), col );
+}
+
+bool wxGridSortedTable::CanGetValueAs( int row, int col,
+                                       const wxString& typeName )
+{
+    return m_table->CanGetValueAs( GetSourceRow(row), col, typeName );
+}
+
+bool wxGridSortedTable::CanSetValueAs( int row, int col,
+                                       const wxString& typeName )
+{
+    return m_table->CanSetValueAs( GetSourceRow(row), col, typeName );
+}
+
+long wxGridSortedTable::GetValueAsLong( int row, int col )
+{
+    return m_table->GetValueAsLong( GetSourceRow(row), col );
+}
+
+double wxGridSortedTable::GetValueAsDouble( int row, int col )
+{
+    return m_table->GetValueAsDouble( GetSourceRow(row), col );
+}
+
+bool wxGridSortedTable::GetValueAsBool( int row, int col )
+{
+    return m_table->GetValueAsBool( GetSourceRow(row), col );
+}
+
+void wxGridSortedTable::SetValueAsLong( int row, int col, long value )
+{
+    m_table->SetValueAsLong( GetSourceRow(row), col, value );
+}
+
+void wxGridSortedTable::SetValueAsDouble( int row, int col, double value )
+{
+    m_table->SetValueAsDouble( GetSourceRow(row), col, value );
+}
+
+void wxGridSortedTable::SetValueAsBool( int row, int col, bool value )
+{
+    m_table->SetValueAsBool( GetSourceRow(row), col, value );
+}
+
+void* wxGridSortedTable::GetValueAsCustom( int row, int col,
+                                           const wxString& typeName )
+{
+    return m_table->GetValueAsCustom( GetSourceRow(row), col, typeName );
+}
+
+void wxGridSortedTable::SetValueAsCustom( int row, int col,
+                                          const wxString& typeName,
+                                          void* value )
+{
+    m_table->SetValueAsCustom( GetSourceRow(row), col, typeName, value );
+}
+
+void wxGridSortedTable::Clear()
+{
+    m_table->Clear();
+}
+
+void wxGridSortedTable::InsertSourceRows( size_t pos, size_t srcPos,
+                                          size_t numRows )
+{
+    if ( m_rows.empty() )
+        return;
+
+    // Shift the indices of the existing rows following the inserted ones in
+    // the source table and show the new rows at the given position.
+    for ( size_t n = 0; n < m_rows.size(); n++ )
+    {
+        if ( static_cast<size_t>(m_rows[n]) >= srcPos )
+            m_rows[n] += numRows;
+    }
+
+    m_rows.insert(m_rows.begin() + pos, numRows, 0);
+    for ( size_t n = 0; n < numRows; n++ )
+        m_rows[pos + n] = srcPos + n;
+}
+
+void wxGridSortedTable::RestartSort( bool wasSorting )
+{
+    if ( wasSorting )
+    {
+        // Make a copy as Sort() assigns to m_sortKeys.
+        const wxGridSortKeys keys(m_sortKeys);
+        Sort(keys);
+    }
+}
+
+bool wxGridSortedTable::InsertRows( size_t pos, size_t numRows )
+{
+    // The background sort, if any, uses the old number of rows, so restart
+    // it after inserting the rows.
+    const bool wasSorting = IsSorting();
+    CancelSort();
+
+    // Keep the current order and just show the new rows at the given
+    // position by inserting them before the row currently shown there.
+    const size_t
+        srcPos = pos < m_rows.size() ? static_cast<size_t>(m_rows[pos]) : pos;
+
+    if ( !m_table->InsertRows( srcPos, numRows ) )
+    {
+        RestartSort( wasSorting );
+        return false;
+    }
+
+    InsertSourceRows( pos, srcPos, numRows );
+
+    NotifyView( wxGRIDTABLE_NOTIFY_ROWS_INSERTED, pos, numRows );
+
+    RestartSort( wasSorting );
+
+    return true;
+}
+
+bool wxGridSortedTable::AppendRows( size_t numRows )
+{
+    const bool wasSorting = IsSorting();
+    CancelSort();
+
+    const size_t curNumRows = GetNumberRows();
+    if ( !m_table->AppendRows( numRows ) )
+    {
+        RestartSort( wasSorting );
+        return false;
+    }
+
+    InsertSourceRows( m_rows.size(), curNumRows, numRows );
+
+    NotifyView( wxGRIDTABLE_NOTIFY_ROWS_APPENDED, numRows );
+
+    RestartSort( wasSorting );
+
+    return true;
+}
+
+bool wxGridSortedTable::DeleteRows( size_t pos, size_t numRows )
+{
+    const bool wasSorting = IsSorting();
+    CancelSort();
+
+    const size_t curNumRows = GetNumberRows();
+
+    // Without any sorting, or if the position is invalid, in which case the
+    // source table reports the error, the rows are the same as in it.
+    if ( m_rows.empty() || pos >= curNumRows )
+    {
+        if ( !m_table->DeleteRows( pos, numRows ) )
+        {
+            RestartSort( wasSorting );
+            return false;
+        }
+
+        NotifyView( wxGRIDTABLE_NOTIFY_ROWS_DELETED,
+                    pos, wxMin(numRows, curNumRows - pos) );
+
+        RestartSort( wasSorting );
+
+        return true;
+    }
+
+    numRows = wxMin(numRows, curNumRows - pos);
+
+    // Mark the source rows corresponding to the rows being deleted.
+    wxVector<char> deleted(curNumRows, 0);
+    for ( size_t n = pos; n < pos + numRows; n++ )
+        deleted[m_rows[n]] = 1;
+
+    // Delete them from the source table, starting from the last one to keep
+    // the indices of the remaining ones valid, and deleting all consecutive
+    // rows at once.
+    bool ok = true;
+    for ( size_t hi = curNumRows; hi > 0; )
+    {
+        if ( !deleted[hi - 1] )
+        {
+            hi--;
+            continue;
+        }
+
+        size_t lo = hi - 1;
+        while ( lo > 0 && deleted[lo - 1] )
+            lo--;
+
+        if ( !m_table->DeleteRows( lo, hi - lo ) )
+        {
+            // The rows before this run were not deleted.
+            for ( size_t n = 0; n < hi; n++ )
+                deleted[n] = 0;
+
+            ok = false;
+            break;
+        }
+
+        hi = lo;
+    }
+
+    // Shrink the permutation by removing the deleted rows from it and
+    // renumbering the remaining ones, and remember which rows of the view
+    // were deleted.
+    wxVector<int> newIndex(curNumRows);
+    int numDeleted = 0;
+    for ( size_t n = 0; n < curNumRows; n++ )
+    {
+        newIndex[n] = n - numDeleted;
+        if ( deleted[n] )
+            numDeleted++;
+    }
+
+    if ( !numDeleted )
+    {
+        RestartSort( wasSorting );
+        return false;
+    }
+
+    wxVector<size_t> deletedViewRows;
+    size_t numKept = 0;
+    for ( size_t n = 0; n < m_rows.size(); n++ )
+    {
+        if ( deleted[m_rows[n]] )
+            deletedViewRows.push_back(n);
+        else
+            m_rows[numKept++] = newIndex[m_rows[n]];
+    }
+
+    m_rows.resize(numKept);
+
+    if ( ok )
+    {
+        NotifyView( wxGRIDTABLE_NOTIFY_ROWS_DELETED, pos, numRows );
+    }
+    else
+    {
+        // Only some of the rows were deleted, notify about each of them,
+        // starting from the end so that the previous positions stay valid.
+        for ( size_t n = deletedViewRows.size(); n > 0; n-- )
+            NotifyView( wxGRIDTABLE_NOTIFY_ROWS_DELETED, deletedViewRows[n - 1], 1 );
+    }
+
+    RestartSort( wasSorting );
+
+    return ok;
+}
+
+bool wxGridSortedTable::InsertCols( size_t pos, size_t numCols )
+{
+    // The columns used as sort keys could be shifted, so don't keep them.
+    ResetSort();
+
+    if ( !m_table->InsertCols( pos, numCols ) )
+        return false;
+
+    NotifyView( wxGRIDTABLE_NOTIFY_COLS_INSERTED, pos, numCols );
+
+    return true;
+}
+
+bool wxGridSortedTable::AppendCols( size_t numCols )
+{
+    // Unlike inserting, appending the columns doesn't affect the sort order.
+    if ( !m_table->AppendCols( numCols ) )
+        return false;
+
+    NotifyView( wxGRIDTABLE_NOTIFY_COLS_APPENDED, numCols );
+
+    return true;
+}
+
+bool wxGridSortedTable::DeleteCols( size_t pos, size_t numCols )
+{
+    ResetSort();
+
+    const size_t curNumCols = GetNumberCols();
+    if ( !m_table->DeleteCols( pos, numCols ) )
+        return false;
+
+    NotifyView( wxGRIDTABLE_NOTIFY_COLS_DELETED,
+                pos, wxMin(numCols, curNumCols - pos) );
+
+    return true;
+}
+
+void wxGridSortedTable::SetRowLabelValue( int row, const wxString& value )
+{
+    m_table->SetRowLabelValue( GetSourceRow(row), value );
+}
+
+void wxGridSortedTable::SetColLabelValue( int col, const wxString& value )
+{
+    m_table->SetColLabelValue( col, value );
+}
+
+void wxGridSortedTable::SetCornerLabelValue( const wxString& value )
+{
+    m_table->SetCornerLabelValue( value );
+}
+
+wxString wxGridSortedTable::GetRowLabelValue( int row )
+{
+    return m_table->GetRowLabelValue( GetSourceRow(row) );
+}
+
+wxString wxGridSortedTable::GetColLabelValue( int col )
+{
+    return m_table->GetColLabelValue( col );
+}
+
+wxString wxGridSortedTable::GetCornerLabelValue() const
+{
+    return m_table->GetCornerLabelValue();
+}
 
-    m_rowLabels[row] = value;
+bool wxGridSortedTable::CanHaveAttributes()
+{
+    return m_table->CanHaveAttributes();
 }
 
-void wxGridStringTable::SetColLabelValue( int col, const wxString& value )
+wxGridCellAttr *wxGridSortedTable::GetAttr( int row, int col,
+                                            wxGridCellAttr::wxAttrKind kind )
 {
-    if ( col > (int)(m_colLabels.GetCount()) - 1 )
-    {
-        int n = m_colLabels.GetCount();
-        int i;
+    return m_table->GetAttr( row == -1 ? row : GetSourceRow(row), col, kind );
+}
 
-        for ( i = n; i <= col; i++ )
-        {
-            m_colLabels.Add( wxGridTableBase::GetColLabelValue(i) );
-        }
-    }
+bool wxGridSortedTable::CanMeasureColUsingSameAttr( int col ) const
+{
+    return m_table->CanMeasureColUsingSameAttr( col );
+}
 
-    m_colLabels[col] = value;
+void wxGridSortedTable::SetAttr( wxGridCellAttr* attr, int row, int col )
+{
+    m_table->SetAttr( attr, GetSourceRow(row), col );
 }
 
-void wxGridStringTable::SetCornerLabelValue( const wxString& value )
+void wxGridSortedTable::SetRowAttr( wxGridCellAttr *attr, int row )
 {
-    m_cornerLabel = value;
+    m_table->SetRowAttr( attr, GetSourceRow(row) );
 }
 
-wxString wxGridStringTable::GetCornerLabelValue() const
+void wxGridSortedTable::SetColAttr( wxGridCellAttr *attr, int col )
 {
-    return m_cornerLabel;
+    m_table->SetColAttr( attr, col );
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -2714,6 +4621,7 @@ wxGrid::~wxGrid()
     // Must do this or ~wxScrollHelper will pop the wrong event handler
     SetTargetWindow(this);
     ClearAttrCache();
+    delete m_renderCache;
     wxSafeDecRef(m_defaultCellAttr);
 
 #ifdef DEBUG_ATTR_CACHE
@@ -2736,6 +4644,12 @@ wxGrid::~wxGrid()
 
     delete m_setFixedRows;
     delete m_setFixedCols;
+
+    delete m_rowPositions;
+    delete m_colPositions;
+
+    delete m_autoSizeColsCache;
+    delete m_autoSizeRowsCache;
 }
 
 //
@@ -2917,9 +4831,10 @@ wxGrid::SetTable(wxGridTableBase *table,
 
         // kill row and column size arrays
         m_colWidths.Empty();
-        m_colRights.Empty();
         m_rowHeights.Empty();
-        m_rowBottoms.Empty();
+
+        ClearAutoSizeCache();
+        ClearRenderCache();
     }
 
     if (table)
@@ -2979,6 +4894,15 @@ void wxGrid::Init()
     m_setFixedRows =
     m_setFixedCols = NULL;
 
+    m_rowPositions =
+    m_colPositions = NULL;
+
+    m_autoSizeColsCache =
+    m_autoSizeRowsCache = NULL;
+    m_autoSizeMaxCells = 0;
+
+    m_renderCache = NULL;
+
     // init attr cache
     m_attrCache.row = -1;
     m_attrCache.col = -1;
@@ -3083,36 +5007,29 @@ void wxGrid::Init()
 void wxGrid::InitRowHeights()
 {
     m_rowHeights.Empty();
-    m_rowBottoms.Empty();
 
     m_rowHeights.Alloc( m_numRows );
-    m_rowBottoms.Alloc( m_numRows );
 
     m_rowHeights.Add( m_defaultRowHeight, m_numRows );
 
-    int rowBottom = 0;
-    for ( int i = 0; i < m_numRows; i++ )
-    {
-        rowBottom += m_defaultRowHeight;
-        m_rowBottoms.Add( rowBottom );
-    }
+    if ( !m_rowPositions )
+        m_rowPositions = new wxGridLinePositions;
+
+    m_rowPositions->Build( m_rowHeights, wxArrayInt() );
 }
 
 void wxGrid::InitColWidths()
 {
     m_colWidths.Empty();
-    m_colRights.Empty();
 
     m_colWidths.Alloc( m_numCols );
-    m_colRights.Alloc( m_numCols );
 
     m_colWidths.Add( m_defaultColWidth, m_numCols );
 
-    for ( int i = 0; i < m_numCols; i++ )
-    {
-        int colRight = ( GetColPos( i ) + 1 ) * m_defaultColWidth;
-        m_colRights.Add( colRight );
-    }
+    if ( !m_colPositions )
+        m_colPositions = new wxGridLinePositions;
+
+    m_colPositions->Build( m_colWidths, m_colAt );
 }
 
 int wxGrid::GetColWidth(int col) const
@@ -3126,16 +5043,16 @@ int wxGrid::GetColWidth(int col) const
 
 int wxGrid::GetColLeft(int col) const
 {
-    if ( m_colRights.IsEmpty() )
+    if ( m_colWidths.IsEmpty() )
         return GetColPos( col ) * m_defaultColWidth;
 
-    return m_colRights[col] - GetColWidth(col);
+    return m_colPositions->GetStart( GetColPos( col ) );
 }
 
 int wxGrid::GetColRight(int col) const
 {
-    return m_colRights.IsEmpty() ? (GetColPos( col ) + 1) * m_defaultColWidth
-                                 : m_colRights[col];
+    return m_colWidths.IsEmpty() ? (GetColPos( col ) + 1) * m_defaultColWidth
+                                 : m_colPositions->GetEnd( GetColPos( col ) );
 }
 
 int wxGrid::GetRowHeight(int row) const
@@ -3150,16 +5067,16 @@ int wxGrid::GetRowHeight(int row) const
 
 int wxGrid::GetRowTop(int row) const
 {
-    if ( m_rowBottoms.IsEmpty() )
+    if ( m_rowHeights.IsEmpty() )
         return row * m_defaultRowHeight;
 
-    return m_rowBottoms[row] - GetRowHeight(row);
+    return m_rowPositions->GetStart(row);
 }
 
 int wxGrid::GetRowBottom(int row) const
 {
-    return m_rowBottoms.IsEmpty() ? (row + 1) * m_defaultRowHeight
-                                  : m_rowBottoms[row];
+    return m_rowHeights.IsEmpty() ? (row + 1) * m_defaultRowHeight
+                                  : m_rowPositions->GetEnd(row);
 }
 
 void wxGrid::CalcDimensions()
@@ -3286,6 +5203,7 @@ bool wxGrid::Redimension( wxGridTableMessage& msg )
     // Clear the attribute cache as the attribute might refer to a different
     // cell than stored in the cache after adding/removing rows/columns.
     ClearAttrCache();
+    ClearRenderCache();
 
     // By the same reasoning, the editor should be dismissed if columns are
     // added or removed. And for consistency, it should IMHO always be
@@ -3306,17 +5224,19 @@ bool wxGrid::Redimension( wxGridTableMessage& msg )
             if ( !m_rowHeights.IsEmpty() )
             {
                 m_rowHeights.Insert( m_defaultRowHeight, pos, numRows );
-                m_rowBottoms.Insert( 0, pos, numRows );
 
-                int bottom = 0;
-                if ( pos > 0 )
-                    bottom = m_rowBottoms[pos - 1];
+                // Rebuilding the positions takes O(N) time, so avoid it when
+                // the rows are inserted at the end.
+                if ( static_cast<int>(pos) == m_numRows - numRows )
+                    m_rowPositions->Append( numRows, m_defaultRowHeight );
+                else
+                    m_rowPositions->Build( m_rowHeights, wxArrayInt() );
+            }
 
-                for ( i = pos; i < m_numRows; i++ )
-                {
-                    bottom += GetRowHeight(i);
-                    m_rowBottoms[i] = bottom;
-                }
+            if ( m_autoSizeColsCache )
+            {
+                m_autoSizeRowsCache->UpdateLines( pos, numRows );
+                m_autoSizeColsCache->UpdateCells( pos );
             }
 
             UpdateCurrentCellOnRedim();
@@ -3338,25 +5258,17 @@ bool wxGrid::Redimension( wxGridTableMessage& msg )
         case wxGRIDTABLE_NOTIFY_ROWS_APPENDED:
         {
             int numRows = msg.GetCommandInt();
-            int oldNumRows = m_numRows;
             m_numRows += numRows;
 
             if ( !m_rowHeights.IsEmpty() )
             {
                 m_rowHeights.Add( m_defaultRowHeight, numRows );
-                m_rowBottoms.Add( 0, numRows );
-
-                int bottom = 0;
-                if ( oldNumRows > 0 )
-                    bottom = m_rowBottoms[oldNumRows - 1];
-
-                for ( i = oldNumRows; i < m_numRows; i++ )
-                {
-                    bottom += GetRowHeight(i);
-                    m_rowBottoms[i] = bottom;
-                }
+                m_rowPositions->Append( numRows, m_defaultRowHeight );
             }
 
+            if ( m_autoSizeColsCache )
+                m_autoSizeColsCache->UpdateCells( m_numRows - numRows );
+
             UpdateCurrentCellOnRedim();
 
             CalcDimensions();
@@ -3376,14 +5288,13 @@ bool wxGrid::Redimension( wxGridTableMessage& msg )
             if ( !m_rowHeights.IsEmpty() )
             {
                 m_rowHeights.RemoveAt( pos, numRows );
-                m_rowBottoms.RemoveAt( pos, numRows );
+                m_rowPositions->Build( m_rowHeights, wxArrayInt() );
+            }
 
-                int h = 0;
-                for ( i = 0; i < m_numRows; i++ )
-                {
-                    h += GetRowHeight(i);
-                    m_rowBottoms[i] = h;
-                }
+            if ( m_autoSizeColsCache )
+            {
+                m_autoSizeRowsCache->UpdateLines( pos, -numRows );
+                m_autoSizeColsCache->UpdateCells( pos );
             }
 
             UpdateCurrentCellOnRedim();
@@ -3445,20 +5356,13 @@ bool wxGrid::Redimension( wxGridTableMessage& msg )
             if ( !m_colWidths.IsEmpty() )
             {
                 m_colWidths.Insert( m_defaultColWidth, pos, numCols );
-                m_colRights.Insert( 0, pos, numCols );
-
-                int right = 0;
-                if ( pos > 0 )
-                    right = m_colRights[GetColAt( pos - 1 )];
-
-                int colPos;
-                for ( colPos = pos; colPos < m_numCols; colPos++ )
-                {
-                    i = GetColAt( colPos );
+                m_colPositions->Build( m_colWidths, m_colAt );
+            }
 
-                    right += GetColWidth(i);
-                    m_colRights[i] = right;
-                }
+            if ( m_autoSizeColsCache )
+            {
+                m_autoSizeColsCache->UpdateLines( pos, numCols );
+                m_autoSizeRowsCache->UpdateCells( pos );
             }
 
             UpdateCurrentCellOnRedim();
@@ -3497,20 +5401,9 @@ bool wxGrid::Redimension( wxGridTableMessage& msg )
             if ( !m_colWidths.IsEmpty() )
             {
                 m_colWidths.Add( m_defaultColWidth, numCols );
-                m_colRights.Add( 0, numCols );
-
-                int right = 0;
-                if ( oldNumCols > 0 )
-                    right = m_colRights[GetColAt( oldNumCols - 1 )];
-
-                int colPos;
-                for ( colPos = oldNumCols; colPos < m_numCols; colPos++ )
-                {
-                    i = GetColAt( colPos );
 
-                    right += GetColWidth(i);
-                    m_colRights[i] = right;
-                }
+                // The new columns are always shown at the end.
+                m_colPositions->Append( numCols, m_defaultColWidth );
             }
 
             // Notice that this must be called after updating m_colWidths above
@@ -3519,6 +5412,9 @@ bool wxGrid::Redimension( wxGridTableMessage& msg )
             if ( m_useNativeHeader )
                 GetGridColHeader()->SetColumnCount(m_numCols);
 
+            if ( m_autoSizeColsCache )
+                m_autoSizeRowsCache->UpdateCells( oldNumCols );
+
             UpdateCurrentCellOnRedim();
 
             CalcDimensions();
@@ -3555,17 +5451,13 @@ bool wxGrid::Redimension( wxGridTableMessage& msg )
             if ( !m_colWidths.IsEmpty() )
             {
                 m_colWidths.RemoveAt( pos, numCols );
-                m_colRights.RemoveAt( pos, numCols );
-
-                int w = 0;
-                int colPos;
-                for ( colPos = 0; colPos < m_numCols; colPos++ )
-                {
-                    i = GetColAt( colPos );
+                m_colPositions->Build( m_colWidths, m_colAt );
+            }
 
-                    w += GetColWidth(i);
-                    m_colRights[i] = w;
-                }
+            if ( m_autoSizeColsCache )
+            {
+                m_autoSizeColsCache->UpdateLines( pos, -numCols );
+                m_autoSizeRowsCache->UpdateCells( pos );
             }
 
             UpdateCurrentCellOnRedim();
@@ -5149,24 +7041,11 @@ void wxGrid::DoEndMoveCol(int pos)
 
 void wxGrid::RefreshAfterColPosChange()
 {
-    // recalculate the column rights as the column positions have changed,
+    // recalculate the column positions as the columns order has changed,
     // unless we calculate them dynamically because all columns widths are the
     // same and it's easy to do
     if ( !m_colWidths.empty() )
-    {
-        int colRight = 0;
-        for ( int colPos = 0; colPos < m_numCols; colPos++ )
-        {
-            int colID = GetColAt( colPos );
-
-            // Ignore the currently hidden columns.
-            const int width = m_colWidths[colID];
-            if ( width > 0 )
-                colRight += width;
-
-            m_colRights[colID] = colRight;
-        }
-    }
+        m_colPositions->Build( m_colWidths, m_colAt );
 
     // and make the changes visible
     if ( m_useNativeHeader )
@@ -5766,7 +7645,6 @@ void wxGrid::OnDPIChanged(wxDPIChangedEvent& event)
     // inside InitPixelFields() above).
     if ( !m_rowHeights.empty() )
     {
-        int total = 0;
         for ( unsigned i = 0; i < m_rowHeights.size(); ++i )
         {
             int height = m_rowHeights[i];
@@ -5776,11 +7654,11 @@ void wxGrid::OnDPIChanged(wxDPIChangedEvent& event)
                 continue;
 
             height = height * event.GetNewDPI().x / event.GetOldDPI().x;
-            total += height;
 
             m_rowHeights[i] = height;
-            m_rowBottoms[i] = total;
         }
+
+        m_rowPositions->Build( m_rowHeights, wxArrayInt() );
     }
 
     // Similarly for columns, except that here we need to update the native
@@ -5790,7 +7668,6 @@ void wxGrid::OnDPIChanged(wxDPIChangedEvent& event)
         colHeader = m_useNativeHeader ? GetGridColHeader() : NULL;
     if ( !m_colWidths.empty() )
     {
-        int total = 0;
         for ( unsigned i = 0; i < m_colWidths.size(); ++i )
         {
             int width = m_colWidths[i];
@@ -5799,14 +7676,14 @@ void wxGrid::OnDPIChanged(wxDPIChangedEvent& event)
                 continue;
 
             width = width * event.GetNewDPI().x / event.GetOldDPI().x;
-            total += width;
 
             m_colWidths[i] = width;
-            m_colRights[i] = total;
 
             if ( colHeader )
                 colHeader->UpdateColumn(i);
         }
+
+        m_colPositions->Build( m_colWidths, m_colAt );
     }
     else if ( colHeader )
     {
@@ -6476,7 +8353,24 @@ void wxGrid::DrawCell( wxDC& dc, const wxGridCellCoords& coords )
         return;
 
     // we draw the cell border ourselves
-    wxGridCellAttrPtr attr = GetCellAttrPtr(row, col);
+    wxGridCellAttrPtr attr;
+    wxGridCellRendererPtr renderer;
+    if ( const wxGridRenderCacheEntry* const
+            entry = m_renderCache ? m_renderCache->Get(row, col) : NULL )
+    {
+        attr = wxGridCellAttrPtr(entry->attr);
+        attr->IncRef();
+        renderer = wxGridCellRendererPtr(entry->renderer);
+        renderer->IncRef();
+    }
+    else
+    {
+        attr = GetCellAttrPtr(row, col);
+        renderer = attr->GetRendererPtr(this, row, col);
+
+        if ( m_renderCache )
+            m_renderCache->Set(row, col, attr.get(), renderer.get());
+    }
 
     bool isCurrent = coords == m_currentCellCoords;
 
@@ -6491,8 +8385,7 @@ void wxGrid::DrawCell( wxDC& dc, const wxGridCellCoords& coords )
     else
     {
         // but all the rest is drawn by the cell renderer and hence may be customized
-        attr->GetRendererPtr(this, row, col)
-            ->Draw(*this, *attr, dc, rect, row, col, IsInSelection(coords));
+        renderer->Draw(*this, *attr, dc, rect, row, col, IsInSelection(coords));
     }
 }
 
@@ -7170,7 +9063,25 @@ void wxGrid::DrawTextRectangle(wxDC& dc,
 
         wxCoord lineWidth = 0,
              lineHeight = 0;
-        dc.GetTextExtent(line, &lineWidth, &lineHeight);
+        if ( nLines == 1 )
+        {
+            // The extent of the only line was already computed above, there
+            // is no need to measure it again.
+            if ( textOrientation == wxHORIZONTAL )
+            {
+                lineWidth = textWidth;
+                lineHeight = textHeight;
+            }
+            else
+            {
+                lineWidth = textHeight;
+                lineHeight = textWidth;
+            }
+        }
+        else
+        {
+            dc.GetTextExtent(line, &lineWidth, &lineHeight);
+        }
 
         switch ( horizAlign )
         {
@@ -7238,6 +9149,15 @@ void wxGrid::DrawTextRectangle(wxDC& dc,
 // TODO: refactor wxTextFile::Read() and reuse the same code from here
 void wxGrid::StringToLines( const wxString& value, wxArrayString& lines ) const
 {
+    // Most cells contain a single line of text, so avoid translating and
+    // copying it when there is nothing to split.
+    if ( value.find_first_of(wxS("\r\n")) == wxString::npos )
+    {
+        if ( !value.empty() )
+            lines.Add( value );
+        return;
+    }
+
     int startPos = 0;
     wxString eol = wxTextFile::GetEOL( wxTextFileType_Unix );
     wxString tVal = wxTextFile::Translate( value, wxTextFileType_Unix );
@@ -7319,6 +9239,9 @@ void wxGrid::EndBatch()
 //
 void wxGrid::ForceRefresh()
 {
+    ClearAttrCache();
+    ClearRenderCache();
+
     BeginBatch();
     EndBatch();
 }
@@ -7727,6 +9650,7 @@ void wxGrid::DoSaveEditControlValue()
         case Event_Unhandled:
         case Event_Handled:
             editor->ApplyEdit(row, col, this);
+            InvalidateCellAutoSize(row, col);
 
             // for compatibility reasons dating back to wx 2.8 when this event
             // was called wxEVT_GRID_CELL_CHANGE and wxEVT_GRID_CELL_CHANGING
@@ -7760,9 +9684,8 @@ wxGridCellCoords wxGrid::XYToCell(int x, int y, wxGridWindow *gridWindow) const
 }
 
 // compute row or column from some (unscrolled) coordinate value, using either
-// m_defaultRowHeight/m_defaultColWidth or binary search on array of
-// m_rowBottoms/m_colRights to do it quickly in O(log n) time.
-// NOTE: This may not work correctly for reordered columns.
+// m_defaultRowHeight/m_defaultColWidth or m_rowPositions/m_colPositions to do
+// it quickly in O(log n) time.
 int wxGrid::PosToLinePos(int coord,
                          bool clipToMinMax,
                          const wxGridOperations& oper,
@@ -7781,8 +9704,8 @@ int wxGrid::PosToLinePos(int coord,
 
     // check for the simplest case: if we have no explicit line sizes
     // configured, then we already know the line this position falls in
-    const wxArrayInt& lineEnds = oper.GetLineEnds(this);
-    if ( lineEnds.empty() )
+    const wxGridLinePositions* const positions = oper.GetLinePositions(this);
+    if ( !positions )
     {
         if ( maxPos < (numLines + minPos) )
             return maxPos;
@@ -7790,45 +9713,24 @@ int wxGrid::PosToLinePos(int coord,
         return clipToMinMax ? numLines + minPos - 1 : -1;
     }
 
-    // binary search is quite efficient and we can't really make any assumptions
-    // on where to start here since row and columns could be of size 0 if they are
-    // hidden. While this could be made more efficient, some profiling will be
-    // necessary to determine if it really is a performance bottleneck
-    maxPos = numLines + minPos - 1;
+    if ( numLines <= 0 )
+        return wxNOT_FOUND;
 
-    // check if the position is beyond the last column
-    const int lineAtMaxPos = oper.GetLineAt(this, maxPos);
-    if ( coord >= lineEnds[lineAtMaxPos] )
-        return clipToMinMax ? maxPos : wxNOT_FOUND;
+    maxPos = numLines + minPos - 1;
 
-    // or before the first one
-    const int lineAt0 = oper.GetLineAt(this, minPos);
-    if ( coord < oper.GetLineStartPos(this, lineAt0) )
+    // check if the position is before the first line
+    if ( coord < positions->GetStart(minPos) )
         return clipToMinMax ? minPos : wxNOT_FOUND;
-    else if ( coord < lineEnds[lineAt0] )
-        return minPos;
-
-    // finally do perform the binary search
-    while ( minPos < maxPos )
-    {
-        wxCHECK_MSG( lineEnds[oper.GetLineAt(this, minPos)] <= coord &&
-                        coord < lineEnds[oper.GetLineAt(this, maxPos)],
-                     -1,
-                     "wxGrid: internal error in PosToLinePos()" );
 
-        if ( coord >= lineEnds[oper.GetLineAt(this, maxPos - 1)] )
-            return maxPos;
-        else
-            maxPos--;
+    // the lines positions are stored in display order, so this takes into
+    // account both reordered and hidden (i.e. of size 0) lines
+    const int pos = positions->FindPos(coord);
 
-        const int median = minPos + (maxPos - minPos + 1) / 2;
-        if ( coord < lineEnds[oper.GetLineAt(this, median)] )
-            maxPos = median;
-        else
-            minPos = median;
-    }
+    // check if the position is beyond the last line
+    if ( pos > maxPos )
+        return clipToMinMax ? maxPos : wxNOT_FOUND;
 
-    return maxPos;
+    return pos;
 }
 
 int
@@ -9198,6 +11100,7 @@ void wxGrid::SetDefaultCellFitMode(wxGridFitMode fitMode)
 void wxGrid::SetDefaultCellFont( const wxFont& font )
 {
     m_defaultCellAttr->SetFont(font);
+    ClearAutoSizeCache();
 }
 
 // For editors and renderers the type registry takes precedence over the
@@ -9343,6 +11246,31 @@ void wxGrid::RefreshAttr(int row, int col)
 {
     if ( m_attrCache.row == row && m_attrCache.col == col )
         ClearAttrCache();
+
+    InvalidateRenderCache(row, col);
+}
+
+void wxGrid::EnableRenderCache(bool enable)
+{
+    if ( enable == IsRenderCacheEnabled() )
+        return;
+
+    if ( enable )
+        m_renderCache = new wxGridRenderCache;
+    else
+        wxDELETE(m_renderCache);
+}
+
+void wxGrid::InvalidateRenderCache(int row, int col) const
+{
+    if ( m_renderCache )
+        m_renderCache->Invalidate(row, col);
+}
+
+void wxGrid::ClearRenderCache() const
+{
+    if ( m_renderCache )
+        m_renderCache->Clear();
 }
 
 
@@ -9419,6 +11347,10 @@ wxGridCellAttr *wxGrid::GetOrCreateCellAttr(int row, int col) const
     wxCHECK_MSG( canHave, attr, wxT("Cell attributes not allowed"));
     wxCHECK_MSG( m_table, attr, wxT("must have a table") );
 
+    // The returned attribute is going to be modified, so the cell needs to
+    // be resolved again when it's drawn the next time.
+    InvalidateRenderCache(row, col);
+
     attr = m_table->GetAttr(row, col, wxGridCellAttr::Cell);
     if ( !attr )
     {
@@ -9491,6 +11423,8 @@ void wxGrid::SetAttr(int row, int col, wxGridCellAttr *attr)
     {
         m_table->SetAttr(attr, row, col);
         ClearAttrCache();
+        InvalidateRenderCache(row, col);
+        InvalidateCellAutoSize(row, col);
     }
     else
     {
@@ -9504,6 +11438,8 @@ void wxGrid::SetRowAttr(int row, wxGridCellAttr *attr)
     {
         m_table->SetRowAttr(attr, row);
         ClearAttrCache();
+        ClearRenderCache();
+        InvalidateCellAutoSize(row, -1);
     }
     else
     {
@@ -9517,6 +11453,8 @@ void wxGrid::SetColAttr(int col, wxGridCellAttr *attr)
     {
         m_table->SetColAttr(attr, col);
         ClearAttrCache();
+        ClearRenderCache();
+        InvalidateCellAutoSize(-1, col);
     }
     else
     {
@@ -9545,6 +11483,7 @@ void wxGrid::SetCellFont( int row, int col, const wxFont& font )
     if ( CanHaveAttributes() )
     {
         GetOrCreateCellAttrPtr(row, col)->SetFont(font);
+        InvalidateCellAutoSize(row, col);
     }
 }
 
@@ -9568,6 +11507,10 @@ void wxGrid::SetCellSize( int row, int col, int num_rows, int num_cols )
 {
     if ( CanHaveAttributes() )
     {
+        // Invalidate the cells covered by this cell before and after changing
+        // its size.
+        InvalidateCellAutoSize(row, col);
+
         int cell_rows, cell_cols;
 
         wxGridCellAttrPtr attr = GetOrCreateCellAttrPtr(row, col);
@@ -9615,6 +11558,8 @@ void wxGrid::SetCellSize( int row, int col, int num_rows, int num_cols )
                 }
             }
         }
+
+        InvalidateCellAutoSize(row, col);
     }
 }
 
@@ -9623,6 +11568,7 @@ void wxGrid::SetCellRenderer(int row, int col, wxGridCellRenderer *renderer)
     if ( CanHaveAttributes() )
     {
         GetOrCreateCellAttrPtr(row, col)->SetRenderer(renderer);
+        InvalidateCellAutoSize(row, col);
     }
 }
 
@@ -9651,6 +11597,10 @@ void wxGrid::RegisterDataType(const wxString& typeName,
                               wxGridCellEditor* editor)
 {
     m_typeRegistry->RegisterDataType(typeName, renderer, editor);
+
+    // The cells of this type may be rendered differently now.
+    ClearAutoSizeCache();
+    ClearRenderCache();
 }
 
 
@@ -9745,12 +11695,13 @@ void wxGrid::SetDefaultRowSize( int height, bool resizeExistingRows )
     if ( resizeExistingRows )
     {
         // since we are resizing all rows to the default row size,
-        // we can simply clear the row heights and row bottoms
-        // arrays (which also allows us to take advantage of
-        // some speed optimisations)
+        // we can simply clear the row heights array (which also
+        // allows us to take advantage of some speed optimisations)
         m_rowHeights.Empty();
-        m_rowBottoms.Empty();
         CalcDimensions();
+
+        if ( m_autoSizeColsCache )
+            m_autoSizeColsCache->Clear();
     }
 }
 
@@ -9850,10 +11801,13 @@ void wxGrid::DoSetRowSize( int row, int height )
     if ( !diff )
         return;
 
-    for ( int i = row; i < m_numRows; i++ )
-    {
-        m_rowBottoms[i] += diff;
-    }
+    // The best widths of the cells of this row may depend on its height and
+    // hidden rows are not measured at all, so the cached extents of the
+    // blocks containing it can't be reused any more.
+    if ( m_autoSizeColsCache )
+        m_autoSizeColsCache->InvalidateCell(-1, row);
+
+    m_rowPositions->Update(row, diff);
 
     InvalidateBestSize();
 
@@ -9955,13 +11909,14 @@ void wxGrid::SetDefaultColSize( int width, bool resizeExistingCols )
     if ( resizeExistingCols )
     {
         // since we are resizing all columns to the default column size,
-        // we can simply clear the col widths and col rights
-        // arrays (which also allows us to take advantage of
-        // some speed optimisations)
+        // we can simply clear the col widths array (which also
+        // allows us to take advantage of some speed optimisations)
         m_colWidths.Empty();
-        m_colRights.Empty();
 
         CalcDimensions();
+
+        if ( m_autoSizeRowsCache )
+            m_autoSizeRowsCache->Clear();
     }
 }
 
@@ -10027,6 +11982,11 @@ void wxGrid::DoSetColSize( int col, int width )
     if ( !diff )
         return;
 
+    // As in DoSetRowSize(), the best heights of the cells depend on the
+    // column width and visibility.
+    if ( m_autoSizeRowsCache )
+        m_autoSizeRowsCache->InvalidateCell(-1, col);
+
     if ( m_useNativeHeader )
     {
         // We have to update the native control if we're called from the
@@ -10040,10 +12000,7 @@ void wxGrid::DoSetColSize( int col, int width )
     }
     //else: will be refreshed when the header is redrawn
 
-    for ( int colPos = GetColPos(col); colPos < m_numCols; colPos++ )
-    {
-        m_colRights[GetColAt(colPos)] += diff;
-    }
+    m_colPositions->Update(GetColPos(col), diff);
 
     InvalidateBestSize();
 
@@ -10260,87 +12217,184 @@ wxGrid::AutoSizeColOrRow(int colOrRow, bool setAsMin, wxGridDirection direction)
     wxGridCellRendererPtr renderer;
 
     wxCoord extent, extentMax = 0;
-    int max = column ? m_numRows : m_numCols;
-    for ( int rowOrCol = 0; rowOrCol < max; rowOrCol++ )
+    const int max = column ? m_numRows : m_numCols;
+
+    bool done = false;
+    if ( canReuseAttr && max > 0 )
     {
-        if ( column )
+        attr = GetCellAttrPtr(0, col);
+        renderer = attr->GetRendererPtr(this, 0, col);
+
+        // Try to get the best width for the entire column at once, if it's
+        // supported by the renderer.
+        extent = renderer->GetMaxBestSize(*this, *attr, dc).x;
+
+        if ( extent != wxDefaultCoord )
         {
-            if ( !IsRowShown(rowOrCol) )
-                continue;
+            extentMax = extent;
 
-            row = rowOrCol;
-            col = colOrRow;
+            // No need to check all the values.
+            done = true;
         }
-        else
+    }
+
+    // The cells are measured in blocks, whose extents are cached if the cache
+    // is enabled and which are also used for limiting the number of cells to
+    // measure, if necessary, by only measuring some of the blocks.
+    const int blockSize = wxGridAutoSizeCache::BLOCK_SIZE;
+    wxGridAutoSizeCache* const
+        cache = column ? m_autoSizeColsCache : m_autoSizeRowsCache;
+
+    const int numBlocks = (max + blockSize - 1) / blockSize;
+    int numBlocksToMeasure = numBlocks;
+    if ( m_autoSizeMaxCells > 0 )
+    {
+        numBlocksToMeasure = wxMin(numBlocksToMeasure,
+                                   (m_autoSizeMaxCells + blockSize - 1) / blockSize);
+    }
+
+    // When reusing the same renderer, try to measure all the cells of the
+    // block at once, this is only possible for the columns and there are no
+    // cells spanning multiple columns/rows in this case, as they would need
+    // to have different attributes.
+    bool canMeasureBlock = canReuseAttr;
+    wxArrayInt rowsInBlock;
+
+    for ( int n = 0; n < numBlocksToMeasure && !done; n++ )
+    {
+        // Spread the measured blocks evenly if we don't measure all of them.
+        const int block = numBlocksToMeasure == numBlocks
+                            ? n
+                            : static_cast<int>(static_cast<double>(n) *
+                                                numBlocks / numBlocksToMeasure);
+
+        if ( cache )
         {
-            if ( !IsColShown(rowOrCol) )
+            const int extentBlock = cache->Get(colOrRow, block);
+            if ( extentBlock != -1 )
+            {
+                if ( extentBlock > extentMax )
+                    extentMax = extentBlock;
                 continue;
-
-            row = colOrRow;
-            col = rowOrCol;
+            }
         }
 
-        // we need to account for the cells spanning multiple columns/rows:
-        // while they may need a lot of space, they don't need all of it in
-        // this column/row
-        int numRows, numCols;
-        const CellSpan span = GetCellSize(row, col, &numRows, &numCols);
-        if ( span == CellSpan_Inside )
-        {
-            // we need to get the size of the main cell, not of a cell hidden
-            // by it
-            row += numRows;
-            col += numCols;
+        wxCoord extentBlockMax = 0;
 
-            // get the size of the main cell too
-            GetCellSize(row, col, &numRows, &numCols);
-        }
+        const int first = block*blockSize;
+        const int last = wxMin(first + blockSize, max);
 
-        // get cell ( main cell if CellSpan_Inside ) renderer best size
-        if ( !canReuseAttr || !attr )
+        rowsInBlock.clear();
+        for ( int rowOrCol = first; rowOrCol < last; rowOrCol++ )
         {
+            if ( column )
+            {
+                if ( !IsRowShown(rowOrCol) )
+                    continue;
+
+                row = rowOrCol;
+                col = colOrRow;
+            }
+            else
+            {
+                if ( !IsColShown(rowOrCol) )
+                    continue;
+
+                row = colOrRow;
+                col = rowOrCol;
+            }
+
+            if ( canReuseAttr )
+            {
+                if ( canMeasureBlock )
+                {
+                    rowsInBlock.push_back(row);
+                }
+                else
+                {
+                    extent = renderer->GetBestWidth(*this, *attr, dc, row, col,
+                                                    GetRowHeight(row));
+                    if ( extent > extentBlockMax )
+                        extentBlockMax = extent;
+                }
+
+                continue;
+            }
+
+            // we need to account for the cells spanning multiple columns/rows:
+            // while they may need a lot of space, they don't need all of it in
+            // this column/row
+            int numRows, numCols;
+            const CellSpan span = GetCellSize(row, col, &numRows, &numCols);
+            if ( span == CellSpan_Inside )
+            {
+                // we need to get the size of the main cell, not of a cell hidden
+                // by it
+                row += numRows;
+                col += numCols;
+
+                // get the size of the main cell too
+                GetCellSize(row, col, &numRows, &numCols);
+            }
+
+            // get cell ( main cell if CellSpan_Inside ) renderer best size
             attr = GetCellAttrPtr(row, col);
             renderer = attr->GetRendererPtr(this, row, col);
 
-            if ( canReuseAttr )
+            if ( renderer )
             {
-                // Try to get the best width for the entire column at once, if
-                // it's supported by the renderer.
-                extent = renderer->GetMaxBestSize(*this, *attr, dc).x;
+                extent = column
+                            ? renderer->GetBestWidth(*this, *attr, dc, row, col,
+                                                     GetRowHeight(row))
+                            : renderer->GetBestHeight(*this, *attr, dc, row, col,
+                                                      GetColWidth(col));
 
-                if ( extent != wxDefaultCoord )
+                if ( span != CellSpan_None )
                 {
-                    extentMax = extent;
-
-                    // No need to check all the values.
-                    break;
+                    // we spread the size of a spanning cell over all the cells it
+                    // covers evenly -- this is probably not ideal but we can't
+                    // really do much better here
+                    //
+                    // notice that numCols and numRows are never 0 as they
+                    // correspond to the size of the main cell of the span and not
+                    // of the cell inside it
+                    extent /= column ? numCols : numRows;
                 }
+
+                if ( extent > extentBlockMax )
+                    extentBlockMax = extent;
             }
         }
 
-        if ( renderer )
+        if ( !rowsInBlock.empty() )
         {
-            extent = column
-                        ? renderer->GetBestWidth(*this, *attr, dc, row, col,
-                                                 GetRowHeight(row))
-                        : renderer->GetBestHeight(*this, *attr, dc, row, col,
-                                                  GetColWidth(col));
-
-            if ( span != CellSpan_None )
+            extent = renderer->GetMaxBestWidth(*this, *attr, dc, rowsInBlock, col);
+            if ( extent == wxDefaultCoord )
             {
-                // we spread the size of a spanning cell over all the cells it
-                // covers evenly -- this is probably not ideal but we can't
-                // really do much better here
-                //
-                // notice that numCols and numRows are never 0 as they
-                // correspond to the size of the main cell of the span and not
-                // of the cell inside it
-                extent /= column ? numCols : numRows;
+                // Not supported by this renderer, don't try it again and
+                // measure the cells one by one instead.
+                canMeasureBlock = false;
+
+                extent = 0;
+                for ( size_t i = 0; i < rowsInBlock.size(); i++ )
+                {
+                    row = rowsInBlock[i];
+                    extent = wxMax(extent,
+                                   renderer->GetBestWidth(*this, *attr, dc,
+                                                          row, col,
+                                                          GetRowHeight(row)));
+                }
             }
 
-            if ( extent > extentMax )
-                extentMax = extent;
+            if ( extent > extentBlockMax )
+                extentBlockMax = extent;
         }
+
+        if ( cache )
+            cache->Set(colOrRow, block, extentBlockMax);
+
+        if ( extentBlockMax > extentMax )
+            extentMax = extentBlockMax;
     }
 
     // now also compare with the column label extent
@@ -10573,6 +12627,79 @@ void wxGrid::AutoSizeColLabelSize( int col )
     ForceRefresh();
 }
 
+void wxGrid::EnableAutoSizeCache(bool enable)
+{
+    if ( enable == IsAutoSizeCacheEnabled() )
+        return;
+
+    if ( enable )
+    {
+        m_autoSizeColsCache = new wxGridAutoSizeCache;
+        m_autoSizeRowsCache = new wxGridAutoSizeCache;
+    }
+    else
+    {
+        wxDELETE(m_autoSizeColsCache);
+        wxDELETE(m_autoSizeRowsCache);
+    }
+}
+
+void wxGrid::InvalidateCellAutoSize(int row, int col)
+{
+    if ( !m_autoSizeColsCache )
+        return;
+
+    if ( row == -1 && col == -1 )
+    {
+        ClearAutoSizeCache();
+    }
+    else if ( row == -1 )
+    {
+        // The entire column has changed.
+        m_autoSizeColsCache->InvalidateLine(col);
+        m_autoSizeRowsCache->InvalidateCell(-1, col);
+    }
+    else if ( col == -1 )
+    {
+        // And here the entire row.
+        m_autoSizeRowsCache->InvalidateLine(row);
+        m_autoSizeColsCache->InvalidateCell(-1, row);
+    }
+    else
+    {
+        // The size of the cell spanning several rows or columns is taken
+        // into account for all of them, so invalidate all of them.
+        int numRows, numCols;
+        if ( GetCellSize(row, col, &numRows, &numCols) != CellSpan_Main )
+            numRows = numCols = 1;
+
+        for ( int r = row; r < row + numRows; r++ )
+        {
+            for ( int c = col; c < col + numCols; c++ )
+            {
+                m_autoSizeColsCache->InvalidateCell(c, r);
+                m_autoSizeRowsCache->InvalidateCell(r, c);
+            }
+        }
+    }
+}
+
+void wxGrid::ClearAutoSizeCache()
+{
+    if ( !m_autoSizeColsCache )
+        return;
+
+    m_autoSizeColsCache->Clear();
+    m_autoSizeRowsCache->Clear();
+}
+
+void wxGrid::SetAutoSizeMaxCells(int maxCells)
+{
+    wxCHECK_RET( maxCells >= 0, "invalid number of cells" );
+
+    m_autoSizeMaxCells = maxCells;
+}
+
 wxSize wxGrid::DoGetBestSize() const
 {
     wxSize size(m_rowLabelWidth + m_extraWidth,
@@ -10584,8 +12711,7 @@ wxSize wxGrid::DoGetBestSize() const
     }
     else
     {
-        for ( int col = 0; col < m_numCols; col++ )
-            size.x += GetColWidth(col);
+        size.x += m_colPositions->GetStart(m_numCols);
     }
 
     if ( m_rowHeights.empty() )
@@ -10594,8 +12720,7 @@ wxSize wxGrid::DoGetBestSize() const
     }
     else
     {
-        for ( int row = 0; row < m_numRows; row++ )
-            size.y += GetRowHeight(row);
+        size.y += m_rowPositions->GetStart(m_numRows);
     }
 
     return size + GetWindowBorderSize();
@@ -10633,6 +12758,8 @@ void wxGrid::SetCellValue( int row, int col, const wxString& s )
     if ( m_table )
     {
         m_table->SetValue( row, col, s );
+        InvalidateCellAutoSize( row, col );
+
         if ( ShouldRefresh() )
         {
             int dummy;
@@ -10671,6 +12798,17 @@ void wxGrid::SelectRow( int row, bool addToSelected )
     m_selection->SelectRow(row);
 }
 
+void wxGrid::SelectRows( const wxArrayInt& rows, bool addToSelected )
+{
+    if ( !m_selection )
+        return;
+
+    if ( !addToSelected )
+        ClearSelection();
+
+    m_selection->SelectRows(rows);
+}
+
 void wxGrid::SelectCol( int col, bool addToSelected )
 {
     if ( !m_selection )
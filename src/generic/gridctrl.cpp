@@ -27,6 +27,7 @@
 
 #include "wx/tokenzr.h"
 #include "wx/renderer.h"
+#include "wx/private/textmeasure.h"
 
 #include "wx/generic/private/grid.h"
 #include "wx/private/window.h"
@@ -69,6 +70,17 @@ void wxGridCellRenderer::Draw(wxGrid& grid,
     dc.DrawRectangle(rect);
 }
 
+// Changing the font or the colours of the DC is not free for all of its
+// implementations (e.g. wxGCDC recreates its native font every time), so avoid
+// doing it when consecutive cells use the same ones, as is usually the case.
+static void SetDCTextColours(wxDC& dc, const wxColour& back, const wxColour& fore)
+{
+    if ( dc.GetTextBackground() != back )
+        dc.SetTextBackground(back);
+    if ( dc.GetTextForeground() != fore )
+        dc.SetTextForeground(fore);
+}
+
 void wxGridCellRenderer::SetTextColoursAndFont(const wxGrid& grid,
                                                const wxGridCellAttr& attr,
                                                wxDC& dc,
@@ -88,22 +100,25 @@ void wxGridCellRenderer::SetTextColoursAndFont(const wxGrid& grid,
                 clr = grid.GetSelectionBackground();
             else
                 clr = wxSystemSettings::GetColour(wxSYS_COLOUR_BTNSHADOW);
-            dc.SetTextBackground( clr );
-            dc.SetTextForeground( grid.GetSelectionForeground() );
+            SetDCTextColours(dc, clr, grid.GetSelectionForeground());
         }
         else
         {
-            dc.SetTextBackground( attr.GetBackgroundColour() );
-            dc.SetTextForeground( attr.GetTextColour() );
+            SetDCTextColours(dc, attr.GetBackgroundColour(), attr.GetTextColour());
         }
     }
     else
     {
-        dc.SetTextBackground(wxSystemSettings::GetColour(wxSYS_COLOUR_BTNFACE));
-        dc.SetTextForeground(wxSystemSettings::GetColour(wxSYS_COLOUR_GRAYTEXT));
+        SetDCTextColours(dc,
+                         wxSystemSettings::GetColour(wxSYS_COLOUR_BTNFACE),
+                         wxSystemSettings::GetColour(wxSYS_COLOUR_GRAYTEXT));
     }
 
-    dc.SetFont( attr.GetFont() );
+    // Only compare the font data pointers and not the fonts themselves, as
+    // the latter could be more expensive than just setting the font.
+    const wxFont& font = attr.GetFont();
+    if ( font.GetRefData() != dc.GetFont().GetRefData() )
+        dc.SetFont(font);
 }
 
 // ----------------------------------------------------------------------------
@@ -625,6 +640,56 @@ wxSize wxGridCellStringRenderer::GetBestSize(wxGrid& grid,
     return DoGetBestSize(attr, dc, grid.GetCellValue(row, col));
 }
 
+int wxGridCellStringRenderer::DoGetMaxBestWidth(const wxGridCellAttr& attr,
+                                                wxDC& dc,
+                                                const wxArrayString& texts)
+{
+    // wxTextMeasure only measures single line strings, so split the multiline
+    // ones into separate lines.
+    wxArrayString lines;
+    lines.reserve(texts.size());
+    for ( size_t n = 0; n < texts.size(); n++ )
+    {
+        const wxString& text = texts[n];
+        if ( text.find('\n') == wxString::npos )
+        {
+            lines.push_back(text);
+        }
+        else
+        {
+            const wxArrayString textLines = wxSplit(text, '\n', '\0');
+            for ( size_t i = 0; i < textLines.size(); i++ )
+                lines.push_back(textLines[i]);
+        }
+    }
+
+    if ( lines.empty() )
+        return 0;
+
+    const wxFont font = attr.GetFont();
+    return wxTextMeasure(&dc, &font).GetLargestStringExtent(lines).x;
+}
+
+int wxGridCellStringRenderer::GetMaxBestWidth(wxGrid& grid,
+                                              wxGridCellAttr& attr,
+                                              wxDC& dc,
+                                              const wxArrayInt& rows,
+                                              int col)
+{
+    wxArrayString texts;
+    texts.reserve(rows.size());
+    for ( size_t n = 0; n < rows.size(); n++ )
+        texts.push_back(GetDisplayString(grid, rows[n], col));
+
+    return DoGetMaxBestWidth(attr, dc, texts);
+}
+
+wxString wxGridCellStringRenderer::GetDisplayString(const wxGrid& grid,
+                                                    int row, int col)
+{
+    return grid.GetCellValue(row, col);
+}
+
 void wxGridCellStringRenderer::Draw(wxGrid& grid,
                                     wxGridCellAttr& attr,
                                     wxDC& dc,
@@ -25,6 +25,8 @@
 #include "wx/generic/gridsel.h"
 #include "wx/dynarray.h"
 
+#include <algorithm>
+
 
 namespace
 {
@@ -39,12 +41,208 @@ int CompareInts(int n1, int n2)
 
 WX_DEFINE_SORTED_ARRAY_CMP_INT(int, CompareInts, wxIntSortedArray);
 
+// ----------------------------------------------------------------------------
+// wxGridSelectionIndex
+// ----------------------------------------------------------------------------
+
+// This class indexes the selected blocks by the ranges of rows they cover,
+// except for the blocks covering all rows, i.e. the selected columns, which
+// are indexed by the ranges of their columns instead. Each of these ranges
+// is stored in an interval tree, allowing to find the blocks containing the
+// given cell in logarithmic time.
+class wxGridSelectionIndex
+{
+public:
+    wxGridSelectionIndex() { }
+
+    // Index the given number of the first blocks.
+    void Build(const wxVectorGridBlockCoords& blocks, size_t count, int numRows);
+
+    void Clear()
+    {
+        m_rows.Clear();
+        m_cols.Clear();
+    }
+
+    // Return true if the cell is contained in one of the indexed blocks.
+    bool Contains(const wxVectorGridBlockCoords& blocks, int row, int col) const
+    {
+        return m_rows.Contains(blocks, row, col, true) ||
+                m_cols.Contains(blocks, col, row, false);
+    }
+
+private:
+    // Static interval tree stored as a sorted array of intervals, with the
+    // interval in the middle of each subarray being the root of the subtree
+    // corresponding to it.
+    class IntervalTree
+    {
+    public:
+        IntervalTree() { }
+
+        void Add(int start, int end, size_t block)
+        {
+            const Interval interval = { start, end, block };
+            m_intervals.push_back(interval);
+        }
+
+        // Must be called after adding all intervals.
+        void Build();
+
+        void Clear()
+        {
+            m_intervals.clear();
+            m_maxEnds.clear();
+        }
+
+        // Return true if any block with the interval containing the given
+        // position also contains the other coordinate in the other direction.
+        bool Contains(const wxVectorGridBlockCoords& blocks,
+                      int pos, int other, bool byRows) const
+        {
+            return DoContains(blocks, 0, m_intervals.size(), pos, other, byRows);
+        }
+
+    private:
+        struct Interval
+        {
+            int start, end;
+            size_t block;
+        };
+
+        static bool CompareIntervals(const Interval& i1, const Interval& i2)
+        {
+            return i1.start < i2.start;
+        }
+
+        int DoBuild(size_t lo, size_t hi);
+
+        bool DoContains(const wxVectorGridBlockCoords& blocks,
+                        size_t lo, size_t hi,
+                        int pos, int other, bool byRows) const;
+
+        // The intervals sorted by their start.
+        wxVector<Interval> m_intervals;
+
+        // The maximal end of all the intervals in the subtree with the root at
+        // the given index.
+        wxVector<int> m_maxEnds;
+    };
+
+    IntervalTree m_rows,
+                 m_cols;
+
+    wxDECLARE_NO_COPY_CLASS(wxGridSelectionIndex);
+};
+
+void
+wxGridSelectionIndex::Build(const wxVectorGridBlockCoords& blocks,
+                            size_t count,
+                            int numRows)
+{
+    Clear();
+
+    for ( size_t n = 0; n < count; n++ )
+    {
+        const wxGridBlockCoords& block = blocks[n];
+        if ( block.GetTopRow() == 0 && block.GetBottomRow() >= numRows - 1 )
+            m_cols.Add(block.GetLeftCol(), block.GetRightCol(), n);
+        else
+            m_rows.Add(block.GetTopRow(), block.GetBottomRow(), n);
+    }
+
+    m_rows.Build();
+    m_cols.Build();
+}
+
+void wxGridSelectionIndex::IntervalTree::Build()
+{
+    std::sort(m_intervals.begin(), m_intervals.end(), CompareIntervals);
+
+    m_maxEnds.resize(m_intervals.size());
+    DoBuild(0, m_intervals.size());
+}
+
+int wxGridSelectionIndex::IntervalTree::DoBuild(size_t lo, size_t hi)
+{
+    if ( lo == hi )
+        return -1;
+
+    const size_t mid = lo + (hi - lo) / 2;
+
+    int maxEnd = m_intervals[mid].end;
+    maxEnd = wxMax(maxEnd, DoBuild(lo, mid));
+    maxEnd = wxMax(maxEnd, DoBuild(mid + 1, hi));
+
+    m_maxEnds[mid] = maxEnd;
+
+    return maxEnd;
+}
+
+bool
+wxGridSelectionIndex::IntervalTree::DoContains(const wxVectorGridBlockCoords& blocks,
+                                               size_t lo, size_t hi,
+                                               int pos, int other,
+                                               bool byRows) const
+{
+    while ( lo < hi )
+    {
+        const size_t mid = lo + (hi - lo) / 2;
+
+        // None of the intervals in this subtree reaches the position.
+        if ( m_maxEnds[mid] < pos )
+            return false;
+
+        if ( DoContains(blocks, lo, mid, pos, other, byRows) )
+            return true;
+
+        // All the intervals in the right subtree start after this one, so if
+        // it starts after the position, none of them can contain it.
+        const Interval& interval = m_intervals[mid];
+        if ( interval.start > pos )
+            return false;
+
+        if ( interval.end >= pos )
+        {
+            const wxGridBlockCoords& block = blocks[interval.block];
+            if ( byRows ? (other >= block.GetLeftCol() &&
+                            other <= block.GetRightCol())
+                        : (other >= block.GetTopRow() &&
+                            other <= block.GetBottomRow()) )
+                return true;
+        }
+
+        // Continue with the right subtree.
+        lo = mid + 1;
+    }
+
+    return false;
+}
+
+// ----------------------------------------------------------------------------
+// wxGridSelection
+// ----------------------------------------------------------------------------
+
 
 wxGridSelection::wxGridSelection( wxGrid * grid,
                                   wxGrid::wxGridSelectionModes sel )
 {
     m_grid = grid;
     m_selectionMode = sel;
+
+    m_index = new wxGridSelectionIndex;
+    m_numIndexedBlocks = 0;
+}
+
+wxGridSelection::~wxGridSelection()
+{
+    delete m_index;
+}
+
+void wxGridSelection::InvalidateIndex()
+{
+    m_index->Clear();
+    m_numIndexedBlocks = 0;
 }
 
 bool wxGridSelection::IsSelection()
@@ -76,13 +274,25 @@ bool wxGridSelection::IsInSelection( int row, int col ) const
 {
     // Check whether the given cell is contained in one of the selected blocks.
     //
-    // Note that this algorithm is O(N) in number of selected blocks, not in
-    // number of cells in the grid, so it should be reasonably efficient even
-    // for very large grids, as the user shouldn't be able to select too many
-    // blocks. If we still run into problems with this, we should find a more
-    // efficient way of storing the selection, e.g. using k-d trees.
+    // There may be a lot of blocks if the user selected many rows or columns
+    // one by one, so use the index for all but the last few of them, which
+    // are checked linearly. Rebuilding the index is O(N log N), so we don't
+    // do it every time a new block is added, but only once there are enough
+    // of them. Notice that the last block is never indexed, as it's the
+    // current one which is modified when the selection is extended.
+    static const size_t MAX_NON_INDEXED_BLOCKS = 16;
+
     const size_t count = m_selection.size();
-    for ( size_t n = 0; n < count; n++ )
+    if ( count - m_numIndexedBlocks > MAX_NON_INDEXED_BLOCKS )
+    {
+        m_index->Build(m_selection, count - 1, m_grid->GetNumberRows());
+        m_numIndexedBlocks = count - 1;
+    }
+
+    if ( m_numIndexedBlocks && m_index->Contains(m_selection, row, col) )
+        return true;
+
+    for ( size_t n = m_numIndexedBlocks; n < count; n++ )
     {
         if ( m_selection[n].Contains(wxGridCellCoords(row, col)) )
             return true;
@@ -159,6 +369,7 @@ void wxGridSelection::SetSelectionMode( wxGrid::wxGridSelectionModes selmode )
                     m_grid->RefreshBlock(block.GetTopLeft(), block.GetBottomRight());
                 }
                 m_selection.erase(m_selection.begin() + n);
+                InvalidateIndex();
             }
         }
 
@@ -186,6 +397,114 @@ void wxGridSelection::SelectCol(int col, const wxKeyboardState& kbd)
            kbd, true);
 }
 
+void wxGridSelection::SelectRows(const wxArrayInt& rows,
+                                 const wxKeyboardState& kbd,
+                                 wxEventType eventType)
+{
+    if ( m_selectionMode == wxGrid::wxGridSelectColumns ||
+            m_selectionMode == wxGrid::wxGridSelectNone )
+        return;
+
+    const int numRows = m_grid->GetNumberRows();
+    const int lastCol = m_grid->GetNumberCols() - 1;
+    if ( rows.empty() || !numRows || lastCol < 0 )
+        return;
+
+    wxArrayInt sortedRows(rows);
+    std::sort(sortedRows.begin(), sortedRows.end());
+
+    const size_t count = sortedRows.size();
+    wxCHECK_RET( sortedRows[0] >= 0 && sortedRows[count - 1] < numRows,
+                 "invalid row index" );
+
+    // Find the rows which are already entirely selected, to avoid adding
+    // them, and sending events about them, again. Only the blocks covering
+    // the full width of the grid need to be checked for this, sort them to
+    // be able to do it in a single pass over the sorted rows.
+    wxVector<std::pair<int, int> > selectedRanges;
+    for ( size_t n = 0; n < m_selection.size(); n++ )
+    {
+        const wxGridBlockCoords& block = m_selection[n];
+        if ( block.GetLeftCol() == 0 && block.GetRightCol() == lastCol )
+        {
+            selectedRanges.push_back(std::make_pair(block.GetTopRow(),
+                                                    block.GetBottomRow()));
+        }
+    }
+    std::sort(selectedRanges.begin(), selectedRanges.end());
+
+    wxArrayInt newRows;
+    newRows.reserve(count);
+
+    size_t nextRange = 0;
+    int lastSelected = -1;
+    for ( size_t n = 0; n < count; n++ )
+    {
+        const int row = sortedRows[n];
+        while ( nextRange < selectedRanges.size() &&
+                    selectedRanges[nextRange].first <= row )
+        {
+            if ( selectedRanges[nextRange].second > lastSelected )
+                lastSelected = selectedRanges[nextRange].second;
+            nextRange++;
+        }
+
+        if ( row > lastSelected )
+            newRows.push_back(row);
+    }
+
+    // Add a single block for each range of consecutive new rows, merging it
+    // with the existing selection.
+    const size_t countOld = m_selection.size();
+    wxVectorGridBlockCoords blocks;
+    for ( size_t n = 0; n < newRows.size(); )
+    {
+        const int top = newRows[n];
+        int bottom = top;
+        for ( n++; n < newRows.size() && newRows[n] <= bottom + 1; n++ )
+            bottom = newRows[n];
+
+        const wxGridBlockCoords block(top, 0, bottom, lastCol);
+        if ( MergeOrAddBlock(m_selection, block) )
+            blocks.push_back(block);
+    }
+
+    if ( blocks.empty() )
+        return;
+
+    // The index only remains valid if the blocks were just appended, but
+    // MergeOrAddBlock() could have also removed some of the existing ones.
+    if ( m_selection.size() != countOld + blocks.size() )
+        InvalidateIndex();
+
+    // Refresh the entire range of the selected rows at once, as doing it for
+    // every block could be very slow if there are many of them.
+    if ( !m_grid->GetBatchCount() )
+    {
+        m_grid->RefreshBlock(blocks.front().GetTopLeft(),
+                             blocks.back().GetBottomRight());
+    }
+
+    // But notify about each block separately, as the rows between them are
+    // not selected.
+    if ( eventType != wxEVT_NULL )
+    {
+        for ( size_t n = 0; n < blocks.size(); n++ )
+        {
+            const wxGridBlockCoords& block = blocks[n];
+
+            wxGridRangeSelectEvent gridEvt(m_grid->GetId(),
+                                           eventType,
+                                           m_grid,
+                                           block.GetTopLeft(),
+                                           block.GetBottomRight(),
+                                           true,
+                                           kbd);
+            m_grid->GetEventHandler()->ProcessEvent(gridEvt);
+        }
+    }
+}
+
 void wxGridSelection::SelectBlock( int topRow, int leftCol,
                                    int bottomRow, int rightCol,
                                    const wxKeyboardState& kbd,
@@ -244,6 +563,7 @@ wxGridSelection::SelectAll()
     // There is no need to refresh anything, as Select() will do it anyhow, and
     // no need to generate any events, so do not call ClearSelection() here.
     m_selection.clear();
+    InvalidateIndex();
 
     const int numRows = m_grid->GetNumberRows();
     const int numCols = m_grid->GetNumberCols();
@@ -344,6 +664,7 @@ wxGridSelection::DeselectBlock(const wxGridBlockCoords& block,
         // remove the block (note that selBlock, being a reference, is
         // invalidated here and can't be used any more below)
         m_selection.erase(m_selection.begin() + n);
+        InvalidateIndex();
         n--;
         count--;
 
@@ -408,6 +729,7 @@ void wxGridSelection::ClearSelection()
         coords1 = block.GetTopLeft();
         coords2 = block.GetBottomRight();
         m_selection.erase(m_selection.begin() + n);
+        InvalidateIndex();
         if ( !m_grid->GetBatchCount() )
         {
             m_grid->RefreshBlock(coords1, coords2);
@@ -436,6 +758,8 @@ void wxGridSelection::ClearSelection()
 
 void wxGridSelection::UpdateRows( size_t pos, int numRows )
 {
+    InvalidateIndex();
+
     size_t count = m_selection.size();
     size_t n;
 
@@ -485,6 +809,8 @@ void wxGridSelection::UpdateRows( size_t pos, int numRows )
 
 void wxGridSelection::UpdateCols( size_t pos, int numCols )
 {
+    InvalidateIndex();
+
     size_t count = m_selection.size();
     size_t n;
 
@@ -684,7 +1010,11 @@ bool wxGridSelection::ExtendCurrentBlock(const wxGridCellCoords& blockStart,
         }
     }
 
-    // Update the current block in place.
+    // Update the current block in place: it's normally not indexed, but make
+    // sure that the index doesn't become out of date if it somehow is.
+    if ( m_numIndexedBlocks == m_selection.size() )
+        InvalidateIndex();
+
     *m_selection.rbegin() = newBlock;
 
     // Send Event.
@@ -875,7 +1205,7 @@ wxGridSelection::Select(const wxGridBlockCoords& block,
     }
 }
 
-void wxGridSelection::MergeOrAddBlock(wxVectorGridBlockCoords& blocks,
+bool wxGridSelection::MergeOrAddBlock(wxVectorGridBlockCoords& blocks,
                                       const wxGridBlockCoords& newBlock)
 {
     size_t count = blocks.size();
@@ -884,7 +1214,7 @@ void wxGridSelection::MergeOrAddBlock(wxVectorGridBlockCoords& blocks,
         const wxGridBlockCoords& block = blocks[n];
 
         if ( block.Contains(newBlock) )
-            return;
+            return false;
 
         if ( newBlock.Contains(block) )
         {
@@ -895,6 +1225,8 @@ void wxGridSelection::MergeOrAddBlock(wxVectorGridBlockCoords& blocks,
     }
 
     blocks.push_back(newBlock);
+
+    return true;
 }
 
 #endif
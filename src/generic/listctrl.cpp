@@ -113,12 +113,153 @@ static const int MARGIN_AROUND_CHECKBOX = 5;
 // arrays/list implementations
 // ----------------------------------------------------------------------------
 
-#include "wx/listimpl.cpp"
-WX_DEFINE_LIST(wxListItemDataList)
-
 #include "wx/listimpl.cpp"
 WX_DEFINE_LIST(wxListHeaderDataList)
 
+// ----------------------------------------------------------------------------
+// wxListStringPool
+// ----------------------------------------------------------------------------
+
+/* static */
+const wxString& wxListStringPool::GetEmpty()
+{
+    static const wxString s_empty;
+    return s_empty;
+}
+
+const wxString* wxListStringPool::Add(const wxString& s)
+{
+    if ( s.empty() )
+        return NULL;
+
+    wxListStringRefCounts::iterator it = m_refCounts.find(s);
+    if ( it == m_refCounts.end() )
+        it = m_refCounts.insert(wxListStringRefCounts::value_type(s, 0)).first;
+
+    it->second++;
+
+    // The keys of the hash map are never moved, so we can keep pointers to
+    // them as long as the elements are not erased.
+    return &it->first;
+}
+
+void wxListStringPool::AddRef(const wxString* s)
+{
+    wxListStringRefCounts::iterator it = m_refCounts.find(*s);
+    wxCHECK_RET( it != m_refCounts.end(), "string not in the pool" );
+
+    it->second++;
+}
+
+void wxListStringPool::Release(const wxString* s)
+{
+    if ( !s )
+        return;
+
+    wxListStringRefCounts::iterator it = m_refCounts.find(*s);
+    wxCHECK_RET( it != m_refCounts.end(), "string not in the pool" );
+
+    if ( !--it->second )
+        m_refCounts.erase(it);
+}
+
+// ----------------------------------------------------------------------------
+// wxListAttrPool
+// ----------------------------------------------------------------------------
+
+wxListAttrPool::~wxListAttrPool()
+{
+    // All the items should have released their attributes by now, but delete
+    // them anyhow to avoid leaks if they didn't.
+    for ( wxListAttrRefCounts::iterator it = m_refCounts.begin();
+          it != m_refCounts.end();
+          ++it )
+    {
+        delete it->first;
+    }
+}
+
+/* static */
+unsigned long wxListAttrPool::Hash(const wxItemAttr& attr)
+{
+    unsigned long hash = 0;
+    if ( attr.HasTextColour() )
+        hash = attr.GetTextColour().GetRGBA();
+    if ( attr.HasBackgroundColour() )
+        hash = hash*31 + attr.GetBackgroundColour().GetRGBA();
+    if ( attr.HasFont() )
+    {
+        const wxFont& font = attr.GetFont();
+        hash = hash*31 + font.GetPointSize();
+        hash = hash*31 + font.GetWeight();
+        hash = hash*31 + font.GetStyle();
+        hash = hash*31 + wxStringHash::stringHash(font.GetFaceName().wx_str());
+    }
+
+    return hash;
+}
+
+wxItemAttr* wxListAttrPool::Add(const wxItemAttr& attr)
+{
+    wxVector<wxItemAttr*>& attrs = m_attrsByHash[Hash(attr)];
+    for ( wxVector<wxItemAttr*>::const_iterator it = attrs.begin();
+          it != attrs.end();
+          ++it )
+    {
+        if ( **it == attr )
+        {
+            AddRef(*it);
+            return *it;
+        }
+    }
+
+    wxItemAttr* const shared = new wxItemAttr(attr);
+    attrs.push_back(shared);
+    m_refCounts[shared] = 1;
+
+    return shared;
+}
+
+void wxListAttrPool::AddRef(wxItemAttr* attr)
+{
+    wxListAttrRefCounts::iterator it = m_refCounts.find(attr);
+    wxCHECK_RET( it != m_refCounts.end(), "attributes not in the pool" );
+
+    it->second++;
+}
+
+void wxListAttrPool::Release(wxItemAttr* attr)
+{
+    if ( !attr )
+        return;
+
+    wxListAttrRefCounts::iterator it = m_refCounts.find(attr);
+    wxCHECK_RET( it != m_refCounts.end(), "attributes not in the pool" );
+
+    if ( --it->second )
+        return;
+
+    m_refCounts.erase(it);
+
+    const unsigned long hash = Hash(*attr);
+    wxVector<wxItemAttr*>& attrs = m_attrsByHash[hash];
+    for ( wxVector<wxItemAttr*>::iterator i = attrs.begin();
+          i != attrs.end();
+          ++i )
+    {
+        if ( *i == attr )
+        {
+            attrs.erase(i);
+            break;
+        }
+    }
+
+    if ( attrs.empty() )
+        m_attrsByHash.erase(hash);
+
+    delete attr;
+}
+
 
 // ----------------------------------------------------------------------------
 // wxListItemData
@@ -126,12 +267,7 @@ WX_DEFINE_LIST(wxListHeaderDataList)
 
 wxListItemData::~wxListItemData()
 {
-    // in the virtual list control the attributes are managed by the main
-    // program, so don't delete them
-    if ( !m_owner->IsVirtual() )
-        delete m_attr;
-
-    delete m_rect;
+    Free();
 }
 
 void wxListItemData::Init()
@@ -140,6 +276,7 @@ void wxListItemData::Init()
     m_data = 0;
 
     m_attr = NULL;
+    m_text = NULL;
 }
 
 wxListItemData::wxListItemData(wxListMainWindow *owner)
@@ -154,6 +291,95 @@ wxListItemData::wxListItemData(wxListMainWindow *owner)
         m_rect = new wxRect;
 }
 
+wxListItemData::wxListItemData(const wxListItemData& other)
+{
+    Copy(other);
+}
+
+wxListItemData& wxListItemData::operator=(const wxListItemData& other)
+{
+    if ( &other != this )
+    {
+        Free();
+        Copy(other);
+    }
+
+    return *this;
+}
+
+void wxListItemData::Copy(const wxListItemData& other)
+{
+    m_owner = other.m_owner;
+    m_image = other.m_image;
+    m_data = other.m_data;
+    m_rect = other.m_rect ? new wxRect(*other.m_rect) : NULL;
+
+    m_text = other.m_text;
+    if ( m_text )
+    {
+        if ( m_owner->IsVirtual() )
+            m_text = new wxString(*m_text);
+        else
+            m_owner->GetStringPool().AddRef(m_text);
+    }
+
+    m_attr = other.m_attr;
+
+    // in the virtual list control the attributes are managed by the main
+    // program, so don't take ownership of them
+    if ( m_attr && !m_owner->IsVirtual() )
+        m_owner->GetAttrPool().AddRef(m_attr);
+}
+
+void wxListItemData::Free()
+{
+    if ( m_owner->IsVirtual() )
+    {
+        delete m_text;
+    }
+    else
+    {
+        m_owner->GetStringPool().Release(m_text);
+        m_owner->GetAttrPool().Release(m_attr);
+    }
+
+    m_text = NULL;
+    m_attr = NULL;
+
+    wxDELETE(m_rect);
+}
+
+void wxListItemData::SetText(const wxString& text)
+{
+    // the items of the virtual controls are only used to cache the data of
+    // the line being drawn, so their texts change all the time and it's not
+    // worth pooling them: just reuse the same string instead
+    if ( m_owner->IsVirtual() )
+    {
+        if ( text.empty() )
+        {
+            delete m_text;
+            m_text = NULL;
+        }
+        else if ( m_text )
+        {
+            *wxConstCast(m_text, wxString) = text;
+        }
+        else
+        {
+            m_text = new wxString(text);
+        }
+
+        return;
+    }
+
+    // add the new string before releasing the old one to avoid removing it
+    // from the pool if it's the same
+    const wxString* const old = m_text;
+    m_text = m_owner->GetStringPool().Add(text);
+    m_owner->GetStringPool().Release(old);
+}
+
 // Check if the item is visible
 bool wxGenericListCtrl::IsVisible(long item) const
 {
@@ -180,12 +406,21 @@ void wxListItemData::SetItem( const wxListItem &info )
     if ( info.m_mask & wxLIST_MASK_DATA )
         m_data = info.m_data;
 
-    if ( info.HasAttributes() )
+    // the attributes of the virtual control items are owned by the program
+    // and can only be set by CacheLineData(), so we must not replace them
+    if ( info.HasAttributes() && !m_owner->IsVirtual() )
     {
+        // the attributes may be shared with the other items, so don't modify
+        // them but replace them with the (possibly shared too) new ones
+        wxItemAttr attr;
         if ( m_attr )
-            m_attr->AssignFrom(*info.GetAttributes());
-        else
-            m_attr = new wxItemAttr(*info.GetAttributes());
+            attr = *m_attr;
+        attr.AssignFrom(*info.GetAttributes());
+
+        wxListAttrPool& pool = m_owner->GetAttrPool();
+        wxItemAttr* const old = m_attr;
+        m_attr = pool.Add(attr);
+        pool.Release(old);
     }
 
     if ( m_rect )
@@ -258,7 +493,7 @@ void wxListItemData::GetItem( wxListItem &info ) const
         mask = -1;
 
     if ( mask & wxLIST_MASK_TEXT )
-        info.m_text = m_text;
+        info.m_text = GetText();
     if ( mask & wxLIST_MASK_IMAGE )
         info.m_image = m_image;
     if ( mask & wxLIST_MASK_DATA )
@@ -436,10 +671,9 @@ wxListLineData::wxListLineData( wxListMainWindow *owner )
 
 void wxListLineData::CalculateSize( wxDC *dc, int spacing )
 {
-    wxListItemDataList::compatibility_iterator node = m_items.GetFirst();
-    wxCHECK_RET( node, wxT("no subitems at all??") );
+    wxCHECK_RET( !m_items.empty(), wxT("no subitems at all??") );
 
-    wxListItemData *item = node->GetData();
+    const wxListItemData *item = &m_items[0];
 
     wxString s;
     wxCoord lw, lh;
@@ -538,10 +772,9 @@ void wxListLineData::CalculateSize( wxDC *dc, int spacing )
 
 void wxListLineData::SetPosition( int x, int y, int spacing )
 {
-    wxListItemDataList::compatibility_iterator node = m_items.GetFirst();
-    wxCHECK_RET( node, wxT("no subitems at all??") );
+    wxCHECK_RET( !m_items.empty(), wxT("no subitems at all??") );
 
-    wxListItemData *item = node->GetData();
+    const wxListItemData *item = &m_items[0];
 
     switch ( GetMode() )
     {
@@ -606,87 +839,67 @@ void wxListLineData::SetPosition( int x, int y, int spacing )
 
 void wxListLineData::InitItems( int num )
 {
+    m_items.reserve(num);
     for (int i = 0; i < num; i++)
-        m_items.Append( new wxListItemData(m_owner) );
+        m_items.push_back( wxListItemData(m_owner) );
 }
 
 void wxListLineData::SetItem( int index, const wxListItem &info )
 {
-    wxListItemDataList::compatibility_iterator node = m_items.Item( index );
-    wxCHECK_RET( node, wxT("invalid column index in SetItem") );
+    wxCHECK_RET( index >= 0 && (size_t)index < m_items.size(),
+                 wxT("invalid column index in SetItem") );
 
-    wxListItemData *item = node->GetData();
-    item->SetItem( info );
+    m_items[index].SetItem( info );
 }
 
 void wxListLineData::GetItem( int index, wxListItem &info ) const
 {
-    wxListItemDataList::compatibility_iterator node = m_items.Item( index );
-    if (node)
-    {
-        wxListItemData *item = node->GetData();
-        item->GetItem( info );
-    }
+    if ( index >= 0 && (size_t)index < m_items.size() )
+        m_items[index].GetItem( info );
 }
 
 wxString wxListLineData::GetText(int index) const
 {
-    wxString s;
-
-    wxListItemDataList::compatibility_iterator node = m_items.Item( index );
-    if (node)
-    {
-        wxListItemData *item = node->GetData();
-        s = item->GetText();
-    }
+    if ( index >= 0 && (size_t)index < m_items.size() )
+        return m_items[index].GetText();
 
-    return s;
+    return wxString();
 }
 
 void wxListLineData::SetText( int index, const wxString& s )
 {
-    wxListItemDataList::compatibility_iterator node = m_items.Item( index );
-    if (node)
-    {
-        wxListItemData *item = node->GetData();
-        item->SetText( s );
-    }
+    if ( index >= 0 && (size_t)index < m_items.size() )
+        m_items[index].SetText( s );
 }
 
 void wxListLineData::SetImage( int index, int image )
 {
-    wxListItemDataList::compatibility_iterator node = m_items.Item( index );
-    wxCHECK_RET( node, wxT("invalid column index in SetImage()") );
+    wxCHECK_RET( index >= 0 && (size_t)index < m_items.size(),
+                 wxT("invalid column index in SetImage()") );
 
-    wxListItemData *item = node->GetData();
-    item->SetImage(image);
+    m_items[index].SetImage(image);
 }
 
 int wxListLineData::GetImage( int index ) const
 {
-    wxListItemDataList::compatibility_iterator node = m_items.Item( index );
-    wxCHECK_MSG( node, -1, wxT("invalid column index in GetImage()") );
+    wxCHECK_MSG( index >= 0 && (size_t)index < m_items.size(), -1,
+                 wxT("invalid column index in GetImage()") );
 
-    wxListItemData *item = node->GetData();
-    return item->GetImage();
+    return m_items[index].GetImage();
 }
 
 wxItemAttr *wxListLineData::GetAttr() const
 {
-    wxListItemDataList::compatibility_iterator node = m_items.GetFirst();
-    wxCHECK_MSG( node, NULL, wxT("invalid column index in GetAttr()") );
+    wxCHECK_MSG( !m_items.empty(), NULL, wxT("invalid column index in GetAttr()") );
 
-    wxListItemData *item = node->GetData();
-    return item->GetAttr();
+    return m_items[0].GetAttr();
 }
 
 void wxListLineData::SetAttr(wxItemAttr *attr)
 {
-    wxListItemDataList::compatibility_iterator node = m_items.GetFirst();
-    wxCHECK_RET( node, wxT("invalid column index in SetAttr()") );
+    wxCHECK_RET( !m_items.empty(), wxT("invalid column index in SetAttr()") );
 
-    wxListItemData *item = node->GetData();
-    item->SetAttr(attr);
+    m_items[0].SetAttr(attr);
 }
 
 void wxListLineData::ApplyAttributes(wxDC *dc,
@@ -769,12 +982,11 @@ void wxListLineData::ApplyAttributes(wxDC *dc,
 
 void wxListLineData::Draw(wxDC *dc, bool current)
 {
-    wxListItemDataList::compatibility_iterator node = m_items.GetFirst();
-    wxCHECK_RET( node, wxT("no subitems at all??") );
+    wxCHECK_RET( !m_items.empty(), wxT("no subitems at all??") );
 
     ApplyAttributes(dc, m_gi->m_rectHighlight, IsHighlighted(), current);
 
-    wxListItemData *item = node->GetData();
+    const wxListItemData *item = &m_items[0];
     if (item->HasImage())
     {
         // centre the image inside our rectangle, this looks nicer when items
@@ -825,12 +1037,10 @@ void wxListLineData::DrawInReportMode( wxDC *dc,
         x += cbSize.GetWidth() + (2 * MARGIN_AROUND_CHECKBOX);
     }
 
-    size_t col = 0;
-    for ( wxListItemDataList::compatibility_iterator node = m_items.GetFirst();
-          node;
-          node = node->GetNext(), col++ )
+    const size_t count = m_items.size();
+    for ( size_t col = 0; col < count; col++ )
     {
-        wxListItemData *item = node->GetData();
+        const wxListItemData *item = &m_items[col];
 
         int width = m_owner->GetColumnWidth(col);
         if (col == 0 && m_owner->HasCheckBoxes())
@@ -1571,6 +1781,7 @@ void wxListMainWindow::Init()
     m_dirty = true;
     m_selCount =
     m_countVirt = 0;
+    m_dataIndexValid = false;
     m_lineFrom =
     m_lineTo = (size_t)-1;
     m_linesPerPage = 0;
@@ -1702,7 +1913,7 @@ wxListLineData *wxListMainWindow::GetDummyLine() const
     // control changed as it would have the incorrect number of fields
     // otherwise
     if ( !m_lines.empty() &&
-            m_lines[0]->m_items.GetCount() != (size_t)GetColumnCount() )
+            m_lines[0]->m_items.size() != (size_t)GetColumnCount() )
     {
         self->m_lines.Clear();
     }
@@ -1779,10 +1990,9 @@ wxRect wxListMainWindow::GetLineLabelRect(size_t line) const
 
     int image_x = 0;
     wxListLineData *data = GetLine(line);
-    wxListItemDataList::compatibility_iterator node = data->m_items.GetFirst();
-    if (node)
+    if ( !data->m_items.empty() )
     {
-        wxListItemData *item = node->GetData();
+        const wxListItemData *item = &data->m_items[0];
         if ( item->HasImage() )
         {
             int ix, iy;
@@ -3426,11 +3636,9 @@ public:
     virtual void UpdateWithRow(int row) wxOVERRIDE
     {
         wxListLineData *line = m_listmain->GetLine( row );
-        wxListItemDataList::compatibility_iterator n = line->m_items.Item( GetColumn() );
+        wxCHECK_RET( GetColumn() < line->m_items.size(), wxS("no subitem?") );
 
-        wxCHECK_RET( n, wxS("no subitem?") );
-
-        wxListItemData* const itemData = n->GetData();
+        const wxListItemData* const itemData = &line->m_items[GetColumn()];
 
         wxListItem item;
         itemData->GetItem(item);
@@ -3565,6 +3773,9 @@ void wxListMainWindow::SetItem( wxListItem &item )
         wxListLineData *line = GetLine((size_t)id);
         line->SetItem( item.m_col, item );
 
+        if ( item.m_mask & wxLIST_MASK_DATA )
+            m_dataIndexValid = false;
+
         // Set item state if user wants
         if ( item.m_mask & wxLIST_MASK_STATE )
             SetItemState( item.m_itemId, item.m_state, item.m_state );
@@ -4300,15 +4511,12 @@ void wxListMainWindow::DeleteItem( long lindex )
         //  mark the Column Max Width cache as dirty if the items in the line
         //  we're deleting contain the Max Column Width
         wxListLineData * const line = GetLine(index);
-        wxListItemDataList::compatibility_iterator n;
         wxListItem      item;
 
-        for (size_t i = 0; i < m_columns.GetCount(); i++)
+        const size_t countCol = wxMin(m_columns.GetCount(), line->m_items.size());
+        for (size_t i = 0; i < countCol; i++)
         {
-            n = line->m_items.Item( i );
-            wxListItemData* itemData;
-            itemData = n->GetData();
-            itemData->GetItem(item);
+            line->m_items[i].GetItem(item);
 
             int itemWidth;
             itemWidth = GetItemWidthWithImage(&item);
@@ -4332,6 +4540,8 @@ void wxListMainWindow::DeleteItem( long lindex )
     {
         delete m_lines[index];
         m_lines.erase( m_lines.begin() + index );
+
+        m_dataIndexValid = false;
     }
 
     // we need to refresh the (vert) scrollbar as the number of items changed
@@ -4375,13 +4585,16 @@ void wxListMainWindow::DeleteColumn( int col )
             //  6. Call DeleteColumn().
             // So we need to check for this as otherwise we would simply crash
             // if this happens.
-            if ( line->m_items.GetCount() <= static_cast<unsigned>(col) )
+            if ( line->m_items.size() <= static_cast<unsigned>(col) )
                 continue;
 
-            wxListItemDataList::compatibility_iterator n = line->m_items.Item( col );
-            delete n->GetData();
-            line->m_items.Erase(n);
+            line->m_items.erase(line->m_items.begin() + col);
         }
+
+        // the item data is stored in the first column, so the data of the
+        // items changes if it is deleted
+        if ( col == 0 )
+            m_dataIndexValid = false;
     }
 
     if ( InReportView() )   //  we only cache max widths when in Report View
@@ -4432,6 +4645,9 @@ void wxListMainWindow::DoDeleteAllItems()
         ResetVisibleLinesRange();
 
     m_lines.Clear();
+
+    m_dataIndex.clear();
+    m_dataIndexValid = false;
 }
 
 void wxListMainWindow::DeleteAllItems()
@@ -4496,6 +4712,26 @@ long wxListMainWindow::FindItem(long start, const wxString& str, bool partial )
     return wxNOT_FOUND;
 }
 
+void wxListMainWindow::UpdateDataIndexOnInsert(size_t line)
+{
+    // Appending items is by far the most common case, so update the index
+    // incrementally instead of rebuilding it later.
+    if ( m_dataIndexValid && line == m_lines.size() - 1 )
+    {
+        wxListItem item;
+        item.m_mask = wxLIST_MASK_DATA;
+        m_lines[line]->GetItem( 0, item );
+
+        // Don't overwrite the index of the existing item with the same data.
+        if ( m_dataIndex.find(item.m_data) == m_dataIndex.end() )
+            m_dataIndex[item.m_data] = line;
+    }
+    else
+    {
+        m_dataIndexValid = false;
+    }
+}
+
 long wxListMainWindow::FindItem(long start, wxUIntPtr data)
 {
     long pos = start;
@@ -4503,6 +4739,36 @@ long wxListMainWindow::FindItem(long start, wxUIntPtr data)
         pos = 0;
 
     size_t count = GetItemCount();
+
+    if ( !IsVirtual() )
+    {
+        if ( !m_dataIndexValid )
+        {
+            m_dataIndex.clear();
+
+            wxListItem item;
+            item.m_mask = wxLIST_MASK_DATA;
+            for ( size_t i = count; i > 0; i-- )
+            {
+                // Iterate backwards to end up with the first item having the
+                // given data.
+                m_lines[i - 1]->GetItem( 0, item );
+                m_dataIndex[item.m_data] = i - 1;
+            }
+
+            m_dataIndexValid = true;
+        }
+
+        wxListDataIndex::const_iterator it = m_dataIndex.find(data);
+        if ( it == m_dataIndex.end() )
+            return wxNOT_FOUND;
+
+        // The index only gives the first item with this data, fall back on
+        // the linear search below for finding the subsequent ones.
+        if ( it->second >= (size_t)pos )
+            return it->second;
+    }
+
     for (size_t i = (size_t)pos; i < count; i++)
     {
         wxListLineData *line = GetLine(i);
@@ -4618,6 +4884,8 @@ void wxListMainWindow::InsertItem( wxListItem &item )
 
     m_lines.insert( m_lines.begin() + id, line );
 
+    UpdateDataIndexOnInsert(id);
+
     m_dirty = true;
 
     // If an item is selected at or below the point of insertion, we need to
@@ -4666,11 +4934,11 @@ long wxListMainWindow::InsertColumn( long col, const wxListItem &item )
             for ( size_t i = 0; i < m_lines.size(); i++ )
             {
                 wxListLineData * const line = GetLine(i);
-                wxListItemData * const data = new wxListItemData(this);
+                const wxListItemData data(this);
                 if ( insert )
-                    line->m_items.Insert(col, data);
+                    line->m_items.insert(line->m_items.begin() + col, data);
                 else
-                    line->m_items.Append(data);
+                    line->m_items.push_back(data);
             }
         }
 
@@ -4740,6 +5008,8 @@ void wxListMainWindow::SortItems( wxListCtrlCompare fn, wxIntPtr data )
 
     std::sort(m_lines.begin(), m_lines.end(), wxListLineComparator(fn, data));
 
+    m_dataIndexValid = false;
+
     m_dirty = true;
 }
 
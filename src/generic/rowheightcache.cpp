@@ -19,6 +19,7 @@
 #include "wx/wxprec.h"
 
 #ifndef WX_PRECOMP
+    #include "wx/utils.h"
 #endif // WX_PRECOMP
 
 #include "wx/generic/private/rowheightcache.h"
@@ -189,140 +190,469 @@ unsigned int RowRanges::CountTo(unsigned int row) const
 // HeightCache
 // ----------------------------------------------------------------------------
 
-bool HeightCache::GetLineInfo(unsigned int row, int &start, int &height)
+// Node of the tree containing a run of rows with the same height.
+struct HeightCacheNode
 {
-    int y = 0;
-    bool found = false;
-    HeightToRowRangesMap::iterator it;
-    for (it = m_heightToRowRange.begin(); it != m_heightToRowRange.end(); ++it)
+    HeightCacheNode(unsigned int rows_, int height_, unsigned int priority_)
+        : left(NULL),
+          right(NULL),
+          priority(priority_),
+          rows(rows_),
+          height(height_)
+    {
+        Update();
+    }
+
+    // Recompute the subtree values from the children ones.
+    void Update()
     {
-        int rowHeight = it->first;
-        RowRanges* rowRanges = it->second;
-        if (rowRanges->Has(row))
+        totalRows = rows;
+        knownRows = height >= 0 ? rows : 0;
+        sumHeights = height >= 0 ? static_cast<int>(rows)*height : 0;
+
+        if ( left )
         {
-            height = rowHeight;
-            found = true;
+            totalRows += left->totalRows;
+            knownRows += left->knownRows;
+            sumHeights += left->sumHeights;
+        }
+
+        if ( right )
+        {
+            totalRows += right->totalRows;
+            knownRows += right->knownRows;
+            sumHeights += right->sumHeights;
         }
-        y += rowHeight * (rowRanges->CountTo(row));
     }
-    if (found)
+
+    HeightCacheNode* left;
+    HeightCacheNode* right;
+
+    // The priority of the node is greater than the priorities of all the
+    // nodes in its subtree, as the priorities are random, this keeps the tree
+    // balanced on average.
+    const unsigned int priority;
+
+    // The number of rows in this node and their height or -1 if unknown.
+    unsigned int rows;
+    int height;
+
+    // The values for the entire subtree, including this node.
+    unsigned int totalRows;
+    unsigned int knownRows;
+    int sumHeights;
+};
+
+namespace
+{
+
+typedef HeightCacheNode Node;
+
+inline unsigned int TotalRows(const Node* node)
+{
+    return node ? node->totalRows : 0;
+}
+
+// Return the priority for a new node using a simple xorshift generator, the
+// priorities don't need to be of high quality.
+inline unsigned int NextPriority(unsigned int& seed)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+// Merge two trees, all rows of the first one come before the second one.
+Node* Merge(Node* first, Node* second)
+{
+    if ( !first )
+        return second;
+    if ( !second )
+        return first;
+
+    if ( first->priority > second->priority )
+    {
+        first->right = Merge(first->right, second);
+        first->Update();
+        return first;
+    }
+    else
     {
-        start = y;
+        second->left = Merge(first, second->left);
+        second->Update();
+        return second;
     }
-    return found;
 }
 
-bool HeightCache::GetLineStart(unsigned int row, int &start)
+// Split the tree into the first rows and the rest of them, the node
+// containing both the last of the first rows and the first of the remaining
+// ones is split into two nodes.
+void Split(Node* node, unsigned int row, Node*& first, Node*& second,
+           unsigned int& seed)
 {
-    int height = 0;
-    return GetLineInfo(row, start, height);
+    if ( !node )
+    {
+        first =
+        second = NULL;
+        return;
+    }
+
+    const unsigned int leftRows = TotalRows(node->left);
+    if ( row <= leftRows )
+    {
+        Split(node->left, row, first, node->left, seed);
+        node->Update();
+        second = node;
+    }
+    else if ( row >= leftRows + node->rows )
+    {
+        Split(node->right, row - leftRows - node->rows, node->right, second,
+              seed);
+        node->Update();
+        first = node;
+    }
+    else // Split this node itself.
+    {
+        const unsigned int offset = row - leftRows;
+        Node* const
+            tail = new Node(node->rows - offset, node->height,
+                            NextPriority(seed));
+
+        Node* const right = node->right;
+        node->rows = offset;
+        node->right = NULL;
+        node->Update();
+
+        first = node;
+        second = Merge(tail, right);
+    }
 }
 
-bool HeightCache::GetLineHeight(unsigned int row, int &height)
+// Add a row with the given height to the last node of the tree if it has the
+// same height, return false if it doesn't.
+bool ExtendLast(Node* node, int height)
+{
+    if ( !node )
+        return false;
+
+    if ( node->right )
+    {
+        if ( !ExtendLast(node->right, height) )
+            return false;
+    }
+    else
+    {
+        if ( node->height != height )
+            return false;
+
+        node->rows++;
+    }
+
+    node->Update();
+    return true;
+}
+
+// Same as ExtendLast() but for the first node of the tree.
+bool ExtendFirst(Node* node, int height)
 {
-    HeightToRowRangesMap::iterator it;
-    for (it = m_heightToRowRange.begin(); it != m_heightToRowRange.end(); ++it)
+    if ( !node )
+        return false;
+
+    if ( node->left )
     {
-        int rowHeight = it->first;
-        RowRanges* rowRanges = it->second;
-        if (rowRanges->Has(row))
+        if ( !ExtendFirst(node->left, height) )
+            return false;
+    }
+    else
+    {
+        if ( node->height != height )
+            return false;
+
+        node->rows++;
+    }
+
+    node->Update();
+    return true;
+}
+
+void DeleteTree(Node* node)
+{
+    if ( !node )
+        return;
+
+    DeleteTree(node->left);
+    DeleteTree(node->right);
+    delete node;
+}
+
+} // anonymous namespace
+
+HeightCache::Node* HeightCache::NewNode(unsigned int rows, int height)
+{
+    return new Node(rows, height, NextPriority(m_seed));
+}
+
+unsigned int HeightCache::GetSize() const
+{
+    return TotalRows(m_root);
+}
+
+void
+HeightCache::GetPrefix(unsigned int row, unsigned int& known, int& sum) const
+{
+    known = 0;
+    sum = 0;
+
+    for ( const Node* node = m_root; node && row; )
+    {
+        const unsigned int leftRows = TotalRows(node->left);
+        if ( row <= leftRows )
         {
-            height = rowHeight;
-            return true;
+            node = node->left;
+            continue;
+        }
+
+        if ( node->left )
+        {
+            known += node->left->knownRows;
+            sum += node->left->sumHeights;
         }
+
+        row -= leftRows;
+
+        const unsigned int rows = wxMin(row, node->rows);
+        if ( node->height >= 0 )
+        {
+            known += rows;
+            sum += static_cast<int>(rows)*node->height;
+        }
+
+        row -= rows;
+        node = node->right;
     }
-    return false;
 }
 
-bool HeightCache::GetLineAt(int y, unsigned int &row)
+unsigned int HeightCache::GetFirstUnknownRow()
 {
-    unsigned int total = 0;
-    HeightToRowRangesMap::iterator it;
-    for (it = m_heightToRowRange.begin(); it != m_heightToRowRange.end(); ++it)
+    unsigned int pos = 0;
+    for ( const Node* node = m_root; node; )
     {
-        RowRanges* rowRanges = it->second;
-        total += rowRanges->CountAll();
+        const Node* const left = node->left;
+        if ( left && left->knownRows != left->totalRows )
+        {
+            node = left;
+            continue;
+        }
+
+        pos += TotalRows(left);
+        if ( node->height < 0 )
+            break;
+
+        pos += node->rows;
+        node = node->right;
     }
 
-    if (total == 0)
-    {
+    return pos;
+}
+
+bool HeightCache::GetLineInfo(unsigned int row, int &start, int &height)
+{
+    return GetLineHeight(row, height) && GetLineStart(row, start);
+}
+
+bool HeightCache::GetLineStart(unsigned int row, int &start)
+{
+    if ( row > GetSize() )
+        return false;
+
+    unsigned int known;
+    int sum;
+    GetPrefix(row, known, sum);
+    if ( known != row )
         return false;
-    }
 
-    int lo = 0;
-    int hi = total;
-    int start, height;
-    while (lo < hi)
+    start = sum;
+    return true;
+}
+
+bool HeightCache::GetLineHeight(unsigned int row, int &height)
+{
+    for ( const Node* node = m_root; node; )
     {
-        int mid = (lo + hi) / 2;
-        if (GetLineInfo(mid, start, height))
+        const unsigned int leftRows = TotalRows(node->left);
+        if ( row < leftRows )
         {
-            if (start + height <= y)
-            {
-                lo = mid + 1;
-            }
-            else
-            {
-                hi = mid;
-            }
+            node = node->left;
+        }
+        else if ( row < leftRows + node->rows )
+        {
+            if ( node->height < 0 )
+                return false;
+
+            height = node->height;
+            return true;
         }
         else
         {
-            // should never happen, except the HeightCache has gaps which is an
-            // invalid state
-            return false;
+            row -= leftRows + node->rows;
+            node = node->right;
         }
     }
-    if (GetLineInfo(lo, start, height))
+
+    return false;
+}
+
+bool HeightCache::GetLineAt(int y, unsigned int &row)
+{
+    if ( y < 0 || !m_root )
+        return false;
+
+    // Find the number of rows ending at or before y by descending the tree,
+    // this is the index of the row containing y, if any.
+    unsigned int pos = 0;
+    int rest = y;
+    for ( const Node* node = m_root; node; )
     {
-        if (y < start)
+        const Node* const left = node->left;
+        if ( left && left->sumHeights > rest )
         {
-            // given y point is before the first row
-            return false;
+            node = left;
+            continue;
+        }
+
+        if ( left )
+        {
+            pos += left->totalRows;
+            rest -= left->sumHeights;
+        }
+
+        // Unknown rows, as well as the rows of zero height, end before y.
+        if ( node->height > 0 )
+        {
+            const unsigned int rows = rest / node->height;
+            if ( rows < node->rows )
+            {
+                pos += rows;
+                break;
+            }
+
+            rest -= static_cast<int>(node->rows)*node->height;
         }
-        row = lo;
-        return true;
+
+        pos += node->rows;
+        node = node->right;
+    }
+
+    // Unknown rows have zero height in the tree, so the row found is only the
+    // right one if it and all the rows before it are known.
+    int height;
+    if ( !GetLineHeight(pos, height) )
+        return false;
+
+    unsigned int known;
+    int sum;
+    GetPrefix(pos, known, sum);
+    if ( known != pos )
+        return false;
+
+    row = pos;
+    return true;
+}
+
+void HeightCache::SetHeight(unsigned int row, int height)
+{
+    Node *first,
+         *middle,
+         *last;
+    Split(m_root, row, first, last, m_seed);
+    Split(last, 1, middle, last, m_seed);
+
+    wxCHECK_RET( middle, "invalid row" );
+
+    // Keep the rows with the same height in the same node if possible.
+    if ( ExtendLast(first, height) || ExtendFirst(last, height) )
+    {
+        delete middle;
+        middle = NULL;
     }
     else
     {
-        // given y point is after the last row
-        return false;
+        middle->height = height;
+        middle->Update();
     }
+
+    m_root = Merge(Merge(first, middle), last);
 }
 
 void HeightCache::Put(unsigned int row, int height)
 {
-    RowRanges *rowRanges = m_heightToRowRange[height];
-    if (rowRanges == NULL)
+    wxCHECK_RET( height >= 0, "invalid row height" );
+
+    const unsigned int size = GetSize();
+    if ( row < size )
     {
-        rowRanges = new RowRanges();
-        m_heightToRowRange[height] = rowRanges;
+        SetHeight(row, height);
+        return;
     }
-    rowRanges->Add(row);
+
+    // Add the rows with unknown height before this one if necessary.
+    if ( row > size )
+        m_root = Merge(m_root, NewNode(row - size, -1));
+
+    if ( !ExtendLast(m_root, height) )
+        m_root = Merge(m_root, NewNode(1, height));
 }
 
 void HeightCache::Remove(unsigned int row)
 {
-    HeightToRowRangesMap::iterator it;
-    for (it = m_heightToRowRange.begin(); it != m_heightToRowRange.end(); ++it)
-    {
-        RowRanges* rowRanges = it->second;
-        rowRanges->Remove(row);
-    }
+    if ( row >= GetSize() )
+        return;
+
+    Node *first,
+         *last;
+    Split(m_root, row, first, last, m_seed);
+    DeleteTree(last);
+    m_root = first;
 }
 
-void HeightCache::Clear()
+void HeightCache::InvalidateLine(unsigned int row)
 {
-    HeightToRowRangesMap::iterator it;
-    for (it = m_heightToRowRange.begin(); it != m_heightToRowRange.end(); ++it)
-    {
-        RowRanges* rowRanges = it->second;
-        delete rowRanges;
-    }
-    m_heightToRowRange.clear();
+    int height;
+    if ( !GetLineHeight(row, height) )
+        return;
+
+    SetHeight(row, -1);
+}
+
+void HeightCache::InsertRows(unsigned int row, unsigned int count)
+{
+    // Nothing to do if the rows are inserted after the cached ones.
+    if ( row >= GetSize() || !count )
+        return;
+
+    Node *first,
+         *last;
+    Split(m_root, row, first, last, m_seed);
+    m_root = Merge(Merge(first, NewNode(count, -1)), last);
 }
 
-HeightCache::~HeightCache()
+void HeightCache::DeleteRows(unsigned int row, unsigned int count)
+{
+    if ( row >= GetSize() || !count )
+        return;
+
+    Node *first,
+         *middle,
+         *last;
+    Split(m_root, row, first, last, m_seed);
+    Split(last, count, middle, last, m_seed);
+    DeleteTree(middle);
+    m_root = Merge(first, last);
+}
+
+void HeightCache::Clear()
 {
-    Clear();
+    DeleteTree(m_root);
+    m_root = NULL;
 }
@@ -29,6 +29,8 @@
 #include "wx/fontmap.h"
 #include "wx/msgout.h"
 
+#include "wx/private/eventtrace.h"
+
 #include "wx/gtk/private.h"
 
 #include "wx/gtk/mimetype.h"
@@ -149,6 +151,9 @@ bool wxApp::DoIdle()
     do {
         ProcessPendingEvents();
 
+        // This is the equivalent of wxEventLoopBase::ProcessIdle() for GTK.
+        wxEventTraceScope traceScope(wxEVENT_TRACE_IDLE);
+
         needMore = ProcessIdle();
     } while (needMore && gtk_events_pending() == 0);
     gdk_threads_leave();
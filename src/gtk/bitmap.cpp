@@ -587,6 +587,32 @@ static void CopyImageData(
 }
 
 #if wxUSE_IMAGE
+// Key of the pixbuf data used to indicate that its pixels are shared with
+// wxImage and so must not be modified.
+static const char* const wxPIXBUF_SHARED_KEY = "wx-shared-pixels";
+
+static void DeleteImageRGBAData(guchar* WXUNUSED(pixels), gpointer data)
+{
+    delete static_cast<wxImageRGBAData*>(data);
+}
+
+// Create a pixbuf with alpha using the interleaved representation of the
+// image directly, instead of copying it.
+static GdkPixbuf* CreatePixbufSharingImageData(const wxImage& image)
+{
+    wxImageRGBAData* const
+        rgba = new wxImageRGBAData(image.GetRGBAData(wxIMAGE_RGBA_STRAIGHT));
+
+    const int w = rgba->GetWidth();
+    GdkPixbuf* const pixbuf = gdk_pixbuf_new_from_data(
+        rgba->GetData(), GDK_COLORSPACE_RGB, true, 8,
+        w, rgba->GetHeight(), 4 * w,
+        DeleteImageRGBAData, rgba);
+    g_object_set_data(G_OBJECT(pixbuf), wxPIXBUF_SHARED_KEY, rgba);
+
+    return pixbuf;
+}
+
 #ifdef __WXGTK3__
 wxBitmap::wxBitmap(const wxImage& image, int depth, double scale)
 {
@@ -594,37 +620,37 @@ wxBitmap::wxBitmap(const wxImage& image, int depth, double scale)
 
     const int w = image.GetWidth();
     const int h = image.GetHeight();
-    const guchar* alpha = image.GetAlpha();
     if (depth < 0)
-        depth = alpha ? 32 : 24;
+        depth = image.HasAlpha() ? 32 : 24;
     else if (depth != 1 && depth != 32)
         depth = 24;
     wxBitmapRefData* bmpData = new wxBitmapRefData(w, h, depth);
     bmpData->m_scaleFactor = scale;
     m_refData = bmpData;
-    GdkPixbuf* pixbuf_dst = gdk_pixbuf_new(GDK_COLORSPACE_RGB, depth == 32, 8, w, h);
-    bmpData->m_pixbufNoMask = pixbuf_dst;
-    wxASSERT(bmpData->m_bpp == 32 || !gdk_pixbuf_get_has_alpha(bmpData->m_pixbufNoMask));
-    const guchar* src = image.GetData();
-
-    guchar* dst = gdk_pixbuf_get_pixels(pixbuf_dst);
-    const int dstStride = gdk_pixbuf_get_rowstride(pixbuf_dst);
-    CopyImageData(dst, gdk_pixbuf_get_n_channels(pixbuf_dst), dstStride, src, 3, 3 * w, w, h);
-
-    if (depth == 32 && alpha)
+    if (depth == 32)
     {
-        for (int j = 0; j < h; j++, dst += dstStride)
-            for (int i = 0; i < w; i++)
-                dst[i * 4 + 3] = *alpha++;
+        // Notice that we must not call image.GetData() before this, as it
+        // would discard the image data cached by a previous conversion.
+        bmpData->m_pixbufNoMask = CreatePixbufSharingImageData(image);
     }
+    else
+    {
+        GdkPixbuf* pixbuf_dst = gdk_pixbuf_new(GDK_COLORSPACE_RGB, false, 8, w, h);
+        bmpData->m_pixbufNoMask = pixbuf_dst;
+        CopyImageData(gdk_pixbuf_get_pixels(pixbuf_dst), 3,
+            gdk_pixbuf_get_rowstride(pixbuf_dst), image.GetData(), 3, 3 * w, w, h);
+    }
+    wxASSERT(bmpData->m_bpp == 32 || !gdk_pixbuf_get_has_alpha(bmpData->m_pixbufNoMask));
+
     if (image.HasMask())
     {
         const guchar r = image.GetMaskRed();
         const guchar g = image.GetMaskGreen();
         const guchar b = image.GetMaskBlue();
+        const guchar* src = image.GetData();
         cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_A8, w, h);
         const int stride = cairo_image_surface_get_stride(surface);
-        dst = cairo_image_surface_get_data(surface);
+        guchar* dst = cairo_image_surface_get_data(surface);
         memset(dst, 0xff, stride * h);
         for (int j = 0; j < h; j++, dst += stride)
             for (int i = 0; i < w; i++, src += 3)
@@ -732,29 +758,11 @@ bool wxBitmap::CreateFromImageAsPixbuf(const wxImage& image)
     int width = image.GetWidth();
     int height = image.GetHeight();
 
-    Create(width, height, 32);
-    GdkPixbuf* pixbuf = GetPixbuf();
-    if (!pixbuf)
+    if (!Create(width, height, 32))
         return false;
 
-    // Copy the data:
-    const unsigned char* in = image.GetData();
-    unsigned char *out = gdk_pixbuf_get_pixels(pixbuf);
-    unsigned char *alpha = image.GetAlpha();
-
-    int rowpad = gdk_pixbuf_get_rowstride(pixbuf) - 4 * width;
-
-    for (int y = 0; y < height; y++, out += rowpad)
-    {
-        for (int x = 0; x < width; x++, out += 4, in += 3)
-        {
-            out[0] = in[0];
-            out[1] = in[1];
-            out[2] = in[2];
-            if (alpha)
-                out[3] = *alpha++;
-        }
-    }
+    // Use the image data directly instead of copying it.
+    M_BMPDATA->m_pixbuf = CreatePixbufSharingImageData(image);
 
     if ( image.HasMask() )
     {
@@ -1531,6 +1539,22 @@ void wxBitmap::PurgeOtherRepresentations(wxBitmap::Representation keep)
 #endif
 
 #ifdef wxHAS_RAW_BITMAP
+// Replace the pixbuf sharing its pixels with wxImage with its own copy, to
+// allow modifying it.
+static void UnsharePixbuf(GdkPixbuf*& pixbuf)
+{
+#if wxUSE_IMAGE
+    if (pixbuf && g_object_get_data(G_OBJECT(pixbuf), wxPIXBUF_SHARED_KEY))
+    {
+        GdkPixbuf* const pixbufCopy = gdk_pixbuf_copy(pixbuf);
+        g_object_unref(pixbuf);
+        pixbuf = pixbufCopy;
+    }
+#else
+    wxUnusedVar(pixbuf);
+#endif // wxUSE_IMAGE
+}
+
 void *wxBitmap::GetRawData(wxPixelDataBase& data, int bpp)
 {
     void* bits = NULL;
@@ -1538,6 +1562,8 @@ void *wxBitmap::GetRawData(wxPixelDataBase& data, int bpp)
     GdkPixbuf* pixbuf = GetPixbufNoMask();
     if ((bpp == 32) == (gdk_pixbuf_get_has_alpha(pixbuf) != 0))
     {
+        UnsharePixbuf(M_BMPDATA->m_pixbufNoMask);
+        pixbuf = M_BMPDATA->m_pixbufNoMask;
         bits = gdk_pixbuf_get_pixels(pixbuf);
         wxBitmapRefData* bmpData = M_BMPDATA;
         data.m_width = bmpData->m_width;
@@ -1560,6 +1586,8 @@ void *wxBitmap::GetRawData(wxPixelDataBase& data, int bpp)
     // Pixmap will get out of date when our pixbuf is accessed directly, so
     // ensure we don't keep the old data in it.
     PurgeOtherRepresentations(Pixbuf);
+    UnsharePixbuf(M_BMPDATA->m_pixbuf);
+    pixbuf = M_BMPDATA->m_pixbuf;
     // Pixbuf with masked data will get out of date too
     if ( M_BMPDATA->m_pixbufMask )
     {
@@ -17,7 +17,12 @@
 
 #include "wx/app.h"
 #include "wx/cmdline.h"
+#include "wx/ffile.h"
 #include "wx/stopwatch.h"
+#include "wx/textfile.h"
+#include "wx/vector.h"
+
+#include <math.h>
 
 #if wxUSE_GUI
     #include "wx/frame.h"
@@ -34,8 +39,45 @@ static const char OPTION_SINGLE = '1';
 
 static const char OPTION_AVG_COUNT = 'a';
 static const char OPTION_NUM_RUNS = 'n';
+static const char OPTION_WARMUP_COUNT = 'w';
 static const char OPTION_NUMERIC_PARAM = 'p';
 static const char OPTION_STRING_PARAM = 's';
+static const char OPTION_JSON = 'j';
+static const char OPTION_COMPARE = 'c';
+static const char OPTION_THRESHOLD = 't';
+
+// ----------------------------------------------------------------------------
+// helper classes
+// ----------------------------------------------------------------------------
+
+namespace
+{
+
+// Results of running a single benchmark with the given parameters.
+struct BenchResult
+{
+    // Unique identifier of the result, combining the benchmark name and its
+    // parameters.
+    wxString id;
+
+    wxString name;
+    long numParam;
+    wxString strParam;
+
+    // Number of calls in each sample and the number of samples.
+    long numRuns,
+         numSamples;
+
+    // Statistics of the time taken by a single call, in microseconds.
+    double min,
+           max,
+           mean,
+           median,
+           p95,
+           stddev;
+};
+
+} // anonymous namespace
 
 // ----------------------------------------------------------------------------
 // BenchApp declaration
@@ -67,12 +109,33 @@ private:
     // list all registered benchmarks
     void ListBenchmarks();
 
+    // run the given benchmark with the current parameters, return false if
+    // it failed
+    bool RunBenchmark(Bench::Function* func);
+
+    // write the results to m_jsonFile, return false on error
+    bool WriteResults() const;
+
+    // compare the results in the given files and return the exit code
+    int CompareResults(const wxString& fileOld, const wxString& fileNew) const;
+
     // command lines options/parameters
     wxSortedArrayString m_toRun;
     long m_numRuns,
          m_avgCount,
+         m_warmupCount,
          m_numParam;
+    bool m_numParamSpecified;
     wxString m_strParam;
+    wxString m_jsonFile;
+    double m_threshold;
+
+    // files to compare in the compare mode
+    wxString m_compareOld,
+             m_compareNew;
+
+    // results of all the benchmarks ran so far
+    wxVector<BenchResult> m_results;
 };
 
 wxIMPLEMENT_APP_CONSOLE(BenchApp);
@@ -101,7 +164,10 @@ BenchApp::BenchApp()
 {
     m_avgCount = 10;
     m_numRuns = 10000; // just some default (TODO: switch to time-based one)
+    m_warmupCount = 1;
     m_numParam = 0;
+    m_numParamSpecified = false;
+    m_threshold = 5.0;
 }
 
 bool BenchApp::OnInit()
@@ -149,6 +215,15 @@ void BenchApp::OnInitCmdLine(wxCmdLineParser& parser)
                          m_numRuns
                      ),
                      wxCMD_LINE_VAL_NUMBER);
+    parser.AddOption(OPTION_WARMUP_COUNT,
+                     "warmup",
+                     wxString::Format
+                     (
+                         "number of times to run benchmarking loop before "
+                         "starting measuring (default: %ld)",
+                         m_warmupCount
+                     ),
+                     wxCMD_LINE_VAL_NUMBER);
     parser.AddOption(OPTION_NUMERIC_PARAM,
                      "num-param",
                      wxString::Format
@@ -163,6 +238,23 @@ void BenchApp::OnInitCmdLine(wxCmdLineParser& parser)
                      "string parameter used by some benchmark functions "
                      "(default: empty)",
                      wxCMD_LINE_VAL_STRING);
+    parser.AddOption(OPTION_JSON,
+                     "json",
+                     "also write the results to the given file in JSON format",
+                     wxCMD_LINE_VAL_STRING);
+    parser.AddSwitch(OPTION_COMPARE,
+                     "compare",
+                     "compare the results in the two JSON files given as "
+                     "parameters instead of running benchmarks");
+    parser.AddOption(OPTION_THRESHOLD,
+                     "threshold",
+                     wxString::Format
+                     (
+                         "percentage of slowdown considered to be a regression "
+                         "in compare mode (default: %g)",
+                         m_threshold
+                     ),
+                     wxCMD_LINE_VAL_DOUBLE);
 
     parser.AddParam("benchmark name",
                     wxCMD_LINE_VAL_STRING,
@@ -188,13 +280,31 @@ bool BenchApp::OnCmdLineParsed(wxCmdLineParser& parser)
         return false;
     }
 
+    parser.Found(OPTION_THRESHOLD, &m_threshold);
+    if ( parser.Found(OPTION_COMPARE) )
+    {
+        if ( count != 2 )
+        {
+            wxFprintf(stderr, "Exactly two files must be given to compare.\n");
+            return false;
+        }
+
+        m_compareOld = parser.GetParam(0);
+        m_compareNew = parser.GetParam(1);
+
+        return BenchAppBase::OnCmdLineParsed(parser);
+    }
+
     bool numRunsSpecified = false;
     if ( parser.Found(OPTION_AVG_COUNT, &m_avgCount) )
         numRunsSpecified = true;
     if ( parser.Found(OPTION_NUM_RUNS, &m_numRuns) )
         numRunsSpecified = true;
-    parser.Found(OPTION_NUMERIC_PARAM, &m_numParam);
+    if ( parser.Found(OPTION_WARMUP_COUNT, &m_warmupCount) )
+        numRunsSpecified = true;
+    m_numParamSpecified = parser.Found(OPTION_NUMERIC_PARAM, &m_numParam);
     parser.Found(OPTION_STRING_PARAM, &m_strParam);
+    parser.Found(OPTION_JSON, &m_jsonFile);
     if ( parser.Found(OPTION_SINGLE) )
     {
         if ( numRunsSpecified )
@@ -206,6 +316,14 @@ bool BenchApp::OnCmdLineParsed(wxCmdLineParser& parser)
 
         m_avgCount =
         m_numRuns = 1;
+        m_warmupCount = 0;
+    }
+
+    if ( m_avgCount < 1 || m_numRuns < 1 || m_warmupCount < 0 )
+    {
+        wxFprintf(stderr, "Invalid number of runs specified.\n");
+
+        return false;
     }
 
     // construct sorted array for quick verification of benchmark names
@@ -234,6 +352,9 @@ bool BenchApp::OnCmdLineParsed(wxCmdLineParser& parser)
 
 int BenchApp::OnRun()
 {
+    if ( !m_compareOld.empty() )
+        return CompareResults(m_compareOld, m_compareNew);
+
     int rc = EXIT_SUCCESS;
     for ( Bench::Function *func = Bench::Function::GetFirst();
           func;
@@ -242,66 +363,425 @@ int BenchApp::OnRun()
         if ( m_toRun.Index(func->GetName()) == wxNOT_FOUND )
             continue;
 
-        wxString params;
-        if ( m_numParam )
-            params += wxString::Format(" with N=%ld", m_numParam);
-        if ( !m_strParam.empty() )
+        if ( m_numParamSpecified || !func->GetParamsCount() )
         {
-            if ( !params.empty() )
-                params += " and";
-            params += wxString::Format(" with s=\"%s\"", m_strParam);
+            if ( !RunBenchmark(func) )
+                rc = EXIT_FAILURE;
         }
-
-        wxPrintf("Benchmarking %s%s: ", func->GetName(), params);
-
-        long timeMin = LONG_MAX,
-             timeMax = 0,
-             timeTotal = 0;
-        bool ok = func->Init();
-        for ( long a = 0; ok && a < m_avgCount; a++ )
+        else // run it with all its predefined parameter values
         {
-            wxStopWatch sw;
-            for ( long n = 0; n < m_numRuns && ok; n++ )
+            for ( size_t n = 0; n < func->GetParamsCount(); n++ )
             {
-                ok = func->Run();
+                m_numParam = func->GetParam(n);
+
+                if ( !RunBenchmark(func) )
+                    rc = EXIT_FAILURE;
             }
 
-            sw.Pause();
+            m_numParam = 0;
+        }
+    }
+
+    if ( !m_jsonFile.empty() && !WriteResults() )
+        rc = EXIT_FAILURE;
 
-            const long t = sw.Time();
-            if ( t < timeMin )
-                timeMin = t;
-            if ( t > timeMax )
-                timeMax = t;
-            timeTotal += t;
+    return rc;
+}
+
+// Format the duration given in microseconds using the appropriate unit.
+static wxString FormatDuration(double us)
+{
+    if ( us < 1. )
+        return wxString::Format("%.1fns", us * 1000.);
+    if ( us < 1000. )
+        return wxString::Format("%.3fus", us);
+    if ( us < 1000000. )
+        return wxString::Format("%.3fms", us / 1000.);
+
+    return wxString::Format("%.3fs", us / 1000000.);
+}
+
+bool BenchApp::RunBenchmark(Bench::Function* func)
+{
+    wxString params;
+    if ( m_numParam )
+        params += wxString::Format(" with N=%ld", m_numParam);
+    if ( !m_strParam.empty() )
+    {
+        if ( !params.empty() )
+            params += " and";
+        params += wxString::Format(" with s=\"%s\"", m_strParam);
+    }
+
+    wxPrintf("Benchmarking %s%s: ", func->GetName(), params);
+
+    bool ok = func->Init();
+
+    for ( long w = 0; ok && w < m_warmupCount; w++ )
+    {
+        for ( long n = 0; n < m_numRuns && ok; n++ )
+        {
+            ok = func->Run();
         }
+    }
+
+    // Time taken by each run of the benchmarking loop, in microseconds.
+    wxVector<double> samples;
+    for ( long a = 0; ok && a < m_avgCount; a++ )
+    {
+        wxStopWatch sw;
+        for ( long n = 0; n < m_numRuns && ok; n++ )
+        {
+            ok = func->Run();
+        }
+
+        sw.Pause();
+
+        samples.push_back(sw.TimeInMicro().ToDouble());
+    }
+
+    func->Done();
+
+    if ( !ok )
+    {
+        wxPrintf("ERROR\n");
+        fflush(stdout);
+
+        return false;
+    }
+
+    // Show the total times of the benchmarking loop runs first.
+    double timeMin = samples[0],
+           timeMax = samples[0],
+           timeTotal = 0.;
+    for ( size_t n = 0; n < samples.size(); n++ )
+    {
+        if ( samples[n] < timeMin )
+            timeMin = samples[n];
+        if ( samples[n] > timeMax )
+            timeMax = samples[n];
+        timeTotal += samples[n];
+    }
+
+    wxPrintf("%ldms total, ", (long)(timeTotal / 1000.));
+
+    double timeAvg = timeTotal;
+    long times = m_avgCount;
+    if ( m_avgCount > 2 )
+    {
+        timeAvg -= timeMin + timeMax;
+        times -= 2;
+    }
+
+    wxPrintf("%.2f avg (min=%ld, max=%ld)\n",
+             timeAvg / times / 1000.,
+             (long)(timeMin / 1000.),
+             (long)(timeMax / 1000.));
+
+    // Compute the statistics for a single call of the function.
+    for ( size_t n = 0; n < samples.size(); n++ )
+        samples[n] /= m_numRuns;
+
+    wxVectorSort(samples);
+
+    const size_t numSamples = samples.size();
+
+    BenchResult result;
+    result.name = func->GetName();
+    result.numParam = m_numParam;
+    result.strParam = m_strParam;
+    result.id = result.name;
+    if ( m_numParam )
+        result.id += wxString::Format("/N=%ld", m_numParam);
+    if ( !m_strParam.empty() )
+        result.id += wxString::Format("/s=%s", m_strParam);
+    result.numRuns = m_numRuns;
+    result.numSamples = numSamples;
+    result.min = samples[0];
+    result.max = samples[numSamples - 1];
+    result.mean = timeTotal / m_numRuns / numSamples;
+    result.median = numSamples % 2
+                        ? samples[numSamples / 2]
+                        : (samples[numSamples / 2 - 1] + samples[numSamples / 2]) / 2;
+
+    // Use the nearest rank method for the percentile.
+    result.p95 = samples[(size_t)ceil(0.95 * numSamples) - 1];
+
+    double variance = 0.;
+    for ( size_t n = 0; n < numSamples; n++ )
+    {
+        const double d = samples[n] - result.mean;
+        variance += d*d;
+    }
+    result.stddev = numSamples > 1 ? sqrt(variance / (numSamples - 1)) : 0.;
+
+    wxPrintf("\tper run: median=%s, p95=%s, stddev=%s\n",
+             FormatDuration(result.median),
+             FormatDuration(result.p95),
+             FormatDuration(result.stddev));
+
+    fflush(stdout);
+
+    m_results.push_back(result);
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// JSON results support
+// ----------------------------------------------------------------------------
 
-        func->Done();
+// We only need to read back the files written by ourselves, so we don't use a
+// full JSON parser but put each result on its own line and use the functions
+// below for reading the values from it.
 
-        if ( !ok )
+static wxString QuoteJSON(const wxString& s)
+{
+    wxString quoted("\"");
+    for ( wxString::const_iterator it = s.begin(); it != s.end(); ++it )
+    {
+        const wxUniChar ch = *it;
+        if ( ch == '"' || ch == '\\' )
+        {
+            quoted += '\\';
+            quoted += ch;
+        }
+        else if ( ch < 0x20 )
         {
-            wxPrintf("ERROR\n");
-            rc = EXIT_FAILURE;
+            quoted += wxString::Format("\\u%04x", (unsigned)ch.GetValue());
         }
         else
         {
-            wxPrintf("%ldms total, ", timeTotal);
+            quoted += ch;
+        }
+    }
+
+    quoted += '"';
+
+    return quoted;
+}
+
+static wxString FormatJSONNumber(double value)
+{
+    // Don't use wxString::Format() which would use the current locale.
+    return wxString::FromCDouble(value, 6);
+}
+
+// Find the start of the value of the given key in the line or return
+// wxString::npos if not found.
+static size_t FindJSONValue(const wxString& line, const char* key)
+{
+    const wxString keyQuoted = QuoteJSON(key) + ":";
+    size_t pos = line.find(keyQuoted);
+    if ( pos == wxString::npos )
+        return pos;
+
+    pos += keyQuoted.length();
+    while ( pos < line.length() && line[pos] == ' ' )
+        pos++;
+
+    return pos;
+}
+
+static bool GetJSONString(const wxString& line, const char* key, wxString& value)
+{
+    size_t pos = FindJSONValue(line, key);
+    if ( pos == wxString::npos || pos >= line.length() || line[pos] != '"' )
+        return false;
+
+    value.clear();
+    for ( pos++; pos < line.length(); pos++ )
+    {
+        wxUniChar ch = line[pos];
+        if ( ch == '"' )
+            return true;
+
+        if ( ch == '\\' )
+        {
+            if ( ++pos == line.length() )
+                break;
 
-            long times = m_avgCount;
-            if ( m_avgCount > 2 )
+            ch = line[pos];
+            if ( ch == 'u' )
             {
-                timeTotal -= timeMin + timeMax;
-                times -= 2;
+                unsigned long code;
+                if ( !line.substr(pos + 1, 4).ToULong(&code, 16) )
+                    break;
+
+                ch = wxUniChar(code);
+                pos += 4;
             }
+        }
+
+        value += ch;
+    }
+
+    // Unterminated string.
+    return false;
+}
+
+static bool GetJSONNumber(const wxString& line, const char* key, double& value)
+{
+    const size_t pos = FindJSONValue(line, key);
+    if ( pos == wxString::npos )
+        return false;
+
+    const size_t end = line.find_first_of(",}", pos);
+    if ( end == wxString::npos )
+        return false;
+
+    return line.substr(pos, end - pos).Trim().ToCDouble(&value);
+}
+
+bool BenchApp::WriteResults() const
+{
+    wxFFile file(m_jsonFile, "w");
+    if ( !file.IsOpened() )
+        return false;
+
+    wxString json;
+    json << "{\n"
+         << "  \"build\": " << QuoteJSON(WX_BUILD_OPTIONS_SIGNATURE) << ",\n"
+         << "  \"unit\": \"us\",\n"
+         << "  \"results\": [\n";
+
+    for ( size_t n = 0; n < m_results.size(); n++ )
+    {
+        const BenchResult& r = m_results[n];
+
+        json << "    { "
+             << "\"id\": " << QuoteJSON(r.id) << ", "
+             << "\"name\": " << QuoteJSON(r.name) << ", "
+             << "\"num_param\": " << r.numParam << ", "
+             << "\"str_param\": " << QuoteJSON(r.strParam) << ", "
+             << "\"runs\": " << r.numRuns << ", "
+             << "\"samples\": " << r.numSamples << ", "
+             << "\"min\": " << FormatJSONNumber(r.min) << ", "
+             << "\"max\": " << FormatJSONNumber(r.max) << ", "
+             << "\"mean\": " << FormatJSONNumber(r.mean) << ", "
+             << "\"median\": " << FormatJSONNumber(r.median) << ", "
+             << "\"p95\": " << FormatJSONNumber(r.p95) << ", "
+             << "\"stddev\": " << FormatJSONNumber(r.stddev)
+             << " }";
+        if ( n != m_results.size() - 1 )
+            json << ",";
+        json << "\n";
+    }
+
+    json << "  ]\n"
+         << "}\n";
+
+    return file.Write(json, wxConvUTF8) && file.Close();
+}
 
-            wxPrintf("%.2f avg (min=%ld, max=%ld)\n",
-                     (float)timeTotal / times, timeMin, timeMax);
+// Read the median times from the results file, return false on error.
+static bool
+ReadResults(const wxString& filename,
+            wxVector<wxString>& ids,
+            wxVector<double>& medians)
+{
+    wxTextFile file;
+    if ( !file.Open(filename, wxConvUTF8) )
+        return false;
+
+    for ( wxString line = file.GetFirstLine();
+          !file.Eof();
+          line = file.GetNextLine() )
+    {
+        wxString id;
+        if ( !GetJSONString(line, "id", id) )
+            continue;
+
+        double median;
+        if ( !GetJSONNumber(line, "median", median) )
+        {
+            wxFprintf(stderr, "No median time for \"%s\" in \"%s\".\n",
+                      id, filename);
+            return false;
         }
 
-        fflush(stdout);
+        ids.push_back(id);
+        medians.push_back(median);
     }
 
-    return rc;
+    return true;
+}
+
+int BenchApp::CompareResults(const wxString& fileOld,
+                             const wxString& fileNew) const
+{
+    wxVector<wxString> idsOld,
+                       idsNew;
+    wxVector<double> timesOld,
+                     timesNew;
+    if ( !ReadResults(fileOld, idsOld, timesOld) ||
+            !ReadResults(fileNew, idsNew, timesNew) )
+    {
+        wxFprintf(stderr, "Failed to read the results to compare.\n");
+        return EXIT_FAILURE;
+    }
+
+    wxPrintf("%-40s %12s %12s %9s\n", "Benchmark", "Old", "New", "Change");
+
+    int numRegressions = 0;
+    for ( size_t n = 0; n < idsNew.size(); n++ )
+    {
+        const wxString& id = idsNew[n];
+
+        size_t m;
+        for ( m = 0; m < idsOld.size(); m++ )
+        {
+            if ( idsOld[m] == id )
+                break;
+        }
+
+        if ( m == idsOld.size() )
+        {
+            wxPrintf("%-40s %12s %12s %9s\n",
+                     id, "-", FormatDuration(timesNew[n]), "new");
+            continue;
+        }
+
+        const double change = timesOld[m] > 0.
+                                ? (timesNew[n] - timesOld[m]) / timesOld[m] * 100.
+                                : 0.;
+
+        const bool isRegression = change > m_threshold;
+        if ( isRegression )
+            numRegressions++;
+
+        wxPrintf("%-40s %12s %12s %+8.1f%%%s\n",
+                 id,
+                 FormatDuration(timesOld[m]),
+                 FormatDuration(timesNew[n]),
+                 change,
+                 isRegression ? "  REGRESSION" : "");
+    }
+
+    for ( size_t m = 0; m < idsOld.size(); m++ )
+    {
+        size_t n;
+        for ( n = 0; n < idsNew.size(); n++ )
+        {
+            if ( idsNew[n] == idsOld[m] )
+                break;
+        }
+
+        if ( n == idsNew.size() )
+        {
+            wxPrintf("%-40s %12s %12s %9s\n",
+                     idsOld[m], FormatDuration(timesOld[m]), "-", "missing");
+        }
+    }
+
+    if ( numRegressions )
+    {
+        wxPrintf("%d regression(s) above %g%% threshold found.\n",
+                 numRegressions, m_threshold);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
 }
 
 int BenchApp::OnExit()
@@ -321,6 +801,15 @@ void BenchApp::ListBenchmarks()
           func;
           func = func->GetNext() )
     {
-        wxPrintf("\t%s\n", func->GetName());
+        wxString params;
+        for ( size_t n = 0; n < func->GetParamsCount(); n++ )
+        {
+            params += params.empty() ? " (N=" : ", ";
+            params << func->GetParam(n);
+        }
+        if ( !params.empty() )
+            params += ")";
+
+        wxPrintf("\t%s%s\n", func->GetName(), params);
     }
 }
@@ -38,6 +38,26 @@ public:
           m_func(func),
           m_init(init),
           m_done(done),
+          m_params(NULL),
+          m_paramsCount(0),
+          m_next(ms_head)
+    {
+        ms_head = this;
+    }
+
+    /// Ctor is used implicitly by BENCHMARK_FUNC_WITH_PARAMS().
+    Function(const char *name,
+             FuncType func,
+             const long *params,
+             size_t paramsCount,
+             InitType init = NULL,
+             DoneType done = NULL)
+        : m_name(name),
+          m_func(func),
+          m_init(init),
+          m_done(done),
+          m_params(params),
+          m_paramsCount(paramsCount),
           m_next(ms_head)
     {
         ms_head = this;
@@ -46,6 +66,13 @@ public:
     /// Get the name of this function
     const char *GetName() const { return m_name; }
 
+    /// Get the number of the numeric parameter values to run the function
+    /// with, 0 if it doesn't use any predefined values.
+    size_t GetParamsCount() const { return m_paramsCount; }
+
+    /// Get the value of the numeric parameter with the given index.
+    long GetParam(size_t n) const { return m_params[n]; }
+
     /// Perform once-only initialization prior to Run().
     bool Init() { return m_init ? (*m_init)() : true; }
 
@@ -71,6 +98,10 @@ private:
     const InitType m_init;
     const DoneType m_done;
 
+    // values of the numeric parameter to use, may be NULL
+    const long * const m_params;
+    const size_t m_paramsCount;
+
     // pointer to the next object in the linked list or NULL
     Function * const m_next;
 
@@ -82,6 +113,10 @@ private:
 
     Tests may use this parameter in whatever way they see fit, by default it is
     1 but can be set to a different value by user from the command line.
+
+    For the functions defined using BENCHMARK_FUNC_WITH_PARAMS() this returns
+    the value the function is currently being run with, unless the parameter
+    was explicitly given on the command line.
  */
 long GetNumericParameter();
 
@@ -123,4 +158,35 @@ wxString GetStringParameter();
     static Bench::Function wxMAKE_UNIQUE_NAME(name)(#name, name, init, done); \
     bool name()
 
+/**
+    Define a benchmark function using several values of the numeric parameter.
+
+    This macro is similar to BENCHMARK_FUNC() but runs the benchmark once for
+    each value in the @a params array (which must be a real array and not a
+    pointer) and reports the results for each of them separately, which is
+    useful for seeing how the performance depends on e.g. the data size. The
+    function should use Bench::GetNumericParameter() to get the current value.
+ */
+#define BENCHMARK_FUNC_WITH_PARAMS(name, params)                              \
+    static bool name();                                                       \
+    static Bench::Function                                                    \
+        wxMAKE_UNIQUE_NAME(name)(#name, name, params, WXSIZEOF(params));      \
+    bool name()
+
+/**
+    Define a benchmark function using several values of the numeric parameter
+    and requiring initialization and shutdown.
+
+    This macro combines BENCHMARK_FUNC_WITH_PARAMS() and
+    BENCHMARK_FUNC_WITH_INIT(): @a init and @a done are called before and
+    after running the benchmark with each of the parameter values, so @a init
+    can use Bench::GetNumericParameter() too.
+ */
+#define BENCHMARK_FUNC_WITH_PARAMS_AND_INIT(name, params, init, done)         \
+    static bool name();                                                       \
+    static Bench::Function                                                    \
+        wxMAKE_UNIQUE_NAME(name)(#name, name, params, WXSIZEOF(params),       \
+                                 init, done);                                 \
+    bool name()
+
 #endif // _WX_TESTS_BENCHMARKS_BENCH_H_
@@ -0,0 +1,699 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        tests/benchmarks/controls.cpp
+// Purpose:     Benchmarks for the controls showing many rows of data
+// Author:      wxWidgets team
+// Created:     2026-10-18
+// Copyright:   (c) 2026 wxWidgets team
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+// All the benchmarks here create the controls as children of the hidden frame
+// created by the benchmarking program and measure the operations which take
+// time proportional to the number of rows: populating the control, repainting
+// it, scrolling it by a page, sorting and selecting all of its rows.
+//
+// wxGrid is drawn into a wxMemoryDC using wxGrid::Render(), so it doesn't
+// need to be shown at all, but the other controls can only be repainted when
+// they are visible, so the frame is temporarily shown by the repainting
+// benchmarks, which means that they need a display, e.g. Xvfb when running
+// wxGTK or wxX11 on a headless machine.
+//
+// Using hundreds of thousands of rows makes all these benchmarks slow, so
+// they should be run with a small number of runs, e.g. "-n 1 -a 5".
+
+#include "wx/app.h"
+#include "wx/bitmap.h"
+#include "wx/dataview.h"
+#include "wx/dcmemory.h"
+#include "wx/frame.h"
+#include "wx/grid.h"
+#include "wx/listctrl.h"
+#include "wx/treectrl.h"
+#include "wx/vector.h"
+
+#include "bench.h"
+
+#include <algorithm>
+
+// Number of rows used by all the benchmarks by default.
+static const long rowCounts[] = { 100000, 1000000 };
+
+// Size of the controls: it determines the number of rows shown in one page.
+static const int controlWidth = 800;
+static const int controlHeight = 600;
+
+namespace
+{
+
+// Return the number of rows to use, possibly specified on the command line.
+int GetRowsCount()
+{
+    const long count = Bench::GetNumericParameter();
+    return static_cast<int>(count > 0 ? count : rowCounts[0]);
+}
+
+wxWindow* GetParentWindow()
+{
+    return wxTheApp->GetTopWindow();
+}
+
+// Return the value used for the given cell: this is a pseudo-random number
+// which is always the same for the same cell, so that sorting by any column
+// does something useful but the results are still reproducible.
+unsigned GetCellNumber(int row, int col)
+{
+    wxUint32 n = static_cast<wxUint32>(row) * 2654435761u + col * 40503u;
+    n ^= n >> 15;
+    return n % 1000000;
+}
+
+wxString GetCellText(int row, int col)
+{
+    return wxString::Format("%06u", GetCellNumber(row, col));
+}
+
+// Show the parent frame of the control, with the control filling all of its
+// client area, and process the events generated by doing this, as otherwise
+// repainting the control wouldn't do anything.
+void ShowControl(wxWindow* win)
+{
+    wxWindow* const parent = win->GetParent();
+    parent->SetClientSize(controlWidth, controlHeight);
+    win->SetSize(0, 0, controlWidth, controlHeight);
+    parent->Show();
+
+    wxTheApp->Yield();
+}
+
+void HideControl(wxWindow* win)
+{
+    win->GetParent()->Hide();
+}
+
+// Repaint the entire visible part of the window immediately.
+bool RepaintControl(wxWindow* win)
+{
+    win->Refresh();
+    win->Update();
+
+    return win->IsShownOnScreen();
+}
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------
+// wxGrid
+// ----------------------------------------------------------------------------
+
+#if wxUSE_GRID
+
+namespace
+{
+
+const int gridCols = 8;
+
+// Virtual table computing the cell values on the fly, but which can be sorted
+// by any column.
+class BenchGridTable : public wxGridTableBase
+{
+public:
+    explicit BenchGridTable(int rows)
+        : m_rows(rows)
+    {
+        m_order.reserve(rows);
+        for ( int row = 0; row < rows; row++ )
+            m_order.push_back(row);
+    }
+
+    virtual int GetNumberRows() wxOVERRIDE { return m_rows; }
+    virtual int GetNumberCols() wxOVERRIDE { return gridCols; }
+
+    virtual wxString GetValue(int row, int col) wxOVERRIDE
+    {
+        return GetCellText(m_order[row], col);
+    }
+
+    virtual void SetValue(int WXUNUSED(row),
+                          int WXUNUSED(col),
+                          const wxString& WXUNUSED(value)) wxOVERRIDE
+    {
+    }
+
+    void Sort(int col, bool ascending)
+    {
+        std::sort(m_order.begin(), m_order.end(), RowCompare(col, ascending));
+    }
+
+private:
+    // Compare the rows by the values in the given column, using the row
+    // index to make the order unambiguous.
+    class RowCompare
+    {
+    public:
+        RowCompare(int col, bool ascending)
+            : m_col(col), m_ascending(ascending)
+        {
+        }
+
+        bool operator()(int row1, int row2) const
+        {
+            const unsigned n1 = GetCellNumber(row1, m_col),
+                           n2 = GetCellNumber(row2, m_col);
+            if ( n1 != n2 )
+                return m_ascending ? n1 < n2 : n2 < n1;
+
+            return row1 < row2;
+        }
+
+    private:
+        int m_col;
+        bool m_ascending;
+    };
+
+    const int m_rows;
+
+    // Index of the row shown at the given position.
+    wxVector<int> m_order;
+
+    wxDECLARE_NO_COPY_CLASS(BenchGridTable);
+};
+
+wxGrid* gs_grid = NULL;
+BenchGridTable* gs_gridTable = NULL;
+
+bool GridInit()
+{
+    gs_grid = new wxGrid(GetParentWindow(), wxID_ANY, wxDefaultPosition,
+                         wxSize(controlWidth, controlHeight));
+
+    gs_gridTable = new BenchGridTable(GetRowsCount());
+    gs_grid->AssignTable(gs_gridTable);
+
+    return true;
+}
+
+void GridDone()
+{
+    delete gs_grid;
+    gs_grid = NULL;
+    gs_gridTable = NULL;
+}
+
+// Draw the page of the grid starting at the given row into a bitmap.
+bool RenderGridPage(int topRow)
+{
+    static wxBitmap s_bitmap(controlWidth, controlHeight);
+
+    wxMemoryDC dc(s_bitmap);
+    dc.SetBackground(*wxWHITE_BRUSH);
+    dc.Clear();
+
+    const int rowsPerPage = controlHeight / gs_grid->GetDefaultRowSize();
+    const int bottomRow = wxMin(topRow + rowsPerPage,
+                                gs_grid->GetNumberRows()) - 1;
+
+    gs_grid->Render(dc, wxPoint(0, 0), s_bitmap.GetSize(),
+                    wxGridCellCoords(topRow, 0),
+                    wxGridCellCoords(bottomRow, gs_grid->GetNumberCols() - 1),
+                    wxGRID_DRAW_DEFAULT | wxGRID_DRAW_SELECTION);
+
+    return bottomRow >= topRow;
+}
+
+} // anonymous namespace
+
+BENCHMARK_FUNC_WITH_PARAMS(GridPopulate, rowCounts)
+{
+    const int rows = GetRowsCount();
+
+    wxGrid grid(GetParentWindow(), wxID_ANY);
+    grid.CreateGrid(rows, gridCols);
+
+    grid.BeginBatch();
+    for ( int row = 0; row < rows; row++ )
+    {
+        for ( int col = 0; col < gridCols; col++ )
+            grid.SetCellValue(row, col, GetCellText(row, col));
+    }
+    grid.EndBatch();
+
+    return grid.GetNumberRows() == rows;
+}
+
+BENCHMARK_FUNC_WITH_PARAMS_AND_INIT(GridRender, rowCounts, GridInit, GridDone)
+{
+    return RenderGridPage(0);
+}
+
+BENCHMARK_FUNC_WITH_PARAMS_AND_INIT(GridScrollPage, rowCounts,
+                                    GridInit, GridDone)
+{
+    if ( !gs_grid->MovePageDown() )
+        gs_grid->GoToCell(0, 0);
+
+    return RenderGridPage(gs_grid->GetGridCursorRow());
+}
+
+BENCHMARK_FUNC_WITH_PARAMS_AND_INIT(GridSort, rowCounts, GridInit, GridDone)
+{
+    static bool s_ascending = false;
+    s_ascending = !s_ascending;
+
+    gs_gridTable->Sort(1, s_ascending);
+    gs_grid->SetSortingColumn(1, s_ascending);
+    gs_grid->ForceRefresh();
+
+    return RenderGridPage(0);
+}
+
+BENCHMARK_FUNC_WITH_PARAMS_AND_INIT(GridSelectRows, rowCounts,
+                                    GridInit, GridDone)
+{
+    gs_grid->SetSelectionMode(wxGrid::wxGridSelectRows);
+
+    const int rows = gs_grid->GetNumberRows();
+    gs_grid->SelectBlock(0, 0, rows - 1, gridCols - 1);
+
+    const bool ok = gs_grid->GetSelectedRows().size() == static_cast<size_t>(rows);
+
+    gs_grid->ClearSelection();
+
+    return ok;
+}
+
+#endif // wxUSE_GRID
+
+// ----------------------------------------------------------------------------
+// wxDataViewCtrl
+// ----------------------------------------------------------------------------
+
+#if wxUSE_DATAVIEWCTRL
+
+namespace
+{
+
+const int dataViewCols = 3;
+
+wxDataViewListCtrl* CreateDataView(int rows)
+{
+    wxDataViewListCtrl* const dvc = new wxDataViewListCtrl
+                                        (
+                                            GetParentWindow(),
+                                            wxID_ANY,
+                                            wxDefaultPosition,
+                                            wxSize(controlWidth, controlHeight),
+                                            wxDV_MULTIPLE
+                                        );
+
+    for ( int col = 0; col < dataViewCols; col++ )
+    {
+        dvc->AppendTextColumn(wxString::Format("Column %d", col),
+                              wxDATAVIEW_CELL_INERT,
+                              -1,
+                              wxALIGN_LEFT,
+                              wxDATAVIEW_COL_SORTABLE);
+    }
+
+    wxVector<wxVariant> values(dataViewCols);
+    for ( int row = 0; row < rows; row++ )
+    {
+        for ( int col = 0; col < dataViewCols; col++ )
+            values[col] = GetCellText(row, col);
+
+        dvc->AppendItem(values);
+    }
+
+    return dvc;
+}
+
+wxDataViewListCtrl* gs_dataView = NULL;
+
+bool DataViewInit()
+{
+    gs_dataView = CreateDataView(GetRowsCount());
+
+    return true;
+}
+
+bool DataViewShownInit()
+{
+    DataViewInit();
+    ShowControl(gs_dataView);
+
+    return true;
+}
+
+void DataViewDone()
+{
+    HideControl(gs_dataView);
+
+    delete gs_dataView;
+    gs_dataView = NULL;
+}
+
+} // anonymous namespace
+
+BENCHMARK_FUNC_WITH_PARAMS(DataViewPopulate, rowCounts)
+{
+    const int rows = GetRowsCount();
+
+    wxDataViewListCtrl* const dvc = CreateDataView(rows);
+    const bool ok = dvc->GetItemCount() == rows;
+    delete dvc;
+
+    return ok;
+}
+
+BENCHMARK_FUNC_WITH_PARAMS_AND_INIT(DataViewRepaint, rowCounts,
+                                    DataViewShownInit, DataViewDone)
+{
+    return RepaintControl(gs_dataView);
+}
+
+BENCHMARK_FUNC_WITH_PARAMS_AND_INIT(DataViewScrollPage, rowCounts,
+                                    DataViewInit, DataViewDone)
+{
+    static int s_row = 0;
+
+    // Use the last row of the next page to really scroll by a page.
+    s_row += wxMax(gs_dataView->GetCountPerPage(), 1);
+    if ( s_row >= gs_dataView->GetItemCount() )
+        s_row = 0;
+
+    const wxDataViewItem item = gs_dataView->RowToItem(s_row);
+    gs_dataView->EnsureVisible(item);
+
+    return item.IsOk();
+}
+
+BENCHMARK_FUNC_WITH_PARAMS_AND_INIT(DataViewSort, rowCounts,
+                                    DataViewInit, DataViewDone)
+{
+    static bool s_ascending = false;
+    s_ascending = !s_ascending;
+
+    gs_dataView->GetColumn(1)->SetSortOrder(s_ascending);
+    gs_dataView->GetModel()->Resort();
+
+    return gs_dataView->GetSortingColumn() == gs_dataView->GetColumn(1);
+}
+
+BENCHMARK_FUNC_WITH_PARAMS_AND_INIT(DataViewSelectAll, rowCounts,
+                                    DataViewInit, DataViewDone)
+{
+    gs_dataView->SelectAll();
+
+    const bool ok = gs_dataView->GetSelectedItemsCount() ==
+                        gs_dataView->GetItemCount();
+
+    gs_dataView->UnselectAll();
+
+    return ok;
+}
+
+#endif // wxUSE_DATAVIEWCTRL
+
+// ----------------------------------------------------------------------------
+// wxListCtrl
+// ----------------------------------------------------------------------------
+
+#if wxUSE_LISTCTRL
+
+namespace
+{
+
+const int listCtrlCols = 3;
+
+wxListCtrl* CreateListCtrl(int rows)
+{
+    wxListCtrl* const list = new wxListCtrl(GetParentWindow(),
+                                            wxID_ANY,
+                                            wxDefaultPosition,
+                                            wxSize(controlWidth, controlHeight),
+                                            wxLC_REPORT);
+
+    for ( int col = 0; col < listCtrlCols; col++ )
+        list->AppendColumn(wxString::Format("Column %d", col));
+
+    for ( int row = 0; row < rows; row++ )
+    {
+        list->InsertItem(row, GetCellText(row, 0));
+        for ( int col = 1; col < listCtrlCols; col++ )
+            list->SetItem(row, col, GetCellText(row, col));
+
+        list->SetItemData(row, GetCellNumber(row, 1));
+    }
+
+    return list;
+}
+
+wxListCtrl* gs_listCtrl = NULL;
+
+bool ListCtrlInit()
+{
+    gs_listCtrl = CreateListCtrl(GetRowsCount());
+
+    return true;
+}
+
+bool ListCtrlShownInit()
+{
+    ListCtrlInit();
+    ShowControl(gs_listCtrl);
+
+    return true;
+}
+
+void ListCtrlDone()
+{
+    HideControl(gs_listCtrl);
+
+    delete gs_listCtrl;
+    gs_listCtrl = NULL;
+}
+
+int wxCALLBACK
+ListCtrlCompare(wxIntPtr item1, wxIntPtr item2, wxIntPtr ascending)
+{
+    if ( item1 == item2 )
+        return 0;
+
+    return (item1 < item2) == (ascending != 0) ? -1 : 1;
+}
+
+} // anonymous namespace
+
+BENCHMARK_FUNC_WITH_PARAMS(ListCtrlPopulate, rowCounts)
+{
+    const int rows = GetRowsCount();
+
+    wxListCtrl* const list = CreateListCtrl(rows);
+    const bool ok = list->GetItemCount() == rows;
+    delete list;
+
+    return ok;
+}
+
+BENCHMARK_FUNC_WITH_PARAMS_AND_INIT(ListCtrlRepaint, rowCounts,
+                                    ListCtrlShownInit, ListCtrlDone)
+{
+    return RepaintControl(gs_listCtrl);
+}
+
+BENCHMARK_FUNC_WITH_PARAMS_AND_INIT(ListCtrlScrollPage, rowCounts,
+                                    ListCtrlInit, ListCtrlDone)
+{
+    static long s_item = 0;
+
+    s_item += wxMax(gs_listCtrl->GetCountPerPage(), 1);
+    if ( s_item >= gs_listCtrl->GetItemCount() )
+        s_item = 0;
+
+    return gs_listCtrl->EnsureVisible(s_item);
+}
+
+BENCHMARK_FUNC_WITH_PARAMS_AND_INIT(ListCtrlSort, rowCounts,
+                                    ListCtrlInit, ListCtrlDone)
+{
+    static bool s_ascending = false;
+    s_ascending = !s_ascending;
+
+    return gs_listCtrl->SortItems(ListCtrlCompare, s_ascending);
+}
+
+BENCHMARK_FUNC_WITH_PARAMS_AND_INIT(ListCtrlSelectAll, rowCounts,
+                                    ListCtrlInit, ListCtrlDone)
+{
+    gs_listCtrl->SetItemState(-1, wxLIST_STATE_SELECTED, wxLIST_STATE_SELECTED);
+
+    const bool ok = gs_listCtrl->GetSelectedItemCount() ==
+                        gs_listCtrl->GetItemCount();
+
+    gs_listCtrl->SetItemState(-1, 0, wxLIST_STATE_SELECTED);
+
+    return ok;
+}
+
+#endif // wxUSE_LISTCTRL
+
+// ----------------------------------------------------------------------------
+// wxTreeCtrl
+// ----------------------------------------------------------------------------
+
+#if wxUSE_TREECTRL
+
+namespace
+{
+
+// Tree control allowing to sort its items in either order.
+class BenchTreeCtrl : public wxTreeCtrl
+{
+public:
+    BenchTreeCtrl() { m_ascending = true; }
+
+    explicit BenchTreeCtrl(wxWindow* parent)
+        : wxTreeCtrl(parent, wxID_ANY,
+                     wxDefaultPosition, wxSize(controlWidth, controlHeight),
+                     wxTR_DEFAULT_STYLE | wxTR_HIDE_ROOT | wxTR_MULTIPLE)
+    {
+        m_ascending = true;
+    }
+
+    void SetSortAscending(bool ascending) { m_ascending = ascending; }
+
+    virtual int OnCompareItems(const wxTreeItemId& item1,
+                               const wxTreeItemId& item2) wxOVERRIDE
+    {
+        const int rc = wxTreeCtrl::OnCompareItems(item1, item2);
+
+        return m_ascending ? rc : -rc;
+    }
+
+private:
+    bool m_ascending;
+
+    wxDECLARE_DYNAMIC_CLASS(BenchTreeCtrl);
+};
+
+wxIMPLEMENT_DYNAMIC_CLASS(BenchTreeCtrl, wxTreeCtrl);
+
+BenchTreeCtrl* CreateTreeCtrl(int rows)
+{
+    BenchTreeCtrl* const tree = new BenchTreeCtrl(GetParentWindow());
+
+    const wxTreeItemId root = tree->AddRoot("Root");
+    for ( int row = 0; row < rows; row++ )
+        tree->AppendItem(root, GetCellText(row, 0));
+
+    return tree;
+}
+
+BenchTreeCtrl* gs_treeCtrl = NULL;
+
+// All top level items of gs_treeCtrl, in their initial order.
+wxVector<wxTreeItemId> gs_treeItems;
+
+// Number of items fitting into one page of gs_treeCtrl.
+int gs_treeItemsPerPage = 1;
+
+bool TreeCtrlInit()
+{
+    gs_treeCtrl = CreateTreeCtrl(GetRowsCount());
+
+    const wxTreeItemId root = gs_treeCtrl->GetRootItem();
+    wxTreeItemIdValue cookie;
+    for ( wxTreeItemId item = gs_treeCtrl->GetFirstChild(root, cookie);
+          item.IsOk();
+          item = gs_treeCtrl->GetNextChild(root, cookie) )
+    {
+        gs_treeItems.push_back(item);
+    }
+
+    // Make sure the items positions are computed before using them.
+    gs_treeCtrl->EnsureVisible(gs_treeItems[0]);
+
+    wxRect rect;
+    if ( gs_treeCtrl->GetBoundingRect(gs_treeItems[0], rect) && rect.height )
+        gs_treeItemsPerPage = wxMax(controlHeight / rect.height, 1);
+
+    return true;
+}
+
+bool TreeCtrlShownInit()
+{
+    TreeCtrlInit();
+    ShowControl(gs_treeCtrl);
+
+    return true;
+}
+
+void TreeCtrlDone()
+{
+    HideControl(gs_treeCtrl);
+
+    gs_treeItems.clear();
+
+    delete gs_treeCtrl;
+    gs_treeCtrl = NULL;
+}
+
+} // anonymous namespace
+
+BENCHMARK_FUNC_WITH_PARAMS(TreeCtrlPopulate, rowCounts)
+{
+    const int rows = GetRowsCount();
+
+    BenchTreeCtrl* const tree = CreateTreeCtrl(rows);
+    const bool ok = tree->GetCount() == static_cast<unsigned>(rows);
+    delete tree;
+
+    return ok;
+}
+
+BENCHMARK_FUNC_WITH_PARAMS_AND_INIT(TreeCtrlRepaint, rowCounts,
+                                    TreeCtrlShownInit, TreeCtrlDone)
+{
+    return RepaintControl(gs_treeCtrl);
+}
+
+BENCHMARK_FUNC_WITH_PARAMS_AND_INIT(TreeCtrlScrollPage, rowCounts,
+                                    TreeCtrlInit, TreeCtrlDone)
+{
+    static size_t s_item = 0;
+
+    s_item += gs_treeItemsPerPage;
+    if ( s_item >= gs_treeItems.size() )
+        s_item = 0;
+
+    gs_treeCtrl->EnsureVisible(gs_treeItems[s_item]);
+
+    return true;
+}
+
+BENCHMARK_FUNC_WITH_PARAMS_AND_INIT(TreeCtrlSort, rowCounts,
+                                    TreeCtrlInit, TreeCtrlDone)
+{
+    static bool s_ascending = false;
+    s_ascending = !s_ascending;
+
+    gs_treeCtrl->SetSortAscending(s_ascending);
+    gs_treeCtrl->SortChildren(gs_treeCtrl->GetRootItem());
+
+    return true;
+}
+
+BENCHMARK_FUNC_WITH_PARAMS_AND_INIT(TreeCtrlSelectAll, rowCounts,
+                                    TreeCtrlInit, TreeCtrlDone)
+{
+    gs_treeCtrl->SelectChildren(gs_treeCtrl->GetRootItem());
+
+    wxArrayTreeItemIds selections;
+    const bool ok = gs_treeCtrl->GetSelections(selections) ==
+                        gs_treeItems.size();
+
+    gs_treeCtrl->UnselectAll();
+
+    return ok;
+}
+
+#endif // wxUSE_TREECTRL
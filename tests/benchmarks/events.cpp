@@ -0,0 +1,238 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        tests/benchmarks/events.cpp
+// Purpose:     Benchmarks for processing and queuing events
+// Author:      wxWidgets team
+// Created:     2026-10-18
+// Copyright:   (c) 2026 wxWidgets team
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#include "wx/app.h"
+#include "wx/event.h"
+#include "wx/thread.h"
+#include "wx/vector.h"
+
+#include "bench.h"
+
+// ----------------------------------------------------------------------------
+// Dispatching events to the dynamically bound handlers
+// ----------------------------------------------------------------------------
+
+namespace
+{
+
+// The handler with one handler for the event type being processed and the
+// given number of handlers for the other event types bound after it.
+class ManyHandlers : public wxEvtHandler
+{
+public:
+    explicit ManyHandlers(int numOtherTypes)
+    {
+        m_count = 0;
+
+        Bind(wxEVT_THREAD, &ManyHandlers::OnEvent, this);
+
+        for ( int n = 0; n < numOtherTypes; n++ )
+            Bind(wxEventTypeTag<wxThreadEvent>(wxNewEventType()),
+                 &ManyHandlers::OnEvent, this);
+    }
+
+    int GetCount() const { return m_count; }
+
+private:
+    void OnEvent(wxThreadEvent& WXUNUSED(event)) { m_count++; }
+
+    int m_count;
+};
+
+} // anonymous namespace
+
+static const long otherTypesCounts[] = { 0, 10, 50 };
+
+BENCHMARK_FUNC_WITH_PARAMS(ProcessEventWithManyHandlers, otherTypesCounts)
+{
+    static const int NUM_DISPATCHED = 1000;
+
+    ManyHandlers handler(Bench::GetNumericParameter());
+
+    wxThreadEvent event;
+    for ( int n = 0; n < NUM_DISPATCHED; n++ )
+        handler.ProcessEventLocally(event);
+
+    return handler.GetCount() == NUM_DISPATCHED;
+}
+
+// ----------------------------------------------------------------------------
+// Queuing events from the other threads
+// ----------------------------------------------------------------------------
+
+#if wxUSE_THREADS
+
+// All the benchmarks here post the same total number of events, split between
+// the given number of the worker threads, and measure the time needed for the
+// main thread to process all of them (or, for the coalesced events, all those
+// which were not replaced by the later ones).
+static const int NUM_EVENTS = 100000;
+
+static const long threadCounts[] = { 1, 2, 4, 8 };
+
+namespace
+{
+
+// The handler counting the events it receives.
+class EventsCounter : public wxEvtHandler
+{
+public:
+    EventsCounter()
+    {
+        m_count = 0;
+
+        Bind(wxEVT_THREAD, &EventsCounter::OnThreadEvent, this);
+    }
+
+    void Increment() { m_count++; }
+
+    int GetCount() const { return m_count; }
+
+private:
+    void OnThreadEvent(wxThreadEvent& WXUNUSED(event)) { Increment(); }
+
+    int m_count;
+};
+
+// The thread posting the events to the counter.
+class PostingThread : public wxThread
+{
+public:
+    enum Kind
+    {
+        Kind_QueueEvent,
+        Kind_QueueCoalescedEvent,
+        Kind_CallAfter
+    };
+
+    PostingThread(EventsCounter& counter, Kind kind, int key, int count)
+        : wxThread(wxTHREAD_JOINABLE),
+          m_counter(counter),
+          m_kind(kind),
+          m_key(key),
+          m_count(count)
+    {
+    }
+
+    virtual ExitCode Entry() wxOVERRIDE
+    {
+        for ( int n = 0; n < m_count; n++ )
+        {
+            switch ( m_kind )
+            {
+                case Kind_QueueEvent:
+                    wxQueueEvent(&m_counter, new wxThreadEvent());
+                    break;
+
+                case Kind_QueueCoalescedEvent:
+                    m_counter.QueueCoalescedEvent(m_key, new wxThreadEvent());
+                    break;
+
+                case Kind_CallAfter:
+                    m_counter.CallAfter(&EventsCounter::Increment);
+                    break;
+            }
+        }
+
+        return 0;
+    }
+
+private:
+    EventsCounter& m_counter;
+    const Kind m_kind;
+    const int m_key;
+    const int m_count;
+};
+
+bool PostFromThreads(PostingThread::Kind kind)
+{
+    const int numThreads = Bench::GetNumericParameter();
+
+    EventsCounter counter;
+
+    wxVector<PostingThread*> threads;
+    for ( int n = 0; n < numThreads; n++ )
+    {
+        PostingThread* const
+            thread = new PostingThread(counter, kind, n, NUM_EVENTS / numThreads);
+        if ( thread->Run() != wxTHREAD_NO_ERROR )
+        {
+            delete thread;
+            break;
+        }
+
+        threads.push_back(thread);
+    }
+
+    // Process the events while they're being posted, just as the main event
+    // loop would do.
+    const int expected = (NUM_EVENTS / numThreads) * threads.size();
+    for ( ;; )
+    {
+        if ( wxTheApp->HasPendingEvents() )
+        {
+            wxTheApp->ProcessPendingEvents();
+            continue;
+        }
+
+        if ( kind == PostingThread::Kind_QueueCoalescedEvent )
+        {
+            // We don't know how many events will be processed in this case,
+            // so just wait until all of them are posted.
+            bool running = false;
+            for ( size_t n = 0; n < threads.size(); n++ )
+            {
+                if ( threads[n]->IsRunning() )
+                {
+                    running = true;
+                    break;
+                }
+            }
+
+            if ( !running && !wxTheApp->HasPendingEvents() )
+                break;
+        }
+        else if ( counter.GetCount() >= expected )
+        {
+            break;
+        }
+
+        wxThread::Yield();
+    }
+
+    for ( size_t n = 0; n < threads.size(); n++ )
+    {
+        threads[n]->Wait();
+        delete threads[n];
+    }
+
+    if ( kind == PostingThread::Kind_QueueCoalescedEvent )
+        return !threads.empty() && counter.GetCount() > 0;
+
+    return !threads.empty() && counter.GetCount() == expected;
+}
+
+} // anonymous namespace
+
+BENCHMARK_FUNC_WITH_PARAMS(QueueEventFromThreads, threadCounts)
+{
+    return PostFromThreads(PostingThread::Kind_QueueEvent);
+}
+
+BENCHMARK_FUNC_WITH_PARAMS(QueueCoalescedEventFromThreads, threadCounts)
+{
+    return PostFromThreads(PostingThread::Kind_QueueCoalescedEvent);
+}
+
+BENCHMARK_FUNC_WITH_PARAMS(CallAfterFromThreads, threadCounts)
+{
+    return PostFromThreads(PostingThread::Kind_CallAfter);
+}
+
+#endif // wxUSE_THREADS
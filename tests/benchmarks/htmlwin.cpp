@@ -0,0 +1,146 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        tests/benchmarks/htmlwin.cpp
+// Purpose:     wxHtmlWindow benchmarks
+// Author:      wxWidgets team
+// Created:     2026-10-18
+// Copyright:   (c) 2026 wxWidgets team
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+// The page is drawn into a wxMemoryDC directly, so the window doesn't need to
+// be shown and these benchmarks can be run without a display, except for the
+// one required by the toolkit itself. As with the other controls benchmarks,
+// they should be run with a small number of runs, e.g. "-n 1 -a 5".
+
+#include "wx/app.h"
+#include "wx/bitmap.h"
+#include "wx/dcmemory.h"
+
+#include "bench.h"
+
+#if wxUSE_HTML
+
+#include "wx/html/htmlwin.h"
+
+// Number of rows in the table shown in the HTML page.
+static const long tableRows[] = { 10000, 100000 };
+
+static const int htmlWinWidth = 800;
+static const int htmlWinHeight = 600;
+
+namespace
+{
+
+// Return the HTML page containing the table with the number of rows given by
+// the numeric parameter.
+const wxString& GetTestPage()
+{
+    static wxString s_page;
+    static long s_rows = -1;
+
+    long rows = Bench::GetNumericParameter();
+    if ( rows <= 0 )
+        rows = tableRows[0];
+
+    if ( rows != s_rows )
+    {
+        s_rows = rows;
+
+        s_page = "<html><body><table border=\"1\">\n";
+        for ( long row = 0; row < rows; row++ )
+        {
+            s_page += wxString::Format
+                      (
+                        "<tr><td>%ld</td><td><b>Row</b> number %ld</td>"
+                        "<td align=\"right\"><i>%lx</i></td></tr>\n",
+                        row, row, row * 2654435761ul
+                      );
+        }
+        s_page += "</table></body></html>";
+    }
+
+    return s_page;
+}
+
+wxHtmlWindow* CreateHtmlWindow()
+{
+    return new wxHtmlWindow(wxTheApp->GetTopWindow(), wxID_ANY,
+                            wxDefaultPosition,
+                            wxSize(htmlWinWidth, htmlWinHeight));
+}
+
+wxHtmlWindow* gs_htmlWin = NULL;
+
+bool HtmlWindowInit()
+{
+    gs_htmlWin = CreateHtmlWindow();
+
+    return gs_htmlWin->SetPage(GetTestPage());
+}
+
+void HtmlWindowDone()
+{
+    delete gs_htmlWin;
+    gs_htmlWin = NULL;
+}
+
+// Draw the part of the page starting at the given vertical position.
+bool RenderHtmlPage(int y)
+{
+    static wxBitmap s_bitmap(htmlWinWidth, htmlWinHeight);
+
+    wxMemoryDC dc(s_bitmap);
+    dc.SetBackground(*wxWHITE_BRUSH);
+    dc.Clear();
+    dc.SetDeviceOrigin(0, -y);
+
+    wxHtmlContainerCell* const cell = gs_htmlWin->GetInternalRepresentation();
+
+    wxHtmlRenderingInfo rinfo;
+    wxDefaultHtmlRenderingStyle rstyle(gs_htmlWin);
+    rinfo.SetStyle(&rstyle);
+    cell->Draw(dc, 0, 0, y, y + htmlWinHeight, rinfo);
+
+    return cell->GetHeight() > y;
+}
+
+} // anonymous namespace
+
+BENCHMARK_FUNC_WITH_PARAMS(HtmlWindowSetPage, tableRows)
+{
+    wxHtmlWindow* const win = CreateHtmlWindow();
+    const bool ok = win->SetPage(GetTestPage());
+    delete win;
+
+    return ok;
+}
+
+BENCHMARK_FUNC_WITH_PARAMS_AND_INIT(HtmlWindowRender, tableRows,
+                                    HtmlWindowInit, HtmlWindowDone)
+{
+    return RenderHtmlPage(0);
+}
+
+BENCHMARK_FUNC_WITH_PARAMS_AND_INIT(HtmlWindowScrollPage, tableRows,
+                                    HtmlWindowInit, HtmlWindowDone)
+{
+    static int s_y = 0;
+
+    s_y += htmlWinHeight;
+    if ( s_y >= gs_htmlWin->GetInternalRepresentation()->GetHeight() )
+        s_y = 0;
+
+    gs_htmlWin->Scroll(-1, s_y / wxHTML_SCROLL_STEP);
+
+    return RenderHtmlPage(s_y);
+}
+
+BENCHMARK_FUNC_WITH_PARAMS_AND_INIT(HtmlWindowSelectAll, tableRows,
+                                    HtmlWindowInit, HtmlWindowDone)
+{
+    gs_htmlWin->SelectAll();
+
+    return !gs_htmlWin->SelectionToText().empty();
+}
+
+#endif // wxUSE_HTML
@@ -8,6 +8,9 @@
 /////////////////////////////////////////////////////////////////////////////
 
 #include "wx/image.h"
+#include "wx/stopwatch.h"
+
+#include "wx/private/image.h"
 
 #include "bench.h"
 
@@ -76,7 +79,43 @@ BENCHMARK_FUNC(EnlargeNormal)
     return GetTestImage().Scale(300, 300, wxIMAGE_QUALITY_NORMAL).IsOk();
 }
 
-BENCHMARK_FUNC(EnlargeHighQuality)
+// The resampling benchmarks below use the implementation specified by the
+// string parameter, e.g. "-s AVX", or the default one if it is empty.
+static wxImageResampleImpl gs_resampleImplOld = wxIMAGE_RESAMPLE_IMPL_DEFAULT;
+
+static bool InitResampleImpl()
+{
+    const wxString name = Bench::GetStringParameter();
+    if ( name.empty() )
+        return true;
+
+    for ( int n = wxIMAGE_RESAMPLE_IMPL_DEFAULT; n < wxIMAGE_RESAMPLE_IMPL_MAX; n++ )
+    {
+        const wxImageResampleImpl impl = static_cast<wxImageResampleImpl>(n);
+        if ( name.CmpNoCase(wxImageGetResampleImplName(impl)) != 0 )
+            continue;
+
+        if ( !wxImageIsResampleImplAvailable(impl) )
+        {
+            wxPrintf("Resampling implementation \"%s\" is not available.\n",
+                     name);
+            return false;
+        }
+
+        gs_resampleImplOld = wxImageSetResampleImpl(impl);
+        return true;
+    }
+
+    wxPrintf("Unknown resampling implementation \"%s\".\n", name);
+    return false;
+}
+
+static void DoneResampleImpl()
+{
+    wxImageSetResampleImpl(gs_resampleImplOld);
+}
+
+BENCHMARK_FUNC_WITH_INIT(EnlargeHighQuality, InitResampleImpl, DoneResampleImpl)
 {
     return GetTestImage().Scale(300, 300, wxIMAGE_QUALITY_HIGH).IsOk();
 }
@@ -86,7 +125,104 @@ BENCHMARK_FUNC(ShrinkNormal)
     return GetTestImage().Scale(50, 50, wxIMAGE_QUALITY_NORMAL).IsOk();
 }
 
-BENCHMARK_FUNC(ShrinkHighQuality)
+BENCHMARK_FUNC_WITH_INIT(ShrinkHighQuality, InitResampleImpl, DoneResampleImpl)
 {
     return GetTestImage().Scale(50, 50, wxIMAGE_QUALITY_HIGH).IsOk();
 }
+
+// Report the throughput of all available resampling implementations, in
+// megapixels of output per second. The numeric parameter can be used to
+// specify the size of the output image, 1000*1000 pixels by default.
+BENCHMARK_FUNC(ResampleThroughput)
+{
+    const wxImage& image = GetTestImage();
+    if ( !image.IsOk() )
+        return false;
+
+    wxImage imageAlpha = image.Copy();
+    if ( !imageAlpha.HasAlpha() )
+        imageAlpha.InitAlpha();
+
+    const int size = Bench::GetNumericParameter() > 0
+                        ? Bench::GetNumericParameter()
+                        : 1000;
+
+    static const struct
+    {
+        const char* name;
+        wxImageResizeQuality quality;
+        bool alpha;
+    } tests[] =
+    {
+        { "bilinear",           wxIMAGE_QUALITY_BILINEAR,   false },
+        { "bilinear+alpha",     wxIMAGE_QUALITY_BILINEAR,   true  },
+        { "bicubic",            wxIMAGE_QUALITY_BICUBIC,    false },
+        { "bicubic+alpha",      wxIMAGE_QUALITY_BICUBIC,    true  },
+    };
+
+    wxPrintf("\n");
+
+    const wxImageResampleImpl implOld = wxImageGetResampleImpl();
+    for ( size_t t = 0; t < WXSIZEOF(tests); t++ )
+    {
+        const wxImage& src = tests[t].alpha ? imageAlpha : image;
+
+        for ( int n = wxIMAGE_RESAMPLE_IMPL_SCALAR; n < wxIMAGE_RESAMPLE_IMPL_MAX; n++ )
+        {
+            const wxImageResampleImpl impl = static_cast<wxImageResampleImpl>(n);
+            if ( !wxImageIsResampleImplAvailable(impl) )
+                continue;
+
+            wxImageSetResampleImpl(impl);
+
+            wxStopWatch sw;
+            if ( !src.Scale(size, size, tests[t].quality).IsOk() )
+                return false;
+            const long ms = sw.Time();
+
+            wxPrintf("\t%-16s %-8s %8.2f Mpx/s\n",
+                     tests[t].name,
+                     wxImageGetResampleImplName(impl),
+                     ms ? (double)size*size / ms / 1000. : 0.);
+        }
+    }
+
+    wxImageSetResampleImpl(implOld);
+
+    return true;
+}
+
+// The benchmarks below are run for all these image sizes by default.
+static const long imageSizes[] = { 64, 256, 1024, 2048 };
+
+// Return the test image scaled to the square of the size given by the numeric
+// parameter.
+static const wxImage& GetTestImageOfSize()
+{
+    static wxImage s_image;
+
+    const int size = Bench::GetNumericParameter() > 0
+                        ? Bench::GetNumericParameter()
+                        : GetTestImage().GetWidth();
+    if ( !s_image.IsOk() || s_image.GetWidth() != size )
+        s_image = GetTestImage().Scale(size, size, wxIMAGE_QUALITY_NORMAL);
+
+    return s_image;
+}
+
+BENCHMARK_FUNC_WITH_PARAMS(ShrinkBilinearSize, imageSizes)
+{
+    const wxImage& image = GetTestImageOfSize();
+    return image.Scale(image.GetWidth() / 2, image.GetHeight() / 2,
+                       wxIMAGE_QUALITY_BILINEAR).IsOk();
+}
+
+BENCHMARK_FUNC_WITH_PARAMS(BlurSize, imageSizes)
+{
+    return GetTestImageOfSize().Blur(3).IsOk();
+}
+
+BENCHMARK_FUNC_WITH_PARAMS(RotateSize, imageSizes)
+{
+    return GetTestImageOfSize().Rotate90().IsOk();
+}
@@ -0,0 +1,155 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        tests/benchmarks/richtext.cpp
+// Purpose:     wxRichTextCtrl benchmarks
+// Author:      wxWidgets team
+// Created:     2026-10-18
+// Copyright:   (c) 2026 wxWidgets team
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+// The buffer is drawn into a wxMemoryDC directly, so the control doesn't need
+// to be shown and these benchmarks can be run without a display, except for
+// the one required by the toolkit itself. As with the other controls
+// benchmarks, they should be run with a small number of runs, e.g. "-n 1 -a 5".
+
+#include "wx/app.h"
+#include "wx/bitmap.h"
+#include "wx/dcmemory.h"
+
+#include "bench.h"
+
+#if wxUSE_RICHTEXT
+
+#include "wx/richtext/richtextctrl.h"
+
+// Number of paragraphs in the control.
+static const long paragraphCounts[] = { 10000, 100000 };
+
+static const int richTextWidth = 800;
+static const int richTextHeight = 600;
+
+namespace
+{
+
+// Return the text consisting of the number of paragraphs given by the numeric
+// parameter.
+const wxString& GetTestText()
+{
+    static wxString s_text;
+    static long s_paragraphs = -1;
+
+    long paragraphs = Bench::GetNumericParameter();
+    if ( paragraphs <= 0 )
+        paragraphs = paragraphCounts[0];
+
+    if ( paragraphs != s_paragraphs )
+    {
+        s_paragraphs = paragraphs;
+
+        s_text.clear();
+        for ( long n = 0; n < paragraphs; n++ )
+        {
+            if ( n )
+                s_text += '\n';
+
+            s_text += wxString::Format("Paragraph %ld of the rich text "
+                                       "control benchmark.", n);
+        }
+    }
+
+    return s_text;
+}
+
+wxRichTextCtrl* CreateRichText()
+{
+    wxRichTextCtrl* const text = new wxRichTextCtrl
+                                     (
+                                        wxTheApp->GetTopWindow(),
+                                        wxID_ANY,
+                                        wxString(),
+                                        wxDefaultPosition,
+                                        wxSize(richTextWidth, richTextHeight)
+                                     );
+
+    text->SetValue(GetTestText());
+    text->LayoutContent();
+
+    return text;
+}
+
+wxRichTextCtrl* gs_richText = NULL;
+
+bool RichTextInit()
+{
+    gs_richText = CreateRichText();
+
+    return true;
+}
+
+void RichTextDone()
+{
+    delete gs_richText;
+    gs_richText = NULL;
+}
+
+// Draw the part of the buffer starting at the given vertical position.
+bool RenderRichTextPage(int y)
+{
+    static wxBitmap s_bitmap(richTextWidth, richTextHeight);
+
+    wxMemoryDC dc(s_bitmap);
+    dc.SetBackground(*wxWHITE_BRUSH);
+    dc.Clear();
+    dc.SetDeviceOrigin(0, -y);
+
+    wxRichTextBuffer& buffer = gs_richText->GetBuffer();
+    wxRichTextDrawingContext context(&buffer);
+
+    return buffer.Draw(dc, context, buffer.GetOwnRange(),
+                       wxRichTextSelection(),
+                       wxRect(0, y, richTextWidth, richTextHeight),
+                       0 /* descent */, 0 /* flags */);
+}
+
+} // anonymous namespace
+
+BENCHMARK_FUNC_WITH_PARAMS(RichTextPopulate, paragraphCounts)
+{
+    wxRichTextCtrl* const text = CreateRichText();
+    const bool ok = !text->IsEmpty();
+    delete text;
+
+    return ok;
+}
+
+BENCHMARK_FUNC_WITH_PARAMS_AND_INIT(RichTextRender, paragraphCounts,
+                                    RichTextInit, RichTextDone)
+{
+    return RenderRichTextPage(0);
+}
+
+BENCHMARK_FUNC_WITH_PARAMS_AND_INIT(RichTextScrollPage, paragraphCounts,
+                                    RichTextInit, RichTextDone)
+{
+    if ( !gs_richText->PageDown() )
+        gs_richText->MoveHome();
+
+    int unitY;
+    gs_richText->GetScrollPixelsPerUnit(NULL, &unitY);
+
+    return RenderRichTextPage(gs_richText->GetViewStart().y * unitY);
+}
+
+BENCHMARK_FUNC_WITH_PARAMS_AND_INIT(RichTextSelectAll, paragraphCounts,
+                                    RichTextInit, RichTextDone)
+{
+    gs_richText->SelectAll();
+
+    const bool ok = gs_richText->HasSelection();
+
+    gs_richText->SelectNone();
+
+    return ok;
+}
+
+#endif // wxUSE_RICHTEXT
@@ -292,6 +292,54 @@ BENCHMARK_FUNC(ReplaceShorter)
     return str.Replace("xx", "y") != 0;
 }
 
+// ----------------------------------------------------------------------------
+// string length dependency
+// ----------------------------------------------------------------------------
+
+// The benchmarks below are run for all these string lengths by default.
+static const long stringLengths[] = { 16, 256, 4096, 65536 };
+
+namespace
+{
+
+// Return ASCII string of the length given by the numeric parameter.
+const wxString& GetTestStringOfLength()
+{
+    static wxString s_str;
+
+    const long len = Bench::GetNumericParameter() > 0
+                        ? Bench::GetNumericParameter()
+                        : 1;
+    if ( s_str.length() != static_cast<size_t>(len) )
+    {
+        s_str.clear();
+        while ( s_str.length() < static_cast<size_t>(len) )
+            s_str += wxString::FromAscii(asciistr);
+        s_str.Truncate(len);
+    }
+
+    return s_str;
+}
+
+} // anonymous namespace
+
+BENCHMARK_FUNC_WITH_PARAMS(ToUTF8Length, stringLengths)
+{
+    return GetTestStringOfLength().utf8_str().length() != 0;
+}
+
+BENCHMARK_FUNC_WITH_PARAMS(FindLength, stringLengths)
+{
+    // Search for a character which doesn't occur in the string.
+    return GetTestStringOfLength().find('#') == wxString::npos;
+}
+
+BENCHMARK_FUNC_WITH_PARAMS(CmpNoCaseLength, stringLengths)
+{
+    const wxString& str = GetTestStringOfLength();
+    return str.CmpNoCase(str) == 0;
+}
+
 // ----------------------------------------------------------------------------
 // string case conversion
 // ----------------------------------------------------------------------------
@@ -17,6 +17,7 @@
 
 #include "wx/app.h"
 #include "wx/dataview.h"
+#include "wx/scopedptr.h"
 #ifdef __WXGTK__
     #include "wx/stopwatch.h"
 #endif // __WXGTK__
@@ -88,6 +89,114 @@ protected:
     wxDECLARE_NO_COPY_CLASS(MultiColumnsDataViewCtrlTestCase);
 };
 
+// A simple list model using the default comparison function.
+class SortByValuesModel : public wxDataViewIndexListModel
+{
+public:
+    explicit SortByValuesModel(const wxArrayString& values)
+        : wxDataViewIndexListModel(values.size()),
+          m_values(values)
+    {
+    }
+
+    virtual unsigned int GetColumnCount() const wxOVERRIDE { return 1; }
+
+    virtual wxString GetColumnType(unsigned int WXUNUSED(col)) const wxOVERRIDE
+    {
+        return "string";
+    }
+
+    virtual void GetValueByRow(wxVariant& variant,
+                               unsigned int row,
+                               unsigned int WXUNUSED(col)) const wxOVERRIDE
+    {
+        variant = m_values[row];
+    }
+
+    virtual bool SetValueByRow(const wxVariant& WXUNUSED(variant),
+                               unsigned int WXUNUSED(row),
+                               unsigned int WXUNUSED(col)) wxOVERRIDE
+    {
+        return false;
+    }
+
+    virtual bool UsesDefaultCompare() const wxOVERRIDE { return true; }
+
+private:
+    const wxArrayString m_values;
+};
+
+// A list model counting the number of times its values were retrieved.
+class CountingValuesModel : public wxDataViewIndexListModel
+{
+public:
+    explicit CountingValuesModel(const wxArrayString& values)
+        : wxDataViewIndexListModel(values.size()),
+          m_values(values),
+          m_getValueCount(0)
+    {
+    }
+
+    int GetValueCount() const { return m_getValueCount; }
+
+    virtual unsigned int GetColumnCount() const wxOVERRIDE { return 1; }
+
+    virtual wxString GetColumnType(unsigned int WXUNUSED(col)) const wxOVERRIDE
+    {
+        return "string";
+    }
+
+    virtual void GetValueByRow(wxVariant& variant,
+                               unsigned int row,
+                               unsigned int WXUNUSED(col)) const wxOVERRIDE
+    {
+        m_getValueCount++;
+        variant = m_values[row];
+    }
+
+    virtual bool SetValueByRow(const wxVariant& variant,
+                               unsigned int row,
+                               unsigned int WXUNUSED(col)) wxOVERRIDE
+    {
+        m_values[row] = variant.GetString();
+        return true;
+    }
+
+private:
+    wxArrayString m_values;
+    mutable int m_getValueCount;
+};
+
+// Return the indices of the items of the model in the order in which they're
+// shown in the control, which must show all of them.
+static wxString GetItemsOrder(wxDataViewCtrl* dvc, SortByValuesModel* model)
+{
+#ifdef __WXGTK__
+    wxYield();
+#endif // __WXGTK__
+
+    const unsigned count = model->GetCount();
+
+    wxVector<int> positions;
+    for ( unsigned n = 0; n < count; n++ )
+        positions.push_back(dvc->GetItemRect(model->GetItem(n)).y);
+
+    wxString order(' ', count);
+    for ( unsigned n = 0; n < count; n++ )
+    {
+        unsigned pos = 0;
+        for ( unsigned m = 0; m < count; m++ )
+        {
+            if ( positions[m] < positions[n] )
+                pos++;
+        }
+
+        order[pos] = static_cast<char>('0' + n);
+    }
+
+    return order;
+}
+
 // ----------------------------------------------------------------------------
 // test initialization
 // ----------------------------------------------------------------------------
@@ -295,6 +404,100 @@ TEST_CASE_METHOD(SingleSelectDataViewCtrlTestCase,
     CHECK( m_dvc->IsExpanded(m_child1) );
 }
 
+TEST_CASE_METHOD(MultiSelectDataViewCtrlTestCase,
+                 "wxDVC::ManyChildren",
+                 "[wxDataViewCtrl][expand]")
+{
+    // Use enough items for the generic version to index them.
+    wxDataViewItemArray items;
+    for ( int i = 0; i < 200; ++i )
+        items.push_back(m_dvc->AppendItem(m_root, wxString::Format("item%d", i)));
+
+    m_dvc->Expand(m_child1);
+    CHECK( m_dvc->IsExpanded(m_child1) );
+
+    wxDataViewItemArray sel;
+    sel.push_back(m_grandchild);
+    sel.push_back(items[0]);
+    sel.push_back(items[150]);
+    sel.push_back(items[199]);
+    m_dvc->SetSelections(sel);
+
+    wxDataViewItemArray selected;
+    CHECK( m_dvc->GetSelections(selected) == 4 );
+    CHECK( m_dvc->IsSelected(m_grandchild) );
+    CHECK( m_dvc->IsSelected(items[150]) );
+    CHECK( !m_dvc->IsSelected(items[149]) );
+    CHECK( !m_dvc->IsSelected(items[151]) );
+
+    // Collapsing and deleting items must shift the selection correctly.
+    m_dvc->Collapse(m_child1);
+    m_dvc->DeleteItem(items[100]);
+
+    CHECK( m_dvc->GetSelections(selected) == 3 );
+    CHECK( m_dvc->IsSelected(items[0]) );
+    CHECK( m_dvc->IsSelected(items[150]) );
+    CHECK( m_dvc->IsSelected(items[199]) );
+    CHECK( !m_dvc->IsSelected(items[149]) );
+    CHECK( !m_dvc->IsSelected(items[151]) );
+}
+
+TEST_CASE_METHOD(MultiSelectDataViewCtrlTestCase,
+                 "wxDVC::Batch",
+                 "[wxDataViewCtrl][batch]")
+{
+    wxDataViewModel* const model = m_dvc->GetModel();
+
+    m_dvc->Select(m_child2);
+
+    model->BeginBatch();
+    CHECK( model->IsInBatch() );
+
+    const wxDataViewItem first = m_dvc->PrependItem(m_root, "first");
+    const wxDataViewItem second = m_dvc->PrependItem(m_root, "second");
+    const wxDataViewItem last = m_dvc->AppendItem(m_root, "last");
+
+    // Nested batches are allowed too.
+    model->BeginBatch();
+    m_dvc->DeleteItem(second);
+    const wxDataViewItem inner = m_dvc->InsertItem(m_root, m_child1, "inner");
+    model->EndBatch();
+    CHECK( model->IsInBatch() );
+
+    model->EndBatch();
+    CHECK( !model->IsInBatch() );
+
+    // The selection must have been preserved.
+    wxDataViewItemArray selected;
+    CHECK( m_dvc->GetSelections(selected) == 1 );
+    CHECK( m_dvc->IsSelected(m_child2) );
+
+    // And the new items must be usable.
+    m_dvc->Select(first);
+    m_dvc->Select(inner);
+    m_dvc->Select(last);
+    CHECK( m_dvc->GetSelections(selected) == 4 );
+    CHECK( m_dvc->IsSelected(first) );
+    CHECK( m_dvc->IsSelected(inner) );
+    CHECK( m_dvc->IsSelected(last) );
+    CHECK( !m_dvc->IsSelected(m_child1) );
+
+    // Items changed during the batch are updated when it ends, even if some
+    // of them are deleted after being changed.
+    {
+        wxDataViewBatchUpdater batch(model);
+        CHECK( model->IsInBatch() );
+
+        m_dvc->SetItemText(first, "changed");
+        m_dvc->SetItemText(last, "deleted");
+        m_dvc->DeleteItem(last);
+    }
+    CHECK( !model->IsInBatch() );
+
+    CHECK( m_dvc->GetItemText(first) == "changed" );
+    CHECK( m_dvc->GetSelections(selected) == 3 );
+}
+
 TEST_CASE_METHOD(SingleSelectDataViewCtrlTestCase,
                  "wxDVC::GetItemRect",
                  "[wxDataViewCtrl][item]")
@@ -367,6 +570,177 @@ TEST_CASE_METHOD(SingleSelectDataViewCtrlTestCase,
     CHECK( rectRoot == wxRect() );
 }
 
+TEST_CASE("wxDVC::SortByValues", "[wxDataViewCtrl][sort]")
+{
+    wxScopedPtr<wxDataViewCtrl> dvc(new wxDataViewCtrl(wxTheApp->GetTopWindow(),
+                                                       wxID_ANY,
+                                                       wxDefaultPosition,
+                                                       wxSize(400, 200)));
+    wxDataViewColumn* const col = dvc->AppendTextColumn("Text", 0);
+
+    wxArrayString values;
+    values.push_back("c");
+    values.push_back("a");
+    values.push_back("b");
+    values.push_back("a");
+
+    SortByValuesModel* const model = new SortByValuesModel(values);
+    dvc->AssociateModel(model);
+    model->DecRef();
+
+    col->SetSortOrder(true);
+    model->Resort();
+    CHECK( GetItemsOrder(dvc.get(), model) == "1320" );
+
+    col->SetSortOrder(false);
+    model->Resort();
+    CHECK( GetItemsOrder(dvc.get(), model) == "0231" );
+}
+
+#ifdef wxHAS_GENERIC_DATAVIEWCTRL
+TEST_CASE("wxDVC::CellCache", "[wxDataViewCtrl][paint]")
+{
+    wxScopedPtr<wxDataViewCtrl> dvc(new wxDataViewCtrl(wxTheApp->GetTopWindow(),
+                                                       wxID_ANY,
+                                                       wxDefaultPosition,
+                                                       wxSize(400, 200)));
+    dvc->AppendTextColumn("Text", 0);
+
+    wxArrayString values;
+    values.push_back("foo");
+    values.push_back("bar");
+    values.push_back("baz");
+
+    CountingValuesModel* const model = new CountingValuesModel(values);
+    dvc->AssociateModel(model);
+    model->DecRef();
+
+    dvc->Refresh();
+    dvc->Update();
+
+    const int count = model->GetValueCount();
+    if ( !count )
+    {
+        WARN("Skipping test as the control wasn't repainted.");
+        return;
+    }
+
+    // Repainting the same cells again shouldn't need to query the model.
+    wxWindow* const main = dvc->GetMainWindow();
+    main->RefreshRect(main->GetClientRect());
+    dvc->Update();
+    CHECK( model->GetValueCount() == count );
+
+    // Unless the entire control is refreshed.
+    dvc->Refresh();
+    dvc->Update();
+    CHECK( model->GetValueCount() > count );
+
+    // But it must do it after the value changes.
+    const int countAfterRefresh = model->GetValueCount();
+    model->ChangeValue("quux", model->GetItem(1), 0);
+    main->RefreshRect(main->GetClientRect());
+    dvc->Update();
+    CHECK( model->GetValueCount() > countAfterRefresh );
+
+    // And after the items are deleted too, as the IDs of the items of the
+    // virtual list models change then.
+    const int countAfterChange = model->GetValueCount();
+    model->RowDeleted(0);
+    main->RefreshRect(main->GetClientRect());
+    dvc->Update();
+    CHECK( model->GetValueCount() > countAfterChange );
+}
+
+// Renderer remembering the values it rendered.
+class RecordingRenderer : public wxDataViewCustomRenderer
+{
+public:
+    explicit RecordingRenderer(wxArrayString& rendered)
+        : wxDataViewCustomRenderer("string"),
+          m_rendered(rendered)
+    {
+    }
+
+    virtual bool SetValue(const wxVariant& value) wxOVERRIDE
+    {
+        m_value = value.GetString();
+        return true;
+    }
+
+    virtual bool GetValue(wxVariant& value) const wxOVERRIDE
+    {
+        value = m_value;
+        return true;
+    }
+
+    virtual wxSize GetSize() const wxOVERRIDE
+    {
+        return wxSize(80, 20);
+    }
+
+    virtual bool Render(wxRect rect, wxDC* dc, int state) wxOVERRIDE
+    {
+        m_rendered.push_back(m_value);
+
+        RenderText(m_value, 0, rect, dc, state);
+        return true;
+    }
+
+private:
+    wxArrayString& m_rendered;
+    wxString m_value;
+};
+
+TEST_CASE("wxDVC::CellCacheInvalidation", "[wxDataViewCtrl][paint]")
+{
+    wxScopedPtr<wxDataViewCtrl> dvc(new wxDataViewCtrl(wxTheApp->GetTopWindow(),
+                                                       wxID_ANY,
+                                                       wxDefaultPosition,
+                                                       wxSize(400, 200)));
+    wxArrayString rendered;
+    dvc->AppendColumn(new wxDataViewColumn("Text",
+                                           new RecordingRenderer(rendered),
+                                           0));
+
+    wxArrayString values;
+    values.push_back("foo");
+    values.push_back("bar");
+
+    CountingValuesModel* const model = new CountingValuesModel(values);
+    dvc->AssociateModel(model);
+    model->DecRef();
+
+    dvc->Refresh();
+    dvc->Update();
+
+    if ( rendered.empty() )
+    {
+        WARN("Skipping test as the control wasn't repainted.");
+        return;
+    }
+
+    CHECK( rendered.Index("bar") != wxNOT_FOUND );
+
+    SECTION("Notified")
+    {
+        model->ChangeValue("baz", model->GetItem(1), 0);
+    }
+
+    SECTION("Refreshed")
+    {
+        model->SetValue("baz", model->GetItem(1), 0);
+        dvc->Refresh();
+    }
+
+    rendered.clear();
+    dvc->Update();
+
+    CHECK( rendered.Index("baz") != wxNOT_FOUND );
+    CHECK( rendered.Index("bar") == wxNOT_FOUND );
+}
+#endif // wxHAS_GENERIC_DATAVIEWCTRL
+
 TEST_CASE_METHOD(SingleSelectDataViewCtrlTestCase,
                  "wxDVC::DeleteAllItems",
                  "[wxDataViewCtrl][delete]")
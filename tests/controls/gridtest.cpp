@@ -14,6 +14,7 @@
 #ifndef WX_PRECOMP
     #include "wx/app.h"
     #include "wx/dcclient.h"
+    #include "wx/dcmemory.h"
 #endif // WX_PRECOMP
 
 #include "wx/grid.h"
@@ -21,10 +22,7 @@
 #include "testableframe.h"
 #include "asserthelper.h"
 #include "wx/uiaction.h"
-
-#ifdef __WXGTK__
-    #include "wx/stopwatch.h"
-#endif // __WXGTK__
+#include "wx/stopwatch.h"
 
 #include "waitforpaint.h"
 
@@ -85,6 +83,67 @@ struct EditInfo
         : pos(pos), count(count), direction(direction) { }
 };
 
+// Renderer counting the number of times it was used for drawing.
+class CountingRenderer : public wxGridCellStringRenderer
+{
+public:
+    explicit CountingRenderer(int& count) : m_count(count) { }
+
+    virtual void Draw(wxGrid& grid,
+                      wxGridCellAttr& attr,
+                      wxDC& dc,
+                      const wxRect& rect,
+                      int row, int col,
+                      bool isSelected) wxOVERRIDE
+    {
+        m_count++;
+
+        wxGridCellStringRenderer::Draw(grid, attr, dc, rect, row, col, isSelected);
+    }
+
+    virtual wxGridCellRenderer *Clone() const wxOVERRIDE
+    {
+        return new CountingRenderer(m_count);
+    }
+
+private:
+    int& m_count;
+};
+
+// Handler storing the blocks from all wxEVT_GRID_RANGE_SELECTED events.
+class RangeSelectRecorder
+{
+public:
+    explicit RangeSelectRecorder(wxGrid* grid)
+        : m_grid(grid)
+    {
+        m_grid->Bind(wxEVT_GRID_RANGE_SELECTED,
+                     &RangeSelectRecorder::OnRangeSelected, this);
+    }
+
+    ~RangeSelectRecorder()
+    {
+        m_grid->Unbind(wxEVT_GRID_RANGE_SELECTED,
+                       &RangeSelectRecorder::OnRangeSelected, this);
+    }
+
+    wxVector<wxGridBlockCoords> m_blocks;
+
+private:
+    void OnRangeSelected(wxGridRangeSelectEvent& event)
+    {
+        m_blocks.push_back(wxGridBlockCoords(event.GetTopRow(),
+                                             event.GetLeftCol(),
+                                             event.GetBottomRow(),
+                                             event.GetRightCol()));
+        event.Skip();
+    }
+
+    wxGrid* const m_grid;
+
+    wxDECLARE_NO_COPY_CLASS(RangeSelectRecorder);
+};
+
 // Derive a new class inheriting from wxGrid, also to get access to its
 // protected GetCellAttr(). This is not pretty, but we don't have any other way
 // of testing this function.
@@ -835,6 +894,63 @@ TEST_CASE_METHOD(GridTestCase, "Grid::SelectionRange", "[grid]")
 #endif
 }
 
+TEST_CASE_METHOD(GridTestCase, "Grid::SelectRows", "[grid]")
+{
+    RangeSelectRecorder select(m_grid);
+
+    wxArrayInt rows;
+    rows.push_back(5);
+    rows.push_back(1);
+    rows.push_back(2);
+    m_grid->SelectRows(rows, true);
+
+    // A single event is sent for each range of consecutive rows.
+    REQUIRE( select.m_blocks.size() == 2 );
+    CHECK( select.m_blocks[0] == wxGridBlockCoords(1, 0, 2, 1) );
+    CHECK( select.m_blocks[1] == wxGridBlockCoords(5, 0, 5, 1) );
+
+    wxGridBlocks sel = m_grid->GetSelectedBlocks();
+    wxGridBlocks::iterator it = sel.begin();
+    REQUIRE( it != sel.end() );
+    CHECK( *it == wxGridBlockCoords(1, 0, 2, 1) );
+    REQUIRE( ++it != sel.end() );
+    CHECK( *it == wxGridBlockCoords(5, 0, 5, 1) );
+    CHECK( ++it == sel.end() );
+
+    CHECK( m_grid->IsInSelection(2, 1) );
+    CHECK( !m_grid->IsInSelection(3, 0) );
+    CHECK( m_grid->IsInSelection(5, 0) );
+
+    // Selecting the already selected rows again doesn't add them to the
+    // selection nor sends events for them.
+    select.m_blocks.clear();
+    rows.push_back(3);
+    m_grid->SelectRows(rows, true);
+
+    REQUIRE( select.m_blocks.size() == 1 );
+    CHECK( select.m_blocks[0] == wxGridBlockCoords(3, 0, 3, 1) );
+
+    size_t numBlocks = 0;
+    const wxGridBlocks selNew = m_grid->GetSelectedBlocks();
+    for ( it = selNew.begin(); it != selNew.end(); ++it )
+        numBlocks++;
+    CHECK( numBlocks == 3 );
+
+    // Select many rows one by one to check that the selection index works.
+    for ( int row = 7; row < 10; row += 2 )
+        m_grid->SelectRow(row, true);
+    for ( int n = 0; n < 20; n++ )
+        m_grid->SelectRow(1, true);
+
+    CHECK( m_grid->IsInSelection(7, 0) );
+    CHECK( !m_grid->IsInSelection(8, 1) );
+    CHECK( m_grid->IsInSelection(9, 1) );
+
+    m_grid->DeselectRow(9);
+    CHECK( !m_grid->IsInSelection(9, 1) );
+    CHECK( m_grid->IsInSelection(7, 1) );
+}
+
 TEST_CASE_METHOD(GridTestCase, "Grid::SelectEmptyGrid", "[grid]")
 {
     for ( int i = 0; i < 2; ++i )
@@ -1076,6 +1192,90 @@ TEST_CASE_METHOD(GridTestCase, "Grid::ColumnVisibility", "[grid]")
     CHECK( m_grid->IsColShown(1) );
 }
 
+TEST_CASE_METHOD(GridTestCase, "Grid::LinePositions", "[grid]")
+{
+    m_grid->AppendRows(90);
+    m_grid->SetDefaultRowSize(20, true);
+
+    // Use different sizes for all rows.
+    for ( int row = 0; row < m_grid->GetNumberRows(); row++ )
+        m_grid->SetRowSize(row, 10 + row % 7);
+
+    m_grid->HideRow(5);
+
+    SECTION("Resize") { m_grid->SetRowSize(3, 40); }
+    SECTION("Show") { m_grid->ShowRow(5); }
+    SECTION("Insert") { m_grid->InsertRows(2, 3); }
+    SECTION("Append") { m_grid->AppendRows(4); }
+    SECTION("Delete")
+    {
+        // The rows shown at the given positions are deleted from the source
+        // table and the order of the remaining ones is preserved: the rows
+        // are currently shown in 2, 0, 1, 3 source order.
+        REQUIRE( table.DeleteRows(2) );
+        CHECK( table.GetNumberRows() == 3 );
+        CHECK( source->GetNumberRows() == 3 );
+        CHECK( table.GetSortKeys().size() == 2 );
+        CHECK( table.GetSourceRow(0) == 1 );
+        CHECK( table.GetSourceRow(1) == 0 );
+        CHECK( table.GetSourceRow(2) == 2 );
+        CHECK( table.GetValue(0, 1) == "c" );
+        CHECK( table.GetValue(1, 1) == "b" );
+        CHECK( table.GetValueAsLong(1, 0) == 2 );
+
+        // Deleting the rows which are not consecutive in the source table.
+        REQUIRE( table.DeleteRows(0, 2) );
+        CHECK( table.GetNumberRows() == 1 );
+        CHECK( table.GetSourceRow(0) == 0 );
+        CHECK( table.GetValue(0, 1) == "b" );
+        CHECK( table.GetValueAsLong(0, 0) == 1 );
+    }
+
+    SECTION("Append") { m_grid->AppendRows(4); }
+    SECTION("Delete") { m_grid->DeleteRows(4, 6); }
+
+    int top = 0;
+    for ( int row = 0; row < m_grid->GetNumberRows(); row++ )
+    {
+        INFO("Row " << row);
+
+        CHECK( m_grid->GetRowTop(row) == top );
+
+        const int height = m_grid->GetRowHeight(row);
+        if ( height )
+        {
+            CHECK( m_grid->YToRow(top) == row );
+            CHECK( m_grid->YToRow(top + height - 1) == row );
+        }
+
+        top += height;
+    }
+
+    CHECK( m_grid->YToRow(top) == wxNOT_FOUND );
+    CHECK( m_grid->YToRow(top, true) == m_grid->GetNumberRows() - 1 );
+
+    // Check that reordered columns are found correctly too.
+    m_grid->AppendCols(2);
+    m_grid->SetColSize(0, 30);
+    m_grid->SetColSize(1, 40);
+    m_grid->SetColSize(2, 50);
+    m_grid->SetColSize(3, 60);
+
+    wxArrayInt neworder;
+    neworder.push_back(2);
+    neworder.push_back(0);
+    neworder.push_back(3);
+    neworder.push_back(1);
+    m_grid->SetColumnsOrder(neworder);
+
+    CHECK( m_grid->GetColLeft(2) == 0 );
+    CHECK( m_grid->GetColLeft(0) == 50 );
+    CHECK( m_grid->GetColRight(1) == 180 );
+    CHECK( m_grid->XToCol(49) == 2 );
+    CHECK( m_grid->XToCol(50) == 0 );
+    CHECK( m_grid->XToCol(140) == 1 );
+}
+
 TEST_CASE_METHOD(GridTestCase, "Grid::LineFormatting", "[grid]")
 {
     CHECK(m_grid->GridLinesEnabled());
@@ -1651,6 +1851,314 @@ TEST_CASE_METHOD(GridTestCase, "Grid::AutoSizeColumn", "[grid]")
     }
 }
 
+TEST_CASE_METHOD(GridTestCase, "Grid::AutoSizeCache", "[grid]")
+{
+    m_grid->EnableAutoSizeCache();
+    REQUIRE( m_grid->IsAutoSizeCacheEnabled() );
+
+    const wxString shortStr = "W";
+    const wxString longStr  = "WWWWWWWW";
+
+    m_grid->SetColLabelValue(0, wxString());
+    m_grid->SetCellValue(0, 0, shortStr);
+    m_grid->AutoSizeColumn(0, false);
+    const int widthShort = m_grid->GetColSize(0);
+
+    // Changing the cell using wxGrid function invalidates the cache.
+    m_grid->SetCellValue(1, 0, longStr);
+    m_grid->AutoSizeColumn(0, false);
+    const int widthLong = m_grid->GetColSize(0);
+    CHECK( widthLong > widthShort );
+
+    SECTION("Table")
+    {
+        // But changing the table directly doesn't.
+        m_grid->GetTable()->SetValue(1, 0, shortStr);
+        m_grid->AutoSizeColumn(0, false);
+        CHECK( m_grid->GetColSize(0) == widthLong );
+
+        m_grid->InvalidateCellAutoSize(1, 0);
+        m_grid->AutoSizeColumn(0, false);
+        CHECK( m_grid->GetColSize(0) == widthShort );
+    }
+
+    SECTION("Delete")
+    {
+        m_grid->DeleteRows(1);
+        m_grid->AutoSizeColumn(0, false);
+        CHECK( m_grid->GetColSize(0) == widthShort );
+    }
+
+    SECTION("ColSize")
+    {
+        // The height of the wrapped text depends on the column width, so
+        // changing it must invalidate the cached row extents.
+        m_grid->SetCellValue(0, 1, "word word word word word word word word");
+        m_grid->SetCellRenderer(0, 1, new wxGridCellAutoWrapStringRenderer);
+
+        m_grid->SetColSize(1, 40);
+        m_grid->AutoSizeRow(0, false);
+        const int heightNarrow = m_grid->GetRowSize(0);
+
+        m_grid->SetColSize(1, 1000);
+        m_grid->AutoSizeRow(0, false);
+        const int heightWide = m_grid->GetRowSize(0);
+        CHECK( heightWide < heightNarrow );
+
+        // And so must showing and hiding it.
+        m_grid->SetColSize(1, 40);
+        m_grid->HideCol(1);
+        m_grid->AutoSizeRow(0, false);
+        CHECK( m_grid->GetRowSize(0) < heightNarrow );
+
+        m_grid->ShowCol(1);
+        m_grid->AutoSizeRow(0, false);
+        CHECK( m_grid->GetRowSize(0) == heightNarrow );
+    }
+
+    SECTION("Disable")
+    {
+        m_grid->EnableAutoSizeCache(false);
+        CHECK( !m_grid->IsAutoSizeCacheEnabled() );
+
+        m_grid->GetTable()->SetValue(1, 0, shortStr);
+        m_grid->AutoSizeColumn(0, false);
+        CHECK( m_grid->GetColSize(0) == widthShort );
+    }
+
+    SECTION("MaxCells")
+    {
+        m_grid->SetCellValue(1, 0, shortStr);
+        m_grid->AppendRows(1000);
+        m_grid->SetCellValue(600, 0, longStr);
+
+        // Only the cells at the beginning are measured in this case.
+        m_grid->SetAutoSizeMaxCells(100);
+        m_grid->AutoSizeColumn(0, false);
+        CHECK( m_grid->GetColSize(0) == widthShort );
+
+        m_grid->SetAutoSizeMaxCells(0);
+        m_grid->AutoSizeColumn(0, false);
+        CHECK( m_grid->GetColSize(0) == widthLong );
+    }
+}
+
+TEST_CASE_METHOD(GridTestCase, "Grid::RenderCache", "[grid]")
+{
+    m_grid->EnableRenderCache();
+    REQUIRE( m_grid->IsRenderCacheEnabled() );
+
+    wxBitmap bmp(400, 200);
+    wxMemoryDC dc(bmp);
+
+    int countOld = 0;
+    m_grid->SetCellRenderer(0, 0, new CountingRenderer(countOld));
+    m_grid->Render(dc);
+    CHECK( countOld == 1 );
+
+    // Drawing the grid again uses the cached renderer.
+    m_grid->Render(dc);
+    CHECK( countOld == 2 );
+
+    // Changing the renderer invalidates it.
+    int countNew = 0;
+    m_grid->SetCellRenderer(0, 0, new CountingRenderer(countNew));
+    m_grid->Render(dc);
+    CHECK( countOld == 2 );
+    CHECK( countNew == 1 );
+
+    SECTION("Insert")
+    {
+        // The cell is still drawn using its renderer after moving.
+        m_grid->InsertRows(0);
+        m_grid->Render(dc);
+        CHECK( countNew == 2 );
+    }
+
+    SECTION("Default")
+    {
+        // Changing the default renderer affects the other cells.
+        int countDefault = 0;
+        m_grid->SetDefaultRenderer(new CountingRenderer(countDefault));
+        m_grid->Render(dc);
+        CHECK( countNew == 2 );
+        CHECK( countDefault == m_grid->GetNumberRows() * m_grid->GetNumberCols() - 1 );
+    }
+}
+
+TEST_CASE("Grid::ColumnarTable", "[grid]")
+{
+    wxGridColumnarTable table;
+
+    CHECK( table.AppendColumn(wxGridColumnarTable::Type_String, "Name") == 0 );
+    CHECK( table.AppendColumn(wxGridColumnarTable::Type_Long) == 1 );
+    CHECK( table.AppendColumn(wxGridColumnarTable::Type_Double) == 2 );
+    REQUIRE( table.AppendRows(3) );
+
+    CHECK( table.GetNumberRows() == 3 );
+    CHECK( table.GetNumberCols() == 3 );
+    CHECK( table.GetColLabelValue(0) == "Name" );
+    CHECK( table.GetColLabelValue(1) == "B" );
+
+    CHECK( table.GetTypeName(0, 1) == wxGRID_VALUE_NUMBER );
+    CHECK( table.GetTypeName(0, 2) == wxGRID_VALUE_FLOAT );
+    CHECK( table.IsEmptyCell(0, 0) );
+    CHECK( table.GetValueAsLong(0, 1) == 0 );
+
+    wxArrayString names;
+    names.push_back("foo");
+    names.push_back("bar");
+    CHECK( table.SetColumnData(0, names, 1) );
+
+    const long numbers[] = { 1, 2, 3 };
+    CHECK( table.SetColumnData(1, numbers, WXSIZEOF(numbers)) );
+
+    // Wrong type or too many values.
+    WX_ASSERT_FAILS_WITH_ASSERT( table.SetColumnData(2, numbers, 3) );
+    WX_ASSERT_FAILS_WITH_ASSERT( table.SetColumnData(1, numbers, 3, 1) );
+
+    CHECK( table.GetValue(1, 0) == "foo" );
+    CHECK( table.GetValue(2, 0) == "bar" );
+    CHECK( table.GetValueAsLong(2, 1) == 3 );
+    CHECK( table.GetValue(2, 1) == "3" );
+
+    table.SetValue(0, 2, "1.5");
+    CHECK( table.GetValueAsDouble(0, 2) == 1.5 );
+    table.SetValue(0, 2, "foo");
+    CHECK( table.GetValueAsDouble(0, 2) == 1.5 );
+    table.SetValue(0, 2, "");
+    CHECK( table.GetValueAsDouble(0, 2) == 0. );
+    table.SetValueAsLong(0, 1, 17);
+    CHECK( table.GetValue(0, 1) == "17" );
+
+    wxArrayString values;
+    table.GetValuesAsString(wxGridBlockCoords(1, 0, 2, 1), values);
+    REQUIRE( values.size() == 4 );
+    CHECK( values[0] == "foo" );
+    CHECK( values[1] == "2" );
+    CHECK( values[2] == "bar" );
+    CHECK( values[3] == "3" );
+
+    REQUIRE( table.DeleteRows(0) );
+    CHECK( table.GetValue(0, 0) == "foo" );
+    CHECK( table.GetValueAsLong(0, 1) == 2 );
+
+    REQUIRE( table.InsertCols(0) );
+    CHECK( table.GetColumnType(0) == wxGridColumnarTable::Type_String );
+    CHECK( table.GetColumnType(2) == wxGridColumnarTable::Type_Long );
+    CHECK( table.GetValueAsLong(1, 2) == 3 );
+}
+
+TEST_CASE("Grid::SortedTable", "[grid]")
+{
+    wxGridColumnarTable* const source = new wxGridColumnarTable;
+    source->AppendColumn(wxGridColumnarTable::Type_Long);
+    source->AppendColumn(wxGridColumnarTable::Type_String);
+    source->AppendRows(4);
+
+    const long numbers[] = { 2, 1, 2, 1 };
+    source->SetColumnData(0, numbers, WXSIZEOF(numbers));
+
+    wxArrayString names;
+    names.push_back("b");
+    names.push_back("a");
+    names.push_back("a");
+    names.push_back("b");
+    source->SetColumnData(1, names);
+
+    wxGridSortedTable table(source, true);
+    table.SetBackgroundSortThreshold(0);
+
+    table.Sort(0);
+    CHECK( !table.IsSorting() );
+
+    // The sort is stable.
+    CHECK( table.GetSourceRow(0) == 1 );
+    CHECK( table.GetSourceRow(1) == 3 );
+    CHECK( table.GetSourceRow(2) == 0 );
+    CHECK( table.GetSourceRow(3) == 2 );
+    CHECK( table.GetValue(0, 1) == "a" );
+
+    wxGridSortKeys keys;
+    keys.push_back(wxGridSortKey(0, false));
+    keys.push_back(wxGridSortKey(1));
+    table.Sort(keys);
+    CHECK( table.GetValue(0, 1) == "a" );
+    CHECK( table.GetValueAsLong(0, 0) == 2 );
+    CHECK( table.GetValue(3, 1) == "b" );
+    CHECK( table.GetValueAsLong(3, 0) == 1 );
+
+    // Modifying the value changes it in the source table.
+    table.SetValue(0, 1, "c");
+    CHECK( source->GetValue(2, 1) == "c" );
+
+    SECTION("Reset")
+    {
+        table.ResetSort();
+        CHECK( table.GetSortKeys().empty() );
+        CHECK( table.GetSourceRow(0) == 0 );
+    }
+
+    SECTION("Insert")
+    {
+        // The sort order is preserved and the new row is shown where it was
+        // inserted.
+        REQUIRE( table.InsertRows(1) );
+        CHECK( table.GetNumberRows() == 5 );
+        CHECK( table.GetSortKeys().size() == 2 );
+        CHECK( table.GetSourceRow(1) == 0 );
+        CHECK( table.GetValue(0, 1) == "c" );
+        CHECK( table.GetValue(1, 1) == "" );
+        CHECK( table.GetValue(2, 1) == "b" );
+        CHECK( table.GetValueAsLong(4, 0) == 1 );
+    }
+
+    SECTION("Delete")
+    {
+        // The rows shown at the given positions are deleted from the source
+        // table and the order of the remaining ones is preserved: the rows
+        // are currently shown in 2, 0, 1, 3 source order.
+        REQUIRE( table.DeleteRows(1, 2) );
+        CHECK( table.GetNumberRows() == 2 );
+        CHECK( source->GetNumberRows() == 2 );
+        CHECK( table.GetSortKeys().size() == 2 );
+        CHECK( table.GetSourceRow(0) == 0 );
+        CHECK( table.GetSourceRow(1) == 1 );
+        CHECK( table.GetValue(0, 1) == "c" );
+        CHECK( table.GetValueAsLong(1, 0) == 1 );
+        CHECK( table.GetValue(1, 1) == "b" );
+    }
+
+    SECTION("Append")
+    {
+        REQUIRE( table.AppendRows(2) );
+        CHECK( table.GetNumberRows() == 6 );
+        CHECK( table.GetSortKeys().size() == 2 );
+        CHECK( table.GetValue(0, 1) == "c" );
+        CHECK( table.GetSourceRow(4) == 4 );
+        CHECK( table.GetSourceRow(5) == 5 );
+    }
+
+#if wxUSE_THREADS
+    SECTION("Background")
+    {
+        table.SetBackgroundSortThreshold(1);
+        table.Sort(1, false);
+
+        for ( wxStopWatch sw; table.IsSorting(); )
+        {
+            if ( sw.Time() > 5000 )
+                FAIL("Timed out waiting for the background sort.");
+
+            wxYield();
+        }
+
+        CHECK( table.GetValue(0, 1) == "c" );
+        CHECK( table.GetValue(3, 1) == "a" );
+    }
+#endif // wxUSE_THREADS
+}
+
 TEST_CASE_METHOD(GridTestCase, "Grid::DrawInvalidCell", "[grid][multicell]")
 {
     // Set up a multicell with inside an overflowing cell.
@@ -1755,6 +2263,46 @@ TEST_CASE_METHOD(GridTestCase, "Grid::CellAttribute", "[attr][cell][grid]")
     }
 }
 
+TEST_CASE_METHOD(GridTestCase, "Grid::SparseCellAttribute", "[attr][cell][grid]")
+{
+    // Use attributes in only some cells of a bigger grid.
+    m_grid->AppendRows(990);
+
+    for ( int row = 0; row < m_grid->GetNumberRows(); row += 7 )
+        SetCellAttr(row, row % 2);
+
+    CHECK_ATTR_COUNT( 143 );
+
+    SECTION("Insert")
+    {
+        InsertRows(1, 5);
+        CHECK_ATTR_COUNT( 143 );
+        CHECK( HasCellAttr(0, 0) );
+        CHECK( !HasCellAttr(7, 1) );
+        CHECK( HasCellAttr(12, 1) );
+        CHECK( HasCellAttr(999, 0) );
+
+        InsertCols(1);
+        CHECK_ATTR_COUNT( 143 );
+        CHECK( HasCellAttr(0, 0) );
+        CHECK( HasCellAttr(12, 2) );
+    }
+
+    SECTION("Delete")
+    {
+        DeleteRows(0, 10);
+        CHECK_ATTR_COUNT( 141 );
+        CHECK( HasCellAttr(4, 0) );
+        CHECK( HasCellAttr(11, 1) );
+        CHECK( HasCellAttr(984, 0) );
+
+        DeleteCols(0);
+        CHECK_ATTR_COUNT( 70 );
+        CHECK( HasCellAttr(11, 0) );
+        CHECK( !HasCellAttr(4, 0) );
+    }
+}
+
 #define CHECK_MULTICELL() CHECK_THAT( *m_grid, HasMulticellOnly(multi) )
 
 #define CHECK_NO_MULTICELL() CHECK_THAT( *m_grid, HasEmptyGrid() )
@@ -442,6 +442,31 @@ void ListBaseTestCase::Find()
     CPPUNIT_ASSERT_EQUAL(2, list->FindItem(-1, "Item 4", true));
     CPPUNIT_ASSERT_EQUAL(2, list->FindItem(1, "Item 40"));
     CPPUNIT_ASSERT_EQUAL(3, list->FindItem(2, "Item 0", true));
+
+    // find the items by their data
+    list->SetItemData(0, 10);
+    list->SetItemData(1, 20);
+    list->SetItemData(2, 10);
+
+    CPPUNIT_ASSERT_EQUAL(0, list->FindItem(-1, 10));
+    CPPUNIT_ASSERT_EQUAL(1, list->FindItem(-1, 20));
+    CPPUNIT_ASSERT_EQUAL(2, list->FindItem(1, 10));
+    CPPUNIT_ASSERT_EQUAL(-1, list->FindItem(3, 10));
+    CPPUNIT_ASSERT_EQUAL(3, list->FindItem(-1, 0));
+    CPPUNIT_ASSERT_EQUAL(-1, list->FindItem(-1, 30));
+
+    // the results must be updated after modifying the items
+    list->InsertItem(0, "Item 2");
+    list->SetItemData(0, 20);
+    CPPUNIT_ASSERT_EQUAL(0, list->FindItem(-1, 20));
+    CPPUNIT_ASSERT_EQUAL(1, list->FindItem(-1, 10));
+
+    list->DeleteItem(0);
+    CPPUNIT_ASSERT_EQUAL(1, list->FindItem(-1, 20));
+
+    list->InsertItem(4, "Item 5");
+    list->SetItemData(4, 30);
+    CPPUNIT_ASSERT_EQUAL(4, list->FindItem(-1, 30));
 }
 
 void ListBaseTestCase::Visible()
@@ -485,6 +510,18 @@ void ListBaseTestCase::ItemFormatting()
 
     CPPUNIT_ASSERT_EQUAL(*wxYELLOW, list->GetTextColour());
     CPPUNIT_ASSERT_EQUAL(*wxRED, list->GetItemTextColour(0));
+
+    // changing the attributes of one item must not affect the other items
+    // with the same attributes
+    list->SetItemTextColour(2, *wxRED);
+    list->SetItemBackgroundColour(2, *wxBLUE);
+    CPPUNIT_ASSERT_EQUAL(*wxRED, list->GetItemTextColour(0));
+    CPPUNIT_ASSERT_EQUAL(*wxRED, list->GetItemTextColour(2));
+
+    list->SetItemTextColour(0, *wxCYAN);
+    CPPUNIT_ASSERT_EQUAL(*wxCYAN, list->GetItemTextColour(0));
+    CPPUNIT_ASSERT_EQUAL(*wxRED, list->GetItemTextColour(2));
+    CPPUNIT_ASSERT_EQUAL(*wxBLUE, list->GetItemBackgroundColour(2));
 }
 
 void ListBaseTestCase::EditLabel()
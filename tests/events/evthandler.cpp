@@ -13,7 +13,13 @@
 #include "testprec.h"
 
 
+#ifndef WX_PRECOMP
+    #include "wx/app.h"
+#endif // WX_PRECOMP
+
 #include "wx/event.h"
+#include "wx/thread.h"
+#include "wx/vector.h"
 
 // ----------------------------------------------------------------------------
 // test events and their handlers
@@ -507,6 +513,456 @@ TEST_CASE("Event::UnbindFromHandler", "[event][bind][unbind]")
     handler.ProcessEvent(e);
 }
 
+// Helper for BindManyTypes() test, has to be declared outside of the function
+// in C++98.
+struct CallsRecorder
+{
+    void OnEvent(wxEvent& e)
+    {
+        calls->push_back(value);
+
+        // Let the other handlers for the same event run too.
+        e.Skip();
+    }
+
+    wxVector<int>* calls;
+    int value;
+};
+
+TEST_CASE("Event::BindManyTypes", "[event][bind][unbind]")
+{
+    static const int NUM_TYPES = 10;
+    static const int NUM_PER_TYPE = 3;
+
+    wxEventType types[NUM_TYPES];
+    for ( int t = 0; t < NUM_TYPES; t++ )
+        types[t] = wxNewEventType();
+
+    wxVector<int> calls;
+    CallsRecorder recorders[NUM_TYPES][NUM_PER_TYPE];
+
+    // Interleave the handlers for the different event types.
+    MyHandler handler;
+    for ( int k = 0; k < NUM_PER_TYPE; k++ )
+    {
+        for ( int t = 0; t < NUM_TYPES; t++ )
+        {
+            CallsRecorder& r = recorders[t][k];
+            r.calls = &calls;
+            r.value = 10*t + k;
+
+            handler.Bind(wxEventTypeTag<wxEvent>(types[t]),
+                         &CallsRecorder::OnEvent, &r);
+        }
+    }
+
+    wxEvtHandler::EnableDispatchStats();
+    wxEvtHandler::ResetDispatchStats();
+
+    // Only the handlers for the event type are called, in LIFO order.
+    wxThreadEvent e3(types[3]);
+    handler.ProcessEventLocally(e3);
+    REQUIRE( calls.size() == 3 );
+    CHECK( calls[0] == 32 );
+    CHECK( calls[1] == 31 );
+    CHECK( calls[2] == 30 );
+
+    wxEventDispatchStats stats = wxEvtHandler::GetDispatchStats();
+    CHECK( stats.searches == 1 );
+    CHECK( stats.handlersScanned == 3 );
+    CHECK( stats.maxHandlersScanned == 3 );
+
+    // The unbound handlers are not called nor counted.
+    CHECK( handler.Unbind(wxEventTypeTag<wxEvent>(types[3]),
+                          &CallsRecorder::OnEvent, &recorders[3][1]) );
+    for ( int k = 0; k < NUM_PER_TYPE; k++ )
+    {
+        CHECK( handler.Unbind(wxEventTypeTag<wxEvent>(types[5]),
+                              &CallsRecorder::OnEvent, &recorders[5][k]) );
+    }
+
+    wxEvtHandler::ResetDispatchStats();
+    calls.clear();
+
+    wxThreadEvent e5(types[5]);
+    handler.ProcessEventLocally(e5);
+    CHECK( calls.empty() );
+
+    handler.ProcessEventLocally(e3);
+    REQUIRE( calls.size() == 2 );
+    CHECK( calls[0] == 32 );
+    CHECK( calls[1] == 30 );
+
+    // Check that binding new handlers after pruning the unbound ones works.
+    handler.Bind(wxEventTypeTag<wxEvent>(types[5]),
+                 &CallsRecorder::OnEvent, &recorders[5][0]);
+
+    calls.clear();
+    handler.ProcessEventLocally(e5);
+    handler.ProcessEventLocally(e3);
+    REQUIRE( calls.size() == 3 );
+    CHECK( calls[0] == 50 );
+    CHECK( calls[1] == 32 );
+    CHECK( calls[2] == 30 );
+
+    stats = wxEvtHandler::GetDispatchStats();
+    CHECK( stats.searches == 4 );
+    CHECK( stats.handlersScanned == 5 );
+    CHECK( stats.maxHandlersScanned == 2 );
+
+    // Nothing is counted when the statistics are disabled.
+    wxEvtHandler::EnableDispatchStats(false);
+    handler.ProcessEventLocally(e3);
+    CHECK( wxEvtHandler::GetDispatchStats().searches == 4 );
+}
+
+TEST_CASE("Event::BindFewTypes", "[event][bind][unbind]")
+{
+    const wxEventType type1 = wxNewEventType(),
+                      type2 = wxNewEventType();
+
+    wxVector<int> calls;
+    CallsRecorder recorders[3];
+    for ( int n = 0; n < 3; n++ )
+    {
+        recorders[n].calls = &calls;
+        recorders[n].value = n;
+    }
+
+    // With just a few handlers, all of them are examined for every event.
+    MyHandler handler;
+    handler.Bind(wxEventTypeTag<wxEvent>(type1),
+                 &CallsRecorder::OnEvent, &recorders[0]);
+    handler.Bind(wxEventTypeTag<wxEvent>(type2),
+                 &CallsRecorder::OnEvent, &recorders[1]);
+    handler.Bind(wxEventTypeTag<wxEvent>(type1),
+                 &CallsRecorder::OnEvent, &recorders[2]);
+
+    wxEvtHandler::EnableDispatchStats();
+    wxEvtHandler::ResetDispatchStats();
+
+    wxThreadEvent e1(type1);
+    handler.ProcessEventLocally(e1);
+    REQUIRE( calls.size() == 2 );
+    CHECK( calls[0] == 2 );
+    CHECK( calls[1] == 0 );
+
+    wxEventDispatchStats stats = wxEvtHandler::GetDispatchStats();
+    CHECK( stats.searches == 1 );
+    CHECK( stats.handlersScanned == 3 );
+
+    CHECK( handler.Unbind(wxEventTypeTag<wxEvent>(type1),
+                          &CallsRecorder::OnEvent, &recorders[2]) );
+
+    calls.clear();
+    handler.ProcessEventLocally(e1);
+    REQUIRE( calls.size() == 1 );
+    CHECK( calls[0] == 0 );
+
+    wxEvtHandler::EnableDispatchStats(false);
+}
+
+TEST_CASE("Event::Trace", "[event][trace]")
+{
+    MyHandler handler;
+    handler.Bind(MyEventType, &MyHandler::OnMyEvent, &handler);
+
+    wxEventTracer::Start();
+
+    MyEvent e;
+    handler.ProcessEvent(e);
+
+    handler.QueueEvent(new MyEvent());
+    handler.ProcessPendingEvents();
+
+    wxEventTracer::Stop();
+
+    // This one is not recorded any more.
+    handler.ProcessEvent(e);
+
+    wxVector<wxEventTraceRecord> records = wxEventTracer::GetRecords();
+    REQUIRE( records.size() == 2 );
+
+    for ( size_t n = 0; n < records.size(); n++ )
+    {
+        const wxEventTraceRecord& r = records[n];
+        CHECK( r.kind == wxEVENT_TRACE_PROCESS );
+        CHECK( r.eventType == MyEventType );
+        CHECK( r.eventClass == wxCLASSINFO(wxEvent) );
+        CHECK( r.handlerClass == wxCLASSINFO(wxEvtHandler) );
+    }
+
+    CHECK( !records[0].wasQueued );
+    CHECK( records[1].wasQueued );
+    CHECK( records[1].start >= records[0].start );
+
+    const wxString trace = wxEventTracer::GetChromeTrace();
+    CHECK( trace.StartsWith("{\"traceEvents\":[{\"name\":\"wxEvent\"") );
+    CHECK( trace.Freq('{') == 1 + 2*2 );
+    CHECK( trace.Contains("\"queueLatency\":") );
+
+    // Only the most recent records are kept.
+    wxEventTracer::Start(4);
+    for ( int n = 0; n < 10; n++ )
+    {
+        MyEvent e2;
+        handler.ProcessEvent(e2);
+    }
+    wxEventTracer::Stop();
+
+    CHECK( wxEventTracer::GetRecords().size() == 4 );
+
+    wxEventTracer::Clear();
+    CHECK( wxEventTracer::GetRecords().empty() );
+    CHECK( wxEventTracer::GetChromeTrace() ==
+            "{\"traceEvents\":[],\"displayTimeUnit\":\"ms\"}" );
+}
+
+#if wxUSE_THREADS
+
+namespace
+{
+
+// Handler checking that the events queued from each thread arrive in order.
+class QueuedEventsHandler : public wxEvtHandler
+{
+public:
+    explicit QueuedEventsHandler(int numThreads)
+        : m_lastSeq(numThreads, -1)
+    {
+        m_count = 0;
+        m_outOfOrder = 0;
+
+        Bind(wxEVT_THREAD, &QueuedEventsHandler::OnThreadEvent, this);
+    }
+
+    int GetCount() const { return m_count; }
+    int GetOutOfOrder() const { return m_outOfOrder; }
+
+private:
+    void OnThreadEvent(wxThreadEvent& event)
+    {
+        long& lastSeq = m_lastSeq[event.GetInt()];
+        if ( event.GetExtraLong() != lastSeq + 1 )
+            m_outOfOrder++;
+
+        lastSeq = event.GetExtraLong();
+        m_count++;
+    }
+
+    wxVector<long> m_lastSeq;
+    int m_count;
+    int m_outOfOrder;
+};
+
+class QueueingThread : public wxThread
+{
+public:
+    QueueingThread(wxEvtHandler& handler, int id, int count)
+        : wxThread(wxTHREAD_JOINABLE),
+          m_handler(handler),
+          m_id(id),
+          m_count(count)
+    {
+    }
+
+    virtual ExitCode Entry() wxOVERRIDE
+    {
+        for ( int n = 0; n < m_count; n++ )
+        {
+            wxThreadEvent* const event = new wxThreadEvent();
+            event->SetInt(m_id);
+            event->SetExtraLong(n);
+            m_handler.QueueEvent(event);
+        }
+
+        return 0;
+    }
+
+private:
+    wxEvtHandler& m_handler;
+    const int m_id;
+    const int m_count;
+};
+
+} // anonymous namespace
+
+TEST_CASE("Event::QueueFromThreads", "[event][queue][thread]")
+{
+    static const int NUM_THREADS = 4;
+    static const int NUM_EVENTS = 10000;
+
+    QueuedEventsHandler handler(NUM_THREADS);
+
+    wxVector<QueueingThread*> threads;
+    for ( int n = 0; n < NUM_THREADS; n++ )
+    {
+        threads.push_back(new QueueingThread(handler, n, NUM_EVENTS));
+        REQUIRE( threads.back()->Run() == wxTHREAD_NO_ERROR );
+    }
+
+    while ( handler.GetCount() < NUM_THREADS*NUM_EVENTS )
+        wxTheApp->ProcessPendingEvents();
+
+    for ( size_t n = 0; n < threads.size(); n++ )
+    {
+        threads[n]->Wait();
+        delete threads[n];
+    }
+
+    CHECK( handler.GetCount() == NUM_THREADS*NUM_EVENTS );
+    CHECK( handler.GetOutOfOrder() == 0 );
+
+    wxTheApp->ProcessPendingEvents();
+    CHECK( !wxTheApp->HasPendingEvents() );
+}
+
+TEST_CASE("Event::QueueAndDelete", "[event][queue]")
+{
+    QueuedEventsHandler* const handler = new QueuedEventsHandler(1);
+    for ( int n = 0; n < 10; n++ )
+    {
+        wxThreadEvent* const event = new wxThreadEvent();
+        event->SetExtraLong(n);
+        handler->QueueEvent(event);
+    }
+
+    CHECK( wxTheApp->HasPendingEvents() );
+
+    // Destroying the handler must remove it from the list of the handlers
+    // with pending events.
+    delete handler;
+    CHECK( !wxTheApp->HasPendingEvents() );
+
+    QueuedEventsHandler handler2(1);
+    wxThreadEvent* const event = new wxThreadEvent();
+    event->SetExtraLong(0);
+    handler2.QueueEvent(event);
+
+    wxTheApp->ProcessPendingEvents();
+    CHECK( handler2.GetCount() == 1 );
+    CHECK( !wxTheApp->HasPendingEvents() );
+}
+
+#endif // wxUSE_THREADS
+
+namespace
+{
+
+// Handler remembering the values of the events it receives.
+class ValuesHandler : public wxEvtHandler
+{
+public:
+    ValuesHandler()
+    {
+        m_batches = 0;
+
+        Bind(wxEVT_THREAD, &ValuesHandler::OnThreadEvent, this);
+        Bind(wxEVT_BATCH, &ValuesHandler::OnBatchEvent, this);
+    }
+
+    void Queue(long value)
+    {
+        QueueEvent(CreateEvent(value));
+    }
+
+    void QueueCoalesced(wxUIntPtr key, long value)
+    {
+        QueueCoalescedEvent(key, CreateEvent(value));
+    }
+
+    const wxVector<long>& GetValues() const { return m_values; }
+    int GetBatches() const { return m_batches; }
+
+private:
+    static wxThreadEvent* CreateEvent(long value)
+    {
+        wxThreadEvent* const event = new wxThreadEvent();
+        event->SetExtraLong(value);
+        return event;
+    }
+
+    void OnThreadEvent(wxThreadEvent& event)
+    {
+        m_values.push_back(event.GetExtraLong());
+    }
+
+    void OnBatchEvent(wxBatchEvent& event)
+    {
+        m_batches++;
+
+        CHECK( event.GetBatchedEventType() == wxEVT_THREAD );
+
+        const wxVector<wxEvent*>& events = event.GetEvents();
+        for ( size_t n = 0; n < events.size(); n++ )
+        {
+            m_values.push_back
+            (
+                static_cast<wxThreadEvent*>(events[n])->GetExtraLong()
+            );
+        }
+    }
+
+    wxVector<long> m_values;
+    int m_batches;
+};
+
+} // anonymous namespace
+
+TEST_CASE("Event::QueueCoalesced", "[event][queue]")
+{
+    ValuesHandler handler;
+
+    for ( int n = 0; n < 100; n++ )
+        handler.QueueCoalesced(1, n);
+
+    wxTheApp->ProcessPendingEvents();
+    REQUIRE( handler.GetValues().size() == 1 );
+    CHECK( handler.GetValues()[0] == 99 );
+
+    // The coalesced event must be processed at the position of the first
+    // event it replaced.
+    handler.QueueCoalesced(1, 1);
+    handler.Queue(2);
+    handler.QueueCoalesced(2, 3);
+    handler.QueueCoalesced(1, 4);
+
+    wxTheApp->ProcessPendingEvents();
+    REQUIRE( handler.GetValues().size() == 4 );
+    CHECK( handler.GetValues()[1] == 4 );
+    CHECK( handler.GetValues()[2] == 2 );
+    CHECK( handler.GetValues()[3] == 3 );
+
+    CHECK( !wxTheApp->HasPendingEvents() );
+}
+
+TEST_CASE("Event::QueueBatched", "[event][queue]")
+{
+    ValuesHandler handler;
+    handler.EnableBatchedEvents(wxEVT_THREAD);
+
+    for ( int n = 0; n < 10; n++ )
+        handler.Queue(n);
+    handler.QueueCoalesced(1, 10);
+    handler.QueueCoalesced(1, 11);
+
+    wxTheApp->ProcessPendingEvents();
+    CHECK( handler.GetBatches() == 1 );
+    REQUIRE( handler.GetValues().size() == 11 );
+    for ( int n = 0; n < 10; n++ )
+        CHECK( handler.GetValues()[n] == n );
+    CHECK( handler.GetValues()[10] == 11 );
+
+    handler.EnableBatchedEvents(wxEVT_THREAD, false);
+
+    handler.Queue(12);
+    handler.Queue(13);
+
+    wxTheApp->ProcessPendingEvents();
+    CHECK( handler.GetBatches() == 1 );
+    CHECK( handler.GetValues().size() == 13 );
+}
+
 // This is a compilation-time-only test: just check that a class inheriting
 // from wxEvtHandler non-publicly can use Bind() with its method, this used to
 // result in compilation errors.
@@ -32,6 +32,8 @@
 #include "wx/clipbrd.h"
 #include "wx/dataobj.h"
 
+#include "wx/private/image.h"
+
 #include "testimage.h"
 
 
@@ -2200,6 +2202,465 @@ TEST_CASE("wxImage::XPM", "[image][xpm]")
    CHECK( wxIcon(dummy_xpm).IsOk() );
 }
 
+TEST_CASE("wxImage::ResampleImpl", "[image][scale]")
+{
+    wxImage original;
+    REQUIRE( original.LoadFile("horse.bmp") );
+
+    // Use an image with partially transparent pixels to check alpha handling.
+    wxImage originalAlpha = original.Copy();
+    originalAlpha.InitAlpha();
+    unsigned char* alpha = originalAlpha.GetAlpha();
+    for ( int n = 0; n < originalAlpha.GetWidth()*originalAlpha.GetHeight(); n++ )
+        alpha[n] = static_cast<unsigned char>(n % 7 ? n : 0);
+
+    const wxImageResampleImpl implOld =
+        wxImageSetResampleImpl(wxIMAGE_RESAMPLE_IMPL_SCALAR);
+
+    const wxSize sizes[] = { wxSize(1, 1), wxSize(50, 37), wxSize(301, 299) };
+    const wxImageResizeQuality qualities[] =
+    {
+        wxIMAGE_QUALITY_BILINEAR,
+        wxIMAGE_QUALITY_BICUBIC,
+    };
+
+    for ( int n = wxIMAGE_RESAMPLE_IMPL_SSE2; n < wxIMAGE_RESAMPLE_IMPL_MAX; n++ )
+    {
+        const wxImageResampleImpl impl = static_cast<wxImageResampleImpl>(n);
+        if ( !wxImageIsResampleImplAvailable(impl) )
+            continue;
+
+        INFO("Using " << wxImageGetResampleImplName(impl));
+
+        for ( size_t s = 0; s < WXSIZEOF(sizes); s++ )
+        {
+            for ( size_t q = 0; q < WXSIZEOF(qualities); q++ )
+            {
+                const int w = sizes[s].x,
+                          h = sizes[s].y;
+
+                wxImageSetResampleImpl(wxIMAGE_RESAMPLE_IMPL_SCALAR);
+                const wxImage expected = original.Scale(w, h, qualities[q]);
+                const wxImage expectedAlpha = originalAlpha.Scale(w, h, qualities[q]);
+
+                wxImageSetResampleImpl(impl);
+                CHECK_THAT( original.Scale(w, h, qualities[q]),
+                            RGBASameAs(expected) );
+                CHECK_THAT( originalAlpha.Scale(w, h, qualities[q]),
+                            RGBASameAs(expectedAlpha) );
+            }
+        }
+    }
+
+    wxImageSetResampleImpl(implOld);
+}
+
+TEST_CASE("wxImage::ThreadCount", "[image][thread]")
+{
+    // Use an image big enough to be really processed by several threads.
+    const int w = 523,
+              h = 317;
+    wxImage image(w, h, false);
+    image.InitAlpha();
+
+    unsigned char* data = image.GetData();
+    unsigned char* alpha = image.GetAlpha();
+    for ( int n = 0; n < w*h; n++ )
+    {
+        data[3*n + 0] = static_cast<unsigned char>(n);
+        data[3*n + 1] = static_cast<unsigned char>(n / w);
+        data[3*n + 2] = static_cast<unsigned char>(n * 7);
+        alpha[n] = static_cast<unsigned char>(n * 13);
+    }
+
+    const int threadCountOld = wxImage::GetThreadCount();
+
+    const wxImageResizeQuality qualities[] =
+    {
+        wxIMAGE_QUALITY_NEAREST,
+        wxIMAGE_QUALITY_BILINEAR,
+        wxIMAGE_QUALITY_BICUBIC,
+        wxIMAGE_QUALITY_BOX_AVERAGE,
+    };
+
+    for ( size_t q = 0; q < WXSIZEOF(qualities); q++ )
+    {
+        wxImage::SetThreadCount(1);
+        const wxImage expectedUp = image.Scale(2*w + 1, 2*h - 1, qualities[q]);
+        const wxImage expectedDown = image.Scale(w/3, h/2, qualities[q]);
+
+        wxImage::SetThreadCount(4);
+        CHECK_THAT( image.Scale(2*w + 1, 2*h - 1, qualities[q]),
+                    RGBASameAs(expectedUp) );
+        CHECK_THAT( image.Scale(w/3, h/2, qualities[q]),
+                    RGBASameAs(expectedDown) );
+    }
+
+    wxImage::SetThreadCount(1);
+    const wxImage blur = image.Blur(5);
+    const wxImage rotatedCW = image.Rotate90(true);
+    const wxImage rotatedCCW = image.Rotate90(false);
+    const wxImage grey = image.ConvertToGreyscale();
+    const wxImage disabled = image.ConvertToDisabled();
+
+    wxImage::SetThreadCount(0);
+    CHECK_THAT( image.Blur(5), RGBASameAs(blur) );
+    CHECK_THAT( image.Rotate90(true), RGBASameAs(rotatedCW) );
+    CHECK_THAT( image.Rotate90(false), RGBASameAs(rotatedCCW) );
+    CHECK_THAT( image.ConvertToGreyscale(), RGBASameAs(grey) );
+    CHECK_THAT( image.ConvertToDisabled(), RGBASameAs(disabled) );
+
+    wxImage::SetThreadCount(threadCountOld);
+}
+
+// Straightforward implementation of the box blur used as the reference.
+static wxImage BlurReference(const wxImage& image, int radius)
+{
+    const int w = image.GetWidth(),
+              h = image.GetHeight();
+    const bool hasAlpha = image.HasAlpha();
+
+    wxImage horz = image.Copy();
+    for ( int y = 0; y < h; y++ )
+    {
+        for ( int x = 0; x < w; x++ )
+        {
+            int r = 0, g = 0, b = 0, a = 0;
+            for ( int k = x - radius; k <= x + radius; k++ )
+            {
+                const int xx = wxMin(wxMax(k, 0), w - 1);
+                r += image.GetRed(xx, y);
+                g += image.GetGreen(xx, y);
+                b += image.GetBlue(xx, y);
+                if ( hasAlpha )
+                    a += image.GetAlpha(xx, y);
+            }
+
+            const int area = 2*radius + 1;
+            horz.SetRGB(x, y, r / area, g / area, b / area);
+            if ( hasAlpha )
+                horz.SetAlpha(x, y, a / area);
+        }
+    }
+
+    wxImage result = horz.Copy();
+    for ( int x = 0; x < w; x++ )
+    {
+        for ( int y = 0; y < h; y++ )
+        {
+            int r = 0, g = 0, b = 0, a = 0;
+            for ( int k = y - radius; k <= y + radius; k++ )
+            {
+                const int yy = wxMin(wxMax(k, 0), h - 1);
+                r += horz.GetRed(x, yy);
+                g += horz.GetGreen(x, yy);
+                b += horz.GetBlue(x, yy);
+                if ( hasAlpha )
+                    a += horz.GetAlpha(x, yy);
+            }
+
+            const int area = 2*radius + 1;
+            result.SetRGB(x, y, r / area, g / area, b / area);
+            if ( hasAlpha )
+                result.SetAlpha(x, y, a / area);
+        }
+    }
+
+    return result;
+}
+
+TEST_CASE("wxImage::Blur", "[image][blur]")
+{
+    const int w = 37,
+              h = 23;
+    wxImage image(w, h, false);
+    image.InitAlpha();
+
+    unsigned char* data = image.GetData();
+    unsigned char* alpha = image.GetAlpha();
+    for ( int n = 0; n < w*h; n++ )
+    {
+        data[3*n + 0] = static_cast<unsigned char>(n * 3);
+        data[3*n + 1] = static_cast<unsigned char>(n / w * 11);
+        data[3*n + 2] = static_cast<unsigned char>(n * 7);
+        alpha[n] = static_cast<unsigned char>(n * 13);
+    }
+
+    // Also check the radii bigger than the image size.
+    const int radii[] = { 0, 1, 4, 30, 100 };
+    for ( size_t n = 0; n < WXSIZEOF(radii); n++ )
+    {
+        const int radius = radii[n];
+        INFO("Radius " << radius);
+
+        const wxImage expected = BlurReference(image, radius);
+        CHECK_THAT( image.Blur(radius), RGBASameAs(expected) );
+        CHECK_THAT( image.BlurHorizontal(radius).BlurVertical(radius),
+                    RGBASameAs(expected) );
+
+        wxImage copy = image;
+        copy.BlurInPlace(radius);
+        CHECK_THAT( copy, RGBASameAs(expected) );
+
+        // The original image must not have been modified.
+        CHECK_THAT( image.Blur(radius), RGBASameAs(expected) );
+    }
+
+    // Blurring without alpha channel must work too.
+    wxImage rgb = image.Copy();
+    rgb.ClearAlpha();
+    CHECK_THAT( rgb.Blur(3), RGBSameAs(BlurReference(rgb, 3)) );
+}
+
+TEST_CASE("wxImage::GaussianBlur", "[image][blur]")
+{
+    const int w = 64,
+              h = 48;
+    wxImage image(w, h);
+    image.InitAlpha();
+    image.SetRGB(wxRect(0, 0, w, h), 10, 200, 70);
+    for ( int y = 0; y < h; y++ )
+    {
+        for ( int x = 0; x < w; x++ )
+            image.SetAlpha(x, y, 255);
+    }
+
+    // Blurring a uniform image doesn't change it.
+    CHECK_THAT( image.GaussianBlur(2.5), RGBASameAs(image) );
+
+    // Nor does blurring with zero sigma.
+    image.SetRGB(w/2, h/2, 255, 0, 255);
+    CHECK_THAT( image.GaussianBlur(0), RGBASameAs(image) );
+
+    // But blurring a single point spreads it symmetrically around it.
+    const wxImage blurred = image.GaussianBlur(3);
+    CHECK( blurred.GetRed(w/2, h/2) < 255 );
+    CHECK( blurred.GetRed(w/2, h/2) > blurred.GetRed(w/2 + 3, h/2) );
+    CHECK( blurred.GetRed(w/2 - 3, h/2) == blurred.GetRed(w/2 + 3, h/2) );
+    CHECK( blurred.GetRed(w/2, h/2 - 3) == blurred.GetRed(w/2, h/2 + 3) );
+    CHECK( blurred.GetRed(0, 0) == 10 );
+
+    wxImage copy = image;
+    copy.GaussianBlurInPlace(3);
+    CHECK_THAT( copy, RGBASameAs(blurred) );
+    CHECK( image.GetRed(w/2, h/2) == 255 );
+}
+
+TEST_CASE("wxImage::GetRGBAData", "[image][rgba]")
+{
+    wxImage image(3, 2);
+    image.SetRGB(wxRect(0, 0, 3, 2), 0x10, 0x80, 0xff);
+
+    // Without alpha, all pixels are opaque.
+    wxImageRGBAData rgba = image.GetRGBAData(wxIMAGE_RGBA_STRAIGHT);
+    REQUIRE( rgba.IsOk() );
+    CHECK( rgba.GetWidth() == 3 );
+    CHECK( rgba.GetHeight() == 2 );
+    CHECK( rgba.GetFormat() == wxIMAGE_RGBA_STRAIGHT );
+
+    const unsigned char* p = rgba.GetData();
+    for ( int n = 0; n < 6; n++, p += 4 )
+    {
+        CHECK( p[0] == 0x10 );
+        CHECK( p[1] == 0x80 );
+        CHECK( p[2] == 0xff );
+        CHECK( p[3] == wxIMAGE_ALPHA_OPAQUE );
+    }
+
+    // The data is cached.
+    CHECK( image.GetRGBAData(wxIMAGE_RGBA_STRAIGHT).GetData() == rgba.GetData() );
+
+    // But not after modifying the image, which doesn't affect the existing
+    // data neither.
+    image.InitAlpha();
+    image.SetAlpha(1, 0, 0x80);
+    image.SetAlpha(2, 1, 0);
+
+    const wxImageRGBAData rgbaAlpha = image.GetRGBAData(wxIMAGE_RGBA_STRAIGHT);
+    CHECK( rgbaAlpha.GetData() != rgba.GetData() );
+    CHECK( rgba.GetData()[4 + 3] == wxIMAGE_ALPHA_OPAQUE );
+    CHECK( rgbaAlpha.GetData()[4 + 3] == 0x80 );
+    CHECK( rgbaAlpha.GetData()[5*4 + 3] == 0 );
+
+    // Premultiplied data uses native 32 bit values.
+    const wxImageRGBAData premult = image.GetRGBAData(wxIMAGE_RGBA_PREMULTIPLIED);
+    CHECK( premult.GetFormat() == wxIMAGE_RGBA_PREMULTIPLIED );
+
+    const wxUint32* const argb = reinterpret_cast<const wxUint32*>(premult.GetData());
+    CHECK( argb[0] == 0xff1080ffu );
+    CHECK( argb[1] == 0x80084080u );
+    CHECK( argb[5] == 0 );
+
+    // Read-only access to the data keeps the cache.
+    const wxImage& constImage = image;
+    CHECK( constImage.GetData()[0] == 0x10 );
+    CHECK( constImage.GetAlpha()[1] == 0x80 );
+    CHECK( image.GetRGBAData(wxIMAGE_RGBA_PREMULTIPLIED).GetData() == premult.GetData() );
+
+    // Getting a pointer allowing to modify the image discards the cache.
+    image.GetData()[0] = 0;
+    const wxImageRGBAData premultNew = image.GetRGBAData(wxIMAGE_RGBA_PREMULTIPLIED);
+    CHECK( *reinterpret_cast<const wxUint32*>(premultNew.GetData()) == 0xff0080ffu );
+}
+
+namespace
+{
+
+// Sink counting the rows it gets and stopping after the given number of them.
+class CountingRowSink : public wxImageRowSink
+{
+public:
+    explicit CountingRowSink(int rowsMax = INT_MAX)
+        : m_rowsMax(rowsMax)
+    {
+        m_width =
+        m_height =
+        m_rows = 0;
+    }
+
+    virtual bool OnBegin(int width, int height, bool WXUNUSED(hasAlpha)) wxOVERRIDE
+    {
+        m_width = width;
+        m_height = height;
+        return true;
+    }
+
+    virtual bool OnRows(int y, int count,
+                        const unsigned char* WXUNUSED(data),
+                        const unsigned char* WXUNUSED(alpha)) wxOVERRIDE
+    {
+        // Rows must be passed in order and without gaps.
+        CHECK( y == m_rows );
+        m_rows += count;
+        return m_rows < m_rowsMax;
+    }
+
+    int m_width,
+        m_height,
+        m_rows;
+
+private:
+    const int m_rowsMax;
+};
+
+void CheckLoadRows(wxInputStream& stream, const wxImage& full)
+{
+    // Loading the entire image must give the same result as LoadFile().
+    REQUIRE( stream.SeekI(0) == 0 );
+    wxImage image;
+    REQUIRE( image.LoadFileRegion(stream, wxRect()) );
+    CHECK_THAT( image, RGBSameAs(full) );
+
+    // And loading just a part of it must be the same as GetSubImage().
+    const wxRect rect(13, 27, 50, 40);
+    REQUIRE( stream.SeekI(0) == 0 );
+    REQUIRE( image.LoadFileRegion(stream, rect) );
+    CHECK_THAT( image, RGBSameAs(full.GetSubImage(rect)) );
+
+    // Scaled size must be rounded up.
+    for ( int scale = 2; scale <= 8; scale *= 2 )
+    {
+        REQUIRE( stream.SeekI(0) == 0 );
+        CountingRowSink sink;
+        CHECK( wxImage::LoadRows(sink, stream, scale) );
+        CHECK( sink.m_width == (full.GetWidth() + scale - 1) / scale );
+        CHECK( sink.m_height == (full.GetHeight() + scale - 1) / scale );
+        CHECK( sink.m_rows == sink.m_height );
+    }
+
+    // Stopping loading must be possible.
+    REQUIRE( stream.SeekI(0) == 0 );
+    CountingRowSink sinkStop(1);
+    CHECK( !wxImage::LoadRows(sinkStop, stream) );
+}
+
+bool RegisterLoadRowsHandlers()
+{
+    wxImage::AddHandler(new wxPNGHandler);
+#if wxUSE_LIBJPEG
+    wxImage::AddHandler(new wxJPEGHandler);
+#endif
+#if wxUSE_LIBTIFF
+    wxImage::AddHandler(new wxTIFFHandler);
+#endif
+
+    return true;
+}
+
+} // anonymous namespace
+
+TEST_CASE("wxImage::LoadRows", "[image][load]")
+{
+    // Execute AddHandler() just once.
+    static const bool registeredHandlers = RegisterLoadRowsHandlers();
+    wxUnusedVar(registeredHandlers);
+
+    SECTION("Files")
+    {
+        static const char* const files[] =
+        {
+            "horse.png",                // interlaced, loaded entirely
+            "horse.bmp",                // RLE, loaded entirely
+            "image/horse_grey.bmp",
+            "image/horse_grey_flipped.bmp",
+#if wxUSE_LIBJPEG
+            "horse.jpg",
+#endif
+#if wxUSE_LIBTIFF
+            "horse.tif",
+#endif
+        };
+
+        for ( size_t n = 0; n < WXSIZEOF(files); n++ )
+        {
+            INFO("File: " << files[n]);
+
+            wxImage full;
+            REQUIRE( full.LoadFile(files[n]) );
+
+            wxFileInputStream stream(files[n]);
+            CheckLoadRows(stream, full);
+        }
+    }
+
+    SECTION("Saved")
+    {
+        wxImage image(37, 23);
+        image.InitAlpha();
+        for ( int y = 0; y < image.GetHeight(); y++ )
+        {
+            for ( int x = 0; x < image.GetWidth(); x++ )
+            {
+                image.SetRGB(x, y, x*7, y*11, (x + y)*3);
+                image.SetAlpha(x, y, (x*y) % 256);
+            }
+        }
+
+        static const wxBitmapType types[] =
+        {
+            wxBITMAP_TYPE_PNG,
+            wxBITMAP_TYPE_BMP,
+#if wxUSE_LIBTIFF
+            wxBITMAP_TYPE_TIFF,
+#endif
+        };
+
+        for ( size_t n = 0; n < WXSIZEOF(types); n++ )
+        {
+            INFO("Type: " << types[n]);
+
+            wxMemoryOutputStream memOut;
+            REQUIRE( image.SaveFile(memOut, types[n]) );
+
+            wxMemoryInputStream memIn(memOut);
+            wxImage full;
+            REQUIRE( full.LoadFile(memIn, types[n]) );
+
+            CheckLoadRows(memIn, full);
+        }
+    }
+}
+
 /*
     TODO: add lots of more tests to wxImage functions
 */
@@ -18,6 +18,7 @@
 #endif
 
 #include "wx/generic/private/rowheightcache.h"
+#include "wx/stopwatch.h"
 
 // ----------------------------------------------------------------------------
 // TestRowRangesAdd
@@ -270,3 +271,158 @@ TEST_CASE("RowHeightCacheTestCase::TestHeightCache", "[dataview][heightcache]")
     CHECK(hc.GetLineAt(22180, row) == false);
     CHECK(row == 666);
 }
+
+// ----------------------------------------------------------------------------
+// TestHeightCacheInsertDelete
+// ----------------------------------------------------------------------------
+TEST_CASE("RowHeightCacheTestCase::TestHeightCacheInsertDelete", "[dataview][heightcache]")
+{
+    HeightCache hc;
+
+    for (unsigned int i = 0; i < 100; i++)
+    {
+        hc.Put(i, i % 2 ? 20 : 30);
+    }
+
+    int start = 0;
+    int height = 0;
+    unsigned int row = 666;
+
+    CHECK(hc.GetFirstUnknownRow() == 100);
+    CHECK(hc.GetLineStart(100, start) == true);
+    CHECK(start == 2500);
+
+    // Inserted rows have unknown heights and the following rows are shifted.
+    hc.InsertRows(10, 5);
+    CHECK(hc.GetFirstUnknownRow() == 10);
+    CHECK(hc.GetLineHeight(10, height) == false);
+    CHECK(hc.GetLineHeight(15, height) == true);
+    CHECK(height == 30);
+    CHECK(hc.GetLineHeight(16, height) == true);
+    CHECK(height == 20);
+
+    CHECK(hc.GetLineStart(10, start) == true);
+    CHECK(start == 250);
+    CHECK(hc.GetLineStart(11, start) == false);
+    CHECK(hc.GetLineAt(249, row) == true);
+    CHECK(row == 9);
+    CHECK(hc.GetLineAt(250, row) == false);
+
+    for (unsigned int i = 10; i < 15; i++)
+    {
+        hc.Put(i, 40);
+    }
+    CHECK(hc.GetFirstUnknownRow() == 105);
+    CHECK(hc.GetLineStart(15, start) == true);
+    CHECK(start == 450);
+    CHECK(hc.GetLineAt(450, row) == true);
+    CHECK(row == 15);
+    CHECK(hc.GetLineAt(449, row) == true);
+    CHECK(row == 14);
+
+    // Deleting the rows shifts them back.
+    hc.DeleteRows(10, 5);
+    CHECK(hc.GetLineStart(100, start) == true);
+    CHECK(start == 2500);
+    CHECK(hc.GetLineAt(2499, row) == true);
+    CHECK(row == 99);
+    CHECK(hc.GetLineAt(2500, row) == false);
+
+    // Changing the height of a single row only affects the following ones.
+    hc.InvalidateLine(50);
+    CHECK(hc.GetFirstUnknownRow() == 50);
+    CHECK(hc.GetLineStart(50, start) == true);
+    CHECK(start == 1250);
+    CHECK(hc.GetLineStart(51, start) == false);
+
+    hc.Put(50, 130);
+    CHECK(hc.GetLineInfo(50, start, height) == true);
+    CHECK(start == 1250);
+    CHECK(height == 130);
+    CHECK(hc.GetLineStart(100, start) == true);
+    CHECK(start == 2600);
+    CHECK(hc.GetLineAt(1379, row) == true);
+    CHECK(row == 50);
+    CHECK(hc.GetLineAt(1380, row) == true);
+    CHECK(row == 51);
+
+    // Deleting past the end just truncates the cache.
+    hc.DeleteRows(90, 20);
+    CHECK(hc.GetFirstUnknownRow() == 90);
+    CHECK(hc.GetLineHeight(90, height) == false);
+}
+
+// ----------------------------------------------------------------------------
+// BenchmarkHeightCache
+// ----------------------------------------------------------------------------
+TEST_CASE("RowHeightCacheTestCase::Benchmark", "[dataview][heightcache][.]")
+{
+    const unsigned int NUM_ROWS = 1000000;
+    const int heights[] = { 17, 22, 22, 35, 22, 48, 22, 22 };
+
+    HeightCache hc;
+
+    wxStopWatch sw;
+    for (unsigned int i = 0; i < NUM_ROWS; i++)
+    {
+        hc.Put(i, heights[i % WXSIZEOF(heights)]);
+    }
+    const long timePut = sw.Time();
+
+    int total = 0;
+    REQUIRE(hc.GetLineStart(NUM_ROWS, total) == true);
+
+    // Use a simple LCG to access the rows in a pseudo-random order.
+    unsigned int seed = 1;
+
+    sw.Start();
+    long long sum = 0;
+    for (unsigned int i = 0; i < NUM_ROWS; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+
+        int start = 0;
+        hc.GetLineStart(seed % NUM_ROWS, start);
+        sum += start;
+    }
+    const long timeStart = sw.Time();
+
+    sw.Start();
+    for (unsigned int i = 0; i < NUM_ROWS; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+
+        unsigned int row = 0;
+        hc.GetLineAt(seed % total, row);
+        sum += row;
+    }
+    const long timeAt = sw.Time();
+
+    // Simulate expanding and collapsing items in the middle of the control.
+    sw.Start();
+    for (unsigned int i = 0; i < 1000; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        const unsigned int row = seed % NUM_ROWS;
+
+        hc.InsertRows(row, 10);
+        for (unsigned int n = 0; n < 10; n++)
+        {
+            hc.Put(row + n, 30);
+        }
+
+        int start = 0;
+        hc.GetLineStart(NUM_ROWS, start);
+        sum += start;
+
+        hc.DeleteRows(row, 10);
+    }
+    const long timeInsert = sw.Time();
+
+    WARN("Row height cache with " << NUM_ROWS << " rows:\n"
+         "  filling:                " << timePut << "ms\n"
+         "  " << NUM_ROWS << " GetLineStart():  " << timeStart << "ms\n"
+         "  " << NUM_ROWS << " GetLineAt():     " << timeAt << "ms\n"
+         "  1000 inserts/deletes:   " << timeInsert << "ms\n"
+         "  (checksum " << sum << ")");
+}
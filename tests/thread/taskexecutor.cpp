@@ -0,0 +1,428 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        tests/thread/taskexecutor.cpp
+// Purpose:     wxTaskExecutor unit test
+// Author:      wxWidgets team
+// Created:     2026-10-18
+// Copyright:   (c) 2026 wxWidgets team
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+// ----------------------------------------------------------------------------
+// headers
+// ----------------------------------------------------------------------------
+
+#include "testprec.h"
+
+
+#ifndef WX_PRECOMP
+    #include "wx/app.h"
+    #include "wx/event.h"
+    #include "wx/thread.h"
+    #include "wx/utils.h"
+#endif // WX_PRECOMP
+
+#include "wx/taskexecutor.h"
+
+// ----------------------------------------------------------------------------
+// helpers
+// ----------------------------------------------------------------------------
+
+namespace
+{
+
+// Task returning the square of its argument.
+struct Square
+{
+    explicit Square(int n) : m_n(n) { }
+
+    int operator()() const { return m_n*m_n; }
+
+    int m_n;
+};
+
+// Task incrementing the given counter.
+struct Increment
+{
+    explicit Increment(wxAtomicInt& counter) : m_counter(&counter) { }
+
+    void operator()() const { wxAtomicInc(*m_counter); }
+
+    wxAtomicInt* m_counter;
+};
+
+// Task blocking its worker thread until the semaphore is posted.
+struct Block
+{
+    explicit Block(wxSemaphore& semaphore) : m_semaphore(&semaphore) { }
+
+    void operator()() const { m_semaphore->Wait(); }
+
+    wxSemaphore* m_semaphore;
+};
+
+// Task appending its id to the vector of ids of the executed tasks.
+struct Record
+{
+    Record(wxVector<int>& ids, wxCriticalSection& cs, int id)
+        : m_ids(&ids), m_cs(&cs), m_id(id)
+    {
+    }
+
+    void operator()() const
+    {
+        wxCriticalSectionLocker lock(*m_cs);
+        m_ids->push_back(m_id);
+    }
+
+    wxVector<int>* m_ids;
+    wxCriticalSection* m_cs;
+    int m_id;
+};
+
+// Task running until it is cancelled.
+struct RunUntilCancelled
+{
+    explicit RunUntilCancelled(wxSemaphore& started) : m_started(&started) { }
+
+    void operator()() const
+    {
+        m_started->Post();
+
+        while ( !wxTaskExecutor::IsCurrentTaskCancelled() )
+            wxMilliSleep(1);
+    }
+
+    wxSemaphore* m_started;
+};
+
+// Task computing Fibonacci numbers by submitting and waiting for subtasks.
+struct Fibonacci
+{
+    Fibonacci(wxTaskExecutor& executor, int n)
+        : m_executor(&executor), m_n(n)
+    {
+    }
+
+    int operator()() const
+    {
+        if ( m_n < 2 )
+            return m_n;
+
+        const wxTaskFuture<int>
+            f1 = m_executor->Submit<int>(Fibonacci(*m_executor, m_n - 1));
+        const wxTaskFuture<int>
+            f2 = m_executor->Submit<int>(Fibonacci(*m_executor, m_n - 2));
+
+        return f1.Get() + f2.Get();
+    }
+
+    wxTaskExecutor* m_executor;
+    int m_n;
+};
+
+// Continuation storing the result of the task and the thread it ran in.
+struct StoreResult
+{
+    StoreResult(int& result, bool& inMainThread)
+        : m_result(&result), m_inMainThread(&inMainThread)
+    {
+    }
+
+    void operator()(const wxTaskFuture<int>& future) const
+    {
+        *m_result = future.Get();
+        *m_inMainThread = wxThread::IsMain();
+    }
+
+    int* m_result;
+    bool* m_inMainThread;
+};
+
+// Handler receiving the results of the tasks.
+class ResultHandler : public wxEvtHandler
+{
+public:
+    ResultHandler() : m_result(0) { }
+
+    void OnResult(const wxTaskFuture<int>& future)
+    {
+        m_result = future.Get();
+    }
+
+    int m_result;
+};
+
+#if wxUSE_EXCEPTIONS
+
+struct Throw
+{
+    int operator()() const { throw 17; }
+};
+
+#endif // wxUSE_EXCEPTIONS
+
+// Process the main thread continuations posted by the executor tasks in the
+// same way as the event loop would do it.
+void ProcessPendingEvents()
+{
+    if ( wxTheApp )
+        wxTheApp->ProcessPendingEvents();
+}
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------
+// tests themselves
+// ----------------------------------------------------------------------------
+
+TEST_CASE("TaskExecutor::Submit", "[thread][taskexecutor]")
+{
+    wxTaskExecutor executor(4);
+    CHECK( executor.GetThreadCount() == 4 );
+
+    static const int NUM_TASKS = 1000;
+
+    wxVector< wxTaskFuture<int> > futures;
+    for ( int n = 0; n < NUM_TASKS; n++ )
+        futures.push_back(executor.Submit<int>(Square(n)));
+
+    wxAtomicInt counter = 0;
+    wxVector< wxTaskFuture<void> > voidFutures;
+    for ( int n = 0; n < NUM_TASKS; n++ )
+        voidFutures.push_back(executor.Submit<void>(Increment(counter)));
+
+    for ( int n = 0; n < NUM_TASKS; n++ )
+    {
+        CHECK( futures[n].Get() == n*n );
+        CHECK( futures[n].GetState() == wxTASK_DONE );
+    }
+
+    for ( int n = 0; n < NUM_TASKS; n++ )
+        voidFutures[n].Wait();
+
+    CHECK( counter == NUM_TASKS );
+}
+
+TEST_CASE("TaskExecutor::Default", "[thread][taskexecutor]")
+{
+    wxTaskExecutor& executor = wxTaskExecutor::Get();
+    CHECK( &executor == &wxTaskExecutor::Get() );
+    CHECK( executor.GetThreadCount() > 0 );
+
+    CHECK( executor.Submit<int>(Square(3)).Get() == 9 );
+}
+
+TEST_CASE("TaskExecutor::Priority", "[thread][taskexecutor]")
+{
+    wxTaskExecutor executor(1);
+
+    // Keep the only worker busy while queuing the other tasks.
+    wxSemaphore semaphore;
+    executor.Submit<void>(Block(semaphore));
+
+    wxVector<int> ids;
+    wxCriticalSection cs;
+    executor.Submit<void>(Record(ids, cs, 1), wxTASK_PRIORITY_LOW);
+    executor.Submit<void>(Record(ids, cs, 2), wxTASK_PRIORITY_NORMAL);
+    executor.Submit<void>(Record(ids, cs, 3), wxTASK_PRIORITY_HIGH);
+    const wxTaskFuture<void>
+        last = executor.Submit<void>(Record(ids, cs, 4), wxTASK_PRIORITY_LOW);
+
+    semaphore.Post();
+    last.Wait();
+
+    REQUIRE( ids.size() == 4 );
+    CHECK( ids[0] == 3 );
+    CHECK( ids[1] == 2 );
+    CHECK( ids[2] == 1 );
+    CHECK( ids[3] == 4 );
+}
+
+TEST_CASE("TaskExecutor::Cancel", "[thread][taskexecutor]")
+{
+    wxTaskExecutor executor(1);
+
+    SECTION("Pending")
+    {
+        wxSemaphore semaphore;
+        executor.Submit<void>(Block(semaphore));
+
+        wxAtomicInt counter = 0;
+        const wxTaskFuture<void>
+            future = executor.Submit<void>(Increment(counter));
+
+        CHECK( future.Cancel() );
+        CHECK( future.IsCancelled() );
+        CHECK( !future.Cancel() );
+
+        semaphore.Post();
+        executor.Submit<void>(Increment(counter)).Wait();
+
+        CHECK( counter == 1 );
+    }
+
+    SECTION("Running")
+    {
+        wxSemaphore started;
+        const wxTaskFuture<void>
+            future = executor.Submit<void>(RunUntilCancelled(started));
+
+        started.Wait();
+        CHECK( future.GetState() == wxTASK_RUNNING );
+
+        CHECK( !future.Cancel() );
+        future.Wait();
+        CHECK( future.IsCancelled() );
+    }
+
+    SECTION("Ignored")
+    {
+        wxSemaphore semaphore;
+        const wxTaskFuture<void>
+            future = executor.Submit<void>(Block(semaphore));
+
+        while ( future.GetState() == wxTASK_PENDING )
+            wxMilliSleep(1);
+
+        // The task doesn't check for cancellation, so it still completes.
+        CHECK( !future.Cancel() );
+        semaphore.Post();
+        future.Wait();
+        CHECK( future.GetState() == wxTASK_DONE );
+    }
+
+    SECTION("Finished")
+    {
+        const wxTaskFuture<int> future = executor.Submit<int>(Square(2));
+        CHECK( future.Get() == 4 );
+
+        CHECK( !future.Cancel() );
+        CHECK( future.GetState() == wxTASK_DONE );
+        CHECK( future.Get() == 4 );
+    }
+
+    SECTION("Shutdown")
+    {
+        wxTaskFuture<void> running,
+                           pending;
+        {
+            wxTaskExecutor other(1);
+
+            wxSemaphore started;
+            running = other.Submit<void>(RunUntilCancelled(started));
+
+            wxAtomicInt counter = 0;
+            pending = other.Submit<void>(Increment(counter));
+
+            started.Wait();
+        }
+
+        CHECK( running.IsCancelled() );
+        CHECK( pending.IsCancelled() );
+    }
+}
+
+TEST_CASE("TaskExecutor::Nested", "[thread][taskexecutor]")
+{
+    // Waiting for the subtasks from inside a task must not deadlock, even if
+    // there are more waiting tasks than threads.
+    wxTaskExecutor executor(2);
+
+    CHECK( executor.Submit<int>(Fibonacci(executor, 15)).Get() == 610 );
+}
+
+TEST_CASE("TaskExecutor::Continuations", "[thread][taskexecutor]")
+{
+    wxTaskExecutor executor(2);
+
+    int result = 0;
+    bool inMainThread = false;
+
+    SECTION("Worker")
+    {
+        wxSemaphore semaphore;
+        const wxTaskFuture<void> block1 = executor.Submit<void>(Block(semaphore));
+        const wxTaskFuture<void> block2 = executor.Submit<void>(Block(semaphore));
+
+        const wxTaskFuture<int> future = executor.Submit<int>(Square(4));
+        future.Then(StoreResult(result, inMainThread));
+
+        semaphore.Post();
+        semaphore.Post();
+
+        future.Wait();
+
+        // Don't destroy the semaphore while the other worker may still use it.
+        block1.Wait();
+        block2.Wait();
+
+        CHECK( result == 16 );
+        CHECK( !inMainThread );
+    }
+
+    SECTION("MainThread")
+    {
+        const wxTaskFuture<int> future = executor.Submit<int>(Square(5));
+        future.ThenInMainThread(StoreResult(result, inMainThread));
+        future.Wait();
+
+        // Adding a continuation to a finished task still executes it later.
+        int result2 = 0;
+        bool inMainThread2 = false;
+        future.ThenInMainThread(StoreResult(result2, inMainThread2));
+        CHECK( result2 == 0 );
+
+        CHECK( executor.ProcessMainThreadContinuations() == 2 );
+        CHECK( result == 25 );
+        CHECK( inMainThread );
+        CHECK( result2 == 25 );
+        CHECK( inMainThread2 );
+
+        CHECK( executor.ProcessMainThreadContinuations() == 0 );
+    }
+
+    SECTION("EventLoop")
+    {
+        ResultHandler handler;
+
+        const wxTaskFuture<int> future = executor.Submit<int>(Square(6));
+        future.ThenInMainThread(&handler, &ResultHandler::OnResult);
+        future.Wait();
+
+        for ( int n = 0; n < 1000 && !handler.m_result; n++ )
+        {
+            ProcessPendingEvents();
+            wxMilliSleep(1);
+        }
+
+        CHECK( handler.m_result == 36 );
+    }
+
+    SECTION("DestroyedHandler")
+    {
+        const wxTaskFuture<int> future = executor.Submit<int>(Square(7));
+
+        ResultHandler* const handler = new ResultHandler;
+        future.ThenInMainThread(handler, &ResultHandler::OnResult);
+        delete handler;
+
+        future.Wait();
+
+        // The continuation must not be called for the destroyed handler.
+        CHECK( executor.ProcessMainThreadContinuations() == 1 );
+    }
+}
+
+#if wxUSE_EXCEPTIONS
+
+TEST_CASE("TaskExecutor::Exception", "[thread][taskexecutor]")
+{
+    wxTaskExecutor executor(1);
+
+    const wxTaskFuture<int> future = executor.Submit<int>(Throw());
+    future.Wait();
+
+    CHECK( future.GetState() == wxTASK_FAILED );
+}
+
+#endif // wxUSE_EXCEPTIONS